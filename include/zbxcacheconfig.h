@@ -37,7 +37,10 @@
 #define	ZBX_POLLER_TYPE_JAVA		4
 #define	ZBX_POLLER_TYPE_HISTORY		5
 #define	ZBX_POLLER_TYPE_ODBC		6
-#define	ZBX_POLLER_TYPE_COUNT		7	/* number of poller types */
+#define	ZBX_POLLER_TYPE_AGENT		7
+#define	ZBX_POLLER_TYPE_SNMP		8
+#define	ZBX_POLLER_TYPE_HTTPAGENT	9
+#define	ZBX_POLLER_TYPE_COUNT		10	/* number of poller types */
 
 typedef enum
 {
@@ -49,7 +52,8 @@ zbx_session_type_t;
 
 #define ZBX_MAX_JAVA_ITEMS		32
 #define ZBX_MAX_SNMP_ITEMS		128
-#define ZBX_MAX_POLLER_ITEMS		128	/* MAX(ZBX_MAX_JAVA_ITEMS, ZBX_MAX_SNMP_ITEMS) */
+#define ZBX_MAX_AGENT_ITEMS		32
+#define ZBX_MAX_POLLER_ITEMS		128	/* MAX(ZBX_MAX_JAVA_ITEMS, ZBX_MAX_SNMP_ITEMS, ZBX_MAX_AGENT_ITEMS) */
 #define ZBX_MAX_PINGER_ITEMS		128
 
 #define ZBX_SNMPTRAP_LOGGING_ENABLED	1
@@ -153,6 +157,7 @@ typedef struct
 	char			key_orig[ZBX_ITEM_KEY_LEN * ZBX_MAX_BYTES_IN_UTF8_CHAR + 1], *key;
 	char			*delay;
 	int			mtime;
+	int			nextcheck;
 	char			trapper_hosts[ZBX_ITEM_TRAPPER_HOSTS_LEN_MAX];
 	char			logtimefmt[ZBX_ITEM_LOGTIMEFMT_LEN_MAX];
 	char			snmp_community_orig[ZBX_ITEM_SNMP_COMMUNITY_LEN_MAX], *snmp_community;
@@ -622,6 +627,18 @@ typedef struct
 }
 zbx_config_cache_info_t;
 
+/* the configuration cache lock statistics */
+typedef struct
+{
+	zbx_uint64_t	reader_stalls;		/* number of read locks delayed by configuration cache writers */
+	double		reader_stall_total;	/* total time readers waited for configuration cache lock */
+	double		reader_stall_max;	/* longest time a reader waited for configuration cache lock */
+	zbx_uint64_t	sync_locks;		/* number of write locks taken by configuration syncer */
+	double		sync_lock_total;	/* total time configuration syncer held write lock */
+	double		sync_lock_max;		/* longest time configuration syncer held write lock */
+}
+zbx_config_cache_lock_stats_t;
+
 typedef struct
 {
 	zbx_uint64_t	dcheckid;
@@ -749,6 +766,9 @@ void	zbx_dc_config_get_functions_by_functionids(zbx_dc_function_t *functions,
 void	zbx_dc_config_clean_functions(zbx_dc_function_t *functions, int *errcodes, size_t num);
 void	zbx_dc_config_clean_triggers(zbx_dc_trigger_t *triggers, int *errcodes, size_t num);
 int	zbx_dc_config_lock_triggers_by_history_items(zbx_vector_ptr_t *history_items, zbx_vector_uint64_t *triggerids);
+int	zbx_dc_config_lock_triggers_by_itemids(const zbx_uint64_t *itemids, int *errcodes, int itemids_num,
+		zbx_vector_uint64_t *triggerids);
+void	zbx_dc_config_get_items_with_triggers(zbx_vector_uint64_t *itemids);
 void	zbx_dc_config_lock_triggers_by_triggerids(zbx_vector_uint64_t *triggerids_in,
 		zbx_vector_uint64_t *triggerids_out);
 void	zbx_dc_config_unlock_triggers(const zbx_vector_uint64_t *triggerids);
@@ -762,6 +782,8 @@ int	zbx_dc_config_get_interface_by_type(zbx_dc_interface_t *interface, zbx_uint6
 int	zbx_dc_config_get_interface(zbx_dc_interface_t *interface, zbx_uint64_t hostid, zbx_uint64_t itemid);
 int	zbx_dc_config_get_poller_nextcheck(unsigned char poller_type);
 int	zbx_dc_config_get_poller_items(unsigned char poller_type, int config_timeout, zbx_dc_item_t **items);
+int	zbx_dc_config_get_async_poller_items(unsigned char poller_type, int config_timeout, int max_items,
+		zbx_dc_item_t **items);
 #ifdef HAVE_OPENIPMI
 int	zbx_dc_config_get_ipmi_poller_items(int now, int items_num, int config_timeout, zbx_dc_item_t *items,
 		int *nextcheck);
@@ -857,6 +879,7 @@ zbx_uint64_t	zbx_dc_get_trigger_count(void);
 double		zbx_dc_get_required_performance(void);
 zbx_uint64_t	zbx_dc_get_host_count(void);
 void		zbx_dc_get_count_stats_all(zbx_config_cache_info_t *stats);
+void		zbx_dc_get_lock_stats(zbx_config_cache_lock_stats_t *stats);
 
 void	zbx_dc_get_status(zbx_vector_ptr_t *hosts_monitored, zbx_vector_ptr_t *hosts_not_monitored,
 		zbx_vector_ptr_t *items_active_normal, zbx_vector_ptr_t *items_active_notsupported,
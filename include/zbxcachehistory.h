@@ -23,10 +23,14 @@
 #include "zbxcacheconfig.h"
 #include "zbxshmem.h"
 #include "zbxpreproc.h"
+#include "zbxmutexs.h"
 
 #define ZBX_SYNC_DONE		0
 #define	ZBX_SYNC_MORE		1
 
+/* the maximum number of independently locked history cache shards */
+#define ZBX_HC_SHARDS_MAX	(ZBX_MUTEX_CACHE_SHARD_COUNT + 1)
+
 typedef struct
 {
 	zbx_uint64_t	history_counter;	/* the total number of processed values */
@@ -40,6 +44,19 @@ typedef struct
 }
 zbx_dc_stats_t;
 
+/* global event correlation statistics */
+typedef struct
+{
+	zbx_uint64_t	events;			/* the number of correlated events */
+	zbx_uint64_t	rules;			/* the number of correlation rules checked for events */
+	zbx_uint64_t	rules_skipped;		/* the number of correlation rules skipped by rule index */
+	zbx_uint64_t	problems_checked;	/* the number of open problems checked for events */
+	zbx_uint64_t	matches;		/* the number of matched correlation rules */
+	zbx_uint64_t	problems;		/* the number of open problems in problem index */
+	zbx_uint64_t	problems_loaded;	/* the number of open problems loaded from database */
+}
+zbx_dc_corr_stats_t;
+
 /* the write cache statistics */
 typedef struct
 {
@@ -50,17 +67,31 @@ typedef struct
 	zbx_uint64_t	index_total;
 	zbx_uint64_t	trend_free;
 	zbx_uint64_t	trend_total;
+	zbx_uint64_t	trend_upserted;		/* the number of trends merged with upsert statements */
+	double		history_lock_wait;
+	zbx_uint64_t	history_queue;		/* the number of values waiting to be synced */
+	double		history_delay;		/* the age of the oldest value waiting to be synced */
+	zbx_uint64_t	trigger_queue;		/* the number of values waiting for trigger evaluation */
+	double		trigger_delay;		/* the wait time of the oldest value in trigger queue */
+	zbx_uint64_t	trigger_processed;	/* the number of values with evaluated triggers */
+	double		trigger_wait;		/* the average value wait time in trigger queue */
+	zbx_uint64_t	history_copied;		/* the number of history rows written with bulk copy */
+	double		history_copy_rate;	/* the average bulk copy speed, rows/sec */
+	zbx_dc_corr_stats_t	corr_stats;
 }
 zbx_wcache_info_t;
 
 void	zbx_sync_history_cache(const zbx_events_funcs_t *events_cbs, int *values_num, int *triggers_num, int *more);
 void	zbx_log_sync_history_cache_progress(void);
+void	zbx_evaluate_trigger_queue(const zbx_events_funcs_t *events_cbs, int *values_num, int *triggers_num,
+		int *more);
 
 #define ZBX_SYNC_NONE	0
 #define ZBX_SYNC_ALL	1
 
 int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_uint64_t history_cache_size,
-		zbx_uint64_t history_index_cache_size,zbx_uint64_t *trends_cache_size, char **error);
+		zbx_uint64_t history_index_cache_size, int history_cache_shards, int trigger_evaluators,
+		zbx_uint64_t trigger_queue_size, zbx_uint64_t *trends_cache_size, char **error);
 void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs);
 
 void	zbx_change_proxy_history_count(int change_count);
@@ -90,9 +121,27 @@ int	zbx_get_proxy_history_count(void);
 #define ZBX_STATS_HISTORY_INDEX_PUSED	20
 #define ZBX_STATS_HISTORY_INDEX_PFREE	21
 #define ZBX_STATS_HISTORY_BIN_COUNTER	22
+#define ZBX_STATS_HISTORY_LOCK_WAIT	23
+#define ZBX_STATS_HISTORY_QUEUE		24
+#define ZBX_STATS_HISTORY_DELAY		25
+#define ZBX_STATS_TRIGGER_QUEUE		26
+#define ZBX_STATS_TRIGGER_DELAY		27
+#define ZBX_STATS_TRIGGER_PROCESSED	28
+#define ZBX_STATS_TRIGGER_WAIT		29
+#define ZBX_STATS_HISTORY_COPIED	30
+#define ZBX_STATS_HISTORY_COPY_RATE	31
+#define ZBX_STATS_CORR_EVENTS		32
+#define ZBX_STATS_CORR_RULES		33
+#define ZBX_STATS_CORR_RULES_SKIPPED	34
+#define ZBX_STATS_CORR_PROBLEMS_CHECKED	35
+#define ZBX_STATS_CORR_MATCHES		36
+#define ZBX_STATS_CORR_PROBLEMS		37
+#define ZBX_STATS_CORR_PROBLEMS_LOADED	38
+#define ZBX_STATS_TREND_UPSERTED	39
 
 void	*zbx_dc_get_stats(int request);
 void	zbx_dc_get_stats_all(zbx_wcache_info_t *wcache_info);
+void	zbx_dc_update_corr_stats(const zbx_dc_corr_stats_t *corr_stats);
 
 zbx_uint64_t	zbx_dc_get_nextid(const char *table_name, int num);
 
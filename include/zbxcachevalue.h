@@ -50,12 +50,24 @@
  *   either zbx_history_record_vector_destroy() function (free the zbx_vc_get_values()
  *   call output) or zbx_history_record_clear() function (free the zbx_vc_get_value() call output).
  *
+ *   The history data can also be read in place with zbx_vc_visit_values() function, which
+ *   calls the specified visitor for every value in the requested range instead of copying
+ *   the values. The visited values are valid only during the visitor call and must be
+ *   copied with zbx_vc_history_record_copy() function to be kept.
+ *
+ *   Aggregates of numeric item values over a time period can be requested with
+ *   zbx_vc_get_window_aggregate() function. The cache keeps running aggregates for requested
+ *   periods, when they are not available the values must be retrieved with zbx_vc_get_values().
+ *
  * Locking
  *
  *   The cache ensures synchronization between processes by using automatic locks whenever
  *   a cache function (zbx_vc_*) is called and by providing manual cache locking functionality
  *   with zbx_vc_lock()/zbx_vc_unlock() functions.
  *
+ *   The zbx_vc_visit_values() visitor is called while the cache is locked, so it must not
+ *   call value cache functions and should not perform lengthy operations.
+ *
  */
 
 #define ZBX_VC_MODE_NORMAL	0
@@ -64,6 +76,16 @@
 /* indicates that all values from database are cached */
 #define ZBX_ITEM_STATUS_CACHED_ALL	1
 
+/* the aggregate functions of sliding window requests */
+#define ZBX_VC_AGGR_SUM		0
+#define ZBX_VC_AGGR_AVG		1
+#define ZBX_VC_AGGR_MIN		2
+#define ZBX_VC_AGGR_MAX		3
+#define ZBX_VC_AGGR_COUNT	4
+
+/* the value cache visitor, returns SUCCEED to visit the next value or FAIL to stop */
+typedef int	(*zbx_vc_visitor_func_t)(const zbx_history_record_t *value, void *data);
+
 /* the cache statistics */
 typedef struct
 {
@@ -92,7 +114,7 @@ typedef struct
 }
 zbx_vc_item_stats_t;
 
-int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error);
+int	zbx_vc_init(zbx_uint64_t value_cache_size, int value_cache_compression, char **error);
 
 void	zbx_vc_destroy(void);
 
@@ -108,6 +130,14 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
 		zbx_history_record_t *value);
 
+int	zbx_vc_visit_values(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_visitor_func_t visitor, void *data);
+
+void	zbx_vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_record_t *src, int value_type);
+
+int	zbx_vc_get_window_aggregate(zbx_uint64_t itemid, unsigned char value_type, int seconds,
+		const zbx_timespec_t *ts, int aggr_func, zbx_history_value_t *value, int *values_num);
+
 int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush);
 
 int	zbx_vc_get_statistics(zbx_vc_stats_t *stats);
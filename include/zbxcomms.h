@@ -22,6 +22,7 @@
 
 #include "zbxalgo.h"
 #include "zbxtime.h"
+#include "zbxcompress.h"
 
 #define ZBX_IPV4_MAX_CIDR_PREFIX	32	/* max number of bits in IPv4 CIDR prefix */
 #define ZBX_IPV6_MAX_CIDR_PREFIX	128	/* max number of bits in IPv6 CIDR prefix */
@@ -166,7 +167,12 @@ typedef struct
 	gnutls_psk_server_credentials_t	psk_server_creds;
 #elif defined(HAVE_OPENSSL)
 	SSL				*ctx;
+#if defined(HAVE_OPENSSL_WITH_PSK)
+	/* PSK identity of incoming connection */
+	char				psk_identity[PSK_MAX_IDENTITY_LEN + 1];
 #endif
+#endif
+	unsigned int			psk_usage;	/* ZBX_PSK_FOR_* flags of incoming PSK connection */
 } zbx_tls_context_t;
 #endif
 
@@ -242,6 +248,9 @@ void	zbx_tcp_unlisten(zbx_socket_t *s);
 int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept, int poll_timeout);
 void	zbx_tcp_unaccept(zbx_socket_t *s);
 
+int	zbx_tcp_accept_nowait(ZBX_SOCKET listen_socket, zbx_socket_t *s, int timeout);
+int	zbx_tcp_accept_step(zbx_socket_t *s, unsigned int tls_accept, short *events);
+
 #define ZBX_TCP_READ_UNTIL_CLOSE 0x01
 
 #define	zbx_tcp_recv(s)				SUCCEED_OR_FAIL(zbx_tcp_recv_ext(s, 0, 0))
@@ -255,6 +264,39 @@ ssize_t		zbx_tcp_recv_ext(zbx_socket_t *s, int timeout, unsigned char flags);
 ssize_t		zbx_tcp_recv_raw_ext(zbx_socket_t *s, int timeout);
 const char	*zbx_tcp_recv_line(zbx_socket_t *s);
 
+/* removes processed data from the beginning of large message while it is being received, */
+/* the size is updated with the remaining number of bytes, FAIL stops further calls       */
+typedef int	(*zbx_tcp_recv_consume_func_t)(char *data, size_t *size, void *arg);
+
+ssize_t	zbx_tcp_recv_consume(zbx_socket_t *s, int timeout, unsigned char flags, zbx_tcp_recv_consume_func_t consume_cb,
+		void *consume_arg);
+
+/* state of a message being received in parts, see zbx_tcp_recv_context() */
+typedef struct
+{
+	size_t				buf_dyn_bytes;
+	size_t				buf_dyn_alloc;	/* allocated size of dynamic buffer */
+	size_t				buf_stat_bytes;
+	size_t				offset;
+	zbx_uint64_t			expected_len;
+	zbx_uint64_t			reserved;
+	zbx_uint64_t			max_len;
+	unsigned char			expect;
+	unsigned char			flags;
+	int				protocol_version;
+	zbx_uncompress_stream_t		*stream;	/* uncompresses large message while it is being received */
+	size_t				consumed;	/* bytes removed from the message by consume_cb */
+	zbx_tcp_recv_consume_func_t	consume_cb;
+	void				*consume_arg;
+}
+zbx_tcp_recv_context_t;
+
+void	zbx_tcp_recv_context_init(zbx_socket_t *s, zbx_tcp_recv_context_t *context, unsigned char flags);
+void	zbx_tcp_recv_context_set_consumer(zbx_tcp_recv_context_t *context, zbx_tcp_recv_consume_func_t consume_cb,
+		void *consume_arg);
+void	zbx_tcp_recv_context_clear(zbx_tcp_recv_context_t *context);
+ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, short *events);
+
 void	zbx_socket_set_deadline(zbx_socket_t *s, int timeout);
 int	zbx_socket_check_deadline(zbx_socket_t *s);
 
@@ -390,7 +432,7 @@ int		zbx_tls_validate_attr(const zbx_socket_t *sock, const zbx_tls_conn_attr_t *
 				const char *tls_subject, const char *tls_psk_identity, const char **msg);
 int		zbx_check_server_issuer_subject(const zbx_socket_t *sock, const char *allowed_issuer,
 				const char *allowed_subject, char **error);
-unsigned int	zbx_tls_get_psk_usage(void);
+unsigned int	zbx_tls_get_psk_usage(const zbx_socket_t *s);
 
 /* TLS BLOCK END */
 
@@ -26,4 +26,16 @@ int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out);
 int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out);
 const char	*zbx_compress_strerror(void);
 
+typedef struct zbx_uncompress_stream	zbx_uncompress_stream_t;
+
+zbx_uncompress_stream_t	*zbx_uncompress_stream_create(char *out, size_t size_out);
+int	zbx_uncompress_stream_write(zbx_uncompress_stream_t *stream, const char *in, size_t size_in);
+int	zbx_uncompress_stream_resume(zbx_uncompress_stream_t *stream);
+size_t	zbx_uncompress_stream_pending(const zbx_uncompress_stream_t *stream);
+void	zbx_uncompress_stream_set_output(zbx_uncompress_stream_t *stream, char *out, size_t size_out);
+size_t	zbx_uncompress_stream_size(const zbx_uncompress_stream_t *stream);
+void	zbx_uncompress_stream_discard(zbx_uncompress_stream_t *stream, size_t size);
+int	zbx_uncompress_stream_finish(zbx_uncompress_stream_t *stream, size_t *size_out);
+void	zbx_uncompress_stream_free(zbx_uncompress_stream_t *stream);
+
 #endif
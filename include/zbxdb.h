@@ -140,6 +140,7 @@ int		zbx_db_statement_execute(int iters);
 void	zbx_mysql_escape_bin(const char *src, char *dst, size_t size);
 #elif defined(HAVE_POSTGRESQL)
 void	zbx_postgresql_escape_bin(const char *src, char **dst, size_t size);
+int	zbx_db_copy_from(const char *sql, const char *data, size_t data_len);
 #endif
 
 int		zbx_db_vexecute(const char *fmt, va_list args);
@@ -254,6 +255,7 @@ struct zbx_db_version_info_t
 };
 
 void	zbx_dbms_version_info_extract(struct zbx_db_version_info_t *version_info);
+int	zbx_db_upsert_supported(void);
 #ifdef HAVE_POSTGRESQL
 void	zbx_tsdb_info_extract(struct zbx_db_version_info_t *version_info);
 void	zbx_tsdb_set_compression_availability(int compression_availabile);
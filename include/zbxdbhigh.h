@@ -702,6 +702,8 @@ typedef struct
 	zbx_vector_ptr_t	rows;
 	/* index of autoincrement field */
 	int			autoincrement;
+	/* 1 - rows are sent with bulk copy instead of insert statements */
+	unsigned char		copy;
 }
 zbx_db_insert_t;
 
@@ -713,6 +715,8 @@ void	zbx_db_insert_add_values(zbx_db_insert_t *self, ...);
 int	zbx_db_insert_execute(zbx_db_insert_t *self);
 void	zbx_db_insert_clean(zbx_db_insert_t *self);
 void	zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name);
+void	zbx_db_insert_use_copy(zbx_db_insert_t *self);
+void	zbx_db_get_copy_stats(zbx_uint64_t *rows, double *time_spent);
 int	zbx_db_get_database_type(void);
 
 typedef struct
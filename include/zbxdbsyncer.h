@@ -31,5 +31,6 @@ typedef struct
 zbx_thread_dbsyncer_args;
 
 ZBX_THREAD_ENTRY(zbx_dbsyncer_thread, args);
+ZBX_THREAD_ENTRY(zbx_trigger_evaluator_thread, args);
 
 #endif
@@ -72,9 +72,18 @@ void	zbx_update_proxy_data(zbx_dc_proxy_t *proxy, char *version_str, int version
 
 int	zbx_process_agent_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **info);
 int	zbx_process_sender_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **info);
+
+typedef struct zbx_proxy_data_stream	zbx_proxy_data_stream_t;
+
+zbx_proxy_data_stream_t	*zbx_proxy_data_stream_create(const zbx_socket_t *sock, const zbx_timespec_t *ts,
+		int proxydata_frequency);
+void	zbx_proxy_data_stream_free(zbx_proxy_data_stream_t *stream);
+size_t	zbx_proxy_data_stream_get_peak(const zbx_proxy_data_stream_t *stream);
+int	zbx_proxy_data_stream_consume(char *data, size_t *size, void *arg);
+
 int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, struct zbx_json_parse *jp, const zbx_timespec_t *ts,
-		unsigned char proxy_status, const zbx_events_funcs_t *events_cbs, int proxydata_frequency, int *more,
-		char **error);
+		const zbx_proxy_data_stream_t *stream, unsigned char proxy_status, const zbx_events_funcs_t *events_cbs,
+		int proxydata_frequency, int *more, char **error);
 int	zbx_check_protocol_version(zbx_dc_proxy_t *proxy, int version);
 
 int	zbx_db_copy_template_elements(zbx_uint64_t hostid, zbx_vector_uint64_t *lnk_templateids,
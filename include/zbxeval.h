@@ -194,6 +194,20 @@ zbx_eval_token_t;
 
 ZBX_VECTOR_DECL(eval_token, zbx_eval_token_t)
 
+/* compiled expression instructions */
+#define ZBX_EVAL_INSTR_TOKEN		0	/* execute source token */
+#define ZBX_EVAL_INSTR_CONST		1	/* push pre-parsed or folded constant */
+#define ZBX_EVAL_INSTR_FUNCTION		2	/* call common function resolved during compilation */
+
+typedef struct
+{
+	zbx_uint32_t	op;
+	zbx_uint32_t	index;	/* index of the source token in evaluation stack */
+	zbx_uint32_t	func;	/* common function identifier for ZBX_EVAL_INSTR_FUNCTION */
+	zbx_variant_t	value;	/* constant value for ZBX_EVAL_INSTR_CONST */
+}
+zbx_eval_instr_t;
+
 typedef struct
 {
 	const char		*expression;
@@ -204,6 +218,8 @@ typedef struct
 	zbx_timespec_t		ts;
 	zbx_vector_eval_token_t	stack;
 	zbx_vector_eval_token_t	ops;
+	zbx_eval_instr_t	*code;
+	int			code_num;
 	zbx_eval_function_cb_t	common_func_cb;
 	zbx_eval_function_cb_t	history_func_cb;
 	void			*data_cb;
@@ -221,6 +237,7 @@ size_t	zbx_eval_serialize(const zbx_eval_context_t *ctx, zbx_mem_malloc_func_t m
 void	zbx_eval_deserialize(zbx_eval_context_t *ctx, const char *expression, zbx_uint64_t rules,
 		const unsigned char *data);
 void	zbx_eval_compose_expression(const zbx_eval_context_t *ctx, char **expression);
+void	zbx_eval_compile(zbx_eval_context_t *ctx);
 int	zbx_eval_execute(zbx_eval_context_t *ctx, const zbx_timespec_t *ts, zbx_variant_t *value, char **error);
 int	zbx_eval_execute_ext(zbx_eval_context_t *ctx, const zbx_timespec_t *ts, zbx_eval_function_cb_t common_func_cb,
 		zbx_eval_function_cb_t history_func_cb, void *data, zbx_variant_t *value, char **error);
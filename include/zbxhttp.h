@@ -83,6 +83,31 @@ int	zbx_http_request(unsigned char request_method, const char *url, const char *
 		unsigned char authtype, const char *username, const char *password, const char *token,
 		unsigned char post_type, char *status_codes, unsigned char output_format, const char *config_source_ip,
 		char **out, char **error);
+
+/* HTTP request that can be performed either synchronously or by cURL multi interface */
+typedef struct
+{
+	CURL			*easyhandle;
+	struct curl_slist	*headers_slist;
+	zbx_http_response_t	header;
+	zbx_http_response_t	body;
+	char			errbuf[CURL_ERROR_SIZE];
+	unsigned char		retrieve_mode;
+	unsigned char		output_format;
+	char			*status_codes;
+}
+zbx_http_context_t;
+
+void	zbx_http_context_create(zbx_http_context_t *context);
+void	zbx_http_context_destroy(zbx_http_context_t *context);
+int	zbx_http_request_prepare(zbx_http_context_t *context, unsigned char request_method, const char *url,
+		const char *query_fields, char *headers, const char *posts, unsigned char retrieve_mode,
+		const char *http_proxy, unsigned char follow_redirects, const char *timeout, const char *ssl_cert_file,
+		const char *ssl_key_file, const char *ssl_key_password, unsigned char verify_peer,
+		unsigned char verify_host, unsigned char authtype, const char *username, const char *password,
+		const char *token, unsigned char post_type, const char *status_codes, unsigned char output_format,
+		const char *config_source_ip, char **error);
+int	zbx_http_handle_response(zbx_http_context_t *context, CURLcode err, char **out, char **error);
 #endif
 
 #endif
@@ -43,6 +43,7 @@ typedef struct
 	int	cnt;
 	char	*status;	/* array of individual response statuses: 1 - valid, 0 - timeout */
 	char	*dnsname;
+	char	*error;		/* the host specific error, NULL if the host was pinged */
 }
 ZBX_FPING_HOST;
 
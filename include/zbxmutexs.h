@@ -23,6 +23,9 @@
 #include "zbxcommon.h"
 #include "zbxprof.h"
 
+/* the number of additional history cache shard locks, the first shard uses ZBX_MUTEX_CACHE */
+#define ZBX_MUTEX_CACHE_SHARD_COUNT	15
+
 #ifdef _WINDOWS
 #	define ZBX_MUTEX_NULL		NULL
 
@@ -55,6 +58,11 @@ typedef enum
 	ZBX_MUTEX_MODBUS,
 	ZBX_MUTEX_TREND_FUNC,
 	ZBX_MUTEX_REMOTE_COMMANDS,
+	ZBX_MUTEX_CONFIG_STATS,
+	ZBX_MUTEX_TRIGGER_QUEUE,
+	ZBX_MUTEX_CACHE_STATS,
+	ZBX_MUTEX_CACHE_SHARD,
+	ZBX_MUTEX_CACHE_SHARD_LAST = ZBX_MUTEX_CACHE_SHARD + ZBX_MUTEX_CACHE_SHARD_COUNT - 1,
 	/* NOTE: Do not forget to sync changes here with mutex names in diag_add_locks_info()! */
 	ZBX_MUTEX_COUNT
 }
@@ -31,6 +31,12 @@
 
 #define ZBX_SELFMON_DELAY		1
 
+/* asynchronous poller statistics */
+#define ZBX_SELFMON_POLLER_CHECKS	0	/* checks in progress */
+#define ZBX_SELFMON_POLLER_LATENCY	1	/* average check latency */
+#define ZBX_SELFMON_POLLER_QUEUE_DELAY	2	/* average delay of checks after their scheduled time */
+#define ZBX_SELFMON_POLLER_STATS_NUM	3
+
 #ifndef _WINDOWS
 #include "zbxcommon.h"
 #include "zbxthreads.h"
@@ -43,6 +49,12 @@ void	zbx_free_selfmon_collector(void);
 void	zbx_update_selfmon_counter(const zbx_thread_info_t *info, unsigned char state);
 void	zbx_get_selfmon_stats(unsigned char proc_type, unsigned char aggr_func, int proc_num, unsigned char state,
 		double *value);
+void	zbx_update_selfmon_buffer(const zbx_thread_info_t *info, zbx_uint64_t size);
+int	zbx_get_selfmon_buffer_stats(unsigned char proc_type, unsigned char aggr_func, int proc_num,
+		zbx_uint64_t *value);
+void	zbx_update_selfmon_poller(const zbx_thread_info_t *info, int checks, double latency, double queue_delay);
+int	zbx_get_selfmon_poller_stats(unsigned char proc_type, unsigned char aggr_func, int proc_num, int stat,
+		double *value);
 int	zbx_get_all_process_stats(zbx_process_info_t *stats);
 void	zbx_sleep_loop(const zbx_thread_info_t *info, int sleeptime);
 #endif
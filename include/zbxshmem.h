@@ -28,6 +28,10 @@
 #define SHMEM_MAX_BUCKET_SIZE		256 /* starting from this size all free chunks are put into the same bucket */
 #define ZBX_SHMEM_BUCKET_COUNT		((SHMEM_MAX_BUCKET_SIZE - ZBX_SHMEM_MIN_BUCKET_SIZE) / 8 + 1)
 
+/* when slabs are enabled allocations up to this size are served from fixed size object slabs */
+#define ZBX_SHMEM_SLAB_MAX_ALLOC	256
+#define ZBX_SHMEM_SLAB_CLASS_COUNT	(ZBX_SHMEM_SLAB_MAX_ALLOC / 8)
+
 typedef struct
 {
 	void		*base;
@@ -47,9 +51,20 @@ typedef struct
 
 	const char	*mem_descr;
 	const char	*mem_param;
+
+	/* size class table of slab allocator, NULL if slabs are not enabled */
+	void		*slab_classes;
 }
 zbx_shmem_info_t;
 
+typedef struct
+{
+	unsigned int	slabs_num;
+	unsigned int	used_objects;
+	unsigned int	free_objects;
+}
+zbx_shmem_slab_stats_t;
+
 typedef struct
 {
 	zbx_uint64_t	free_size;
@@ -60,6 +75,9 @@ typedef struct
 	unsigned int	chunks_num[ZBX_SHMEM_BUCKET_COUNT];
 	unsigned int	free_chunks;
 	unsigned int	used_chunks;
+
+	/* slab statistics by object size class (8, 16, ..., ZBX_SHMEM_SLAB_MAX_ALLOC bytes) */
+	zbx_shmem_slab_stats_t	slab_classes[ZBX_SHMEM_SLAB_CLASS_COUNT];
 }
 zbx_shmem_stats_t;
 
@@ -68,6 +86,7 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 int	zbx_shmem_create_min(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
 		int allow_oom, char **error);
 void	zbx_shmem_destroy(zbx_shmem_info_t *info);
+int	zbx_shmem_enable_slabs(zbx_shmem_info_t *info, char **error);
 
 #define	zbx_shmem_malloc(info, old, size) __zbx_shmem_malloc(__FILE__, __LINE__, info, old, size)
 #define	zbx_shmem_realloc(info, old, size) __zbx_shmem_realloc(__FILE__, __LINE__, info, old, size)
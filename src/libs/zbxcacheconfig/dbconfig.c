@@ -48,8 +48,11 @@
 
 int	sync_in_progress = 0;
 
-#define START_SYNC	do { WRLOCK_CACHE_CONFIG_HISTORY; WRLOCK_CACHE; sync_in_progress = 1; } while(0)
-#define FINISH_SYNC	do { sync_in_progress = 0; UNLOCK_CACHE; UNLOCK_CACHE_CONFIG_HISTORY; } while(0)
+#define START_SYNC	dc_sync_lock()
+#define FINISH_SYNC	dc_sync_unlock()
+
+/* read lock waits shorter than this are not counted as reader stalls */
+#define ZBX_DC_READER_STALL_MIN		0.001
 
 #define ZBX_SNMP_OID_TYPE_NORMAL	0
 #define ZBX_SNMP_OID_TYPE_DYNAMIC	1
@@ -107,8 +110,78 @@ zbx_rwlock_t		config_lock = ZBX_RWLOCK_NULL;
 zbx_rwlock_t		config_history_lock = ZBX_RWLOCK_NULL;
 zbx_shmem_info_t	*config_mem;
 
+static zbx_mutex_t	config_stats_lock = ZBX_MUTEX_NULL;
+static double		sync_lock_time;
+
 ZBX_SHMEM_FUNC_IMPL(__config, config_mem)
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read lock configuration cache, accounting the time spent waiting  *
+ *          for writers in configuration cache lock statistics                *
+ *                                                                            *
+ ******************************************************************************/
+void	dc_rdlock_cache(void)
+{
+	double	time_start, time_wait;
+
+	time_start = zbx_time();
+	zbx_rwlock_rdlock(config_lock);
+
+	if (ZBX_DC_READER_STALL_MIN > (time_wait = zbx_time() - time_start))
+		return;
+
+	zbx_mutex_lock(config_stats_lock);
+
+	config->lock_stats.reader_stalls++;
+	config->lock_stats.reader_stall_total += time_wait;
+
+	if (time_wait > config->lock_stats.reader_stall_max)
+		config->lock_stats.reader_stall_max = time_wait;
+
+	zbx_mutex_unlock(config_stats_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: write lock configuration cache for applying synced changes        *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_sync_lock(void)
+{
+	WRLOCK_CACHE_CONFIG_HISTORY;
+	WRLOCK_CACHE;
+	sync_in_progress = 1;
+
+	sync_lock_time = zbx_time();
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unlock configuration cache after applying synced changes          *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_sync_unlock(void)
+{
+	double	time_held;
+
+	time_held = zbx_time() - sync_lock_time;
+
+	zbx_mutex_lock(config_stats_lock);
+
+	config->lock_stats.sync_locks++;
+	config->lock_stats.sync_lock_total += time_held;
+
+	if (time_held > config->lock_stats.sync_lock_max)
+		config->lock_stats.sync_lock_max = time_held;
+
+	zbx_mutex_unlock(config_stats_lock);
+
+	sync_in_progress = 0;
+	UNLOCK_CACHE;
+	UNLOCK_CACHE_CONFIG_HISTORY;
+}
+
 static void	dc_maintenance_precache_nested_groups(void);
 static void	dc_item_reset_triggers(ZBX_DC_ITEM *item, ZBX_DC_TRIGGER *trigger_exclude);
 
@@ -247,6 +320,30 @@ static unsigned char	poller_by_item(unsigned char type, const char *key)
 {
 	switch (type)
 	{
+		case ITEM_TYPE_ZABBIX:
+			if (0 != get_config_forks_cb(ZBX_PROCESS_TYPE_AGENT_POLLER))
+				return ZBX_POLLER_TYPE_AGENT;
+
+			if (0 == get_config_forks_cb(ZBX_PROCESS_TYPE_POLLER))
+				break;
+
+			return ZBX_POLLER_TYPE_NORMAL;
+		case ITEM_TYPE_SNMP:
+			if (0 != get_config_forks_cb(ZBX_PROCESS_TYPE_SNMP_POLLER))
+				return ZBX_POLLER_TYPE_SNMP;
+
+			if (0 == get_config_forks_cb(ZBX_PROCESS_TYPE_POLLER))
+				break;
+
+			return ZBX_POLLER_TYPE_NORMAL;
+		case ITEM_TYPE_HTTPAGENT:
+			if (0 != get_config_forks_cb(ZBX_PROCESS_TYPE_HTTPAGENT_POLLER))
+				return ZBX_POLLER_TYPE_HTTPAGENT;
+
+			if (0 == get_config_forks_cb(ZBX_PROCESS_TYPE_POLLER))
+				break;
+
+			return ZBX_POLLER_TYPE_NORMAL;
 		case ITEM_TYPE_SIMPLE:
 			if (SUCCEED == cmp_key_id(key, ZBX_SERVER_ICMPPING_KEY) ||
 					SUCCEED == cmp_key_id(key, ZBX_SERVER_ICMPPINGSEC_KEY) ||
@@ -258,12 +355,9 @@ static unsigned char	poller_by_item(unsigned char type, const char *key)
 				return ZBX_POLLER_TYPE_PINGER;
 			}
 			ZBX_FALLTHROUGH;
-		case ITEM_TYPE_ZABBIX:
-		case ITEM_TYPE_SNMP:
 		case ITEM_TYPE_EXTERNAL:
 		case ITEM_TYPE_SSH:
 		case ITEM_TYPE_TELNET:
-		case ITEM_TYPE_HTTPAGENT:
 		case ITEM_TYPE_SCRIPT:
 		case ITEM_TYPE_INTERNAL:
 			if (0 == get_config_forks_cb(ZBX_PROCESS_TYPE_POLLER))
@@ -501,6 +595,45 @@ int	DCitem_nextcheck_update(ZBX_DC_ITEM *item, const ZBX_DC_INTERFACE *interface
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if SNMP item can be checked by asynchronous SNMP pollers   *
+ *                                                                            *
+ * Comments: SNMP pollers send only GET requests of SNMPv1 and SNMPv2c items  *
+ *           to interfaces with IP address, so they are not blocked by walks, *
+ *           DNS resolution or SNMPv3 engine discovery.                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	dc_snmp_item_is_async(const ZBX_DC_ITEM *dc_item)
+{
+	const ZBX_DC_SNMPITEM		*snmpitem;
+	const ZBX_DC_INTERFACE		*dc_interface;
+	const ZBX_DC_SNMPINTERFACE	*snmp;
+
+	if (0 != (ZBX_FLAG_DISCOVERY_RULE & dc_item->flags))
+		return FAIL;
+
+	if (NULL == (snmpitem = (const ZBX_DC_SNMPITEM *)zbx_hashset_search(&config->snmpitems, &dc_item->itemid)) ||
+			ZBX_SNMP_OID_TYPE_NORMAL != snmpitem->snmp_oid_type)
+	{
+		return FAIL;
+	}
+
+	if (NULL == (dc_interface = (const ZBX_DC_INTERFACE *)zbx_hashset_search(&config->interfaces,
+			&dc_item->interfaceid)) || 1 != dc_interface->useip)
+	{
+		return FAIL;
+	}
+
+	if (NULL == (snmp = (const ZBX_DC_SNMPINTERFACE *)zbx_hashset_search(&config->interfaces_snmp,
+			&dc_item->interfaceid)) || ZBX_IF_SNMP_VERSION_3 == snmp->version)
+	{
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
 static void	DCitem_poller_type_update(ZBX_DC_ITEM *dc_item, const ZBX_DC_HOST *dc_host, int flags)
 {
 	unsigned char	poller_type;
@@ -513,6 +646,22 @@ static void	DCitem_poller_type_update(ZBX_DC_ITEM *dc_item, const ZBX_DC_HOST *d
 
 	poller_type = poller_by_item(dc_item->type, dc_item->key);
 
+	/* agent pollers do not support encrypted connections, leave such items to normal pollers */
+	if (ZBX_POLLER_TYPE_AGENT == poller_type && ZBX_TCP_SEC_UNENCRYPTED != dc_host->tls_connect &&
+			0 != get_config_forks_cb(ZBX_PROCESS_TYPE_POLLER))
+	{
+		poller_type = ZBX_POLLER_TYPE_NORMAL;
+	}
+
+	/* SNMP checks that would block asynchronous SNMP pollers are left to normal pollers */
+	if (ZBX_POLLER_TYPE_SNMP == poller_type && SUCCEED != dc_snmp_item_is_async(dc_item))
+	{
+		if (0 != get_config_forks_cb(ZBX_PROCESS_TYPE_POLLER))
+			poller_type = ZBX_POLLER_TYPE_NORMAL;
+		else
+			poller_type = ZBX_NO_POLLER;
+	}
+
 	if (0 != (flags & ZBX_HOST_UNREACHABLE))
 	{
 		if (ZBX_POLLER_TYPE_NORMAL == poller_type || ZBX_POLLER_TYPE_JAVA == poller_type)
@@ -7871,6 +8020,16 @@ static int	__config_heap_elem_compare(const void *d1, const void *d2)
 	ZBX_RETURN_IF_NOT_EQUAL(i1->nextcheck, i2->nextcheck);
 	ZBX_RETURN_IF_NOT_EQUAL(i1->queue_priority, i2->queue_priority);
 
+	/* keep agent items of the same interface due at the same time together, so normal pollers can request */
+	/* them over one connection                                                                            */
+	if (ITEM_TYPE_ZABBIX == i1->type || ITEM_TYPE_ZABBIX == i2->type)
+	{
+		ZBX_RETURN_IF_NOT_EQUAL(i1->type, i2->type);
+		ZBX_RETURN_IF_NOT_EQUAL(i1->interfaceid, i2->interfaceid);
+
+		return 0;
+	}
+
 	if (ITEM_TYPE_SNMP != i1->type)
 	{
 		if (ITEM_TYPE_SNMP != i2->type)
@@ -8075,12 +8234,18 @@ int	zbx_init_configuration_cache(zbx_get_program_type_f get_program_type, zbx_ge
 	if (SUCCEED != (ret = zbx_rwlock_create(&config_history_lock, ZBX_RWLOCK_CONFIG_HISTORY, error)))
 		goto out;
 
+	if (SUCCEED != (ret = zbx_mutex_create(&config_stats_lock, ZBX_MUTEX_CONFIG_STATS, error)))
+		goto out;
+
 	if (SUCCEED != (ret = zbx_shmem_create(&config_mem, conf_cache_size, "configuration cache",
 			"CacheSize", 0, error)))
 	{
 		goto out;
 	}
 
+	if (SUCCEED != (ret = zbx_shmem_enable_slabs(config_mem, error)))
+		goto out;
+
 	config = (ZBX_DC_CONFIG *)__config_shmem_malloc_func(NULL, sizeof(ZBX_DC_CONFIG) +
 			(size_t)get_config_forks_cb(ZBX_PROCESS_TYPE_TIMER) * sizeof(zbx_vector_ptr_t));
 
@@ -8252,6 +8417,7 @@ int	zbx_init_configuration_cache(zbx_get_program_type_f get_program_type, zbx_ge
 	config->auto_registration_actions = 0;
 
 	memset(&config->revision, 0, sizeof(config->revision));
+	memset(&config->lock_stats, 0, sizeof(config->lock_stats));
 
 	config->um_cache = um_cache_create();
 
@@ -8305,6 +8471,7 @@ void	zbx_free_configuration_cache(void)
 
 	zbx_shmem_destroy(config_mem);
 	config_mem = NULL;
+	zbx_mutex_destroy(&config_stats_lock);
 	zbx_rwlock_destroy(&config_history_lock);
 	zbx_rwlock_destroy(&config_lock);
 
@@ -8849,6 +9016,7 @@ static void	DCget_item(zbx_dc_item_t *dst_item, const ZBX_DC_ITEM *src_item)
 	dst_item->state = src_item->state;
 	dst_item->lastlogsize = src_item->lastlogsize;
 	dst_item->mtime = src_item->mtime;
+	dst_item->nextcheck = src_item->nextcheck;
 
 	dst_item->status = src_item->status;
 
@@ -9891,6 +10059,113 @@ next:;
 	return history_items->values_num - locked_num;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: Lock triggers of the specified items so that multiple trigger     *
+ *          evaluators do not process one trigger simultaneously.             *
+ *                                                                            *
+ * Parameters: itemids     - [IN] the item identifiers                        *
+ *             errcodes    - [OUT] SUCCEED - the item triggers were locked    *
+ *                                 FAIL    - some of item triggers are        *
+ *                                           already locked, item cannot be   *
+ *                                           taken                            *
+ *             itemids_num - [IN] the number of items                         *
+ *             triggerids  - [OUT] list of trigger IDs that this function has *
+ *                                 locked for processing; unlock those using  *
+ *                                 zbx_dc_config_unlock_triggers() function   *
+ *                                                                            *
+ * Return value: the number of items available for processing (unlocked).     *
+ *                                                                            *
+ * Comments: This is zbx_dc_config_lock_triggers_by_history_items() analog    *
+ *           for trigger evaluators, which take items from trigger queue.     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dc_config_lock_triggers_by_itemids(const zbx_uint64_t *itemids, int *errcodes, int itemids_num,
+		zbx_vector_uint64_t *triggerids)
+{
+	int			i, j, locked_num = 0;
+	const ZBX_DC_ITEM	*dc_item;
+	ZBX_DC_TRIGGER		*dc_trigger;
+
+	WRLOCK_CACHE;
+
+	for (i = 0; i < itemids_num; i++)
+	{
+		errcodes[i] = SUCCEED;
+
+		if (NULL == (dc_item = (ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemids[i])))
+			continue;
+
+		if (NULL == dc_item->triggers)
+			continue;
+
+		for (j = 0; NULL != (dc_trigger = dc_item->triggers[j]); j++)
+		{
+			if (TRIGGER_STATUS_ENABLED != dc_trigger->status)
+				continue;
+
+			if (1 == dc_trigger->locked)
+			{
+				locked_num++;
+				errcodes[i] = FAIL;
+				goto next;
+			}
+		}
+
+		for (j = 0; NULL != (dc_trigger = dc_item->triggers[j]); j++)
+		{
+			if (TRIGGER_STATUS_ENABLED != dc_trigger->status)
+				continue;
+
+			dc_trigger->locked = 1;
+			zbx_vector_uint64_append(triggerids, dc_trigger->triggerid);
+		}
+next:;
+	}
+
+	UNLOCK_CACHE;
+
+	return itemids_num - locked_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes items without enabled triggers from the list              *
+ *                                                                            *
+ * Parameters: itemids - [IN/OUT] the item identifiers                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_config_get_items_with_triggers(zbx_vector_uint64_t *itemids)
+{
+	int			i, j, items_num = 0;
+	const ZBX_DC_ITEM	*dc_item;
+	const ZBX_DC_TRIGGER	*dc_trigger;
+
+	RDLOCK_CACHE;
+
+	for (i = 0; i < itemids->values_num; i++)
+	{
+		if (NULL == (dc_item = (ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemids->values[i])))
+			continue;
+
+		if (NULL == dc_item->triggers)
+			continue;
+
+		for (j = 0; NULL != (dc_trigger = dc_item->triggers[j]); j++)
+		{
+			if (TRIGGER_STATUS_ENABLED == dc_trigger->status)
+			{
+				itemids->values[items_num++] = itemids->values[i];
+				break;
+			}
+		}
+	}
+
+	UNLOCK_CACHE;
+
+	itemids->values_num = items_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Lock triggers so that multiple processes do not process one       *
@@ -10667,45 +10942,28 @@ static void	dc_requeue_item_at(ZBX_DC_ITEM *dc_item, ZBX_DC_HOST *dc_host, int n
  *                                                                            *
  * Parameters: poller_type    - [IN] poller type (ZBX_POLLER_TYPE_...)        *
  *             config_timeout - [IN]                                          *
+ *             max_items      - [IN] the maximum number of items to get       *
  *             items          - [OUT] array of items                          *
  *                                                                            *
  * Return value: number of items in items array                               *
  *                                                                            *
- * Comments: Items leave the queue only through this function. Pollers must   *
- *           always return the items they have taken using                    *
- *           zbx_dc_requeue_items() or zbx_dc_poller_requeue_items().         *
- *                                                                            *
- *           Currently batch polling is supported only for JMX, SNMP and      *
- *           icmpping* simple checks. In other cases only single item is      *
- *           retrieved.                                                       *
- *                                                                            *
- *           IPMI poller queue are handled by                                 *
- *           zbx_dc_config_get_ipmi_poller_items() function.                  *
+ * Comments: If more than one item is found the items array is allocated by   *
+ *           this function, otherwise the item is stored in the array passed  *
+ *           by caller.                                                       *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dc_config_get_poller_items(unsigned char poller_type, int config_timeout, zbx_dc_item_t **items)
+static int	dc_config_get_poller_items(unsigned char poller_type, int config_timeout, int max_items,
+		zbx_dc_item_t **items)
 {
-	int			now, num = 0, max_items;
+	int			now, num = 0;
 	zbx_binary_heap_t	*queue;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() poller_type:%d", __func__, (int)poller_type);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() poller_type:%d max_items:%d", __func__, (int)poller_type, max_items);
 
 	now = time(NULL);
 
 	queue = &config->queues[poller_type];
 
-	switch (poller_type)
-	{
-		case ZBX_POLLER_TYPE_JAVA:
-			max_items = ZBX_MAX_JAVA_ITEMS;
-			break;
-		case ZBX_POLLER_TYPE_PINGER:
-			max_items = ZBX_MAX_PINGER_ITEMS;
-			break;
-		default:
-			max_items = 1;
-	}
-
 	WRLOCK_CACHE;
 
 	while (num < max_items && FAIL == zbx_binary_heap_empty(queue))
@@ -10735,6 +10993,12 @@ int	zbx_dc_config_get_poller_items(unsigned char poller_type, int config_timeout
 				if (0 != __config_java_item_compare(dc_item_prev, dc_item))
 					break;
 			}
+			else if (ITEM_TYPE_ZABBIX == dc_item_prev->type && (ZBX_POLLER_TYPE_NORMAL == poller_type ||
+					ZBX_POLLER_TYPE_UNREACHABLE == poller_type))
+			{
+				if (ITEM_TYPE_ZABBIX != dc_item->type || dc_item_prev->interfaceid != dc_item->interfaceid)
+					break;
+			}
 		}
 
 		zbx_binary_heap_remove_min(queue);
@@ -10789,18 +11053,30 @@ int	zbx_dc_config_get_poller_items(unsigned char poller_type, int config_timeout
 
 		if (0 == num)
 		{
-			if (ZBX_POLLER_TYPE_NORMAL == poller_type && ITEM_TYPE_SNMP == dc_item->type &&
-					0 == (ZBX_FLAG_DISCOVERY_RULE & dc_item->flags))
+			if ((ZBX_POLLER_TYPE_NORMAL == poller_type || ZBX_POLLER_TYPE_SNMP == poller_type) &&
+					ITEM_TYPE_SNMP == dc_item->type)
 			{
 				ZBX_DC_SNMPITEM	*snmpitem;
+				int		snmp_items = 1;
 
 				snmpitem = (ZBX_DC_SNMPITEM *)zbx_hashset_search(&config->snmpitems, &dc_item->itemid);
 
-				if (ZBX_SNMP_OID_TYPE_NORMAL == snmpitem->snmp_oid_type ||
-						ZBX_SNMP_OID_TYPE_DYNAMIC == snmpitem->snmp_oid_type)
+				if (0 == (ZBX_FLAG_DISCOVERY_RULE & dc_item->flags) &&
+						(ZBX_SNMP_OID_TYPE_NORMAL == snmpitem->snmp_oid_type ||
+						ZBX_SNMP_OID_TYPE_DYNAMIC == snmpitem->snmp_oid_type))
 				{
-					max_items = DCconfig_get_suggested_snmp_vars_nolock(dc_item->interfaceid, NULL);
+					snmp_items = DCconfig_get_suggested_snmp_vars_nolock(dc_item->interfaceid, NULL);
 				}
+
+				/* SNMP pollers also limit the batch by the number of free check slots */
+				if (ZBX_POLLER_TYPE_NORMAL == poller_type || snmp_items < max_items)
+					max_items = snmp_items;
+			}
+			else if (ITEM_TYPE_ZABBIX != dc_item->type && (ZBX_POLLER_TYPE_NORMAL == poller_type ||
+					ZBX_POLLER_TYPE_UNREACHABLE == poller_type))
+			{
+				/* only SNMP and agent items are checked in batches by pollers */
+				max_items = 1;
 			}
 
 			if (1 < max_items)
@@ -10821,6 +11097,74 @@ int	zbx_dc_config_get_poller_items(unsigned char poller_type, int config_timeout
 	return num;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: Get array of items for selected poller                            *
+ *                                                                            *
+ * Parameters: poller_type    - [IN] poller type (ZBX_POLLER_TYPE_...)        *
+ *             config_timeout - [IN]                                          *
+ *             items          - [OUT] array of items                          *
+ *                                                                            *
+ * Return value: number of items in items array                               *
+ *                                                                            *
+ * Comments: Items leave the queue only through this function. Pollers must   *
+ *           always return the items they have taken using                    *
+ *           zbx_dc_requeue_items() or zbx_dc_poller_requeue_items().         *
+ *                                                                            *
+ *           Currently batch polling is supported only for JMX, SNMP, agent   *
+ *           and icmpping* simple checks. In other cases only single item is  *
+ *           retrieved.                                                       *
+ *                                                                            *
+ *           IPMI poller queue are handled by                                 *
+ *           zbx_dc_config_get_ipmi_poller_items() function.                  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dc_config_get_poller_items(unsigned char poller_type, int config_timeout, zbx_dc_item_t **items)
+{
+	int	max_items;
+
+	switch (poller_type)
+	{
+		case ZBX_POLLER_TYPE_JAVA:
+			max_items = ZBX_MAX_JAVA_ITEMS;
+			break;
+		case ZBX_POLLER_TYPE_PINGER:
+			max_items = ZBX_MAX_PINGER_ITEMS;
+			break;
+		case ZBX_POLLER_TYPE_NORMAL:
+		case ZBX_POLLER_TYPE_UNREACHABLE:
+			max_items = ZBX_MAX_AGENT_ITEMS;
+			break;
+		default:
+			max_items = 1;
+	}
+
+	return dc_config_get_poller_items(poller_type, config_timeout, max_items, items);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: Get array of items for asynchronous poller                        *
+ *                                                                            *
+ * Parameters: poller_type    - [IN] poller type (ZBX_POLLER_TYPE_...)        *
+ *             config_timeout - [IN]                                          *
+ *             max_items      - [IN] the number of free check slots in poller *
+ *             items          - [OUT] array of items                          *
+ *                                                                            *
+ * Return value: number of items in items array                               *
+ *                                                                            *
+ * Comments: Asynchronous pollers run checks of different hosts concurrently, *
+ *           so agent and HTTP agent items are not grouped by interface. SNMP *
+ *           items are returned as a single batch of items sharing the same   *
+ *           interface, limited by the suggested number of SNMP variables.    *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dc_config_get_async_poller_items(unsigned char poller_type, int config_timeout, int max_items,
+		zbx_dc_item_t **items)
+{
+	return dc_config_get_poller_items(poller_type, config_timeout, max_items, items);
+}
+
 #ifdef HAVE_OPENIPMI
 /******************************************************************************
  *                                                                            *
@@ -12517,6 +12861,20 @@ void	zbx_dc_get_count_stats_all(zbx_config_cache_info_t *stats)
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get configuration cache lock statistics                           *
+ *                                                                            *
+ * Parameters: stats - [OUT] the lock statistics                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_lock_stats(zbx_config_cache_lock_stats_t *stats)
+{
+	zbx_mutex_lock(config_stats_lock);
+	*stats = config->lock_stats;
+	zbx_mutex_unlock(config_stats_lock);
+}
+
 static void	proxy_counter_ui64_push(zbx_vector_ptr_t *vector, zbx_uint64_t proxyid, zbx_uint64_t counter)
 {
 	zbx_proxy_counter_t	*proxy_counter;
@@ -981,6 +981,7 @@ typedef struct
 	zbx_um_cache_t		*um_cache;
 	char			autoreg_psk_identity[HOST_TLS_PSK_IDENTITY_LEN_MAX];	/* autoregistration PSK */
 	char			autoreg_psk[HOST_TLS_PSK_LEN_MAX];
+	zbx_config_cache_lock_stats_t	lock_stats;		/* protected by config_stats_lock */
 }
 ZBX_DC_CONFIG;
 
@@ -988,7 +989,9 @@ extern int	sync_in_progress;
 extern ZBX_DC_CONFIG	*config;
 extern zbx_rwlock_t	config_lock;
 
-#define	RDLOCK_CACHE	if (0 == sync_in_progress) zbx_rwlock_rdlock(config_lock)
+void	dc_rdlock_cache(void);
+
+#define	RDLOCK_CACHE	if (0 == sync_in_progress) dc_rdlock_cache()
 #define	WRLOCK_CACHE	if (0 == sync_in_progress) zbx_rwlock_wrlock(config_lock)
 #define	UNLOCK_CACHE	if (0 == sync_in_progress) zbx_rwlock_unlock(config_lock)
 
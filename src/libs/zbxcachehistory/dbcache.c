@@ -41,17 +41,24 @@
 static zbx_shmem_info_t	*hc_index_mem = NULL;
 static zbx_shmem_info_t	*hc_mem = NULL;
 static zbx_shmem_info_t	*trend_mem = NULL;
+static zbx_shmem_info_t	*hc_trigger_mem = NULL;
 
-#define	LOCK_CACHE	zbx_mutex_lock(cache_lock)
-#define	UNLOCK_CACHE	zbx_mutex_unlock(cache_lock)
+/* the first shard lock also protects the cache-wide fields (proxy queue, sync progress) */
+#define	LOCK_CACHE	hc_shard_lock(&cache->shards[0])
+#define	UNLOCK_CACHE	hc_shard_unlock(&cache->shards[0])
 #define	LOCK_TRENDS	zbx_mutex_lock(trends_lock)
 #define	UNLOCK_TRENDS	zbx_mutex_unlock(trends_lock)
+#define	LOCK_TRIGGER_QUEUE	zbx_mutex_lock(trigger_queue_lock)
+#define	UNLOCK_TRIGGER_QUEUE	zbx_mutex_unlock(trigger_queue_lock)
 #define	LOCK_CACHE_IDS		zbx_mutex_lock(cache_ids_lock)
 #define	UNLOCK_CACHE_IDS	zbx_mutex_unlock(cache_ids_lock)
+#define	LOCK_CACHE_STATS	zbx_mutex_lock(cache_stats_lock)
+#define	UNLOCK_CACHE_STATS	zbx_mutex_unlock(cache_stats_lock)
 
-static zbx_mutex_t	cache_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	trends_lock = ZBX_MUTEX_NULL;
+static zbx_mutex_t	trigger_queue_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	cache_ids_lock = ZBX_MUTEX_NULL;
+static zbx_mutex_t	cache_stats_lock = ZBX_MUTEX_NULL;
 
 static char		*sql = NULL;
 static size_t		sql_alloc = 4 * ZBX_KIBIBYTE;
@@ -62,6 +69,9 @@ static zbx_get_program_type_f	get_program_type_cb = NULL;
 
 #define ZBX_HC_ITEMS_INIT_SIZE	1000
 
+/* the minimum history cache and history index cache size per shard */
+#define ZBX_HC_SHARD_SIZE_MIN	(128 * ZBX_KIBIBYTE)
+
 #define ZBX_TRENDS_CLEANUP_TIME	(SEC_PER_MIN * 55)
 
 /* the maximum time spent synchronizing history */
@@ -75,6 +85,11 @@ static zbx_get_program_type_f	get_program_type_cb = NULL;
 /* the minimum processed item percentage of item candidates to continue synchronizing */
 #define ZBX_HC_SYNC_MIN_PCNT	10
 
+/* the trigger queue memory per queued value - each queued value takes up to ~40 bytes, each queued item up */
+/* to ~64 bytes in item index, plus item index slots and queue heap, leaving room for reallocation and      */
+/* fragmentation                                                                                            */
+#define ZBX_HC_TRIGGER_VALUE_SIZE	256
+
 /* the maximum number of characters for history cache values */
 #define ZBX_HISTORY_VALUE_LEN	(1024 * 64)
 
@@ -109,15 +124,64 @@ typedef struct
 }
 zbx_hc_proxyqueue_t;
 
+/* history cache shard - items are distributed across shards by itemid, */
+/* each shard has its own lock, history index and history data memory   */
 typedef struct
 {
-	zbx_hashset_t		trends;
-	zbx_dc_stats_t		stats;
+	zbx_mutex_t		lock;
+	zbx_shmem_info_t	*mem;
+	zbx_shmem_info_t	*index_mem;
 
 	zbx_hashset_t		history_items;
 	zbx_binary_heap_t	history_queue;
-
 	int			history_num;
+
+	zbx_dc_stats_t		stats;
+
+	double			lock_wait;	/* the total time spent waiting for shard lock */
+}
+zbx_hc_shard_t;
+
+/* value timestamp queued for trigger evaluation */
+typedef struct zbx_hc_trigger_data
+{
+	zbx_timespec_t			ts;
+	double				time_queued;
+	struct zbx_hc_trigger_data	*next;
+}
+zbx_hc_trigger_data_t;
+
+/* item with values queued for trigger evaluation */
+typedef struct
+{
+	zbx_uint64_t		itemid;
+	unsigned char		status;
+	zbx_hc_trigger_data_t	*tail;
+	zbx_hc_trigger_data_t	*head;
+}
+zbx_hc_trigger_item_t;
+
+/* the queue of values history syncers pass to trigger evaluators */
+typedef struct
+{
+	zbx_hashset_t		items;
+	zbx_binary_heap_t	queue;
+	int			values_num;
+	int			values_reserved;	/* the space reserved by history syncers for next batch */
+	int			values_max;	/* the maximum number of queued values, based on queue size */
+
+	zbx_uint64_t		processed;	/* the number of values with evaluated triggers */
+	double			wait;		/* the total time evaluated values have spent in queue */
+}
+zbx_hc_trigger_queue_t;
+
+typedef struct
+{
+	zbx_hashset_t		trends;
+
+	zbx_hc_shard_t		shards[ZBX_HC_SHARDS_MAX];
+	int			shards_num;
+
 	int			trends_num;
 	int			trends_last_cleanup_hour;
 	int			history_num_total;
@@ -127,6 +191,20 @@ typedef struct
 
 	zbx_hc_proxyqueue_t	proxyqueue;
 	int			proxy_history_count;
+
+	/* the number of trigger evaluators, 0 - triggers are evaluated by history syncers */
+	int			trigger_evaluators;
+	zbx_hc_trigger_queue_t	triggerqueue;
+
+	/* bulk copy statistics of history syncers, protected by the cache statistics lock */
+	zbx_uint64_t		copy_rows;
+	double			copy_time;
+
+	/* global event correlation statistics, protected by the cache statistics lock */
+	zbx_dc_corr_stats_t	corr_stats;
+
+	/* the number of trend rows merged with upsert statements, protected by the trends lock */
+	zbx_uint64_t		trends_upserted;
 }
 ZBX_DC_CACHE;
 
@@ -178,37 +256,334 @@ static size_t		item_values_alloc = 0, item_values_num = 0;
 static void	hc_add_item_values(dc_item_value_t *values, int values_num);
 static void	hc_pop_items(zbx_vector_ptr_t *history_items);
 static void	hc_get_item_values(zbx_dc_history_t *history, zbx_vector_ptr_t *history_items);
-static void	hc_push_items(zbx_vector_ptr_t *history_items);
+static int	hc_push_items(zbx_vector_ptr_t *history_items);
 static void	hc_free_item_values(zbx_dc_history_t *history, int history_num);
-static void	hc_queue_item(zbx_hc_item_t *item);
+static void	hc_queue_item(zbx_hc_shard_t *shard, zbx_hc_item_t *item);
 static int	hc_queue_elem_compare_func(const void *d1, const void *d2);
 static int	hc_queue_get_size(void);
+static int	hc_trigger_queue_reserve(void);
+static void	hc_trigger_queue_release(void);
+static void	hc_queue_trigger_values(const zbx_dc_history_t *history, int history_num,
+		const zbx_vector_uint64_t *itemids);
+static void	hc_queue_trigger_item(zbx_hc_trigger_item_t *item);
+static int	hc_trigger_queue_elem_compare_func(const void *d1, const void *d2);
+static void	hc_pop_trigger_items(zbx_vector_ptr_t *trigger_items);
+static int	hc_push_trigger_items(zbx_vector_ptr_t *trigger_items);
 static int	hc_get_history_compression_age(void);
+static void	evaluate_trigger_queue(int *values_num, int *triggers_num, const zbx_events_funcs_t *events_cbs,
+		int sync_time_max, int *more);
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves all internal metrics of the database cache              *
+ * Purpose: locks history cache shard and updates lock wait statistics        *
  *                                                                            *
- * Parameters: stats - [OUT] write cache metrics                              *
+ ******************************************************************************/
+static void	hc_shard_lock(zbx_hc_shard_t *shard)
+{
+	double	time_start;
+
+	time_start = zbx_time();
+	zbx_mutex_lock(shard->lock);
+	shard->lock_wait += zbx_time() - time_start;
+}
+
+static void	hc_shard_unlock(zbx_hc_shard_t *shard)
+{
+	zbx_mutex_unlock(shard->lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns history cache shard the item belongs to                   *
  *                                                                            *
  ******************************************************************************/
-void	zbx_dc_get_stats_all(zbx_wcache_info_t *wcache_info)
+static zbx_hc_shard_t	*hc_get_shard(zbx_uint64_t itemid)
 {
-	LOCK_CACHE;
+	return &cache->shards[itemid % (zbx_uint64_t)cache->shards_num];
+}
 
-	wcache_info->stats = cache->stats;
-	wcache_info->history_free = hc_mem->free_size;
-	wcache_info->history_total = hc_mem->total_size;
-	wcache_info->index_free = hc_index_mem->free_size;
-	wcache_info->index_total = hc_index_mem->total_size;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sums statistics of all history cache shards                       *
+ *                                                                            *
+ * Comments: Shards are locked one at a time, so the totals are not a single  *
+ *           snapshot of the whole cache.                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_get_shard_stats(zbx_dc_stats_t *stats, zbx_uint64_t *history_free, zbx_uint64_t *history_total,
+		zbx_uint64_t *index_free, zbx_uint64_t *index_total, double *lock_wait)
+{
+	int	i;
 
-	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
+	memset(stats, 0, sizeof(zbx_dc_stats_t));
+	*history_free = *history_total = *index_free = *index_total = 0;
+	*lock_wait = 0;
+
+	for (i = 0; i < cache->shards_num; i++)
 	{
-		wcache_info->trend_free = trend_mem->free_size;
-		wcache_info->trend_total = trend_mem->orig_size;
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+
+		hc_shard_lock(shard);
+
+		stats->history_counter += shard->stats.history_counter;
+		stats->history_float_counter += shard->stats.history_float_counter;
+		stats->history_uint_counter += shard->stats.history_uint_counter;
+		stats->history_str_counter += shard->stats.history_str_counter;
+		stats->history_log_counter += shard->stats.history_log_counter;
+		stats->history_text_counter += shard->stats.history_text_counter;
+		stats->history_bin_counter += shard->stats.history_bin_counter;
+		stats->notsupported_counter += shard->stats.notsupported_counter;
+
+		*history_free += shard->mem->free_size;
+		*history_total += shard->mem->total_size;
+		*index_free += shard->index_mem->free_size;
+		*index_total += shard->index_mem->total_size;
+		*lock_wait += shard->lock_wait;
+
+		hc_shard_unlock(shard);
 	}
+}
 
-	UNLOCK_CACHE;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets history bulk copy and event correlation statistics           *
+ *                                                                            *
+ * Parameters: copied     - [OUT] the number of rows written with bulk copy   *
+ *             copy_rate  - [OUT] the average bulk copy speed, rows/sec       *
+ *             corr_stats - [OUT] the event correlation statistics            *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_get_global_stats(zbx_uint64_t *copied, double *copy_rate, zbx_dc_corr_stats_t *corr_stats)
+{
+	LOCK_CACHE_STATS;
+
+	*copied = cache->copy_rows;
+	*copy_rate = (0 < cache->copy_time ? (double)cache->copy_rows / cache->copy_time : 0);
+	*corr_stats = cache->corr_stats;
+
+	UNLOCK_CACHE_STATS;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets trend cache statistics                                       *
+ *                                                                            *
+ * Parameters: trend_free     - [OUT] the free trend cache size               *
+ *             trend_total    - [OUT] the trend cache size                    *
+ *             trend_upserted - [OUT] the number of trends merged with upsert *
+ *                                    statements                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_get_trend_stats(zbx_uint64_t *trend_free, zbx_uint64_t *trend_total, zbx_uint64_t *trend_upserted)
+{
+	/* trend cache exists only on server */
+	if (0 == (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
+	{
+		*trend_free = *trend_total = *trend_upserted = 0;
+		return;
+	}
+
+	LOCK_TRENDS;
+
+	*trend_free = trend_mem->free_size;
+	*trend_total = trend_mem->orig_size;
+	*trend_upserted = cache->trends_upserted;
+
+	UNLOCK_TRENDS;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds bulk copy statistics of the current process to the history   *
+ *          cache statistics                                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_update_copy_stats(void)
+{
+	zbx_uint64_t	rows;
+	double		time_spent;
+
+	zbx_db_get_copy_stats(&rows, &time_spent);
+
+	if (0 == rows)
+		return;
+
+	LOCK_CACHE_STATS;
+
+	cache->copy_rows += rows;
+	cache->copy_time += time_spent;
+
+	UNLOCK_CACHE_STATS;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds global event correlation statistics of the current process   *
+ *          to the history cache statistics                                   *
+ *                                                                            *
+ * Parameters: corr_stats - [IN] the correlation statistics, the number of    *
+ *                               open problems replaces the cached value      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_update_corr_stats(const zbx_dc_corr_stats_t *corr_stats)
+{
+	LOCK_CACHE_STATS;
+
+	cache->corr_stats.events += corr_stats->events;
+	cache->corr_stats.rules += corr_stats->rules;
+	cache->corr_stats.rules_skipped += corr_stats->rules_skipped;
+	cache->corr_stats.problems_checked += corr_stats->problems_checked;
+	cache->corr_stats.matches += corr_stats->matches;
+	cache->corr_stats.problems = corr_stats->problems;
+	cache->corr_stats.problems_loaded += corr_stats->problems_loaded;
+
+	UNLOCK_CACHE_STATS;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets queue depth and latency of history sync and trigger          *
+ *          evaluation stages                                                 *
+ *                                                                            *
+ * Parameters: history_queue     - [OUT] the number of values waiting to be   *
+ *                                       synced                               *
+ *             history_delay     - [OUT] the age of the oldest value waiting  *
+ *                                       to be synced, seconds                *
+ *             trigger_queue     - [OUT] the number of values waiting for     *
+ *                                       trigger evaluation                   *
+ *             trigger_delay     - [OUT] the wait time of the oldest item in  *
+ *                                       trigger queue, seconds               *
+ *             trigger_processed - [OUT] the number of values with evaluated  *
+ *                                       triggers                             *
+ *             trigger_wait      - [OUT] the average value wait time in       *
+ *                                       trigger queue, seconds               *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_get_queue_stats(zbx_uint64_t *history_queue, double *history_delay, zbx_uint64_t *trigger_queue,
+		double *trigger_delay, zbx_uint64_t *trigger_processed, double *trigger_wait)
+{
+	int			i;
+	double			now;
+	zbx_timespec_t		ts;
+	zbx_binary_heap_elem_t	*elem;
+
+	now = zbx_time();
+	*history_queue = 0;
+	*history_delay = 0;
+
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+		double		delay;
+
+		hc_shard_lock(shard);
+
+		*history_queue += (zbx_uint64_t)shard->history_num;
+
+		if (FAIL == zbx_binary_heap_empty(&shard->history_queue))
+		{
+			elem = zbx_binary_heap_find_min(&shard->history_queue);
+			ts = ((const zbx_hc_item_t *)elem->data)->tail->ts;
+
+			if (*history_delay < (delay = now - ts.sec - ts.ns / 1e9))
+				*history_delay = delay;
+		}
+
+		hc_shard_unlock(shard);
+	}
+
+	*trigger_queue = 0;
+	*trigger_processed = 0;
+	*trigger_wait = 0;
+	*trigger_delay = 0;
+
+	/* trigger queue exists only when triggers are evaluated by trigger evaluators */
+	if (0 == cache->trigger_evaluators)
+		return;
+
+	LOCK_TRIGGER_QUEUE;
+
+	*trigger_queue = (zbx_uint64_t)cache->triggerqueue.values_num;
+	*trigger_processed = cache->triggerqueue.processed;
+	*trigger_wait = (0 != cache->triggerqueue.processed ?
+			cache->triggerqueue.wait / (double)cache->triggerqueue.processed : 0);
+
+	if (0 != cache->triggerqueue.queue.elems_num)
+	{
+		elem = zbx_binary_heap_find_min(&cache->triggerqueue.queue);
+		*trigger_delay = now - ((const zbx_hc_trigger_item_t *)elem->data)->tail->time_queued;
+	}
+
+	UNLOCK_TRIGGER_QUEUE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the number of values in history cache                     *
+ *                                                                            *
+ * Comments: The history cache shards must be locked or other processes must  *
+ *           be already terminated.                                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_get_history_num(void)
+{
+	int	i, history_num = 0;
+
+	for (i = 0; i < cache->shards_num; i++)
+		history_num += cache->shards[i].history_num;
+
+	return history_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the number of values and items in history cache, locking  *
+ *          history cache shards one at a time                                *
+ *                                                                            *
+ * Parameters: values_num - [OUT] the number of values                        *
+ *             items_num  - [OUT] the number of items, optional               *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_count_history(int *values_num, int *items_num)
+{
+	int	i;
+
+	*values_num = 0;
+
+	if (NULL != items_num)
+		*items_num = 0;
+
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+
+		hc_shard_lock(shard);
+
+		*values_num += shard->history_num;
+
+		if (NULL != items_num)
+			*items_num += shard->history_items.num_data;
+
+		hc_shard_unlock(shard);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieves all internal metrics of the database cache              *
+ *                                                                            *
+ * Parameters: stats - [OUT] write cache metrics                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_stats_all(zbx_wcache_info_t *wcache_info)
+{
+	hc_get_shard_stats(&wcache_info->stats, &wcache_info->history_free, &wcache_info->history_total,
+			&wcache_info->index_free, &wcache_info->index_total, &wcache_info->history_lock_wait);
+
+	hc_get_queue_stats(&wcache_info->history_queue, &wcache_info->history_delay, &wcache_info->trigger_queue,
+			&wcache_info->trigger_delay, &wcache_info->trigger_processed, &wcache_info->trigger_wait);
+	hc_get_global_stats(&wcache_info->history_copied, &wcache_info->history_copy_rate, &wcache_info->corr_stats);
+	hc_get_trend_stats(&wcache_info->trend_free, &wcache_info->trend_total, &wcache_info->trend_upserted);
 }
 
 /******************************************************************************
@@ -221,111 +596,185 @@ void	*zbx_dc_get_stats(int request)
 	static zbx_uint64_t	value_uint;
 	static double		value_double;
 	void			*ret;
+	zbx_dc_stats_t		stats;
+	zbx_dc_corr_stats_t	corr_stats;
+	zbx_uint64_t		history_free, history_total, index_free, index_total, history_queue, trigger_queue,
+				trigger_processed, copied, trend_free, trend_total, trend_upserted;
+	double			lock_wait, history_delay, trigger_delay, trigger_wait, copy_rate;
 
-	LOCK_CACHE;
+	hc_get_shard_stats(&stats, &history_free, &history_total, &index_free, &index_total, &lock_wait);
+	hc_get_queue_stats(&history_queue, &history_delay, &trigger_queue, &trigger_delay, &trigger_processed,
+			&trigger_wait);
+	hc_get_global_stats(&copied, &copy_rate, &corr_stats);
+	hc_get_trend_stats(&trend_free, &trend_total, &trend_upserted);
 
 	switch (request)
 	{
 		case ZBX_STATS_HISTORY_COUNTER:
-			value_uint = cache->stats.history_counter;
+			value_uint = stats.history_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FLOAT_COUNTER:
-			value_uint = cache->stats.history_float_counter;
+			value_uint = stats.history_float_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_UINT_COUNTER:
-			value_uint = cache->stats.history_uint_counter;
+			value_uint = stats.history_uint_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_STR_COUNTER:
-			value_uint = cache->stats.history_str_counter;
+			value_uint = stats.history_str_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_LOG_COUNTER:
-			value_uint = cache->stats.history_log_counter;
+			value_uint = stats.history_log_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TEXT_COUNTER:
-			value_uint = cache->stats.history_text_counter;
+			value_uint = stats.history_text_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_NOTSUPPORTED_COUNTER:
-			value_uint = cache->stats.notsupported_counter;
+			value_uint = stats.notsupported_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TOTAL:
-			value_uint = hc_mem->total_size;
+			value_uint = history_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_USED:
-			value_uint = hc_mem->total_size - hc_mem->free_size;
+			value_uint = history_total - history_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FREE:
-			value_uint = hc_mem->free_size;
+			value_uint = history_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_PUSED:
-			value_double = 100 * (double)(hc_mem->total_size - hc_mem->free_size) / hc_mem->total_size;
+			value_double = 100 * (double)(history_total - history_free) / history_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_PFREE:
-			value_double = 100 * (double)hc_mem->free_size / hc_mem->total_size;
+			value_double = 100 * (double)history_free / history_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_TREND_TOTAL:
-			value_uint = trend_mem->orig_size;
+			value_uint = trend_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_TREND_USED:
-			value_uint = trend_mem->orig_size - trend_mem->free_size;
+			value_uint = trend_total - trend_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_TREND_FREE:
-			value_uint = trend_mem->free_size;
+			value_uint = trend_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_TREND_PUSED:
-			value_double = 100 * (double)(trend_mem->orig_size - trend_mem->free_size) /
-					trend_mem->orig_size;
+			value_double = 100 * (double)(trend_total - trend_free) / trend_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_TREND_PFREE:
-			value_double = 100 * (double)trend_mem->free_size / trend_mem->orig_size;
+			value_double = 100 * (double)trend_free / trend_total;
 			ret = (void *)&value_double;
 			break;
+		case ZBX_STATS_TREND_UPSERTED:
+			value_uint = trend_upserted;
+			ret = (void *)&value_uint;
+			break;
 		case ZBX_STATS_HISTORY_INDEX_TOTAL:
-			value_uint = hc_index_mem->total_size;
+			value_uint = index_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_USED:
-			value_uint = hc_index_mem->total_size - hc_index_mem->free_size;
+			value_uint = index_total - index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_FREE:
-			value_uint = hc_index_mem->free_size;
+			value_uint = index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PUSED:
-			value_double = 100 * (double)(hc_index_mem->total_size - hc_index_mem->free_size) /
-					hc_index_mem->total_size;
+			value_double = 100 * (double)(index_total - index_free) /
+					index_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PFREE:
-			value_double = 100 * (double)hc_index_mem->free_size / hc_index_mem->total_size;
+			value_double = 100 * (double)index_free / index_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_BIN_COUNTER:
-			value_uint = cache->stats.history_bin_counter;
+			value_uint = stats.history_bin_counter;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_HISTORY_LOCK_WAIT:
+			value_double = lock_wait;
+			ret = (void *)&value_double;
+			break;
+		case ZBX_STATS_HISTORY_QUEUE:
+			value_uint = history_queue;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_HISTORY_DELAY:
+			value_double = history_delay;
+			ret = (void *)&value_double;
+			break;
+		case ZBX_STATS_TRIGGER_QUEUE:
+			value_uint = trigger_queue;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_TRIGGER_DELAY:
+			value_double = trigger_delay;
+			ret = (void *)&value_double;
+			break;
+		case ZBX_STATS_TRIGGER_PROCESSED:
+			value_uint = trigger_processed;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_TRIGGER_WAIT:
+			value_double = trigger_wait;
+			ret = (void *)&value_double;
+			break;
+		case ZBX_STATS_HISTORY_COPIED:
+			value_uint = copied;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_HISTORY_COPY_RATE:
+			value_double = copy_rate;
+			ret = (void *)&value_double;
+			break;
+		case ZBX_STATS_CORR_EVENTS:
+			value_uint = corr_stats.events;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_CORR_RULES:
+			value_uint = corr_stats.rules;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_CORR_RULES_SKIPPED:
+			value_uint = corr_stats.rules_skipped;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_CORR_PROBLEMS_CHECKED:
+			value_uint = corr_stats.problems_checked;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_CORR_MATCHES:
+			value_uint = corr_stats.matches;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_CORR_PROBLEMS:
+			value_uint = corr_stats.problems;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_CORR_PROBLEMS_LOADED:
+			value_uint = corr_stats.problems_loaded;
 			ret = (void *)&value_uint;
 			break;
 		default:
 			ret = NULL;
 	}
 
-	UNLOCK_CACHE;
-
 	return ret;
 }
 
@@ -375,6 +824,133 @@ static void	DCupdate_trends(zbx_vector_uint64_pair_t *trends_diff)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: completes trends upsert statement with the merge clause and       *
+ *          executes it                                                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_trends_upsert_execute(unsigned char value_type, const char *table_name, size_t *sql_offset)
+{
+#if defined(HAVE_POSTGRESQL)
+	zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset, " on conflict (itemid,clock) do update set value_avg=");
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		zbx_snprintf_alloc(&sql, &sql_alloc, sql_offset,
+				"(%s.value_avg*%s.num+excluded.value_avg*excluded.num)/(%s.num+excluded.num)",
+				table_name, table_name, table_name);
+	}
+	else
+	{
+		zbx_snprintf_alloc(&sql, &sql_alloc, sql_offset,
+				"div(%s.value_avg*%s.num+excluded.value_avg*excluded.num,%s.num+excluded.num)",
+				table_name, table_name, table_name);
+	}
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, sql_offset, ",value_min=least(%s.value_min,excluded.value_min)"
+			",value_max=greatest(%s.value_max,excluded.value_max),num=%s.num+excluded.num",
+			table_name, table_name, table_name);
+#else
+	/* MySQL evaluates assignments left to right, so value_avg must be updated before num */
+	zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset, " on duplicate key update value_avg=");
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+				"(value_avg*num+values(value_avg)*values(num))/(num+values(num))");
+	}
+	else
+	{
+		/* avoid bigint overflow when multiplying average by number of values */
+		zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+				"floor((cast(value_avg as decimal(40,0))*num+"
+				"cast(values(value_avg) as decimal(40,0))*values(num))/(num+values(num)))");
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset, ",value_min=least(value_min,values(value_min))"
+			",value_max=greatest(value_max,values(value_max)),num=num+values(num)");
+	ZBX_UNUSED(table_name);
+#endif
+	zbx_db_execute("%s", sql);
+
+	*sql_offset = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: helper function for DCflush trends, merges trends with the        *
+ *          existing database rows using batched upsert statements            *
+ *                                                                            *
+ * Return value: the number of upserted trends                                *
+ *                                                                            *
+ * Comments: Replaces selecting the existing rows and updating them one by    *
+ *           one - num/min/avg/max are merged by database server.             *
+ *                                                                            *
+ ******************************************************************************/
+static int	dc_upsert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, unsigned char value_type,
+		const char *table_name, int clock)
+{
+#define ZBX_TRENDS_UPSERT_BATCH	1000
+	ZBX_DC_TREND	*trend;
+	int		i, rows_num = 0, upserted_num = 0;
+	size_t		sql_offset = 0;
+
+	for (i = 0; i < trends_num; i++)
+	{
+		trend = &trends[i];
+
+		if (0 == trend->itemid)
+			continue;
+
+		if (clock != trend->clock || value_type != trend->value_type)
+			continue;
+
+		if (0 == rows_num)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "insert into %s"
+					" (itemid,clock,num,value_min,value_avg,value_max) values ", table_name);
+		}
+		else
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "(" ZBX_FS_UI64 ",%d,%d," ZBX_FS_DBL64_SQL ","
+					ZBX_FS_DBL64_SQL "," ZBX_FS_DBL64_SQL ")", trend->itemid, trend->clock,
+					trend->num, trend->value_min.dbl, trend->value_avg.dbl, trend->value_max.dbl);
+		}
+		else
+		{
+			zbx_uint128_t	avg;
+
+			/* calculate the trend average value */
+			zbx_udiv128_64(&avg, &trend->value_avg.ui64, trend->num);
+
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "(" ZBX_FS_UI64 ",%d,%d," ZBX_FS_UI64 ","
+					ZBX_FS_UI64 "," ZBX_FS_UI64 ")", trend->itemid, trend->clock, trend->num,
+					trend->value_min.ui64, avg.lo, trend->value_max.ui64);
+		}
+
+		trend->itemid = 0;
+		upserted_num++;
+
+		if (ZBX_TRENDS_UPSERT_BATCH == ++rows_num)
+		{
+			dc_trends_upsert_execute(value_type, table_name, &sql_offset);
+			rows_num = 0;
+		}
+	}
+
+	if (0 != rows_num)
+		dc_trends_upsert_execute(value_type, table_name, &sql_offset);
+
+	return upserted_num;
+#undef ZBX_TRENDS_UPSERT_BATCH
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: helper function for DCflush trends                                *
@@ -641,38 +1217,21 @@ static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx
 
 /******************************************************************************
  *                                                                            *
- * Purpose: flush trend to the database                                       *
+ * Purpose: helper function for DCflush trends, updates trends that already   *
+ *          exist in database and inserts the rest                            *
  *                                                                            *
  ******************************************************************************/
-static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint64_pair_t *trends_diff)
+static void	dc_update_trends_in_db(ZBX_DC_TREND *trends, int trends_num, zbx_vector_uint64_pair_t *trends_diff,
+		unsigned char value_type, const char *table_name, int clock)
 {
-	int		num, i, clock, inserts_num = 0, itemids_alloc, itemids_num = 0, trends_to = *trends_num;
-	unsigned char	value_type;
+	int		i, inserts_num = 0, itemids_alloc, itemids_num = 0, trends_to = trends_num;
 	zbx_uint64_t	*itemids = NULL;
 	ZBX_DC_TREND	*trend = NULL;
-	const char	*table_name;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() trends_num:%d", __func__, *trends_num);
-
-	clock = trends[0].clock;
-	value_type = trends[0].value_type;
-
-	switch (value_type)
-	{
-		case ITEM_VALUE_TYPE_FLOAT:
-			table_name = "trends";
-			break;
-		case ITEM_VALUE_TYPE_UINT64:
-			table_name = "trends_uint";
-			break;
-		default:
-			assert(0);
-	}
-
-	itemids_alloc = MIN(ZBX_HC_SYNC_MAX, *trends_num);
+	itemids_alloc = MIN(ZBX_HC_SYNC_MAX, trends_num);
 	itemids = (zbx_uint64_t *)zbx_malloc(itemids, itemids_alloc * sizeof(zbx_uint64_t));
 
-	for (i = 0; i < *trends_num; i++)
+	for (i = 0; i < trends_num; i++)
 	{
 		trend = &trends[i];
 
@@ -731,20 +1290,63 @@ static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uin
 			if (0 == trends[i].itemid)
 				continue;
 
-			if (clock != trends[i].clock || value_type != trends[i].value_type)
-				continue;
+			if (clock != trends[i].clock || value_type != trends[i].value_type)
+				continue;
+
+			if (0 == trends[i].disable_from || trends[i].disable_from > clock)
+				continue;
+
+			pair.first = trends[i].itemid;
+			pair.second = clock + SEC_PER_HOUR;
+			zbx_vector_uint64_pair_append(trends_diff, pair);
+		}
+	}
+
+	if (0 != inserts_num)
+		dc_insert_trends_in_db(trends, trends_to, value_type, table_name, clock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: flush trend to the database                                       *
+ *                                                                            *
+ * Return value: the number of trends merged with upsert statements           *
+ *                                                                            *
+ * Comments: Upsert is used when the database server supports it, otherwise   *
+ *           the existing rows are selected and updated and the rest are      *
+ *           inserted.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint64_pair_t *trends_diff)
+{
+	int		num, i, clock, upserted_num = 0;
+	unsigned char	value_type;
+	const char	*table_name;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() trends_num:%d", __func__, *trends_num);
 
-			if (0 == trends[i].disable_from || trends[i].disable_from > clock)
-				continue;
+	clock = trends[0].clock;
+	value_type = trends[0].value_type;
 
-			pair.first = trends[i].itemid;
-			pair.second = clock + SEC_PER_HOUR;
-			zbx_vector_uint64_pair_append(trends_diff, pair);
-		}
+	switch (value_type)
+	{
+		case ITEM_VALUE_TYPE_FLOAT:
+			table_name = "trends";
+			break;
+		case ITEM_VALUE_TYPE_UINT64:
+			table_name = "trends_uint";
+			break;
+		default:
+			assert(0);
 	}
 
-	if (0 != inserts_num)
-		dc_insert_trends_in_db(trends, trends_to, value_type, table_name, clock);
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+	/* disable_from is used only to skip selecting rows that do not exist, which upsert does not need */
+	if (SUCCEED == zbx_db_upsert_supported())
+		upserted_num = dc_upsert_trends_in_db(trends, *trends_num, value_type, table_name, clock);
+	else
+#endif
+		dc_update_trends_in_db(trends, *trends_num, trends_diff, value_type, table_name, clock);
 
 	/* clean trends */
 	for (i = 0, num = 0; i < *trends_num; i++)
@@ -756,7 +1358,9 @@ static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uin
 	}
 	*trends_num = num;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() upserted:%d", __func__, upserted_num);
+
+	return upserted_num;
 }
 
 /******************************************************************************
@@ -960,14 +1564,27 @@ static void	DBmass_update_trends(const ZBX_DC_TREND *trends, int trends_num,
 
 	if (0 != trends_num)
 	{
+		int	flushed_num = trends_num, upserted_num = 0;
+		double	sec = zbx_time();
+
 		trends_tmp = (ZBX_DC_TREND *)zbx_malloc(NULL, trends_num * sizeof(ZBX_DC_TREND));
 		memcpy(trends_tmp, trends, trends_num * sizeof(ZBX_DC_TREND));
 		qsort(trends_tmp, trends_num, sizeof(ZBX_DC_TREND), zbx_trend_compare);
 
 		while (0 < trends_num)
-			DBflush_trends(trends_tmp, &trends_num, trends_diff);
+			upserted_num += DBflush_trends(trends_tmp, &trends_num, trends_diff);
 
 		zbx_free(trends_tmp);
+
+		if (0 != upserted_num)
+		{
+			LOCK_TRENDS;
+			cache->trends_upserted += (zbx_uint64_t)upserted_num;
+			UNLOCK_TRENDS;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "flushed %d trends (%d upserted) in " ZBX_FS_DBL " sec", flushed_num,
+				upserted_num, zbx_time() - sec);
 	}
 }
 
@@ -1822,12 +2439,46 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get identifiers and timestamps of items with new values for       *
+ *          trigger recalculation                                             *
+ *                                                                            *
+ * Parameters: history     - [IN] array of history data                       *
+ *             history_num - [IN] number of history structures                *
+ *             itemids     - [OUT] the item identifiers                       *
+ *             timespecs   - [OUT] timestamp for item identifiers             *
+ *                                                                            *
+ * Return value: the number of returned items                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	get_trigger_itemids(const zbx_dc_history_t *history, int history_num, zbx_uint64_t *itemids,
+		zbx_timespec_t *timespecs)
+{
+	int	i, item_num = 0;
+
+	for (i = 0; i < history_num; i++)
+	{
+		const zbx_dc_history_t	*h = &history[i];
+
+		if (0 != (ZBX_DC_FLAG_NOVALUE & h->flags))
+			continue;
+
+		itemids[item_num] = h->itemid;
+		timespecs[item_num] = h->ts;
+		item_num++;
+	}
+
+	return item_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: re-calculate and update values of triggers related to the items   *
  *                                                                            *
- * Parameters: history           - [IN] array of history data                 *
- *             history_num       - [IN] number of history structures          *
+ * Parameters: itemids           - [IN] the item identifiers, sorted          *
+ *             timespecs         - [IN] timestamp for item identifiers        *
+ *             item_num          - [IN] the number of items                   *
  *             history_itemids   - [IN] the item identifiers                  *
  *                                      (used for item lookup)                *
  *             history_items     - [IN] the items                             *
@@ -1835,38 +2486,19 @@ out:
  *             timers            - [IN] trigger timers                        *
  *             add_event_cb      - [IN]                                       *
  *             trigger_diff      - [OUT] trigger updates                      *
- *             itemids           - [OUT] the item identifiers                 *
- *                                      (used for item lookup)                *
- *             timespecs         - [OUT] timestamp for item identifiers       *
  *             trigger_info      - [OUT] triggers                             *
  *             trigger_order     - [OUT] pointer to the list of triggers      *
  *                                                                            *
  ******************************************************************************/
-static void	recalculate_triggers(const zbx_dc_history_t *history, int history_num,
+static void	recalculate_triggers(const zbx_uint64_t *itemids, const zbx_timespec_t *timespecs, int item_num,
 		const zbx_vector_uint64_t *history_itemids, const zbx_history_sync_item_t *history_items,
 		const int *history_errcodes, const zbx_vector_ptr_t *timers, zbx_add_event_func_t add_event_cb,
-		zbx_vector_ptr_t *trigger_diff, zbx_uint64_t *itemids, zbx_timespec_t *timespecs,
-		zbx_hashset_t *trigger_info, zbx_vector_ptr_t *trigger_order)
+		zbx_vector_ptr_t *trigger_diff, zbx_hashset_t *trigger_info, zbx_vector_ptr_t *trigger_order)
 {
-	int			i, item_num = 0, timers_num = 0;
+	int			i, timers_num = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	if (0 != history_num)
-	{
-		for (i = 0; i < history_num; i++)
-		{
-			const zbx_dc_history_t	*h = &history[i];
-
-			if (0 != (ZBX_DC_FLAG_NOVALUE & h->flags))
-				continue;
-
-			itemids[item_num] = h->itemid;
-			timespecs[item_num] = h->ts;
-			item_num++;
-		}
-	}
-
 	for (i = 0; i < timers->values_num; i++)
 	{
 		zbx_trigger_timer_t	*timer = (zbx_trigger_timer_t *)timers->values[i];
@@ -2648,6 +3280,7 @@ static void	dc_add_proxy_history(zbx_dc_history_t *history, int history_num)
 	now = (int)time(NULL);
 	zbx_db_insert_prepare(&db_insert, "proxy_history", "itemid", "clock", "ns", "value", "flags", "write_clock",
 			NULL);
+	zbx_db_insert_use_copy(&db_insert);
 
 	for (i = 0; i < history_num; i++)
 	{
@@ -2718,6 +3351,7 @@ static void	dc_add_proxy_history_meta(zbx_dc_history_t *history, int history_num
 	now = (int)time(NULL);
 	zbx_db_insert_prepare(&db_insert, "proxy_history", "itemid", "clock", "ns", "value", "lastlogsize", "mtime",
 			"flags", "write_clock", NULL);
+	zbx_db_insert_use_copy(&db_insert);
 
 	for (i = 0; i < history_num; i++)
 	{
@@ -2791,6 +3425,7 @@ static void	dc_add_proxy_history_log(zbx_dc_history_t *history, int history_num)
 	/* see hc_copy_history_data() for fields that might be uninitialized and need special handling here */
 	zbx_db_insert_prepare(&db_insert, "proxy_history", "itemid", "clock", "ns", "timestamp", "source", "severity",
 			"value", "logeventid", "lastlogsize", "mtime", "flags", "write_clock", NULL);
+	zbx_db_insert_use_copy(&db_insert);
 
 	for (i = 0; i < history_num; i++)
 	{
@@ -2857,6 +3492,7 @@ static void	dc_add_proxy_history_notsupported(zbx_dc_history_t *history, int his
 	now = (int)time(NULL);
 	zbx_db_insert_prepare(&db_insert, "proxy_history", "itemid", "clock", "ns", "value", "state", "write_clock",
 			NULL);
+	zbx_db_insert_use_copy(&db_insert);
 
 	for (i = 0; i < history_num; i++)
 	{
@@ -3306,7 +3942,7 @@ static void	proxy_prepare_history(zbx_dc_history_t *history, int history_num)
 
 static void	sync_proxy_history(int *total_num, int *more)
 {
-	int			history_num, txn_rc;
+	int			history_num, txn_rc, queue_size;
 	time_t			sync_start;
 	zbx_vector_ptr_t	history_items;
 	zbx_vector_ptr_t	item_diff;
@@ -3322,13 +3958,9 @@ static void	sync_proxy_history(int *total_num, int *more)
 	{
 		*more = ZBX_SYNC_DONE;
 
-		LOCK_CACHE;
-
 		hc_pop_items(&history_items);		/* select and take items out of history cache */
 		history_num = history_items.values_num;
 
-		UNLOCK_CACHE;
-
 		if (0 == history_num)
 			break;
 
@@ -3346,31 +3978,26 @@ static void	sync_proxy_history(int *total_num, int *more)
 		}
 		while (ZBX_DB_DOWN == (txn_rc = zbx_db_commit()));
 
-		LOCK_CACHE;
+		/* apply item changes before returning items to history cache, */
+		/* so the next item values are synced with updated metadata    */
+		if (ZBX_DB_FAIL != txn_rc && 0 != item_diff.values_num)
+			zbx_dc_config_items_apply_changes(&item_diff);
 
-		hc_push_items(&history_items);	/* return items to history cache */
+		/* return items to history cache */
+		queue_size = hc_push_items(&history_items);
 
 		if (ZBX_DB_FAIL != txn_rc)
 		{
-			if (0 != item_diff.values_num)
-				zbx_dc_config_items_apply_changes(&item_diff);
-
-			cache->history_num -= history_num;
-
-			if (0 != hc_queue_get_size())
+			/* a full batch means the not visited shards might have more items queued */
+			if (0 != queue_size || ZBX_HC_SYNC_MAX == history_items.values_num)
 				*more = ZBX_SYNC_MORE;
 
-			UNLOCK_CACHE;
-
 			*total_num += history_num;
 
 			hc_free_item_values(history, history_num);
 		}
 		else
-		{
 			*more = ZBX_SYNC_MORE;
-			UNLOCK_CACHE;
-		}
 
 		zbx_vector_ptr_clear(&history_items);
 		zbx_vector_ptr_clear_ext(&item_diff, zbx_default_mem_free_func);
@@ -3381,6 +4008,8 @@ static void	sync_proxy_history(int *total_num, int *more)
 	}
 	while (ZBX_SYNC_MORE == *more && ZBX_HC_SYNC_TIME_MAX >= time(NULL) - sync_start);
 
+	hc_update_copy_stats();
+
 	zbx_vector_ptr_destroy(&item_diff);
 	zbx_vector_ptr_destroy(&history_items);
 }
@@ -3418,7 +4047,7 @@ static void	sync_server_history(int *values_num, int *triggers_num,
 	static ZBX_HISTORY_LOG		*history_log;
 	static int			module_enabled = FAIL;
 	int				i, history_num, history_float_num, history_integer_num, history_string_num,
-					history_text_num, history_log_num, txn_error, compression_age,
+					history_text_num, history_log_num, txn_error, compression_age, queue_size,
 					connectors_retrieved = FAIL;
 	unsigned int			item_retrieve_mode;
 	time_t				sync_start;
@@ -3502,22 +4131,36 @@ static void	sync_server_history(int *values_num, int *triggers_num,
 
 	do
 	{
-		int			trends_num = 0, timers_num = 0, ret = SUCCEED;
+		int			trends_num = 0, timers_num = 0, ret = SUCCEED, trigger_reserved = FAIL;
 		ZBX_DC_TREND		*trends = NULL;
 
 		*more = ZBX_SYNC_DONE;
 
-		LOCK_CACHE;
-		hc_pop_items(&history_items);		/* select and take items out of history cache */
-		UNLOCK_CACHE;
+		if (0 != cache->trigger_evaluators && FAIL == (trigger_reserved = hc_trigger_queue_reserve()))
+		{
+			int	evaluated_num = 0, trigger_more;
+
+			/* help trigger evaluators to catch up instead of waiting for trigger queue space */
+			evaluate_trigger_queue(&evaluated_num, triggers_num, events_cbs, 0, &trigger_more);
+
+			if (FAIL == (trigger_reserved = hc_trigger_queue_reserve()))
+				*more = ZBX_SYNC_MORE;
+		}
+
+		if (0 == cache->trigger_evaluators || SUCCEED == trigger_reserved)
+			hc_pop_items(&history_items);	/* select and take items out of history cache */
 
 		if (0 != history_items.values_num)
 		{
-			if (0 == (history_num = zbx_dc_config_lock_triggers_by_history_items(&history_items, &triggerids)))
+			/* triggers are locked by trigger evaluators when they are evaluated outside history syncers */
+			if (0 != cache->trigger_evaluators)
+			{
+				history_num = history_items.values_num;
+			}
+			else if (0 == (history_num = zbx_dc_config_lock_triggers_by_history_items(&history_items,
+					&triggerids)))
 			{
-				LOCK_CACHE;
 				hc_push_items(&history_items);
-				UNLOCK_CACHE;
 				zbx_vector_ptr_clear(&history_items);
 			}
 		}
@@ -3598,6 +4241,11 @@ static void	sync_server_history(int *values_num, int *triggers_num,
 					zbx_vector_uint64_pair_clear(&trends_diff);
 				}
 				while (ZBX_DB_DOWN == txn_error);
+
+				/* queue values for trigger evaluation before returning items to history cache, */
+				/* so the values of the same item are queued in the order they were received     */
+				if (0 != cache->trigger_evaluators)
+					hc_queue_trigger_values(history, history_num, &itemids);
 			}
 
 			zbx_dc_close_user_macros(um_handle);
@@ -3609,7 +4257,7 @@ static void	sync_server_history(int *values_num, int *triggers_num,
 			zbx_vector_ptr_clear_ext(&item_diff, (zbx_clean_func_t)zbx_ptr_free);
 		}
 
-		if (FAIL != ret)
+		if (FAIL != ret && 0 == cache->trigger_evaluators)
 		{
 			/* don't process trigger timers when server is shutting down */
 			if (ZBX_IS_RUNNING())
@@ -3625,6 +4273,8 @@ static void	sync_server_history(int *values_num, int *triggers_num,
 
 			if (0 != history_num || 0 != timers_num)
 			{
+				int	trigger_item_num;
+
 				for (i = 0; i < trigger_timers.values_num; i++)
 				{
 					zbx_trigger_timer_t	*timer = (zbx_trigger_timer_t *)trigger_timers.values[i];
@@ -3633,14 +4283,16 @@ static void	sync_server_history(int *values_num, int *triggers_num,
 						zbx_vector_uint64_append(&triggerids, timer->triggerid);
 				}
 
+				trigger_item_num = get_trigger_itemids(history, history_num, trigger_itemids,
+						trigger_timespecs);
+
 				do
 				{
 					zbx_db_begin();
 
-					recalculate_triggers(history, history_num, &itemids, items, errcodes,
-							&trigger_timers, events_cbs->add_event_cb, &trigger_diff,
-							trigger_itemids,
-							trigger_timespecs, &trigger_info, &trigger_order);
+					recalculate_triggers(trigger_itemids, trigger_timespecs, trigger_item_num, &itemids,
+							items, errcodes, &trigger_timers, events_cbs->add_event_cb,
+							&trigger_diff, &trigger_info, &trigger_order);
 
 					if (NULL != events_cbs->process_events_cb)
 					{
@@ -3688,11 +4340,11 @@ static void	sync_server_history(int *values_num, int *triggers_num,
 
 		if (0 != history_num)
 		{
-			LOCK_CACHE;
-			hc_push_items(&history_items);	/* return items to history cache */
-			cache->history_num -= history_num;
+			/* return items to history cache */
+			queue_size = hc_push_items(&history_items);
 
-			if (0 != hc_queue_get_size())
+			/* a full batch means the not visited shards might have more items queued */
+			if (0 != queue_size || ZBX_HC_SYNC_MAX == history_items.values_num)
 			{
 				/* Continue sync if enough of sync candidates were processed       */
 				/* (meaning most of sync candidates are not locked by triggers).   */
@@ -3703,8 +4355,6 @@ static void	sync_server_history(int *values_num, int *triggers_num,
 					*more = ZBX_SYNC_MORE;
 			}
 
-			UNLOCK_CACHE;
-
 			*values_num += history_num;
 		}
 
@@ -3806,6 +4456,9 @@ static void	sync_server_history(int *values_num, int *triggers_num,
 			hc_free_item_values(history, history_num);
 		}
 
+		if (SUCCEED == trigger_reserved)
+			hc_trigger_queue_release();
+
 		zbx_vector_uint64_clear(&itemids);
 
 		/* Exit from sync loop if we have spent too much time here.       */
@@ -3813,6 +4466,8 @@ static void	sync_server_history(int *values_num, int *triggers_num,
 	}
 	while (ZBX_SYNC_MORE == *more && ZBX_HC_SYNC_TIME_MAX >= time(NULL) - sync_start);
 
+	hc_update_copy_stats();
+
 	zbx_free(items);
 	zbx_free(errcodes);
 	zbx_free(data);
@@ -3836,6 +4491,270 @@ static void	sync_server_history(int *values_num, int *triggers_num,
 	zbx_vector_uint64_destroy(&triggerids);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluate triggers of the values queued by history syncers and     *
+ *          timer triggers from timer queue                                   *
+ *                                                                            *
+ * Parameters:                                                                *
+ *             values_num    - [IN/OUT] the number of evaluated values        *
+ *             triggers_num  - [IN/OUT] the number of processed triggers      *
+ *             events_cbs    - [IN]                                           *
+ *             sync_time_max - [IN] the maximum time to spend evaluating      *
+ *                                  values, 0 - evaluate a single batch       *
+ *             more          - [OUT] a flag indicating the queue emptiness:   *
+ *                                ZBX_SYNC_DONE - nothing to do, go idle      *
+ *                                ZBX_SYNC_MORE - more values to evaluate     *
+ *                                                                            *
+ * Comments: This function is used by trigger evaluators, when triggers are   *
+ *           evaluated outside history syncers. Values are taken from trigger *
+ *           queue by 1k batches, one value per item in each batch, so        *
+ *           triggers are evaluated for item values in the order the values   *
+ *           were received. Triggers are processed in topological order.      *
+ *           History syncers also use it to evaluate a batch of queued values *
+ *           when trigger queue is full.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	evaluate_trigger_queue(int *values_num, int *triggers_num, const zbx_events_funcs_t *events_cbs,
+		int sync_time_max, int *more)
+{
+	int				i, txn_error, event_export_enabled;
+	time_t				sync_start;
+	zbx_vector_uint64_t		triggerids, history_itemids;
+	zbx_vector_ptr_t		trigger_items, trigger_diff, trigger_timers, trigger_order;
+	zbx_uint64_t			trigger_itemids[ZBX_HC_SYNC_MAX];
+	zbx_timespec_t			trigger_timespecs[ZBX_HC_SYNC_MAX];
+	int				errcodes[ZBX_HC_SYNC_MAX];
+	zbx_hashset_t			trigger_info;
+	unsigned char			*data = NULL;
+	size_t				data_alloc = 0, data_offset;
+	zbx_vector_connector_filter_t	connector_filters_history, connector_filters_events;
+
+	zbx_vector_connector_filter_create(&connector_filters_history);
+	zbx_vector_connector_filter_create(&connector_filters_events);
+	zbx_vector_ptr_create(&trigger_diff);
+
+	zbx_vector_uint64_create(&triggerids);
+	zbx_vector_uint64_reserve(&triggerids, ZBX_HC_SYNC_MAX);
+
+	zbx_vector_ptr_create(&trigger_timers);
+	zbx_vector_ptr_reserve(&trigger_timers, ZBX_HC_TIMER_MAX);
+
+	zbx_vector_ptr_create(&trigger_items);
+	zbx_vector_ptr_reserve(&trigger_items, ZBX_HC_SYNC_MAX);
+
+	zbx_vector_ptr_create(&trigger_order);
+	zbx_hashset_create(&trigger_info, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	/* the evaluated items are not synced here, trigger functions will retrieve them from configuration cache */
+	zbx_vector_uint64_create(&history_itemids);
+
+	zbx_dc_config_history_sync_get_connector_filters(&connector_filters_history, &connector_filters_events);
+
+	sync_start = time(NULL);
+
+	do
+	{
+		int	item_num = 0, timers_num;
+
+		*more = ZBX_SYNC_DONE;
+
+		hc_pop_trigger_items(&trigger_items);
+
+		if (0 != trigger_items.values_num)
+		{
+			zbx_vector_ptr_sort(&trigger_items, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+
+			for (i = 0; i < trigger_items.values_num; i++)
+				trigger_itemids[i] = ((zbx_hc_trigger_item_t *)trigger_items.values[i])->itemid;
+
+			zbx_dc_config_lock_triggers_by_itemids(trigger_itemids, errcodes, trigger_items.values_num,
+					&triggerids);
+
+			/* we don't need to lock the cache because no other processes can change */
+			/* item's oldest value until it is pushed back to trigger queue           */
+			for (i = 0; i < trigger_items.values_num; i++)
+			{
+				zbx_hc_trigger_item_t	*item = (zbx_hc_trigger_item_t *)trigger_items.values[i];
+
+				if (SUCCEED != errcodes[i])
+				{
+					item->status = ZBX_HC_ITEM_STATUS_BUSY;
+					continue;
+				}
+
+				trigger_itemids[item_num] = item->itemid;
+				trigger_timespecs[item_num] = item->tail->ts;
+				item_num++;
+			}
+		}
+
+		/* don't process trigger timers when server is shutting down */
+		if (ZBX_IS_RUNNING())
+			zbx_dc_get_trigger_timers(&trigger_timers, time(NULL), ZBX_HC_TIMER_SOFT_MAX, ZBX_HC_TIMER_MAX);
+
+		timers_num = trigger_timers.values_num;
+
+		if (ZBX_HC_TIMER_SOFT_MAX <= timers_num)
+			*more = ZBX_SYNC_MORE;
+
+		if (0 != item_num || 0 != timers_num)
+		{
+			for (i = 0; i < trigger_timers.values_num; i++)
+			{
+				zbx_trigger_timer_t	*timer = (zbx_trigger_timer_t *)trigger_timers.values[i];
+
+				if (0 != timer->lock)
+					zbx_vector_uint64_append(&triggerids, timer->triggerid);
+			}
+
+			do
+			{
+				zbx_db_begin();
+
+				recalculate_triggers(trigger_itemids, trigger_timespecs, item_num, &history_itemids, NULL,
+						NULL, &trigger_timers, events_cbs->add_event_cb, &trigger_diff,
+						&trigger_info, &trigger_order);
+
+				if (NULL != events_cbs->process_events_cb)
+				{
+					/* process trigger events generated by recalculate_triggers() */
+					events_cbs->process_events_cb(&trigger_diff, &triggerids);
+				}
+
+				if (0 != trigger_diff.values_num)
+					zbx_db_save_trigger_changes(&trigger_diff);
+
+				if (ZBX_DB_OK == (txn_error = zbx_db_commit()))
+					zbx_dc_config_triggers_apply_changes(&trigger_diff);
+				else if (NULL != events_cbs->clean_events_cb)
+					events_cbs->clean_events_cb();
+
+				zbx_vector_ptr_clear_ext(&trigger_diff, (zbx_clean_func_t)zbx_trigger_diff_free);
+			}
+			while (ZBX_DB_DOWN == txn_error);
+
+			if (ZBX_DB_OK == txn_error && NULL != events_cbs->events_update_itservices_cb)
+				events_cbs->events_update_itservices_cb();
+
+			if (SUCCEED == (event_export_enabled = zbx_is_export_enabled(ZBX_FLAG_EXPTYPE_EVENTS)) ||
+					0 != connector_filters_events.values_num)
+			{
+				data_offset = 0;
+
+				if (NULL != events_cbs->export_events_cb)
+				{
+					events_cbs->export_events_cb(event_export_enabled, &connector_filters_events,
+							&data, &data_alloc, &data_offset);
+				}
+
+				if (0 != data_offset)
+				{
+					zbx_connector_send(ZBX_IPC_CONNECTOR_REQUEST, data,
+							(zbx_uint32_t)data_offset);
+				}
+			}
+
+			if (NULL != events_cbs->clean_events_cb)
+				events_cbs->clean_events_cb();
+		}
+
+		if (0 != triggerids.values_num)
+		{
+			*triggers_num += triggerids.values_num;
+			zbx_dc_config_unlock_triggers(&triggerids);
+			zbx_vector_uint64_clear(&triggerids);
+		}
+
+		if (0 != trigger_timers.values_num)
+		{
+			zbx_dc_reschedule_trigger_timers(&trigger_timers, time(NULL));
+			zbx_vector_ptr_clear(&trigger_timers);
+		}
+
+		if (0 != trigger_items.values_num)
+		{
+			/* Continue if enough of the taken items were processed, otherwise */
+			/* wait a bit for other evaluators to unlock the triggers.         */
+			if (0 != hc_push_trigger_items(&trigger_items) &&
+					ZBX_HC_SYNC_MIN_PCNT <= item_num * 100 / trigger_items.values_num)
+			{
+				*more = ZBX_SYNC_MORE;
+			}
+
+			*values_num += item_num;
+			zbx_vector_ptr_clear(&trigger_items);
+		}
+	}
+	while (ZBX_SYNC_MORE == *more && 0 != sync_time_max && sync_time_max >= time(NULL) - sync_start);
+
+	zbx_free(data);
+
+	zbx_vector_connector_filter_clear_ext(&connector_filters_events, zbx_connector_filter_free);
+	zbx_vector_connector_filter_clear_ext(&connector_filters_history, zbx_connector_filter_free);
+	zbx_vector_connector_filter_destroy(&connector_filters_events);
+	zbx_vector_connector_filter_destroy(&connector_filters_history);
+	zbx_vector_uint64_destroy(&history_itemids);
+	zbx_vector_ptr_destroy(&trigger_order);
+	zbx_hashset_destroy(&trigger_info);
+	zbx_vector_ptr_destroy(&trigger_items);
+	zbx_vector_ptr_destroy(&trigger_timers);
+	zbx_vector_ptr_destroy(&trigger_diff);
+	zbx_vector_uint64_destroy(&triggerids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates triggers of all values in trigger queue                 *
+ *                                                                            *
+ * Comments: This function is used to flush trigger queue at server exit.     *
+ *           Other processes are already terminated, so cache locking is      *
+ *           unnecessary.                                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	sync_trigger_queue_full(const zbx_events_funcs_t *events_cbs)
+{
+	int			values_num = 0, triggers_num = 0, more;
+	zbx_hashset_iter_t	iter;
+	zbx_hc_trigger_item_t	*item;
+	zbx_binary_heap_t	tmp_trigger_queue;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() values_num:%d", __func__, cache->triggerqueue.values_num);
+
+	/* Trigger evaluators might have been stopped while processing items taken out of trigger queue.   */
+	/* Same as with history queue replace the shared-memory trigger queue with heap-allocated one and  */
+	/* add all items from trigger queue index to it.                                                    */
+	tmp_trigger_queue = cache->triggerqueue.queue;
+
+	zbx_binary_heap_create(&cache->triggerqueue.queue, hc_trigger_queue_elem_compare_func,
+			ZBX_BINARY_HEAP_OPTION_EMPTY);
+	zbx_hashset_iter_reset(&cache->triggerqueue.items, &iter);
+
+	while (NULL != (item = (zbx_hc_trigger_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+		hc_queue_trigger_item(item);
+	}
+
+	if (0 != cache->triggerqueue.queue.elems_num)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "evaluating queued triggers...");
+
+		do
+		{
+			evaluate_trigger_queue(&values_num, &triggers_num, events_cbs, ZBX_HC_SYNC_TIME_MAX, &more);
+		}
+		while (0 != cache->triggerqueue.queue.elems_num);
+
+		zabbix_log(LOG_LEVEL_WARNING, "evaluating queued triggers done");
+	}
+
+	zbx_binary_heap_destroy(&cache->triggerqueue.queue);
+	cache->triggerqueue.queue = tmp_trigger_queue;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: writes updates and new data from history cache to database        *
@@ -3848,12 +4767,12 @@ static void	sync_server_history(int *values_num, int *triggers_num,
  ******************************************************************************/
 static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 {
-	int			values_num = 0, triggers_num = 0, more;
+	int			values_num = 0, triggers_num = 0, more, i;
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
-	zbx_binary_heap_t	tmp_history_queue;
+	zbx_binary_heap_t	tmp_history_queue[ZBX_HC_SHARDS_MAX];
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, hc_get_history_num());
 
 	/* History index cache might be full without any space left for queueing items from history index to  */
 	/* history queue. The solution: replace the shared-memory history queue with heap-allocated one. Add  */
@@ -3870,20 +4789,33 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 	{
 		/* unlock all triggers before full sync so no items are locked by triggers */
 		zbx_dc_config_unlock_all_triggers();
+
+		/* trigger evaluators are stopped, evaluate the queued values and the remaining history here */
+		if (0 != cache->trigger_evaluators)
+		{
+			sync_trigger_queue_full(events_cbs);
+			cache->trigger_evaluators = 0;
+		}
 	}
 
-	tmp_history_queue = cache->history_queue;
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
 
-	zbx_binary_heap_create(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
+		tmp_history_queue[i] = shard->history_queue;
 
-	/* add all items from history index to the new history queue */
-	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL != item->tail)
+		zbx_binary_heap_create(&shard->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY);
+		zbx_hashset_iter_reset(&shard->history_items, &iter);
+
+		/* add all items from history index to the new history queue */
+		while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
 		{
-			item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-			hc_queue_item(item);
+			if (NULL != item->tail)
+			{
+				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+				hc_queue_item(shard, item);
+			}
 		}
 	}
 
@@ -3899,15 +4831,18 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 				sync_proxy_history(&values_num, &more);
 
 			zabbix_log(LOG_LEVEL_WARNING, "syncing history data... " ZBX_FS_DBL "%%",
-					(double)values_num / (cache->history_num + values_num) * 100);
+					(double)values_num / (hc_get_history_num() + values_num) * 100);
 		}
 		while (0 != hc_queue_get_size());
 
 		zabbix_log(LOG_LEVEL_WARNING, "syncing history data done");
 	}
 
-	zbx_binary_heap_destroy(&cache->history_queue);
-	cache->history_queue = tmp_history_queue;
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_binary_heap_destroy(&cache->shards[i].history_queue);
+		cache->shards[i].history_queue = tmp_history_queue[i];
+	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -3920,7 +4855,9 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 void	zbx_log_sync_history_cache_progress(void)
 {
 	double		pcnt = -1.0;
-	int		ts_last, ts_next, sec;
+	int		ts_last, ts_next, sec, history_num;
+
+	hc_count_history(&history_num, NULL);
 
 	LOCK_CACHE;
 
@@ -3935,16 +4872,16 @@ void	zbx_log_sync_history_cache_progress(void)
 
 	if (0 == cache->history_progress_ts)
 	{
-		cache->history_num_total = cache->history_num;
+		cache->history_num_total = history_num;
 		cache->history_progress_ts = sec;
 	}
 
-	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == cache->history_num)
+	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == history_num)
 	{
 		if (0 != cache->history_num_total)
-			pcnt = 100 * (double)(cache->history_num_total - cache->history_num) / cache->history_num_total;
+			pcnt = 100 * (double)(cache->history_num_total - history_num) / cache->history_num_total;
 
-		cache->history_progress_ts = (0 == cache->history_num ? INT_MAX : sec);
+		cache->history_progress_ts = (0 == history_num ? INT_MAX : sec);
 	}
 
 	ts_next = cache->history_progress_ts;
@@ -3976,7 +4913,7 @@ void	zbx_log_sync_history_cache_progress(void)
  ******************************************************************************/
 void	zbx_sync_history_cache(const zbx_events_funcs_t *events_cbs, int *values_num, int *triggers_num, int *more)
 {
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, hc_get_history_num());
 
 	*values_num = 0;
 	*triggers_num = 0;
@@ -3987,6 +4924,30 @@ void	zbx_sync_history_cache(const zbx_events_funcs_t *events_cbs, int *values_nu
 		sync_proxy_history(values_num, more);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates triggers of the values queued by history syncers        *
+ *                                                                            *
+ * Parameters:                                                                *
+ *             events_cbs   - [IN]                                            *
+ *             values_num   - [OUT] the number of evaluated values            *
+ *             triggers_num - [OUT] the number of processed triggers          *
+ *             more         - [OUT] a flag indicating the queue emptiness:    *
+ *                                ZBX_SYNC_DONE - nothing to do, go idle      *
+ *                                ZBX_SYNC_MORE - more values to evaluate     *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_evaluate_trigger_queue(const zbx_events_funcs_t *events_cbs, int *values_num, int *triggers_num,
+		int *more)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() values_num:%d", __func__, cache->triggerqueue.values_num);
+
+	*values_num = 0;
+	*triggers_num = 0;
+
+	evaluate_trigger_queue(values_num, triggers_num, events_cbs, ZBX_HC_SYNC_TIME_MAX, more);
+}
+
 /******************************************************************************
  *                                                                            *
  * local history cache                                                        *
@@ -4488,14 +5449,8 @@ void	zbx_dc_flush_history(void)
 	if (0 == item_values_num)
 		return;
 
-	LOCK_CACHE;
-
 	hc_add_item_values(item_values, item_values_num);
 
-	cache->history_num += item_values_num;
-
-	UNLOCK_CACHE;
-
 	item_values_num = 0;
 	string_values_offset = 0;
 }
@@ -4505,8 +5460,58 @@ void	zbx_dc_flush_history(void)
  * history cache storage                                                      *
  *                                                                            *
  ******************************************************************************/
-ZBX_SHMEM_FUNC_IMPL(__hc_index, hc_index_mem)
-ZBX_SHMEM_FUNC_IMPL(__hc, hc_mem)
+
+/* History index hashsets and queues keep allocator callbacks without any context, */
+/* so every shard has its own set of callbacks bound to the shard index memory.    */
+/* Item values are allocated from the shard history memory passed explicitly.      */
+#define HC_INDEX_SHMEM_FUNC_IMPL(__index)							\
+	ZBX_SHMEM_FUNC_IMPL(__hc_index_ ## __index, cache->shards[__index].index_mem)
+
+#define HC_INDEX_SHMEM_FUNCS(__index)								\
+	{__hc_index_ ## __index ## _shmem_malloc_func, __hc_index_ ## __index ## _shmem_realloc_func,	\
+	__hc_index_ ## __index ## _shmem_free_func}
+
+#if 16 != ZBX_HC_SHARDS_MAX
+#	error "history index allocators must be defined for every history cache shard"
+#endif
+
+HC_INDEX_SHMEM_FUNC_IMPL(0)
+HC_INDEX_SHMEM_FUNC_IMPL(1)
+HC_INDEX_SHMEM_FUNC_IMPL(2)
+HC_INDEX_SHMEM_FUNC_IMPL(3)
+HC_INDEX_SHMEM_FUNC_IMPL(4)
+HC_INDEX_SHMEM_FUNC_IMPL(5)
+HC_INDEX_SHMEM_FUNC_IMPL(6)
+HC_INDEX_SHMEM_FUNC_IMPL(7)
+HC_INDEX_SHMEM_FUNC_IMPL(8)
+HC_INDEX_SHMEM_FUNC_IMPL(9)
+HC_INDEX_SHMEM_FUNC_IMPL(10)
+HC_INDEX_SHMEM_FUNC_IMPL(11)
+HC_INDEX_SHMEM_FUNC_IMPL(12)
+HC_INDEX_SHMEM_FUNC_IMPL(13)
+HC_INDEX_SHMEM_FUNC_IMPL(14)
+HC_INDEX_SHMEM_FUNC_IMPL(15)
+
+typedef struct
+{
+	zbx_mem_malloc_func_t	malloc_func;
+	zbx_mem_realloc_func_t	realloc_func;
+	zbx_mem_free_func_t	free_func;
+}
+zbx_hc_shmem_funcs_t;
+
+static const zbx_hc_shmem_funcs_t	hc_index_funcs[ZBX_HC_SHARDS_MAX] = {
+	HC_INDEX_SHMEM_FUNCS(0), HC_INDEX_SHMEM_FUNCS(1), HC_INDEX_SHMEM_FUNCS(2), HC_INDEX_SHMEM_FUNCS(3),
+	HC_INDEX_SHMEM_FUNCS(4), HC_INDEX_SHMEM_FUNCS(5), HC_INDEX_SHMEM_FUNCS(6), HC_INDEX_SHMEM_FUNCS(7),
+	HC_INDEX_SHMEM_FUNCS(8), HC_INDEX_SHMEM_FUNCS(9), HC_INDEX_SHMEM_FUNCS(10), HC_INDEX_SHMEM_FUNCS(11),
+	HC_INDEX_SHMEM_FUNCS(12), HC_INDEX_SHMEM_FUNCS(13), HC_INDEX_SHMEM_FUNCS(14), HC_INDEX_SHMEM_FUNCS(15)
+};
+
+#undef HC_INDEX_SHMEM_FUNCS
+#undef HC_INDEX_SHMEM_FUNC_IMPL
+
+/* trigger queue has its own memory, so queueing values for trigger evaluation does not compete with history */
+ZBX_SHMEM_FUNC_IMPL(__hc_trigger, hc_trigger_mem)
 
 /******************************************************************************
  *                                                                            *
@@ -4529,14 +5534,15 @@ static int	hc_queue_elem_compare_func(const void *d1, const void *d2)
  *                                                                            *
  * Purpose: free history item data allocated in history cache                 *
  *                                                                            *
- * Parameters: data - [IN] history item data                                  *
+ * Parameters: shard - [IN] the history cache shard the data belongs to       *
+ *             data  - [IN] history item data                                 *
  *                                                                            *
  ******************************************************************************/
-static void	hc_free_data(zbx_hc_data_t *data)
+static void	hc_free_data(zbx_hc_shard_t *shard, zbx_hc_data_t *data)
 {
 	if (ITEM_STATE_NOTSUPPORTED == data->state)
 	{
-		__hc_shmem_free_func(data->value.str);
+		zbx_shmem_free(shard->mem, data->value.str);
 	}
 	else
 	{
@@ -4547,15 +5553,15 @@ static void	hc_free_data(zbx_hc_data_t *data)
 				case ITEM_VALUE_TYPE_STR:
 				case ITEM_VALUE_TYPE_TEXT:
 				case ITEM_VALUE_TYPE_BIN:
-					__hc_shmem_free_func(data->value.str);
+					zbx_shmem_free(shard->mem, data->value.str);
 					break;
 				case ITEM_VALUE_TYPE_LOG:
-					__hc_shmem_free_func(data->value.log->value);
+					zbx_shmem_free(shard->mem, data->value.log->value);
 
 					if (NULL != data->value.log->source)
-						__hc_shmem_free_func(data->value.log->source);
+						zbx_shmem_free(shard->mem, data->value.log->source);
 
-					__hc_shmem_free_func(data->value.log);
+					zbx_shmem_free(shard->mem, data->value.log);
 					break;
 				case ITEM_VALUE_TYPE_UINT64:
 				case ITEM_VALUE_TYPE_FLOAT:
@@ -4568,69 +5574,73 @@ static void	hc_free_data(zbx_hc_data_t *data)
 		}
 	}
 
-	__hc_shmem_free_func(data);
+	zbx_shmem_free(shard->mem, data);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: put back item into history queue                                  *
  *                                                                            *
- * Parameters: data - [IN] history item data                                  *
+ * Parameters: shard - [IN] the history cache shard                           *
+ *             item  - [IN] the history item                                  *
  *                                                                            *
  ******************************************************************************/
-static void	hc_queue_item(zbx_hc_item_t *item)
+static void	hc_queue_item(zbx_hc_shard_t *shard, zbx_hc_item_t *item)
 {
 	zbx_binary_heap_elem_t	elem = {item->itemid, (void *)item};
 
-	zbx_binary_heap_insert(&cache->history_queue, &elem);
+	zbx_binary_heap_insert(&shard->history_queue, &elem);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: returns history item by itemid                                    *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
+ * Parameters: shard  - [IN] the history cache shard                          *
+ *             itemid - [IN] the item id                                      *
  *                                                                            *
  * Return value: the history item or NULL if the requested item is not in     *
  *               history cache                                                *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_get_item(zbx_uint64_t itemid)
+static zbx_hc_item_t	*hc_get_item(zbx_hc_shard_t *shard, zbx_uint64_t itemid)
 {
-	return (zbx_hc_item_t *)zbx_hashset_search(&cache->history_items, &itemid);
+	return (zbx_hc_item_t *)zbx_hashset_search(&shard->history_items, &itemid);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: adds a new item to history cache                                  *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
- *                      [IN] the item data                                    *
+ * Parameters: shard  - [IN] the history cache shard                          *
+ *             itemid - [IN] the item id                                      *
+ *             data   - [IN] the item data                                    *
  *                                                                            *
  * Return value: the added history item                                       *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_add_item(zbx_uint64_t itemid, zbx_hc_data_t *data)
+static zbx_hc_item_t	*hc_add_item(zbx_hc_shard_t *shard, zbx_uint64_t itemid, zbx_hc_data_t *data)
 {
 	zbx_hc_item_t	item_local = {itemid, ZBX_HC_ITEM_STATUS_NORMAL, 0, data, data};
 
-	return (zbx_hc_item_t *)zbx_hashset_insert(&cache->history_items, &item_local, sizeof(item_local));
+	return (zbx_hc_item_t *)zbx_hashset_insert(&shard->history_items, &item_local, sizeof(item_local));
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: copies string value to history cache                              *
  *                                                                            *
- * Parameters: str - [IN] the string value                                    *
+ * Parameters: shard - [IN] the history cache shard to store the value in     *
+ *             str   - [IN] the string value                                  *
  *                                                                            *
  * Return value: the copied string or NULL if there was not enough memory     *
  *                                                                            *
  ******************************************************************************/
-static char	*hc_mem_value_str_dup(const dc_value_str_t *str)
+static char	*hc_mem_value_str_dup(zbx_hc_shard_t *shard, const dc_value_str_t *str)
 {
 	char	*ptr;
 
-	if (NULL == (ptr = (char *)__hc_shmem_malloc_func(NULL, str->len)))
+	if (NULL == (ptr = (char *)zbx_shmem_malloc(shard->mem, NULL, str->len)))
 		return NULL;
 
 	memcpy(ptr, &string_values[str->pvalue], str->len - 1);
@@ -4643,8 +5653,9 @@ static char	*hc_mem_value_str_dup(const dc_value_str_t *str)
  *                                                                            *
  * Purpose: clones string value into history data memory                      *
  *                                                                            *
- * Parameters: dst - [IN/OUT] a reference to the cloned value                 *
- *             str - [IN] the string value to clone                           *
+ * Parameters: shard - [IN] the history cache shard to store the value in     *
+ *             dst   - [IN/OUT] a reference to the cloned value               *
+ *             str   - [IN] the string value to clone                         *
  *                                                                            *
  * Return value: SUCCESS - either there was no need to clone the string       *
  *                         (it was empty or already cloned) or the string was *
@@ -4655,7 +5666,7 @@ static char	*hc_mem_value_str_dup(const dc_value_str_t *str)
  *           until it finishes cloning string value.                          *
  *                                                                            *
  ******************************************************************************/
-static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
+static int	hc_clone_history_str_data(zbx_hc_shard_t *shard, char **dst, const dc_value_str_t *str)
 {
 	if (0 == str->len)
 		return SUCCEED;
@@ -4663,7 +5674,7 @@ static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
 	if (NULL != *dst)
 		return SUCCEED;
 
-	if (NULL != (*dst = hc_mem_value_str_dup(str)))
+	if (NULL != (*dst = hc_mem_value_str_dup(shard, str)))
 		return SUCCEED;
 
 	return FAIL;
@@ -4673,7 +5684,8 @@ static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
  *                                                                            *
  * Purpose: clones log value into history data memory                         *
  *                                                                            *
- * Parameters: dst        - [IN/OUT] a reference to the cloned value          *
+ * Parameters: shard      - [IN] the history cache shard for the value        *
+ *             dst        - [IN/OUT] a reference to the cloned value          *
  *             item_value - [IN] the log value to clone                       *
  *                                                                            *
  * Return value: SUCCESS - the log value was cloned successfully              *
@@ -4683,21 +5695,21 @@ static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
  *           until it finishes cloning log value.                             *
  *                                                                            *
  ******************************************************************************/
-static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_t *item_value)
+static int	hc_clone_history_log_data(zbx_hc_shard_t *shard, zbx_log_value_t **dst,
+		const dc_item_value_t *item_value)
 {
 	if (NULL == *dst)
 	{
-		/* using realloc instead of malloc just to suppress 'not used' warning for realloc */
-		if (NULL == (*dst = (zbx_log_value_t *)__hc_shmem_realloc_func(NULL, sizeof(zbx_log_value_t))))
+		if (NULL == (*dst = (zbx_log_value_t *)zbx_shmem_malloc(shard->mem, NULL, sizeof(zbx_log_value_t))))
 			return FAIL;
 
 		memset(*dst, 0, sizeof(zbx_log_value_t));
 	}
 
-	if (SUCCEED != hc_clone_history_str_data(&(*dst)->value, &item_value->value.value_str))
+	if (SUCCEED != hc_clone_history_str_data(shard, &(*dst)->value, &item_value->value.value_str))
 		return FAIL;
 
-	if (SUCCEED != hc_clone_history_str_data(&(*dst)->source, &item_value->source))
+	if (SUCCEED != hc_clone_history_str_data(shard, &(*dst)->source, &item_value->source))
 		return FAIL;
 
 	(*dst)->logeventid = item_value->logeventid;
@@ -4711,7 +5723,8 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
  *                                                                            *
  * Purpose: clones item value from local cache into history cache             *
  *                                                                            *
- * Parameters: data       - [IN/OUT] a reference to the cloned value          *
+ * Parameters: shard      - [IN] the history cache shard of the item          *
+ *             data       - [IN/OUT] a reference to the cloned value          *
  *             item_value - [IN] the item value                               *
  *                                                                            *
  * Return value: SUCCESS - the item value was cloned successfully             *
@@ -4719,13 +5732,14 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
  *                                                                            *
  * Comments: This function can be called in loop with the same data value     *
  *           until it finishes cloning item value.                            *
+ *           The history cache shard of the item must be locked.              *
  *                                                                            *
  ******************************************************************************/
-static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *item_value)
+static int	hc_clone_history_data(zbx_hc_shard_t *shard, zbx_hc_data_t **data, const dc_item_value_t *item_value)
 {
 	if (NULL == *data)
 	{
-		if (NULL == (*data = (zbx_hc_data_t *)__hc_shmem_malloc_func(NULL, sizeof(zbx_hc_data_t))))
+		if (NULL == (*data = (zbx_hc_data_t *)zbx_shmem_malloc(shard->mem, NULL, sizeof(zbx_hc_data_t))))
 			return FAIL;
 
 		memset(*data, 0, sizeof(zbx_hc_data_t));
@@ -4743,24 +5757,24 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 
 	if (ITEM_STATE_NOTSUPPORTED == item_value->state)
 	{
-		if (NULL == ((*data)->value.str = hc_mem_value_str_dup(&item_value->value.value_str)))
+		if (NULL == ((*data)->value.str = hc_mem_value_str_dup(shard, &item_value->value.value_str)))
 			return FAIL;
 
 		(*data)->value_type = item_value->value_type;
-		cache->stats.notsupported_counter++;
+		shard->stats.notsupported_counter++;
 
 		return SUCCEED;
 	}
 
 	if (0 != (ZBX_DC_FLAG_LLD & item_value->flags))
 	{
-		if (NULL == ((*data)->value.str = hc_mem_value_str_dup(&item_value->value.value_str)))
+		if (NULL == ((*data)->value.str = hc_mem_value_str_dup(shard, &item_value->value.value_str)))
 			return FAIL;
 
 		(*data)->value_type = ITEM_VALUE_TYPE_TEXT;
 
-		cache->stats.history_text_counter++;
-		cache->stats.history_counter++;
+		shard->stats.history_text_counter++;
+		shard->stats.history_counter++;
 
 		return SUCCEED;
 	}
@@ -4778,14 +5792,14 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 			case ITEM_VALUE_TYPE_STR:
 			case ITEM_VALUE_TYPE_TEXT:
 			case ITEM_VALUE_TYPE_BIN:
-				if (SUCCEED != hc_clone_history_str_data(&(*data)->value.str,
+				if (SUCCEED != hc_clone_history_str_data(shard, &(*data)->value.str,
 						&item_value->value.value_str))
 				{
 					return FAIL;
 				}
 				break;
 			case ITEM_VALUE_TYPE_LOG:
-				if (SUCCEED != hc_clone_history_log_data(&(*data)->value.log, item_value))
+				if (SUCCEED != hc_clone_history_log_data(shard, &(*data)->value.log, item_value))
 					return FAIL;
 				break;
 			case ITEM_VALUE_TYPE_NONE:
@@ -4797,22 +5811,22 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 		switch (item_value->item_value_type)
 		{
 			case ITEM_VALUE_TYPE_FLOAT:
-				cache->stats.history_float_counter++;
+				shard->stats.history_float_counter++;
 				break;
 			case ITEM_VALUE_TYPE_UINT64:
-				cache->stats.history_uint_counter++;
+				shard->stats.history_uint_counter++;
 				break;
 			case ITEM_VALUE_TYPE_STR:
-				cache->stats.history_str_counter++;
+				shard->stats.history_str_counter++;
 				break;
 			case ITEM_VALUE_TYPE_TEXT:
-				cache->stats.history_text_counter++;
+				shard->stats.history_text_counter++;
 				break;
 			case ITEM_VALUE_TYPE_LOG:
-				cache->stats.history_log_counter++;
+				shard->stats.history_log_counter++;
 				break;
 			case ITEM_VALUE_TYPE_BIN:
-				cache->stats.history_bin_counter++;
+				shard->stats.history_bin_counter++;
 				break;
 			case ITEM_VALUE_TYPE_NONE:
 			default:
@@ -4820,7 +5834,7 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 				exit(EXIT_FAILURE);
 		}
 
-		cache->stats.history_counter++;
+		shard->stats.history_counter++;
 	}
 
 	(*data)->value_type = item_value->value_type;
@@ -4838,236 +5852,554 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
  * Comments: If the history cache is full this function will wait until       *
  *           history syncers processes values freeing enough space to store   *
  *           the new value.                                                   *
+ *           Values are added shard by shard, locking each shard only once.   *
  *                                                                            *
  ******************************************************************************/
 static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 {
 	dc_item_value_t	*item_value;
-	int		i;
+	int		i, j;
 	zbx_hc_item_t	*item;
 
-	for (i = 0; i < values_num; i++)
+	for (j = 0; j < cache->shards_num; j++)
 	{
-		zbx_hc_data_t	*data = NULL;
-
-		item_value = &values[i];
+		zbx_hc_shard_t	*shard = &cache->shards[j];
+		int		locked = FAIL;
 
-		/* a record with metadata and no value can be dropped if  */
-		/* the metadata update is copied to the last queued value */
-		if (NULL != (item = hc_get_item(item_value->itemid)) &&
-				0 != (item_value->flags & ZBX_DC_FLAG_NOVALUE) &&
-				0 != (item_value->flags & ZBX_DC_FLAG_META))
+		for (i = 0; i < values_num; i++)
 		{
-			/* skip metadata updates when only one value is queued, */
-			/* because the item might be already being processed    */
-			if (item->head != item->tail)
-			{
-				item->head->lastlogsize = item_value->lastlogsize;
-				item->head->mtime = item_value->mtime;
-				item->head->flags |= ZBX_DC_FLAG_META;
+			zbx_hc_data_t	*data = NULL;
+
+			item_value = &values[i];
+
+			if (shard != hc_get_shard(item_value->itemid))
 				continue;
+
+			if (FAIL == locked)
+			{
+				hc_shard_lock(shard);
+				locked = SUCCEED;
+			}
+
+			/* a record with metadata and no value can be dropped if  */
+			/* the metadata update is copied to the last queued value */
+			if (NULL != (item = hc_get_item(shard, item_value->itemid)) &&
+					0 != (item_value->flags & ZBX_DC_FLAG_NOVALUE) &&
+					0 != (item_value->flags & ZBX_DC_FLAG_META))
+			{
+				/* skip metadata updates when only one value is queued, */
+				/* because the item might be already being processed    */
+				if (item->head != item->tail)
+				{
+					item->head->lastlogsize = item_value->lastlogsize;
+					item->head->mtime = item_value->mtime;
+					item->head->flags |= ZBX_DC_FLAG_META;
+					continue;
+				}
+			}
+
+			if (SUCCEED != hc_clone_history_data(shard, &data, item_value))
+			{
+				do
+				{
+					hc_shard_unlock(shard);
+
+					zabbix_log(LOG_LEVEL_DEBUG, "History cache is full. Sleeping for 1 second.");
+					sleep(1);
+
+					hc_shard_lock(shard);
+				}
+				while (SUCCEED != hc_clone_history_data(shard, &data, item_value));
+
+				item = hc_get_item(shard, item_value->itemid);
+			}
+
+			if (NULL == item)
+			{
+				item = hc_add_item(shard, item_value->itemid, data);
+				hc_queue_item(shard, item);
+			}
+			else
+			{
+				item->head->next = data;
+				item->head = data;
 			}
+			item->values_num++;
+			shard->history_num++;
 		}
 
-		if (SUCCEED != hc_clone_history_data(&data, item_value))
+		if (SUCCEED == locked)
+			hc_shard_unlock(shard);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies item value from history cache into the specified history   *
+ *          value                                                             *
+ *                                                                            *
+ * Parameters: history - [OUT] the history value                              *
+ *             itemid  - [IN] the item identifier                             *
+ *             data    - [IN] the history data to copy                        *
+ *                                                                            *
+ * Comments: handling of uninitialized fields in dc_add_proxy_history_log()   *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_copy_history_data(zbx_dc_history_t *history, zbx_uint64_t itemid, zbx_hc_data_t *data)
+{
+	history->itemid = itemid;
+	history->ts = data->ts;
+	history->state = data->state;
+	history->flags = data->flags;
+	history->lastlogsize = data->lastlogsize;
+	history->mtime = data->mtime;
+
+	if (ITEM_STATE_NOTSUPPORTED == data->state)
+	{
+		history->value.err = zbx_strdup(NULL, data->value.str);
+		history->flags |= ZBX_DC_FLAG_UNDEF;
+		return;
+	}
+
+	history->value_type = data->value_type;
+
+	if (0 == (ZBX_DC_FLAG_NOVALUE & data->flags))
+	{
+		switch (data->value_type)
 		{
-			do
-			{
-				UNLOCK_CACHE;
+			case ITEM_VALUE_TYPE_FLOAT:
+				history->value.dbl = data->value.dbl;
+				break;
+			case ITEM_VALUE_TYPE_UINT64:
+				history->value.ui64 = data->value.ui64;
+				break;
+			case ITEM_VALUE_TYPE_STR:
+			case ITEM_VALUE_TYPE_TEXT:
+			case ITEM_VALUE_TYPE_BIN:
+				history->value.str = zbx_strdup(NULL, data->value.str);
+				break;
+			case ITEM_VALUE_TYPE_LOG:
+				history->value.log = (zbx_log_value_t *)zbx_malloc(NULL, sizeof(zbx_log_value_t));
+				history->value.log->value = zbx_strdup(NULL, data->value.log->value);
+
+				if (NULL != data->value.log->source)
+					history->value.log->source = zbx_strdup(NULL, data->value.log->source);
+				else
+					history->value.log->source = NULL;
+
+				history->value.log->timestamp = data->value.log->timestamp;
+				history->value.log->severity = data->value.log->severity;
+				history->value.log->logeventid = data->value.log->logeventid;
+
+				break;
+			case ITEM_VALUE_TYPE_NONE:
+			default:
+				THIS_SHOULD_NEVER_HAPPEN;
+				exit(EXIT_FAILURE);
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: pops the next batch of history items from cache for processing    *
+ *                                                                            *
+ * Parameters: history_items - [OUT] the locked history items                 *
+ *                                                                            *
+ * Comments: The history_items must be returned back to history cache with    *
+ *           hc_push_items() function after they have been processed.         *
+ *           Each call starts with the next shard, so syncers started at the  *
+ *           same time are spread across different shards.                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_pop_items(zbx_vector_ptr_t *history_items)
+{
+	static int		shard_next = -1;
+	zbx_binary_heap_elem_t	*elem;
+	zbx_hc_item_t		*item;
+	int			i;
+
+	if (-1 == shard_next)
+		shard_next = (int)(getpid() % cache->shards_num);
+
+	for (i = 0; i < cache->shards_num && ZBX_HC_SYNC_MAX > history_items->values_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[(shard_next + i) % cache->shards_num];
+
+		hc_shard_lock(shard);
+
+		while (ZBX_HC_SYNC_MAX > history_items->values_num &&
+				FAIL == zbx_binary_heap_empty(&shard->history_queue))
+		{
+			elem = zbx_binary_heap_find_min(&shard->history_queue);
+			item = (zbx_hc_item_t *)elem->data;
+			zbx_vector_ptr_append(history_items, item);
+
+			zbx_binary_heap_remove_min(&shard->history_queue);
+		}
+
+		hc_shard_unlock(shard);
+	}
+
+	shard_next = (shard_next + 1) % cache->shards_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets item history values                                          *
+ *                                                                            *
+ * Parameters: history       - [OUT] the history values                       *
+ *             history_items - [IN] the history items                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_get_item_values(zbx_dc_history_t *history, zbx_vector_ptr_t *history_items)
+{
+	int		i, history_num = 0;
+	zbx_hc_item_t	*item;
+
+	/* we don't need to lock history cache because no other processes can  */
+	/* change item's history data until it is pushed back to history queue */
+	for (i = 0; i < history_items->values_num; i++)
+	{
+		item = (zbx_hc_item_t *)history_items->values[i];
+
+		if (ZBX_HC_ITEM_STATUS_BUSY == item->status)
+			continue;
+
+		hc_copy_history_data(&history[history_num++], item->itemid, item->tail);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: push back the processed history items into history cache          *
+ *                                                                            *
+ * Parameters: history_items - [IN] the history items containing processed    *
+ *                                  (available) and busy items                *
+ *                                                                            *
+ * Return value: the number of items left in history queues of the shards the *
+ *               history items belong to                                      *
+ *                                                                            *
+ * Comments: This function removes processed value from history cache.        *
+ *           If there is no more data for this item, then the item itself is  *
+ *           removed from history index.                                      *
+ *           Only the shards of the returned items are locked, so the queue   *
+ *           size is collected without locking other shards.                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_push_items(zbx_vector_ptr_t *history_items)
+{
+	int		i, j, size = 0;
+	zbx_hc_item_t	*item;
+	zbx_hc_data_t	*data_free;
+
+	for (j = 0; j < cache->shards_num; j++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[j];
+		int		locked = FAIL;
+
+		for (i = 0; i < history_items->values_num; i++)
+		{
+			item = (zbx_hc_item_t *)history_items->values[i];
+
+			if (shard != hc_get_shard(item->itemid))
+				continue;
 
-				zabbix_log(LOG_LEVEL_DEBUG, "History cache is full. Sleeping for 1 second.");
-				sleep(1);
+			if (FAIL == locked)
+			{
+				hc_shard_lock(shard);
+				locked = SUCCEED;
+			}
 
-				LOCK_CACHE;
+			switch (item->status)
+			{
+				case ZBX_HC_ITEM_STATUS_BUSY:
+					/* reset item status before returning it to queue */
+					item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+					hc_queue_item(shard, item);
+					break;
+				case ZBX_HC_ITEM_STATUS_NORMAL:
+					item->values_num--;
+					shard->history_num--;
+					data_free = item->tail;
+					item->tail = item->tail->next;
+					hc_free_data(shard, data_free);
+					if (NULL == item->tail)
+						zbx_hashset_remove(&shard->history_items, item);
+					else
+						hc_queue_item(shard, item);
+					break;
 			}
-			while (SUCCEED != hc_clone_history_data(&data, item_value));
+		}
 
-			item = hc_get_item(item_value->itemid);
+		if (SUCCEED == locked)
+		{
+			size += shard->history_queue.elems_num;
+			hc_shard_unlock(shard);
 		}
+	}
+
+	return size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieve the size of history queue                                *
+ *                                                                            *
+ * Comments: All shards are locked one by one, so this function must be used  *
+ *           only for full cache sync and not in the history sync loop.       *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_queue_get_size(void)
+{
+	int	i, size = 0;
+
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+
+		hc_shard_lock(shard);
+		size += shard->history_queue.elems_num;
+		hc_shard_unlock(shard);
+	}
+
+	return size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares trigger queue elements                                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_trigger_queue_elem_compare_func(const void *d1, const void *d2)
+{
+	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
+	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+
+	const zbx_hc_trigger_item_t	*item1 = (const zbx_hc_trigger_item_t *)e1->data;
+	const zbx_hc_trigger_item_t	*item2 = (const zbx_hc_trigger_item_t *)e2->data;
+
+	/* compare by timestamp of the oldest value */
+	return zbx_timespec_compare(&item1->tail->ts, &item2->tail->ts);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: put back item into trigger queue                                  *
+ *                                                                            *
+ * Comments: The trigger queue must be locked.                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_queue_trigger_item(zbx_hc_trigger_item_t *item)
+{
+	zbx_binary_heap_elem_t	elem = {item->itemid, (void *)item};
 
-		if (NULL == item)
-		{
-			item = hc_add_item(item_value->itemid, data);
-			hc_queue_item(item);
-		}
-		else
-		{
-			item->head->next = data;
-			item->head = data;
-		}
-		item->values_num++;
-	}
+	zbx_binary_heap_insert(&cache->triggerqueue.queue, &elem);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: copies item value from history cache into the specified history   *
- *          value                                                             *
+ * Purpose: reserves trigger queue space for the values of one history sync   *
+ *          batch                                                             *
  *                                                                            *
- * Parameters: history - [OUT] the history value                              *
- *             itemid  - [IN] the item identifier                             *
- *             data    - [IN] the history data to copy                        *
+ * Return value: SUCCEED - the space was reserved                             *
+ *               FAIL    - trigger queue is full                              *
  *                                                                            *
- * Comments: handling of uninitialized fields in dc_add_proxy_history_log()   *
+ * Comments: The reserved space must be released with                         *
+ *           hc_trigger_queue_release() function after the batch values have  *
+ *           been queued. The trigger queue holds at most values_max values,  *
+ *           calculated from its memory size, so queueing reserved values     *
+ *           cannot run out of memory.                                        *
  *                                                                            *
  ******************************************************************************/
-static void	hc_copy_history_data(zbx_dc_history_t *history, zbx_uint64_t itemid, zbx_hc_data_t *data)
+static int	hc_trigger_queue_reserve(void)
 {
-	history->itemid = itemid;
-	history->ts = data->ts;
-	history->state = data->state;
-	history->flags = data->flags;
-	history->lastlogsize = data->lastlogsize;
-	history->mtime = data->mtime;
-
-	if (ITEM_STATE_NOTSUPPORTED == data->state)
-	{
-		history->value.err = zbx_strdup(NULL, data->value.str);
-		history->flags |= ZBX_DC_FLAG_UNDEF;
-		return;
-	}
+	int	ret = FAIL;
 
-	history->value_type = data->value_type;
+	LOCK_TRIGGER_QUEUE;
 
-	if (0 == (ZBX_DC_FLAG_NOVALUE & data->flags))
+	if (cache->triggerqueue.values_max >= cache->triggerqueue.values_num + cache->triggerqueue.values_reserved +
+			ZBX_HC_SYNC_MAX)
 	{
-		switch (data->value_type)
-		{
-			case ITEM_VALUE_TYPE_FLOAT:
-				history->value.dbl = data->value.dbl;
-				break;
-			case ITEM_VALUE_TYPE_UINT64:
-				history->value.ui64 = data->value.ui64;
-				break;
-			case ITEM_VALUE_TYPE_STR:
-			case ITEM_VALUE_TYPE_TEXT:
-			case ITEM_VALUE_TYPE_BIN:
-				history->value.str = zbx_strdup(NULL, data->value.str);
-				break;
-			case ITEM_VALUE_TYPE_LOG:
-				history->value.log = (zbx_log_value_t *)zbx_malloc(NULL, sizeof(zbx_log_value_t));
-				history->value.log->value = zbx_strdup(NULL, data->value.log->value);
+		cache->triggerqueue.values_reserved += ZBX_HC_SYNC_MAX;
+		ret = SUCCEED;
+	}
 
-				if (NULL != data->value.log->source)
-					history->value.log->source = zbx_strdup(NULL, data->value.log->source);
-				else
-					history->value.log->source = NULL;
+	UNLOCK_TRIGGER_QUEUE;
 
-				history->value.log->timestamp = data->value.log->timestamp;
-				history->value.log->severity = data->value.log->severity;
-				history->value.log->logeventid = data->value.log->logeventid;
+	return ret;
+}
 
-				break;
-			case ITEM_VALUE_TYPE_NONE:
-			default:
-				THIS_SHOULD_NEVER_HAPPEN;
-				exit(EXIT_FAILURE);
-		}
-	}
+/******************************************************************************
+ *                                                                            *
+ * Purpose: releases trigger queue space reserved with                        *
+ *          hc_trigger_queue_reserve() function                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_trigger_queue_release(void)
+{
+	LOCK_TRIGGER_QUEUE;
+	cache->triggerqueue.values_reserved -= ZBX_HC_SYNC_MAX;
+	UNLOCK_TRIGGER_QUEUE;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: pops the next batch of history items from cache for processing    *
+ * Purpose: queues synced values of items with triggers for trigger           *
+ *          evaluation                                                        *
  *                                                                            *
- * Parameters: history_items - [OUT] the locked history items                 *
+ * Parameters: history     - [IN] the synced history values                   *
+ *             history_num - [IN] the number of history values                *
+ *             itemids     - [IN] the history value item identifiers, sorted  *
  *                                                                            *
- * Comments: The history_items must be returned back to history cache with    *
- *           hc_push_items() function after they have been processed.         *
+ * Comments: The trigger queue space must be reserved with                    *
+ *           hc_trigger_queue_reserve() function.                             *
  *                                                                            *
  ******************************************************************************/
-static void	hc_pop_items(zbx_vector_ptr_t *history_items)
+static void	hc_queue_trigger_values(const zbx_dc_history_t *history, int history_num,
+		const zbx_vector_uint64_t *itemids)
 {
-	zbx_binary_heap_elem_t	*elem;
-	zbx_hc_item_t		*item;
+	int			i;
+	double			now;
+	zbx_vector_uint64_t	trigger_itemids;
+	zbx_hc_trigger_item_t	*item;
+	zbx_hc_trigger_data_t	*data;
+
+	zbx_vector_uint64_create(&trigger_itemids);
+	zbx_vector_uint64_append_array(&trigger_itemids, itemids->values, itemids->values_num);
+	zbx_dc_config_get_items_with_triggers(&trigger_itemids);
 
-	while (ZBX_HC_SYNC_MAX > history_items->values_num && FAIL == zbx_binary_heap_empty(&cache->history_queue))
+	if (0 == trigger_itemids.values_num)
+		goto out;
+
+	now = zbx_time();
+
+	LOCK_TRIGGER_QUEUE;
+
+	for (i = 0; i < history_num; i++)
 	{
-		elem = zbx_binary_heap_find_min(&cache->history_queue);
-		item = (zbx_hc_item_t *)elem->data;
-		zbx_vector_ptr_append(history_items, item);
+		const zbx_dc_history_t	*h = &history[i];
+
+		if (0 != (ZBX_DC_FLAG_NOVALUE & h->flags))
+			continue;
+
+		if (FAIL == zbx_vector_uint64_bsearch(&trigger_itemids, h->itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+			continue;
+
+		data = (zbx_hc_trigger_data_t *)zbx_shmem_malloc(hc_trigger_mem, NULL, sizeof(zbx_hc_trigger_data_t));
+		data->ts = h->ts;
+		data->time_queued = now;
+		data->next = NULL;
+
+		if (NULL == (item = (zbx_hc_trigger_item_t *)zbx_hashset_search(&cache->triggerqueue.items,
+				&h->itemid)))
+		{
+			zbx_hc_trigger_item_t	item_local = {h->itemid, ZBX_HC_ITEM_STATUS_NORMAL, data, data};
+
+			item = (zbx_hc_trigger_item_t *)zbx_hashset_insert(&cache->triggerqueue.items, &item_local,
+					sizeof(item_local));
+			hc_queue_trigger_item(item);
+		}
+		else
+		{
+			item->head->next = data;
+			item->head = data;
+		}
 
-		zbx_binary_heap_remove_min(&cache->history_queue);
+		cache->triggerqueue.values_num++;
 	}
+
+	UNLOCK_TRIGGER_QUEUE;
+out:
+	zbx_vector_uint64_destroy(&trigger_itemids);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: gets item history values                                          *
+ * Purpose: pops the next batch of items from trigger queue for evaluation    *
  *                                                                            *
- * Parameters: history       - [OUT] the history values                       *
- *             history_items - [IN] the history items                         *
+ * Parameters: trigger_items - [OUT] the trigger queue items                  *
+ *                                                                            *
+ * Comments: The trigger_items must be returned back to trigger queue with    *
+ *           hc_push_trigger_items() function after they have been processed. *
  *                                                                            *
  ******************************************************************************/
-static void	hc_get_item_values(zbx_dc_history_t *history, zbx_vector_ptr_t *history_items)
+static void	hc_pop_trigger_items(zbx_vector_ptr_t *trigger_items)
 {
-	int		i, history_num = 0;
-	zbx_hc_item_t	*item;
+	zbx_binary_heap_elem_t	*elem;
 
-	/* we don't need to lock history cache because no other processes can  */
-	/* change item's history data until it is pushed back to history queue */
-	for (i = 0; i < history_items->values_num; i++)
-	{
-		item = (zbx_hc_item_t *)history_items->values[i];
+	LOCK_TRIGGER_QUEUE;
 
-		if (ZBX_HC_ITEM_STATUS_BUSY == item->status)
-			continue;
+	while (ZBX_HC_SYNC_MAX > trigger_items->values_num &&
+			FAIL == zbx_binary_heap_empty(&cache->triggerqueue.queue))
+	{
+		elem = zbx_binary_heap_find_min(&cache->triggerqueue.queue);
+		zbx_vector_ptr_append(trigger_items, elem->data);
 
-		hc_copy_history_data(&history[history_num++], item->itemid, item->tail);
+		zbx_binary_heap_remove_min(&cache->triggerqueue.queue);
 	}
+
+	UNLOCK_TRIGGER_QUEUE;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: push back the processed history items into history cache          *
+ * Purpose: push back the processed items into trigger queue                  *
  *                                                                            *
- * Parameters: history_items - [IN] the history items containing processed    *
- *                                  (available) and busy items                *
+ * Parameters: trigger_items - [IN] the trigger queue items containing        *
+ *                                  processed (available) and busy items      *
  *                                                                            *
- * Comments: This function removes processed value from history cache.        *
- *           If there is no more data for this item, then the item itself is  *
- *           removed from history index.                                      *
+ * Return value: the number of items left in trigger queue                    *
+ *                                                                            *
+ * Comments: This function removes the processed value from trigger queue.    *
+ *           If there are no more values for this item, then the item itself  *
+ *           is removed from trigger queue index.                             *
  *                                                                            *
  ******************************************************************************/
-void	hc_push_items(zbx_vector_ptr_t *history_items)
+static int	hc_push_trigger_items(zbx_vector_ptr_t *trigger_items)
 {
-	int		i;
-	zbx_hc_item_t	*item;
-	zbx_hc_data_t	*data_free;
+	int			i, size;
+	double			now;
+	zbx_hc_trigger_item_t	*item;
+	zbx_hc_trigger_data_t	*data_free;
 
-	for (i = 0; i < history_items->values_num; i++)
+	now = zbx_time();
+
+	LOCK_TRIGGER_QUEUE;
+
+	for (i = 0; i < trigger_items->values_num; i++)
 	{
-		item = (zbx_hc_item_t *)history_items->values[i];
+		item = (zbx_hc_trigger_item_t *)trigger_items->values[i];
 
 		switch (item->status)
 		{
 			case ZBX_HC_ITEM_STATUS_BUSY:
 				/* reset item status before returning it to queue */
 				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-				hc_queue_item(item);
+				hc_queue_trigger_item(item);
 				break;
 			case ZBX_HC_ITEM_STATUS_NORMAL:
-				item->values_num--;
+				cache->triggerqueue.values_num--;
+				cache->triggerqueue.processed++;
+				cache->triggerqueue.wait += now - item->tail->time_queued;
+
 				data_free = item->tail;
 				item->tail = item->tail->next;
-				hc_free_data(data_free);
+				zbx_shmem_free(hc_trigger_mem, data_free);
+
 				if (NULL == item->tail)
-					zbx_hashset_remove(&cache->history_items, item);
+					zbx_hashset_remove_direct(&cache->triggerqueue.items, item);
 				else
-					hc_queue_item(item);
+					hc_queue_trigger_item(item);
 				break;
 		}
 	}
-}
 
-/******************************************************************************
- *                                                                            *
- * Purpose: retrieve the size of history queue                                *
- *                                                                            *
- ******************************************************************************/
-int	hc_queue_get_size(void)
-{
-	return cache->history_queue.elems_num;
+	size = cache->triggerqueue.queue.elems_num;
+
+	UNLOCK_TRIGGER_QUEUE;
+
+	return size;
 }
 
 int	hc_get_history_compression_age(void)
@@ -5144,9 +6476,11 @@ out:
  *                                                                            *
  ******************************************************************************/
 int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_uint64_t history_cache_size,
-		zbx_uint64_t history_index_cache_size,zbx_uint64_t *trends_cache_size, char **error)
+		zbx_uint64_t history_index_cache_size, int history_cache_shards, int trigger_evaluators,
+		zbx_uint64_t trigger_queue_size, zbx_uint64_t *trends_cache_size, char **error)
 {
-	int	ret;
+	int		ret, i;
+	zbx_uint64_t	shard_size, shard_index_size;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -5158,48 +6492,150 @@ int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_uint64_
 		goto out;
 	}
 
-	if (SUCCEED != (ret = zbx_mutex_create(&cache_lock, ZBX_MUTEX_CACHE, error)))
+	if (1 > history_cache_shards || ZBX_HC_SHARDS_MAX < history_cache_shards)
+	{
+		*error = zbx_dsprintf(*error, "invalid number of history cache shards: %d", history_cache_shards);
+		ret = FAIL;
 		goto out;
+	}
 
-	if (SUCCEED != (ret = zbx_mutex_create(&cache_ids_lock, ZBX_MUTEX_CACHE_IDS, error)))
-		goto out;
+	/* history cache and history index cache memory is split equally between shards */
+	shard_size = history_cache_size / (zbx_uint64_t)history_cache_shards;
+	shard_index_size = history_index_cache_size / (zbx_uint64_t)history_cache_shards;
 
-	if (SUCCEED != (ret = zbx_shmem_create(&hc_mem, history_cache_size, "history cache",
-			"HistoryCacheSize", 1, error)))
+	if (ZBX_HC_SHARD_SIZE_MIN > shard_size || ZBX_HC_SHARD_SIZE_MIN > shard_index_size)
 	{
+		*error = zbx_dsprintf(*error, "HistoryCacheSize and HistoryIndexCacheSize must be at least "
+				ZBX_FS_UI64 " bytes per history cache shard", (zbx_uint64_t)ZBX_HC_SHARD_SIZE_MIN);
+		ret = FAIL;
 		goto out;
 	}
 
-	if (SUCCEED != (ret = zbx_shmem_create(&hc_index_mem, history_index_cache_size, "history index cache",
+	if (SUCCEED != (ret = zbx_mutex_create(&cache_ids_lock, ZBX_MUTEX_CACHE_IDS, error)))
+		goto out;
+
+	if (SUCCEED != (ret = zbx_mutex_create(&cache_stats_lock, ZBX_MUTEX_CACHE_STATS, error)))
+		goto out;
+
+	if (SUCCEED != (ret = zbx_shmem_create(&hc_mem, shard_size, "history cache", "HistoryCacheSize", 1, error)))
+		goto out;
+
+	if (SUCCEED != (ret = zbx_shmem_enable_slabs(hc_mem, error)))
+		goto out;
+
+	if (SUCCEED != (ret = zbx_shmem_create(&hc_index_mem, shard_index_size, "history index cache",
 			"HistoryIndexCacheSize", 0, error)))
 	{
 		goto out;
 	}
 
-	cache = (ZBX_DC_CACHE *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_CACHE));
+	if (SUCCEED != (ret = zbx_shmem_enable_slabs(hc_index_mem, error)))
+		goto out;
+
+	/* the cache-wide data is stored in the first shard index memory */
+	cache = (ZBX_DC_CACHE *)zbx_shmem_malloc(hc_index_mem, NULL, sizeof(ZBX_DC_CACHE));
 	memset(cache, 0, sizeof(ZBX_DC_CACHE));
 
-	ids = (ZBX_DC_IDS *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_IDS));
+	ids = (ZBX_DC_IDS *)zbx_shmem_malloc(hc_index_mem, NULL, sizeof(ZBX_DC_IDS));
 	memset(ids, 0, sizeof(ZBX_DC_IDS));
 
-	zbx_hashset_create_ext(&cache->history_items, ZBX_HC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+	cache->shards_num = history_cache_shards;
+
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+
+		if (0 == i)
+		{
+			if (SUCCEED != (ret = zbx_mutex_create(&shard->lock, ZBX_MUTEX_CACHE, error)))
+				goto out;
+
+			shard->mem = hc_mem;
+			shard->index_mem = hc_index_mem;
+		}
+		else
+		{
+			if (SUCCEED != (ret = zbx_mutex_create(&shard->lock, ZBX_MUTEX_CACHE_SHARD + i - 1, error)))
+				goto out;
+
+			if (SUCCEED != (ret = zbx_shmem_create(&shard->mem, shard_size, "history cache",
+					"HistoryCacheSize", 1, error)))
+			{
+				goto out;
+			}
+
+			if (SUCCEED != (ret = zbx_shmem_enable_slabs(shard->mem, error)))
+				goto out;
+
+			if (SUCCEED != (ret = zbx_shmem_create(&shard->index_mem, shard_index_size,
+					"history index cache", "HistoryIndexCacheSize", 0, error)))
+			{
+				goto out;
+			}
+
+			if (SUCCEED != (ret = zbx_shmem_enable_slabs(shard->index_mem, error)))
+				goto out;
+		}
+
+		zbx_hashset_create_ext(&shard->history_items, ZBX_HC_ITEMS_INIT_SIZE,
+				ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+				hc_index_funcs[i].malloc_func, hc_index_funcs[i].realloc_func,
+				hc_index_funcs[i].free_func);
 
-	zbx_binary_heap_create_ext(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+		zbx_binary_heap_create_ext(&shard->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY, hc_index_funcs[i].malloc_func,
+				hc_index_funcs[i].realloc_func, hc_index_funcs[i].free_func);
+	}
+
+	/* the cache-wide queues are stored in the first shard index memory */
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
 		zbx_hashset_create_ext(&(cache->proxyqueue.index), ZBX_HC_SYNC_MAX,
 			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+			hc_index_funcs[0].malloc_func, hc_index_funcs[0].realloc_func, hc_index_funcs[0].free_func);
 
-		zbx_list_create_ext(&(cache->proxyqueue.list), __hc_index_shmem_malloc_func,
-				__hc_index_shmem_free_func);
+		zbx_list_create_ext(&(cache->proxyqueue.list), hc_index_funcs[0].malloc_func,
+				hc_index_funcs[0].free_func);
 
 		cache->proxyqueue.state = ZBX_HC_PROXYQUEUE_STATE_NORMAL;
 
+		if (0 != trigger_evaluators)
+		{
+			/* the trigger queue must fit at least one history sync batch */
+			if ((zbx_uint64_t)ZBX_HC_SYNC_MAX * ZBX_HC_TRIGGER_VALUE_SIZE > trigger_queue_size)
+			{
+				*error = zbx_dsprintf(*error, "TriggerQueueSize must be at least " ZBX_FS_UI64 " bytes",
+						(zbx_uint64_t)ZBX_HC_SYNC_MAX * ZBX_HC_TRIGGER_VALUE_SIZE);
+				ret = FAIL;
+				goto out;
+			}
+
+			if (SUCCEED != (ret = zbx_mutex_create(&trigger_queue_lock, ZBX_MUTEX_TRIGGER_QUEUE, error)))
+				goto out;
+
+			if (SUCCEED != (ret = zbx_shmem_create(&hc_trigger_mem, trigger_queue_size, "trigger queue",
+					"TriggerQueueSize", 0, error)))
+			{
+				goto out;
+			}
+
+			if (SUCCEED != (ret = zbx_shmem_enable_slabs(hc_trigger_mem, error)))
+				goto out;
+
+			zbx_hashset_create_ext(&cache->triggerqueue.items, ZBX_HC_ITEMS_INIT_SIZE,
+					ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+					__hc_trigger_shmem_malloc_func, __hc_trigger_shmem_realloc_func,
+					__hc_trigger_shmem_free_func);
+
+			zbx_binary_heap_create_ext(&cache->triggerqueue.queue, hc_trigger_queue_elem_compare_func,
+					ZBX_BINARY_HEAP_OPTION_EMPTY, __hc_trigger_shmem_malloc_func,
+					__hc_trigger_shmem_realloc_func, __hc_trigger_shmem_free_func);
+
+			cache->triggerqueue.values_max = (int)MIN(trigger_queue_size / ZBX_HC_TRIGGER_VALUE_SIZE, INT_MAX);
+			cache->trigger_evaluators = trigger_evaluators;
+		}
+
 		if (SUCCEED != (ret = init_trend_cache(trends_cache_size, error)))
 			goto out;
 	}
@@ -5286,11 +6722,27 @@ static void	DCsync_all(const zbx_events_funcs_t *events_cbs)
  ******************************************************************************/
 void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs)
 {
+	int	i;
+
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	if (ZBX_SYNC_ALL == sync)
 		DCsync_all(events_cbs);
 
+	for (i = cache->shards_num - 1; 0 <= i; i--)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+
+		zbx_mutex_destroy(&shard->lock);
+
+		/* the first shard memory is destroyed last, because it contains the shards */
+		if (0 != i)
+		{
+			zbx_shmem_destroy(shard->mem);
+			zbx_shmem_destroy(shard->index_mem);
+		}
+	}
+
 	cache = NULL;
 
 	zbx_shmem_destroy(hc_mem);
@@ -5298,14 +6750,21 @@ void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs)
 	zbx_shmem_destroy(hc_index_mem);
 	hc_index_mem = NULL;
 
-	zbx_mutex_destroy(&cache_lock);
 	zbx_mutex_destroy(&cache_ids_lock);
+	zbx_mutex_destroy(&cache_stats_lock);
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
 		zbx_shmem_destroy(trend_mem);
 		trend_mem = NULL;
 		zbx_mutex_destroy(&trends_lock);
+
+		if (NULL != hc_trigger_mem)
+		{
+			zbx_shmem_destroy(hc_trigger_mem);
+			hc_trigger_mem = NULL;
+			zbx_mutex_destroy(&trigger_queue_lock);
+		}
 	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
@@ -5419,12 +6878,50 @@ out:
  ******************************************************************************/
 void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
 {
-	LOCK_CACHE;
+	int	items, values;
 
-	*values_num = cache->history_num;
-	*items_num = cache->history_items.num_data;
+	hc_count_history(&values, &items);
 
-	UNLOCK_CACHE;
+	*values_num = (zbx_uint64_t)values;
+	*items_num = (zbx_uint64_t)items;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds shared memory allocator statistics of a shard to the total   *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_add_mem_stats(zbx_shmem_stats_t *total, const zbx_shmem_stats_t *stats)
+{
+	int	i;
+
+	if (0 == total->used_chunks + total->free_chunks)
+	{
+		*total = *stats;
+		return;
+	}
+
+	total->free_size += stats->free_size;
+	total->used_size += stats->used_size;
+	total->overhead += stats->overhead;
+	total->free_chunks += stats->free_chunks;
+	total->used_chunks += stats->used_chunks;
+
+	if (total->min_chunk_size > stats->min_chunk_size)
+		total->min_chunk_size = stats->min_chunk_size;
+
+	if (total->max_chunk_size < stats->max_chunk_size)
+		total->max_chunk_size = stats->max_chunk_size;
+
+	for (i = 0; i < ZBX_SHMEM_BUCKET_COUNT; i++)
+		total->chunks_num[i] += stats->chunks_num[i];
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		total->slab_classes[i].slabs_num += stats->slab_classes[i].slabs_num;
+		total->slab_classes[i].used_objects += stats->slab_classes[i].used_objects;
+		total->slab_classes[i].free_objects += stats->slab_classes[i].free_objects;
+	}
 }
 
 /******************************************************************************
@@ -5434,15 +6931,35 @@ void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
  ******************************************************************************/
 void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index)
 {
-	LOCK_CACHE;
+	int			i;
+	zbx_shmem_stats_t	stats;
 
 	if (NULL != data)
-		zbx_shmem_get_stats(hc_mem, data);
+		memset(data, 0, sizeof(zbx_shmem_stats_t));
 
 	if (NULL != index)
-		zbx_shmem_get_stats(hc_index_mem, index);
+		memset(index, 0, sizeof(zbx_shmem_stats_t));
 
-	UNLOCK_CACHE;
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+
+		hc_shard_lock(shard);
+
+		if (NULL != data)
+		{
+			zbx_shmem_get_stats(shard->mem, &stats);
+			hc_add_mem_stats(data, &stats);
+		}
+
+		if (NULL != index)
+		{
+			zbx_shmem_get_stats(shard->index_mem, &stats);
+			hc_add_mem_stats(index, &stats);
+		}
+
+		hc_shard_unlock(shard);
+	}
 }
 
 /******************************************************************************
@@ -5454,19 +6971,25 @@ void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items)
 {
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
+	int			i;
 
-	LOCK_CACHE;
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
 
-	zbx_vector_uint64_pair_reserve(items, cache->history_items.num_data);
+		hc_shard_lock(shard);
 
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
-	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		zbx_uint64_pair_t	pair = {item->itemid, item->values_num};
-		zbx_vector_uint64_pair_append_ptr(items, &pair);
-	}
+		zbx_vector_uint64_pair_reserve(items, (size_t)items->values_num + shard->history_items.num_data);
 
-	UNLOCK_CACHE;
+		zbx_hashset_iter_reset(&shard->history_items, &iter);
+		while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
+		{
+			zbx_uint64_pair_t	pair = {item->itemid, item->values_num};
+			zbx_vector_uint64_pair_append_ptr(items, &pair);
+		}
+
+		hc_shard_unlock(shard);
+	}
 }
 
 /******************************************************************************
@@ -5579,14 +7102,18 @@ static void	zbx_hc_proxyqueue_clear(void)
  ******************************************************************************/
 int	zbx_hc_check_proxy(zbx_uint64_t proxyid)
 {
-	double	hc_pused;
-	int	ret;
+	double		hc_pused, lock_wait;
+	int		ret;
+	zbx_dc_stats_t	stats;
+	zbx_uint64_t	history_free, history_total, index_free, index_total;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() proxyid:"ZBX_FS_UI64, __func__, proxyid);
 
-	LOCK_CACHE;
+	hc_get_shard_stats(&stats, &history_free, &history_total, &index_free, &index_total, &lock_wait);
+	hc_pused = 100 * (double)(history_total - history_free) / history_total;
 
-	hc_pused = 100 * (double)(hc_mem->total_size - hc_mem->free_size) / hc_mem->total_size;
+	/* proxy queue is protected by the first shard lock */
+	LOCK_CACHE;
 
 	if (20 >= hc_pused)
 	{
@@ -5637,3 +7164,7 @@ out:
 
 	return ret;
 }
+
+#ifdef HAVE_TESTS
+#	include "../../../tests/libs/zbxdbcache/dbcache_test.c"
+#endif
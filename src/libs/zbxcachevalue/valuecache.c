@@ -18,6 +18,7 @@
 **/
 
 #include "zbxcachevalue.h"
+#include "vc_pack.h"
 
 #include "zbxmutexs.h"
 #include "zbxtime.h"
@@ -100,7 +101,13 @@ typedef struct zbx_vc_chunk
 	/* the number of item value slots in chunk */
 	int			slots_num;
 
-	/* the item value data */
+	/* the size of packed item value data, 0 if values are stored as history records */
+	int			packed_size;
+
+	/* the identifier of packed item value data, used to match unpacked value buffer */
+	zbx_uint64_t		packed_id;
+
+	/* the item value data - either history records or packed values */
 	zbx_history_record_t	slots[1];
 }
 zbx_vc_chunk_t;
@@ -113,6 +120,55 @@ zbx_vc_chunk_t;
 #define ZBX_VC_MAX_CHUNK_RECORDS	((64 * ZBX_KIBIBYTE - sizeof(zbx_vc_chunk_t)) / \
 		sizeof(zbx_history_record_t) + 1)
 
+/* the unpacked value buffer of the last accessed packed chunk */
+static ZBX_THREAD_LOCAL zbx_history_record_t	*vc_unpacked_values = NULL;
+static ZBX_THREAD_LOCAL zbx_uint64_t		vc_unpacked_id = 0;
+
+/* the window flags */
+#define ZBX_VC_WINDOW_VALID	0x01
+#define ZBX_VC_WINDOW_MIN	0x02
+#define ZBX_VC_WINDOW_MAX	0x04
+
+/* the period after which windows not requested anymore are removed */
+#define ZBX_VC_WINDOW_EXPIRE_PERIOD	SEC_PER_HOUR
+
+/* the running aggregates of item values in a sliding time window */
+typedef struct zbx_vc_window
+{
+	/* the next window of the same item */
+	struct zbx_vc_window	*next;
+
+	/* the window length in seconds */
+	int			seconds;
+
+	/* the window flags (ZBX_VC_WINDOW_*), min and max flags are set while */
+	/* the window min and max values are up to date                        */
+	int			flags;
+
+	/* the last time when the window was requested */
+	int			last_accessed;
+
+	/* the window start - only values with greater timestamps are in window */
+	zbx_timespec_t		start;
+
+	/* the timestamp of the newest item value in cache */
+	zbx_timespec_t		end;
+
+	/* the number of window values - the newest item values in cache */
+	int			values_num;
+
+	/* the sum of values, the sum of doubles is maintained for both numeric types */
+	double			sum_dbl;
+	zbx_uint64_t		sum_ui64;
+
+	/* the number of values removed since the sum of doubles was recalculated */
+	int			removed_num;
+
+	zbx_history_value_t	min;
+	zbx_history_value_t	max;
+}
+zbx_vc_window_t;
+
 /* the value cache item data */
 typedef struct
 {
@@ -175,6 +231,9 @@ typedef struct
 
 	/* the first (oldest) chunk of item history data              */
 	zbx_vc_chunk_t	*tail;
+
+	/* the sliding windows of running aggregates                  */
+	zbx_vc_window_t	*windows;
 }
 zbx_vc_item_t;
 
@@ -199,6 +258,12 @@ typedef struct
 	/* the minimum number of bytes to be freed when cache runs out of space */
 	size_t		min_free_request;
 
+	/* 1 - pack numeric values of filled chunks, 0 - store values as history records */
+	int		compression;
+
+	/* the identifier of the last packed chunk data */
+	zbx_uint64_t	last_packed_id;
+
 	/* the cached items */
 	zbx_hashset_t	items;
 
@@ -218,13 +283,31 @@ typedef struct
 }
 zbx_vc_item_weight_t;
 
+/* the data of value cache visitor appending values to vector */
+typedef struct
+{
+	zbx_vector_history_record_t	*values;
+	unsigned char			value_type;
+}
+zbx_vc_vector_append_t;
+
+/* the data of value cache visitor copying the first value */
+typedef struct
+{
+	zbx_history_record_t	*value;
+	unsigned char		value_type;
+	int			found;
+}
+zbx_vc_value_copy_t;
+
 ZBX_VECTOR_DECL(vc_itemweight, zbx_vc_item_weight_t)
 ZBX_VECTOR_IMPL(vc_itemweight, zbx_vc_item_weight_t)
 
 typedef enum
 {
 	ZBX_VC_UPDATE_STATS,
-	ZBX_VC_UPDATE_RANGE
+	ZBX_VC_UPDATE_RANGE,
+	ZBX_VC_UPDATE_WINDOW
 }
 zbx_vc_item_update_type_t;
 
@@ -240,6 +323,12 @@ enum
 	ZBX_VC_UPDATE_RANGE_NOW
 };
 
+enum
+{
+	ZBX_VC_UPDATE_WINDOW_SECONDS,
+	ZBX_VC_UPDATE_WINDOW_NOW
+};
+
 typedef struct
 {
 	zbx_uint64_t			itemid;
@@ -275,13 +364,14 @@ static zbx_vc_cache_t	*vc_cache = NULL;
 #define	UNLOCK_CACHE	zbx_rwlock_unlock(vc_lock)
 
 /* function prototypes */
-static void	vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_record_t *src, int value_type);
 static void	vc_history_record_vector_clean(zbx_vector_history_record_t *vector, int value_type);
 
 static size_t	vch_item_free_cache(zbx_vc_item_t *item);
 static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk);
 static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num);
 static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp);
+static size_t	vc_item_free_windows(zbx_vc_item_t *item);
+static void	vc_item_check_windows(zbx_vc_item_t *item);
 
 /*********************************************************************************
  *                                                                               *
@@ -881,7 +971,7 @@ static void	vc_release_space(zbx_vc_item_t *source_item, size_t space)
  *           value contents. This memory must be freed by the caller.         *
  *                                                                            *
  ******************************************************************************/
-static void	vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_record_t *src, int value_type)
+void	zbx_vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_record_t *src, int value_type)
 {
 	dst->timestamp = src->timestamp;
 
@@ -912,14 +1002,43 @@ static void	vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_
  *                                                                            *
  ******************************************************************************/
 static void	vc_history_record_vector_append(zbx_vector_history_record_t *vector, int value_type,
-		zbx_history_record_t *value)
+		const zbx_history_record_t *value)
 {
 	zbx_history_record_t	record;
 
-	vc_history_record_copy(&record, value, value_type);
+	zbx_vc_history_record_copy(&record, value, value_type);
 	zbx_vector_history_record_append_ptr(vector, &record);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache visitor appending visited values to value vector      *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_history_record_vector_append_func(const zbx_history_record_t *value, void *data)
+{
+	zbx_vc_vector_append_t	*append = (zbx_vc_vector_append_t *)data;
+
+	vc_history_record_vector_append(append->values, append->value_type, value);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache visitor copying the first visited value               *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_history_record_copy_func(const zbx_history_record_t *value, void *data)
+{
+	zbx_vc_value_copy_t	*copy = (zbx_vc_value_copy_t *)data;
+
+	zbx_vc_history_record_copy(copy->value, value, copy->value_type);
+	copy->found = 1;
+
+	return FAIL;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: allocate cache memory to store item's resources                   *
@@ -1269,6 +1388,50 @@ static void	vc_item_update_db_cached_from(zbx_vc_item_t *item, int timestamp)
  * range) are automatically removed from cache.
  */
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets chunk values as history records                              *
+ *                                                                            *
+ * Parameters: chunk      - [IN] the chunk                                    *
+ *             value_type - [IN] the item value type                          *
+ *                                                                            *
+ * Return value: the chunk value slots                                        *
+ *                                                                            *
+ * Comments: Packed chunks are unpacked into per thread buffer, which is      *
+ *           valid until values of another packed chunk are requested.        *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_history_record_t	*vch_chunk_values(const zbx_vc_chunk_t *chunk, unsigned char value_type)
+{
+	if (0 == chunk->packed_size)
+		return (zbx_history_record_t *)chunk->slots;
+
+	if (vc_unpacked_id != chunk->packed_id)
+	{
+		if (NULL == vc_unpacked_values)
+		{
+			vc_unpacked_values = (zbx_history_record_t *)zbx_malloc(NULL, ZBX_VC_MAX_CHUNK_RECORDS *
+					sizeof(zbx_history_record_t));
+		}
+
+		vc_unpack_values((const unsigned char *)chunk->slots, chunk->slots_num, value_type,
+				vc_unpacked_values);
+		vc_unpacked_id = chunk->packed_id;
+	}
+
+	return vc_unpacked_values;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets timestamp seconds of the specified chunk value               *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_chunk_sec(const zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk, int index)
+{
+	return vch_chunk_values(chunk, item->value_type)[index].timestamp.sec;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: updates item range with current request range                     *
@@ -1295,7 +1458,7 @@ static void	vch_item_update_range(zbx_vc_item_t *item, int range, int now)
 		diff += 0xff;
 
 	if (NULL != item->head)
-		last_value_timestamp = item->head->slots[item->head->last_value].timestamp.sec;
+		last_value_timestamp = vch_chunk_sec(item, item->head, item->head->last_value);
 	else
 		last_value_timestamp = now;
 
@@ -1398,13 +1561,176 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: replaces chunk in item chunk list                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_replace_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, zbx_vc_chunk_t *chunk_new)
+{
+	if (NULL != chunk->prev)
+		chunk->prev->next = chunk_new;
+	else
+		item->tail = chunk_new;
+
+	if (NULL != chunk->next)
+		chunk->next->prev = chunk_new;
+	else
+		item->head = chunk_new;
+
+	__vc_shmem_free_func(chunk);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: packs chunk values                                                *
+ *                                                                            *
+ * Parameters: item  - [IN/OUT] the chunk owner item                          *
+ *             chunk - [IN] the chunk to pack                                 *
+ *                                                                            *
+ * Comments: Packing is opportunistic - if packed values would not be smaller *
+ *           or there is no free memory for packed chunk, the chunk is kept   *
+ *           as is.                                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_pack_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	int		values_num, packed_size;
+	unsigned char	*buf;
+	zbx_vc_chunk_t	*chunk_new;
+
+	values_num = chunk->last_value - chunk->first_value + 1;
+	buf = (unsigned char *)zbx_malloc(NULL, (size_t)values_num * ZBX_VC_PACKED_RECORD_SIZE_MAX);
+
+	packed_size = vc_pack_values(&chunk->slots[chunk->first_value], values_num, item->value_type, buf);
+
+	if ((size_t)packed_size >= (size_t)values_num * sizeof(zbx_history_record_t))
+		goto out;
+
+	if (NULL == (chunk_new = (zbx_vc_chunk_t *)__vc_shmem_malloc_func(NULL, offsetof(zbx_vc_chunk_t, slots) +
+			(size_t)packed_size)))
+	{
+		goto out;
+	}
+
+	chunk_new->prev = chunk->prev;
+	chunk_new->next = chunk->next;
+	chunk_new->first_value = 0;
+	chunk_new->last_value = values_num - 1;
+	chunk_new->slots_num = values_num;
+	chunk_new->packed_size = packed_size;
+	chunk_new->packed_id = ++vc_cache->last_packed_id;
+	memcpy(chunk_new->slots, buf, (size_t)packed_size);
+
+	vch_item_replace_chunk(item, chunk, chunk_new);
+out:
+	zbx_free(buf);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: packs filled item chunks                                          *
+ *                                                                            *
+ * Parameters: item - [IN/OUT] the item                                       *
+ *                                                                            *
+ * Comments: The head chunk receives new values and the tail chunk with free  *
+ *           slots receives older values, so they are not packed.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_pack_chunks(zbx_vc_item_t *item)
+{
+	zbx_vc_chunk_t	*chunk, *next;
+
+	if (0 == vc_cache->compression)
+		return;
+
+	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
+		return;
+
+	for (chunk = item->tail; NULL != chunk && chunk != item->head; chunk = next)
+	{
+		next = chunk->next;
+
+		if (0 != chunk->packed_size || (chunk == item->tail && 0 != chunk->first_value))
+			continue;
+
+		vch_item_pack_chunk(item, chunk);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unpacks chunk values into history records                         *
+ *                                                                            *
+ * Parameters: item  - [IN/OUT] the chunk owner item                          *
+ *             chunk - [IN] the chunk to unpack                               *
+ *                                                                            *
+ * Return value: the unpacked chunk or NULL if there was not enough memory    *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vc_chunk_t	*vch_item_unpack_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	zbx_vc_chunk_t	*chunk_new;
+
+	if (NULL == (chunk_new = (zbx_vc_chunk_t *)vc_item_malloc(item, sizeof(zbx_vc_chunk_t) +
+			sizeof(zbx_history_record_t) * (size_t)(chunk->slots_num - 1))))
+	{
+		return NULL;
+	}
+
+	chunk_new->prev = chunk->prev;
+	chunk_new->next = chunk->next;
+	chunk_new->first_value = chunk->first_value;
+	chunk_new->last_value = chunk->last_value;
+	chunk_new->slots_num = chunk->slots_num;
+	chunk_new->packed_size = 0;
+	chunk_new->packed_id = 0;
+	vc_unpack_values((const unsigned char *)chunk->slots, chunk->slots_num, item->value_type, chunk_new->slots);
+
+	vch_item_replace_chunk(item, chunk, chunk_new);
+
+	return chunk_new;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unpacks chunks, starting with the head chunk, down to the chunk   *
+ *          containing the last value with timestamp less or equal to the     *
+ *          specified timestamp                                               *
+ *                                                                            *
+ * Parameters: item - [IN/OUT] the item                                       *
+ *             ts   - [IN] the target timestamp                               *
+ *                                                                            *
+ * Return value: SUCCEED - the chunks were unpacked successfully              *
+ *               FAIL    - not enough memory                                  *
+ *                                                                            *
+ * Comments: Used before inserting value in the middle of cached data.        *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_unpack_chunks(zbx_vc_item_t *item, const zbx_timespec_t *ts)
+{
+	zbx_vc_chunk_t	*chunk;
+
+	for (chunk = item->head; NULL != chunk; chunk = chunk->prev)
+	{
+		if (0 != chunk->packed_size && NULL == (chunk = vch_item_unpack_chunk(item, chunk)))
+			return FAIL;
+
+		if (0 >= zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, ts))
+			break;
+	}
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: find the index of the last value in chunk with timestamp less or  *
  *          equal to the specified timestamp.                                 *
  *                                                                            *
- * Parameters:  chunk - [IN] the chunk                                        *
- *              ts    - [IN] the target timestamp                             *
+ * Parameters:  chunk      - [IN] the chunk                                   *
+ *              value_type - [IN] the item value type                         *
+ *              ts         - [IN] the target timestamp                        *
  *                                                                            *
  * Return value: The index of the last value in chunk with timestamp less or  *
  *               equal to the specified timestamp.                            *
@@ -1412,12 +1738,14 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
  *               values have timestamps greater than the target timestamp).   *
  *                                                                            *
  ******************************************************************************/
-static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const zbx_timespec_t *ts)
+static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, unsigned char value_type,
+		const zbx_timespec_t *ts)
 {
-	int	start = chunk->first_value, end = chunk->last_value, middle;
+	int				start = chunk->first_value, end = chunk->last_value, middle;
+	const zbx_history_record_t	*slots = vch_chunk_values(chunk, value_type);
 
 	/* check if the last value timestamp is already greater or equal to the specified timestamp */
-	if (0 >= zbx_timespec_compare(&chunk->slots[end].timestamp, ts))
+	if (0 >= zbx_timespec_compare(&slots[end].timestamp, ts))
 		return end;
 
 	/* chunk contains only one value, which did not pass the above check, return failure */
@@ -1429,13 +1757,13 @@ static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const z
 	{
 		middle = start + (end - start) / 2;
 
-		if (0 < zbx_timespec_compare(&chunk->slots[middle].timestamp, ts))
+		if (0 < zbx_timespec_compare(&slots[middle].timestamp, ts))
 		{
 			end = middle;
 			continue;
 		}
 
-		if (0 >= zbx_timespec_compare(&chunk->slots[middle + 1].timestamp, ts))
+		if (0 >= zbx_timespec_compare(&slots[middle + 1].timestamp, ts))
 		{
 			start = middle;
 			continue;
@@ -1477,16 +1805,17 @@ static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec
 
 	index = chunk->last_value;
 
-	if (0 < zbx_timespec_compare(&chunk->slots[index].timestamp, ts))
+	if (0 < zbx_timespec_compare(&vch_chunk_values(chunk, item->value_type)[index].timestamp, ts))
 	{
-		while (0 < zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, ts))
+		while (0 < zbx_timespec_compare(&vch_chunk_values(chunk, item->value_type)[chunk->first_value].timestamp,
+				ts))
 		{
 			chunk = chunk->prev;
 			/* there are no values for requested range, return failure */
 			if (NULL == chunk)
 				return FAIL;
 		}
-		index = vch_chunk_find_last_value_before(chunk, ts);
+		index = vch_chunk_find_last_value_before(chunk, item->value_type, ts);
 	}
 
 	*pchunk = chunk;
@@ -1617,7 +1946,12 @@ static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
 {
 	size_t	freed;
 
-	freed = sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t);
+	if (0 != chunk->packed_size)
+		freed = offsetof(zbx_vc_chunk_t, slots) + (size_t)chunk->packed_size;
+	else
+		freed = sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t);
+
+	/* packed chunks hold only numeric values, which do not have resources to free */
 	freed += vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->last_value);
 
 	__vc_shmem_free_func(chunk);
@@ -1667,15 +2001,16 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
 	{
 		zbx_vc_chunk_t	*tail = item->tail;
 		zbx_vc_chunk_t	*chunk = tail;
+		int		last_sec, head_sec;
 
 		timestamp -= item->active_range;
+		head_sec = vch_chunk_sec(item, item->head, item->head->last_value);
 
 		/* Try to remove chunks with all history values older than maximum request range, maximum */
 		/* request range should be calculated from last received value with which active range    */
 		/* was calculated to avoid dropping of chunks that might be still used in count request.  */
-		while (NULL != chunk && chunk->slots[chunk->last_value].timestamp.sec < timestamp &&
-				chunk->slots[chunk->last_value].timestamp.sec !=
-						item->head->slots[item->head->last_value].timestamp.sec)
+		while (NULL != chunk && (last_sec = vch_chunk_sec(item, chunk, chunk->last_value)) < timestamp &&
+				last_sec != head_sec)
 		{
 			/* don't remove the head chunk */
 			if (NULL == (next = chunk->next))
@@ -1689,10 +2024,9 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
 			/* In this case increase the first value index of the next chunk until the first  */
 			/* value timestamp is greater.                                                    */
 
-			if (next->slots[next->first_value].timestamp.sec != next->slots[next->last_value].timestamp.sec)
+			if (vch_chunk_sec(item, next, next->first_value) != vch_chunk_sec(item, next, next->last_value))
 			{
-				while (next->slots[next->first_value].timestamp.sec ==
-						chunk->slots[chunk->last_value].timestamp.sec)
+				while (vch_chunk_sec(item, next, next->first_value) == last_sec)
 				{
 					vc_item_free_values(item, next->slots, next->first_value, next->first_value);
 					next->first_value++;
@@ -1700,7 +2034,7 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
 			}
 
 			/* set the database cached from timestamp to the last (oldest) removed value timestamp + 1 */
-			item->db_cached_from = chunk->slots[chunk->last_value].timestamp.sec + 1;
+			item->db_cached_from = last_sec + 1;
 
 			vch_item_remove_chunk(item, chunk);
 
@@ -1710,6 +2044,8 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
 		/* reset the status flags if data was removed from cache */
 		if (tail != item->tail)
 			item->status = 0;
+
+		vc_item_check_windows(item);
 	}
 }
 
@@ -1731,16 +2067,16 @@ static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
 		item->status = 0;
 
 	/* try to remove chunks with all history values older than the timestamp */
-	while (NULL != chunk && chunk->slots[chunk->first_value].timestamp.sec < timestamp)
+	while (NULL != chunk && vch_chunk_sec(item, chunk, chunk->first_value) < timestamp)
 	{
 		zbx_vc_chunk_t	*next;
 
 		/* If chunk contains values with timestamp greater or equal - remove */
 		/* only the values with less timestamp. Otherwise remove the while   */
 		/* chunk and check next one.                                         */
-		if (chunk->slots[chunk->last_value].timestamp.sec >= timestamp)
+		if (vch_chunk_sec(item, chunk, chunk->last_value) >= timestamp)
 		{
-			while (chunk->slots[chunk->first_value].timestamp.sec < timestamp)
+			while (vch_chunk_sec(item, chunk, chunk->first_value) < timestamp)
 			{
 				vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->first_value);
 				chunk->first_value++;
@@ -1753,6 +2089,8 @@ static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
 		vch_item_remove_chunk(item, chunk);
 		chunk = next;
 	}
+
+	vc_item_check_windows(item);
 }
 
 /******************************************************************************
@@ -1772,13 +2110,14 @@ static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
  ******************************************************************************/
 static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_record_t *value)
 {
-	int		ret = FAIL, index, sindex, nslots = 0;
+	int		ret = FAIL, index, sindex, nslots = 0, chunk_added = 0;
 	zbx_vc_chunk_t	*chunk, *schunk;
 
-	if (NULL != item->head &&
-			0 < zbx_history_record_compare_asc_func(&item->head->slots[item->head->last_value], value))
+	if (NULL != item->head && 0 < zbx_history_record_compare_asc_func(
+			&vch_chunk_values(item->head, item->value_type)[item->head->last_value], value))
 	{
-		if (0 < zbx_history_record_compare_asc_func(&item->tail->slots[item->tail->first_value], value))
+		if (0 < zbx_history_record_compare_asc_func(
+				&vch_chunk_values(item->tail, item->value_type)[item->tail->first_value], value))
 		{
 			/* If the added value has the same or older timestamp as the first value in cache */
 			/* we can't add it to keep cache consistency. Additionally we must make sure no   */
@@ -1799,6 +2138,10 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 			goto out;
 		}
 
+		/* the newer values will be shifted to free slot for the added value */
+		if (FAIL == vch_item_unpack_chunks(item, &value->timestamp))
+			goto out;
+
 		sindex = item->head->last_value;
 		schunk = item->head;
 
@@ -1806,6 +2149,8 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 		{
 			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
 				goto out;
+
+			chunk_added = 1;
 		}
 		else
 			item->head->last_value++;
@@ -1847,6 +2192,8 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 		{
 			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
 				goto out;
+
+			chunk_added = 1;
 		}
 		else
 			item->head->last_value++;
@@ -1860,6 +2207,10 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 	if (SUCCEED != vch_item_copy_value(item, chunk, index, value))
 		goto out;
 
+	/* the previous head chunk has been filled */
+	if (1 == chunk_added)
+		vch_item_pack_chunks(item);
+
 	ret = SUCCEED;
 out:
 	return ret;
@@ -1888,7 +2239,7 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 	/* skip values already added to the item cache by another process */
 	if (NULL != item->tail)
 	{
-		int	sec = item->tail->slots[item->tail->first_value].timestamp.sec;
+		int	sec = vch_chunk_sec(item, item->tail, item->tail->first_value);
 
 		while (--count >= 0 && values[count].timestamp.sec >= sec)
 			;
@@ -1899,8 +2250,9 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 	{
 		int	copy_slots, nslots = 0;
 
-		/* find the number of free slots on the left side in first (tail) chunk */
-		if (NULL != item->tail)
+		/* find the number of free slots on the left side in first (tail) chunk, */
+		/* packed chunks have no free slots                                      */
+		if (NULL != item->tail && 0 == item->tail->packed_size)
 			nslots = item->tail->first_value;
 
 		if (0 == nslots)
@@ -1922,6 +2274,8 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 			goto out;
 	}
 
+	vch_item_pack_chunks(item);
+
 	ret = SUCCEED;
 out:
 	return ret;
@@ -1959,7 +2313,7 @@ static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
 	if (NULL != (*item)->tail)
 	{
 		/* we need to get item values before the first cached value, but not including it */
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+		range_end = vch_chunk_sec(*item, (*item)->tail, (*item)->tail->first_value) - 1;
 	}
 	else
 		range_end = ZBX_JAN_2038;
@@ -2068,7 +2422,7 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 
 	/* get the end timestamp to which (including) the values should be cached */
 	if (NULL != (*item)->head)
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+		range_end = vch_chunk_sec(*item, (*item)->tail, (*item)->tail->first_value) - 1;
 	else
 		range_end = ZBX_JAN_2038;
 
@@ -2126,8 +2480,7 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 
 	if ((count <= records.values_num || 0 == range_start) && 0 != records.values_num)
 	{
-		vc_item_update_db_cached_from(*item,
-				(*item)->tail->slots[(*item)->tail->first_value].timestamp.sec);
+		vc_item_update_db_cached_from(*item, vch_chunk_sec(*item, (*item)->tail, (*item)->tail->first_value));
 	}
 	else if (0 != range_start)
 		vc_item_update_db_cached_from(*item, range_start);
@@ -2140,21 +2493,25 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves item history data from cache                            *
+ * Purpose: visits item history data in cache                                 *
  *                                                                            *
  * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order                           *
  *             seconds   - [IN] the time period to retrieve data for          *
  *             ts        - [IN] the requested period end timestamp            *
+ *             visitor   - [IN] the visitor called for values in descending  *
+ *                              order                                         *
+ *             data      - [IN] the visitor data                              *
+ *                                                                            *
+ * Return value: the number of visited values                                 *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		const zbx_timespec_t *ts)
+static int	vch_item_visit_values_by_time(const zbx_vc_item_t *item, int seconds, const zbx_timespec_t *ts,
+		zbx_vc_visitor_func_t visitor, void *data)
 {
-	int		index, now;
-	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
-	zbx_vc_chunk_t	*chunk;
+	int			index, now, values_num = 0;
+	zbx_timespec_t		start = {ts->sec - seconds, ts->ns};
+	zbx_vc_chunk_t		*chunk;
+	zbx_history_record_t	*slots;
 
 	/* Check if maximum request range is not set and all data are cached.  */
 	/* Because that indicates there was a count based request with unknown */
@@ -2169,44 +2526,59 @@ static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_hi
 	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
 	{
 		/* Cache does not contain records for the specified timeshift & seconds range. */
-		/* Return empty vector with success.                                           */
-		return;
+		/* Return with success without visiting any values.                            */
+		return 0;
 	}
 
-	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	slots = vch_chunk_values(chunk, item->value_type);
+
+	/* visit item history values until the start timestamp is reached */
+	while (0 < zbx_timespec_compare(&slots[chunk->last_value].timestamp, &start))
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
+		{
+			values_num++;
+
+			if (SUCCEED != visitor(&slots[index--], data))
+				return values_num;
+		}
 
 		if (NULL == (chunk = chunk->prev))
 			break;
 
 		index = chunk->last_value;
+		slots = vch_chunk_values(chunk, item->value_type);
 	}
+
+	return values_num;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves item history data from cache                            *
+ * Purpose: visits item history data in cache                                 *
  *                                                                            *
  * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
  *             seconds   - [IN] the time period                               *
  *             count     - [IN] the number of history values to retrieve      *
  *             timestamp - [IN] the target timestamp                          *
+ *             visitor   - [IN] the visitor called for values in descending  *
+ *                              order                                         *
+ *             data      - [IN] the visitor data                              *
+ *                                                                            *
+ * Return value: the number of visited values                                 *
+ *                                                                            *
+ * Comments: When the visitor stops the values are still counted without      *
+ *           visiting them to update the item range as if all values were     *
+ *           retrieved.                                                       *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
-		int seconds, int count, const zbx_timespec_t *ts)
+static int	vch_item_visit_values_by_time_and_count(zbx_vc_item_t *item, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_visitor_func_t visitor, void *data)
 {
-	int		index, now, range_timestamp;
-	zbx_vc_chunk_t	*chunk;
-	zbx_timespec_t	start;
+	int			index, now, range_timestamp, values_num = 0, visited_num = 0, oldest_sec = 0;
+	zbx_vc_chunk_t		*chunk;
+	zbx_timespec_t		start;
+	zbx_history_record_t	*slots;
 
 	/* set start timestamp of the requested time period */
 	if (0 != seconds)
@@ -2222,20 +2594,25 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 
 	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
 	{
-		/* return empty vector with success */
+		/* return with success without visiting any values */
 		goto out;
 	}
 
-	/* fill the values vector with item history values until the <count> values are read    */
-	/* or no more values within specified time period                                       */
-	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	/* visit item history values until the <count> values are read or no more values */
+	/* within specified time period                                                   */
+	slots = vch_chunk_values(chunk, item->value_type);
+
+	/* visit item history values until the start timestamp is reached */
+	while (0 < zbx_timespec_compare(&slots[chunk->last_value].timestamp, &start))
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
 		{
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+			if (values_num == visited_num && SUCCEED == visitor(&slots[index], data))
+				visited_num++;
+
+			oldest_sec = slots[index--].timestamp.sec;
 
-			if (values->values_num == count)
+			if (++values_num == count)
 				goto out;
 		}
 
@@ -2243,12 +2620,17 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 			break;
 
 		index = chunk->last_value;
+		slots = vch_chunk_values(chunk, item->value_type);
 	}
 out:
-	if (count > values->values_num)
+	/* count the value which stopped the visitor as visited */
+	if (visited_num < values_num)
+		visited_num++;
+
+	if (count > values_num)
 	{
 		if (0 == seconds)
-			return;
+			return visited_num;
 
 		/* not enough data in the requested period, set the range equal to the period plus */
 		/* one second to include nanosecond shifts                                         */
@@ -2257,45 +2639,43 @@ out:
 	else
 	{
 		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
-		range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
+		range_timestamp = oldest_sec - 1;
 	}
 
 	now = (int)time(NULL);
 	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+
+	return visited_num;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get item values for the specified range                           *
+ * Purpose: visit item values for the specified range                         *
  *                                                                            *
  * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
  *             seconds   - [IN] the time period to retrieve data for          *
  *             count     - [IN] the number of history values to retrieve      *
  *             ts        - [IN] the target timestamp                          *
+ *             visitor   - [IN] the visitor called for values in descending  *
+ *                              order                                         *
+ *             data      - [IN] the visitor data                              *
  *                                                                            *
- * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ * Return value:  SUCCEED - the item history data was visited successfully    *
  *                FAIL    - the item history data was not retrieved           *
  *                                                                            *
- * Comments: This function returns data from cache if necessary updating it   *
- *           from DB. If cache update was required and failed (not enough     *
- *           memory to cache DB values), then this function also fails.       *
+ * Comments: This function visits data in cache if necessary updating it from *
+ *           DB. If cache update was required and failed (not enough memory   *
+ *           to cache DB values), then this function also fails.              *
  *                                                                            *
  *           If <count> is set then value range is defined as <count> values  *
  *           before <timestamp>. Otherwise the range is defined as <seconds>  *
  *           seconds before <timestamp>.                                      *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		int count, const zbx_timespec_t *ts)
+static int	vch_item_get_values(zbx_vc_item_t *item, int seconds, int count, const zbx_timespec_t *ts,
+		zbx_vc_visitor_func_t visitor, void *data)
 {
-	int	ret, records_read, hits, misses, range_start;
-
-	zbx_vector_history_record_clear(values);
+	int	ret, records_read, hits, misses, range_start, values_num;
 
 	if (0 == count)
 	{
@@ -2307,10 +2687,7 @@ static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t
 
 		records_read = ret;
 
-		vch_item_get_values_by_time(item, values, seconds, ts);
-
-		if (records_read > values->values_num)
-			records_read = values->values_num;
+		values_num = vch_item_visit_values_by_time(item, seconds, ts, visitor, data);
 	}
 	else
 	{
@@ -2321,13 +2698,13 @@ static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t
 
 		records_read = ret;
 
-		vch_item_get_values_by_time_and_count(item, values, seconds, count, ts);
-
-		if (records_read > values->values_num)
-			records_read = values->values_num;
+		values_num = vch_item_visit_values_by_time_and_count(item, seconds, count, ts, visitor, data);
 	}
 
-	hits = values->values_num - records_read;
+	if (records_read > values_num)
+		records_read = values_num;
+
+	hits = values_num - records_read;
 	misses = records_read;
 
 	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, hits, misses);
@@ -2363,61 +2740,579 @@ static size_t	vch_item_free_cache(zbx_vc_item_t *item)
 	item->head = NULL;
 	item->tail = NULL;
 
+	freed += vc_item_free_windows(item);
+
 	return freed;
 }
 
 /******************************************************************************************************************
  *                                                                                                                *
- * Public API                                                                                                     *
+ * Sliding window aggregates                                                                                      *
  *                                                                                                                *
  ******************************************************************************************************************/
+/*
+ * Trigger functions sum(), avg(), min(), max() and count() with a time period
+ * are evaluated with every new item value. Instead of copying all period values
+ * from cache and aggregating them on each evaluation the value cache keeps
+ * running aggregates for such (item, period) pairs - windows.
+ *
+ * A window is registered by the first zbx_vc_get_window_aggregate() request
+ * and built from the cached item values. Afterwards zbx_vc_add_values() adds
+ * new values to the window and expires the values older than the new value
+ * period, so requests for the newest value period are served under read lock.
+ *
+ * The window values are always the newest window->values_num item values in
+ * cache, so they are not copied - the values are read from item chunks when
+ * the window is expired or recalculated. The window keeps the sum, min and max
+ * of its values. Min or max is recalculated when its value is expired. The
+ * window is invalidated when a value is added inside its range out of order or
+ * its values are removed from cache and is built again by the next request.
+ */
+
+static int	vc_window_value_less(unsigned char value_type, const zbx_history_value_t *v1,
+		const zbx_history_value_t *v2)
+{
+	if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		return v1->ui64 < v2->ui64 ? SUCCEED : FAIL;
+
+	return v1->dbl < v2->dbl ? SUCCEED : FAIL;
+}
 
 /******************************************************************************
  *                                                                            *
- * Purpose: initializes value cache                                           *
+ * Purpose: finds the first (oldest) window value in item chunks              *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             window - [IN] the window                                       *
+ *             pchunk - [OUT] the chunk containing the value                  *
+ *             pindex - [OUT] the value index in chunk                        *
+ *                                                                            *
+ * Return value: SUCCEED - the value was found                                *
+ *               FAIL    - the window is empty or its values are not cached   *
  *                                                                            *
  ******************************************************************************/
-int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
+static int	vc_window_get_first_value(const zbx_vc_item_t *item, const zbx_vc_window_t *window,
+		zbx_vc_chunk_t **pchunk, int *pindex)
 {
-	zbx_uint64_t	size_reserved;
-	int		ret = FAIL;
-
-	if (0 == value_cache_size)
-		return SUCCEED;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
-
-	if (SUCCEED != (ret = zbx_rwlock_create(&vc_lock, ZBX_RWLOCK_VALUECACHE, error)))
-		goto out;
+	zbx_vc_chunk_t	*chunk;
+	int		num = window->values_num, chunk_num;
 
-	size_reserved = zbx_shmem_required_size(1, "value cache size", "ValueCacheSize");
+	if (0 == num)
+		return FAIL;
 
-	if (SUCCEED != zbx_shmem_create(&vc_mem, value_cache_size, "value cache size", "ValueCacheSize", 1,
-			error))
+	for (chunk = item->head; NULL != chunk; chunk = chunk->prev)
 	{
-		goto out;
-	}
-
-	value_cache_size -= size_reserved;
+		if (num <= (chunk_num = chunk->last_value - chunk->first_value + 1))
+		{
+			*pchunk = chunk;
+			*pindex = chunk->last_value - num + 1;
 
-	vc_cache = (zbx_vc_cache_t *)__vc_shmem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
+			return SUCCEED;
+		}
 
-	if (NULL == vc_cache)
-	{
-		*error = zbx_strdup(*error, "cannot allocate value cache header");
-		goto out;
+		num -= chunk_num;
 	}
-	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
 
-	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+	return FAIL;
+}
 
-	if (NULL == vc_cache->items.slots)
-	{
-		*error = zbx_strdup(*error, "cannot allocate value cache data storage");
-		goto out;
-	}
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets window and marks it invalid                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_window_reset(zbx_vc_window_t *window)
+{
+	window->values_num = 0;
+	window->sum_dbl = 0;
+	window->sum_ui64 = 0;
+	window->removed_num = 0;
+	window->flags &= ~(ZBX_VC_WINDOW_VALID | ZBX_VC_WINDOW_MIN | ZBX_VC_WINDOW_MAX);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees window                                                      *
+ *                                                                            *
+ * Return value: the size of freed memory (bytes)                             *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_window_free(zbx_vc_window_t *window)
+{
+	__vc_shmem_free_func(window);
+
+	return sizeof(zbx_vc_window_t);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees all item windows                                            *
+ *                                                                            *
+ * Return value: the size of freed memory (bytes)                             *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_item_free_windows(zbx_vc_item_t *item)
+{
+	size_t		freed = 0;
+	zbx_vc_window_t	*window, *next;
+
+	for (window = item->windows; NULL != window; window = next)
+	{
+		next = window->next;
+		freed += vc_window_free(window);
+	}
+
+	item->windows = NULL;
+
+	return freed;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: invalidates windows with values removed from cache                *
+ *                                                                            *
+ * Parameters: item - [IN/OUT] the item                                       *
+ *                                                                            *
+ * Comments: Values are removed starting with the oldest, so the window       *
+ *           values are still cached while the item has at least as many      *
+ *           values as the window.                                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_item_check_windows(zbx_vc_item_t *item)
+{
+	zbx_vc_window_t	*window;
+
+	for (window = item->windows; NULL != window; window = window->next)
+	{
+		if (window->values_num > item->values_total)
+			vc_window_reset(window);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds value to window aggregates                                   *
+ *                                                                            *
+ * Parameters: window     - [IN/OUT] the window                               *
+ *             value_type - [IN] the item value type                          *
+ *             value      - [IN] the value                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_window_add_value(zbx_vc_window_t *window, unsigned char value_type, const zbx_history_value_t *value)
+{
+	if (ITEM_VALUE_TYPE_UINT64 == value_type)
+	{
+		window->sum_ui64 += value->ui64;
+		window->sum_dbl += (double)value->ui64;
+	}
+	else
+		window->sum_dbl += value->dbl;
+
+	if (0 == window->values_num++)
+	{
+		window->min = window->max = *value;
+		window->flags |= ZBX_VC_WINDOW_MIN | ZBX_VC_WINDOW_MAX;
+		return;
+	}
+
+	if (0 != (window->flags & ZBX_VC_WINDOW_MIN) && SUCCEED == vc_window_value_less(value_type, value,
+			&window->min))
+	{
+		window->min = *value;
+	}
+
+	if (0 != (window->flags & ZBX_VC_WINDOW_MAX) && SUCCEED == vc_window_value_less(value_type, &window->max,
+			value))
+	{
+		window->max = *value;
+	}
+}
+
+typedef struct
+{
+	zbx_vc_window_t	*window;
+	unsigned char	value_type;
+}
+zbx_vc_window_build_t;
+
+static int	vc_window_add_value_func(const zbx_history_record_t *value, void *data)
+{
+	zbx_vc_window_build_t	*build = (zbx_vc_window_build_t *)data;
+
+	vc_window_add_value(build->window, build->value_type, &value->value);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: recalculates the sum of doubles, min and max from window values   *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             window - [IN/OUT] the window                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_window_recalculate(const zbx_vc_item_t *item, zbx_vc_window_t *window)
+{
+	zbx_vc_chunk_t		*chunk;
+	zbx_history_record_t	*slots;
+	int			index, num;
+
+	if (SUCCEED != vc_window_get_first_value(item, window, &chunk, &index))
+		return;
+
+	num = window->values_num;
+	window->values_num = 0;
+	window->sum_dbl = 0;
+	window->sum_ui64 = 0;
+	window->removed_num = 0;
+
+	slots = vch_chunk_values(chunk, item->value_type);
+
+	while (window->values_num < num)
+	{
+		vc_window_add_value(window, item->value_type, &slots[index].value);
+
+		if (++index > chunk->last_value)
+		{
+			if (NULL == (chunk = chunk->next))
+				break;
+
+			index = chunk->first_value;
+			slots = vch_chunk_values(chunk, item->value_type);
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes values older than the new window start                    *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             window - [IN/OUT] the window                                   *
+ *             start  - [IN] the new window start                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_window_expire(const zbx_vc_item_t *item, zbx_vc_window_t *window, const zbx_timespec_t *start)
+{
+	zbx_vc_chunk_t			*chunk;
+	zbx_history_record_t		*slots;
+	const zbx_history_value_t	*value;
+	int				index;
+
+	if (0 <= zbx_timespec_compare(&window->start, start))
+		return;
+
+	window->start = *start;
+
+	if (SUCCEED != vc_window_get_first_value(item, window, &chunk, &index))
+		return;
+
+	slots = vch_chunk_values(chunk, item->value_type);
+
+	while (0 < window->values_num && 0 >= zbx_timespec_compare(&slots[index].timestamp, start))
+	{
+		value = &slots[index].value;
+
+		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
+		{
+			window->sum_ui64 -= value->ui64;
+			window->sum_dbl -= (double)value->ui64;
+		}
+		else
+			window->sum_dbl -= value->dbl;
+
+		/* the min or max is recalculated when requested */
+		if (FAIL == vc_window_value_less(item->value_type, &window->min, value))
+			window->flags &= ~ZBX_VC_WINDOW_MIN;
+
+		if (FAIL == vc_window_value_less(item->value_type, value, &window->max))
+			window->flags &= ~ZBX_VC_WINDOW_MAX;
+
+		window->values_num--;
+		window->removed_num++;
+
+		if (++index > chunk->last_value)
+		{
+			if (NULL == (chunk = chunk->next))
+				break;
+
+			index = chunk->first_value;
+			slots = vch_chunk_values(chunk, item->value_type);
+		}
+	}
+
+	/* recalculate the sum of doubles to drop the rounding errors accumulated by subtractions */
+	if (window->removed_num > window->values_num)
+		vc_window_recalculate(item, window);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: builds window from cached item values                             *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             window - [IN/OUT] the window                                   *
+ *             ts     - [IN] the window end timestamp                         *
+ *                                                                            *
+ * Return value: SUCCEED - the window was built                               *
+ *               FAIL    - the window values are not cached or the window end *
+ *                         is older than the newest cached value              *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_window_build(zbx_vc_item_t *item, zbx_vc_window_t *window, const zbx_timespec_t *ts)
+{
+	zbx_vc_window_build_t	build = {.window = window, .value_type = item->value_type};
+
+	if (ZBX_ITEM_STATUS_CACHED_ALL != item->status && (0 == item->db_cached_from ||
+			ts->sec - window->seconds < item->db_cached_from))
+	{
+		return FAIL;
+	}
+
+	if (NULL != item->head)
+	{
+		window->end = vch_chunk_values(item->head, item->value_type)[item->head->last_value].timestamp;
+
+		if (0 > zbx_timespec_compare(ts, &window->end))
+			return FAIL;
+	}
+	else
+		window->end.sec = window->end.ns = 0;
+
+	vc_window_reset(window);
+
+	window->start.sec = ts->sec - window->seconds;
+	window->start.ns = ts->ns;
+
+	vch_item_visit_values_by_time(item, window->seconds, ts, vc_window_add_value_func, &build);
+
+	window->flags |= ZBX_VC_WINDOW_VALID;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets aggregate of window values                                   *
+ *                                                                            *
+ * Parameters: window     - [IN] the window                                   *
+ *             value_type - [IN] the item value type                          *
+ *             ts         - [IN] the period end timestamp                     *
+ *             aggr_func  - [IN] the aggregate function (ZBX_VC_AGGR_*)       *
+ *             value      - [OUT] the aggregate value                         *
+ *             values_num - [OUT] the number of values in period              *
+ *                                                                            *
+ * Return value: SUCCEED - the aggregate was calculated                       *
+ *               FAIL    - the window must be built, expired or recalculated  *
+ *                         first                                              *
+ *                                                                            *
+ * Comments: The window is not changed, so it can be used under read lock.    *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_window_get_aggregate(const zbx_vc_window_t *window, unsigned char value_type,
+		const zbx_timespec_t *ts, int aggr_func, zbx_history_value_t *value, int *values_num)
+{
+	zbx_timespec_t	start = {ts->sec - window->seconds, ts->ns};
+
+	if (0 == (window->flags & ZBX_VC_WINDOW_VALID) || 0 > zbx_timespec_compare(ts, &window->end) ||
+			0 != zbx_timespec_compare(&start, &window->start))
+	{
+		return FAIL;
+	}
+
+	if (0 == (*values_num = window->values_num))
+	{
+		if (ZBX_VC_AGGR_SUM == aggr_func)
+			memset(value, 0, sizeof(zbx_history_value_t));
+
+		return SUCCEED;
+	}
+
+	switch (aggr_func)
+	{
+		case ZBX_VC_AGGR_SUM:
+			if (ITEM_VALUE_TYPE_UINT64 == value_type)
+				value->ui64 = window->sum_ui64;
+			else
+				value->dbl = window->sum_dbl;
+			break;
+		case ZBX_VC_AGGR_AVG:
+			value->dbl = window->sum_dbl / window->values_num;
+			break;
+		case ZBX_VC_AGGR_MIN:
+			if (0 == (window->flags & ZBX_VC_WINDOW_MIN))
+				return FAIL;
+
+			*value = window->min;
+			break;
+		case ZBX_VC_AGGR_MAX:
+			if (0 == (window->flags & ZBX_VC_WINDOW_MAX))
+				return FAIL;
+
+			*value = window->max;
+			break;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds item window                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vc_window_t	*vc_item_find_window(const zbx_vc_item_t *item, int seconds)
+{
+	zbx_vc_window_t	*window;
+
+	for (window = item->windows; NULL != window; window = window->next)
+	{
+		if (window->seconds == seconds)
+			return window;
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds item window, registers a new window if not found            *
+ *                                                                            *
+ * Parameters: item    - [IN] the item                                        *
+ *             seconds - [IN] the window length                               *
+ *                                                                            *
+ * Return value: the window or NULL if there is not enough memory             *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vc_window_t	*vc_item_get_window(zbx_vc_item_t *item, int seconds)
+{
+	zbx_vc_window_t	*window;
+
+	if (NULL != (window = vc_item_find_window(item, seconds)))
+		return window;
+
+	if (NULL == (window = (zbx_vc_window_t *)vc_item_malloc(item, sizeof(zbx_vc_window_t))))
+		return NULL;
+
+	memset(window, 0, sizeof(zbx_vc_window_t));
+	window->seconds = seconds;
+	window->next = item->windows;
+	item->windows = window;
+
+	return window;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates item windows with a value added to cache                  *
+ *                                                                            *
+ * Parameters: item  - [IN] the item                                          *
+ *             value - [IN] the added value                                   *
+ *             now   - [IN] the current time                                  *
+ *                                                                            *
+ * Comments: The windows are expired to the added value period, which is      *
+ *           usually requested next, so the request does not change window.   *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_item_update_windows(zbx_vc_item_t *item, const zbx_history_record_t *value, int now)
+{
+	zbx_vc_window_t	*window, *next, **pwindow = &item->windows;
+	zbx_timespec_t	start;
+
+	for (window = item->windows; NULL != window; window = next)
+	{
+		next = window->next;
+
+		if (window->last_accessed + ZBX_VC_WINDOW_EXPIRE_PERIOD < now)
+		{
+			*pwindow = next;
+			vc_window_free(window);
+			continue;
+		}
+
+		pwindow = &window->next;
+
+		if (0 == (window->flags & ZBX_VC_WINDOW_VALID))
+			continue;
+
+		if (0 <= zbx_timespec_compare(&value->timestamp, &window->end))
+		{
+			window->end = value->timestamp;
+			vc_window_add_value(window, item->value_type, &value->value);
+
+			start.sec = value->timestamp.sec - window->seconds;
+			start.ns = value->timestamp.ns;
+			vc_window_expire(item, window, &start);
+		}
+		else if (value->timestamp.sec >= window->start.sec)
+		{
+			/* value was added inside window out of order, the cache might also drop */
+			/* window values having the same timestamp seconds as the added value    */
+			vc_window_reset(window);
+		}
+	}
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * Public API                                                                                                     *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes value cache                                           *
+ *                                                                            *
+ * Parameters: value_cache_size        - [IN] the value cache size            *
+ *             value_cache_compression - [IN] 1 - store filled chunks of      *
+ *                                            numeric items packed            *
+ *             error                   - [OUT] the error message              *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_init(zbx_uint64_t value_cache_size, int value_cache_compression, char **error)
+{
+	zbx_uint64_t	size_reserved;
+	int		ret = FAIL;
+
+	if (0 == value_cache_size)
+		return SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (SUCCEED != (ret = zbx_rwlock_create(&vc_lock, ZBX_RWLOCK_VALUECACHE, error)))
+		goto out;
+
+	size_reserved = zbx_shmem_required_size(1, "value cache size", "ValueCacheSize");
+
+	if (SUCCEED != zbx_shmem_create(&vc_mem, value_cache_size, "value cache size", "ValueCacheSize", 1,
+			error))
+	{
+		goto out;
+	}
+
+	value_cache_size -= size_reserved;
+
+	vc_cache = (zbx_vc_cache_t *)__vc_shmem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
+
+	if (NULL == vc_cache)
+	{
+		*error = zbx_strdup(*error, "cannot allocate value cache header");
+		goto out;
+	}
+	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
+	vc_cache->compression = value_cache_compression;
+	vc_unpacked_id = 0;
+
+	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
+			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+
+	if (NULL == vc_cache->items.slots)
+	{
+		*error = zbx_strdup(*error, "cannot allocate value cache data storage");
+		goto out;
+	}
 
 	zbx_hashset_create_ext(&vc_cache->strpool, VC_STRPOOL_INIT_SIZE,
 			vc_strpool_hash_func, vc_strpool_compare_func, NULL,
@@ -2470,6 +3365,9 @@ void	zbx_vc_destroy(void)
 		zbx_rwlock_destroy(&vc_lock);
 	}
 
+	zbx_free(vc_unpacked_values);
+	vc_unpacked_id = 0;
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -2525,7 +3423,7 @@ void	zbx_vc_reset(void)
 int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush)
 {
 	zbx_vc_item_t		*item;
-	int			i;
+	int			i, now;
 	zbx_dc_history_t	*h;
 
 	if (SUCCEED != zbx_history_add_values(history, ret_flush))
@@ -2534,6 +3432,8 @@ int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush)
 	if (ZBX_VC_DISABLED == vc_state)
 		return SUCCEED;
 
+	now = (int)time(NULL);
+
 	WRLOCK_CACHE;
 
 	for (i = 0; i < history->values_num; i++)
@@ -2547,7 +3447,7 @@ int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush)
 			int			last_value_timestamp;
 
 			if (NULL != head)
-				last_value_timestamp = head->slots[head->last_value].timestamp.sec;
+				last_value_timestamp = vch_chunk_sec(item, head, head->last_value);
 			else
 				last_value_timestamp = (int)time(NULL);
 
@@ -2563,6 +3463,9 @@ int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush)
 				continue;
 			}
 
+			if (NULL != item->windows)
+				vc_item_update_windows(item, &record, now);
+
 			/* try to remove old (unused) chunks if a new chunk was added */
 			if (head != item->head)
 				vch_item_clean_cache(item, last_value_timestamp);
@@ -2576,35 +3479,33 @@ int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get item history data for the specified time period               *
+ * Purpose: visit item history data for the specified time period             *
  *                                                                            *
  * Parameters: itemid     - [IN] the item id                                  *
  *             value_type - [IN] the item value type                          *
- *             values     - [OUT] the item history data stored time/value     *
- *                          pairs in descending order                         *
  *             seconds    - [IN] the time period to retrieve data for         *
  *             count      - [IN] the number of history values to retrieve     *
  *             ts         - [IN] the period end timestamp                     *
+ *             visitor    - [IN] the visitor called for cached values in      *
+ *                               descending order                             *
+ *             data       - [IN] the visitor data                             *
+ *             values     - [OUT] the item history data read from DB when the *
+ *                                cache cannot be used                        *
+ *             cache_used - [OUT] 1 - the values were visited in cache,       *
+ *                                0 - the values were read from DB            *
  *                                                                            *
  * Return value:  SUCCEED - the item history data was retrieved successfully  *
  *                FAIL    - the item history data was not retrieved           *
  *                                                                            *
- * Comments: If the data is not in cache, it's read from DB, so this function *
- *           will always return the requested data, unless some error occurs. *
- *                                                                            *
- *           If <count> is set then value range is defined as <count> values  *
- *           before <timestamp>. Otherwise the range is defined as <seconds>  *
- *           seconds before <timestamp>.                                      *
- *                                                                            *
  ******************************************************************************/
-int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_history_record_t *values,
-		int seconds, int count, const zbx_timespec_t *ts)
+static int	vc_get_values(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_visitor_func_t visitor, void *data, zbx_vector_history_record_t *values,
+		int *cache_used)
 {
 	zbx_vc_item_t	*item, new_item;
-	int 		ret = FAIL, cache_used = 1;
+	int 		ret = FAIL;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d count:%d period:%d end_timestamp"
-			" '%s'", __func__, itemid, value_type, count, seconds, zbx_timespec_str(ts));
+	*cache_used = 1;
 
 	RDLOCK_CACHE;
 
@@ -2627,11 +3528,11 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 	else if (item->value_type != value_type)
 		goto out;
 
-	ret = vch_item_get_values(item, values, seconds, count, ts);
+	ret = vch_item_get_values(item, seconds, count, ts, visitor, data);
 out:
 	if (FAIL == ret)
 	{
-		cache_used = 0;
+		*cache_used = 0;
 
 		UNLOCK_CACHE;
 		ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts);
@@ -2646,12 +3547,104 @@ out:
 
 	UNLOCK_CACHE;
 
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get item history data for the specified time period               *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             values     - [OUT] the item history data stored time/value     *
+ *                          pairs in descending order                         *
+ *             seconds    - [IN] the time period to retrieve data for         *
+ *             count      - [IN] the number of history values to retrieve     *
+ *             ts         - [IN] the period end timestamp                     *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: If the data is not in cache, it's read from DB, so this function *
+ *           will always return the requested data, unless some error occurs. *
+ *                                                                            *
+ *           If <count> is set then value range is defined as <count> values  *
+ *           before <timestamp>. Otherwise the range is defined as <seconds>  *
+ *           seconds before <timestamp>.                                      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_history_record_t *values,
+		int seconds, int count, const zbx_timespec_t *ts)
+{
+	zbx_vc_vector_append_t	append = {.values = values, .value_type = value_type};
+	int			ret, cache_used;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d count:%d period:%d end_timestamp"
+			" '%s'", __func__, itemid, value_type, count, seconds, zbx_timespec_str(ts));
+
+	zbx_vector_history_record_clear(values);
+
+	ret = vc_get_values(itemid, value_type, seconds, count, ts, vc_history_record_vector_append_func, &append,
+			values, &cache_used);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
 			__func__, zbx_result_string(ret), values->values_num, cache_used);
 
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: visit item history data for the specified time period without     *
+ *          copying it                                                        *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             seconds    - [IN] the time period to retrieve data for         *
+ *             count      - [IN] the number of history values to retrieve     *
+ *             ts         - [IN] the period end timestamp                     *
+ *             visitor    - [IN] the visitor called for every value in        *
+ *                               descending order until it returns FAIL       *
+ *             data       - [IN] the visitor data                             *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was visited successfully    *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: The range is defined in the same way as for zbx_vc_get_values(). *
+ *                                                                            *
+ *           The values are visited in place while the cache is locked, so   *
+ *           the visitor must not access value cache and must copy the value  *
+ *           contents it needs after the visit. Only if the data cannot be    *
+ *           cached it is read from DB and visited after the cache is         *
+ *           unlocked.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_visit_values(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_visitor_func_t visitor, void *data)
+{
+	zbx_vector_history_record_t	values;
+	int				ret, cache_used, i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d count:%d period:%d end_timestamp"
+			" '%s'", __func__, itemid, value_type, count, seconds, zbx_timespec_str(ts));
+
+	zbx_history_record_vector_create(&values);
+
+	ret = vc_get_values(itemid, value_type, seconds, count, ts, visitor, data, &values, &cache_used);
+
+	for (i = 0; i < values.values_num; i++)
+	{
+		if (SUCCEED != visitor(&values.values[i], data))
+			break;
+	}
+
+	zbx_history_record_vector_destroy(&values, value_type);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s cached:%d", __func__, zbx_result_string(ret), cache_used);
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get the last history value with a timestamp less or equal to the  *
@@ -2666,29 +3659,146 @@ out:
  *               FAIL    - otherwise                                          *
  *                                                                            *
  * Comments: Depending on the value type this function might allocate memory  *
- *           to store value data. To free it use zbx_vc_history_value_clear() *
+ *           to store value data. To free it use zbx_history_record_clear()   *
  *           function.                                                        *
  *                                                                            *
  ******************************************************************************/
 int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
 		zbx_history_record_t *value)
 {
-	zbx_vector_history_record_t	values;
-	int				ret = FAIL;
+	zbx_vc_value_copy_t	copy = {.value = value, .value_type = value_type};
 
-	zbx_history_record_vector_create(&values);
+	if (SUCCEED != zbx_vc_visit_values(itemid, value_type, ts->sec, 1, ts, vc_history_record_copy_func, &copy) ||
+			0 == copy.found)
+	{
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
 
-	if (SUCCEED != zbx_vc_get_values(itemid, value_type, &values, ts->sec, 1, ts) || 0 == values.values_num)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get aggregate of item values for the specified time period        *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             seconds    - [IN] the time period                              *
+ *             ts         - [IN] the period end timestamp                     *
+ *             aggr_func  - [IN] the aggregate function (ZBX_VC_AGGR_*)       *
+ *             value      - [OUT] the sum, min or max of the item value type, *
+ *                                average as double, not set for count or     *
+ *                                if there are no values in period            *
+ *             values_num - [OUT] the number of values in period              *
+ *                                                                            *
+ * Return value:  SUCCEED - the aggregate was calculated                      *
+ *                FAIL    - the aggregate is not available, the values must   *
+ *                          be retrieved with zbx_vc_get_values()             *
+ *                                                                            *
+ * Comments: Only numeric items are supported. The first request registers    *
+ *           the (item, period) window which is built from cache once the     *
+ *           period values are cached. The window is kept up to date while    *
+ *           the requests do not go back in time, so the period end must not  *
+ *           be older than the newest item value.                             *
+ *                                                                            *
+ *           The cache is read locked when the window already covers the      *
+ *           requested period, which is the period of the newest item value.  *
+ *           Otherwise it is write locked to build or expire the window.      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_window_aggregate(zbx_uint64_t itemid, unsigned char value_type, int seconds,
+		const zbx_timespec_t *ts, int aggr_func, zbx_history_value_t *value, int *values_num)
+{
+	zbx_vc_item_t	*item;
+	zbx_vc_window_t	*window;
+	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
+	int		ret = FAIL, now;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " period:%d aggr_func:%d end_timestamp '%s'",
+			__func__, itemid, seconds, aggr_func, zbx_timespec_str(ts));
+
+	if (ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type)
+		goto finish;
+
+	now = (int)time(NULL);
+
+	RDLOCK_CACHE;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		goto out;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)) ||
+			item->value_type != value_type)
+	{
+		goto out;
+	}
+
+	if (NULL != (window = vc_item_find_window(item, seconds)) && SUCCEED == vc_window_get_aggregate(window,
+			value_type, ts, aggr_func, value, values_num))
+	{
+		vc_cache_item_update(itemid, ZBX_VC_UPDATE_WINDOW, seconds, now);
+
+		/* keep the period values cached to build the window again when necessary */
+		if (0 != item->active_range || ZBX_ITEM_STATUS_CACHED_ALL != item->status)
+			vc_cache_item_update(itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
+
+		vc_cache_item_update(itemid, ZBX_VC_UPDATE_STATS, *values_num, 0);
+
+		ret = SUCCEED;
+		goto out;
+	}
+
+	UNLOCK_CACHE;
+
+	WRLOCK_CACHE;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		goto out;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)) ||
+			item->value_type != value_type)
+	{
+		goto out;
+	}
+
+	if (NULL == (window = vc_item_get_window(item, seconds)))
+		goto out;
+
+	window->last_accessed = now;
+
+	if (0 == (window->flags & ZBX_VC_WINDOW_VALID))
+	{
+		if (SUCCEED != vc_window_build(item, window, ts))
+			goto out;
+	}
+	else if (0 > zbx_timespec_compare(ts, &window->end) || 0 > zbx_timespec_compare(&start, &window->start))
 		goto out;
 
-	*value = values.values[0];
+	vc_window_expire(item, window, &start);
 
-	/* reset values vector size so the returned value is not cleared when destroying the vector */
-	values.values_num = 0;
+	if ((ZBX_VC_AGGR_MIN == aggr_func && 0 == (window->flags & ZBX_VC_WINDOW_MIN)) ||
+			(ZBX_VC_AGGR_MAX == aggr_func && 0 == (window->flags & ZBX_VC_WINDOW_MAX)))
+	{
+		vc_window_recalculate(item, window);
+	}
+
+	if (SUCCEED != vc_window_get_aggregate(window, value_type, ts, aggr_func, value, values_num))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		goto out;
+	}
+
+	/* keep the period values cached to build the window again when necessary */
+	if (0 != item->active_range || ZBX_ITEM_STATUS_CACHED_ALL != item->status)
+		vch_item_update_range(item, seconds + now - ts->sec + 1, now);
+
+	vc_update_statistics(item, window->values_num, 0, now);
 
 	ret = SUCCEED;
 out:
-	zbx_history_record_vector_destroy(&values, value_type);
+	UNLOCK_CACHE;
+finish:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
 }
@@ -2833,6 +3943,7 @@ void	zbx_vc_flush_stats(void)
 {
 	int		i, now;
 	zbx_vc_item_t	*item = NULL;
+	zbx_vc_window_t	*window;
 	zbx_uint64_t	itemid = 0;
 
 	if (ZBX_VC_DISABLED == vc_state || 0 == vc_itemupdates.values_num)
@@ -2867,6 +3978,13 @@ void	zbx_vc_flush_stats(void)
 				vc_update_statistics(item, update->data[ZBX_VC_UPDATE_STATS_HITS],
 						update->data[ZBX_VC_UPDATE_STATS_MISSES], now);
 				break;
+			case ZBX_VC_UPDATE_WINDOW:
+				if (NULL != (window = vc_item_find_window(item,
+						update->data[ZBX_VC_UPDATE_WINDOW_SECONDS])))
+				{
+					window->last_accessed = update->data[ZBX_VC_UPDATE_WINDOW_NOW];
+				}
+				break;
 		}
 	}
 
@@ -0,0 +1,207 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "vc_pack.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes variable length encoded unsigned integer                   *
+ *                                                                            *
+ * Parameters: ptr   - [OUT] the output buffer                                *
+ *             value - [IN] the value to write                                *
+ *                                                                            *
+ * Return value: the number of bytes written                                  *
+ *                                                                            *
+ ******************************************************************************/
+int	vc_pack_varint(unsigned char *ptr, zbx_uint64_t value)
+{
+	int	len = 0;
+
+	while (0x80 <= value)
+	{
+		ptr[len++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+
+	ptr[len++] = (unsigned char)value;
+
+	return len;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads variable length encoded unsigned integer                    *
+ *                                                                            *
+ * Parameters: ptr   - [IN] the input buffer                                  *
+ *             value - [OUT] the value read                                   *
+ *                                                                            *
+ * Return value: the number of bytes read                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	vc_unpack_varint(const unsigned char *ptr, zbx_uint64_t *value)
+{
+	int	len = 0, shift = 0;
+
+	*value = 0;
+
+	do
+	{
+		*value |= (zbx_uint64_t)(ptr[len] & 0x7f) << shift;
+		shift += 7;
+	}
+	while (0 != (ptr[len++] & 0x80));
+
+	return len;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: maps signed integer to unsigned so that values with small         *
+ *          magnitude have small variable length encoding                     *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	vc_zigzag_encode(zbx_int64_t value)
+{
+	return ((zbx_uint64_t)value << 1) ^ (0 > value ? ~__UINT64_C(0) : __UINT64_C(0));
+}
+
+static zbx_int64_t	vc_zigzag_decode(zbx_uint64_t value)
+{
+	return (zbx_int64_t)(value >> 1) ^ -(zbx_int64_t)(value & 1);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: packs numeric item values                                         *
+ *                                                                            *
+ * Parameters: values     - [IN] the values to pack                           *
+ *             values_num - [IN] the number of values                         *
+ *             value_type - [IN] the value type (float or unsigned)           *
+ *             buf        - [OUT] the packed data, must have space for        *
+ *                          ZBX_VC_PACKED_RECORD_SIZE_MAX bytes per value     *
+ *                                                                            *
+ * Return value: the size of packed data                                      *
+ *                                                                            *
+ * Comments: Timestamp seconds are stored as delta of deltas and nanoseconds  *
+ *           as is, both variable length encoded.                             *
+ *           Floating point values are stored as XOR with the previous value, *
+ *           dropping leading and trailing zero bytes - one header byte holds *
+ *           the number of leading (high nibble) and trailing (low nibble)    *
+ *           zero bytes, followed by the remaining bytes.                     *
+ *           Unsigned values are stored as variable length encoded deltas.    *
+ *                                                                            *
+ ******************************************************************************/
+int	vc_pack_values(const zbx_history_record_t *values, int values_num, unsigned char value_type,
+		unsigned char *buf)
+{
+	int		i, j, lz, tz;
+	unsigned char	*ptr = buf;
+	zbx_int64_t	delta, delta_prev = 0;
+	zbx_uint64_t	bits, bits_prev = 0;
+	int		sec_prev = 0;
+
+	for (i = 0; i < values_num; i++)
+	{
+		delta = (zbx_int64_t)values[i].timestamp.sec - sec_prev;
+		ptr += vc_pack_varint(ptr, vc_zigzag_encode(delta - delta_prev));
+		delta_prev = delta;
+		sec_prev = values[i].timestamp.sec;
+
+		ptr += vc_pack_varint(ptr, (zbx_uint64_t)values[i].timestamp.ns);
+
+		if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		{
+			ptr += vc_pack_varint(ptr, vc_zigzag_encode((zbx_int64_t)(values[i].value.ui64 - bits_prev)));
+			bits_prev = values[i].value.ui64;
+			continue;
+		}
+
+		memcpy(&bits, &values[i].value.dbl, sizeof(bits));
+
+		if (0 == (bits ^ bits_prev))
+		{
+			*ptr++ = 0x80;
+			continue;
+		}
+
+		for (lz = 0; 0 == (((bits ^ bits_prev) >> (56 - lz * 8)) & 0xff); lz++)
+			;
+
+		for (tz = 0; 0 == (((bits ^ bits_prev) >> (tz * 8)) & 0xff); tz++)
+			;
+
+		*ptr++ = (unsigned char)(lz << 4 | tz);
+
+		for (j = 7 - lz; j >= tz; j--)
+			*ptr++ = (unsigned char)((bits ^ bits_prev) >> (j * 8));
+
+		bits_prev = bits;
+	}
+
+	return (int)(ptr - buf);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unpacks numeric item values packed with vc_pack_values()          *
+ *                                                                            *
+ * Parameters: data       - [IN] the packed data                              *
+ *             values_num - [IN] the number of packed values                  *
+ *             value_type - [IN] the value type (float or unsigned)           *
+ *             values     - [OUT] the unpacked values, must have space for    *
+ *                          values_num values                                 *
+ *                                                                            *
+ ******************************************************************************/
+void	vc_unpack_values(const unsigned char *data, int values_num, unsigned char value_type,
+		zbx_history_record_t *values)
+{
+	int			i, j, lz, tz;
+	const unsigned char	*ptr = data;
+	zbx_int64_t		delta = 0;
+	zbx_uint64_t		value, bits = 0, xor;
+	int			sec = 0;
+
+	for (i = 0; i < values_num; i++)
+	{
+		ptr += vc_unpack_varint(ptr, &value);
+		delta += vc_zigzag_decode(value);
+		sec += (int)delta;
+		values[i].timestamp.sec = sec;
+
+		ptr += vc_unpack_varint(ptr, &value);
+		values[i].timestamp.ns = (int)value;
+
+		if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		{
+			ptr += vc_unpack_varint(ptr, &value);
+			bits += (zbx_uint64_t)vc_zigzag_decode(value);
+			values[i].value.ui64 = bits;
+			continue;
+		}
+
+		lz = *ptr >> 4;
+		tz = *ptr++ & 0x0f;
+
+		for (xor = 0, j = 7 - lz; j >= tz; j--)
+			xor |= (zbx_uint64_t)*ptr++ << (j * 8);
+
+		bits ^= xor;
+		memcpy(&values[i].value.dbl, &bits, sizeof(bits));
+	}
+}
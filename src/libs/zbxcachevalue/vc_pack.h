@@ -0,0 +1,39 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_VC_PACK_H
+#define ZABBIX_VC_PACK_H
+
+#include "zbxhistory.h"
+
+/* the maximum size of variable length encoded 64 bit integer */
+#define ZBX_VC_VARINT_SIZE_MAX		10
+
+/* the maximum size of packed value - timestamp seconds, nanoseconds and value */
+#define ZBX_VC_PACKED_RECORD_SIZE_MAX	(ZBX_VC_VARINT_SIZE_MAX * 3)
+
+int	vc_pack_varint(unsigned char *ptr, zbx_uint64_t value);
+int	vc_unpack_varint(const unsigned char *ptr, zbx_uint64_t *value);
+
+int	vc_pack_values(const zbx_history_record_t *values, int values_num, unsigned char value_type,
+		unsigned char *buf);
+void	vc_unpack_values(const unsigned char *data, int values_num, unsigned char value_type,
+		zbx_history_record_t *values);
+
+#endif
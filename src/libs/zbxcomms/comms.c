@@ -1569,6 +1569,145 @@ void	zbx_tcp_unaccept(zbx_socket_t *s)
 	s->accepted = 0;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: accept an incoming connection without waiting for it              *
+ *                                                                            *
+ * Parameters: listen_socket - [IN] listening socket                          *
+ *             s             - [OUT] socket for the accepted connection       *
+ *             timeout       - [IN] timeout for operations on the connection  *
+ *                                                                            *
+ * Return value: SUCCEED       - connection is accepted, connection type is   *
+ *                               detected by zbx_tcp_accept_step()            *
+ *               FAIL          - an error occurred                            *
+ *               TIMEOUT_ERROR - no pending connections                       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_accept_nowait(ZBX_SOCKET listen_socket, zbx_socket_t *s, int timeout)
+{
+	ZBX_SOCKADDR	serv_addr;
+	ZBX_SOCKET	accepted_socket;
+	ZBX_SOCKLEN_T	nlen;
+
+	zbx_socket_clean(s);
+
+	nlen = sizeof(serv_addr);
+	if (ZBX_SOCKET_ERROR == (accepted_socket = (ZBX_SOCKET)accept(listen_socket, (struct sockaddr *)&serv_addr,
+			&nlen)))
+	{
+		if (SUCCEED == zbx_socket_had_nonblocking_error())
+			return TIMEOUT_ERROR;
+
+		zbx_set_socket_strerror("accept() failed: %s", zbx_strerror_from_system(zbx_socket_last_error()));
+
+		return FAIL;
+	}
+
+	s->socket = accepted_socket;
+	s->socket_orig = ZBX_SOCKET_ERROR;
+	s->accepted = 1;
+	s->timeout = timeout;
+
+	if (SUCCEED != socket_set_nonblocking(accepted_socket))
+	{
+		zbx_set_socket_strerror("failed to set socket non-blocking mode: %s",
+				zbx_strerror_from_system(zbx_socket_last_error()));
+		zbx_tcp_unaccept(s);
+		return FAIL;
+	}
+
+	if (SUCCEED != zbx_socket_peer_ip_save(s))
+	{
+		/* cannot get peer IP address */
+		zbx_tcp_unaccept(s);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: detect connection type and perform the next step of TLS           *
+ *          handshake on a connection accepted by zbx_tcp_accept_nowait()     *
+ *                                                                            *
+ * Parameters: s          - [IN/OUT] accepted connection                      *
+ *             tls_accept - [IN] TLS configuration                            *
+ *             events     - [OUT] POLLIN or POLLOUT if the socket must be     *
+ *                                waited for before calling this function     *
+ *                                again, 0 when the connection is accepted    *
+ *                                                                            *
+ * Return value: SUCCEED - the connection is accepted or waits for events     *
+ *               FAIL    - an error occurred, the connection must be closed   *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_accept_step(zbx_socket_t *s, unsigned int tls_accept, short *events)
+{
+	*events = 0;
+
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	if (NULL == s->tls_ctx)
+#endif
+	{
+		ssize_t	res;
+		char	buf;	/* 1 byte buffer */
+
+		if (ZBX_PROTO_ERROR == (res = ZBX_TCP_RECV(s->socket, &buf, 1, MSG_PEEK)))
+		{
+			if (SUCCEED == zbx_socket_had_nonblocking_error())
+			{
+				*events = POLLIN;
+				return SUCCEED;
+			}
+
+			zbx_set_socket_strerror("from %s: reading first byte from connection failed: %s", s->peer,
+					zbx_strerror_from_system(zbx_socket_last_error()));
+			return FAIL;
+		}
+
+		/* if the 1st byte is 0x16 then assume it's a TLS connection */
+		if (1 != res || '\x16' != buf)
+		{
+			if (0 == (tls_accept & ZBX_TCP_SEC_UNENCRYPTED))
+			{
+				zbx_set_socket_strerror("from %s: unencrypted connections are not allowed", s->peer);
+				return FAIL;
+			}
+
+			s->connection_type = ZBX_TCP_SEC_UNENCRYPTED;
+			return SUCCEED;
+		}
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+		if (0 == (tls_accept & (ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK)))
+		{
+			zbx_set_socket_strerror("from %s: TLS connections are not allowed", s->peer);
+			return FAIL;
+		}
+#else
+		zbx_set_socket_strerror("from %s: support for TLS was not compiled in", s->peer);
+		return FAIL;
+#endif
+	}
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	{
+		char	*error = NULL;
+		int	ret;
+
+		zbx_socket_set_deadline(s, s->timeout);
+
+		if (SUCCEED != (ret = zbx_tls_accept_step(s, tls_accept, events, &error)))
+		{
+			zbx_set_socket_strerror("from %s: %s", s->peer, error);
+			zbx_free(error);
+		}
+
+		zbx_socket_set_deadline(s, 0);
+
+		return ret;
+	}
+#endif
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: finds the next line in socket data buffer                         *
@@ -1777,267 +1916,673 @@ int	zbx_socket_check_deadline(zbx_socket_t *s)
 	return zbx_ts_check_deadline(&s->deadline);
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: receive data                                                      *
- *                                                                            *
- * Return value: number of bytes received - success,                          *
- *               FAIL - an error occurred                                     *
- *                                                                            *
- ******************************************************************************/
-ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout, unsigned char flags)
-{
 #define ZBX_TCP_EXPECT_HEADER		1
 #define ZBX_TCP_EXPECT_VERSION		2
 #define ZBX_TCP_EXPECT_VERSION_VALIDATE	3
 #define ZBX_TCP_EXPECT_LENGTH		4
 #define ZBX_TCP_EXPECT_SIZE		5
 
-	ssize_t		nbytes;
-	size_t		buf_dyn_bytes = 0, buf_stat_bytes = 0, offset = 0;
-	zbx_uint64_t	expected_len = 16 * ZBX_MEBIBYTE, reserved = 0, max_len;
-	unsigned char	expect = ZBX_TCP_EXPECT_HEADER;
-	int		protocol_version;
+#define ZBX_TCP_RECV_MORE	0
+#define ZBX_TCP_RECV_STOP	1
+#define ZBX_TCP_RECV_ERROR	2
+
+/* initial size of dynamic buffer, it is grown as the message arrives and is not consumed */
+#define ZBX_TCP_RECV_BUF_INIT	(8 * ZBX_STAT_BUF_LEN)
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepare socket and context for receiving a message                *
+ *                                                                            *
+ * Parameters: s       - [IN] the socket                                      *
+ *             context - [OUT] the receiving state                            *
+ *             flags   - [IN] ZBX_TCP_LARGE to allow large messages           *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tcp_recv_context_init(zbx_socket_t *s, zbx_tcp_recv_context_t *context, unsigned char flags)
+{
+	context->buf_dyn_bytes = 0;
+	context->buf_dyn_alloc = 0;
+	context->buf_stat_bytes = 0;
+	context->offset = 0;
+	context->expected_len = 16 * ZBX_MEBIBYTE;
+	context->reserved = 0;
+	context->expect = ZBX_TCP_EXPECT_HEADER;
+	context->flags = flags;
+	context->protocol_version = 0;
+	context->stream = NULL;
+	context->consumed = 0;
+	context->consume_cb = NULL;
+	context->consume_arg = NULL;
 #if defined(_WINDOWS)
-	max_len = ZBX_MAX_RECV_DATA_SIZE;
+	context->max_len = ZBX_MAX_RECV_DATA_SIZE;
 #else
-	max_len = 0 != (flags & ZBX_TCP_LARGE) ? ZBX_MAX_RECV_LARGE_DATA_SIZE : ZBX_MAX_RECV_DATA_SIZE;
+	context->max_len = 0 != (flags & ZBX_TCP_LARGE) ? ZBX_MAX_RECV_LARGE_DATA_SIZE : ZBX_MAX_RECV_DATA_SIZE;
 #endif
 	zbx_socket_free(s);
 
 	s->buf_type = ZBX_BUF_TYPE_STAT;
 	s->buffer = s->buf_stat;
+}
 
-	if (0 != timeout)
-		zbx_socket_set_deadline(s, timeout);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: set callback to process large message while it is being received  *
+ *                                                                            *
+ * Parameters: context     - [IN/OUT] the receiving state                     *
+ *             consume_cb  - [IN] the callback                                *
+ *             consume_arg - [IN] the callback argument                       *
+ *                                                                            *
+ * Comments: The callback is called with the message data received so far     *
+ *           every time a part of message is received into the dynamic        *
+ *           buffer. Data removed by the callback is not kept in memory and   *
+ *           is missing from the received message.                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tcp_recv_context_set_consumer(zbx_tcp_recv_context_t *context, zbx_tcp_recv_consume_func_t consume_cb,
+		void *consume_arg)
+{
+	context->consume_cb = consume_cb;
+	context->consume_arg = consume_arg;
+}
 
-	while (0 != (nbytes = zbx_tcp_read(s, s->buf_stat + buf_stat_bytes, sizeof(s->buf_stat) - buf_stat_bytes)))
+/******************************************************************************
+ *                                                                            *
+ * Purpose: release resources of message receiving that was not finished      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tcp_recv_context_clear(zbx_tcp_recv_context_t *context)
+{
+	if (NULL != context->stream)
 	{
-		if (ZBX_PROTO_ERROR == nbytes)
-			goto out;
+		zbx_uncompress_stream_free(context->stream);
+		context->stream = NULL;
+	}
+}
 
-		if (ZBX_BUF_TYPE_STAT == s->buf_type)
-			buf_stat_bytes += (size_t)nbytes;
-		else
+/******************************************************************************
+ *                                                                            *
+ * Purpose: pass the data received into dynamic buffer to the consumer        *
+ *                                                                            *
+ ******************************************************************************/
+static void	tcp_recv_context_consume(zbx_socket_t *s, zbx_tcp_recv_context_t *context)
+{
+	size_t	size, left;
+
+	if (NULL == context->consume_cb)
+		return;
+
+	if (NULL != context->stream)
+		size = zbx_uncompress_stream_size(context->stream);
+	else
+		size = (size_t)MIN(context->buf_dyn_bytes, context->expected_len);
+
+	left = (size -= context->consumed);
+
+	if (SUCCEED != context->consume_cb(s->buffer, &left, context->consume_arg))
+		context->consume_cb = NULL;
+
+	if (left < size)
+	{
+		context->consumed += size - left;
+
+		if (NULL != context->stream)
+			zbx_uncompress_stream_discard(context->stream, size - left);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: make sure dynamic buffer can hold the specified number of bytes   *
+ *                                                                            *
+ * Parameters: s       - [IN/OUT] the socket                                  *
+ *             context - [IN/OUT] the receiving state                         *
+ *             size    - [IN] the required buffer size                        *
+ *             max     - [IN] the maximum buffer size                         *
+ *                                                                            *
+ * Comments: The buffer is doubled to avoid reallocating it for every part of *
+ *           message that is not consumed.                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	tcp_recv_context_reserve(zbx_socket_t *s, zbx_tcp_recv_context_t *context, size_t size, size_t max)
+{
+	if (size <= context->buf_dyn_alloc)
+		return;
+
+	context->buf_dyn_alloc = MAX(size, MIN(context->buf_dyn_alloc * 2, max));
+	s->buffer = (char *)zbx_realloc(s->buffer, context->buf_dyn_alloc);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: uncompress received part of large message                         *
+ *                                                                            *
+ * Parameters: s       - [IN/OUT] the socket                                  *
+ *             context - [IN/OUT] the receiving state                         *
+ *             data    - [IN] the compressed data part                        *
+ *             size    - [IN] the data part size                              *
+ *                                                                            *
+ * Return value: SUCCEED - the data part was uncompressed                     *
+ *               FAIL    - the data is corrupted or larger than expected      *
+ *                                                                            *
+ * Comments: Uncompressed data is passed to the consumer whenever the buffer  *
+ *           becomes full. If the consumer does not free any space the buffer *
+ *           is grown up to the uncompressed message size.                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	tcp_recv_context_uncompress(zbx_socket_t *s, zbx_tcp_recv_context_t *context, const char *data,
+		size_t size)
+{
+	if (SUCCEED != zbx_uncompress_stream_write(context->stream, data, size))
+		goto out;
+
+	while (0 != zbx_uncompress_stream_pending(context->stream))
+	{
+		size_t	consumed = context->consumed;
+
+		tcp_recv_context_consume(s, context);
+
+		if (consumed == context->consumed)
 		{
-			if (buf_dyn_bytes + (size_t)nbytes <= expected_len)
-				memcpy(s->buffer + buf_dyn_bytes, s->buf_stat, (size_t)nbytes);
-			buf_dyn_bytes += (size_t)nbytes;
+			if (context->buf_dyn_alloc > context->reserved)
+			{
+				zbx_set_socket_strerror("size of uncompressed data is more than expected");
+				return FAIL;
+			}
+
+			tcp_recv_context_reserve(s, context, context->buf_dyn_alloc + 1, context->reserved + 1);
+			zbx_uncompress_stream_set_output(context->stream, s->buffer, context->buf_dyn_alloc - 1);
 		}
 
-		if (buf_stat_bytes + buf_dyn_bytes >= expected_len)
-			break;
+		if (SUCCEED != zbx_uncompress_stream_resume(context->stream))
+			goto out;
+	}
+
+	return SUCCEED;
+out:
+	zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
 
-		if (ZBX_TCP_EXPECT_HEADER == expect)
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process received bytes stored in socket static buffer             *
+ *                                                                            *
+ * Parameters: s       - [IN] the socket                                      *
+ *             context - [IN/OUT] the receiving state                         *
+ *             nbytes  - [IN] number of bytes received                        *
+ *                                                                            *
+ * Return value: ZBX_TCP_RECV_MORE  - more data is expected                   *
+ *               ZBX_TCP_RECV_STOP  - receiving must be stopped, the result   *
+ *                                    is checked by tcp_recv_context_finish() *
+ *               ZBX_TCP_RECV_ERROR - the message must be ignored             *
+ *                                                                            *
+ ******************************************************************************/
+static int	tcp_recv_context_process(zbx_socket_t *s, zbx_tcp_recv_context_t *context, ssize_t nbytes)
+{
+	if (ZBX_BUF_TYPE_STAT == s->buf_type)
+		context->buf_stat_bytes += (size_t)nbytes;
+	else
+	{
+		if (context->buf_dyn_bytes + (size_t)nbytes <= context->expected_len)
 		{
-			if (ZBX_TCP_HEADER_LEN > buf_stat_bytes)
+			if (NULL != context->stream)
 			{
-				if (0 == strncmp(s->buf_stat, ZBX_TCP_HEADER_DATA, buf_stat_bytes))
-					continue;
-
-				break;
+				if (SUCCEED != tcp_recv_context_uncompress(s, context, s->buf_stat, (size_t)nbytes))
+					goto uncompress_error;
 			}
 			else
 			{
-				if (0 != strncmp(s->buf_stat, ZBX_TCP_HEADER_DATA, ZBX_TCP_HEADER_LEN))
-				{
-					/* invalid header, abort receiving */
-					break;
-				}
-
-				expect = ZBX_TCP_EXPECT_VERSION;
-				offset += ZBX_TCP_HEADER_LEN;
+				tcp_recv_context_reserve(s, context, context->buf_dyn_bytes - context->consumed +
+						(size_t)nbytes + 1, context->expected_len + 1);
+				memcpy(s->buffer + context->buf_dyn_bytes - context->consumed, s->buf_stat, (size_t)nbytes);
 			}
 		}
+		context->buf_dyn_bytes += (size_t)nbytes;
 
-		if (ZBX_TCP_EXPECT_VERSION == expect)
-		{
-			if (offset + 1 > buf_stat_bytes)
-				continue;
+		if (context->buf_dyn_bytes <= context->expected_len)
+			tcp_recv_context_consume(s, context);
+	}
+
+	if (context->buf_stat_bytes + context->buf_dyn_bytes >= context->expected_len)
+		return ZBX_TCP_RECV_STOP;
 
-			expect = ZBX_TCP_EXPECT_VERSION_VALIDATE;
-			protocol_version = s->buf_stat[ZBX_TCP_HEADER_LEN];
+	if (ZBX_TCP_EXPECT_HEADER == context->expect)
+	{
+		if (ZBX_TCP_HEADER_LEN > context->buf_stat_bytes)
+		{
+			if (0 == strncmp(s->buf_stat, ZBX_TCP_HEADER_DATA, context->buf_stat_bytes))
+				return ZBX_TCP_RECV_MORE;
 
-			if (0 == (protocol_version & ZBX_TCP_PROTOCOL) ||
-					protocol_version > (ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS | flags))
+			return ZBX_TCP_RECV_STOP;
+		}
+		else
+		{
+			if (0 != strncmp(s->buf_stat, ZBX_TCP_HEADER_DATA, ZBX_TCP_HEADER_LEN))
 			{
-				/* invalid protocol version, abort receiving */
-				break;
+				/* invalid header, abort receiving */
+				return ZBX_TCP_RECV_STOP;
 			}
-			s->protocol = protocol_version;
-			expect = ZBX_TCP_EXPECT_LENGTH;
-			offset++;
+
+			context->expect = ZBX_TCP_EXPECT_VERSION;
+			context->offset += ZBX_TCP_HEADER_LEN;
 		}
+	}
+
+	if (ZBX_TCP_EXPECT_VERSION == context->expect)
+	{
+		if (context->offset + 1 > context->buf_stat_bytes)
+			return ZBX_TCP_RECV_MORE;
 
-		if (ZBX_TCP_EXPECT_LENGTH == expect)
+		context->expect = ZBX_TCP_EXPECT_VERSION_VALIDATE;
+		context->protocol_version = s->buf_stat[ZBX_TCP_HEADER_LEN];
+
+		if (0 == (context->protocol_version & ZBX_TCP_PROTOCOL) ||
+				context->protocol_version > (ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS | context->flags))
 		{
-			if (0 != (protocol_version & ZBX_TCP_LARGE))
-			{
-				zbx_uint64_t	len64_le;
+			/* invalid protocol version, abort receiving */
+			return ZBX_TCP_RECV_STOP;
+		}
+		s->protocol = context->protocol_version;
+		context->expect = ZBX_TCP_EXPECT_LENGTH;
+		context->offset++;
+	}
 
-				if (offset + 2 * sizeof(len64_le) > buf_stat_bytes)
-					continue;
+	if (ZBX_TCP_EXPECT_LENGTH == context->expect)
+	{
+		if (0 != (context->protocol_version & ZBX_TCP_LARGE))
+		{
+			zbx_uint64_t	len64_le;
 
-				memcpy(&len64_le, s->buf_stat + offset, sizeof(len64_le));
-				offset += sizeof(len64_le);
-				expected_len = zbx_letoh_uint64(len64_le);
+			if (context->offset + 2 * sizeof(len64_le) > context->buf_stat_bytes)
+				return ZBX_TCP_RECV_MORE;
 
-				memcpy(&len64_le, s->buf_stat + offset, sizeof(len64_le));
-				offset += sizeof(len64_le);
-				reserved = zbx_letoh_uint64(len64_le);
-			}
-			else
-			{
-				zbx_uint32_t	len32_le;
+			memcpy(&len64_le, s->buf_stat + context->offset, sizeof(len64_le));
+			context->offset += sizeof(len64_le);
+			context->expected_len = zbx_letoh_uint64(len64_le);
 
-				if (offset + 2 * sizeof(len32_le) > buf_stat_bytes)
-					continue;
+			memcpy(&len64_le, s->buf_stat + context->offset, sizeof(len64_le));
+			context->offset += sizeof(len64_le);
+			context->reserved = zbx_letoh_uint64(len64_le);
+		}
+		else
+		{
+			zbx_uint32_t	len32_le;
 
-				memcpy(&len32_le, s->buf_stat + offset, sizeof(len32_le));
-				offset += sizeof(len32_le);
-				expected_len = zbx_letoh_uint32(len32_le);
+			if (context->offset + 2 * sizeof(len32_le) > context->buf_stat_bytes)
+				return ZBX_TCP_RECV_MORE;
 
-				memcpy(&len32_le, s->buf_stat + offset, sizeof(len32_le));
-				offset += sizeof(len32_le);
-				reserved = zbx_letoh_uint32(len32_le);
-			}
+			memcpy(&len32_le, s->buf_stat + context->offset, sizeof(len32_le));
+			context->offset += sizeof(len32_le);
+			context->expected_len = zbx_letoh_uint32(len32_le);
 
-			if (max_len < expected_len)
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "Message size " ZBX_FS_UI64 " from %s exceeds the "
-						"maximum size " ZBX_FS_UI64 " bytes. Message ignored.", expected_len,
-						s->peer, max_len);
-				nbytes = ZBX_PROTO_ERROR;
-				goto out;
-			}
+			memcpy(&len32_le, s->buf_stat + context->offset, sizeof(len32_le));
+			context->offset += sizeof(len32_le);
+			context->reserved = zbx_letoh_uint32(len32_le);
+		}
 
-			/* compressed protocol stores uncompressed packet size in the reserved data */
-			if (max_len < reserved)
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "Uncompressed message size " ZBX_FS_UI64 " from %s"
-						" exceeds the maximum size " ZBX_FS_UI64 " bytes. Message ignored.",
-						reserved, s->peer, max_len);
-				nbytes = ZBX_PROTO_ERROR;
-				goto out;
-			}
+		if (context->max_len < context->expected_len)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "Message size " ZBX_FS_UI64 " from %s exceeds the "
+					"maximum size " ZBX_FS_UI64 " bytes. Message ignored.", context->expected_len,
+					s->peer, context->max_len);
+			return ZBX_TCP_RECV_ERROR;
+		}
 
-			if (sizeof(s->buf_stat) > expected_len)
+		/* compressed protocol stores uncompressed packet size in the reserved data */
+		if (context->max_len < context->reserved)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "Uncompressed message size " ZBX_FS_UI64 " from %s"
+					" exceeds the maximum size " ZBX_FS_UI64 " bytes. Message ignored.",
+					context->reserved, s->peer, context->max_len);
+			return ZBX_TCP_RECV_ERROR;
+		}
+
+		if (sizeof(s->buf_stat) > context->expected_len)
+		{
+			context->buf_stat_bytes -= context->offset;
+			memmove(s->buf_stat, s->buf_stat + context->offset, context->buf_stat_bytes);
+		}
+		else
+		{
+			s->buf_type = ZBX_BUF_TYPE_DYN;
+			context->buf_dyn_bytes = context->buf_stat_bytes - context->offset;
+			context->buf_stat_bytes = 0;
+
+			/* large compressed message is uncompressed as it arrives instead of being buffered whole */
+			if (0 != (context->protocol_version & ZBX_TCP_COMPRESS))
 			{
-				buf_stat_bytes -= offset;
-				memmove(s->buf_stat, s->buf_stat + offset, buf_stat_bytes);
+				context->buf_dyn_alloc = (size_t)MIN(context->reserved, ZBX_TCP_RECV_BUF_INIT) + 1;
+				s->buffer = (char *)zbx_malloc(NULL, context->buf_dyn_alloc);
+
+				if (NULL == (context->stream = zbx_uncompress_stream_create(s->buffer,
+						context->buf_dyn_alloc - 1)))
+				{
+					zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
+					goto uncompress_error;
+				}
+
+				if (context->buf_dyn_bytes <= context->expected_len && SUCCEED !=
+						tcp_recv_context_uncompress(s, context, s->buf_stat + context->offset,
+						context->buf_dyn_bytes))
+				{
+					goto uncompress_error;
+				}
 			}
 			else
 			{
-				s->buf_type = ZBX_BUF_TYPE_DYN;
-				s->buffer = (char *)zbx_malloc(NULL, expected_len + 1);
-				buf_dyn_bytes = buf_stat_bytes - offset;
-				buf_stat_bytes = 0;
-				memcpy(s->buffer, s->buf_stat + offset, buf_dyn_bytes);
+				context->buf_dyn_alloc = (size_t)MIN(context->expected_len, ZBX_TCP_RECV_BUF_INIT) + 1;
+				s->buffer = (char *)zbx_malloc(NULL, context->buf_dyn_alloc);
+				memcpy(s->buffer, s->buf_stat + context->offset, context->buf_dyn_bytes);
 			}
 
-			expect = ZBX_TCP_EXPECT_SIZE;
-
-			if (buf_stat_bytes + buf_dyn_bytes >= expected_len)
-				break;
+			if (context->buf_dyn_bytes <= context->expected_len)
+				tcp_recv_context_consume(s, context);
 		}
+
+		context->expect = ZBX_TCP_EXPECT_SIZE;
+
+		if (context->buf_stat_bytes + context->buf_dyn_bytes >= context->expected_len)
+			return ZBX_TCP_RECV_STOP;
 	}
 
-	if (ZBX_TCP_EXPECT_SIZE == expect)
+	return ZBX_TCP_RECV_MORE;
+uncompress_error:
+	zbx_tcp_recv_context_clear(context);
+
+	return ZBX_TCP_RECV_ERROR;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: validate and decompress the message after receiving is stopped    *
+ *                                                                            *
+ * Parameters: s       - [IN] the socket                                      *
+ *             context - [IN] the receiving state                             *
+ *                                                                            *
+ * Return value: number of bytes received - success,                          *
+ *               FAIL - the message is invalid                                *
+ *                                                                            *
+ ******************************************************************************/
+static ssize_t	tcp_recv_context_finish(zbx_socket_t *s, zbx_tcp_recv_context_t *context)
+{
+	size_t	received = context->buf_stat_bytes + context->buf_dyn_bytes, stream_size = 0;
+	int	stream_ret = FAIL;
+
+	if (NULL != context->stream)
+	{
+		stream_ret = zbx_uncompress_stream_finish(context->stream, &stream_size);
+		zbx_tcp_recv_context_clear(context);
+	}
+
+	if (ZBX_TCP_EXPECT_SIZE == context->expect)
 	{
-		if (buf_stat_bytes + buf_dyn_bytes == expected_len)
+		if (received == context->expected_len)
 		{
-			if (0 != (protocol_version & ZBX_TCP_COMPRESS))
+			if (ZBX_BUF_TYPE_DYN == s->buf_type && 0 != (context->protocol_version & ZBX_TCP_COMPRESS))
+			{
+				/* message was uncompressed while being received */
+				if (SUCCEED != stream_ret)
+				{
+					zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
+					return FAIL;
+				}
+
+				if (stream_size != context->reserved)
+				{
+					zbx_set_socket_strerror("size of uncompressed data is less than expected");
+					return FAIL;
+				}
+
+				s->read_bytes = context->reserved - context->consumed;
+
+				zabbix_log(LOG_LEVEL_TRACE, "%s(): received " ZBX_FS_SIZE_T " bytes with"
+						" compression ratio %.1f", __func__, (zbx_fs_size_t)received,
+						(double)context->reserved / (double)received);
+			}
+			else if (0 != (context->protocol_version & ZBX_TCP_COMPRESS))
 			{
 				char	*out;
-				size_t	out_size = reserved;
+				size_t	out_size = context->reserved;
 
-				out = (char *)zbx_malloc(NULL, reserved + 1);
-				if (FAIL == zbx_uncompress(s->buffer, buf_stat_bytes + buf_dyn_bytes, out, &out_size))
+				out = (char *)zbx_malloc(NULL, context->reserved + 1);
+				if (FAIL == zbx_uncompress(s->buffer, received, out, &out_size))
 				{
 					zbx_free(out);
 					zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
-					nbytes = ZBX_PROTO_ERROR;
-					goto out;
+					return FAIL;
 				}
 
-				if (out_size != reserved)
+				if (out_size != context->reserved)
 				{
 					zbx_free(out);
 					zbx_set_socket_strerror("size of uncompressed data is less than expected");
-					nbytes = ZBX_PROTO_ERROR;
-					goto out;
+					return FAIL;
 				}
 
-				if (ZBX_BUF_TYPE_DYN == s->buf_type)
-					zbx_free(s->buffer);
-
 				s->buf_type = ZBX_BUF_TYPE_DYN;
 				s->buffer = out;
-				s->read_bytes = reserved;
+				s->read_bytes = context->reserved;
 
 				zabbix_log(LOG_LEVEL_TRACE, "%s(): received " ZBX_FS_SIZE_T " bytes with"
-						" compression ratio %.1f", __func__,
-						(zbx_fs_size_t)(buf_stat_bytes + buf_dyn_bytes),
-						(double)reserved / (double)(buf_stat_bytes + buf_dyn_bytes));
+						" compression ratio %.1f", __func__, (zbx_fs_size_t)received,
+						(double)context->reserved / (double)received);
 			}
 			else
-				s->read_bytes = buf_stat_bytes + buf_dyn_bytes;
+				s->read_bytes = received - context->consumed;
 
 			s->buffer[s->read_bytes] = '\0';
 		}
 		else
 		{
-			if (buf_stat_bytes + buf_dyn_bytes < expected_len)
+			if (received < context->expected_len)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "Message from %s is shorter than expected " ZBX_FS_UI64
-						" bytes. Message ignored.", s->peer, (zbx_uint64_t)expected_len);
+						" bytes. Message ignored.", s->peer, context->expected_len);
 			}
 			else
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "Message from %s is longer than expected " ZBX_FS_UI64
-						" bytes. Message ignored.", s->peer, (zbx_uint64_t)expected_len);
+						" bytes. Message ignored.", s->peer, context->expected_len);
 			}
 
-			nbytes = ZBX_PROTO_ERROR;
+			return FAIL;
 		}
 	}
-	else if (ZBX_TCP_EXPECT_LENGTH == expect)
+	else if (ZBX_TCP_EXPECT_LENGTH == context->expect)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "Message from %s is missing data length. Message ignored.", s->peer);
-		nbytes = ZBX_PROTO_ERROR;
+		return FAIL;
 	}
-	else if (ZBX_TCP_EXPECT_VERSION == expect)
+	else if (ZBX_TCP_EXPECT_VERSION == context->expect)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "Message from %s is missing protocol version. Message ignored.",
 				s->peer);
-		nbytes = ZBX_PROTO_ERROR;
+		return FAIL;
 	}
-	else if (ZBX_TCP_EXPECT_VERSION_VALIDATE == expect)
+	else if (ZBX_TCP_EXPECT_VERSION_VALIDATE == context->expect)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "Message from %s is using unsupported protocol version \"%d\"."
-				" Message ignored.", s->peer, protocol_version);
-		nbytes = ZBX_PROTO_ERROR;
+				" Message ignored.", s->peer, context->protocol_version);
+		return FAIL;
 	}
-	else if (0 != buf_stat_bytes)
+	else if (0 != context->buf_stat_bytes)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "Message from %s is missing header. Message ignored.", s->peer);
-		nbytes = ZBX_PROTO_ERROR;
+		return FAIL;
 	}
 	else
 	{
 		s->read_bytes = 0;
 		s->buffer[s->read_bytes] = '\0';
 	}
+
+	return (ssize_t)(s->read_bytes + context->offset);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receive data                                                      *
+ *                                                                            *
+ * Return value: number of bytes received - success,                          *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ ******************************************************************************/
+ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout, unsigned char flags)
+{
+	return zbx_tcp_recv_consume(s, timeout, flags, NULL, NULL);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receive data passing large message to the consumer while it is    *
+ *          being received                                                    *
+ *                                                                            *
+ * Parameters: s           - [IN] the socket                                  *
+ *             timeout     - [IN] the receive timeout, 0 - no timeout         *
+ *             flags       - [IN] ZBX_TCP_LARGE to allow large messages       *
+ *             consume_cb  - [IN] the consumer callback, optional             *
+ *             consume_arg - [IN] the consumer callback argument              *
+ *                                                                            *
+ * Return value: number of bytes received - success,                          *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ * Comments: See zbx_tcp_recv_context_set_consumer().                         *
+ *                                                                            *
+ ******************************************************************************/
+ssize_t	zbx_tcp_recv_consume(zbx_socket_t *s, int timeout, unsigned char flags, zbx_tcp_recv_consume_func_t consume_cb,
+		void *consume_arg)
+{
+	ssize_t			nbytes, ret = FAIL;
+	zbx_tcp_recv_context_t	context;
+
+	zbx_tcp_recv_context_init(s, &context, flags);
+	zbx_tcp_recv_context_set_consumer(&context, consume_cb, consume_arg);
+
+	if (0 != timeout)
+		zbx_socket_set_deadline(s, timeout);
+
+	while (0 != (nbytes = zbx_tcp_read(s, s->buf_stat + context.buf_stat_bytes,
+			sizeof(s->buf_stat) - context.buf_stat_bytes)))
+	{
+		int	rc;
+
+		if (ZBX_PROTO_ERROR == nbytes)
+			goto out;
+
+		if (ZBX_TCP_RECV_ERROR == (rc = tcp_recv_context_process(s, &context, nbytes)))
+			goto out;
+
+		if (ZBX_TCP_RECV_STOP == rc)
+			break;
+	}
+
+	ret = tcp_recv_context_finish(s, &context);
 out:
+	zbx_tcp_recv_context_clear(&context);
+
 	if (0 != timeout)
 		zbx_socket_set_deadline(s, 0);
 
-	return (ZBX_PROTO_ERROR == nbytes ? FAIL : (ssize_t)(s->read_bytes + offset));
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read available data from socket without waiting                   *
+ *                                                                            *
+ * Parameters: s      - [IN] the socket                                       *
+ *             buf    - [OUT] buffer for data                                 *
+ *             len    - [IN] buffer size                                      *
+ *             events - [OUT] POLLIN or POLLOUT when no data can be read yet  *
+ *                                                                            *
+ * Return value: number of bytes read or ZBX_PROTO_ERROR (with events set     *
+ *               when the socket must be waited for)                          *
+ *                                                                            *
+ ******************************************************************************/
+static ssize_t	tcp_read_nowait(zbx_socket_t *s, char *buf, size_t len, short *events)
+{
+	ssize_t	n;
+
+	*events = 0;
+
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	if (NULL != s->tls_ctx)	/* TLS connection */
+	{
+		char	*error = NULL;
+
+		if (ZBX_PROTO_ERROR == (n = zbx_tls_read_nowait(s, buf, len, events, &error)) && 0 == *events)
+		{
+			zbx_set_socket_strerror("%s", error);
+			zbx_free(error);
+		}
+
+		return n;
+	}
+#endif
+	if (0 <= (n = ZBX_TCP_READ(s->socket, buf, len)))
+		return n;
+
+	if (SUCCEED == zbx_socket_had_nonblocking_error())
+		*events = POLLIN;
+	else
+	{
+		zbx_set_socket_strerror("cannot read from socket: %s",
+				zbx_strerror_from_system(zbx_socket_last_error()));
+	}
+
+	return ZBX_PROTO_ERROR;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receive the available part of a message without waiting           *
+ *                                                                            *
+ * Parameters: s       - [IN] the socket                                      *
+ *             context - [IN/OUT] the receiving state, initialized by         *
+ *                                zbx_tcp_recv_context_init()                 *
+ *             events  - [OUT] POLLIN or POLLOUT if the socket must be waited *
+ *                             for before calling this function again         *
+ *                                                                            *
+ * Return value: number of bytes received - the message is received,          *
+ *               FAIL - the message is not complete yet (events is set) or    *
+ *                      an error occurred (events is 0)                       *
+ *                                                                            *
+ * Comments: If receiving is abandoned before the message is received the     *
+ *           context must be released with zbx_tcp_recv_context_clear().      *
+ *                                                                            *
+ ******************************************************************************/
+ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, short *events)
+{
+	ssize_t	nbytes;
+
+	while (0 != (nbytes = tcp_read_nowait(s, s->buf_stat + context->buf_stat_bytes,
+			sizeof(s->buf_stat) - context->buf_stat_bytes, events)))
+	{
+		int	rc;
+
+		if (ZBX_PROTO_ERROR == nbytes)
+			return FAIL;
+
+		if (ZBX_TCP_RECV_ERROR == (rc = tcp_recv_context_process(s, context, nbytes)))
+			return FAIL;
+
+		if (ZBX_TCP_RECV_STOP == rc)
+			break;
+	}
+
+	return tcp_recv_context_finish(s, context);
+}
+
+#undef ZBX_TCP_RECV_MORE
+#undef ZBX_TCP_RECV_STOP
+#undef ZBX_TCP_RECV_ERROR
 
 #undef ZBX_TCP_EXPECT_HEADER
+#undef ZBX_TCP_EXPECT_VERSION
+#undef ZBX_TCP_EXPECT_VERSION_VALIDATE
 #undef ZBX_TCP_EXPECT_LENGTH
 #undef ZBX_TCP_EXPECT_SIZE
-}
 
 /******************************************************************************
  *                                                                            *
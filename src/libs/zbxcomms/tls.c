@@ -200,8 +200,10 @@ static ZBX_THREAD_LOCAL size_t		my_psk_len		= 0;
 /* but other components (e.g. agent) do not link dbconfig.o. */
 size_t	(*find_psk_in_cache)(const unsigned char *, unsigned char *, unsigned int *) = NULL;
 
+#if defined(HAVE_GNUTLS)
 /* variable for passing information from callback functions if PSK was found among host PSKs or autoregistration PSK */
 static unsigned int	psk_usage;
+#endif
 
 static zbx_tls_status_t	tls_status = ZBX_TLS_INIT_NONE;
 
@@ -224,11 +226,6 @@ static ZBX_THREAD_LOCAL size_t			psk_identity_len_for_cb	= 0;
 static ZBX_THREAD_LOCAL char			*psk_for_cb		= NULL;
 static ZBX_THREAD_LOCAL size_t			psk_len_for_cb		= 0;
 #endif
-#ifdef HAVE_OPENSSL_WITH_PSK
-/* variables for capturing PSK identity from server callback function */
-static ZBX_THREAD_LOCAL int			incoming_connection_has_psk = 0;
-static ZBX_THREAD_LOCAL char			incoming_connection_psk_id[PSK_MAX_IDENTITY_LEN + 1];
-#endif
 /* buffer for messages produced by zbx_openssl_info_cb() */
 ZBX_THREAD_LOCAL char				info_buf[256];
 #endif
@@ -654,22 +651,20 @@ static unsigned int	zbx_psk_client_cb(SSL *ssl, const char *hint, char *identity
 static unsigned int	zbx_psk_server_cb(SSL *ssl, const char *identity, unsigned char *psk,
 		unsigned int max_psk_len)
 {
-	const char	*psk_loc;
-	size_t		psk_len = 0;
-	int		psk_bin_len;
-	unsigned char	tls_psk_hex[HOST_TLS_PSK_LEN_MAX], psk_buf[HOST_TLS_PSK_LEN / 2];
-
-	ZBX_UNUSED(ssl);
+	const char		*psk_loc;
+	size_t			psk_len = 0;
+	int			psk_bin_len;
+	unsigned char		tls_psk_hex[HOST_TLS_PSK_LEN_MAX], psk_buf[HOST_TLS_PSK_LEN / 2];
+	zbx_tls_context_t	*tls_ctx = (zbx_tls_context_t *)SSL_get_app_data(ssl);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "%s() requested PSK identity \"%s\"", __func__, identity);
 
-	incoming_connection_has_psk = 1;
-	psk_usage = 0;
+	tls_ctx->psk_usage = 0;
 
 	if (0 != (zbx_get_program_type_cb() & (ZBX_PROGRAM_TYPE_PROXY | ZBX_PROGRAM_TYPE_SERVER)))
 	{
 		/* call the function zbx_dc_get_psk_by_identity() by pointer */
-		if (0 < find_psk_in_cache((const unsigned char *)identity, tls_psk_hex, &psk_usage))
+		if (0 < find_psk_in_cache((const unsigned char *)identity, tls_psk_hex, &tls_ctx->psk_usage))
 		{
 			/* The PSK is in configuration cache. Convert PSK to binary form. */
 			if (0 >= (psk_bin_len = zbx_hex2bin(tls_psk_hex, psk_buf, sizeof(psk_buf))))
@@ -689,13 +684,13 @@ static unsigned int	zbx_psk_server_cb(SSL *ssl, const char *identity, unsigned c
 				0 == strcmp(my_psk_identity, identity))
 		{
 			/* the PSK is in proxy configuration file */
-			psk_usage |= ZBX_PSK_FOR_PROXY;
+			tls_ctx->psk_usage |= ZBX_PSK_FOR_PROXY;
 
 			if (0 < psk_len && (psk_len != my_psk_len || 0 != memcmp(psk_loc, my_psk, psk_len)))
 			{
 				/* PSK was also found in configuration cache but with different value */
 				zbx_psk_warn_misconfig(identity);
-				psk_usage &= ~(unsigned int)ZBX_PSK_FOR_AUTOREG;
+				tls_ctx->psk_usage &= ~(unsigned int)ZBX_PSK_FOR_AUTOREG;
 			}
 
 			psk_loc = my_psk;	/* prefer PSK from proxy configuration file */
@@ -736,12 +731,12 @@ static unsigned int	zbx_psk_server_cb(SSL *ssl, const char *identity, unsigned c
 		}
 
 		memcpy(psk, psk_loc, psk_len);
-		zbx_strlcpy(incoming_connection_psk_id, identity, sizeof(incoming_connection_psk_id));
+		zbx_strlcpy(tls_ctx->psk_identity, identity, sizeof(tls_ctx->psk_identity));
 
 		return (unsigned int)psk_len;	/* success */
 	}
 fail:
-	incoming_connection_psk_id[0] = '\0';
+	tls_ctx->psk_identity[0] = '\0';
 	return 0;	/* PSK not found */
 }
 #endif
@@ -2729,6 +2724,7 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 	s->tls_ctx->ctx = NULL;
 	s->tls_ctx->psk_client_creds = NULL;
 	s->tls_ctx->psk_server_creds = NULL;
+	s->tls_ctx->psk_usage = 0;
 
 	if (GNUTLS_E_SUCCESS != (res = gnutls_init(&s->tls_ctx->ctx, GNUTLS_CLIENT | GNUTLS_NO_EXTENSIONS)))
 			/* GNUTLS_NO_EXTENSIONS is used because we do not currently support extensions (e.g. session */
@@ -3262,6 +3258,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 	s->tls_ctx->ctx = NULL;
 	s->tls_ctx->psk_client_creds = NULL;
 	s->tls_ctx->psk_server_creds = NULL;
+	s->tls_ctx->psk_usage = 0;
 
 	if (GNUTLS_E_SUCCESS != (res = gnutls_init(&s->tls_ctx->ctx, GNUTLS_SERVER)))
 	{
@@ -3472,6 +3469,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 	else if (GNUTLS_CRD_PSK == creds)
 	{
 		s->connection_type = ZBX_TCP_SEC_TLS_PSK;
+		s->tls_ctx->psk_usage = psk_usage;
 
 		if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
 		{
@@ -3516,23 +3514,40 @@ out1:
 	return ret;
 }
 #elif defined(HAVE_OPENSSL)
-int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
+static void	tls_accept_free(zbx_socket_t *s)
 {
-	const char	*cipher_name;
-	int		ret = FAIL, res;
-	size_t		error_alloc = 0, error_offset = 0;
-	long		verify_result;
+	if (NULL != s->tls_ctx->ctx)
+		SSL_free(s->tls_ctx->ctx);
+
+	zbx_free(s->tls_ctx);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create TLS context for accepting a connection                     *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     s          - [IN] socket with opened connection                        *
+ *     tls_accept - [IN] type of connection to accept                         *
+ *     error      - [OUT] dynamically allocated memory with error message     *
+ *                                                                            *
+ * Return value: SUCCEED - TLS context is ready for handshake                 *
+ *               FAIL    - an error occurred, TLS context is freed            *
+ *                                                                            *
+ ******************************************************************************/
+static int	tls_accept_init(zbx_socket_t *s, unsigned int tls_accept, char **error)
+{
+	size_t	error_alloc = 0, error_offset = 0;
 
 #if OPENSSL_VERSION_NUMBER >= 0x1010100fL	/* OpenSSL 1.1.1 or newer, or LibreSSL */
 	const unsigned char	session_id_context[] = {'Z', 'b', 'x'};
 #endif
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
-
 	s->tls_ctx = zbx_malloc(s->tls_ctx, sizeof(zbx_tls_context_t));
 	s->tls_ctx->ctx = NULL;
+	s->tls_ctx->psk_usage = 0;
 
 #if defined(HAVE_OPENSSL_WITH_PSK)
-	incoming_connection_has_psk = 0;	/* assume certificate-based connection by default */
+	s->tls_ctx->psk_identity[0] = '\0';	/* assume certificate-based connection by default */
 #endif
 	if ((ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK) == (tls_accept & (ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK)))
 	{
@@ -3654,32 +3669,35 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		goto out;
 	}
 
-	/* TLS handshake */
-
-	info_buf[0] = '\0';	/* empty buffer for zbx_openssl_info_cb() messages */
-
-	while (-1 == (res = SSL_accept(s->tls_ctx->ctx)))
-	{
-		int	ssl_err;
-
-		ssl_err = SSL_get_error(s->tls_ctx->ctx, res);
+	/* the PSK server callback stores identity and usage of incoming connection here */
+	SSL_set_app_data(s->tls_ctx->ctx, s->tls_ctx);
 
-		if (SSL_ERROR_WANT_READ != ssl_err && SSL_ERROR_WANT_WRITE != ssl_err)
-			break;
+	return SUCCEED;
+out:	/* an error occurred */
+	tls_accept_free(s);
 
-		if (FAIL == tls_socket_wait(s->socket, s->tls_ctx->ctx, ssl_err))
-		{
-			*error = zbx_dsprintf(*error, "cannot wait for TLS handshake: %s",
-					zbx_strerror_from_system(zbx_socket_last_error()));
-			goto out;
-		}
+	return FAIL;
+}
 
-		if (SUCCEED != zbx_socket_check_deadline(s))
-		{
-			*error = zbx_strdup(*error, "SSL_accept() timed out");
-			goto out;
-		}
-	}
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check result of completed TLS handshake and determine connection  *
+ *          type                                                              *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     s     - [IN] socket with TLS context                                   *
+ *     res   - [IN] last result of SSL_accept()                               *
+ *     error - [OUT] dynamically allocated memory with error message          *
+ *                                                                            *
+ * Return value: SUCCEED - TLS connection is established                      *
+ *               FAIL    - an error occurred, TLS context is freed            *
+ *                                                                            *
+ ******************************************************************************/
+static int	tls_accept_finish(zbx_socket_t *s, int res, char **error)
+{
+	const char	*cipher_name;
+	size_t		error_alloc = 0, error_offset = 0;
+	long		verify_result;
 
 	if (1 != res)
 	{
@@ -3718,7 +3736,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 	cipher_name = SSL_get_cipher(s->tls_ctx->ctx);
 
 #if defined(HAVE_OPENSSL_WITH_PSK)
-	if (1 == incoming_connection_has_psk)
+	if ('\0' != s->tls_ctx->psk_identity[0])
 	{
 		s->connection_type = ZBX_TCP_SEC_TLS_PSK;
 	}
@@ -3736,7 +3754,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 			zbx_snprintf_alloc(error, &error_alloc, &error_offset, "%s",
 					X509_verify_cert_error_string(verify_result));
 			zbx_tls_close(s);
-			goto out1;
+			return FAIL;
 		}
 
 		/* Issuer and Subject will be verified later, after receiving sender type and host name */
@@ -3749,23 +3767,117 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		return FAIL;
 	}
 #endif
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():SUCCEED (established %s %s)", __func__,
-			SSL_get_version(s->tls_ctx->ctx), cipher_name);
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() established %s %s", __func__, SSL_get_version(s->tls_ctx->ctx),
+			cipher_name);
 
 	return SUCCEED;
 
 out:	/* an error occurred */
-	if (NULL != s->tls_ctx->ctx)
-		SSL_free(s->tls_ctx->ctx);
+	tls_accept_free(s);
 
-	zbx_free(s->tls_ctx);
-out1:
+	return FAIL;
+}
+
+int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
+{
+	int	ret = FAIL, res;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (SUCCEED != tls_accept_init(s, tls_accept, error))
+		goto out;
+
+	/* TLS handshake */
+
+	info_buf[0] = '\0';	/* empty buffer for zbx_openssl_info_cb() messages */
+
+	while (-1 == (res = SSL_accept(s->tls_ctx->ctx)))
+	{
+		int	ssl_err;
+
+		ssl_err = SSL_get_error(s->tls_ctx->ctx, res);
+
+		if (SSL_ERROR_WANT_READ != ssl_err && SSL_ERROR_WANT_WRITE != ssl_err)
+			break;
+
+		if (FAIL == tls_socket_wait(s->socket, s->tls_ctx->ctx, ssl_err))
+		{
+			*error = zbx_dsprintf(*error, "cannot wait for TLS handshake: %s",
+					zbx_strerror_from_system(zbx_socket_last_error()));
+			tls_accept_free(s);
+			goto out;
+		}
+
+		if (SUCCEED != zbx_socket_check_deadline(s))
+		{
+			*error = zbx_strdup(*error, "SSL_accept() timed out");
+			tls_accept_free(s);
+			goto out;
+		}
+	}
+
+	ret = tls_accept_finish(s, res, error);
+out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s error:'%s'", __func__, zbx_result_string(ret),
 			ZBX_NULL2EMPTY_STR(*error));
 	return ret;
 }
 #endif
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform the next step of TLS handshake on an accepted connection  *
+ *          without waiting for socket                                        *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     s          - [IN] socket with opened connection                        *
+ *     tls_accept - [IN] type of connection to accept                         *
+ *     events     - [OUT] POLLIN or POLLOUT if handshake is not finished and  *
+ *                        the socket must be waited for, 0 otherwise          *
+ *     error      - [OUT] dynamically allocated memory with error message     *
+ *                                                                            *
+ * Return value:                                                              *
+ *     SUCCEED - handshake is finished (events is 0) or must be continued     *
+ *               when the socket is ready for the requested events            *
+ *     FAIL    - an error occurred                                            *
+ *                                                                            *
+ * Comments: TLS context is created on the first call. With GnuTLS the whole  *
+ *           handshake is performed at once.                                  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tls_accept_step(zbx_socket_t *s, unsigned int tls_accept, short *events, char **error)
+{
+#if defined(HAVE_GNUTLS)
+	*events = 0;
+
+	return zbx_tls_accept(s, tls_accept, error);
+#elif defined(HAVE_OPENSSL)
+	int	res;
+
+	*events = 0;
+
+	if (NULL == s->tls_ctx && SUCCEED != tls_accept_init(s, tls_accept, error))
+		return FAIL;
+
+	info_buf[0] = '\0';	/* empty buffer for zbx_openssl_info_cb() messages */
+
+	if (-1 == (res = SSL_accept(s->tls_ctx->ctx)))
+	{
+		switch (SSL_get_error(s->tls_ctx->ctx, res))
+		{
+			case SSL_ERROR_WANT_READ:
+				*events = POLLIN;
+				return SUCCEED;
+			case SSL_ERROR_WANT_WRITE:
+				*events = POLLOUT;
+				return SUCCEED;
+		}
+	}
+
+	return tls_accept_finish(s, res, error);
+#endif
+}
+
 #if defined(HAVE_GNUTLS)
 #	define ZBX_TLS_WRITE(ctx, buf, len)	gnutls_record_send(ctx, buf, len)
 #	define ZBX_TLS_READ(ctx, buf, len)	gnutls_record_recv(ctx, buf, len)
@@ -3856,7 +3968,24 @@ ssize_t	zbx_tls_write(zbx_socket_t *s, const char *buf, size_t len, char **error
 	return offset;
 }
 
-ssize_t	zbx_tls_read(zbx_socket_t *s, char *buf, size_t len, char **error)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read data from TLS connection                                     *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     s      - [IN] socket with established TLS connection                   *
+ *     buf    - [OUT] buffer for data                                         *
+ *     len    - [IN] buffer size                                              *
+ *     events - [OUT] optional, if specified the socket is not waited for -   *
+ *                    POLLIN or POLLOUT is returned instead when no data can  *
+ *                    be read yet                                             *
+ *     error  - [OUT] dynamically allocated memory with error message         *
+ *                                                                            *
+ * Return value: number of bytes read or ZBX_PROTO_ERROR (with events set     *
+ *               when the socket must be waited for)                          *
+ *                                                                            *
+ ******************************************************************************/
+static ssize_t	tls_read(zbx_socket_t *s, char *buf, size_t len, short *events, char **error)
 {
 	ssize_t		n = 0;
 
@@ -3874,6 +4003,16 @@ ssize_t	zbx_tls_read(zbx_socket_t *s, char *buf, size_t len, char **error)
 		if (SUCCEED != tls_is_nonblocking_error(err))
 			break;
 
+		if (NULL != events)
+		{
+#if defined(HAVE_GNUTLS)
+			*events = (0 == gnutls_record_get_direction(s->tls_ctx->ctx) ? POLLIN : POLLOUT);
+#elif defined(HAVE_OPENSSL)
+			*events = (SSL_ERROR_WANT_WRITE == err ? POLLOUT : POLLIN);
+#endif
+			return ZBX_PROTO_ERROR;
+		}
+
 		if (FAIL == tls_socket_wait(s->socket, s->tls_ctx->ctx, err))
 		{
 			*error = zbx_dsprintf(*error, "cannot wait socket: %s",
@@ -3921,6 +4060,25 @@ ssize_t	zbx_tls_read(zbx_socket_t *s, char *buf, size_t len, char **error)
 	return n;
 }
 
+ssize_t	zbx_tls_read(zbx_socket_t *s, char *buf, size_t len, char **error)
+{
+	return tls_read(s, buf, len, NULL, error);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read data from TLS connection without waiting for socket          *
+ *                                                                            *
+ * Comments: see tls_read()                                                   *
+ *                                                                            *
+ ******************************************************************************/
+ssize_t	zbx_tls_read_nowait(zbx_socket_t *s, char *buf, size_t len, short *events, char **error)
+{
+	*events = 0;
+
+	return tls_read(s, buf, len, events, error);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: close a TLS connection before closing a TCP socket                *
@@ -3982,8 +4140,9 @@ void	zbx_tls_close(zbx_socket_t *s)
 		info_buf[0] = '\0';	/* empty buffer for zbx_openssl_info_cb() messages */
 
 		/* After TLS shutdown the TCP connection will be closed. So, there is no need to do a bidirectional */
-		/* TLS shutdown - unidirectional shutdown is ok. */
-		while (0 > (res = SSL_shutdown(s->tls_ctx->ctx)))
+		/* TLS shutdown - unidirectional shutdown is ok. Connection with unfinished handshake (e.g. timed out */
+		/* while being accepted without blocking) is closed without TLS shutdown. */
+		while (0 == SSL_in_init(s->tls_ctx->ctx) && 0 > (res = SSL_shutdown(s->tls_ctx->ctx)))
 		{
 			int	err;
 
@@ -4135,14 +4294,12 @@ int	zbx_tls_get_attr_psk(const zbx_socket_t *s, zbx_tls_conn_attr_t *attr)
 #elif defined(HAVE_OPENSSL) && defined(HAVE_OPENSSL_WITH_PSK)
 int	zbx_tls_get_attr_psk(const zbx_socket_t *s, zbx_tls_conn_attr_t *attr)
 {
-	ZBX_UNUSED(s);
-
 	/* SSL_get_psk_identity() is not used here. It works with TLS 1.2, */
 	/* but returns NULL with TLS 1.3 in OpenSSL 1.1.1 */
-	if ('\0' == incoming_connection_psk_id[0])
+	if ('\0' == s->tls_ctx->psk_identity[0])
 		return FAIL;
 
-	attr->psk_identity = incoming_connection_psk_id;
+	attr->psk_identity = s->tls_ctx->psk_identity;
 	attr->psk_identity_len = strlen(attr->psk_identity);
 	return SUCCEED;
 }
@@ -4298,8 +4455,8 @@ void	zbx_tls_take_vars(ZBX_THREAD_SENDVAL_TLS_ARGS *args)
 }
 #endif
 
-unsigned int	zbx_tls_get_psk_usage(void)
+unsigned int	zbx_tls_get_psk_usage(const zbx_socket_t *s)
 {
-	return	psk_usage;
+	return	s->tls_ctx->psk_usage;
 }
 #endif
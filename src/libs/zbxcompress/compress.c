@@ -120,6 +120,230 @@ int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
 	return SUCCEED;
 }
 
+struct zbx_uncompress_stream
+{
+	z_stream	zs;
+	size_t		out_size;	/* output buffer size */
+	size_t		out_left;	/* output buffer space not yet given to zlib */
+	size_t		in_left;	/* input data not yet given to zlib */
+	int		finished;
+};
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start uncompressing data arriving in parts                        *
+ *                                                                            *
+ * Parameters: out      - [OUT] the buffer for uncompressed data              *
+ *             size_out - [IN] the buffer size                                *
+ *                                                                            *
+ * Return value: the uncompress stream or NULL on error                       *
+ *                                                                            *
+ * Comments: The stream must be freed with zbx_uncompress_stream_free().      *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uncompress_stream_t	*zbx_uncompress_stream_create(char *out, size_t size_out)
+{
+	zbx_uncompress_stream_t	*stream;
+
+	stream = (zbx_uncompress_stream_t *)zbx_malloc(NULL, sizeof(zbx_uncompress_stream_t));
+	memset(&stream->zs, 0, sizeof(stream->zs));
+	stream->zs.next_out = (Bytef *)out;
+	stream->out_size = size_out;
+	stream->out_left = size_out;
+	stream->in_left = 0;
+	stream->finished = 0;
+
+	if (Z_OK != (zbx_zlib_errno = inflateInit(&stream->zs)))
+	{
+		zbx_free(stream);
+		return NULL;
+	}
+
+	return stream;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: give pending input data to zlib until it is uncompressed or the   *
+ *          output buffer is full                                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	uncompress_stream_inflate(zbx_uncompress_stream_t *stream)
+{
+	while (0 != stream->in_left || 0 != stream->zs.avail_in)
+	{
+		uInt	avail_in = stream->zs.avail_in, avail_out = stream->zs.avail_out;
+		int	rc;
+
+		if (0 != stream->finished)
+		{
+			/* data after the end of compressed stream */
+			zbx_zlib_errno = Z_DATA_ERROR;
+			return FAIL;
+		}
+
+		/* zlib counts buffer sizes in 32 bits, larger buffers are given to it in parts */
+		if (0 == stream->zs.avail_in)
+		{
+			stream->zs.avail_in = (uInt)MIN(stream->in_left, UINT_MAX);
+			stream->in_left -= stream->zs.avail_in;
+		}
+
+		if (0 == stream->zs.avail_out)
+		{
+			stream->zs.avail_out = (uInt)MIN(stream->out_left, UINT_MAX);
+			stream->out_left -= stream->zs.avail_out;
+		}
+
+		if (Z_STREAM_END == (rc = inflate(&stream->zs, Z_NO_FLUSH)))
+		{
+			stream->finished = 1;
+			continue;
+		}
+
+		if (Z_OK == rc)
+			continue;
+
+		/* Z_BUF_ERROR is not fatal while there is progress */
+		if (Z_BUF_ERROR == rc && (avail_in != stream->zs.avail_in || avail_out != stream->zs.avail_out))
+			continue;
+
+		/* output buffer is full, the rest of input is kept until there is more space */
+		if (Z_BUF_ERROR == rc && 0 == stream->zs.avail_out && 0 == stream->out_left)
+			break;
+
+		zbx_zlib_errno = rc;
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: uncompress the next part of data                                  *
+ *                                                                            *
+ * Parameters: stream  - [IN] the uncompress stream                           *
+ *             in      - [IN] the compressed data part                        *
+ *             size_in - [IN] the data part size                              *
+ *                                                                            *
+ * Return value: SUCCEED - the data part was uncompressed successfully        *
+ *               FAIL    - the data is corrupted                              *
+ *                                                                            *
+ * Comments: When the output buffer becomes full the rest of data part is     *
+ *           left pending, see zbx_uncompress_stream_pending(). The data part *
+ *           must stay valid until it is uncompressed with                    *
+ *           zbx_uncompress_stream_resume().                                  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_uncompress_stream_write(zbx_uncompress_stream_t *stream, const char *in, size_t size_in)
+{
+	stream->zs.next_in = (z_const Bytef *)in;
+	stream->zs.avail_in = 0;
+	stream->in_left = size_in;
+
+	return uncompress_stream_inflate(stream);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: continue uncompressing pending data after output buffer space     *
+ *          was freed with zbx_uncompress_stream_discard() or added with      *
+ *          zbx_uncompress_stream_set_output()                                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_uncompress_stream_resume(zbx_uncompress_stream_t *stream)
+{
+	return uncompress_stream_inflate(stream);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the number of compressed bytes left pending because output    *
+ *          buffer is full                                                    *
+ *                                                                            *
+ ******************************************************************************/
+size_t	zbx_uncompress_stream_pending(const zbx_uncompress_stream_t *stream)
+{
+	return stream->in_left + stream->zs.avail_in;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: continue uncompressing into reallocated output buffer             *
+ *                                                                            *
+ * Parameters: stream   - [IN] the uncompress stream                          *
+ *             out      - [IN] the output buffer with the data uncompressed   *
+ *                             so far copied to its beginning                 *
+ *             size_out - [IN] the buffer size                                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_uncompress_stream_set_output(zbx_uncompress_stream_t *stream, char *out, size_t size_out)
+{
+	size_t	size = stream->out_size - stream->out_left - stream->zs.avail_out;
+
+	stream->zs.next_out = (Bytef *)out + size;
+	stream->zs.avail_out = 0;
+	stream->out_size = size_out;
+	stream->out_left = size_out - size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the number of bytes uncompressed so far                       *
+ *                                                                            *
+ ******************************************************************************/
+size_t	zbx_uncompress_stream_size(const zbx_uncompress_stream_t *stream)
+{
+	return (size_t)stream->zs.total_out;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: move output position back after the caller has removed part of    *
+ *          the uncompressed data from the output buffer                      *
+ *                                                                            *
+ * Parameters: stream - [IN] the uncompress stream                            *
+ *             size   - [IN] the number of bytes removed                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_uncompress_stream_discard(zbx_uncompress_stream_t *stream, size_t size)
+{
+	stream->out_left += stream->zs.avail_out + size;
+	stream->zs.avail_out = 0;
+	stream->zs.next_out -= size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check that the complete compressed data was uncompressed          *
+ *                                                                            *
+ * Parameters: stream   - [IN] the uncompress stream                          *
+ *             size_out - [OUT] the uncompressed data size                    *
+ *                                                                            *
+ * Return value: SUCCEED - the compressed data has ended                      *
+ *               FAIL    - the compressed data is incomplete                  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_uncompress_stream_finish(zbx_uncompress_stream_t *stream, size_t *size_out)
+{
+	if (0 == stream->finished)
+	{
+		zbx_zlib_errno = Z_DATA_ERROR;
+		return FAIL;
+	}
+
+	*size_out = (size_t)stream->zs.total_out;
+
+	return SUCCEED;
+}
+
+void	zbx_uncompress_stream_free(zbx_uncompress_stream_t *stream)
+{
+	inflateEnd(&stream->zs);
+	zbx_free(stream);
+}
+
 #else
 
 int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
@@ -140,6 +364,64 @@ int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
 	return FAIL;
 }
 
+zbx_uncompress_stream_t	*zbx_uncompress_stream_create(char *out, size_t size_out)
+{
+	ZBX_UNUSED(out);
+	ZBX_UNUSED(size_out);
+	return NULL;
+}
+
+int	zbx_uncompress_stream_write(zbx_uncompress_stream_t *stream, const char *in, size_t size_in)
+{
+	ZBX_UNUSED(stream);
+	ZBX_UNUSED(in);
+	ZBX_UNUSED(size_in);
+	return FAIL;
+}
+
+int	zbx_uncompress_stream_resume(zbx_uncompress_stream_t *stream)
+{
+	ZBX_UNUSED(stream);
+	return FAIL;
+}
+
+size_t	zbx_uncompress_stream_pending(const zbx_uncompress_stream_t *stream)
+{
+	ZBX_UNUSED(stream);
+	return 0;
+}
+
+void	zbx_uncompress_stream_set_output(zbx_uncompress_stream_t *stream, char *out, size_t size_out)
+{
+	ZBX_UNUSED(stream);
+	ZBX_UNUSED(out);
+	ZBX_UNUSED(size_out);
+}
+
+size_t	zbx_uncompress_stream_size(const zbx_uncompress_stream_t *stream)
+{
+	ZBX_UNUSED(stream);
+	return 0;
+}
+
+void	zbx_uncompress_stream_discard(zbx_uncompress_stream_t *stream, size_t size)
+{
+	ZBX_UNUSED(stream);
+	ZBX_UNUSED(size);
+}
+
+int	zbx_uncompress_stream_finish(zbx_uncompress_stream_t *stream, size_t *size_out)
+{
+	ZBX_UNUSED(stream);
+	ZBX_UNUSED(size_out);
+	return FAIL;
+}
+
+void	zbx_uncompress_stream_free(zbx_uncompress_stream_t *stream)
+{
+	ZBX_UNUSED(stream);
+}
+
 const char	*zbx_compress_strerror(void)
 {
 	return "";
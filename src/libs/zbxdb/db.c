@@ -1619,6 +1619,120 @@ clean:
 	return ret;
 }
 
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes COPY FROM STDIN statement, sending the specified data    *
+ *                                                                            *
+ * Parameters: sql      - [IN] copy statement                                 *
+ *             data     - [IN] rows in copy text format                       *
+ *             data_len - [IN] data length in bytes                           *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on recoverable error) *
+ *               or number of rows copied (on success)                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_copy_from(const char *sql, const char *data, size_t data_len)
+{
+#define ZBX_DB_COPY_CHUNK_SIZE	(ZBX_MEBIBYTE)
+	int		ret = ZBX_DB_OK;
+	double		sec = 0;
+	PGresult	*result;
+	char		*error = NULL;
+	size_t		offset, len;
+
+	if (0 != config_log_slow_queries)
+		sec = zbx_time();
+
+	if (0 == txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level,
+				sql);
+		return ZBX_DB_FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] [" ZBX_FS_SIZE_T " bytes]", txn_level, sql,
+			(zbx_fs_size_t)data_len);
+
+	if (NULL == (result = PQexec(conn, sql)))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		goto out;
+	}
+
+	if (PGRES_COPY_IN != PQresultStatus(result))
+		goto check;
+
+	PQclear(result);
+
+	for (offset = 0; offset < data_len; offset += len)
+	{
+		if (ZBX_DB_COPY_CHUNK_SIZE < (len = data_len - offset))
+			len = ZBX_DB_COPY_CHUNK_SIZE;
+
+		if (1 != PQputCopyData(conn, data + offset, (int)len))
+			break;
+	}
+
+	if (offset < data_len)
+		PQputCopyEnd(conn, "cannot send copy data");
+	else
+		PQputCopyEnd(conn, NULL);
+
+	if (NULL == (result = PQgetResult(conn)))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		goto out;
+	}
+check:
+	if (PGRES_COMMAND_OK != PQresultStatus(result))
+	{
+		zbx_err_codes_t	errcode;
+
+		zbx_postgresql_error(&error, result);
+
+		if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), "23505"))
+			errcode = ERR_Z3008;
+		else
+			errcode = ERR_Z3005;
+
+		zbx_db_errlog(errcode, 0, error, sql);
+		zbx_free(error);
+
+		ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+	}
+	else
+		ret = atoi(PQcmdTuples(result));
+
+	PQclear(result);
+
+	/* drain remaining results to leave the connection ready for the next command */
+	while (NULL != (result = PQgetResult(conn)))
+		PQclear(result);
+out:
+	if (0 != config_log_slow_queries)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)config_log_slow_queries / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+#undef ZBX_DB_COPY_CHUNK_SIZE
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: execute a select statement                                        *
@@ -2894,6 +3008,33 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() version:%lu", __func__, (unsigned long)zbx_dbms_version_get());
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if database server can merge conflicting rows within      *
+ *          insert statement (insert ... on conflict/on duplicate key)        *
+ *                                                                            *
+ * Return value: SUCCEED - upsert is supported                                *
+ *               FAIL    - upsert is not supported or DBMS version unknown    *
+ *                                                                            *
+ * Comments: PostgreSQL server version is known only after DBMS version info  *
+ *           has been extracted.                                              *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_upsert_supported(void)
+{
+#if defined(HAVE_MYSQL)
+	return SUCCEED;
+#elif defined(HAVE_POSTGRESQL)
+	/* on conflict clause was added in PostgreSQL 9.5, older versions can run with AllowUnsupportedDBVersions */
+	if (ZBX_DBVERSION_UNDEFINED == ZBX_PG_SVERSION || 90500 > ZBX_PG_SVERSION)
+		return FAIL;
+
+	return SUCCEED;
+#else
+	return FAIL;
+#endif
+}
+
 #ifdef HAVE_POSTGRESQL
 static int	zbx_tsdb_table_has_compressed_chunks(const char *table_names)
 {
@@ -2995,6 +2995,7 @@ void	zbx_db_insert_prepare_dyn(zbx_db_insert_t *self, const zbx_db_table_t *tabl
 	}
 
 	self->autoincrement = -1;
+	self->copy = 0;
 
 	zbx_vector_ptr_create(&self->fields);
 	zbx_vector_ptr_create(&self->rows);
@@ -3097,7 +3098,9 @@ void	zbx_db_insert_add_values_dyn(zbx_db_insert_t *self, zbx_db_value_t **values
 #ifdef HAVE_ORACLE
 				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_OFF);
 #else
-				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_ON);
+				/* bulk copy data is escaped when formatting rows */
+				row[i].str = DBdyn_escape_field_len(field, value->str,
+						0 == self->copy ? ESCAPE_SEQUENCE_ON : ESCAPE_SEQUENCE_OFF);
 #endif
 				break;
 			case ZBX_TYPE_INT:
@@ -3216,6 +3219,198 @@ static void	decode_and_escape_binary_value_for_sql(char **sql_insert_data)
 }
 #endif
 
+#ifdef HAVE_POSTGRESQL
+/* bulk copy statistics of the current process, collected by zbx_db_get_copy_stats() */
+static zbx_uint64_t	db_copy_rows;
+static double		db_copy_time;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends string escaped for copy text format                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_copy_escape_str(char **data, size_t *data_alloc, size_t *data_offset, const char *src)
+{
+	size_t	len;
+
+	while ('\0' != *src)
+	{
+		if (0 != (len = strcspn(src, "\\\t\n\r")))
+		{
+			zbx_strncpy_alloc(data, data_alloc, data_offset, src, len);
+
+			if ('\0' == *(src += len))
+				break;
+		}
+
+		zbx_chrcpy_alloc(data, data_alloc, data_offset, '\\');
+
+		switch (*src++)
+		{
+			case '\t':
+				zbx_chrcpy_alloc(data, data_alloc, data_offset, 't');
+				break;
+			case '\n':
+				zbx_chrcpy_alloc(data, data_alloc, data_offset, 'n');
+				break;
+			case '\r':
+				zbx_chrcpy_alloc(data, data_alloc, data_offset, 'r');
+				break;
+			default:
+				zbx_chrcpy_alloc(data, data_alloc, data_offset, '\\');
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends Base64 encoded binary data as bytea hex value escaped for *
+ *          copy text format                                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_copy_escape_bin(char **data, size_t *data_alloc, size_t *data_offset, const char *src)
+{
+	static const char	hex[] = "0123456789abcdef";
+	size_t			binary_data_len, binary_data_max_len = strlen(src) * 3 / 4 + 1;
+	char			*binary_data = (char *)zbx_malloc(NULL, binary_data_max_len);
+
+	zbx_base64_decode(src, binary_data, binary_data_max_len, &binary_data_len);
+
+	zbx_strcpy_alloc(data, data_alloc, data_offset, "\\\\x");
+
+	for (size_t i = 0; i < binary_data_len; i++)
+	{
+		zbx_chrcpy_alloc(data, data_alloc, data_offset, hex[(unsigned char)binary_data[i] >> 4]);
+		zbx_chrcpy_alloc(data, data_alloc, data_offset, hex[(unsigned char)binary_data[i] & 0x0f]);
+	}
+
+	zbx_free(binary_data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes the prepared database bulk insert operation with         *
+ *          COPY FROM STDIN instead of insert statements                      *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Return value: Returns SUCCEED if the operation completed successfully or   *
+ *               FAIL otherwise.                                              *
+ *                                                                            *
+ * Comments: Values are sent in text format, so they are not escaped and      *
+ *           parsed as SQL literals and the server skips statement parsing.   *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_insert_execute_copy(zbx_db_insert_t *self)
+{
+	char	*sql_command = NULL, *data;
+	size_t	sql_command_alloc = 0, sql_command_offset = 0, data_alloc = 64 * ZBX_KIBIBYTE, data_offset = 0;
+	int	rc;
+	double	sec;
+
+	zbx_snprintf_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, "copy %s (",
+			self->table->table);
+
+	for (int i = 0; i < self->fields.values_num; i++)
+	{
+		const zbx_db_field_t	*field = (const zbx_db_field_t *)self->fields.values[i];
+
+		if (0 != i)
+			zbx_chrcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, ',');
+
+		zbx_strcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, field->name);
+	}
+
+	zbx_strcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, ") from stdin");
+
+	data = (char *)zbx_malloc(NULL, data_alloc);
+
+	for (int i = 0; i < self->rows.values_num; i++)
+	{
+		const zbx_db_value_t	*values = (const zbx_db_value_t *)self->rows.values[i];
+
+		for (int j = 0; j < self->fields.values_num; j++)
+		{
+			const zbx_db_value_t	*value = &values[j];
+			const zbx_db_field_t	*field = (const zbx_db_field_t *)self->fields.values[j];
+
+			if (0 != j)
+				zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, '\t');
+
+			switch (field->type)
+			{
+				case ZBX_TYPE_CHAR:
+				case ZBX_TYPE_TEXT:
+				case ZBX_TYPE_SHORTTEXT:
+				case ZBX_TYPE_LONGTEXT:
+				case ZBX_TYPE_CUID:
+					db_copy_escape_str(&data, &data_alloc, &data_offset, value->str);
+					break;
+				case ZBX_TYPE_BLOB:
+					db_copy_escape_bin(&data, &data_alloc, &data_offset, value->str);
+					break;
+				case ZBX_TYPE_INT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, "%d", value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_DBL64, value->dbl);
+					break;
+				case ZBX_TYPE_UINT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_UI64, value->ui64);
+					break;
+				case ZBX_TYPE_ID:
+					if (0 == value->ui64)
+					{
+						zbx_strcpy_alloc(&data, &data_alloc, &data_offset, "\\N");
+						break;
+					}
+
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_UI64, value->ui64);
+					break;
+				default:
+					THIS_SHOULD_NEVER_HAPPEN;
+					exit(EXIT_FAILURE);
+			}
+		}
+
+		zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, '\n');
+	}
+
+	sec = zbx_time();
+
+	rc = zbx_db_copy_from(sql_command, data, data_offset);
+
+	while (ZBX_DB_DOWN == rc)
+	{
+		zbx_db_close();
+		zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
+
+		if (ZBX_DB_DOWN == (rc = zbx_db_copy_from(sql_command, data, data_offset)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	sec = zbx_time() - sec;
+
+	if (ZBX_DB_OK <= rc)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "copied %d rows into \"%s\" in " ZBX_FS_DBL " sec, " ZBX_FS_DBL
+				" rows/sec", rc, self->table->table, sec, 0 < sec ? (double)rc / sec : (double)rc);
+
+		db_copy_rows += (zbx_uint64_t)rc;
+		db_copy_time += sec;
+	}
+
+	zbx_free(data);
+	zbx_free(sql_command);
+
+	return ZBX_DB_OK <= rc ? SUCCEED : FAIL;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: executes the prepared database bulk insert operation              *
@@ -3264,6 +3459,11 @@ int	zbx_db_insert_execute(zbx_db_insert_t *self)
 		}
 	}
 
+#ifdef HAVE_POSTGRESQL
+	if (0 != self->copy)
+		return db_insert_execute_copy(self);
+#endif
+
 #ifndef HAVE_ORACLE
 	sql = (char *)zbx_malloc(NULL, sql_alloc);
 #endif
@@ -3500,6 +3700,58 @@ void	zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name)
 	exit(EXIT_FAILURE);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends the rows with bulk copy instead of insert statements when   *
+ *          the database supports it                                          *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Comments: Must be called before adding values. Currently bulk copy is      *
+ *           supported only with PostgreSQL (COPY FROM STDIN).                *
+ *           It is requested for history and proxy history inserts. Trends   *
+ *           are not copied - they are merged with existing rows by upsert    *
+ *           statements, which COPY cannot do.                                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_insert_use_copy(zbx_db_insert_t *self)
+{
+#ifdef HAVE_POSTGRESQL
+	if (0 != self->rows.values_num)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return;
+	}
+
+	self->copy = 1;
+#else
+	ZBX_UNUSED(self);
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets bulk copy statistics of the current process accumulated      *
+ *          since the previous call                                           *
+ *                                                                            *
+ * Parameters: rows       - [OUT] the number of copied rows                   *
+ *             time_spent - [OUT] the time spent copying rows (seconds)       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_get_copy_stats(zbx_uint64_t *rows, double *time_spent)
+{
+#ifdef HAVE_POSTGRESQL
+	*rows = db_copy_rows;
+	*time_spent = db_copy_time;
+
+	db_copy_rows = 0;
+	db_copy_time = 0;
+#else
+	*rows = 0;
+	*time_spent = 0;
+#endif
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: determine is it a server or a proxy database                      *
@@ -244,3 +244,120 @@ ZBX_THREAD_ENTRY(zbx_dbsyncer_thread, args)
 	exit(EXIT_SUCCESS);
 #undef STAT_INTERVAL
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates triggers of the values synced by history syncers        *
+ *                                                                            *
+ * Comments: never returns                                                    *
+ *                                                                            *
+ ******************************************************************************/
+ZBX_THREAD_ENTRY(zbx_trigger_evaluator_thread, args)
+{
+	int			sleeptime = -1, total_values_num = 0, values_num, more, total_triggers_num = 0,
+				triggers_num;
+	double			sec, total_sec = 0.0;
+	time_t			last_stat_time;
+	char			*stats = NULL;
+	const char		*process_name;
+	size_t			stats_alloc = 0, stats_offset = 0;
+	const zbx_thread_info_t	*info = &((zbx_thread_args_t *)args)->info;
+	int			server_num = ((zbx_thread_args_t *)args)->info.server_num;
+	int			process_num = ((zbx_thread_args_t *)args)->info.process_num;
+	unsigned char		process_type = ((zbx_thread_args_t *)args)->info.process_type;
+
+	zbx_thread_dbsyncer_args	*dbsyncer_args = (zbx_thread_dbsyncer_args *)
+			(((zbx_thread_args_t *)args)->args);
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "%s #%d started [%s #%d]", get_program_type_string(info->program_type),
+			server_num, (process_name = get_process_type_string(process_type)), process_num);
+
+	zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+
+#define STAT_INTERVAL	5	/* if a process is busy and does not sleep then update status not faster than */
+				/* once in STAT_INTERVAL seconds */
+
+	zbx_setproctitle("%s #%d [connecting to the database]", process_name, process_num);
+	last_stat_time = time(NULL);
+
+	zbx_strcpy_alloc(&stats, &stats_alloc, &stats_offset, "started");
+
+	/* database APIs might not handle signals correctly and hang, block signals to avoid hanging */
+	zbx_block_signals(&orig_mask);
+	zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
+	zbx_unblock_signals(&orig_mask);
+
+	if (SUCCEED == zbx_is_export_enabled(ZBX_FLAG_EXPTYPE_EVENTS))
+		problems_export = zbx_problems_export_init(get_problems_export, "trigger-evaluator", process_num);
+
+	for (;;)
+	{
+		sec = zbx_time();
+
+		zbx_prof_update(get_process_type_string(process_type), sec);
+		zabbix_report_log_level_change();
+
+		if (0 != sleeptime)
+			zbx_setproctitle("%s #%d [%s, evaluating triggers]", process_name, process_num, stats);
+
+		/* database APIs might not handle signals correctly and hang, block signals to avoid hanging */
+		zbx_block_signals(&orig_mask);
+
+		zbx_prof_start(__func__, ZBX_PROF_PROCESSING);
+		zbx_evaluate_trigger_queue(dbsyncer_args->events_cbs, &values_num, &triggers_num, &more);
+		zbx_prof_end();
+
+		zbx_unblock_signals(&orig_mask);
+
+		total_values_num += values_num;
+		total_triggers_num += triggers_num;
+		total_sec += zbx_time() - sec;
+
+		sleeptime = (ZBX_SYNC_MORE == more ? 0 : dbsyncer_args->config_histsyncer_frequency);
+
+		if (0 != sleeptime || STAT_INTERVAL <= time(NULL) - last_stat_time)
+		{
+			stats_offset = 0;
+			zbx_snprintf_alloc(&stats, &stats_alloc, &stats_offset,
+					"processed %d values, %d triggers in " ZBX_FS_DBL " sec", total_values_num,
+					total_triggers_num, total_sec);
+
+			if (0 == sleeptime)
+			{
+				zbx_setproctitle("%s #%d [%s, evaluating triggers]", process_name, process_num,
+						stats);
+			}
+			else
+			{
+				zbx_setproctitle("%s #%d [%s, idle %d sec]", process_name, process_num, stats,
+						sleeptime);
+			}
+
+			total_values_num = 0;
+			total_triggers_num = 0;
+			total_sec = 0.0;
+			last_stat_time = time(NULL);
+		}
+
+		if (ZBX_SYNC_MORE == more)
+			continue;
+
+		if (!ZBX_IS_RUNNING())
+			break;
+
+		zbx_sleep_loop(info, sleeptime);
+	}
+
+	/* database APIs might not handle signals correctly and hang, block signals to avoid hanging */
+	zbx_block_signals(&orig_mask);
+	zbx_db_close();
+	zbx_unblock_signals(&orig_mask);
+
+	if (SUCCEED == zbx_is_export_enabled(ZBX_FLAG_EXPTYPE_EVENTS))
+		zbx_export_deinit(problems_export);
+
+	zbx_free(stats);
+
+	exit(EXIT_SUCCESS);
+#undef STAT_INTERVAL
+}
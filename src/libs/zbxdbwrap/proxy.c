@@ -416,7 +416,7 @@ int	zbx_check_access_passive_proxy(zbx_socket_t *sock, int send_response, const
 	}
 	else if (ZBX_TCP_SEC_TLS_PSK == sock->connection_type)
 	{
-		if (0 != (ZBX_PSK_FOR_PROXY & zbx_tls_get_psk_usage()))
+		if (0 != (ZBX_PSK_FOR_PROXY & zbx_tls_get_psk_usage(sock)))
 			return SUCCEED;
 
 		zabbix_log(LOG_LEVEL_WARNING, "%s from server \"%s\" is not allowed: it used PSK which is not"
@@ -1437,6 +1437,28 @@ static void	log_client_timediff(int level, struct zbx_json_parse *jp, const zbx_
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes history data row field located by                         *
+ *          parse_history_data_row_value()                                    *
+ *                                                                            *
+ * Parameters: p         - [IN] the field value in json or NULL if the field  *
+ *                              is missing                                    *
+ *             tmp       - [IN/OUT] the decoded value buffer                  *
+ *             tmp_alloc - [IN/OUT] the decoded value buffer size             *
+ *                                                                            *
+ * Return value:  SUCCEED - the field was decoded                             *
+ *                FAIL    - the field is missing or is not a primitive value  *
+ *                                                                            *
+ ******************************************************************************/
+static int	decode_history_data_row_field(const char *p, char **tmp, size_t *tmp_alloc)
+{
+	if (NULL == p || NULL == zbx_json_decodevalue_dyn(p, tmp, tmp_alloc, NULL))
+		return FAIL;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: parses agent value from history data json row                     *
@@ -1449,22 +1471,60 @@ static void	log_client_timediff(int level, struct zbx_json_parse *jp, const zbx_
  * Return value:  SUCCEED - the value was parsed successfully                 *
  *                FAIL    - otherwise                                         *
  *                                                                            *
+ * Comments: The row is walked once to locate all fields instead of searching *
+ *           it from the beginning for each field.                            *
+ *                                                                            *
  ******************************************************************************/
 static int	parse_history_data_row_value(const struct zbx_json_parse *jp_row, zbx_timespec_t *unique_shift,
 		zbx_agent_value_t *av)
 {
-	char	*tmp = NULL;
-	size_t	tmp_alloc = 0;
-	int	ret = FAIL;
+	const char	*p = NULL, *p_clock = NULL, *p_ns = NULL, *p_state = NULL, *p_lastlogsize = NULL,
+			*p_mtime = NULL, *p_value = NULL, *p_timestamp = NULL, *p_source = NULL, *p_severity = NULL,
+			*p_logeventid = NULL, *p_id = NULL, **pfield;
+	char		*tmp = NULL, name[MAX_STRING_LEN];
+	size_t		tmp_alloc = 0;
+	int		ret = FAIL;
 
 	memset(av, 0, sizeof(zbx_agent_value_t));
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_CLOCK, &tmp, &tmp_alloc, NULL))
+	while (NULL != (p = zbx_json_pair_next(jp_row, p, name, sizeof(name))))
+	{
+		if (0 == strcmp(name, ZBX_PROTO_TAG_CLOCK))
+			pfield = &p_clock;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_NS))
+			pfield = &p_ns;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_STATE))
+			pfield = &p_state;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LASTLOGSIZE))
+			pfield = &p_lastlogsize;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_MTIME))
+			pfield = &p_mtime;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_VALUE))
+			pfield = &p_value;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGTIMESTAMP))
+			pfield = &p_timestamp;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGSOURCE))
+			pfield = &p_source;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGSEVERITY))
+			pfield = &p_severity;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGEVENTID))
+			pfield = &p_logeventid;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_ID))
+			pfield = &p_id;
+		else
+			continue;
+
+		/* the first occurrence of duplicate field is used */
+		if (NULL == *pfield)
+			*pfield = p;
+	}
+
+	if (SUCCEED == decode_history_data_row_field(p_clock, &tmp, &tmp_alloc))
 	{
 		if (FAIL == zbx_is_uint31(tmp, &av->ts.sec))
 			goto out;
 
-		if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_NS, &tmp, &tmp_alloc, NULL))
+		if (SUCCEED == decode_history_data_row_field(p_ns, &tmp, &tmp_alloc))
 		{
 			if (FAIL == zbx_is_uint_n_range(tmp, tmp_alloc, &av->ts.ns, sizeof(av->ts.ns),
 				0LL, 999999999LL))
@@ -1489,49 +1549,49 @@ static int	parse_history_data_row_value(const struct zbx_json_parse *jp_row, zbx
 	else
 		zbx_timespec(&av->ts);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_STATE, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == decode_history_data_row_field(p_state, &tmp, &tmp_alloc))
 		av->state = (unsigned char)atoi(tmp);
 
 	/* Unsupported item meta information must be ignored for backwards compatibility. */
 	/* New agents will not send meta information for items in unsupported state.      */
 	if (ITEM_STATE_NOTSUPPORTED != av->state)
 	{
-		if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LASTLOGSIZE, &tmp, &tmp_alloc, NULL))
+		if (SUCCEED == decode_history_data_row_field(p_lastlogsize, &tmp, &tmp_alloc))
 		{
 			av->meta = 1;	/* contains meta information */
 
 			zbx_is_uint64(tmp, &av->lastlogsize);
 
-			if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_MTIME, &tmp, &tmp_alloc, NULL))
+			if (SUCCEED == decode_history_data_row_field(p_mtime, &tmp, &tmp_alloc))
 				av->mtime = atoi(tmp);
 		}
 	}
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_VALUE, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == decode_history_data_row_field(p_value, &tmp, &tmp_alloc))
 		av->value = zbx_strdup(av->value, tmp);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGTIMESTAMP, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == decode_history_data_row_field(p_timestamp, &tmp, &tmp_alloc))
 		av->timestamp = atoi(tmp);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGSOURCE, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == decode_history_data_row_field(p_source, &tmp, &tmp_alloc))
 		av->source = zbx_strdup(av->source, tmp);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGSEVERITY, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == decode_history_data_row_field(p_severity, &tmp, &tmp_alloc))
 		av->severity = atoi(tmp);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGEVENTID, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == decode_history_data_row_field(p_logeventid, &tmp, &tmp_alloc))
 		av->logeventid = atoi(tmp);
 
-	if (SUCCEED != zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_ID, &tmp, &tmp_alloc, NULL) ||
+	if (SUCCEED != decode_history_data_row_field(p_id, &tmp, &tmp_alloc) ||
 			SUCCEED != zbx_is_uint64(tmp, &av->id))
 	{
 		av->id = 0;
 	}
 
-	zbx_free(tmp);
-
 	ret = SUCCEED;
 out:
+	zbx_free(tmp);
+
 	return ret;
 }
 
@@ -2899,6 +2959,423 @@ static void	check_proxy_nodata_empty(const zbx_timespec_t *ts, unsigned char pro
 	}
 }
 
+#define ZBX_PROXY_DATA_STREAM_HEAD	0	/* receiving request data before history */
+#define ZBX_PROXY_DATA_STREAM_HISTORY	1	/* processing history rows as they are received */
+#define ZBX_PROXY_DATA_STREAM_DONE	2	/* history rows left in request are processed with request */
+#define ZBX_PROXY_DATA_STREAM_OFF	3	/* whole request is processed after it is received */
+
+/* history data of 'proxy data' request processed while the request is being received */
+struct zbx_proxy_data_stream
+{
+	const zbx_socket_t	*sock;
+	zbx_timespec_t		ts;
+	int			proxydata_frequency;
+	int			state;
+	size_t			offset;		/* next request member or the first unprocessed history row */
+	size_t			rows_end;	/* end of the last complete history row */
+	int			rows_num;	/* number of complete history rows not processed yet */
+	size_t			peak;		/* maximum size of request data kept in memory */
+	zbx_uint64_t		proxy_hostid;
+	zbx_session_t		*session;
+	zbx_proxy_diff_t	proxy_diff;
+	int			nodata_flags;	/* proxy suppress window flags before history is processed */
+	char			*error;
+	size_t			error_alloc;
+	size_t			error_offset;
+};
+
+static const char	*proxy_data_stream_skip_whitespace(const char *p, const char *end)
+{
+	while (p < end && (' ' == *p || '\t' == *p || '\r' == *p || '\n' == *p))
+		p++;
+
+	return p;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find end of JSON value in partially received data                 *
+ *                                                                            *
+ * Parameters: p   - [IN] the value start                                     *
+ *             end - [IN] the end of received data                            *
+ *                                                                            *
+ * Return value: pointer after the value or NULL if the value is not received *
+ *               completely                                                   *
+ *                                                                            *
+ * Comments: The value is validated later, when it is parsed.                 *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*proxy_data_stream_skip_value(const char *p, const char *end)
+{
+	int	level = 0;
+
+	if ('{' != *p && '[' != *p && '"' != *p)
+	{
+		while (p < end && ',' != *p && ']' != *p && '}' != *p && ' ' != *p && '\t' != *p && '\r' != *p &&
+				'\n' != *p)
+		{
+			p++;
+		}
+
+		return p < end ? p : NULL;
+	}
+
+	for (; p < end; p++)
+	{
+		switch (*p)
+		{
+			case '"':
+				while (++p < end && '"' != *p)
+				{
+					if ('\\' == *p && ++p == end)
+						return NULL;
+				}
+
+				if (p == end)
+					return NULL;
+				break;
+			case '{':
+			case '[':
+				level++;
+				break;
+			case '}':
+			case ']':
+				level--;
+				break;
+		}
+
+		if (0 == level)
+			return p + 1;
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find history data array in partially received request            *
+ *                                                                            *
+ * Parameters: stream - [IN/OUT] the proxy data stream                        *
+ *             data   - [IN] the request data received so far                 *
+ *             size   - [IN] the request data size                            *
+ *                                                                            *
+ * Return value: SUCCEED - the history array was found, stream offset points  *
+ *                         to its first row                                   *
+ *               FAIL    - more data is needed or the request has no history  *
+ *                         data (stream state is set to off)                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	proxy_data_stream_find_history(zbx_proxy_data_stream_t *stream, const char *data, size_t size)
+{
+	const char	*p, *name, *end = data + size;
+	size_t		name_len;
+
+	if (0 == stream->offset)
+	{
+		if (end == (p = proxy_data_stream_skip_whitespace(data, end)))
+			return FAIL;
+
+		if ('{' != *p)
+			goto off;
+
+		stream->offset = (size_t)(p + 1 - data);
+	}
+
+	while (1)
+	{
+		if (end == (p = proxy_data_stream_skip_whitespace(data + stream->offset, end)))
+			return FAIL;
+
+		if ('"' != *p)
+			goto off;
+
+		name = p;
+
+		if (NULL == (p = proxy_data_stream_skip_value(p, end)))
+			return FAIL;
+
+		name_len = (size_t)(p - name);
+
+		if (end == (p = proxy_data_stream_skip_whitespace(p, end)))
+			return FAIL;
+
+		if (':' != *p)
+			goto off;
+
+		if (end == (p = proxy_data_stream_skip_whitespace(p + 1, end)))
+			return FAIL;
+
+		if (ZBX_CONST_STRLEN("\"" ZBX_PROTO_TAG_HISTORY_DATA "\"") == name_len &&
+				0 == strncmp(name, "\"" ZBX_PROTO_TAG_HISTORY_DATA "\"", name_len))
+		{
+			if ('[' != *p)
+				goto off;
+
+			stream->offset = (size_t)(p + 1 - data);
+
+			return SUCCEED;
+		}
+
+		if (NULL == (p = proxy_data_stream_skip_value(p, end)) ||
+				end == (p = proxy_data_stream_skip_whitespace(p, end)))
+		{
+			return FAIL;
+		}
+
+		if (',' != *p)
+			goto off;
+
+		stream->offset = (size_t)(p + 1 - data);
+	}
+off:
+	stream->state = ZBX_PROXY_DATA_STREAM_OFF;
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check the request data received before history and prepare to    *
+ *          process history                                                   *
+ *                                                                            *
+ * Parameters: stream - [IN/OUT] the proxy data stream                        *
+ *             data   - [IN] the request data received so far                 *
+ *                                                                            *
+ * Return value: SUCCEED - history can be processed while it is received      *
+ *               FAIL    - the request must be received completely first      *
+ *                                                                            *
+ * Comments: Errors are reported when the complete request is processed.      *
+ *                                                                            *
+ ******************************************************************************/
+static int	proxy_data_stream_begin(zbx_proxy_data_stream_t *stream, const char *data)
+{
+	char			*head, *error = NULL, value[MAX_STRING_LEN], token[MAX_STRING_LEN];
+	struct zbx_json_parse	jp;
+	zbx_dc_proxy_t		proxy;
+	int			ret = FAIL;
+
+	/* close history array and request object to parse the data received before history */
+	head = (char *)zbx_malloc(NULL, stream->offset + 3);
+	memcpy(head, data, stream->offset);
+	memcpy(head + stream->offset, "]}", 3);
+
+	if (SUCCEED != zbx_json_open(head, &jp))
+		goto out;
+
+	if (SUCCEED != zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_REQUEST, value, sizeof(value), NULL) ||
+			0 != strcmp(value, ZBX_PROTO_VALUE_PROXY_DATA))
+	{
+		goto out;
+	}
+
+	/* session discards values already processed if the proxy sends the request again after failure */
+	if (SUCCEED != zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_SESSION, token, sizeof(token), NULL) ||
+			ZBX_SESSION_TOKEN_SIZE != strlen(token))
+	{
+		goto out;
+	}
+
+	if (SUCCEED != zbx_get_active_proxy_from_request(&jp, &proxy, &error) ||
+			SUCCEED != zbx_proxy_check_permissions(&proxy, stream->sock, &error))
+	{
+		goto out;
+	}
+
+	/* protocol version is sent after history, the version of previous request is checked instead */
+	if (ZBX_PROXY_VERSION_CURRENT != proxy.compatibility || SUCCEED != zbx_hc_check_proxy(proxy.hostid))
+		goto out;
+
+	stream->proxy_diff.flags = ZBX_FLAGS_PROXY_DIFF_UNSET;
+	stream->proxy_diff.hostid = proxy.hostid;
+
+	if (SUCCEED != zbx_dc_get_proxy_nodata_win(proxy.hostid, &stream->proxy_diff.nodata_win,
+			&stream->proxy_diff.lastaccess))
+	{
+		goto out;
+	}
+
+	check_proxy_nodata(&stream->ts, HOST_STATUS_PROXY_ACTIVE, stream->proxydata_frequency, &stream->proxy_diff);
+	stream->nodata_flags = stream->proxy_diff.nodata_win.flags;
+
+	stream->proxy_hostid = proxy.hostid;
+	stream->session = zbx_dc_get_or_create_session(proxy.hostid, token, ZBX_SESSION_TYPE_DATA);
+
+	ret = SUCCEED;
+out:
+	zbx_free(error);
+	zbx_free(head);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process complete history rows and remove them from request data  *
+ *                                                                            *
+ * Parameters: stream - [IN/OUT] the proxy data stream                        *
+ *             data   - [IN/OUT] the request data received so far            *
+ *             size   - [IN/OUT] the request data size                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	proxy_data_stream_process_rows(zbx_proxy_data_stream_t *stream, char *data, size_t *size)
+{
+	struct zbx_json_parse	jp_data;
+	char			*info = NULL, *rows_end = data + stream->rows_end, last = *rows_end;
+	size_t			next;
+
+	/* rows are processed as history array closed after the last complete row */
+	*rows_end = ']';
+	jp_data.start = data + stream->offset - 1;
+	jp_data.end = rows_end;
+
+	if (SUCCEED != process_history_data_by_itemids(NULL, proxy_item_validator, (void *)&stream->proxy_hostid,
+			&jp_data, stream->session, &stream->proxy_diff.nodata_win, &info, ZBX_ITEM_GET_PROCESS))
+	{
+		zbx_strcatnl_alloc(&stream->error, &stream->error_alloc, &stream->error_offset, info);
+	}
+
+	*rows_end = last;
+	zbx_free(info);
+
+	for (next = stream->rows_end; next < *size; next++)
+	{
+		if (',' != data[next] && ' ' != data[next] && '\t' != data[next] && '\r' != data[next] &&
+				'\n' != data[next])
+		{
+			break;
+		}
+	}
+
+	memmove(data + stream->offset, data + next, *size - next);
+	*size -= next - stream->offset;
+
+	stream->rows_end = stream->offset;
+	stream->rows_num = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create stream to process history of large 'proxy data' request   *
+ *          while it is being received                                        *
+ *                                                                            *
+ * Parameters: sock                - [IN] the connection socket               *
+ *             ts                  - [IN] timestamp when the proxy connection *
+ *                                        was established                     *
+ *             proxydata_frequency - [IN]                                     *
+ *                                                                            *
+ * Return value: the proxy data stream                                        *
+ *                                                                            *
+ * Comments: The stream is given to zbx_tcp_recv_consume() with               *
+ *           zbx_proxy_data_stream_consume() callback and then to             *
+ *           zbx_process_proxy_data() to process the rest of request.         *
+ *                                                                            *
+ ******************************************************************************/
+zbx_proxy_data_stream_t	*zbx_proxy_data_stream_create(const zbx_socket_t *sock, const zbx_timespec_t *ts,
+		int proxydata_frequency)
+{
+	zbx_proxy_data_stream_t	*stream;
+
+	stream = (zbx_proxy_data_stream_t *)zbx_malloc(NULL, sizeof(zbx_proxy_data_stream_t));
+	memset(stream, 0, sizeof(zbx_proxy_data_stream_t));
+
+	stream->sock = sock;
+	stream->ts = *ts;
+	stream->proxydata_frequency = proxydata_frequency;
+	stream->state = ZBX_PROXY_DATA_STREAM_HEAD;
+
+	return stream;
+}
+
+void	zbx_proxy_data_stream_free(zbx_proxy_data_stream_t *stream)
+{
+	zbx_free(stream->error);
+	zbx_free(stream);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get maximum size of request data kept in memory while receiving   *
+ *                                                                            *
+ ******************************************************************************/
+size_t	zbx_proxy_data_stream_get_peak(const zbx_proxy_data_stream_t *stream)
+{
+	return stream->peak;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process history rows of partially received 'proxy data' request   *
+ *          in batches and remove them from the request                       *
+ *                                                                            *
+ * Parameters: data - [IN/OUT] the request data received so far               *
+ *             size - [IN/OUT] the request data size                          *
+ *             arg  - [IN] the proxy data stream                              *
+ *                                                                            *
+ * Return value: SUCCEED - more data can be processed                         *
+ *               FAIL    - the rest of request is processed after it is       *
+ *                         received                                           *
+ *                                                                            *
+ * Comments: Processed rows are removed from the history array keeping the    *
+ *           request valid JSON, so the request data kept in memory does not  *
+ *           grow with the number of history rows.                            *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_proxy_data_stream_consume(char *data, size_t *size, void *arg)
+{
+	zbx_proxy_data_stream_t	*stream = (zbx_proxy_data_stream_t *)arg;
+	const char		*p, *end;
+
+	if (stream->peak < *size)
+		stream->peak = *size;
+
+	if (ZBX_PROXY_DATA_STREAM_HEAD == stream->state)
+	{
+		if (SUCCEED != proxy_data_stream_find_history(stream, data, *size))
+			return ZBX_PROXY_DATA_STREAM_OFF == stream->state ? FAIL : SUCCEED;
+
+		if (SUCCEED != proxy_data_stream_begin(stream, data))
+		{
+			stream->state = ZBX_PROXY_DATA_STREAM_OFF;
+			return FAIL;
+		}
+
+		stream->state = ZBX_PROXY_DATA_STREAM_HISTORY;
+		stream->rows_end = stream->offset;
+	}
+
+	end = data + *size;
+
+	for (p = data + stream->rows_end; p < end;)
+	{
+		while (p < end && (',' == *p || ' ' == *p || '\t' == *p || '\r' == *p || '\n' == *p))
+			p++;
+
+		if (p == end)
+			break;
+
+		/* the last batch is processed with the rest of request */
+		if ('{' != *p)
+		{
+			stream->state = ZBX_PROXY_DATA_STREAM_DONE;
+			return FAIL;
+		}
+
+		if (NULL == (p = proxy_data_stream_skip_value(p, end)))
+			break;
+
+		stream->rows_end = (size_t)(p - data);
+
+		if (ZBX_HISTORY_VALUES_MAX == ++stream->rows_num)
+		{
+			proxy_data_stream_process_rows(stream, data, size);
+			end = data + *size;
+			p = data + stream->rows_end;
+		}
+	}
+
+	return SUCCEED;
+}
+
 /***********************************************************************************
  *                                                                                 *
  * Purpose: process 'proxy data' request                                           *
@@ -2907,6 +3384,8 @@ static void	check_proxy_nodata_empty(const zbx_timespec_t *ts, unsigned char pro
  *             jp                  - [IN] JSON with proxy data                     *
  *             ts                  - [IN] timestamp when the proxy connection was  *
  *                                        established                              *
+ *             stream              - [IN] history processed while the request was  *
+ *                                        received, optional                       *
  *             proxy_status        - [IN] active or passive proxy mode             *
  *             events_cbs          - [IN]                                          *
  *             proxydata_frequency - [IN]                                          *
@@ -2919,8 +3398,8 @@ static void	check_proxy_nodata_empty(const zbx_timespec_t *ts, unsigned char pro
  *                                                                                 *
  ***********************************************************************************/
 int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, struct zbx_json_parse *jp, const zbx_timespec_t *ts,
-		unsigned char proxy_status, const zbx_events_funcs_t *events_cbs, int proxydata_frequency, int *more,
-		char **error)
+		const zbx_proxy_data_stream_t *stream, unsigned char proxy_status, const zbx_events_funcs_t *events_cbs,
+		int proxydata_frequency, int *more, char **error)
 {
 	struct zbx_json_parse	jp_data;
 	int			ret = SUCCEED, flags_old;
@@ -2930,15 +3409,29 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, struct zbx_json_parse *j
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	proxy_diff.flags = ZBX_FLAGS_PROXY_DIFF_UNSET;
-	proxy_diff.hostid = proxy->hostid;
+	if (NULL != stream && ZBX_PROXY_DATA_STREAM_HISTORY != stream->state &&
+			ZBX_PROXY_DATA_STREAM_DONE != stream->state)
+	{
+		stream = NULL;
+	}
 
-	if (SUCCEED != (ret = zbx_dc_get_proxy_nodata_win(proxy_diff.hostid, &proxy_diff.nodata_win,
-			&proxy_diff.lastaccess)))
+	/* continue with proxy state of the history processed while the request was received */
+	if (NULL != stream)
 	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot get proxy communication delay");
-		ret = FAIL;
-		goto out;
+		proxy_diff = stream->proxy_diff;
+	}
+	else
+	{
+		proxy_diff.flags = ZBX_FLAGS_PROXY_DIFF_UNSET;
+		proxy_diff.hostid = proxy->hostid;
+
+		if (SUCCEED != (ret = zbx_dc_get_proxy_nodata_win(proxy_diff.hostid, &proxy_diff.nodata_win,
+				&proxy_diff.lastaccess)))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot get proxy communication delay");
+			ret = FAIL;
+			goto out;
+		}
 	}
 
 	if (SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_MORE, value, sizeof(value), NULL))
@@ -2956,8 +3449,10 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, struct zbx_json_parse *j
 
 	proxy_diff.flags |= ZBX_FLAGS_PROXY_DIFF_UPDATE_PROXYDELAY;
 	flags_old = proxy_diff.nodata_win.flags;
+
 	/* first packet can be empty for active proxy */
-	check_proxy_nodata(ts, proxy_status, proxydata_frequency, &proxy_diff);
+	if (NULL == stream)
+		check_proxy_nodata(ts, proxy_status, proxydata_frequency, &proxy_diff);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "%s() flag_win:%d/%d flag:%d proxy_status:%d period_end:%d delay:%d"
 			" timestamp:%d lastaccess:%d proxy_delay:%d more:%d", __func__, proxy_diff.nodata_win.flags,
@@ -2974,13 +3469,17 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, struct zbx_json_parse *j
 			zbx_strcatnl_alloc(error, &error_alloc, &error_offset, error_step);
 	}
 
-	flags_old = proxy_diff.nodata_win.flags;
+	flags_old = (NULL != stream ? stream->nodata_flags : proxy_diff.nodata_win.flags);
 
 	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_HISTORY_DATA, &jp_data))
 	{
 		zbx_session_t	*session = NULL;
 
-		if (SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_SESSION, value, sizeof(value), NULL))
+		if (NULL != stream)
+		{
+			session = stream->session;
+		}
+		else if (SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_SESSION, value, sizeof(value), NULL))
 		{
 			size_t	token_len;
 
@@ -3002,6 +3501,12 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, struct zbx_json_parse *j
 		}
 	}
 
+	if (NULL != stream && NULL != stream->error)
+	{
+		zbx_strcatnl_alloc(error, &error_alloc, &error_offset, stream->error);
+		ret = FAIL;
+	}
+
 	if (0 != (proxy_diff.nodata_win.flags & ZBX_PROXY_SUPPRESS_ACTIVE))
 	{
 		check_proxy_nodata_empty(ts, proxy_status, &proxy_diff);
@@ -3361,3 +3866,6 @@ int	zbx_check_protocol_version(zbx_dc_proxy_t *proxy, int version)
 	return SUCCEED;
 }
 
+#ifdef HAVE_TESTS
+#	include "../../../tests/libs/zbxdbwrap/proxy_data_stream_test.c"
+#endif
@@ -23,6 +23,7 @@
 #include "zbxalgo.h"
 #include "zbxshmem.h"
 #include "zbxcachehistory.h"
+#include "zbxcacheconfig.h"
 #include "zbxconnector.h"
 #include "zbxlog.h"
 #include "zbxmutexs.h"
@@ -51,6 +52,12 @@
 #define ZBX_DIAG_CONNECTOR_VALUES			0x00000001
 #define ZBX_DIAG_CONNECTOR_SIMPLE		(ZBX_DIAG_CONNECTOR_VALUES)
 
+#define ZBX_DIAG_CONFIGCACHE_READERS		0x00000001
+#define ZBX_DIAG_CONFIGCACHE_SYNC		0x00000002
+
+#define ZBX_DIAG_CONFIGCACHE_SIMPLE	(ZBX_DIAG_CONFIGCACHE_READERS | \
+					ZBX_DIAG_CONFIGCACHE_SYNC)
+
 static zbx_diag_add_section_info_func_t	add_diag_cb;
 
 void	zbx_diag_map_free(zbx_diag_map_t *map)
@@ -204,6 +211,33 @@ void	zbx_diag_add_mem_stats(struct zbx_json *json, const char *name, const zbx_s
 
 	zbx_json_close(json);
 	zbx_json_close(json);
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		if (0 != stats->slab_classes[i].slabs_num)
+			break;
+	}
+
+	if (ZBX_SHMEM_SLAB_CLASS_COUNT != i)
+	{
+		zbx_json_addarray(json, "slabs");
+
+		for (; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+		{
+			if (0 == stats->slab_classes[i].slabs_num)
+				continue;
+
+			zbx_json_addobject(json, NULL);
+			zbx_json_adduint64(json, "size", (zbx_uint64_t)(8 * (i + 1)));
+			zbx_json_adduint64(json, "slabs", stats->slab_classes[i].slabs_num);
+			zbx_json_adduint64(json, "used", stats->slab_classes[i].used_objects);
+			zbx_json_adduint64(json, "free", stats->slab_classes[i].free_objects);
+			zbx_json_close(json);
+		}
+
+		zbx_json_close(json);
+	}
+
 	zbx_json_close(json);
 }
 
@@ -550,27 +584,40 @@ void	zbx_diag_add_locks_info(struct zbx_json *json)
 {
 	int		i;
 #ifdef HAVE_VMINFO_T_UPDATES
-	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
+	const char	*names[ZBX_MUTEX_CACHE_SHARD] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_KSTAT", "ZBX_MUTEX_MODBUS",
-				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS"};
+				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_CONFIG_STATS",
+				"ZBX_MUTEX_TRIGGER_QUEUE", "ZBX_MUTEX_CACHE_STATS"};
 #else
-	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
+	const char	*names[ZBX_MUTEX_CACHE_SHARD] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_MODBUS",
-				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS"};
+				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_CONFIG_STATS",
+				"ZBX_MUTEX_TRIGGER_QUEUE", "ZBX_MUTEX_CACHE_STATS"};
 #endif
 	zbx_json_addarray(json, ZBX_DIAG_LOCKS);
 
-	for (i = 0; i < ZBX_MUTEX_COUNT; i++)
+	for (i = 0; i < ZBX_MUTEX_CACHE_SHARD; i++)
 	{
 		zbx_json_addobject(json, NULL);
 		zbx_json_addhex(json, names[i], (zbx_uint64_t)zbx_mutex_addr_get(i));
 		zbx_json_close(json);
 	}
 
+	for (i = ZBX_MUTEX_CACHE_SHARD; i < ZBX_MUTEX_COUNT; i++)
+	{
+		char	name[MAX_STRING_LEN];
+
+		zbx_snprintf(name, sizeof(name), "ZBX_MUTEX_CACHE_SHARD_%d", i - ZBX_MUTEX_CACHE_SHARD + 1);
+
+		zbx_json_addobject(json, NULL);
+		zbx_json_addhex(json, name, (zbx_uint64_t)zbx_mutex_addr_get(i));
+		zbx_json_close(json);
+	}
+
 	zbx_json_addobject(json, NULL);
 	zbx_json_addhex(json, "ZBX_RWLOCK_CONFIG", (zbx_uint64_t)zbx_rwlock_addr_get(ZBX_RWLOCK_CONFIG));
 	zbx_json_close(json);
@@ -686,6 +733,9 @@ static void	diag_prepare_default_request(struct zbx_json *j, unsigned int flags)
 
 	if (0 != (flags & (1 << ZBX_DIAGINFO_CONNECTOR)))
 		diag_add_section_request(j, ZBX_DIAG_CONNECTOR, "values", NULL);
+
+	if (0 != (flags & (1 << ZBX_DIAGINFO_CONFIGCACHE)))
+		diag_add_section_request(j, ZBX_DIAG_CONFIGCACHE, NULL);
 }
 
 /******************************************************************************
@@ -735,7 +785,7 @@ static void	diag_get_simple_values(const struct zbx_json_parse *jp, char **msg)
 static void	diag_log_memory_info(struct zbx_json_parse *jp, const char *field, const char *path, char **out,
 		size_t *out_alloc, size_t *out_offset)
 {
-	struct zbx_json_parse	jp_memory, jp_size, jp_chunks;
+	struct zbx_json_parse	jp_memory, jp_size, jp_chunks, jp_slabs, jp_slab;
 	char			*msg = NULL;
 
 	if (FAIL == zbx_json_open_path(jp, path, &jp_memory))
@@ -775,6 +825,23 @@ static void	diag_log_memory_info(struct zbx_json_parse *jp, const char *field, c
 			}
 		}
 	}
+
+	if (SUCCEED == zbx_json_brackets_by_name(&jp_memory, "slabs", &jp_slabs))
+	{
+		const char	*pnext;
+
+		zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "  slabs:");
+
+		for (pnext = NULL; NULL != (pnext = zbx_json_next(&jp_slabs, pnext));)
+		{
+			if (SUCCEED == zbx_json_brackets_open(pnext, &jp_slab))
+			{
+				diag_get_simple_values(&jp_slab, &msg);
+				zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "    %s", msg);
+				zbx_free(msg);
+			}
+		}
+	}
 }
 
 /******************************************************************************
@@ -944,6 +1011,25 @@ static void	diag_log_connector(struct zbx_json_parse *jp, char **out, size_t *ou
 	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: log configuration cache diagnostic information                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_log_config_cache(struct zbx_json_parse *jp, char **out, size_t *out_alloc, size_t *out_offset)
+{
+	char	*msg = NULL;
+
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset,
+			"== configuration cache diagnostic information ==");
+
+	diag_get_simple_values(jp, &msg);
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "%s", msg);
+	zbx_free(msg);
+
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: log diagnostic information                                        *
@@ -1008,6 +1094,8 @@ void	zbx_diag_log_info(unsigned int flags, char **result)
 			}
 			else if (0 == strcmp(section, ZBX_DIAG_CONNECTOR))
 				diag_log_connector(&jp_section, result, &result_alloc, &result_offset);
+			else if (0 == strcmp(section, ZBX_DIAG_CONFIGCACHE))
+				diag_log_config_cache(&jp_section, result, &result_alloc, &result_offset);
 		}
 	}
 	else
@@ -1120,6 +1208,81 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add requested configuration cache diagnostic information to json  *
+ *          data                                                              *
+ *                                                                            *
+ * Parameters: jp    - [IN] the request                                       *
+ *             json  - [IN/OUT] the json to update                            *
+ *             error - [OUT] error message                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the information was added successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_diag_add_configcache_info(const struct zbx_json_parse *jp, struct zbx_json *json, char **error)
+{
+	zbx_vector_ptr_t	tops;
+	int			ret;
+	double			time1, time2, time_total = 0;
+	zbx_uint64_t		fields;
+	zbx_diag_map_t		field_map[] = {
+					{"", ZBX_DIAG_CONFIGCACHE_SIMPLE},
+					{"readers", ZBX_DIAG_CONFIGCACHE_READERS},
+					{"sync", ZBX_DIAG_CONFIGCACHE_SYNC},
+					{NULL, 0}
+					};
+
+	zbx_vector_ptr_create(&tops);
+
+	if (SUCCEED == (ret = zbx_diag_parse_request(jp, field_map, &fields, &tops, error)))
+	{
+		zbx_json_addobject(json, ZBX_DIAG_CONFIGCACHE);
+
+		if (0 != (fields & ZBX_DIAG_CONFIGCACHE_SIMPLE))
+		{
+			zbx_config_cache_lock_stats_t	stats;
+
+			time1 = zbx_time();
+			zbx_dc_get_lock_stats(&stats);
+			time2 = zbx_time();
+			time_total += time2 - time1;
+
+			if (0 != (fields & ZBX_DIAG_CONFIGCACHE_READERS))
+			{
+				zbx_json_adduint64(json, "reader.stalls", stats.reader_stalls);
+				zbx_json_addfloat(json, "reader.stall.total", stats.reader_stall_total);
+				zbx_json_addfloat(json, "reader.stall.max", stats.reader_stall_max);
+			}
+
+			if (0 != (fields & ZBX_DIAG_CONFIGCACHE_SYNC))
+			{
+				zbx_json_adduint64(json, "sync.locks", stats.sync_locks);
+				zbx_json_addfloat(json, "sync.lock.total", stats.sync_lock_total);
+				zbx_json_addfloat(json, "sync.lock.max", stats.sync_lock_max);
+			}
+		}
+
+		if (0 != tops.values_num)
+		{
+			zbx_diag_map_t	*map = (zbx_diag_map_t *)tops.values[0];
+
+			*error = zbx_dsprintf(*error, "Unsupported top field: %s", map->name);
+			ret = FAIL;
+		}
+
+		zbx_json_addfloat(json, "time", time_total);
+
+		zbx_json_close(json);
+	}
+
+	zbx_vector_ptr_clear_ext(&tops, (zbx_ptr_free_func_t)zbx_diag_map_free);
+	zbx_vector_ptr_destroy(&tops);
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: init section add callback function                                *
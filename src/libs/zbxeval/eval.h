@@ -26,5 +26,7 @@ int	eval_suffixed_number_parse(const char *value, char *suffix);
 int	eval_compare_token(const zbx_eval_context_t *ctx, const zbx_strloc_t *loc, const char *text,
 		size_t len);
 size_t	eval_parse_query(const char *str, const char **phost, const char **pkey, const char **pfilter);
+int	eval_compile(const zbx_eval_context_t *ctx, zbx_eval_instr_t **code);
+void	eval_free_code(zbx_eval_instr_t *code, int code_num);
 
 #endif
@@ -50,6 +50,166 @@ typedef enum
 }
 zbx_function_trim_optype_t;
 
+/* common functions, resolved by name when expression is compiled or executed */
+typedef enum
+{
+	EVAL_FUNCTION_MIN = 0,
+	EVAL_FUNCTION_MAX,
+	EVAL_FUNCTION_SUM,
+	EVAL_FUNCTION_AVG,
+	EVAL_FUNCTION_ABS,
+	EVAL_FUNCTION_LENGTH,
+	EVAL_FUNCTION_DATE,
+	EVAL_FUNCTION_TIME,
+	EVAL_FUNCTION_NOW,
+	EVAL_FUNCTION_DAYOFWEEK,
+	EVAL_FUNCTION_DAYOFMONTH,
+	EVAL_FUNCTION_BITAND,
+	EVAL_FUNCTION_BITOR,
+	EVAL_FUNCTION_BITXOR,
+	EVAL_FUNCTION_BITLSHIFT,
+	EVAL_FUNCTION_BITRSHIFT,
+	EVAL_FUNCTION_BITNOT,
+	EVAL_FUNCTION_BETWEEN,
+	EVAL_FUNCTION_IN,
+	EVAL_FUNCTION_ASCII,
+	EVAL_FUNCTION_CHAR,
+	EVAL_FUNCTION_LEFT,
+	EVAL_FUNCTION_RIGHT,
+	EVAL_FUNCTION_MID,
+	EVAL_FUNCTION_BITLENGTH,
+	EVAL_FUNCTION_BYTELENGTH,
+	EVAL_FUNCTION_CONCAT,
+	EVAL_FUNCTION_INSERT,
+	EVAL_FUNCTION_REPLACE,
+	EVAL_FUNCTION_REPEAT,
+	EVAL_FUNCTION_LTRIM,
+	EVAL_FUNCTION_RTRIM,
+	EVAL_FUNCTION_TRIM,
+	EVAL_FUNCTION_CBRT,
+	EVAL_FUNCTION_CEIL,
+	EVAL_FUNCTION_EXP,
+	EVAL_FUNCTION_EXPM1,
+	EVAL_FUNCTION_FLOOR,
+	EVAL_FUNCTION_SIGNUM,
+	EVAL_FUNCTION_DEGREES,
+	EVAL_FUNCTION_RADIANS,
+	EVAL_FUNCTION_ACOS,
+	EVAL_FUNCTION_ASIN,
+	EVAL_FUNCTION_ATAN,
+	EVAL_FUNCTION_COS,
+	EVAL_FUNCTION_COSH,
+	EVAL_FUNCTION_COT,
+	EVAL_FUNCTION_SIN,
+	EVAL_FUNCTION_SINH,
+	EVAL_FUNCTION_TAN,
+	EVAL_FUNCTION_LOG,
+	EVAL_FUNCTION_LOG10,
+	EVAL_FUNCTION_SQRT,
+	EVAL_FUNCTION_POWER,
+	EVAL_FUNCTION_ROUND,
+	EVAL_FUNCTION_MOD,
+	EVAL_FUNCTION_TRUNCATE,
+	EVAL_FUNCTION_ATAN2,
+	EVAL_FUNCTION_PI,
+	EVAL_FUNCTION_E,
+	EVAL_FUNCTION_RAND,
+	EVAL_FUNCTION_KURTOSIS,
+	EVAL_FUNCTION_MAD,
+	EVAL_FUNCTION_SKEWNESS,
+	EVAL_FUNCTION_STDDEVPOP,
+	EVAL_FUNCTION_STDDEVSAMP,
+	EVAL_FUNCTION_SUMOFSQUARES,
+	EVAL_FUNCTION_VARPOP,
+	EVAL_FUNCTION_VARSAMP,
+	EVAL_FUNCTION_COUNT,
+	EVAL_FUNCTION_HISTOGRAM_QUANTILE,
+	EVAL_FUNCTION_UNKNOWN
+}
+zbx_eval_function_t;
+
+typedef struct
+{
+	const char	*name;
+	size_t		len;
+}
+zbx_eval_function_name_t;
+
+/* must be in the same order as zbx_eval_function_t values */
+static const zbx_eval_function_name_t	eval_functions[] = {
+	{"min", ZBX_CONST_STRLEN("min")},
+	{"max", ZBX_CONST_STRLEN("max")},
+	{"sum", ZBX_CONST_STRLEN("sum")},
+	{"avg", ZBX_CONST_STRLEN("avg")},
+	{"abs", ZBX_CONST_STRLEN("abs")},
+	{"length", ZBX_CONST_STRLEN("length")},
+	{"date", ZBX_CONST_STRLEN("date")},
+	{"time", ZBX_CONST_STRLEN("time")},
+	{"now", ZBX_CONST_STRLEN("now")},
+	{"dayofweek", ZBX_CONST_STRLEN("dayofweek")},
+	{"dayofmonth", ZBX_CONST_STRLEN("dayofmonth")},
+	{"bitand", ZBX_CONST_STRLEN("bitand")},
+	{"bitor", ZBX_CONST_STRLEN("bitor")},
+	{"bitxor", ZBX_CONST_STRLEN("bitxor")},
+	{"bitlshift", ZBX_CONST_STRLEN("bitlshift")},
+	{"bitrshift", ZBX_CONST_STRLEN("bitrshift")},
+	{"bitnot", ZBX_CONST_STRLEN("bitnot")},
+	{"between", ZBX_CONST_STRLEN("between")},
+	{"in", ZBX_CONST_STRLEN("in")},
+	{"ascii", ZBX_CONST_STRLEN("ascii")},
+	{"char", ZBX_CONST_STRLEN("char")},
+	{"left", ZBX_CONST_STRLEN("left")},
+	{"right", ZBX_CONST_STRLEN("right")},
+	{"mid", ZBX_CONST_STRLEN("mid")},
+	{"bitlength", ZBX_CONST_STRLEN("bitlength")},
+	{"bytelength", ZBX_CONST_STRLEN("bytelength")},
+	{"concat", ZBX_CONST_STRLEN("concat")},
+	{"insert", ZBX_CONST_STRLEN("insert")},
+	{"replace", ZBX_CONST_STRLEN("replace")},
+	{"repeat", ZBX_CONST_STRLEN("repeat")},
+	{"ltrim", ZBX_CONST_STRLEN("ltrim")},
+	{"rtrim", ZBX_CONST_STRLEN("rtrim")},
+	{"trim", ZBX_CONST_STRLEN("trim")},
+	{"cbrt", ZBX_CONST_STRLEN("cbrt")},
+	{"ceil", ZBX_CONST_STRLEN("ceil")},
+	{"exp", ZBX_CONST_STRLEN("exp")},
+	{"expm1", ZBX_CONST_STRLEN("expm1")},
+	{"floor", ZBX_CONST_STRLEN("floor")},
+	{"signum", ZBX_CONST_STRLEN("signum")},
+	{"degrees", ZBX_CONST_STRLEN("degrees")},
+	{"radians", ZBX_CONST_STRLEN("radians")},
+	{"acos", ZBX_CONST_STRLEN("acos")},
+	{"asin", ZBX_CONST_STRLEN("asin")},
+	{"atan", ZBX_CONST_STRLEN("atan")},
+	{"cos", ZBX_CONST_STRLEN("cos")},
+	{"cosh", ZBX_CONST_STRLEN("cosh")},
+	{"cot", ZBX_CONST_STRLEN("cot")},
+	{"sin", ZBX_CONST_STRLEN("sin")},
+	{"sinh", ZBX_CONST_STRLEN("sinh")},
+	{"tan", ZBX_CONST_STRLEN("tan")},
+	{"log", ZBX_CONST_STRLEN("log")},
+	{"log10", ZBX_CONST_STRLEN("log10")},
+	{"sqrt", ZBX_CONST_STRLEN("sqrt")},
+	{"power", ZBX_CONST_STRLEN("power")},
+	{"round", ZBX_CONST_STRLEN("round")},
+	{"mod", ZBX_CONST_STRLEN("mod")},
+	{"truncate", ZBX_CONST_STRLEN("truncate")},
+	{"atan2", ZBX_CONST_STRLEN("atan2")},
+	{"pi", ZBX_CONST_STRLEN("pi")},
+	{"e", ZBX_CONST_STRLEN("e")},
+	{"rand", ZBX_CONST_STRLEN("rand")},
+	{"kurtosis", ZBX_CONST_STRLEN("kurtosis")},
+	{"mad", ZBX_CONST_STRLEN("mad")},
+	{"skewness", ZBX_CONST_STRLEN("skewness")},
+	{"stddevpop", ZBX_CONST_STRLEN("stddevpop")},
+	{"stddevsamp", ZBX_CONST_STRLEN("stddevsamp")},
+	{"sumofsquares", ZBX_CONST_STRLEN("sumofsquares")},
+	{"varpop", ZBX_CONST_STRLEN("varpop")},
+	{"varsamp", ZBX_CONST_STRLEN("varsamp")},
+	{"count", ZBX_CONST_STRLEN("count")},
+	{"histogram_quantile", ZBX_CONST_STRLEN("histogram_quantile")}
+};
+
 /******************************************************************************
  *                                                                            *
  * Purpose: converts variant string value containing suffixed number to       *
@@ -430,6 +590,30 @@ int	 eval_suffixed_number_parse(const char *value, char *suffix)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses numeric token                                              *
+ *                                                                            *
+ * Parameters: ctx   - [IN] evaluation context                                *
+ *             token - [IN] numeric token                                     *
+ *             value - [OUT] parsed value                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	eval_parse_number(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token, zbx_variant_t *value)
+{
+	zbx_uint64_t	ui64;
+
+	if (SUCCEED == zbx_is_uint64_n(ctx->expression + token->loc.l, token->loc.r - token->loc.l + 1, &ui64))
+	{
+		zbx_variant_set_ui64(value, ui64);
+	}
+	else
+	{
+		zbx_variant_set_dbl(value, atof(ctx->expression + token->loc.l) *
+				suffix2factor(ctx->expression[token->loc.r]));
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: pushes value in output stack                                      *
@@ -454,18 +638,7 @@ static int	eval_execute_push_value(const zbx_eval_context_t *ctx, const zbx_eval
 	{
 		if (ZBX_EVAL_TOKEN_VAR_NUM == token->type)
 		{
-			zbx_uint64_t	ui64;
-
-			if (SUCCEED == zbx_is_uint64_n(ctx->expression + token->loc.l, token->loc.r - token->loc.l + 1,
-					&ui64))
-			{
-				zbx_variant_set_ui64(&value, ui64);
-			}
-			else
-			{
-				zbx_variant_set_dbl(&value, atof(ctx->expression + token->loc.l) *
-						suffix2factor(ctx->expression[token->loc.r]));
-			}
+			eval_parse_number(ctx, token, &value);
 		}
 		else
 		{
@@ -2770,10 +2943,35 @@ static int	eval_execute_function_count(const zbx_eval_context_t *ctx, const zbx_
 
 /******************************************************************************
  *                                                                            *
- * Purpose: evaluates common function                                         *
+ * Purpose: resolves common function name into function identifier           *
+ *                                                                            *
+ * Parameters: ctx   - [IN] evaluation context                                *
+ *             token - [IN] function token                                    *
+ *                                                                            *
+ * Return value: function identifier or EVAL_FUNCTION_UNKNOWN if the function *
+ *               is not supported by evaluation library                       *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint32_t	eval_resolve_common_function(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token)
+{
+	zbx_uint32_t	i;
+
+	for (i = 0; i < EVAL_FUNCTION_UNKNOWN; i++)
+	{
+		if (SUCCEED == eval_compare_token(ctx, &token->loc, eval_functions[i].name, eval_functions[i].len))
+			return i;
+	}
+
+	return EVAL_FUNCTION_UNKNOWN;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates resolved common function                                *
  *                                                                            *
  * Parameters: ctx    - [IN] evaluation context                               *
  *             token  - [IN] function token                                   *
+ *             func   - [IN] function identifier                              *
  *             output - [IN/OUT] output value stack                           *
  *             error  - [OUT] error message in case of failure                *
  *                                                                            *
@@ -2781,8 +2979,8 @@ static int	eval_execute_function_count(const zbx_eval_context_t *ctx, const zbx_
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	eval_execute_common_function(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
-		zbx_vector_var_t *output, char **error)
+static int	eval_execute_resolved_function(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
+		zbx_uint32_t func, zbx_vector_var_t *output, char **error)
 {
 	if ((zbx_uint32_t)output->values_num < token->opt)
 	{
@@ -2791,150 +2989,150 @@ static int	eval_execute_common_function(const zbx_eval_context_t *ctx, const zbx
 		return FAIL;
 	}
 
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "min", ZBX_CONST_STRLEN("min")))
-		return eval_execute_function_min(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "max", ZBX_CONST_STRLEN("max")))
-		return eval_execute_function_max(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sum", ZBX_CONST_STRLEN("sum")))
-		return eval_execute_function_sum(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "avg", ZBX_CONST_STRLEN("avg")))
-		return eval_execute_function_avg(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "abs", ZBX_CONST_STRLEN("abs")))
-		return eval_execute_function_abs(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "length", ZBX_CONST_STRLEN("length")))
-		return eval_execute_function_length(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "date", ZBX_CONST_STRLEN("date")))
-		return eval_execute_function_date(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "time", ZBX_CONST_STRLEN("time")))
-		return eval_execute_function_time(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "now", ZBX_CONST_STRLEN("now")))
-		return eval_execute_function_now(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "dayofweek", ZBX_CONST_STRLEN("dayofweek")))
-		return eval_execute_function_dayofweek(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "dayofmonth", ZBX_CONST_STRLEN("dayofmonth")))
-		return eval_execute_function_dayofmonth(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitand", ZBX_CONST_STRLEN("bitand")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_AND, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitor", ZBX_CONST_STRLEN("bitor")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_OR, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitxor", ZBX_CONST_STRLEN("bitxor")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_XOR, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitlshift", ZBX_CONST_STRLEN("bitlshift")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_LSHIFT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitrshift", ZBX_CONST_STRLEN("bitrshift")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_RSHIFT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitnot", ZBX_CONST_STRLEN("bitnot")))
-		return eval_execute_function_bitnot(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "between", ZBX_CONST_STRLEN("between")))
-		return eval_execute_function_between(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "in", ZBX_CONST_STRLEN("in")))
-		return eval_execute_function_in(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "ascii", ZBX_CONST_STRLEN("ascii")))
-		return eval_execute_function_ascii(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "char", ZBX_CONST_STRLEN("char")))
-		return eval_execute_function_char(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "left", ZBX_CONST_STRLEN("left")))
-		return eval_execute_function_left(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "right", ZBX_CONST_STRLEN("right")))
-		return eval_execute_function_right(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "mid", ZBX_CONST_STRLEN("mid")))
-		return eval_execute_function_mid(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitlength", ZBX_CONST_STRLEN("bitlength")))
-		return eval_execute_function_bitlength(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bytelength", ZBX_CONST_STRLEN("bytelength")))
-		return eval_execute_function_bytelength(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "concat", ZBX_CONST_STRLEN("concat")))
-		return eval_execute_function_concat(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "insert", ZBX_CONST_STRLEN("insert")))
-		return eval_execute_function_insert(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "replace", ZBX_CONST_STRLEN("replace")))
-		return eval_execute_function_replace(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "repeat", ZBX_CONST_STRLEN("repeat")))
-		return eval_execute_function_repeat(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "ltrim", ZBX_CONST_STRLEN("ltrim")))
-		return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_LEFT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "rtrim", ZBX_CONST_STRLEN("rtrim")))
-		return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_RIGHT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "trim", ZBX_CONST_STRLEN("trim")))
-		return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_ALL, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cbrt", ZBX_CONST_STRLEN("cbrt")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, cbrt);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "ceil", ZBX_CONST_STRLEN("ceil")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, ceil);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "exp", ZBX_CONST_STRLEN("exp")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, exp);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "expm1", ZBX_CONST_STRLEN("expm1")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, expm1);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "floor", ZBX_CONST_STRLEN("floor")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, floor);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "signum", ZBX_CONST_STRLEN("signum")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_signum);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "degrees", ZBX_CONST_STRLEN("degrees")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_degrees);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "radians", ZBX_CONST_STRLEN("radians")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_radians);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "acos", ZBX_CONST_STRLEN("acos")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, acos);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "asin", ZBX_CONST_STRLEN("asin")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, asin);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "atan", ZBX_CONST_STRLEN("atan")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, atan);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cos", ZBX_CONST_STRLEN("cos")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, cos);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cosh", ZBX_CONST_STRLEN("cosh")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, cosh);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cot", ZBX_CONST_STRLEN("cot")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_cot);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sin", ZBX_CONST_STRLEN("sin")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, sin);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sinh", ZBX_CONST_STRLEN("sinh")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, sinh);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "tan", ZBX_CONST_STRLEN("tan")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, tan);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "log", ZBX_CONST_STRLEN("log")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, log);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "log10", ZBX_CONST_STRLEN("log10")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, log10);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sqrt", ZBX_CONST_STRLEN("sqrt")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, sqrt);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "power", ZBX_CONST_STRLEN("power")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, pow);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "round", ZBX_CONST_STRLEN("round")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, eval_math_func_round);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "mod", ZBX_CONST_STRLEN("mod")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, fmod);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "truncate", ZBX_CONST_STRLEN("truncate")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, eval_math_func_truncate);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "atan2", ZBX_CONST_STRLEN("atan2")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, atan2);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "pi", ZBX_CONST_STRLEN("pi")))
-		return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_PI);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "e", ZBX_CONST_STRLEN("e")))
-		return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_E);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "rand", ZBX_CONST_STRLEN("rand")))
-		return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_RANDOM);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "kurtosis", ZBX_CONST_STRLEN("kurtosis")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_kurtosis, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "mad", ZBX_CONST_STRLEN("mad")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_mad, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "skewness", ZBX_CONST_STRLEN("skewness")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_skewness, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "stddevpop", ZBX_CONST_STRLEN("stddevpop")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevpop, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "stddevsamp", ZBX_CONST_STRLEN("stddevsamp")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevsamp, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sumofsquares", ZBX_CONST_STRLEN("sumofsquares")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_sumofsquares, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "varpop", ZBX_CONST_STRLEN("varpop")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varpop, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "varsamp", ZBX_CONST_STRLEN("varsamp")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varsamp, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "count", ZBX_CONST_STRLEN("count")))
-		return eval_execute_function_count(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "histogram_quantile",
-			ZBX_CONST_STRLEN("histogram_quantile")))
-	{
-		return eval_execute_function_histogram_quantile(ctx, token, output, error);
+	switch (func)
+	{
+		case EVAL_FUNCTION_MIN:
+			return eval_execute_function_min(ctx, token, output, error);
+		case EVAL_FUNCTION_MAX:
+			return eval_execute_function_max(ctx, token, output, error);
+		case EVAL_FUNCTION_SUM:
+			return eval_execute_function_sum(ctx, token, output, error);
+		case EVAL_FUNCTION_AVG:
+			return eval_execute_function_avg(ctx, token, output, error);
+		case EVAL_FUNCTION_ABS:
+			return eval_execute_function_abs(ctx, token, output, error);
+		case EVAL_FUNCTION_LENGTH:
+			return eval_execute_function_length(ctx, token, output, error);
+		case EVAL_FUNCTION_DATE:
+			return eval_execute_function_date(ctx, token, output, error);
+		case EVAL_FUNCTION_TIME:
+			return eval_execute_function_time(ctx, token, output, error);
+		case EVAL_FUNCTION_NOW:
+			return eval_execute_function_now(ctx, token, output, error);
+		case EVAL_FUNCTION_DAYOFWEEK:
+			return eval_execute_function_dayofweek(ctx, token, output, error);
+		case EVAL_FUNCTION_DAYOFMONTH:
+			return eval_execute_function_dayofmonth(ctx, token, output, error);
+		case EVAL_FUNCTION_BITAND:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_AND, output, error);
+		case EVAL_FUNCTION_BITOR:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_OR, output, error);
+		case EVAL_FUNCTION_BITXOR:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_XOR, output, error);
+		case EVAL_FUNCTION_BITLSHIFT:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_LSHIFT, output, error);
+		case EVAL_FUNCTION_BITRSHIFT:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_RSHIFT, output, error);
+		case EVAL_FUNCTION_BITNOT:
+			return eval_execute_function_bitnot(ctx, token, output, error);
+		case EVAL_FUNCTION_BETWEEN:
+			return eval_execute_function_between(ctx, token, output, error);
+		case EVAL_FUNCTION_IN:
+			return eval_execute_function_in(ctx, token, output, error);
+		case EVAL_FUNCTION_ASCII:
+			return eval_execute_function_ascii(ctx, token, output, error);
+		case EVAL_FUNCTION_CHAR:
+			return eval_execute_function_char(ctx, token, output, error);
+		case EVAL_FUNCTION_LEFT:
+			return eval_execute_function_left(ctx, token, output, error);
+		case EVAL_FUNCTION_RIGHT:
+			return eval_execute_function_right(ctx, token, output, error);
+		case EVAL_FUNCTION_MID:
+			return eval_execute_function_mid(ctx, token, output, error);
+		case EVAL_FUNCTION_BITLENGTH:
+			return eval_execute_function_bitlength(ctx, token, output, error);
+		case EVAL_FUNCTION_BYTELENGTH:
+			return eval_execute_function_bytelength(ctx, token, output, error);
+		case EVAL_FUNCTION_CONCAT:
+			return eval_execute_function_concat(ctx, token, output, error);
+		case EVAL_FUNCTION_INSERT:
+			return eval_execute_function_insert(ctx, token, output, error);
+		case EVAL_FUNCTION_REPLACE:
+			return eval_execute_function_replace(ctx, token, output, error);
+		case EVAL_FUNCTION_REPEAT:
+			return eval_execute_function_repeat(ctx, token, output, error);
+		case EVAL_FUNCTION_LTRIM:
+			return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_LEFT, output, error);
+		case EVAL_FUNCTION_RTRIM:
+			return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_RIGHT, output, error);
+		case EVAL_FUNCTION_TRIM:
+			return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_ALL, output, error);
+		case EVAL_FUNCTION_CBRT:
+			return eval_execute_math_function_single_param(ctx, token, output, error, cbrt);
+		case EVAL_FUNCTION_CEIL:
+			return eval_execute_math_function_single_param(ctx, token, output, error, ceil);
+		case EVAL_FUNCTION_EXP:
+			return eval_execute_math_function_single_param(ctx, token, output, error, exp);
+		case EVAL_FUNCTION_EXPM1:
+			return eval_execute_math_function_single_param(ctx, token, output, error, expm1);
+		case EVAL_FUNCTION_FLOOR:
+			return eval_execute_math_function_single_param(ctx, token, output, error, floor);
+		case EVAL_FUNCTION_SIGNUM:
+			return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_signum);
+		case EVAL_FUNCTION_DEGREES:
+			return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_degrees);
+		case EVAL_FUNCTION_RADIANS:
+			return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_radians);
+		case EVAL_FUNCTION_ACOS:
+			return eval_execute_math_function_single_param(ctx, token, output, error, acos);
+		case EVAL_FUNCTION_ASIN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, asin);
+		case EVAL_FUNCTION_ATAN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, atan);
+		case EVAL_FUNCTION_COS:
+			return eval_execute_math_function_single_param(ctx, token, output, error, cos);
+		case EVAL_FUNCTION_COSH:
+			return eval_execute_math_function_single_param(ctx, token, output, error, cosh);
+		case EVAL_FUNCTION_COT:
+			return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_cot);
+		case EVAL_FUNCTION_SIN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, sin);
+		case EVAL_FUNCTION_SINH:
+			return eval_execute_math_function_single_param(ctx, token, output, error, sinh);
+		case EVAL_FUNCTION_TAN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, tan);
+		case EVAL_FUNCTION_LOG:
+			return eval_execute_math_function_single_param(ctx, token, output, error, log);
+		case EVAL_FUNCTION_LOG10:
+			return eval_execute_math_function_single_param(ctx, token, output, error, log10);
+		case EVAL_FUNCTION_SQRT:
+			return eval_execute_math_function_single_param(ctx, token, output, error, sqrt);
+		case EVAL_FUNCTION_POWER:
+			return eval_execute_math_function_double_param(ctx, token, output, error, pow);
+		case EVAL_FUNCTION_ROUND:
+			return eval_execute_math_function_double_param(ctx, token, output, error, eval_math_func_round);
+		case EVAL_FUNCTION_MOD:
+			return eval_execute_math_function_double_param(ctx, token, output, error, fmod);
+		case EVAL_FUNCTION_TRUNCATE:
+			return eval_execute_math_function_double_param(ctx, token, output, error, eval_math_func_truncate);
+		case EVAL_FUNCTION_ATAN2:
+			return eval_execute_math_function_double_param(ctx, token, output, error, atan2);
+		case EVAL_FUNCTION_PI:
+			return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_PI);
+		case EVAL_FUNCTION_E:
+			return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_E);
+		case EVAL_FUNCTION_RAND:
+			return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_RANDOM);
+		case EVAL_FUNCTION_KURTOSIS:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_kurtosis, output, error);
+		case EVAL_FUNCTION_MAD:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_mad, output, error);
+		case EVAL_FUNCTION_SKEWNESS:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_skewness, output, error);
+		case EVAL_FUNCTION_STDDEVPOP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevpop, output, error);
+		case EVAL_FUNCTION_STDDEVSAMP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevsamp, output, error);
+		case EVAL_FUNCTION_SUMOFSQUARES:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_sumofsquares, output, error);
+		case EVAL_FUNCTION_VARPOP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varpop, output, error);
+		case EVAL_FUNCTION_VARSAMP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varsamp, output, error);
+		case EVAL_FUNCTION_COUNT:
+			return eval_execute_function_count(ctx, token, output, error);
+		case EVAL_FUNCTION_HISTOGRAM_QUANTILE:
+			return eval_execute_function_histogram_quantile(ctx, token, output, error);
 	}
 
 	if (NULL != ctx->common_func_cb)
@@ -2944,6 +3142,26 @@ static int	eval_execute_common_function(const zbx_eval_context_t *ctx, const zbx
 	return FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates common function                                         *
+ *                                                                            *
+ * Parameters: ctx    - [IN] evaluation context                               *
+ *             token  - [IN] function token                                   *
+ *             output - [IN/OUT] output value stack                           *
+ *             error  - [OUT] error message in case of failure                *
+ *                                                                            *
+ * Return value: SUCCEED - function was executed successfully                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_execute_common_function(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
+		zbx_vector_var_t *output, char **error)
+{
+	return eval_execute_resolved_function(ctx, token, eval_resolve_common_function(ctx, token), output,
+			error);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluates history function                                        *
@@ -2998,6 +3216,62 @@ static void	eval_throw_exception(zbx_vector_var_t *output, char **error)
 	zbx_variant_set_none(arg);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes token                                                    *
+ *                                                                            *
+ * Parameters: ctx    - [IN] evaluation context                               *
+ *             token  - [IN] token to execute                                 *
+ *             output - [IN/OUT] output value stack                           *
+ *             error  - [OUT] error message in case of failure                *
+ *                                                                            *
+ * Return value: SUCCEED - token was executed successfully                    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_execute_token(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
+		zbx_vector_var_t *output, char **error)
+{
+	if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
+		return eval_execute_op_unary(ctx, token, output, error);
+
+	if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR2))
+		return eval_execute_op_binary(ctx, token, output, error);
+
+	switch (token->type)
+	{
+		case ZBX_EVAL_TOKEN_NOP:
+			return SUCCEED;
+		case ZBX_EVAL_TOKEN_VAR_NUM:
+		case ZBX_EVAL_TOKEN_VAR_STR:
+		case ZBX_EVAL_TOKEN_VAR_MACRO:
+		case ZBX_EVAL_TOKEN_VAR_USERMACRO:
+		case ZBX_EVAL_TOKEN_ARG_QUERY:
+		case ZBX_EVAL_TOKEN_ARG_PERIOD:
+			return eval_execute_push_value(ctx, token, output, error);
+		case ZBX_EVAL_TOKEN_ARG_NULL:
+			eval_execute_push_null(output);
+			return SUCCEED;
+		case ZBX_EVAL_TOKEN_FUNCTION:
+			return eval_execute_common_function(ctx, token, output, error);
+		case ZBX_EVAL_TOKEN_HIST_FUNCTION:
+			return eval_execute_history_function(ctx, token, output, error);
+		case ZBX_EVAL_TOKEN_FUNCTIONID:
+			if (ZBX_VARIANT_NONE == token->value.type)
+			{
+				*error = zbx_strdup(*error, "trigger history functions must be pre-calculated");
+				return FAIL;
+			}
+			return eval_execute_push_value(ctx, token, output, error);
+		case ZBX_EVAL_TOKEN_EXCEPTION:
+			eval_throw_exception(output, error);
+			return FAIL;
+		default:
+			*error = zbx_dsprintf(*error, "unknown token at \"%s\"", ctx->expression + token->loc.l);
+			return FAIL;
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluates pre-parsed expression                                   *
@@ -3009,6 +3283,9 @@ static void	eval_throw_exception(zbx_vector_var_t *output, char **error)
  * Return value: SUCCEED - expression was evaluated successfully              *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: Compiled instructions are executed if the expression was         *
+ *           compiled, otherwise the token stack is interpreted.              *
+ *                                                                            *
  ******************************************************************************/
 static int	eval_execute(const zbx_eval_context_t *ctx, zbx_variant_t *value, char **error)
 {
@@ -3018,69 +3295,47 @@ static int	eval_execute(const zbx_eval_context_t *ctx, zbx_variant_t *value, cha
 
 	zbx_vector_var_create(&output);
 
-	for (i = 0; i < ctx->stack.values_num; i++)
+	if (NULL != ctx->code)
 	{
-		zbx_eval_token_t	*token = &ctx->stack.values[i];
+		zbx_vector_var_reserve(&output, (size_t)ctx->code_num);
 
-		if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
-		{
-			if (SUCCEED != eval_execute_op_unary(ctx, token, &output, &errmsg))
-				goto out;
-		}
-		else if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR2))
-		{
-			if (SUCCEED != eval_execute_op_binary(ctx, token, &output, &errmsg))
-				goto out;
-		}
-		else
+		for (i = 0; i < ctx->code_num; i++)
 		{
-			switch (token->type)
+			const zbx_eval_instr_t	*instr = &ctx->code[i];
+			zbx_variant_t		constant;
+
+			switch (instr->op)
 			{
-				case ZBX_EVAL_TOKEN_NOP:
-					break;
-				case ZBX_EVAL_TOKEN_VAR_NUM:
-				case ZBX_EVAL_TOKEN_VAR_STR:
-				case ZBX_EVAL_TOKEN_VAR_MACRO:
-				case ZBX_EVAL_TOKEN_VAR_USERMACRO:
-					if (SUCCEED != eval_execute_push_value(ctx, token, &output, &errmsg))
-						goto out;
-					break;
-				case ZBX_EVAL_TOKEN_ARG_QUERY:
-				case ZBX_EVAL_TOKEN_ARG_PERIOD:
-					if (SUCCEED != eval_execute_push_value(ctx, token, &output, &errmsg))
-						goto out;
-					break;
-				case ZBX_EVAL_TOKEN_ARG_NULL:
-					eval_execute_push_null(&output);
-					break;
-				case ZBX_EVAL_TOKEN_FUNCTION:
-					if (SUCCEED != eval_execute_common_function(ctx, token, &output, &errmsg))
-						goto out;
+				case ZBX_EVAL_INSTR_CONST:
+					/* compiled constants are numeric, no need for deep copy */
+					constant = instr->value;
+					zbx_vector_var_append_ptr(&output, &constant);
 					break;
-				case ZBX_EVAL_TOKEN_HIST_FUNCTION:
-					if (SUCCEED != eval_execute_history_function(ctx, token, &output, &errmsg))
+				case ZBX_EVAL_INSTR_FUNCTION:
+					if (SUCCEED != eval_execute_resolved_function(ctx, &ctx->stack.values[instr->index],
+							instr->func, &output, &errmsg))
+					{
 						goto out;
+					}
 					break;
-				case ZBX_EVAL_TOKEN_FUNCTIONID:
-					if (ZBX_VARIANT_NONE == token->value.type)
+				default:
+					if (SUCCEED != eval_execute_token(ctx, &ctx->stack.values[instr->index], &output,
+							&errmsg))
 					{
-						errmsg = zbx_strdup(errmsg, "trigger history functions must be"
-								" pre-calculated");
 						goto out;
 					}
-					if (SUCCEED != eval_execute_push_value(ctx, token, &output, &errmsg))
-						goto out;
 					break;
-				case ZBX_EVAL_TOKEN_EXCEPTION:
-					eval_throw_exception(&output, &errmsg);
-					goto out;
-				default:
-					errmsg = zbx_dsprintf(errmsg, "unknown token at \"%s\"",
-							ctx->expression + token->loc.l);
-					goto out;
 			}
 		}
 	}
+	else
+	{
+		for (i = 0; i < ctx->stack.values_num; i++)
+		{
+			if (SUCCEED != eval_execute_token(ctx, &ctx->stack.values[i], &output, &errmsg))
+				goto out;
+		}
+	}
 
 	if (1 != output.values_num)
 	{
@@ -3118,6 +3373,246 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if common function result depends only on its arguments   *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_is_pure_function(zbx_uint32_t func)
+{
+	switch (func)
+	{
+		case EVAL_FUNCTION_DATE:
+		case EVAL_FUNCTION_TIME:
+		case EVAL_FUNCTION_NOW:
+		case EVAL_FUNCTION_DAYOFWEEK:
+		case EVAL_FUNCTION_DAYOFMONTH:
+		case EVAL_FUNCTION_RAND:
+		case EVAL_FUNCTION_UNKNOWN:
+			return FAIL;
+		default:
+			return SUCCEED;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates operator or function with constant arguments during     *
+ *          compilation                                                       *
+ *                                                                            *
+ * Parameters: ctx      - [IN] evaluation context                             *
+ *             token    - [IN] operator or function token                     *
+ *             func     - [IN] resolved function identifier                   *
+ *             args     - [IN] constant argument instructions                 *
+ *             args_num - [IN] number of arguments                            *
+ *             value    - [OUT] folded value                                  *
+ *                                                                            *
+ * Return value: SUCCEED - token was folded into numeric constant             *
+ *               FAIL    - otherwise, the token must be evaluated at runtime  *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_compile_fold(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token, zbx_uint32_t func,
+		const zbx_eval_instr_t *args, int args_num, zbx_variant_t *value)
+{
+	zbx_vector_var_t	output;
+	char			*error = NULL;
+	int			i, ret;
+
+	zbx_vector_var_create(&output);
+
+	for (i = 0; i < args_num; i++)
+	{
+		zbx_variant_t	arg = args[i].value;
+
+		zbx_vector_var_append_ptr(&output, &arg);
+	}
+
+	if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
+		ret = eval_execute_op_unary(ctx, token, &output, &error);
+	else if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR2))
+		ret = eval_execute_op_binary(ctx, token, &output, &error);
+	else
+		ret = eval_execute_resolved_function(ctx, token, func, &output, &error);
+
+	if (SUCCEED == ret && 1 == output.values_num &&
+			(ZBX_VARIANT_UI64 == output.values[0].type || ZBX_VARIANT_DBL == output.values[0].type))
+	{
+		*value = output.values[0];
+		output.values_num = 0;
+	}
+	else
+		ret = FAIL;
+
+	zbx_free(error);
+
+	for (i = 0; i < output.values_num; i++)
+		zbx_variant_clear(&output.values[i]);
+
+	zbx_vector_var_destroy(&output);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compiles token stack into instructions                            *
+ *                                                                            *
+ * Parameters: ctx  - [IN] evaluation context                                 *
+ *             code - [OUT] compiled instructions                             *
+ *                                                                            *
+ * Return value: number of compiled instructions                              *
+ *                                                                            *
+ * Comments: Numeric constants are parsed, common functions are resolved by   *
+ *           name and operators or pure functions having only constant        *
+ *           arguments are folded into constants. Tokens that can be changed  *
+ *           after compilation (macros, strings, functionids, ...) are        *
+ *           executed as tokens.                                              *
+ *                                                                            *
+ ******************************************************************************/
+int	eval_compile(const zbx_eval_context_t *ctx, zbx_eval_instr_t **code)
+{
+	int	i, code_num = 0, *slots, slots_num = 0;
+
+	if (0 == ctx->stack.values_num)
+	{
+		*code = NULL;
+		return 0;
+	}
+
+	*code = (zbx_eval_instr_t *)zbx_malloc(NULL, sizeof(zbx_eval_instr_t) * (size_t)ctx->stack.values_num);
+
+	/* constant flags of the values on output stack during execution */
+	slots = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)ctx->stack.values_num);
+
+	for (i = 0; i < ctx->stack.values_num; i++)
+	{
+		const zbx_eval_token_t	*token = &ctx->stack.values[i];
+		zbx_eval_instr_t	*instr;
+		zbx_uint32_t		func = EVAL_FUNCTION_UNKNOWN;
+		int			j, args_num, fold = FAIL;
+		zbx_variant_t		value;
+
+		if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
+		{
+			args_num = 1;
+			fold = SUCCEED;
+		}
+		else if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR2))
+		{
+			args_num = 2;
+			fold = SUCCEED;
+		}
+		else if (ZBX_EVAL_TOKEN_FUNCTION == token->type)
+		{
+			args_num = (int)token->opt;
+			func = eval_resolve_common_function(ctx, token);
+			fold = eval_is_pure_function(func);
+		}
+		else if (0 != (token->type & ZBX_EVAL_CLASS_FUNCTION))
+			args_num = (int)token->opt;
+		else if (ZBX_EVAL_TOKEN_NOP == token->type)
+			continue;
+		else
+			args_num = 0;
+
+		/* malformed stack will fail during execution, no need to fold it */
+		if (args_num > slots_num)
+		{
+			args_num = slots_num;
+			fold = FAIL;
+		}
+
+		if (SUCCEED == fold)
+		{
+			/* constant arguments are always the last compiled instructions */
+			for (j = slots_num - args_num; j < slots_num; j++)
+			{
+				if (SUCCEED != slots[j])
+				{
+					fold = FAIL;
+					break;
+				}
+			}
+		}
+
+		if (SUCCEED == fold && SUCCEED == eval_compile_fold(ctx, token, func, *code + code_num - args_num,
+				args_num, &value))
+		{
+			code_num -= args_num;
+
+			for (j = code_num; j < code_num + args_num; j++)
+				zbx_variant_clear(&(*code)[j].value);
+
+			instr = &(*code)[code_num++];
+			instr->op = ZBX_EVAL_INSTR_CONST;
+			instr->value = value;
+		}
+		else
+		{
+			instr = &(*code)[code_num++];
+			zbx_variant_set_none(&instr->value);
+
+			if (ZBX_EVAL_TOKEN_VAR_NUM == token->type && ZBX_VARIANT_NONE == token->value.type &&
+					NULL == memchr(ctx->expression + token->loc.l, '{',
+					token->loc.r - token->loc.l + 1))
+			{
+				instr->op = ZBX_EVAL_INSTR_CONST;
+				eval_parse_number(ctx, token, &instr->value);
+			}
+			else if (ZBX_EVAL_TOKEN_FUNCTION == token->type)
+				instr->op = ZBX_EVAL_INSTR_FUNCTION;
+			else
+				instr->op = ZBX_EVAL_INSTR_TOKEN;
+		}
+
+		instr->index = (zbx_uint32_t)i;
+		instr->func = func;
+
+		slots_num -= args_num;
+		slots[slots_num++] = (ZBX_EVAL_INSTR_CONST == instr->op ? SUCCEED : FAIL);
+	}
+
+	zbx_free(slots);
+
+	return code_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees compiled instructions                                       *
+ *                                                                            *
+ * Parameters: code     - [IN] compiled instructions                          *
+ *             code_num - [IN] number of instructions                         *
+ *                                                                            *
+ ******************************************************************************/
+void	eval_free_code(zbx_eval_instr_t *code, int code_num)
+{
+	int	i;
+
+	for (i = 0; i < code_num; i++)
+		zbx_variant_clear(&code[i].value);
+
+	zbx_free(code);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compiles parsed expression for faster execution                   *
+ *                                                                            *
+ * Parameters: ctx - [IN/OUT] evaluation context                              *
+ *                                                                            *
+ * Comments: The compiled instructions reference evaluation context tokens,   *
+ *           so the token stack must not be restructured afterwards. Token    *
+ *           values can still be replaced as compilation uses only tokens     *
+ *           without values.                                                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_eval_compile(zbx_eval_context_t *ctx)
+{
+	eval_free_code(ctx->code, ctx->code_num);
+	ctx->code_num = eval_compile(ctx, &ctx->code);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: initializes execution context                                     *
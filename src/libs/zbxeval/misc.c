@@ -153,6 +153,9 @@ static zbx_uint32_t	deserialize_variant(const unsigned char *ptr,  zbx_variant_t
  *           serialized, making it impossible to reconstruct the expression   *
  *           text with replaced tokens. Context serialization/deserialization *
  *           must be used for context caching.                                *
+ *           The expression is compiled and the compiled instructions are     *
+ *           serialized after tokens, so deserialized contexts can be         *
+ *           executed without parsing constants and resolving functions.      *
  *                                                                            *
  * Return value: size of serialized data                                      *
  *                                                                            *
@@ -160,10 +163,12 @@ static zbx_uint32_t	deserialize_variant(const unsigned char *ptr,  zbx_variant_t
 size_t	zbx_eval_serialize(const zbx_eval_context_t *ctx, zbx_mem_malloc_func_t malloc_func,
 		unsigned char **data)
 {
-	int		i;
-	unsigned char	buffer_static[ZBX_EVAL_STATIC_BUFFER_SIZE], *buffer = buffer_static, *ptr = buffer, len_buff[6];
-	size_t		buffer_size = ZBX_EVAL_STATIC_BUFFER_SIZE;
-	zbx_uint32_t	len, len_offset;
+	int			i, code_num = 0;
+	unsigned char		buffer_static[ZBX_EVAL_STATIC_BUFFER_SIZE], *buffer = buffer_static, *ptr = buffer,
+				len_buff[6];
+	size_t			buffer_size = ZBX_EVAL_STATIC_BUFFER_SIZE;
+	zbx_uint32_t		len, len_offset;
+	zbx_eval_instr_t	*code = NULL;
 
 	if (NULL == malloc_func)
 		malloc_func = ZBX_DEFAULT_MEM_MALLOC_FUNC;
@@ -186,6 +191,28 @@ size_t	zbx_eval_serialize(const zbx_eval_context_t *ctx, zbx_mem_malloc_func_t m
 		serialize_variant(&buffer, &buffer_size, &token->value, &ptr);
 	}
 
+	if (NULL != ctx->expression)
+		code_num = eval_compile(ctx, &code);
+
+	reserve_buffer(&buffer, &buffer_size, 6, &ptr);
+	ptr += zbx_serialize_uint31_compact(ptr, code_num);
+
+	for (i = 0; i < code_num; i++)
+	{
+		const zbx_eval_instr_t	*instr = &code[i];
+
+		/* reserve space for 3 compact uint31 values */
+		reserve_buffer(&buffer, &buffer_size, 18, &ptr);
+
+		ptr += zbx_serialize_uint31_compact(ptr, instr->op);
+		ptr += zbx_serialize_uint31_compact(ptr, instr->index);
+		ptr += zbx_serialize_uint31_compact(ptr, instr->func);
+
+		serialize_variant(&buffer, &buffer_size, &instr->value, &ptr);
+	}
+
+	eval_free_code(code, code_num);
+
 	len = ptr - buffer;
 
 	len_offset = zbx_serialize_uint31_compact(len_buff, len);
@@ -214,13 +241,15 @@ size_t	zbx_eval_serialize(const zbx_eval_context_t *ctx, zbx_mem_malloc_func_t m
 void	zbx_eval_deserialize(zbx_eval_context_t *ctx, const char *expression, zbx_uint64_t rules,
 		const unsigned char *data)
 {
-	zbx_uint32_t	i, tokens_num, len, pos;
+	zbx_uint32_t		i, tokens_num, len, pos, code_num;
+	const unsigned char	*end;
 
 	memset(ctx, 0, sizeof(zbx_eval_context_t));
 	ctx->expression = expression;
 	ctx->rules = rules;
 
 	data += zbx_deserialize_uint31_compact(data, &len);
+	end = data + len;
 	data += zbx_deserialize_uint31_compact(data, &tokens_num);
 	zbx_vector_eval_token_create(&ctx->stack);
 	zbx_vector_eval_token_reserve(&ctx->stack, tokens_num);
@@ -240,6 +269,37 @@ void	zbx_eval_deserialize(zbx_eval_context_t *ctx, const char *expression, zbx_u
 
 		data += deserialize_variant(data, &token->value);
 	}
+
+	if (data >= end)
+		return;
+
+	data += zbx_deserialize_uint31_compact(data, &code_num);
+
+	if (0 == code_num)
+		return;
+
+	ctx->code = (zbx_eval_instr_t *)zbx_malloc(NULL, sizeof(zbx_eval_instr_t) * code_num);
+	ctx->code_num = (int)code_num;
+
+	for (i = 0; i < code_num; i++)
+	{
+		zbx_eval_instr_t	*instr = &ctx->code[i];
+
+		data += zbx_deserialize_uint31_compact(data, &instr->op);
+		data += zbx_deserialize_uint31_compact(data, &instr->index);
+		data += zbx_deserialize_uint31_compact(data, &instr->func);
+		data += deserialize_variant(data, &instr->value);
+
+		if (instr->index >= tokens_num)
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			ctx->code_num = (int)i + 1;
+			eval_free_code(ctx->code, ctx->code_num);
+			ctx->code = NULL;
+			ctx->code_num = 0;
+			return;
+		}
+	}
 }
 
 static int	compare_tokens_by_loc(const void *d1, const void *d2)
@@ -1038,6 +1098,21 @@ void	zbx_eval_copy(zbx_eval_context_t *dst, const zbx_eval_context_t *src, const
 		if (ZBX_VARIANT_NONE != src->stack.values[i].value.type)
 			zbx_variant_copy(&dst->stack.values[i].value, &src->stack.values[i].value);
 	}
+
+	if (0 != src->code_num)
+	{
+		dst->code = (zbx_eval_instr_t *)zbx_malloc(NULL, sizeof(zbx_eval_instr_t) * (size_t)src->code_num);
+
+		for (i = 0; i < src->code_num; i++)
+		{
+			dst->code[i] = src->code[i];
+			zbx_variant_copy(&dst->code[i].value, &src->code[i].value);
+		}
+	}
+	else
+		dst->code = NULL;
+
+	dst->code_num = src->code_num;
 }
 
 /******************************************************************************
@@ -1191,6 +1191,10 @@ static void	eval_clear(zbx_eval_context_t *ctx)
 
 		zbx_vector_eval_token_destroy(&ctx->stack);
 	}
+
+	eval_free_code(ctx->code, ctx->code_num);
+	ctx->code = NULL;
+	ctx->code_num = 0;
 }
 
 /******************************************************************************
@@ -1217,6 +1221,8 @@ static int	eval_parse_expression(zbx_eval_context_t *ctx, const char *expression
 	ctx->last_token_type = ZBX_EVAL_CLASS_SEPARATOR;
 	ctx->const_index = 0;
 	ctx->functionid_index = 0;
+	ctx->code = NULL;
+	ctx->code_num = 0;
 	zbx_vector_eval_token_create(&ctx->stack);
 	zbx_vector_eval_token_reserve(&ctx->stack, 16);
 	zbx_vector_eval_token_create(&ctx->ops);
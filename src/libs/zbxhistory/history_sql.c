@@ -197,6 +197,7 @@ static void	add_history_dbl(const zbx_vector_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history", "itemid", "clock", "ns", "value", NULL);
+	zbx_db_insert_use_copy(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -216,6 +217,7 @@ static void	add_history_uint(const zbx_vector_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history_uint", "itemid", "clock", "ns", "value", NULL);
+	zbx_db_insert_use_copy(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -235,6 +237,7 @@ static void	add_history_str(const zbx_vector_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history_str", "itemid", "clock", "ns", "value", NULL);
+	zbx_db_insert_use_copy(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -254,6 +257,7 @@ static void	add_history_text(const zbx_vector_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history_text", "itemid", "clock", "ns", "value", NULL);
+	zbx_db_insert_use_copy(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -274,6 +278,7 @@ static void	add_history_log(const zbx_vector_ptr_t *history)
 
 	zbx_db_insert_prepare(db_insert, "history_log", "itemid", "clock", "ns", "timestamp", "source", "severity",
 			"value", "logeventid", NULL);
+	zbx_db_insert_use_copy(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -297,6 +302,7 @@ static void	add_history_bin(const zbx_vector_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history_bin", "itemid", "clock", "ns", "value", NULL);
+	zbx_db_insert_use_copy(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -435,6 +435,7 @@ static const char	*zbx_request_string(int result)
 	}
 }
 
+/* the posted data is copied, because the request can be performed after the caller has freed it */
 static int	http_prepare_request(CURL *easyhandle, const char *posts, unsigned char request_method, char **error)
 {
 	CURLcode	err;
@@ -442,7 +443,7 @@ static int	http_prepare_request(CURL *easyhandle, const char *posts, unsigned ch
 	switch (request_method)
 	{
 		case HTTP_REQUEST_POST:
-			if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POSTFIELDS, posts)))
+			if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_COPYPOSTFIELDS, posts)))
 			{
 				*error = zbx_dsprintf(*error, "Cannot specify data to POST: %s", curl_easy_strerror(err));
 				return FAIL;
@@ -452,7 +453,7 @@ static int	http_prepare_request(CURL *easyhandle, const char *posts, unsigned ch
 			if ('\0' == *posts)
 				return SUCCEED;
 
-			if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POSTFIELDS, posts)))
+			if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_COPYPOSTFIELDS, posts)))
 			{
 				*error = zbx_dsprintf(*error, "Cannot specify data to POST: %s", curl_easy_strerror(err));
 				return FAIL;
@@ -473,7 +474,7 @@ static int	http_prepare_request(CURL *easyhandle, const char *posts, unsigned ch
 			}
 			break;
 		case HTTP_REQUEST_PUT:
-			if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POSTFIELDS, posts)))
+			if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_COPYPOSTFIELDS, posts)))
 			{
 				*error = zbx_dsprintf(*error, "Cannot specify data to POST: %s", curl_easy_strerror(err));
 				return FAIL;
@@ -566,22 +567,59 @@ static void	http_output_json(unsigned char retrieve_mode, char **buffer, zbx_htt
 	zbx_json_free(&json);
 }
 
-int	zbx_http_request(unsigned char request_method, const char *url, const char *query_fields, char *headers,
-		const char *posts, unsigned char retrieve_mode, const char *http_proxy, unsigned char follow_redirects,
-		const char *timeout, int max_attempts, const char *ssl_cert_file, const char *ssl_key_file,
-		const char *ssl_key_password, unsigned char verify_peer, unsigned char verify_host,
-		unsigned char authtype, const char *username, const char *password, const char *token,
-		unsigned char post_type, char *status_codes, unsigned char output_format, const char *config_source_ip,
-		char **out, char **error)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initialize HTTP request context                                   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_http_context_create(zbx_http_context_t *context)
+{
+	memset(context, 0, sizeof(zbx_http_context_t));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free resources allocated by HTTP request context                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_http_context_destroy(zbx_http_context_t *context)
+{
+	curl_slist_free_all(context->headers_slist);	/* must be called after curl_easy_perform() */
+	curl_easy_cleanup(context->easyhandle);
+	zbx_free(context->body.data);
+	zbx_free(context->header.data);
+	zbx_free(context->status_codes);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create and configure cURL easy handle for HTTP request            *
+ *                                                                            *
+ * Parameters: context - [OUT] the request context, must not be moved until   *
+ *                             the request is finished                        *
+ *             ...     - [IN] the request parameters, see zbx_http_request()  *
+ *             error   - [OUT] the error message                              *
+ *                                                                            *
+ * Return value: SUCCEED - the request can be performed with                  *
+ *                         context->easyhandle                                *
+ *               NOTSUPPORTED - failed to configure the request               *
+ *                                                                            *
+ * Comments: All request parameters are copied, so they can be freed once     *
+ *           this function returns.                                           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_http_request_prepare(zbx_http_context_t *context, unsigned char request_method, const char *url,
+		const char *query_fields, char *headers, const char *posts, unsigned char retrieve_mode,
+		const char *http_proxy, unsigned char follow_redirects, const char *timeout, const char *ssl_cert_file,
+		const char *ssl_key_file, const char *ssl_key_password, unsigned char verify_peer,
+		unsigned char verify_host, unsigned char authtype, const char *username, const char *password,
+		const char *token, unsigned char post_type, const char *status_codes, unsigned char output_format,
+		const char *config_source_ip, char **error)
 {
 	CURL			*easyhandle;
 	CURLcode		err;
-	char			url_buffer[ZBX_ITEM_URL_LEN_MAX], errbuf[CURL_ERROR_SIZE], *headers_ptr, *line, *buffer;
+	char			url_buffer[ZBX_ITEM_URL_LEN_MAX], *headers_ptr, *line;
 	int			ret = NOTSUPPORTED, timeout_seconds, found = FAIL;
-	long			response_code;
-	struct curl_slist	*headers_slist = NULL;
-	struct zbx_json		json;
-	zbx_http_response_t	body = {0}, header = {0};
 	zbx_curl_cb_t		curl_body_cb;
 	char			application_json[] = {"Content-Type: application/json"};
 	char			application_ndjson[] = {"Content-Type: application/x-ndjson"};
@@ -592,12 +630,16 @@ int	zbx_http_request(unsigned char request_method, const char *url, const char *
 
 	zabbix_log(LOG_LEVEL_TRACE, "message body '%s'", posts);
 
-	if (NULL == (easyhandle = curl_easy_init()))
+	if (NULL == (easyhandle = context->easyhandle = curl_easy_init()))
 	{
-		*error = zbx_strdup(NULL, "Cannot initialize cURL library");;
+		*error = zbx_strdup(NULL, "Cannot initialize cURL library");
 		goto clean;
 	}
 
+	context->retrieve_mode = retrieve_mode;
+	context->output_format = output_format;
+	context->status_codes = zbx_strdup(NULL, status_codes);
+
 	switch (retrieve_mode)
 	{
 		case ZBX_RETRIEVE_MODE_CONTENT:
@@ -613,8 +655,8 @@ int	zbx_http_request(unsigned char request_method, const char *url, const char *
 			goto clean;
 	}
 
-	if (SUCCEED != zbx_http_prepare_callbacks(easyhandle, &header, &body, zbx_curl_write_cb, curl_body_cb, errbuf,
-			error))
+	if (SUCCEED != zbx_http_prepare_callbacks(easyhandle, &context->header, &context->body, zbx_curl_write_cb,
+			curl_body_cb, context->errbuf, error))
 	{
 		goto clean;
 	}
@@ -668,7 +710,7 @@ int	zbx_http_request(unsigned char request_method, const char *url, const char *
 	headers_ptr = headers;
 	while (NULL != (line = zbx_http_parse_header(&headers_ptr)))
 	{
-		headers_slist = curl_slist_append(headers_slist, line);
+		context->headers_slist = curl_slist_append(context->headers_slist, line);
 
 		if (FAIL == found && 0 == strncmp(line, "Content-Type:", ZBX_CONST_STRLEN("Content-Type:")))
 			found = SUCCEED;
@@ -679,14 +721,14 @@ int	zbx_http_request(unsigned char request_method, const char *url, const char *
 	if (FAIL == found)
 	{
 		if (ZBX_POSTTYPE_JSON == post_type)
-			headers_slist = curl_slist_append(headers_slist, application_json);
+			context->headers_slist = curl_slist_append(context->headers_slist, application_json);
 		else if (ZBX_POSTTYPE_XML == post_type)
-			headers_slist = curl_slist_append(headers_slist, application_xml);
+			context->headers_slist = curl_slist_append(context->headers_slist, application_xml);
 		else if (ZBX_POSTTYPE_NDJSON == post_type)
-			headers_slist = curl_slist_append(headers_slist, application_ndjson);
+			context->headers_slist = curl_slist_append(context->headers_slist, application_ndjson);
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_HTTPHEADER, headers_slist)))
+	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_HTTPHEADER, context->headers_slist)))
 	{
 		*error = zbx_dsprintf(NULL, "Cannot specify headers: %s", curl_easy_strerror(err));
 		goto clean;
@@ -725,28 +767,35 @@ int	zbx_http_request(unsigned char request_method, const char *url, const char *
 		goto clean;
 	}
 
-	/* try to retrieve page several times depending on number of retries */
-	do
-	{
-		*errbuf = '\0';
+	ret = SUCCEED;
+clean:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
-		if (CURLE_OK == (err = curl_easy_perform(easyhandle)))
-		{
-			break;
-		}
-		else
-		{
-			if (1 != max_attempts)
-			{
-				zabbix_log(LOG_LEVEL_INFORMATION, "cannot perform request: %s",
-						'\0' == *errbuf ? curl_easy_strerror(err) : errbuf);
-			}
-		}
+	return ret;
+}
 
-		header.offset = 0;
-		body.offset = 0;
-	}
-	while (0 < --max_attempts);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process the result of performed HTTP request                      *
+ *                                                                            *
+ * Parameters: context - [IN] the request context                             *
+ *             err     - [IN] the request result code                         *
+ *             out     - [OUT] the formatted response                         *
+ *             error   - [OUT] the error message                              *
+ *                                                                            *
+ * Return value: SUCCEED - the response was received and matches the          *
+ *                         required status codes                              *
+ *               NOTSUPPORTED - the request has failed                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_http_handle_response(zbx_http_context_t *context, CURLcode err, char **out, char **error)
+{
+	char		*headers_ptr, *line, *buffer;
+	int		ret = NOTSUPPORTED;
+	long		response_code;
+	struct zbx_json	json;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	if (CURLE_OK != err)
 	{
@@ -757,60 +806,60 @@ int	zbx_http_request(unsigned char request_method, const char *url, const char *
 		else
 		{
 			*error = zbx_dsprintf(NULL, "Cannot perform request: %s",
-					'\0' == *errbuf ? curl_easy_strerror(err) : errbuf);
+					'\0' == *context->errbuf ? curl_easy_strerror(err) : context->errbuf);
 		}
 		goto clean;
 	}
 
-	if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_RESPONSE_CODE, &response_code)))
+	if (CURLE_OK != (err = curl_easy_getinfo(context->easyhandle, CURLINFO_RESPONSE_CODE, &response_code)))
 	{
 		*error = zbx_dsprintf(NULL, "Cannot get the response code: %s", curl_easy_strerror(err));
 		goto clean;
 	}
 
-	if (NULL == header.data)
+	if (NULL == context->header.data)
 	{
 		*error = zbx_dsprintf(NULL, "Server returned empty header");
 		goto clean;
 	}
 
-	switch (retrieve_mode)
+	switch (context->retrieve_mode)
 	{
 		case ZBX_RETRIEVE_MODE_CONTENT:
-			if (NULL != body.data && FAIL == zbx_is_utf8(body.data))
+			if (NULL != context->body.data && FAIL == zbx_is_utf8(context->body.data))
 			{
 				*error = zbx_dsprintf(NULL, "Server returned invalid UTF-8 sequence");
 				goto clean;
 			}
 
-			if (HTTP_STORE_JSON == output_format)
+			if (HTTP_STORE_JSON == context->output_format)
 			{
-				http_output_json(retrieve_mode, &buffer, &header, &body);
+				http_output_json(context->retrieve_mode, &buffer, &context->header, &context->body);
 				*out = buffer;
 			}
 			else
 			{
-				if (NULL != body.data)
+				if (NULL != context->body.data)
 				{
-					*out = body.data;
-					body.data = NULL;
+					*out = context->body.data;
+					context->body.data = NULL;
 				}
 				else
 					*out = zbx_strdup(NULL, "");
 			}
 			break;
 		case ZBX_RETRIEVE_MODE_HEADERS:
-			if (FAIL == zbx_is_utf8(header.data))
+			if (FAIL == zbx_is_utf8(context->header.data))
 			{
 				*error = zbx_dsprintf(NULL, "Server returned invalid UTF-8 sequence");
 				goto clean;
 			}
 
-			if (HTTP_STORE_JSON == output_format)
+			if (HTTP_STORE_JSON == context->output_format)
 			{
 				zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
 				zbx_json_addobject(&json, "header");
-				headers_ptr = header.data;
+				headers_ptr = context->header.data;
 				while (NULL != (line = zbx_http_parse_header(&headers_ptr)))
 				{
 					http_add_json_header(&json, line);
@@ -821,52 +870,101 @@ int	zbx_http_request(unsigned char request_method, const char *url, const char *
 			}
 			else
 			{
-				*out = header.data;
-				header.data = NULL;
+				*out = context->header.data;
+				context->header.data = NULL;
 			}
 			break;
 		case ZBX_RETRIEVE_MODE_BOTH:
-			if (FAIL == zbx_is_utf8(header.data) || (NULL != body.data && FAIL == zbx_is_utf8(body.data)))
+			if (FAIL == zbx_is_utf8(context->header.data) ||
+					(NULL != context->body.data && FAIL == zbx_is_utf8(context->body.data)))
 			{
 				*error = zbx_dsprintf(NULL, "Server returned invalid UTF-8 sequence");
 				goto clean;
 			}
 
-			if (HTTP_STORE_JSON == output_format)
+			if (HTTP_STORE_JSON == context->output_format)
 			{
-				http_output_json(retrieve_mode, &buffer, &header, &body);
+				http_output_json(context->retrieve_mode, &buffer, &context->header, &context->body);
 				*out = buffer;
 			}
 			else
 			{
-				if (NULL != body.data)
+				if (NULL != context->body.data)
 				{
-					zbx_strncpy_alloc(&header.data, &header.allocated, &header.offset, body.data,
-							body.offset);
+					zbx_strncpy_alloc(&context->header.data, &context->header.allocated,
+							&context->header.offset, context->body.data, context->body.offset);
 				}
 
-				*out = header.data;
-				header.data = NULL;
+				*out = context->header.data;
+				context->header.data = NULL;
 			}
 			break;
 	}
 
-	if ('\0' != *status_codes && FAIL == zbx_int_in_list(status_codes, (int)response_code))
+	if ('\0' != *context->status_codes && FAIL == zbx_int_in_list(context->status_codes, (int)response_code))
 	{
 		*error = zbx_dsprintf(NULL, "Response code \"%ld\" did not match any of the"
-				" required status codes \"%s\"", response_code, status_codes);
+				" required status codes \"%s\"", response_code, context->status_codes);
 		goto clean;
 	}
 
 	ret = SUCCEED;
 clean:
-	curl_slist_free_all(headers_slist);	/* must be called after curl_easy_perform() */
-	curl_easy_cleanup(easyhandle);
-	zbx_free(body.data);
-	zbx_free(header.data);
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
 }
 
+int	zbx_http_request(unsigned char request_method, const char *url, const char *query_fields, char *headers,
+		const char *posts, unsigned char retrieve_mode, const char *http_proxy, unsigned char follow_redirects,
+		const char *timeout, int max_attempts, const char *ssl_cert_file, const char *ssl_key_file,
+		const char *ssl_key_password, unsigned char verify_peer, unsigned char verify_host,
+		unsigned char authtype, const char *username, const char *password, const char *token,
+		unsigned char post_type, char *status_codes, unsigned char output_format, const char *config_source_ip,
+		char **out, char **error)
+{
+	zbx_http_context_t	context;
+	CURLcode		err;
+	int			ret;
+
+	zbx_http_context_create(&context);
+
+	if (SUCCEED != (ret = zbx_http_request_prepare(&context, request_method, url, query_fields, headers, posts,
+			retrieve_mode, http_proxy, follow_redirects, timeout, ssl_cert_file, ssl_key_file,
+			ssl_key_password, verify_peer, verify_host, authtype, username, password, token, post_type,
+			status_codes, output_format, config_source_ip, error)))
+	{
+		goto clean;
+	}
+
+	/* try to retrieve page several times depending on number of retries */
+	do
+	{
+		*context.errbuf = '\0';
+
+		if (CURLE_OK == (err = curl_easy_perform(context.easyhandle)))
+		{
+			break;
+		}
+		else
+		{
+			if (1 != max_attempts)
+			{
+				zabbix_log(LOG_LEVEL_INFORMATION, "cannot perform request: %s",
+						'\0' == *context.errbuf ? curl_easy_strerror(err) : context.errbuf);
+			}
+		}
+
+		context.header.offset = 0;
+		context.body.offset = 0;
+	}
+	while (0 < --max_attempts);
+
+	ret = zbx_http_handle_response(&context, err, out, error);
+clean:
+	zbx_http_context_destroy(&context);
+
+	return ret;
+}
+
 #endif
@@ -0,0 +1,681 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "icmpnative.h"
+
+#include "zbxcomms.h"
+#include "zbxtime.h"
+#include "zbxstr.h"
+#include "zbxip.h"
+
+#define ICMP_HEADER_SIZE	8
+#define ICMP_IP_HEADER_MAX	60
+
+#define ICMPV4_ECHO_REPLY	0
+#define ICMPV4_ECHO_REQUEST	8
+#define ICMPV6_ECHO_REQUEST	128
+#define ICMPV6_ECHO_REPLY	129
+
+/* defaults of the corresponding fping options, to keep item semantics unchanged */
+#define ICMP_DEFAULT_SIZE		56	/* -b, bytes */
+#define ICMP_DEFAULT_PERIOD		1000	/* -p, milliseconds */
+#define ICMP_DEFAULT_TIMEOUT_MAX	2000	/* -t defaults to -p, but not more than this, milliseconds */
+
+/* gap between any two packets sent, in seconds */
+#define ICMP_PACKET_INTERVAL	0.00005
+/* delay before retrying a send when the socket buffer is full, in seconds */
+#define ICMP_SEND_RETRY_DELAY	0.001
+
+#define ICMP_SOCKET_BUFFER_SIZE	(4 * ZBX_MEBIBYTE)
+
+#define ICMP_SOCKET_IPV4	0
+#ifdef HAVE_IPV6
+#	define ICMP_SOCKET_IPV6	1
+#	define ICMP_SOCKETS_NUM	2
+#else
+#	define ICMP_SOCKETS_NUM	1
+#endif
+
+/* echo data prefix identifying the request, the target returns it back in the reply */
+typedef struct
+{
+	zbx_uint32_t	cookie;
+	zbx_uint32_t	target;
+	zbx_uint32_t	request;
+	double		sent;
+}
+icmp_stamp_t;
+
+typedef struct
+{
+	int	fd;
+	int	family;
+}
+icmp_socket_t;
+
+typedef struct
+{
+	ZBX_FPING_HOST		*host;
+	icmp_socket_t		*sock;
+	struct sockaddr_storage	addr;
+	socklen_t		addrlen;
+	double			next_send;
+}
+icmp_target_t;
+
+typedef struct
+{
+	icmp_socket_t	sockets[ICMP_SOCKETS_NUM];
+	icmp_target_t	*targets;
+	int		targets_num;
+	int		requests_count;
+	double		period;
+	double		timeout;
+	unsigned char	allow_redirect;
+	zbx_uint32_t	cookie;
+	unsigned char	*packet;
+	size_t		packet_size;
+	unsigned char	*buf;
+	size_t		buf_size;
+	zbx_uint64_t	sent;
+	zbx_uint64_t	received;
+}
+icmp_ping_t;
+
+static ZBX_THREAD_LOCAL zbx_uint32_t	icmp_cookie;
+
+static unsigned short	icmp_checksum(const unsigned char *data, size_t len)
+{
+	zbx_uint32_t	sum = 0;
+	unsigned short	word;
+
+	for (; 1 < len; data += 2, len -= 2)
+	{
+		memcpy(&word, data, sizeof(word));
+		sum += word;
+	}
+
+	if (0 != len)
+	{
+		word = 0;
+		memcpy(&word, data, 1);
+		sum += word;
+	}
+
+	sum = (sum >> 16) + (sum & 0xffff);
+	sum += (sum >> 16);
+
+	return (unsigned short)~sum;
+}
+
+static int	icmp_socket_index(int family)
+{
+#ifdef HAVE_IPV6
+	if (AF_INET6 == family)
+		return ICMP_SOCKET_IPV6;
+#else
+	ZBX_UNUSED(family);
+#endif
+	return ICMP_SOCKET_IPV4;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: open non-blocking ICMP socket of the specified address family     *
+ *                                                                            *
+ * Parameters: sock          - [OUT] the socket                               *
+ *             family        - [IN] the address family                        *
+ *             source        - [IN] the source address to bind to (optional)  *
+ *             error         - [OUT] the error message                        *
+ *             max_error_len - [IN] the size of error buffer                  *
+ *                                                                            *
+ * Return value: SUCCEED - the socket was opened                              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: unprivileged ICMP datagram sockets are preferred, raw sockets    *
+ *           are used when the process group is not allowed to open them      *
+ *           (net.ipv4.ping_group_range on Linux) but the process has the     *
+ *           CAP_NET_RAW capability                                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmp_socket_open(icmp_socket_t *sock, int family, const struct addrinfo *source, char *error,
+		size_t max_error_len)
+{
+	int	protocol = IPPROTO_ICMP, flags, size = ICMP_SOCKET_BUFFER_SIZE;
+
+#ifdef HAVE_IPV6
+	if (AF_INET6 == family)
+		protocol = IPPROTO_ICMPV6;
+#endif
+	if (-1 == (sock->fd = socket(family, SOCK_DGRAM, protocol)) &&
+			-1 == (sock->fd = socket(family, SOCK_RAW, protocol)))
+	{
+		zbx_snprintf(error, max_error_len, "cannot open ICMP%s socket: %s", AF_INET == family ? "" : "v6",
+				zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (NULL != source && -1 == bind(sock->fd, source->ai_addr, source->ai_addrlen))
+	{
+		zbx_snprintf(error, max_error_len, "cannot bind ICMP socket to source address: %s",
+				zbx_strerror(errno));
+		goto fail;
+	}
+
+	if (-1 == (flags = fcntl(sock->fd, F_GETFL, 0)) || -1 == fcntl(sock->fd, F_SETFL, flags | O_NONBLOCK))
+	{
+		zbx_snprintf(error, max_error_len, "cannot set ICMP socket to non-blocking mode: %s",
+				zbx_strerror(errno));
+		goto fail;
+	}
+
+	/* replies of large batches arrive in bursts, the kernel caps the size by net.core.rmem_max */
+	if (-1 == setsockopt(sock->fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot set ICMP socket receive buffer size: %s",
+				zbx_strerror(errno));
+	}
+
+	sock->family = family;
+
+	return SUCCEED;
+fail:
+	close(sock->fd);
+	sock->fd = -1;
+
+	return FAIL;
+}
+
+static int	icmp_addr_resolve(const char *addr, int family, struct sockaddr_storage *ss, socklen_t *ss_len)
+{
+	struct addrinfo	hints, *ai = NULL;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = family;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_flags = AI_NUMERICHOST;
+
+	if (0 != getaddrinfo(addr, NULL, &hints, &ai))
+	{
+		hints.ai_flags = 0;
+
+		if (0 != getaddrinfo(addr, NULL, &hints, &ai))
+			return FAIL;
+	}
+
+	memcpy(ss, ai->ai_addr, ai->ai_addrlen);
+	*ss_len = ai->ai_addrlen;
+
+	freeaddrinfo(ai);
+
+	return SUCCEED;
+}
+
+static int	icmp_addr_compare(const struct sockaddr_storage *ss1, const struct sockaddr_storage *ss2)
+{
+	if (ss1->ss_family != ss2->ss_family)
+		return FAIL;
+
+	if (AF_INET == ss1->ss_family)
+	{
+		if (((const struct sockaddr_in *)ss1)->sin_addr.s_addr !=
+				((const struct sockaddr_in *)ss2)->sin_addr.s_addr)
+		{
+			return FAIL;
+		}
+
+		return SUCCEED;
+	}
+#ifdef HAVE_IPV6
+	if (AF_INET6 == ss1->ss_family)
+	{
+		if (0 != memcmp(&((const struct sockaddr_in6 *)ss1)->sin6_addr,
+				&((const struct sockaddr_in6 *)ss2)->sin6_addr, sizeof(struct in6_addr)))
+		{
+			return FAIL;
+		}
+
+		return SUCCEED;
+	}
+#endif
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send echo request to the target                                   *
+ *                                                                            *
+ * Parameters: ping    - [IN/OUT] the ping batch                              *
+ *             index   - [IN] the target index                                *
+ *             request - [IN] the request index                               *
+ *             now     - [IN] the current time                                *
+ *                                                                            *
+ * Return value: SUCCEED - the request was sent or cannot be sent at all and  *
+ *                         is treated as lost                                 *
+ *               FAIL    - the socket buffer is full, retry later             *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmp_send(icmp_ping_t *ping, int index, int request, double now)
+{
+	icmp_target_t	*target = &ping->targets[index];
+	icmp_stamp_t	stamp;
+	unsigned short	checksum;
+
+	memset(ping->packet, 0, ICMP_HEADER_SIZE);
+	ping->packet[0] = (AF_INET == target->sock->family ? ICMPV4_ECHO_REQUEST : ICMPV6_ECHO_REQUEST);
+
+	/* identifier is replaced by the kernel for datagram sockets, replies are matched by the stamp */
+	ping->packet[4] = (unsigned char)(ping->cookie >> 8);
+	ping->packet[5] = (unsigned char)ping->cookie;
+	ping->packet[6] = (unsigned char)(request >> 8);
+	ping->packet[7] = (unsigned char)request;
+
+	memset(&stamp, 0, sizeof(stamp));
+	stamp.cookie = ping->cookie;
+	stamp.target = (zbx_uint32_t)index;
+	stamp.request = (zbx_uint32_t)request;
+	stamp.sent = now;
+	memcpy(ping->packet + ICMP_HEADER_SIZE, &stamp, sizeof(stamp));
+
+	/* ICMPv6 checksum covers the pseudo header and is always calculated by the kernel */
+	if (AF_INET == target->sock->family)
+	{
+		checksum = icmp_checksum(ping->packet, ping->packet_size);
+		memcpy(ping->packet + 2, &checksum, sizeof(checksum));
+	}
+
+	if (-1 == sendto(target->sock->fd, ping->packet, ping->packet_size, 0, (struct sockaddr *)&target->addr,
+			target->addrlen))
+	{
+		if (EAGAIN == errno || EWOULDBLOCK == errno || ENOBUFS == errno || EINTR == errno)
+			return FAIL;
+
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot send ICMP echo request to \"%s\": %s", target->host->addr,
+				zbx_strerror(errno));
+	}
+
+	ping->sent++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: match echo reply to the request and update target statistics      *
+ *                                                                            *
+ * Parameters: ping   - [IN/OUT] the ping batch                               *
+ *             family - [IN] the address family of receiving socket           *
+ *             data   - [IN] the received packet                              *
+ *             len    - [IN] the received packet length                       *
+ *             from   - [IN] the reply source address                         *
+ *             now    - [IN] the reply receiving time                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	icmp_reply_process(icmp_ping_t *ping, int family, const unsigned char *data, size_t len,
+		const struct sockaddr_storage *from, double now)
+{
+	icmp_stamp_t	stamp;
+	icmp_target_t	*target;
+	ZBX_FPING_HOST	*host;
+	double		sec;
+
+	/* raw IPv4 sockets (and datagram sockets on some systems) return IP header as well */
+	if (AF_INET == family && 0 != len && 4 == (data[0] >> 4))
+	{
+		size_t	ip_header_len = (size_t)(data[0] & 0x0f) * 4;
+
+		if (ip_header_len > len)
+			return;
+
+		data += ip_header_len;
+		len -= ip_header_len;
+	}
+
+	if (ICMP_HEADER_SIZE + sizeof(stamp) > len)
+		return;
+
+	if ((AF_INET == family ? ICMPV4_ECHO_REPLY : ICMPV6_ECHO_REPLY) != data[0] || 0 != data[1])
+		return;
+
+	memcpy(&stamp, data + ICMP_HEADER_SIZE, sizeof(stamp));
+
+	/* raw sockets receive replies to other processes as well */
+	if (stamp.cookie != ping->cookie || stamp.target >= (zbx_uint32_t)ping->targets_num ||
+			stamp.request >= (zbx_uint32_t)ping->requests_count)
+	{
+		return;
+	}
+
+	target = &ping->targets[stamp.target];
+	host = target->host;
+
+	if (target->sock->family != family || 0 != host->status[stamp.request])
+		return;
+
+	sec = now - stamp.sent;
+
+	if (0 > sec || ping->timeout < sec)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring late response from \"%s\" for request %u", host->addr,
+				stamp.request);
+		return;
+	}
+
+	if (SUCCEED != icmp_addr_compare(&target->addr, from) && 0 == ping->allow_redirect)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "treating redirected response as target host \"%s\" down", host->addr);
+		return;
+	}
+
+	host->status[stamp.request] = 1;
+
+	if (0 == host->rcv || host->min > sec)
+		host->min = sec;
+	if (0 == host->rcv || host->max < sec)
+		host->max = sec;
+	host->sum += sec;
+	host->rcv++;
+
+	ping->received++;
+}
+
+static void	icmp_recv(icmp_ping_t *ping, const icmp_socket_t *sock)
+{
+	struct sockaddr_storage	from;
+	socklen_t		from_len;
+	ssize_t			n;
+
+	for (;;)
+	{
+		from_len = sizeof(from);
+
+		if (-1 == (n = recvfrom(sock->fd, ping->buf, ping->buf_size, 0, (struct sockaddr *)&from, &from_len)))
+		{
+			if (EINTR == errno)
+				continue;
+
+			if (EAGAIN != errno && EWOULDBLOCK != errno)
+				zabbix_log(LOG_LEVEL_DEBUG, "cannot receive ICMP packet: %s", zbx_strerror(errno));
+
+			break;
+		}
+
+		icmp_reply_process(ping, sock->family, ping->buf, (size_t)n, &from, zbx_time());
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send all requests of the batch and collect replies                *
+ *                                                                            *
+ * Comments: requests are sent round by round, each round sending one request *
+ *           to every target. Consecutive requests to the same target are at  *
+ *           least the period apart, while any two packets are paced by a     *
+ *           short fixed interval, so replies of a large batch are spread.    *
+ *           The batch completes when all replies are received or the timeout *
+ *           of the last request expires.                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	icmp_ping_run(icmp_ping_t *ping)
+{
+	zbx_pollfd_t	pollfds[ICMP_SOCKETS_NUM];
+	icmp_socket_t	*pollsocks[ICMP_SOCKETS_NUM];
+	int		pollfds_num = 0, round = 0, index = 0, wait_ms;
+	double		now, send_at, deadline = 0, wakeup;
+
+	for (int i = 0; i < ICMP_SOCKETS_NUM; i++)
+	{
+		if (-1 == ping->sockets[i].fd)
+			continue;
+
+		pollfds[pollfds_num].fd = ping->sockets[i].fd;
+		pollfds[pollfds_num].events = POLLIN;
+		pollsocks[pollfds_num++] = &ping->sockets[i];
+	}
+
+	send_at = zbx_time();
+
+	for (;;)
+	{
+		now = zbx_time();
+
+		while (round < ping->requests_count)
+		{
+			icmp_target_t	*target = &ping->targets[index];
+			double		due = MAX(send_at, target->next_send);
+
+			if (due > now)
+				break;
+
+			if (SUCCEED != icmp_send(ping, index, round, now))
+			{
+				send_at = now + ICMP_SEND_RETRY_DELAY;
+				break;
+			}
+
+			target->next_send = now + ping->period;
+			send_at = due + ICMP_PACKET_INTERVAL;
+			deadline = now + ping->timeout;
+
+			if (++index == ping->targets_num)
+			{
+				index = 0;
+				round++;
+			}
+		}
+
+		if (round == ping->requests_count)
+		{
+			if (now >= deadline || ping->sent == ping->received)
+				break;
+
+			wakeup = deadline;
+		}
+		else
+			wakeup = MAX(send_at, ping->targets[index].next_send);
+
+		if (0 > (wait_ms = (int)ceil((wakeup - now) * 1000)))
+			wait_ms = 0;
+
+		if (0 >= zbx_socket_poll(pollfds, (unsigned long)pollfds_num, wait_ms))
+			continue;
+
+		for (int i = 0; i < pollfds_num; i++)
+		{
+			if (0 != (pollfds[i].revents & POLLIN))
+				icmp_recv(ping, pollsocks[i]);
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: ping hosts using ICMP sockets                                     *
+ *                                                                            *
+ * Parameters: hosts          - [IN/OUT] the target hosts                     *
+ *             hosts_count    - [IN] the number of target hosts               *
+ *             requests_count - [IN] the number of pings to send to a target  *
+ *             period         - [IN] the interval between pings to one target *
+ *                                   in milliseconds, 0 - default             *
+ *             size           - [IN] the ping data size, 0 - default          *
+ *             timeout        - [IN] the ping timeout in milliseconds,        *
+ *                                   0 - default                              *
+ *             allow_redirect - [IN] treat redirected response as host up     *
+ *             rdns           - [IN] resolve host DNS names                   *
+ *             source_ip      - [IN] the source address (optional)            *
+ *             error          - [OUT] the error message                       *
+ *             max_error_len  - [IN] the size of error buffer                 *
+ *                                                                            *
+ * Return value: SUCCEED - the hosts were pinged                              *
+ *               FAIL    - ICMP sockets cannot be used, hosts are unchanged   *
+ *                                                                            *
+ * Comments: the host statistics are the same as parsed from fping -C output, *
+ *           hosts that cannot be resolved are left with zero request count   *
+ *           and the host error set                                           *
+ *                                                                            *
+ ******************************************************************************/
+int	icmp_native_ping(ZBX_FPING_HOST *hosts, int hosts_count, int requests_count, int period, int size,
+		int timeout, unsigned char allow_redirect, int rdns, const char *source_ip, char *error,
+		size_t max_error_len)
+{
+	icmp_ping_t	ping;
+	struct addrinfo	hints, *source = NULL;
+	int		i, family, ret = FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts_count:%d requests_count:%d period:%d size:%d timeout:%d",
+			__func__, hosts_count, requests_count, period, size, timeout);
+
+	memset(&ping, 0, sizeof(ping));
+
+	for (i = 0; i < ICMP_SOCKETS_NUM; i++)
+		ping.sockets[i].fd = -1;
+
+#ifdef HAVE_IPV6
+	family = AF_UNSPEC;
+#else
+	family = AF_INET;
+#endif
+	if (NULL != source_ip)
+	{
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = family;
+		hints.ai_socktype = SOCK_DGRAM;
+		hints.ai_flags = AI_NUMERICHOST;
+
+		if (0 != getaddrinfo(source_ip, NULL, &hints, &source))
+		{
+			zbx_snprintf(error, max_error_len, "invalid source IP address \"%s\"", source_ip);
+			goto out;
+		}
+
+		family = source->ai_family;
+	}
+
+	if (0 == period)
+		period = ICMP_DEFAULT_PERIOD;
+
+	if (0 == timeout)
+		timeout = MIN(period, ICMP_DEFAULT_TIMEOUT_MAX);
+
+	if (0 == size)
+		size = ICMP_DEFAULT_SIZE;
+
+	ping.requests_count = requests_count;
+	ping.period = period / 1000.0;
+	ping.timeout = timeout / 1000.0;
+	ping.allow_redirect = allow_redirect;
+
+	if (0 == icmp_cookie)
+	{
+		zbx_timespec_t	ts;
+
+		zbx_timespec(&ts);
+		icmp_cookie = (zbx_uint32_t)ts.sec ^ (zbx_uint32_t)ts.ns ^ (zbx_uint32_t)getpid();
+	}
+
+	ping.cookie = ++icmp_cookie;
+	ping.packet_size = ICMP_HEADER_SIZE + MAX((size_t)size, sizeof(icmp_stamp_t));
+	ping.packet = (unsigned char *)zbx_malloc(NULL, ping.packet_size);
+	memset(ping.packet, 0, ping.packet_size);
+	ping.buf_size = ping.packet_size + ICMP_IP_HEADER_MAX;
+	ping.buf = (unsigned char *)zbx_malloc(NULL, ping.buf_size);
+	ping.targets = (icmp_target_t *)zbx_malloc(NULL, sizeof(icmp_target_t) * (size_t)MAX(hosts_count, 1));
+
+	for (i = 0; i < hosts_count; i++)
+	{
+		hosts[i].status = (char *)zbx_malloc(NULL, (size_t)requests_count);
+		memset(hosts[i].status, 0, (size_t)requests_count);
+	}
+
+	for (i = 0; i < hosts_count; i++)
+	{
+		icmp_target_t	*target = &ping.targets[ping.targets_num];
+		icmp_socket_t	*sock;
+
+		if (SUCCEED != icmp_addr_resolve(hosts[i].addr, family, &target->addr, &target->addrlen))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot resolve ICMP ping target \"%s\"", hosts[i].addr);
+			hosts[i].error = zbx_dsprintf(hosts[i].error, "Cannot resolve host address \"%s\".",
+					hosts[i].addr);
+			continue;
+		}
+
+		sock = &ping.sockets[icmp_socket_index(target->addr.ss_family)];
+
+		if (-1 == sock->fd && SUCCEED != icmp_socket_open(sock, target->addr.ss_family, source, error,
+				max_error_len))
+		{
+			goto out;
+		}
+
+		target->host = &hosts[i];
+		target->sock = sock;
+		target->next_send = 0;
+		ping.targets_num++;
+	}
+
+	/* nothing to ping when none of the hosts were resolved */
+	if (0 != ping.targets_num)
+		icmp_ping_run(&ping);
+
+	for (i = 0; i < ping.targets_num; i++)
+	{
+		ZBX_FPING_HOST	*host = ping.targets[i].host;
+
+		host->cnt += requests_count;
+
+		if (0 != rdns)
+		{
+			char	dnsname[ZBX_MAX_DNSNAME_LEN + 1];
+
+			zbx_gethost_by_ip(host->addr, dnsname, sizeof(dnsname));
+			host->dnsname = zbx_strdup(host->dnsname, dnsname);
+		}
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() sent:" ZBX_FS_UI64 " received:" ZBX_FS_UI64, __func__, ping.sent,
+			ping.received);
+
+	ret = SUCCEED;
+out:
+	for (i = 0; i < ICMP_SOCKETS_NUM; i++)
+	{
+		if (-1 != ping.sockets[i].fd)
+			close(ping.sockets[i].fd);
+	}
+
+	for (i = 0; i < hosts_count; i++)
+	{
+		zbx_free(hosts[i].status);
+
+		if (SUCCEED != ret)
+			zbx_free(hosts[i].error);
+	}
+
+	zbx_free(ping.targets);
+	zbx_free(ping.buf);
+	zbx_free(ping.packet);
+
+	if (NULL != source)
+		freeaddrinfo(source);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
@@ -0,0 +1,29 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_ICMPNATIVE_H
+#define ZABBIX_ICMPNATIVE_H
+
+#include "zbxicmpping.h"
+
+int	icmp_native_ping(ZBX_FPING_HOST *hosts, int hosts_count, int requests_count, int period, int size,
+		int timeout, unsigned char allow_redirect, int rdns, const char *source_ip, char *error,
+		size_t max_error_len);
+
+#endif
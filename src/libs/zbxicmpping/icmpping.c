@@ -18,6 +18,7 @@
 **/
 
 #include "zbxicmpping.h"
+#include "icmpnative.h"
 
 #include <signal.h>
 
@@ -49,6 +50,7 @@ static ZBX_THREAD_LOCAL int		fping_ipv6_supported;
 #endif
 
 static ZBX_THREAD_LOCAL time_t		fping_check_reset_at;	/* time of the last fping options expiration */
+static ZBX_THREAD_LOCAL unsigned char	icmp_native_failed;	/* ICMP sockets failure was already logged */
 static ZBX_THREAD_LOCAL char		tmpfile_uniq[255] = {'\0'};
 
 typedef struct
@@ -1152,7 +1154,9 @@ void	zbx_init_icmpping_env(const char *prefix, long int id)
  * Return value: SUCCEED - successfully processed hosts                       *
  *               NOTSUPPORTED - otherwise                                     *
  *                                                                            *
- * Comments: use external binary 'fping' to avoid superuser privileges        *
+ * Comments: hosts are pinged directly using ICMP sockets, the external       *
+ *           binary 'fping' is used when neither unprivileged ICMP nor raw    *
+ *           sockets can be opened by the process                             *
  *                                                                            *
  ******************************************************************************/
 int	zbx_ping(ZBX_FPING_HOST *hosts, int hosts_count, int requests_count, int period, int size, int timeout,
@@ -1162,12 +1166,27 @@ int	zbx_ping(ZBX_FPING_HOST *hosts, int hosts_count, int requests_count, int per
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts_count:%d", __func__, hosts_count);
 
+	if (SUCCEED == (ret = icmp_native_ping(hosts, hosts_count, requests_count, period, size, timeout,
+			allow_redirect, rdns, config_icmpping->get_source_ip(), error, max_error_len)))
+	{
+		icmp_native_failed = 0;
+		goto out;
+	}
+
+	if (0 == icmp_native_failed)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "%s, falling back to fping", error);
+		icmp_native_failed = 1;
+	}
+	else
+		zabbix_log(LOG_LEVEL_DEBUG, "%s, falling back to fping", error);
+
 	if (NOTSUPPORTED == (ret = hosts_ping(hosts, hosts_count, requests_count, period, size, timeout,
 			allow_redirect, rdns, error, max_error_len)))
 	{
 		zabbix_log(LOG_LEVEL_ERR, "%s", error);
 	}
-
+out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
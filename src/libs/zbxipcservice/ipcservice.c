@@ -49,8 +49,59 @@ struct zbx_ipc_client
 	void			*userdata;
 
 	zbx_uint32_t		refcount;
+
+	/* shared memory ring attached by client, the number of messages received  */
+	/* through socket after attaching ring and the flag set when ring reading  */
+	/* must wait for the next message to be received through socket            */
+	zbx_ipc_ring_t		*ring;
+	zbx_uint64_t		ring_socket_num;
+	unsigned char		ring_blocked;
+};
+
+/* Single producer/single consumer ring in shared memory, used by clients to pass */
+/* messages to service without copying them through socket. The ring contains     */
+/* records followed by message data aligned to 8 bytes. The head and tail are     */
+/* free running offsets, written by producer and consumer respectively.           */
+struct zbx_ipc_ring
+{
+	zbx_uint32_t	magic;
+	zbx_uint32_t	size;
+
+	/* set by consumer before waiting for socket events, reset by producer */
+	/* when sending doorbell message                                        */
+	zbx_uint32_t	waiting;
+
+	unsigned char	pad_head[52];
+	zbx_uint64_t	head;
+
+	/* the number of messages producer has written to socket instead of ring */
+	zbx_uint64_t	socket_num;
+	unsigned char	pad_tail[48];
+	zbx_uint64_t	tail;
+	unsigned char	pad_data[56];
 };
 
+#define ZBX_IPC_RING_MAGIC	0x5a425852
+
+#define ZBX_IPC_RING_DATA(ring)	((unsigned char *)(ring) + sizeof(zbx_ipc_ring_t))
+
+/* Message record in shared memory ring. Messages written to socket and ring */
+/* are ordered by the number of socket messages written before the record.  */
+typedef struct
+{
+	zbx_uint32_t	code;
+	zbx_uint32_t	size;
+	zbx_uint64_t	socket_num;
+}
+zbx_ipc_ring_record_t;
+
+/* internal message codes, never returned to service users */
+#define ZBX_IPC_RING_ATTACH	0xfffffff0
+#define ZBX_IPC_RING_DOORBELL	0xfffffff1
+
+/* ring record code, telling to continue reading from the ring start */
+#define ZBX_IPC_RING_WRAP	0xfffffff2
+
 /*
  * Private API
  */
@@ -85,6 +136,7 @@ static void	event_free(struct event *event)
 
 static void	ipc_client_read_event_cb(evutil_socket_t fd, short what, void *arg);
 static void	ipc_client_write_event_cb(evutil_socket_t fd, short what, void *arg);
+static zbx_ipc_message_t	*ipc_message_create(zbx_uint32_t code, const unsigned char *data, zbx_uint32_t size);
 
 static const char	*ipc_get_path(void)
 {
@@ -477,6 +529,203 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes message to shared memory ring                              *
+ *                                                                            *
+ * Parameters: ring - [IN] the ring                                           *
+ *             code - [IN] the message code                                   *
+ *             data - [IN] the data                                           *
+ *             size - [IN] the data size                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the message was written                            *
+ *               FAIL    - the message is too large or there is not enough    *
+ *                         free space in ring                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_ring_write(zbx_ipc_ring_t *ring, zbx_uint32_t code, const unsigned char *data, zbx_uint32_t size)
+{
+	zbx_uint64_t		head, tail;
+	zbx_uint32_t		pos, contiguous, record_size;
+	zbx_ipc_ring_record_t	*record;
+	unsigned char		*buffer = ZBX_IPC_RING_DATA(ring);
+
+	if (size > ring->size / 2)
+		return FAIL;
+
+	record_size = sizeof(zbx_ipc_ring_record_t) + (zbx_uint32_t)ZBX_SIZE_T_ALIGN8(size);
+
+	/* head is modified only by producer */
+	head = ring->head;
+	tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	pos = (zbx_uint32_t)(head & (ring->size - 1));
+	contiguous = ring->size - pos;
+
+	if (ring->size - (head - tail) < (contiguous < record_size ? contiguous : 0) + record_size)
+		return FAIL;
+
+	/* records are aligned to 8 bytes, so there is always space for the record code */
+	if (contiguous < record_size)
+	{
+		record = (zbx_ipc_ring_record_t *)(buffer + pos);
+		record->code = ZBX_IPC_RING_WRAP;
+		head += contiguous;
+		pos = 0;
+	}
+
+	record = (zbx_ipc_ring_record_t *)(buffer + pos);
+	record->code = code;
+	record->size = size;
+	record->socket_num = ring->socket_num;
+
+	if (0 != size)
+		memcpy(buffer + pos + sizeof(zbx_ipc_ring_record_t), data, size);
+
+	__atomic_store_n(&ring->head, head + record_size, __ATOMIC_SEQ_CST);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads messages from client shared memory ring into received       *
+ *          messages queue                                                    *
+ *                                                                            *
+ * Parameters: client - [IN] the client                                       *
+ *                                                                            *
+ * Comments: Reading stops at the first record written after a message that   *
+ *           was not yet received through socket.                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_client_read_ring(zbx_ipc_client_t *client)
+{
+	zbx_ipc_ring_t		*ring = client->ring;
+	zbx_uint64_t		head, tail;
+	zbx_uint32_t		pos;
+	zbx_ipc_ring_record_t	*record;
+	unsigned char		*buffer = ZBX_IPC_RING_DATA(ring);
+
+	client->ring_blocked = 0;
+
+	/* tail is modified only by consumer */
+	tail = ring->tail;
+	head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+	while (tail != head)
+	{
+		pos = (zbx_uint32_t)(tail & (ring->size - 1));
+		record = (zbx_ipc_ring_record_t *)(buffer + pos);
+
+		if (ZBX_IPC_RING_WRAP == record->code)
+		{
+			tail += ring->size - pos;
+			continue;
+		}
+
+		if (record->socket_num > client->ring_socket_num)
+		{
+			client->ring_blocked = 1;
+			break;
+		}
+
+		if (record->size > ring->size / 2)
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			tail = head;
+			break;
+		}
+
+		zbx_queue_ptr_push(&client->rx_queue, ipc_message_create(record->code,
+				buffer + pos + sizeof(zbx_ipc_ring_record_t), record->size));
+
+		tail += sizeof(zbx_ipc_ring_record_t) + ZBX_SIZE_T_ALIGN8(record->size);
+	}
+
+	__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: attaches shared memory ring created by client                     *
+ *                                                                            *
+ * Parameters: client - [IN] the client                                       *
+ *                                                                            *
+ * Comments: The ring attach request contains shared memory identifier. The   *
+ *           result is sent back to client with the same message code.        *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_client_attach_ring(zbx_ipc_client_t *client)
+{
+	int		shmid, ret = FAIL;
+	zbx_ipc_ring_t	*ring;
+
+	if (NULL != client->ring || sizeof(shmid) != client->rx_header[ZBX_IPC_MESSAGE_SIZE])
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		goto out;
+	}
+
+	memcpy(&shmid, client->rx_data, sizeof(shmid));
+
+	if ((void *)(-1) == (ring = (zbx_ipc_ring_t *)shmat(shmid, NULL, 0)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot attach IPC client ring: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	if (ZBX_IPC_RING_MAGIC != ring->magic)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		shmdt(ring);
+		goto out;
+	}
+
+	client->ring = ring;
+	zbx_vector_ptr_append(&client->service->clients_ring, client);
+	ret = SUCCEED;
+out:
+	zbx_ipc_client_send(client, ZBX_IPC_RING_ATTACH, (const unsigned char *)&ret, sizeof(ret));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes internal ring message received through client socket    *
+ *                                                                            *
+ * Parameters: client - [IN] the client                                       *
+ *                                                                            *
+ * Return value: SUCCEED - the message was processed internally               *
+ *               FAIL    - the message must be added to received messages     *
+ *                         queue                                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_client_process_ring_message(zbx_ipc_client_t *client)
+{
+	switch (client->rx_header[ZBX_IPC_MESSAGE_CODE])
+	{
+		case ZBX_IPC_RING_ATTACH:
+			ipc_client_attach_ring(client);
+			break;
+		case ZBX_IPC_RING_DOORBELL:
+			if (NULL != client->ring)
+				ipc_client_read_ring(client);
+			break;
+		default:
+			if (NULL != client->ring)
+			{
+				/* messages written to ring before this one must be queued first */
+				ipc_client_read_ring(client);
+				client->ring_socket_num++;
+			}
+			return FAIL;
+	}
+
+	zbx_free(client->rx_data);
+	client->rx_bytes = 0;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: frees client's libevent event                                     *
@@ -525,6 +774,9 @@ static void	ipc_client_free(zbx_ipc_client_t *client)
 	zbx_queue_ptr_destroy(&client->tx_queue);
 	zbx_free(client->tx_data);
 
+	if (NULL != client->ring)
+		shmdt(client->ring);
+
 	ipc_client_free_events(client);
 
 	zbx_free(client);
@@ -598,11 +850,19 @@ static int	ipc_client_read(zbx_ipc_client_t *client)
 		{
 			zbx_free(client->rx_data);
 			client->rx_bytes = 0;
+
+			/* queue messages written to ring before the connection was closed */
+			if (NULL != client->ring)
+				ipc_client_read_ring(client);
+
 			return FAIL;
 		}
 
-		if (SUCCEED == (rc = ipc_message_is_completed(client->rx_header, client->rx_bytes)))
+		if (SUCCEED == (rc = ipc_message_is_completed(client->rx_header, client->rx_bytes)) &&
+				SUCCEED != ipc_client_process_ring_message(client))
+		{
 			ipc_client_push_rx_message(client);
+		}
 	}
 
 	while (SUCCEED == rc);
@@ -776,6 +1036,12 @@ static void	ipc_service_remove_client(zbx_ipc_service_t *service, zbx_ipc_client
 		if (service->clients.values[i] == client)
 			zbx_vector_ptr_remove_noorder(&service->clients, i);
 	}
+
+	if (NULL != client->ring && FAIL != (i = zbx_vector_ptr_search(&service->clients_ring, client,
+			ZBX_DEFAULT_PTR_COMPARE_FUNC)))
+	{
+		zbx_vector_ptr_remove_noorder(&service->clients_ring, i);
+	}
 }
 
 /******************************************************************************
@@ -1122,6 +1388,7 @@ int	zbx_ipc_socket_open(zbx_ipc_socket_t *csocket, const char *service_name, int
 
 	csocket->rx_buffer_bytes = 0;
 	csocket->rx_buffer_offset = 0;
+	csocket->ring = NULL;
 
 	ret = SUCCEED;
 out:
@@ -1146,6 +1413,12 @@ void	zbx_ipc_socket_close(zbx_ipc_socket_t *csocket)
 		csocket->fd = -1;
 	}
 
+	if (NULL != csocket->ring)
+	{
+		shmdt(csocket->ring);
+		csocket->ring = NULL;
+	}
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -1169,6 +1442,27 @@ int	zbx_ipc_socket_write(zbx_ipc_socket_t *csocket, zbx_uint32_t code, const uns
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	if (NULL != csocket->ring)
+	{
+		if (SUCCEED == ipc_ring_write(csocket->ring, code, data, size))
+		{
+			ret = SUCCEED;
+
+			/* wake up service if it's waiting for socket events */
+			if (0 != __atomic_exchange_n(&csocket->ring->waiting, 0, __ATOMIC_SEQ_CST) &&
+					(SUCCEED != ipc_socket_write_message(csocket, ZBX_IPC_RING_DOORBELL, NULL, 0,
+					&size_sent) || ZBX_IPC_HEADER_SIZE != size_sent))
+			{
+				ret = FAIL;
+			}
+
+			goto out;
+		}
+
+		/* messages written to ring after this one will wait until it's received */
+		csocket->ring->socket_num++;
+	}
+
 	if (SUCCEED == ipc_socket_write_message(csocket, code, data, size, &size_sent) &&
 			size_sent == size + ZBX_IPC_HEADER_SIZE)
 	{
@@ -1176,7 +1470,7 @@ int	zbx_ipc_socket_write(zbx_ipc_socket_t *csocket, zbx_uint32_t code, const uns
 	}
 	else
 		ret = FAIL;
-
+out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -1250,6 +1544,88 @@ int	zbx_ipc_socket_connected(const zbx_ipc_socket_t *csocket)
 	return 0 < csocket->fd ? SUCCEED : FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates shared memory ring for writing messages to IPC service    *
+ *                                                                            *
+ * Parameters: csocket - [IN] an opened IPC socket to the service             *
+ *             size    - [IN] the ring size, must be power of 2               *
+ *             error   - [OUT] the error message                              *
+ *                                                                            *
+ * Return value: SUCCEED - the ring was attached by service                   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: After ring is attached zbx_ipc_socket_write() writes messages to *
+ *           ring and only falls back to socket for messages not fitting in   *
+ *           it. Messages are received by service in the same order as they   *
+ *           were written. On failure the socket can still be used as usual.  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_socket_open_ring(zbx_ipc_socket_t *csocket, zbx_uint32_t size, char **error)
+{
+	int			shmid, ret = FAIL;
+	zbx_uint32_t		size_sent;
+	zbx_ipc_ring_t		*ring;
+	zbx_ipc_message_t	message;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() size:%u", __func__, size);
+
+	if (NULL != csocket->ring || 0 != (size & (size - 1)) || ZBX_IPC_SOCKET_BUFFER_SIZE > size)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		*error = zbx_strdup(*error, "invalid ring parameters");
+		goto out;
+	}
+
+	if (-1 == (shmid = shmget(IPC_PRIVATE, sizeof(zbx_ipc_ring_t) + size, IPC_CREAT | IPC_EXCL | 0600)))
+	{
+		*error = zbx_dsprintf(*error, "cannot allocate shared memory: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	if ((void *)(-1) == (ring = (zbx_ipc_ring_t *)shmat(shmid, NULL, 0)))
+	{
+		*error = zbx_dsprintf(*error, "cannot attach shared memory: %s", zbx_strerror(errno));
+		shmctl(shmid, IPC_RMID, NULL);
+		goto out;
+	}
+
+	memset(ring, 0, sizeof(zbx_ipc_ring_t));
+	ring->magic = ZBX_IPC_RING_MAGIC;
+	ring->size = size;
+
+	if (SUCCEED != ipc_socket_write_message(csocket, ZBX_IPC_RING_ATTACH, (const unsigned char *)&shmid,
+			sizeof(shmid), &size_sent) || ZBX_IPC_HEADER_SIZE + sizeof(shmid) != size_sent)
+	{
+		*error = zbx_strdup(*error, "cannot send ring attach request");
+	}
+	else if (SUCCEED != zbx_ipc_socket_read(csocket, &message))
+	{
+		*error = zbx_strdup(*error, "cannot read ring attach response");
+	}
+	else
+	{
+		if (ZBX_IPC_RING_ATTACH != message.code || sizeof(ret) != message.size)
+			*error = zbx_strdup(*error, "unexpected ring attach response");
+		else if (SUCCEED != (ret = *(int *)message.data))
+			*error = zbx_strdup(*error, "service cannot attach ring");
+
+		zbx_ipc_message_clean(&message);
+	}
+
+	/* the segment is destroyed after both sides have detached it */
+	shmctl(shmid, IPC_RMID, NULL);
+
+	if (SUCCEED == ret)
+		csocket->ring = ring;
+	else
+		shmdt(ring);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: frees the resources allocated to store IPC message data           *
@@ -1503,6 +1879,7 @@ int	zbx_ipc_service_start(zbx_ipc_service_t *service, const char *service_name,
 	service->path = zbx_strdup(NULL, service_name);
 	zbx_vector_ptr_create(&service->clients);
 	zbx_queue_ptr_create(&service->clients_recv);
+	zbx_vector_ptr_create(&service->clients_ring);
 
 	service->ev = event_base_new();
 	service->ev_listener = event_new(service->ev, service->fd, EV_READ | EV_PERSIST,
@@ -1543,6 +1920,7 @@ void	zbx_ipc_service_close(zbx_ipc_service_t *service)
 
 	zbx_vector_ptr_destroy(&service->clients);
 	zbx_queue_ptr_destroy(&service->clients_recv);
+	zbx_vector_ptr_destroy(&service->clients_ring);
 
 	event_free(service->ev_alert);
 	event_free(service->ev_timer);
@@ -1552,6 +1930,79 @@ void	zbx_ipc_service_close(zbx_ipc_service_t *service)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads messages from shared memory rings of all clients            *
+ *                                                                            *
+ * Parameters: service - [IN] the IPC service                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_service_read_rings(zbx_ipc_service_t *service)
+{
+	for (int i = 0; i < service->clients_ring.values_num; i++)
+	{
+		zbx_ipc_client_t	*client = (zbx_ipc_client_t *)service->clients_ring.values[i];
+
+		ipc_client_read_ring(client);
+		ipc_service_push_client(service, client);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets shared memory ring waiting flags                           *
+ *                                                                            *
+ * Parameters: service - [IN] the IPC service                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_service_reset_rings_wait(zbx_ipc_service_t *service)
+{
+	for (int i = 0; i < service->clients_ring.values_num; i++)
+	{
+		zbx_ipc_client_t	*client = (zbx_ipc_client_t *)service->clients_ring.values[i];
+
+		__atomic_store_n(&client->ring->waiting, 0, __ATOMIC_RELAXED);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares client shared memory rings for waiting on socket events  *
+ *                                                                            *
+ * Parameters: service - [IN] the IPC service                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the service can wait for socket events, producers  *
+ *                         will send doorbell message after writing to ring   *
+ *               FAIL    - new messages were written to rings and queued      *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_service_prepare_rings_wait(zbx_ipc_service_t *service)
+{
+	int	i;
+
+	for (i = 0; i < service->clients_ring.values_num; i++)
+	{
+		zbx_ipc_client_t	*client = (zbx_ipc_client_t *)service->clients_ring.values[i];
+
+		__atomic_store_n(&client->ring->waiting, 1, __ATOMIC_SEQ_CST);
+
+		/* blocked rings will be read after receiving message from socket */
+		if (0 == client->ring_blocked && __atomic_load_n(&client->ring->head, __ATOMIC_SEQ_CST) !=
+				client->ring->tail)
+		{
+			break;
+		}
+	}
+
+	if (i == service->clients_ring.values_num)
+		return SUCCEED;
+
+	ipc_service_reset_rings_wait(service);
+	ipc_service_read_rings(service);
+
+	return FAIL;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: receives ipc message from a connected client                      *
@@ -1585,7 +2036,10 @@ int	zbx_ipc_service_recv(zbx_ipc_service_t *service, const zbx_timespec_t *timeo
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() timeout:%d.%03d", __func__, timeout->sec, timeout->ns / 1000000);
 
-	if ((0 != timeout->sec || 0 != timeout->ns) && SUCCEED == zbx_queue_ptr_empty(&service->clients_recv))
+	ipc_service_read_rings(service);
+
+	if ((0 != timeout->sec || 0 != timeout->ns) && SUCCEED == zbx_queue_ptr_empty(&service->clients_recv) &&
+			SUCCEED == ipc_service_prepare_rings_wait(service))
 	{
 		if (ZBX_IPC_WAIT_FOREVER != timeout->sec)
 		{
@@ -1599,6 +2053,9 @@ int	zbx_ipc_service_recv(zbx_ipc_service_t *service, const zbx_timespec_t *timeo
 
 	event_base_loop(service->ev, flags);
 
+	if (EVLOOP_ONCE == flags)
+		ipc_service_reset_rings_wait(service);
+
 	if (NULL != (*client = ipc_service_pop_client(service)))
 	{
 		if (NULL != (*message = (zbx_ipc_message_t *)zbx_queue_ptr_pop(&(*client)->rx_queue)))
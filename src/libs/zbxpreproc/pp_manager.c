@@ -97,9 +97,10 @@ static void	pp_curl_destroy(void)
 #endif
 }
 
-void	zbx_init_library_preproc(zbx_flush_value_func_t flush_value_cb)
+void	zbx_init_library_preproc(zbx_flush_value_func_t flush_value_cb, zbx_uint64_t config_ring_size)
 {
 	flush_value_func_cb = flush_value_cb;
+	pp_protocol_set_ring_size((zbx_uint32_t)config_ring_size);
 }
 
 /******************************************************************************
@@ -134,7 +135,7 @@ zbx_pp_manager_t	*zbx_pp_manager_create(int workers_num, zbx_pp_notify_cb_t fini
 	manager = (zbx_pp_manager_t *)zbx_malloc(NULL, sizeof(zbx_pp_manager_t));
 	memset(manager, 0, sizeof(zbx_pp_manager_t));
 
-	if (SUCCEED != pp_task_queue_init(&manager->queue, error))
+	if (SUCCEED != pp_task_queue_init(&manager->queue, workers_num, error))
 		goto out;
 
 	manager->timekeeper = zbx_timekeeper_create(workers_num, NULL);
@@ -790,6 +790,21 @@ void	zbx_preprocessor_unpack_top_sequences_result(zbx_vector_pp_sequence_stats_p
 	}
 }
 
+static zbx_uint32_t	preproc_ring_size = 0;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets size of shared memory ring used to send values to            *
+ *          preprocessing manager                                             *
+ *                                                                            *
+ * Parameters: ring_size - [IN] the ring size, 0 - send values through socket *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_protocol_set_ring_size(zbx_uint32_t ring_size)
+{
+	preproc_ring_size = ring_size;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: sends command to preprocessor manager                             *
@@ -806,6 +821,7 @@ static void	preprocessor_send(zbx_uint32_t code, unsigned char *data, zbx_uint32
 {
 	char			*error = NULL;
 	static zbx_ipc_socket_t	socket = {0};
+	static int		ring_checked = 0;
 
 	/* each process has a permanent connection to preprocessing manager */
 	if (0 == socket.fd && FAIL == zbx_ipc_socket_open(&socket, ZBX_IPC_SERVICE_PREPROCESSING, SEC_PER_MIN,
@@ -815,6 +831,19 @@ static void	preprocessor_send(zbx_uint32_t code, unsigned char *data, zbx_uint32
 		exit(EXIT_FAILURE);
 	}
 
+	/* values are passed to preprocessing manager through shared memory ring when configured */
+	if (0 == ring_checked && 0 != preproc_ring_size)
+	{
+		if (SUCCEED != zbx_ipc_socket_open_ring(&socket, preproc_ring_size, &error))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot create preprocessing ring, using socket only: %s",
+					error);
+			zbx_free(error);
+		}
+
+		ring_checked = 1;
+	}
+
 	if (FAIL == zbx_ipc_socket_write(&socket, code, data, size))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot send data to preprocessing service");
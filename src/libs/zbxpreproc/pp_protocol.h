@@ -63,6 +63,8 @@ typedef struct
 }
 zbx_packed_field_t;
 
+void	pp_protocol_set_ring_size(zbx_uint32_t ring_size);
+
 zbx_uint32_t	zbx_preprocessor_unpack_value(zbx_preproc_item_value_t *value, unsigned char *data);
 
 void	zbx_preprocessor_unpack_test_request(zbx_pp_item_preproc_t *preproc, zbx_variant_t *value, zbx_timespec_t *ts,
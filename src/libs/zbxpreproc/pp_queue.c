@@ -26,6 +26,9 @@
 #define PP_TASK_QUEUE_INIT_LOCK		0x01
 #define PP_TASK_QUEUE_INIT_EVENT	0x02
 
+/* maximum number of tasks stolen from other worker deque at once */
+#define PP_TASK_QUEUE_STEAL_MAX		16
+
 ZBX_PTR_VECTOR_IMPL(pp_sequence_stats_ptr, zbx_pp_sequence_stats_t *)
 
 /* task sequence registry by itemid */
@@ -40,14 +43,15 @@ zbx_pp_item_task_sequence_t;
  *                                                                            *
  * Purpose: initialize task queue                                             *
  *                                                                            *
- * Parameters: queue - [IN] task queue                                        *
- *             error - [OUT]                                                  *
+ * Parameters: queue       - [IN] task queue                                  *
+ *             workers_num - [IN] number of workers (task deques)             *
+ *             error       - [OUT]                                            *
  *                                                                            *
  * Return value: SUCCEED - the task queue was initialized successfully        *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error)
+int	pp_task_queue_init(zbx_pp_queue_t *queue, int workers_num, char **error)
 {
 	int	err, ret = FAIL;
 
@@ -55,12 +59,31 @@ int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error)
 	queue->pending_num = 0;
 	queue->finished_num = 0;
 	queue->processing_num = 0;
-	zbx_list_create(&queue->pending);
-	zbx_list_create(&queue->immediate);
 	zbx_list_create(&queue->finished);
 
 	zbx_hashset_create(&queue->sequences, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
+	queue->deques = (zbx_pp_task_deque_t *)zbx_malloc(NULL, sizeof(zbx_pp_task_deque_t) * (size_t)workers_num);
+	queue->deque_next = 0;
+
+	/* deques_num is the number of deques with initialized mutex */
+	for (queue->deques_num = 0; queue->deques_num < workers_num; queue->deques_num++)
+	{
+		zbx_pp_task_deque_t	*deque = &queue->deques[queue->deques_num];
+
+		if (0 != (err = pthread_mutex_init(&deque->lock, NULL)))
+		{
+			*error = zbx_dsprintf(NULL, "cannot initialize task deque mutex: %s", zbx_strerror(err));
+			goto out;
+		}
+
+		zbx_list_create(&deque->tasks);
+		deque->tasks_num = 0;
+		zbx_list_create(&deque->finished);
+		deque->finished_num = 0;
+		deque->popped_num = 0;
+	}
+
 	if (0 != (err = pthread_mutex_init(&queue->lock, NULL)))
 	{
 		*error = zbx_dsprintf(NULL, "cannot initialize task queue mutex: %s", zbx_strerror(err));
@@ -109,11 +132,21 @@ void	pp_task_queue_destroy(zbx_pp_queue_t *queue)
 	if (0 != (queue->init_flags & PP_TASK_QUEUE_INIT_EVENT))
 		pthread_cond_destroy(&queue->event);
 
-	pp_task_queue_clear_tasks(&queue->pending);
-	zbx_list_destroy(&queue->pending);
+	for (int i = 0; i < queue->deques_num; i++)
+	{
+		zbx_pp_task_deque_t	*deque = &queue->deques[i];
+
+		pthread_mutex_destroy(&deque->lock);
+
+		pp_task_queue_clear_tasks(&deque->tasks);
+		zbx_list_destroy(&deque->tasks);
 
-	pp_task_queue_clear_tasks(&queue->immediate);
-	zbx_list_destroy(&queue->immediate);
+		pp_task_queue_clear_tasks(&deque->finished);
+		zbx_list_destroy(&deque->finished);
+	}
+
+	zbx_free(queue->deques);
+	queue->deques_num = 0;
 
 	pp_task_queue_clear_tasks(&queue->finished);
 	zbx_list_destroy(&queue->finished);
@@ -163,6 +196,39 @@ void	pp_task_queue_deregister_worker(zbx_pp_queue_t *queue)
 	queue->workers_num--;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: push task to the next worker deque                                *
+ *                                                                            *
+ * Parameters: queue     - [IN] task queue                                    *
+ *             task      - [IN] task to push                                  *
+ *             immediate - [IN] 1 - task must be processed before the other   *
+ *                                  tasks in deque                            *
+ *                              0 - otherwise                                 *
+ *                                                                            *
+ * Comments: Tasks are distributed between worker deques in round robin       *
+ *           fashion, idle workers will steal them from busy ones.            *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_task_queue_push_deque(zbx_pp_queue_t *queue, zbx_pp_task_t *task, int immediate)
+{
+	zbx_pp_task_deque_t	*deque = &queue->deques[queue->deque_next];
+
+	if (++queue->deque_next == queue->deques_num)
+		queue->deque_next = 0;
+
+	pthread_mutex_lock(&deque->lock);
+
+	if (0 != immediate)
+		zbx_list_prepend(&deque->tasks, task, NULL);
+	else
+		zbx_list_append(&deque->tasks, task, NULL);
+
+	deque->tasks_num++;
+
+	pthread_mutex_unlock(&deque->lock);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add task to an existing sequence or create/append to a new one    *
@@ -226,7 +292,7 @@ void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 			break;
 	}
 
-	zbx_list_append(&queue->immediate, task, NULL);
+	pp_task_queue_push_deque(queue, task, 1);
 }
 
 /******************************************************************************
@@ -253,7 +319,7 @@ void	pp_task_queue_remove_sequence(zbx_pp_queue_t *queue, zbx_uint64_t itemid)
 void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
 	queue->pending_num++;
-	zbx_list_append(&queue->immediate, task, NULL);
+	pp_task_queue_push_deque(queue, task, 1);
 }
 
 /******************************************************************************
@@ -265,93 +331,182 @@ void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
  *                                                                            *
  * Comments: This function is used to push tasks created by new preprocessing *
  *           or testing requests.                                             *
+ *           Sequence tasks are moved to existing task sequences while        *
+ *           pushing, so only independent tasks are placed in worker deques   *
+ *           and the order of sequence tasks does not depend on which worker  *
+ *           pops them.                                                       *
  *                                                                            *
  ******************************************************************************/
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
 	zbx_pp_task_value_t	*d = (zbx_pp_task_value_t *)PP_TASK_DATA(task);
+	int			immediate = (ITEM_TYPE_INTERNAL == d->preproc->type ? 1 : 0);
+
 	queue->pending_num++;
 
-	if (ITEM_TYPE_INTERNAL != d->preproc->type)
+	if (ZBX_PP_TASK_VALUE_SEQ == task->type)
 	{
-		zbx_list_append(&queue->pending, task, NULL);
-		return;
+		/* task is being moved to sequence while still pending, */
+		/* so statistics are not affected                       */
+		if (NULL == (task = pp_task_queue_add_sequence(queue, task)))
+			return;
 	}
 
-	if (ZBX_PP_TASK_VALUE == task->type)
+	pp_task_queue_push_deque(queue, task, immediate);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: steal tasks from other worker deques                              *
+ *                                                                            *
+ * Parameters: queue        - [IN] task queue                                 *
+ *             worker_index - [IN] index of the stealing worker               *
+ *                                                                            *
+ * Return value: The stolen task or NULL if all deques are empty.             *
+ *                                                                            *
+ * Comments: Up to half of the victim deque tasks are stolen, the first is    *
+ *           returned and the rest are moved to the stealing worker deque.    *
+ *           Only one deque lock is held at a time to avoid lock ordering     *
+ *           issues between workers stealing from each other.                 *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_pp_task_t	*pp_task_queue_steal(zbx_pp_queue_t *queue, int worker_index)
+{
+	zbx_pp_task_t	*tasks[PP_TASK_QUEUE_STEAL_MAX];
+	int		tasks_num = 0;
+
+	for (int i = 1; i < queue->deques_num && 0 == tasks_num; i++)
 	{
-		zbx_list_append(&queue->immediate, task, NULL);
-		return;
+		zbx_pp_task_deque_t	*victim = &queue->deques[(worker_index + i) % queue->deques_num];
+		int			steal_num;
+
+		pthread_mutex_lock(&victim->lock);
+
+		if (PP_TASK_QUEUE_STEAL_MAX < (steal_num = (victim->tasks_num + 1) / 2))
+			steal_num = PP_TASK_QUEUE_STEAL_MAX;
+
+		while (tasks_num < steal_num && SUCCEED == zbx_list_pop(&victim->tasks, (void **)&tasks[tasks_num]))
+			tasks_num++;
+
+		victim->tasks_num -= tasks_num;
+
+		pthread_mutex_unlock(&victim->lock);
 	}
 
-	zbx_pp_task_t	*seq_task;
+	if (0 == tasks_num)
+		return NULL;
+
+	if (1 < tasks_num)
+	{
+		zbx_pp_task_deque_t	*deque = &queue->deques[worker_index];
+
+		pthread_mutex_lock(&deque->lock);
+
+		for (int i = 1; i < tasks_num; i++)
+			zbx_list_append(&deque->tasks, tasks[i], NULL);
 
-	if (NULL != (seq_task = pp_task_queue_add_sequence(queue, task)))
-		zbx_list_append(&queue->immediate, seq_task, NULL);
+		deque->tasks_num += tasks_num - 1;
+
+		pthread_mutex_unlock(&deque->lock);
+	}
+
+	return tasks[0];
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: pop task from task queue                                          *
  *                                                                            *
- * Parameters: queue - [IN] task queue                                        *
+ * Parameters: queue        - [IN] task queue                                 *
+ *             worker_index - [IN] index of the popping worker                *
  *                                                                            *
  * Return value: The popped task or NULL if there are no tasks to be          *
  *               processed.                                                   *
  *                                                                            *
  * Comments: This function is used by workers to pop tasks for processing.    *
- *           Sequence tasks will be moved to existing tasks sequences or      *
- *           returned if there are no registered sequences for this item.     *
+ *           It must be called without task queue lock - the task is popped   *
+ *           from worker own deque or stolen from other worker deques.        *
+ *           Queue statistics are updated when finished tasks are flushed.    *
  *                                                                            *
  ******************************************************************************/
-zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue)
+zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue, int worker_index)
 {
-	zbx_pp_task_t	*task = NULL;
+	zbx_pp_task_deque_t	*deque = &queue->deques[worker_index];
+	zbx_pp_task_t		*task = NULL;
 
-	if (SUCCEED == zbx_list_pop(&queue->immediate, (void **)&task))
-	{
-		/* while sequence tasks do not affect statistics, the first task in sequence */
-		/* does, so the statistics can be updated for all tasks                      */
-		queue->pending_num--;
-		queue->processing_num++;
+	pthread_mutex_lock(&deque->lock);
 
-		return (zbx_pp_task_t *)task;
-	}
+	if (SUCCEED == zbx_list_pop(&deque->tasks, (void **)&task))
+		deque->tasks_num--;
+	else
+		task = NULL;
 
-	while (SUCCEED == zbx_list_pop(&queue->pending, (void **)&task))
-	{
-		if (ZBX_PP_TASK_VALUE_SEQ == task->type)
-		{
-			/* task is being moved from pending to immediate queue */
-			/* while still pending, so statistics are not affected */
-			task = pp_task_queue_add_sequence(queue, task);
-		}
+	pthread_mutex_unlock(&deque->lock);
 
-		if (NULL != task)
-		{
-			queue->pending_num--;
-			queue->processing_num++;
+	if (NULL == task && NULL == (task = pp_task_queue_steal(queue, worker_index)))
+		return NULL;
 
-			return task;
-		}
-	}
+	/* while sequence tasks do not affect statistics, the first task in sequence */
+	/* does, so the statistics can be updated for all tasks                      */
+	deque->popped_num++;
 
-	return NULL;
+	return task;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: push finished task into queue                                     *
+ * Purpose: push finished task into worker finished task batch                *
  *                                                                            *
- * Parameters: queue - [IN] task queue                                        *
- *             task  - [IN] task                                              *
+ * Parameters: queue        - [IN] task queue                                 *
+ *             worker_index - [IN] index of the worker                        *
+ *             task         - [IN] task                                       *
+ *                                                                            *
+ * Return value: The number of finished tasks in batch.                       *
+ *                                                                            *
+ * Comments: This function is called by workers without task queue lock.      *
+ *           The batch is handed over to manager by                           *
+ *           pp_task_queue_flush_finished() function.                         *
  *                                                                            *
  ******************************************************************************/
-void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
+int	pp_task_queue_push_finished(zbx_pp_queue_t *queue, int worker_index, zbx_pp_task_t *task)
 {
-	queue->finished_num++;
-	queue->processing_num--;
-	zbx_list_append(&queue->finished, task, NULL);
+	zbx_pp_task_deque_t	*deque = &queue->deques[worker_index];
+
+	zbx_list_append(&deque->finished, task, NULL);
+
+	return ++deque->finished_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: move worker finished task batch into queue                        *
+ *                                                                            *
+ * Parameters: queue        - [IN] task queue                                 *
+ *             worker_index - [IN] index of the worker                        *
+ *                                                                            *
+ * Return value: The number of flushed tasks.                                 *
+ *                                                                            *
+ * Comments: This function must be called within task queue lock.             *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_task_queue_flush_finished(zbx_pp_queue_t *queue, int worker_index)
+{
+	zbx_pp_task_deque_t	*deque = &queue->deques[worker_index];
+	zbx_pp_task_t		*task;
+	int			flushed_num = deque->finished_num;
+
+	queue->pending_num -= deque->popped_num;
+	queue->processing_num += deque->popped_num;
+	deque->popped_num = 0;
+
+	while (SUCCEED == zbx_list_pop(&deque->finished, (void **)&task))
+		zbx_list_append(&queue->finished, task, NULL);
+
+	queue->processing_num -= (zbx_uint64_t)flushed_num;
+	queue->finished_num += (zbx_uint64_t)flushed_num;
+	deque->finished_num = 0;
+
+	return flushed_num;
 }
 
 /******************************************************************************
@@ -402,6 +557,34 @@ int	pp_task_queue_wait(zbx_pp_queue_t *queue, char **error)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get number of tasks queued in worker deques                       *
+ *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *                                                                            *
+ * Return value: The number of queued tasks.                                  *
+ *                                                                            *
+ * Comments: This function must be called within task queue lock, so new      *
+ *           tasks cannot be pushed before the worker starts waiting.         *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_task_queue_get_queued_num(zbx_pp_queue_t *queue)
+{
+	int	tasks_num = 0;
+
+	for (int i = 0; i < queue->deques_num; i++)
+	{
+		zbx_pp_task_deque_t	*deque = &queue->deques[i];
+
+		pthread_mutex_lock(&deque->lock);
+		tasks_num += deque->tasks_num;
+		pthread_mutex_unlock(&deque->lock);
+	}
+
+	return tasks_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: notify one worker                                                 *
@@ -23,6 +23,21 @@
 #include "zbxpreproc.h"
 #include "zbxalgo.h"
 
+/* per worker task deque - tasks are pushed round robin by manager and popped */
+/* by the owner, idle workers steal tasks from the other worker deques         */
+typedef struct
+{
+	pthread_mutex_t	lock;
+	zbx_list_t	tasks;
+	int		tasks_num;
+
+	/* the following fields are accessed only by the owner worker */
+	zbx_list_t	finished;
+	int		finished_num;
+	zbx_uint64_t	popped_num;
+}
+zbx_pp_task_deque_t;
+
 typedef struct
 {
 	zbx_uint32_t	init_flags;
@@ -33,16 +48,18 @@ typedef struct
 
 	zbx_hashset_t	sequences;
 
-	zbx_list_t	pending;
-	zbx_list_t	immediate;
 	zbx_list_t	finished;
 
+	zbx_pp_task_deque_t	*deques;
+	int			deques_num;
+	int			deque_next;
+
 	pthread_mutex_t	lock;
 	pthread_cond_t	event;
 }
 zbx_pp_queue_t;
 
-int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error);
+int	pp_task_queue_init(zbx_pp_queue_t *queue, int workers_num, char **error);
 void	pp_task_queue_destroy(zbx_pp_queue_t *queue);
 
 void	pp_task_queue_lock(zbx_pp_queue_t *queue);
@@ -52,15 +69,17 @@ void	pp_task_queue_deregister_worker(zbx_pp_queue_t *queue);
 void	pp_task_queue_remove_sequence(zbx_pp_queue_t *queue, zbx_uint64_t itemid);
 
 int	pp_task_queue_wait(zbx_pp_queue_t *queue, char **error);
+int	pp_task_queue_get_queued_num(zbx_pp_queue_t *queue);
 void	pp_task_queue_notify(zbx_pp_queue_t *queue);
 void	pp_task_queue_notify_all(zbx_pp_queue_t *queue);
 
 void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 
-zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue);
+zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue, int worker_index);
 void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
-void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
+int	pp_task_queue_push_finished(zbx_pp_queue_t *queue, int worker_index, zbx_pp_task_t *task);
+int	pp_task_queue_flush_finished(zbx_pp_queue_t *queue, int worker_index);
 zbx_pp_task_t	*pp_task_queue_pop_finished(zbx_pp_queue_t *queue);
 
 void	pp_task_queue_get_sequence_stats(zbx_pp_queue_t *queue, zbx_vector_pp_sequence_stats_ptr_t *stats);
@@ -31,6 +31,8 @@
 #define PP_WORKER_INIT_NONE	0x00
 #define PP_WORKER_INIT_THREAD	0x01
 
+#define PP_WORKER_FINISHED_BATCH_SIZE	16
+
 /******************************************************************************
  *                                                                            *
  * Purpose: process preprocessing testing task                                *
@@ -110,7 +112,7 @@ static void	*pp_worker_entry(void *args)
 	zbx_pp_task_t		*in;
 	char			*error = NULL, component[MAX_ID_LEN + 1];
 	sigset_t		mask;
-	int			err;
+	int			err, index = worker->id - 1;
 
 	zbx_snprintf(component, sizeof(component), "%d", worker->id);
 	zbx_set_log_component(component, &worker->logger);
@@ -136,14 +138,15 @@ static void	*pp_worker_entry(void *args)
 	pp_context_init(&worker->execute_ctx);
 	pp_task_queue_lock(queue);
 	pp_task_queue_register_worker(queue);
+	pp_task_queue_unlock(queue);
 
-	while (0 == worker->stop)
+	for (;;)
 	{
-		if (NULL != (in = pp_task_queue_pop_new(queue)))
+		if (NULL != (in = pp_task_queue_pop_new(queue, index)))
 		{
-			pp_task_queue_unlock(queue);
+			unsigned char	type = in->type;
 
-			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_BUSY);
+			zbx_timekeeper_update(worker->timekeeper, index, ZBX_PROCESS_STATE_BUSY);
 
 			zabbix_log(LOG_LEVEL_TRACE, "%s() process task type:%u itemid:" ZBX_FS_UI64, __func__,
 					in->type, in->itemid);
@@ -165,26 +168,38 @@ static void	*pp_worker_entry(void *args)
 					break;
 			}
 
-			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_IDLE);
+			zbx_timekeeper_update(worker->timekeeper, index, ZBX_PROCESS_STATE_IDLE);
 
-			pp_task_queue_lock(queue);
-			pp_task_queue_push_finished(queue, in);
+			/* finished tasks are handed over to manager in batches, except sequence tasks */
+			/* blocking the next value of the same item and test tasks with waiting client */
+			if (PP_WORKER_FINISHED_BATCH_SIZE > pp_task_queue_push_finished(queue, index, in) &&
+					ZBX_PP_TASK_SEQUENCE != type && ZBX_PP_TASK_TEST != type)
+			{
+				continue;
+			}
+		}
 
-			if (NULL != worker->finished_cb)
-				worker->finished_cb(worker->finished_data);
+		pp_task_queue_lock(queue);
 
-			continue;
-		}
+		if (0 != pp_task_queue_flush_finished(queue, index) && NULL != worker->finished_cb)
+			worker->finished_cb(worker->finished_data);
+
+		if (0 != worker->stop)
+			break;
 
-		if (SUCCEED != pp_task_queue_wait(queue, &error))
+		if (NULL == in && 0 == pp_task_queue_get_queued_num(queue))
 		{
-			zabbix_log(LOG_LEVEL_WARNING, "[%d] %s", worker->id, error);
-			zbx_free(error);
-			worker->stop = 1;
+			if (SUCCEED != pp_task_queue_wait(queue, &error))
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "[%d] %s", worker->id, error);
+				zbx_free(error);
+				worker->stop = 1;
+			}
+			else if (1 < pp_task_queue_get_queued_num(queue))
+				pp_task_queue_notify(queue);
 		}
 
-		if (1 < queue->pending_num)
-			pp_task_queue_notify(queue);
+		pp_task_queue_unlock(queue);
 	}
 
 	pp_task_queue_deregister_worker(queue);
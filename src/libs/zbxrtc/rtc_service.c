@@ -205,7 +205,7 @@ static void	rtc_process_diaginfo(const char *data, char **result)
 	if (0 == strcmp(buf, "all"))
 	{
 		scope = (1 << ZBX_DIAGINFO_HISTORYCACHE) | (1 << ZBX_DIAGINFO_PREPROCESSING) |
-				(1 << ZBX_DIAGINFO_LOCKS);
+				(1 << ZBX_DIAGINFO_LOCKS) | (1 << ZBX_DIAGINFO_CONFIGCACHE);
 	}
 	else if (0 == strcmp(buf, ZBX_DIAG_HISTORYCACHE))
 	{
@@ -223,6 +223,10 @@ static void	rtc_process_diaginfo(const char *data, char **result)
 	{
 		scope = 1 << ZBX_DIAGINFO_CONNECTOR;
 	}
+	else if (0 == strcmp(buf, ZBX_DIAG_CONFIGCACHE))
+	{
+		scope = 1 << ZBX_DIAGINFO_CONFIGCACHE;
+	}
 	else
 	{
 		if (NULL == *result)
@@ -435,6 +439,7 @@ static void	rtc_process_request(zbx_rtc_t *rtc, zbx_uint32_t code, const unsigne
 #ifdef HAVE_NETSNMP
 			zbx_rtc_notify(rtc, ZBX_PROCESS_TYPE_POLLER, 0, ZBX_RTC_SNMP_CACHE_RELOAD, NULL, 0);
 			zbx_rtc_notify(rtc, ZBX_PROCESS_TYPE_UNREACHABLE, 0, ZBX_RTC_SNMP_CACHE_RELOAD, NULL, 0);
+			zbx_rtc_notify(rtc, ZBX_PROCESS_TYPE_SNMP_POLLER, 0, ZBX_RTC_SNMP_CACHE_RELOAD, NULL, 0);
 			zbx_rtc_notify(rtc, ZBX_PROCESS_TYPE_TRAPPER, 0, ZBX_RTC_SNMP_CACHE_RELOAD, NULL, 0);
 			zbx_rtc_notify(rtc, ZBX_PROCESS_TYPE_DISCOVERYMANAGER, 0, ZBX_RTC_SNMP_CACHE_RELOAD, NULL, 0);
 			zbx_rtc_notify(rtc, ZBX_PROCESS_TYPE_TASKMANAGER, 0, ZBX_RTC_SNMP_CACHE_RELOAD, NULL, 0);
@@ -38,6 +38,8 @@ typedef struct
 	zbx_timekeeper_t	*monitor;
 	zbx_timekeeper_sync_t	sync;
 	int			process_index[ZBX_PROCESS_TYPE_COUNT];
+	zbx_uint64_t		*buffer_peak;	/* the largest received message size of each process */
+	double			*poller_stats;	/* ZBX_SELFMON_POLLER_STATS_NUM statistics of each process */
 }
 zbx_selfmon_collector_t;
 
@@ -104,7 +106,9 @@ int	zbx_init_selfmon_collector(zbx_get_config_forks_f get_config_forks, char **e
 		units_num += get_config_forks_cb(proc_type);
 	}
 
-	sz_total = zbx_timekeeper_get_memmalloc_size(units_num);
+	/* timekeeper, peak buffer sizes and poller statistics arrays with allocation overhead */
+	sz_total = zbx_timekeeper_get_memmalloc_size(units_num) + sizeof(zbx_uint64_t) * (size_t)units_num +
+			sizeof(double) * ZBX_SELFMON_POLLER_STATS_NUM * (size_t)units_num + 4 * sizeof(zbx_uint64_t);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "%s() size:" ZBX_FS_SIZE_T, __func__, (zbx_fs_size_t)sz_total);
 
@@ -117,6 +121,14 @@ int	zbx_init_selfmon_collector(zbx_get_config_forks_f get_config_forks, char **e
 	zbx_timekeeper_sync_init(&collector.sync, sm_sync_lock, sm_sync_unlock, (void *)&sm_lock);
 	collector.monitor = zbx_timekeeper_create_ext(units_num, &collector.sync, __sm_shmem_malloc_func,
 			__sm_shmem_realloc_func, __sm_shmem_free_func);
+
+	collector.buffer_peak = (zbx_uint64_t *)__sm_shmem_malloc_func(NULL, sizeof(zbx_uint64_t) *
+			(size_t)units_num);
+	memset(collector.buffer_peak, 0, sizeof(zbx_uint64_t) * (size_t)units_num);
+
+	collector.poller_stats = (double *)__sm_shmem_malloc_func(NULL, sizeof(double) * ZBX_SELFMON_POLLER_STATS_NUM *
+			(size_t)units_num);
+	memset(collector.poller_stats, 0, sizeof(double) * ZBX_SELFMON_POLLER_STATS_NUM * (size_t)units_num);
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() collector.monitor:%p", __func__, (void *)collector.monitor);
 
@@ -159,6 +171,204 @@ void	zbx_update_selfmon_counter(const zbx_thread_info_t *info, unsigned char sta
 
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remember the size of message received by process if it is the     *
+ *          largest so far                                                    *
+ *                                                                            *
+ * Parameters: info - [IN] caller process info                                *
+ *             size - [IN] the received message size                          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_update_selfmon_buffer(const zbx_thread_info_t *info, zbx_uint64_t size)
+{
+	int	unit_index;
+
+	if (ZBX_PROCESS_TYPE_UNKNOWN == info->process_type || SUCCEED != selfmon_is_process_monitored(
+			info->process_type))
+	{
+		return;
+	}
+
+	unit_index = collector.process_index[info->process_type] + info->process_num - 1;
+
+	/* only the process itself changes its value, so it can be compared without locking */
+	if (size <= collector.buffer_peak[unit_index])
+		return;
+
+	zbx_mutex_lock(sm_lock);
+	collector.buffer_peak[unit_index] = size;
+	zbx_mutex_unlock(sm_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the largest received message size of selected process         *
+ *                                                                            *
+ * Parameters: proc_type - [IN] type of process; ZBX_PROCESS_TYPE_*           *
+ *             aggr_func - [IN] one of ZBX_SELFMON_AGGR_FUNC_*                *
+ *             proc_num  - [IN] process number; 1 - first process;            *
+ *                              0 - all processes                             *
+ *             value     - [OUT] the message size in bytes                    *
+ *                                                                            *
+ * Return value: SUCCEED - the size was returned                              *
+ *               FAIL    - the process type is not monitored                  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_get_selfmon_buffer_stats(unsigned char proc_type, unsigned char aggr_func, int proc_num,
+		zbx_uint64_t *value)
+{
+	int	i, unit_index, unit_count;
+
+	if (SUCCEED != selfmon_is_process_monitored(proc_type))
+		return FAIL;
+
+	unit_index = collector.process_index[proc_type];
+
+	if (0 < proc_num)
+	{
+		unit_index += proc_num - 1;
+		unit_count = 1;
+	}
+	else
+		unit_count = get_config_forks_cb(proc_type);
+
+	*value = 0;
+
+	zbx_mutex_lock(sm_lock);
+
+	for (i = unit_index; i < unit_index + unit_count; i++)
+	{
+		zbx_uint64_t	size = collector.buffer_peak[i];
+
+		switch (aggr_func)
+		{
+			case ZBX_SELFMON_AGGR_FUNC_MIN:
+				if (i == unit_index || size < *value)
+					*value = size;
+				break;
+			case ZBX_SELFMON_AGGR_FUNC_AVG:
+				*value += size;
+				break;
+			default:
+				if (size > *value)
+					*value = size;
+		}
+	}
+
+	zbx_mutex_unlock(sm_lock);
+
+	if (ZBX_SELFMON_AGGR_FUNC_AVG == aggr_func && 0 != unit_count)
+		*value /= (zbx_uint64_t)unit_count;
+
+	return SUCCEED;
+}
+
+static int	selfmon_is_async_poller(unsigned char proc_type)
+{
+	switch (proc_type)
+	{
+		case ZBX_PROCESS_TYPE_AGENT_POLLER:
+		case ZBX_PROCESS_TYPE_SNMP_POLLER:
+		case ZBX_PROCESS_TYPE_HTTPAGENT_POLLER:
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: store statistics of asynchronous poller for the last interval     *
+ *                                                                            *
+ * Parameters: info        - [IN] caller process info                         *
+ *             checks      - [IN] number of checks in progress                *
+ *             latency     - [IN] average check latency, seconds              *
+ *             queue_delay - [IN] average delay of checks after their         *
+ *                                scheduled time, seconds                     *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_update_selfmon_poller(const zbx_thread_info_t *info, int checks, double latency, double queue_delay)
+{
+	double	*stats;
+
+	if (SUCCEED != selfmon_is_async_poller(info->process_type))
+		return;
+
+	stats = collector.poller_stats + ZBX_SELFMON_POLLER_STATS_NUM *
+			(collector.process_index[info->process_type] + info->process_num - 1);
+
+	zbx_mutex_lock(sm_lock);
+	stats[ZBX_SELFMON_POLLER_CHECKS] = (double)checks;
+	stats[ZBX_SELFMON_POLLER_LATENCY] = latency;
+	stats[ZBX_SELFMON_POLLER_QUEUE_DELAY] = queue_delay;
+	zbx_mutex_unlock(sm_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get statistics of selected asynchronous poller                    *
+ *                                                                            *
+ * Parameters: proc_type - [IN] type of process; ZBX_PROCESS_TYPE_*           *
+ *             aggr_func - [IN] one of ZBX_SELFMON_AGGR_FUNC_*                *
+ *             proc_num  - [IN] process number; 1 - first process;            *
+ *                              0 - all processes                             *
+ *             stat      - [IN] one of ZBX_SELFMON_POLLER_*                   *
+ *             value     - [OUT] the statistics value                         *
+ *                                                                            *
+ * Return value: SUCCEED - the value was returned                             *
+ *               FAIL    - the process is not an asynchronous poller          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_get_selfmon_poller_stats(unsigned char proc_type, unsigned char aggr_func, int proc_num, int stat,
+		double *value)
+{
+	int	i, unit_index, unit_count;
+
+	if (SUCCEED != selfmon_is_async_poller(proc_type))
+		return FAIL;
+
+	unit_index = collector.process_index[proc_type];
+
+	if (0 < proc_num)
+	{
+		unit_index += proc_num - 1;
+		unit_count = 1;
+	}
+	else
+		unit_count = get_config_forks_cb(proc_type);
+
+	*value = 0;
+
+	zbx_mutex_lock(sm_lock);
+
+	for (i = unit_index; i < unit_index + unit_count; i++)
+	{
+		double	stat_value = collector.poller_stats[ZBX_SELFMON_POLLER_STATS_NUM * i + stat];
+
+		switch (aggr_func)
+		{
+			case ZBX_SELFMON_AGGR_FUNC_MIN:
+				if (i == unit_index || stat_value < *value)
+					*value = stat_value;
+				break;
+			case ZBX_SELFMON_AGGR_FUNC_AVG:
+				*value += stat_value;
+				break;
+			default:
+				if (stat_value > *value)
+					*value = stat_value;
+		}
+	}
+
+	zbx_mutex_unlock(sm_lock);
+
+	if (ZBX_SELFMON_AGGR_FUNC_AVG == aggr_func && 0 != unit_count)
+		*value /= unit_count;
+
+	return SUCCEED;
+}
+
 static void	collect_selfmon_stats(void)
 {
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -1082,224 +1082,137 @@ static int	get_function_by_name(const char *name, size_t len)
 	return ZBX_VALUE_FUNC_UNKNOWN;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: calculate minimum value from the history value vector             *
- *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             result      - [OUT] the resulting value                        *
- *                                                                            *
- ******************************************************************************/
-static void	evaluate_history_func_min(zbx_vector_history_record_t *values, int value_type, double *result)
+/* the data of value cache visitor calculating history function */
+typedef struct
 {
-	int	i;
-
-	if (ITEM_VALUE_TYPE_UINT64 == value_type)
-	{
-		*result = (double)values->values[0].value.ui64;
-
-		for (i = 1; i < values->values_num; i++)
-			if ((double)values->values[i].value.ui64 < *result)
-				*result = (double)values->values[i].value.ui64;
-	}
-	else
-	{
-		*result = values->values[0].value.dbl;
-
-		for (i = 1; i < values->values_num; i++)
-			if (values->values[i].value.dbl < *result)
-				*result = values->values[i].value.dbl;
-	}
+	unsigned char	value_type;
+	int		func;
+	int		values_num;
+	double		result;
 }
+zbx_history_func_t;
 
 /******************************************************************************
  *                                                                            *
- * Purpose: calculate maximum value from the history value vector             *
+ * Purpose: value cache visitor calculating function with history values      *
  *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             result      - [OUT] the resulting value                        *
+ * Parameters: value - [IN] the history value, only float/uint64 values are   *
+ *                          supported                                         *
+ *             data  - [IN/OUT] the function data (zbx_history_func_t). Only  *
+ *                          ZBX_VALUE_FUNC_MIN, ZBX_VALUE_FUNC_AVG,           *
+ *                          ZBX_VALUE_FUNC_MAX, ZBX_VALUE_FUNC_SUM,           *
+ *                          ZBX_VALUE_FUNC_COUNT functions are supported.     *
  *                                                                            *
- ******************************************************************************/
-static void	evaluate_history_func_max(zbx_vector_history_record_t *values, int value_type, double *result)
-{
-	int	i;
-
-	if (ITEM_VALUE_TYPE_UINT64 == value_type)
-	{
-		*result = (double)values->values[0].value.ui64;
-
-		for (i = 1; i < values->values_num; i++)
-			if ((double)values->values[i].value.ui64 > *result)
-				*result = (double)values->values[i].value.ui64;
-	}
-	else
-	{
-		*result = values->values[0].value.dbl;
-
-		for (i = 1; i < values->values_num; i++)
-			if (values->values[i].value.dbl > *result)
-				*result = values->values[i].value.dbl;
-	}
-}
-
-/******************************************************************************
+ * Return value: SUCCEED - the next value must be visited                     *
  *                                                                            *
- * Purpose: calculate sum of values from the history value vector             *
- *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             result      - [OUT] the resulting value                        *
+ * Comments: The average must be finished with evaluate_history_func_result() *
+ *           after all values are visited.                                    *
  *                                                                            *
  ******************************************************************************/
-static void	evaluate_history_func_sum(zbx_vector_history_record_t *values, int value_type, double *result)
+static int	evaluate_history_func_visit(const zbx_history_record_t *value, void *data)
 {
-	int	i;
+	zbx_history_func_t	*hf = (zbx_history_func_t *)data;
+	double			dbl;
 
-	*result = 0;
-
-	if (ITEM_VALUE_TYPE_UINT64 == value_type)
-	{
-		for (i = 0; i < values->values_num; i++)
-			*result += (double)values->values[i].value.ui64;
-	}
+	if (ITEM_VALUE_TYPE_UINT64 == hf->value_type)
+		dbl = (double)value->value.ui64;
 	else
+		dbl = value->value.dbl;
+
+	switch (hf->func)
 	{
-		for (i = 0; i < values->values_num; i++)
-			*result += values->values[i].value.dbl;
+		case ZBX_VALUE_FUNC_MIN:
+			if (0 == hf->values_num || dbl < hf->result)
+				hf->result = dbl;
+			break;
+		case ZBX_VALUE_FUNC_MAX:
+			if (0 == hf->values_num || dbl > hf->result)
+				hf->result = dbl;
+			break;
+		case ZBX_VALUE_FUNC_SUM:
+		case ZBX_VALUE_FUNC_AVG:
+			hf->result += dbl;
+			break;
 	}
-}
 
-/******************************************************************************
- *                                                                            *
- * Purpose: calculate average value of values from the history value vector   *
- *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             result      - [OUT] the resulting value                        *
- *                                                                            *
- ******************************************************************************/
-static void	evaluate_history_func_avg(zbx_vector_history_record_t *values, int value_type, double *result)
-{
-	evaluate_history_func_sum(values, value_type, result);
-	*result /= values->values_num;
+	hf->values_num++;
+
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: calculate number of values in value vector                        *
+ * Purpose: get the result of function calculated with history values         *
+ *                                                                            *
+ * Parameters: hf - [IN] the function data with at least one value visited    *
  *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             result      - [OUT] the resulting value                        *
+ * Return value: the resulting value                                          *
  *                                                                            *
  ******************************************************************************/
-static void	evaluate_history_func_count(zbx_vector_history_record_t *values, double *result)
+static double	evaluate_history_func_result(const zbx_history_func_t *hf)
 {
-	*result = (double)values->values_num;
+	switch (hf->func)
+	{
+		case ZBX_VALUE_FUNC_AVG:
+			return hf->result / hf->values_num;
+		case ZBX_VALUE_FUNC_COUNT:
+			return (double)hf->values_num;
+		default:
+			return hf->result;
+	}
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: calculate the last (newest) value in value vector                 *
- *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             result      - [OUT] the resulting value                        *
- *                                                                            *
- ******************************************************************************/
-static void	evaluate_history_func_last(zbx_vector_history_record_t *values, int value_type, double *result)
+/* the data of value cache visitor converting history value to variant */
+typedef struct
 {
-	if (ITEM_VALUE_TYPE_UINT64 == value_type)
-		*result = (double)values->values[0].value.ui64;
-	else
-		*result = values->values[0].value.dbl;
+	unsigned char		value_type;
+	zbx_vector_var_t	*results;
 }
+zbx_history_var_append_t;
 
 /******************************************************************************
  *                                                                            *
- * Purpose: convert history record to variant and append to variant vector    *
+ * Purpose: value cache visitor converting the first visited history record   *
+ *          to variant and appending it to variant vector                     *
  *                                                                            *
- * Parameters: values         - [IN] vector containing history values         *
- *             value_type     - [IN] type of an item                          *
- *             result_vector  - [OUT] resulting vector                        *
+ * Parameters: value - [IN] the history value                                 *
+ *             data  - [IN/OUT] the value type and resulting vector           *
+ *                                 (zbx_history_var_append_t)                 *
+ *                                                                            *
+ * Return value: FAIL - only the first value is appended                      *
  *                                                                            *
  ******************************************************************************/
-static void	var_vector_append_history_record(zbx_vector_history_record_t *values, int value_type,
-		zbx_vector_var_t *results_vector)
+static int	var_vector_append_history_record(const zbx_history_record_t *value, void *data)
 {
-	zbx_variant_t	result;
+	zbx_history_var_append_t	*append = (zbx_history_var_append_t *)data;
+	zbx_variant_t			result;
 
-	switch (value_type)
+	switch (append->value_type)
 	{
 		case ITEM_VALUE_TYPE_UINT64:
-			zbx_variant_set_ui64(&result, values->values[0].value.ui64);
+			zbx_variant_set_ui64(&result, value->value.ui64);
 			break;
 		case ITEM_VALUE_TYPE_STR:
 		case ITEM_VALUE_TYPE_TEXT:
-			zbx_variant_set_str(&result, zbx_strdup(NULL, values->values[0].value.str));
+			zbx_variant_set_str(&result, zbx_strdup(NULL, value->value.str));
 			break;
 		case ITEM_VALUE_TYPE_LOG:
-			zbx_variant_set_str(&result, zbx_strdup(NULL, values->values[0].value.log->value));
+			zbx_variant_set_str(&result, zbx_strdup(NULL, value->value.log->value));
 			break;
 		case ITEM_VALUE_TYPE_FLOAT:
-			zbx_variant_set_dbl(&result, values->values[0].value.dbl);
+			zbx_variant_set_dbl(&result, value->value.dbl);
 			break;
 		case ITEM_VALUE_TYPE_NONE:
-			return;
+			return FAIL;
 		case ITEM_VALUE_TYPE_BIN:
 		default:
 			THIS_SHOULD_NEVER_HAPPEN;
-			return;
+			return FAIL;
 	}
 
-	zbx_vector_var_append(results_vector, result);
-}
+	zbx_vector_var_append(append->results, result);
 
-/******************************************************************************
- *                                                                            *
- * Purpose: calculate function with values from value vector                  *
- *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             func        - [IN] the function to calculate. Only             *
- *                           ZBX_VALUE_FUNC_MIN, ZBX_VALUE_FUNC_AVG,          *
- *                           ZBX_VALUE_FUNC_MAX, ZBX_VALUE_FUNC_SUM,          *
- *                           ZBX_VALUE_FUNC_COUNT, ZBX_VALUE_FUNC_LAST        *
- *                           functions are supported.                         *
- *             result      - [OUT] the resulting value                        *
- *                                                                            *
- ******************************************************************************/
-static void	evaluate_history_func(zbx_vector_history_record_t *values, int value_type, int func,
-		double *result)
-{
-	switch (func)
-	{
-		case ZBX_VALUE_FUNC_MIN:
-			evaluate_history_func_min(values, value_type, result);
-			break;
-		case ZBX_VALUE_FUNC_AVG:
-			evaluate_history_func_avg(values, value_type, result);
-			break;
-		case ZBX_VALUE_FUNC_MAX:
-			evaluate_history_func_max(values, value_type, result);
-			break;
-		case ZBX_VALUE_FUNC_SUM:
-			evaluate_history_func_sum(values, value_type, result);
-			break;
-		case ZBX_VALUE_FUNC_COUNT:
-			evaluate_history_func_count(values, result);
-			break;
-		case ZBX_VALUE_FUNC_LAST:
-			evaluate_history_func_last(values, value_type, result);
-			break;
-	}
+	return FAIL;
 }
 
 /******************************************************************************
@@ -1586,32 +1499,34 @@ static int	evaluate_count_many(char *operator, char *pattern, zbx_dc_item_t *dci
 {
 	int				ret = FAIL;
 	zbx_eval_count_pattern_data_t	pdata;
-	zbx_vector_history_record_t	values;
-
-	zbx_history_record_vector_create(&values);
+	zbx_count_pattern_visit_t	visit;
 
 	if (FAIL == zbx_init_count_pattern(operator, pattern, dcitem->value_type, &pdata, error))
-		goto out;
+		return FAIL;
+
+	visit.pdata = &pdata;
+	visit.pattern = pattern;
+	visit.value_type = dcitem->value_type;
+	visit.limit = ZBX_MAX_UINT31_1;
+	visit.count = 0;
+	visit.ret = SUCCEED;
+	visit.error = error;
 
-	if (SUCCEED == zbx_vc_get_values(dcitem->itemid, dcitem->value_type, &values, seconds, count, ts))
+	if (SUCCEED == zbx_vc_visit_values(dcitem->itemid, dcitem->value_type, seconds, count, ts,
+			zbx_count_history_record_with_pattern, &visit))
 	{
 		zbx_variant_t	v;
-		int		result = 0;
 
-		if (FAIL == zbx_execute_count_with_pattern(pattern, dcitem->value_type, &pdata, &values,
-				ZBX_MAX_UINT31_1, &result, error))
-		{
+		if (SUCCEED != visit.ret)
 			goto out;
-		}
 
-		zbx_variant_set_dbl(&v, (double)result);
+		zbx_variant_set_dbl(&v, (double)visit.count);
 		zbx_vector_var_append(results_vector, v);
 	}
 
 	ret = SUCCEED;
 out:
 	zbx_clear_count_pattern(&pdata);
-	zbx_history_record_vector_destroy(&values, dcitem->value_type);
 
 	return ret;
 }
@@ -1642,7 +1557,6 @@ static int	expression_eval_many(zbx_expression_eval_t *eval, zbx_expression_quer
 	zbx_expression_query_many_t	*data;
 	int				ret = FAIL, item_func, count, seconds, i;
 	zbx_vector_var_t		*results_var_vector;
-	double				result;
 	char				*operator = NULL, *pattern = NULL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() %.*s(/%s/%s?[%s],...)", __func__, (int)len, name,
@@ -1786,30 +1700,26 @@ static int	expression_eval_many(zbx_expression_eval_t *eval, zbx_expression_quer
 				goto out;
 			}
 		}
-		else
+		else if (ZBX_VALUE_FUNC_LAST == item_func)
 		{
-			zbx_vector_history_record_t	values;
+			zbx_history_var_append_t	append = {.value_type = dcitem->value_type,
+									.results = results_var_vector};
 
-			zbx_history_record_vector_create(&values);
+			zbx_vc_visit_values(dcitem->itemid, dcitem->value_type, seconds, count, ts,
+					var_vector_append_history_record, &append);
+		}
+		else
+		{
+			zbx_history_func_t	hf = {.value_type = dcitem->value_type, .func = item_func};
 
-			if (SUCCEED == zbx_vc_get_values(dcitem->itemid, dcitem->value_type, &values, seconds, count, ts)
-					&& 0 < values.values_num)
+			if (SUCCEED == zbx_vc_visit_values(dcitem->itemid, dcitem->value_type, seconds, count, ts,
+					evaluate_history_func_visit, &hf) && 0 < hf.values_num)
 			{
-				if (ZBX_VALUE_FUNC_LAST == item_func)
-				{
-					var_vector_append_history_record(&values, dcitem->value_type, results_var_vector);
-				}
-				else
-				{
-					zbx_variant_t	v;
+				zbx_variant_t	v;
 
-					evaluate_history_func(&values, dcitem->value_type, item_func, &result);
-					zbx_variant_set_dbl(&v, result);
-					zbx_vector_var_append(results_var_vector, v);
-				}
+				zbx_variant_set_dbl(&v, evaluate_history_func_result(&hf));
+				zbx_vector_var_append(results_var_vector, v);
 			}
-
-			zbx_history_record_vector_destroy(&values, dcitem->value_type);
 		}
 	}
 
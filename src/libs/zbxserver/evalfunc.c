@@ -681,6 +681,33 @@ out:
 	return ret;
 }
 
+/* the data of value cache visitor getting the Nth last value */
+typedef struct
+{
+	int			n;
+	int			index;
+	unsigned char		value_type;
+	zbx_history_record_t	*value;
+}
+zbx_last_n_value_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache visitor copying the Nth visited value                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	last_n_value_visit(const zbx_history_record_t *value, void *data)
+{
+	zbx_last_n_value_t	*last = (zbx_last_n_value_t *)data;
+
+	if (++last->index < last->n)
+		return SUCCEED;
+
+	zbx_vc_history_record_copy(last->value, value, last->value_type);
+
+	return FAIL;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get last Nth value defined by #num:now-timeshift first parameter  *
@@ -699,12 +726,10 @@ out:
 static int	get_last_n_value(const zbx_dc_evaluate_item_t *item, const char *parameters, const zbx_timespec_t *ts,
 		zbx_history_record_t *value, char **error)
 {
-	int				arg1 = 1, ret = FAIL, time_shift;
-	zbx_value_type_t		arg1_type = ZBX_VALUE_NVALUES;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
-
-	zbx_history_record_vector_create(&values);
+	int			arg1 = 1, ret = FAIL, time_shift;
+	zbx_value_type_t	arg1_type = ZBX_VALUE_NVALUES;
+	zbx_timespec_t		ts_end = *ts;
+	zbx_last_n_value_t	last = {.value = value, .value_type = item->value_type};
 
 	if (SUCCEED != get_function_parameter_hist_range(ts->sec, parameters, 1, &arg1, &arg1_type, &time_shift))
 	{
@@ -716,24 +741,20 @@ static int	get_last_n_value(const zbx_dc_evaluate_item_t *item, const char *para
 		arg1 = 1;	/* time or non parameter is defaulted to "last(0)" */
 
 	ts_end.sec -= time_shift;
+	last.n = arg1;
 
-	if (SUCCEED != zbx_vc_get_values(item->itemid, item->value_type, &values, 0, arg1, &ts_end))
+	if (SUCCEED != zbx_vc_visit_values(item->itemid, item->value_type, 0, arg1, &ts_end, last_n_value_visit,
+			&last))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (arg1 <= values.values_num)
-	{
-		*value = values.values[arg1 - 1];
-		zbx_vector_history_record_remove(&values, arg1 - 1);
+	if (arg1 == last.index)
 		ret = SUCCEED;
-	}
 	else
 		*error = zbx_strdup(*error, "not enough data");
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	return ret;
 }
 
@@ -1432,47 +1453,75 @@ int	zbx_count_var_vector_with_pattern(zbx_eval_count_pattern_data_t *pdata, char
 	return SUCCEED;
 }
 
-int	zbx_execute_count_with_pattern(char *pattern, unsigned char value_type, zbx_eval_count_pattern_data_t *pdata,
-		zbx_vector_history_record_t *records, int limit, int *count, char **error)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache visitor counting values matching pattern              *
+ *                                                                            *
+ * Parameters: value - [IN] the history value                                 *
+ *             data  - [IN/OUT] the counting data (zbx_count_pattern_visit_t) *
+ *                                                                            *
+ * Return value: SUCCEED - the next value must be counted                     *
+ *               FAIL    - the limit was reached or matching failed, in the   *
+ *                         later case the ret field of counting data is set   *
+ *                         to FAIL                                            *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_count_history_record_with_pattern(const zbx_history_record_t *value, void *data)
 {
-	int			i, ret;
-	zbx_vector_var_t	values;
+	zbx_count_pattern_visit_t	*visit = (zbx_count_pattern_visit_t *)data;
+	zbx_eval_count_pattern_data_t	*pdata = visit->pdata;
+	const char			*str = NULL;
+	char				buf[ZBX_MAX_UINT64_LEN];
 
-	zbx_vector_var_create(&values);
-	zbx_vector_var_reserve(&values, records->values_num);
-	values.values_num = records->values_num;
+	if (visit->count >= visit->limit)
+		return FAIL;
 
-	switch (value_type)
+	if (OP_ANY == pdata->op)
 	{
-		case ITEM_VALUE_TYPE_UINT64:
-			for (i = 0; i < records->values_num; i++)
-				zbx_variant_set_ui64(&values.values[i], records->values[i].value.ui64);
+		visit->count++;
+		goto out;
+	}
 
+	switch (visit->value_type)
+	{
+		case ITEM_VALUE_TYPE_UINT64:
+			if (0 != pdata->numeric_search)
+			{
+				count_one_ui64(&visit->count, pdata->op, value->value.ui64, pdata->pattern_ui64,
+						pdata->pattern2_ui64);
+			}
+			else
+			{
+				zbx_snprintf(buf, sizeof(buf), ZBX_FS_UI64, value->value.ui64);
+				str = buf;
+			}
 			break;
-
 		case ITEM_VALUE_TYPE_FLOAT:
-			for (i = 0; i < records->values_num; i++)
-				zbx_variant_set_dbl(&values.values[i], records->values[i].value.dbl);
-
+			if (0 != pdata->numeric_search)
+			{
+				count_one_dbl(&visit->count, pdata->op, value->value.dbl, pdata->pattern_dbl);
+			}
+			else
+			{
+				zbx_snprintf(buf, sizeof(buf), ZBX_FS_DBL_EXT(4), value->value.dbl);
+				str = buf;
+			}
 			break;
-
 		case ITEM_VALUE_TYPE_LOG:
-			for (i = 0; i < records->values_num; i++)
-				zbx_variant_set_str(&values.values[i], records->values[i].value.log->value);
-
+			str = value->value.log->value;
 			break;
 		default:
-			for (i = 0; i < records->values_num; i++)
-				zbx_variant_set_str(&values.values[i], records->values[i].value.str);
-
-			break;
+			str = value->value.str;
 	}
 
-	ret = zbx_count_var_vector_with_pattern(pdata, pattern, &values, limit, count, error);
-
-	zbx_vector_var_destroy(&values);
-
-	return ret;
+	if (NULL != str && FAIL == count_one_str(&visit->count, pdata->op, str, visit->pattern, &pdata->regexps,
+			visit->error))
+	{
+		visit->ret = FAIL;
+		return FAIL;
+	}
+out:
+	return visit->count < visit->limit ? SUCCEED : FAIL;
 }
 
 /******************************************************************************
@@ -1509,8 +1558,10 @@ static int	evaluate_COUNT(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 	char				*operator = NULL, *pattern = NULL;
 	zbx_value_type_t		arg1_type;
 	zbx_vector_history_record_t	values;
+	zbx_history_value_t		result;
 	zbx_timespec_t			ts_end = *ts;
 	zbx_eval_count_pattern_data_t	pdata;
+	zbx_count_pattern_visit_t	visit;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() params:%s", __func__, ZBX_NULL2EMPTY_STR(parameters));
 
@@ -1565,14 +1616,35 @@ static int	evaluate_COUNT(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	/* the number of values in period is tracked by value cache when no filter is applied */
+	if (0 != seconds && 0 == time_shift && OP_ANY == pdata.op && COUNT_ALL == unique &&
+			SUCCEED == zbx_vc_get_window_aggregate(item->itemid, item->value_type, seconds, &ts_end,
+			ZBX_VC_AGGR_COUNT, &result, &count))
 	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
-		goto clean;
+		if (count > limit)
+			count = limit;
+
+		goto finish;
 	}
 
+	visit.pdata = &pdata;
+	visit.pattern = pattern;
+	visit.value_type = item->value_type;
+	visit.limit = limit;
+	visit.count = 0;
+	visit.ret = SUCCEED;
+	visit.error = error;
+
 	if (COUNT_UNIQUE == unique)
 	{
+		int	i;
+
+		if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+		{
+			*error = zbx_strdup(*error, "cannot get values from value cache");
+			goto clean;
+		}
+
 		switch (item->value_type)
 		{
 			case ITEM_VALUE_TYPE_UINT64:
@@ -1599,23 +1671,25 @@ static int	evaluate_COUNT(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 				zbx_vector_history_record_str_uniq(&values,
 						(zbx_compare_func_t)history_record_str_compare);
 		}
-	}
 
-	/* skip counting values one by one if filter matches any value */
-	if (OP_ANY != pdata.op)
-	{
-		if (FAIL == zbx_execute_count_with_pattern(pattern, item->value_type, &pdata, &values, limit, &count,
-				error))
+		for (i = 0; i < values.values_num; i++)
 		{
-			goto clean;
+			if (SUCCEED != zbx_count_history_record_with_pattern(&values.values[i], &visit))
+				break;
 		}
 	}
-	else
+	else if (FAIL == zbx_vc_visit_values(item->itemid, item->value_type, seconds, nvalues, &ts_end,
+			zbx_count_history_record_with_pattern, &visit))
 	{
-		if ((count = values.values_num) > limit)
-			count = limit;
+		*error = zbx_strdup(*error, "cannot get values from value cache");
+		goto clean;
 	}
 
+	if (SUCCEED != visit.ret)
+		goto clean;
+
+	count = visit.count;
+finish:
 	zbx_variant_set_dbl(value, count);
 
 	ret = SUCCEED;
@@ -1644,6 +1718,107 @@ out:
 #undef OP_IREGEXP
 #undef OP_BITAND
 
+/* the data of value cache visitors aggregating numeric values */
+typedef struct
+{
+	unsigned char		value_type;
+	int			values_num;
+	zbx_history_value_t	result;
+}
+zbx_history_aggr_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache visitor summing numeric values                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	history_sum_visit(const zbx_history_record_t *value, void *data)
+{
+	zbx_history_aggr_t	*aggr = (zbx_history_aggr_t *)data;
+
+	if (ITEM_VALUE_TYPE_FLOAT == aggr->value_type)
+		aggr->result.dbl += value->value.dbl;
+	else
+		aggr->result.ui64 += value->value.ui64;
+
+	aggr->values_num++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache visitor averaging numeric values                      *
+ *                                                                            *
+ * Comments: The average of float values is calculated incrementally, while   *
+ *           unsigned values are summed and must be divided by the number of  *
+ *           values afterwards.                                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	history_avg_visit(const zbx_history_record_t *value, void *data)
+{
+	zbx_history_aggr_t	*aggr = (zbx_history_aggr_t *)data;
+
+	aggr->values_num++;
+
+	if (ITEM_VALUE_TYPE_FLOAT == aggr->value_type)
+		aggr->result.dbl += value->value.dbl / aggr->values_num - aggr->result.dbl / aggr->values_num;
+	else
+		aggr->result.dbl += (double)value->value.ui64;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache visitor finding the minimum numeric value             *
+ *                                                                            *
+ ******************************************************************************/
+static int	history_min_visit(const zbx_history_record_t *value, void *data)
+{
+	zbx_history_aggr_t	*aggr = (zbx_history_aggr_t *)data;
+
+	if (ITEM_VALUE_TYPE_UINT64 == aggr->value_type)
+	{
+		if (0 == aggr->values_num || value->value.ui64 < aggr->result.ui64)
+			aggr->result.ui64 = value->value.ui64;
+	}
+	else
+	{
+		if (0 == aggr->values_num || value->value.dbl < aggr->result.dbl)
+			aggr->result.dbl = value->value.dbl;
+	}
+
+	aggr->values_num++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache visitor finding the maximum numeric value             *
+ *                                                                            *
+ ******************************************************************************/
+static int	history_max_visit(const zbx_history_record_t *value, void *data)
+{
+	zbx_history_aggr_t	*aggr = (zbx_history_aggr_t *)data;
+
+	if (ITEM_VALUE_TYPE_UINT64 == aggr->value_type)
+	{
+		if (0 == aggr->values_num || value->value.ui64 > aggr->result.ui64)
+			aggr->result.ui64 = value->value.ui64;
+	}
+	else
+	{
+		if (0 == aggr->values_num || value->value.dbl > aggr->result.dbl)
+			aggr->result.dbl = value->value.dbl;
+	}
+
+	aggr->values_num++;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate function 'sum' for the item                              *
@@ -1662,16 +1837,13 @@ out:
 static int	evaluate_SUM(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_history_value_t		result;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift, values_num;
+	zbx_value_type_t	arg1_type;
+	zbx_history_aggr_t	aggr = {.value_type = item->value_type};
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1705,31 +1877,22 @@ static int	evaluate_SUM(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (0 != seconds && 0 == time_shift && SUCCEED == zbx_vc_get_window_aggregate(item->itemid,
+			item->value_type, seconds, &ts_end, ZBX_VC_AGGR_SUM, &aggr.result, &values_num))
 	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
-		goto out;
+		goto finish;
 	}
 
-	if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+	if (FAIL == zbx_vc_visit_values(item->itemid, item->value_type, seconds, nvalues, &ts_end, history_sum_visit,
+			&aggr))
 	{
-		result.dbl = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.dbl += values.values[i].value.dbl;
-	}
-	else
-	{
-		result.ui64 = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.ui64 += values.values[i].value.ui64;
+		*error = zbx_strdup(*error, "cannot get values from value cache");
+		goto out;
 	}
-
-	zbx_history_value2variant(&result, item->value_type, value);
+finish:
+	zbx_history_value2variant(&aggr.result, item->value_type, value);
 	ret = SUCCEED;
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -1754,15 +1917,13 @@ out:
 static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				arg1, ret = FAIL, i, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift, values_num;
+	zbx_value_type_t	arg1_type;
+	zbx_history_aggr_t	aggr = {.value_type = item->value_type};
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1796,29 +1957,33 @@ static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (0 != seconds && 0 == time_shift && SUCCEED == zbx_vc_get_window_aggregate(item->itemid,
+			item->value_type, seconds, &ts_end, ZBX_VC_AGGR_AVG, &aggr.result, &values_num))
 	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
+		if (0 < values_num)
+		{
+			zbx_variant_set_dbl(value, aggr.result.dbl);
+			ret = SUCCEED;
+		}
+		else
+			*error = zbx_strdup(*error, "not enough data");
+
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (FAIL == zbx_vc_visit_values(item->itemid, item->value_type, seconds, nvalues, &ts_end, history_avg_visit,
+			&aggr))
 	{
-		double	avg = 0;
+		*error = zbx_strdup(*error, "cannot get values from value cache");
+		goto out;
+	}
 
-		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += values.values[i].value.dbl / (i + 1) - avg / (i + 1);
-		}
-		else
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += (double)values.values[i].value.ui64;
+	if (0 < aggr.values_num)
+	{
+		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
+			aggr.result.dbl = aggr.result.dbl / aggr.values_num;
 
-			avg = avg / values.values_num;
-		}
-		zbx_variant_set_dbl(value, avg);
+		zbx_variant_set_dbl(value, aggr.result.dbl);
 
 		ret = SUCCEED;
 	}
@@ -1828,7 +1993,6 @@ static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -1872,17 +2036,6 @@ static int	evaluate_LAST(zbx_variant_t *value, const zbx_dc_evaluate_item_t *ite
 #define EVALUATE_MIN	0
 #define EVALUATE_MAX	1
 
-#define LOOP_FIND_MIN_OR_MAX(type, mode_op)							\
-	do											\
-	{											\
-		for (i = 1; i < values.values_num; i++)							\
-		{											\
-			if (values.values[i].value.type mode_op values.values[index].value.type)	\
-				index = i;								\
-		}											\
-	}												\
-	while(0)
-
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate function 'min' or 'max' for the item                     *
@@ -1902,15 +2055,13 @@ static int	evaluate_LAST(zbx_variant_t *value, const zbx_dc_evaluate_item_t *ite
 static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error, int min_or_max)
 {
-	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift, values_num;
+	zbx_value_type_t	arg1_type;
+	zbx_history_aggr_t	aggr = {.value_type = item->value_type};
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1944,40 +2095,31 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (0 != seconds && 0 == time_shift && SUCCEED == zbx_vc_get_window_aggregate(item->itemid,
+			item->value_type, seconds, &ts_end, EVALUATE_MIN == min_or_max ? ZBX_VC_AGGR_MIN :
+			ZBX_VC_AGGR_MAX, &aggr.result, &values_num))
 	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
+		if (0 < values_num)
+		{
+			zbx_history_value2variant(&aggr.result, item->value_type, value);
+			ret = SUCCEED;
+		}
+		else
+			*error = zbx_strdup(*error, "not enough data");
+
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (FAIL == zbx_vc_visit_values(item->itemid, item->value_type, seconds, nvalues, &ts_end,
+			EVALUATE_MIN == min_or_max ? history_min_visit : history_max_visit, &aggr))
 	{
-		int	index = 0;
-
-		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
-		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, >);
-			}
-		}
-		else
-		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, >);
-			}
-		}
+		*error = zbx_strdup(*error, "cannot get values from value cache");
+		goto out;
+	}
 
-		zbx_history_value2variant(&values.values[index].value, item->value_type, value);
+	if (0 < aggr.values_num)
+	{
+		zbx_history_value2variant(&aggr.result, item->value_type, value);
 		ret = SUCCEED;
 	}
 	else
@@ -1986,7 +2128,6 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -34,6 +34,18 @@ int	evaluate_function(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item,
 
 int	zbx_is_trigger_function(const char *name, size_t len);
 
-int	zbx_execute_count_with_pattern(char *pattern, unsigned char value_type, zbx_eval_count_pattern_data_t *pdata,
-		zbx_vector_history_record_t *records, int limit, int *count, char **error);
+/* the data of value cache visitor counting values matching pattern */
+typedef struct
+{
+	zbx_eval_count_pattern_data_t	*pdata;
+	char				*pattern;
+	unsigned char			value_type;
+	int				limit;
+	int				count;
+	int				ret;
+	char				**error;
+}
+zbx_count_pattern_visit_t;
+
+int	zbx_count_history_record_with_pattern(const zbx_history_record_t *value, void *data);
 #endif
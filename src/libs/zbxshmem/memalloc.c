@@ -81,6 +81,29 @@
  *  lo_bound             `size' fields in chunk B                   hi_bound  *
  *  (aligned)            have SHMEM_FLG_USED bit set               (aligned)  *
  *                                                                            *
+ * (*) slab: when enabled, small allocations are served from slabs - used     *
+ *     chunks of SHMEM_SLAB_SIZE bytes split into objects of the same size    *
+ *     class (multiple of 8 bytes, up to ZBX_SHMEM_SLAB_MAX_ALLOC)            *
+ *                                                                            *
+ *             +------------------- slab chunk ------------------+            *
+ *             |                                                 |            *
+ *             v                                                 v            *
+ *                                                                            *
+ *     |size|slab header|hdr|object|hdr|object|...|hdr|object|...|size|       *
+ *                                                                            *
+ *     object header has SHMEM_FLG_USED and SHMEM_FLG_SLAB bits set and the   *
+ *     offset of the object header from the slab header in the lower bits,    *
+ *     so freeing an object does not have to search for its slab              *
+ *                                                                            *
+ *     free objects of a slab are kept in a singly-linked list, slabs with    *
+ *     free objects are kept in doubly-linked list of their size class and    *
+ *     slabs without used objects are returned to the free chunk buckets      *
+ *     once there are more than SHMEM_SLAB_EMPTY_MAX of them in the class or  *
+ *     when the general allocator runs out of memory                          *
+ *                                                                            *
+ *     free objects of slabs are accounted as free memory in free_size,       *
+ *     only slab headers and unused slab tails are accounted as used memory   *
+ *                                                                            *
  ******************************************************************************/
 
 static void	*ALIGN4(void *ptr);
@@ -110,6 +133,7 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr);
 #define SHMEM_SIZE_FIELD	sizeof(zbx_uint64_t)
 
 #define SHMEM_FLG_USED		((__UINT64_C(1))<<63)
+#define SHMEM_FLG_SLAB		((__UINT64_C(1))<<62)
 
 #define FREE_CHUNK(ptr)		(((*(zbx_uint64_t *)(ptr)) & SHMEM_FLG_USED) == 0)
 #define CHUNK_SIZE(ptr)		((*(zbx_uint64_t *)(ptr)) & ~SHMEM_FLG_USED)
@@ -117,6 +141,38 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr);
 #define SHMEM_MIN_SIZE		__UINT64_C(128)
 #define SHMEM_MAX_SIZE		__UINT64_C(0x1000000000)	/* 64 GB */
 
+#define SHMEM_SLAB_SIZE		__UINT64_C(4096)
+#define SHMEM_SLAB_EMPTY_MAX	2	/* the number of empty slabs kept for reuse in each size class */
+
+#define SLAB_OBJECT(ptr)	(0 != ((*(zbx_uint64_t *)(ptr)) & SHMEM_FLG_SLAB))
+#define SLAB_OFFSET(ptr)	((*(zbx_uint64_t *)(ptr)) & ~(SHMEM_FLG_USED | SHMEM_FLG_SLAB))
+
+typedef struct zbx_shmem_slab zbx_shmem_slab_t;
+
+struct zbx_shmem_slab
+{
+	zbx_shmem_slab_t	*prev;
+	zbx_shmem_slab_t	*next;
+	void			*free_objects;
+	unsigned int		used_objects;
+	unsigned int		objects_num;	/* the number of objects carved from slab so far */
+	int			class_index;
+};
+
+typedef struct
+{
+	zbx_shmem_slab_t	*partial;	/* slabs with free objects */
+	zbx_uint64_t		object_size;	/* object size including header */
+	unsigned int		objects_max;	/* the number of objects per slab */
+	unsigned int		slabs_num;
+	unsigned int		empty_slabs;
+	unsigned int		used_objects;
+}
+zbx_shmem_slab_class_t;
+
+#define SLAB_HEADER_SIZE	((sizeof(zbx_shmem_slab_t) + 7) & ~(size_t)7)
+#define SLAB_OBJECTS(slab)	((char *)(slab) + SLAB_HEADER_SIZE)
+
 /* helper functions */
 
 static void	*ALIGN4(void *ptr)
@@ -523,6 +579,270 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr)
 	}
 }
 
+/* slab functions */
+
+static void	mem_slab_link(zbx_shmem_slab_class_t *slab_class, zbx_shmem_slab_t *slab)
+{
+	slab->prev = NULL;
+	slab->next = slab_class->partial;
+
+	if (NULL != slab_class->partial)
+		slab_class->partial->prev = slab;
+
+	slab_class->partial = slab;
+}
+
+static void	mem_slab_unlink(zbx_shmem_slab_class_t *slab_class, zbx_shmem_slab_t *slab)
+{
+	if (NULL != slab->prev)
+		slab->prev->next = slab->next;
+	else
+		slab_class->partial = slab->next;
+
+	if (NULL != slab->next)
+		slab->next->prev = slab->prev;
+}
+
+static void	mem_slab_init_classes(zbx_shmem_slab_class_t *slab_classes)
+{
+	int	i;
+
+	memset(slab_classes, 0, ZBX_SHMEM_SLAB_CLASS_COUNT * sizeof(zbx_shmem_slab_class_t));
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		slab_classes[i].object_size = SHMEM_SIZE_FIELD + (zbx_uint64_t)(i + 1) * 8;
+		slab_classes[i].objects_max = (unsigned int)((SHMEM_SLAB_SIZE - SLAB_HEADER_SIZE) /
+				slab_classes[i].object_size);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates object from slab of the corresponding size class        *
+ *                                                                            *
+ * Parameters: info - [IN] the shared memory                                  *
+ *             size - [IN] the requested size, up to ZBX_SHMEM_SLAB_MAX_ALLOC *
+ *                                                                            *
+ * Return value: the object header or NULL if there is no memory for new slab *
+ *                                                                            *
+ ******************************************************************************/
+static void	*mem_slab_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	int			index;
+	zbx_shmem_slab_class_t	*slab_class;
+	zbx_shmem_slab_t	*slab;
+	void			*object;
+
+	index = (int)((size + 7) >> 3) - 1;
+	slab_class = (zbx_shmem_slab_class_t *)info->slab_classes + index;
+
+	if (NULL == (slab = slab_class->partial))
+	{
+		void	*chunk;
+
+		if (NULL == (chunk = __mem_malloc(info, SHMEM_SLAB_SIZE)))
+			return NULL;
+
+		slab = (zbx_shmem_slab_t *)((char *)chunk + SHMEM_SIZE_FIELD);
+		slab->free_objects = NULL;
+		slab->used_objects = 0;
+		slab->objects_num = 0;
+		slab->class_index = index;
+
+		mem_slab_link(slab_class, slab);
+		slab_class->slabs_num++;
+
+		info->used_size -= slab_class->objects_max * slab_class->object_size;
+		info->free_size += slab_class->objects_max * slab_class->object_size;
+	}
+	else if (0 == slab->used_objects)
+		slab_class->empty_slabs--;
+
+	if (NULL != (object = slab->free_objects))
+	{
+		slab->free_objects = *(void **)((char *)object + SHMEM_SIZE_FIELD);
+	}
+	else
+	{
+		object = SLAB_OBJECTS(slab) + slab->objects_num * slab_class->object_size;
+		*(zbx_uint64_t *)object = SHMEM_FLG_USED | SHMEM_FLG_SLAB | (zbx_uint64_t)((char *)object -
+				(char *)slab);
+		slab->objects_num++;
+	}
+
+	if (++slab->used_objects == slab_class->objects_max)
+		mem_slab_unlink(slab_class, slab);
+
+	slab_class->used_objects++;
+
+	info->used_size += slab_class->object_size;
+	info->free_size -= slab_class->object_size;
+
+	return object;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns empty slab to the general allocator                       *
+ *                                                                            *
+ * Parameters: info       - [IN] the shared memory                            *
+ *             slab_class - [IN] the slab size class                          *
+ *             slab       - [IN] the empty slab                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	mem_slab_release(zbx_shmem_info_t *info, zbx_shmem_slab_class_t *slab_class, zbx_shmem_slab_t *slab)
+{
+	mem_slab_unlink(slab_class, slab);
+	slab_class->slabs_num--;
+
+	info->used_size += slab_class->objects_max * slab_class->object_size;
+	info->free_size -= slab_class->objects_max * slab_class->object_size;
+
+	__mem_free(info, slab);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns object to its slab                                        *
+ *                                                                            *
+ * Parameters: info   - [IN] the shared memory                                *
+ *             object - [IN] the object header                                *
+ *                                                                            *
+ * Comments: Slab is released when all its objects are freed and its size     *
+ *           class already has SHMEM_SLAB_EMPTY_MAX empty slabs.              *
+ *                                                                            *
+ ******************************************************************************/
+static void	mem_slab_free(zbx_shmem_info_t *info, void *object)
+{
+	zbx_shmem_slab_t	*slab;
+	zbx_shmem_slab_class_t	*slab_class;
+
+	slab = (zbx_shmem_slab_t *)((char *)object - SLAB_OFFSET(object));
+	slab_class = (zbx_shmem_slab_class_t *)info->slab_classes + slab->class_index;
+
+	*(void **)((char *)object + SHMEM_SIZE_FIELD) = slab->free_objects;
+	slab->free_objects = object;
+
+	if (slab->used_objects-- == slab_class->objects_max)
+		mem_slab_link(slab_class, slab);
+
+	slab_class->used_objects--;
+
+	info->used_size -= slab_class->object_size;
+	info->free_size += slab_class->object_size;
+
+	if (0 != slab->used_objects)
+		return;
+
+	if (SHMEM_SLAB_EMPTY_MAX > slab_class->empty_slabs)
+		slab_class->empty_slabs++;
+	else
+		mem_slab_release(info, slab_class, slab);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns all empty slabs to the general allocator                  *
+ *                                                                            *
+ * Parameters: info - [IN] the shared memory                                  *
+ *                                                                            *
+ * Return value: the number of released slabs                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	mem_slab_release_empty(zbx_shmem_info_t *info)
+{
+	int			i, released = 0;
+	zbx_shmem_slab_class_t	*slab_class;
+	zbx_shmem_slab_t	*slab, *next;
+
+	if (NULL == info->slab_classes)
+		return 0;
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		slab_class = (zbx_shmem_slab_class_t *)info->slab_classes + i;
+
+		for (slab = slab_class->partial; 0 != slab_class->empty_slabs && NULL != slab; slab = next)
+		{
+			next = slab->next;
+
+			if (0 != slab->used_objects)
+				continue;
+
+			mem_slab_release(info, slab_class, slab);
+			slab_class->empty_slabs--;
+			released++;
+		}
+	}
+
+	return released;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns object size available for user data                       *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	mem_slab_object_size(const zbx_shmem_info_t *info, void *object)
+{
+	zbx_shmem_slab_t	*slab;
+
+	slab = (zbx_shmem_slab_t *)((char *)object - SLAB_OFFSET(object));
+
+	return ((zbx_shmem_slab_class_t *)info->slab_classes)[slab->class_index].object_size - SHMEM_SIZE_FIELD;
+}
+
+static void	*mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	void	*chunk;
+
+	if (NULL != info->slab_classes && ZBX_SHMEM_SLAB_MAX_ALLOC >= size &&
+			NULL != (chunk = mem_slab_malloc(info, size)))
+	{
+		return chunk;
+	}
+
+	/* empty slabs kept for reuse might be enough to satisfy the request */
+	if (NULL == (chunk = __mem_malloc(info, size)) && 0 != mem_slab_release_empty(info))
+		chunk = __mem_malloc(info, size);
+
+	return chunk;
+}
+
+static void	*mem_realloc(zbx_shmem_info_t *info, void *old, zbx_uint64_t size)
+{
+	void		*chunk;
+	zbx_uint64_t	object_size;
+
+	if (!SLAB_OBJECT((char *)old - SHMEM_SIZE_FIELD))
+	{
+		if (NULL == (chunk = __mem_realloc(info, old, size)) && 0 != mem_slab_release_empty(info))
+			chunk = __mem_realloc(info, old, size);
+
+		return chunk;
+	}
+
+	if (size <= (object_size = mem_slab_object_size(info, (char *)old - SHMEM_SIZE_FIELD)))
+		return (char *)old - SHMEM_SIZE_FIELD;
+
+	if (NULL == (chunk = mem_malloc(info, size)))
+		return NULL;
+
+	memcpy((char *)chunk + SHMEM_SIZE_FIELD, old, MIN(size, object_size));
+	mem_slab_free(info, (char *)old - SHMEM_SIZE_FIELD);
+
+	return chunk;
+}
+
+static void	mem_free(zbx_shmem_info_t *info, void *ptr)
+{
+	if (SLAB_OBJECT((char *)ptr - SHMEM_SIZE_FIELD))
+		mem_slab_free(info, (char *)ptr - SHMEM_SIZE_FIELD);
+	else
+		__mem_free(info, ptr);
+}
+
 /* public memory interface */
 
 int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
@@ -596,6 +916,7 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	base = (void *)((char *)base + strlen(param) + 1);
 
 	(*info)->allow_oom = allow_oom;
+	(*info)->slab_classes = NULL;
 
 	/* prepare shared memory for further allocation by creating one big chunk */
 	(*info)->lo_bound = ALIGN8(base);
@@ -665,6 +986,36 @@ void	zbx_shmem_destroy(zbx_shmem_info_t *info)
 	(void)shmdt(info->base);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables slab allocation of small objects                          *
+ *                                                                            *
+ * Return value: SUCCEED - slabs were enabled                                 *
+ *               FAIL - not enough memory for slab size class table           *
+ *                                                                            *
+ * Comments: Allocations up to ZBX_SHMEM_SLAB_MAX_ALLOC bytes are served from *
+ *           slabs of equal size objects, which avoids fragmenting memory     *
+ *           with large numbers of small allocations and reduces per object   *
+ *           overhead. Must be called after creating shared memory, before    *
+ *           any allocations.                                                 *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_shmem_enable_slabs(zbx_shmem_info_t *info, char **error)
+{
+	void	*chunk;
+
+	if (NULL == (chunk = __mem_malloc(info, ZBX_SHMEM_SLAB_CLASS_COUNT * sizeof(zbx_shmem_slab_class_t))))
+	{
+		*error = zbx_dsprintf(*error, "cannot allocate slab size classes for %s", info->mem_descr);
+		return FAIL;
+	}
+
+	info->slab_classes = (char *)chunk + SHMEM_SIZE_FIELD;
+	mem_slab_init_classes((zbx_shmem_slab_class_t *)info->slab_classes);
+
+	return SUCCEED;
+}
+
 void	*__zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, const void *old, size_t size)
 {
 	void	*chunk;
@@ -683,7 +1034,7 @@ void	*__zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, con
 		exit(EXIT_FAILURE);
 	}
 
-	chunk = __mem_malloc(info, size);
+	chunk = mem_malloc(info, size);
 
 	if (NULL == chunk)
 	{
@@ -715,9 +1066,9 @@ void	*__zbx_shmem_realloc(const char *file, int line, zbx_shmem_info_t *info, vo
 	}
 
 	if (NULL == old)
-		chunk = __mem_malloc(info, size);
+		chunk = mem_malloc(info, size);
 	else
-		chunk = __mem_realloc(info, old, size);
+		chunk = mem_realloc(info, old, size);
 
 	if (NULL == chunk)
 	{
@@ -745,7 +1096,7 @@ void	__zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info, void *
 		exit(EXIT_FAILURE);
 	}
 
-	__mem_free(info, ptr);
+	mem_free(info, ptr);
 }
 
 void	zbx_shmem_clear(zbx_shmem_info_t *info)
@@ -763,6 +1114,18 @@ void	zbx_shmem_clear(zbx_shmem_info_t *info)
 	info->used_size = 0;
 	info->free_size = info->total_size;
 
+	if (NULL != info->slab_classes)
+	{
+		char	*error = NULL;
+
+		if (SUCCEED != zbx_shmem_enable_slabs(info, &error))
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			zbx_free(error);
+			info->slab_classes = NULL;
+		}
+	}
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -793,6 +1156,21 @@ void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats)
 		stats->chunks_num[i] = counter;
 	}
 
+	if (NULL != info->slab_classes)
+	{
+		const zbx_shmem_slab_class_t	*slab_class = (const zbx_shmem_slab_class_t *)info->slab_classes;
+
+		for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+		{
+			stats->slab_classes[i].slabs_num = slab_class[i].slabs_num;
+			stats->slab_classes[i].used_objects = slab_class[i].used_objects;
+			stats->slab_classes[i].free_objects = slab_class[i].slabs_num * slab_class[i].objects_max -
+					slab_class[i].used_objects;
+		}
+	}
+	else
+		memset(stats->slab_classes, 0, sizeof(stats->slab_classes));
+
 	stats->overhead = info->total_size - info->used_size - info->free_size;
 	stats->used_chunks = stats->overhead / (2 * SHMEM_SIZE_FIELD) + 1 - stats->free_chunks;
 	stats->free_size = info->free_size;
@@ -817,6 +1195,16 @@ void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
 			ZBX_SHMEM_MIN_BUCKET_SIZE + 8 * i, stats.chunks_num[i]);
 	}
 
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		if (0 == stats.slab_classes[i].slabs_num)
+			continue;
+
+		zabbix_log(level, "slabs of %3d byte objects: %8u used objects: %8u free objects: %8u", 8 * (i + 1),
+				stats.slab_classes[i].slabs_num, stats.slab_classes[i].used_objects,
+				stats.slab_classes[i].free_objects);
+	}
+
 	zabbix_log(level, "min chunk size: %10llu bytes", (unsigned long long)stats.min_chunk_size);
 	zabbix_log(level, "max chunk size: %10llu bytes", (unsigned long long)stats.max_chunk_size);
 
@@ -195,6 +195,11 @@ void	zbx_zabbix_stats_get(struct zbx_json *json, int config_startup_time)
 	zbx_json_adduint64(json, "used", wcache_info.history_total - wcache_info.history_free);
 	zbx_json_addfloat(json, "pused", 100 * (double)(wcache_info.history_total - wcache_info.history_free) /
 			(double)wcache_info.history_total);
+	zbx_json_addfloat(json, "lockwait", wcache_info.history_lock_wait);
+	zbx_json_adduint64(json, "queue", wcache_info.history_queue);
+	zbx_json_addfloat(json, "delay", wcache_info.history_delay);
+	zbx_json_adduint64(json, "copied", wcache_info.history_copied);
+	zbx_json_addfloat(json, "copyrate", wcache_info.history_copy_rate);
 	zbx_json_close(json);
 
 	zbx_json_addobject(json, "index");
@@ -215,6 +220,24 @@ void	zbx_zabbix_stats_get(struct zbx_json *json, int config_startup_time)
 		zbx_json_adduint64(json, "used", wcache_info.trend_total - wcache_info.trend_free);
 		zbx_json_addfloat(json, "pused", 100 * (double)(wcache_info.trend_total - wcache_info.trend_free) /
 				(double)wcache_info.trend_total);
+		zbx_json_adduint64(json, "upserted", wcache_info.trend_upserted);
+		zbx_json_close(json);
+
+		zbx_json_addobject(json, "triggers");
+		zbx_json_adduint64(json, "queue", wcache_info.trigger_queue);
+		zbx_json_addfloat(json, "delay", wcache_info.trigger_delay);
+		zbx_json_adduint64(json, "processed", wcache_info.trigger_processed);
+		zbx_json_addfloat(json, "wait", wcache_info.trigger_wait);
+		zbx_json_close(json);
+
+		zbx_json_addobject(json, "correlation");
+		zbx_json_adduint64(json, "events", wcache_info.corr_stats.events);
+		zbx_json_adduint64(json, "rules", wcache_info.corr_stats.rules);
+		zbx_json_adduint64(json, "skipped", wcache_info.corr_stats.rules_skipped);
+		zbx_json_adduint64(json, "checked", wcache_info.corr_stats.problems_checked);
+		zbx_json_adduint64(json, "matched", wcache_info.corr_stats.matches);
+		zbx_json_adduint64(json, "problems", wcache_info.corr_stats.problems);
+		zbx_json_adduint64(json, "loaded", wcache_info.corr_stats.problems_loaded);
 		zbx_json_close(json);
 	}
 
@@ -24,6 +24,7 @@
 #include "zbxlog.h"
 #include "zbxstr.h"
 #include "zbxtime.h"
+#include "zbxjson.h"
 #include "zbx_rtc_constants.h"
 
 #if defined(ZABBIX_SERVICE)
@@ -36,16 +37,118 @@
 static volatile sig_atomic_t	need_update_userparam;
 #endif
 
-static void	process_listener(zbx_socket_t *s, int config_timeout)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send reply to one key of multiple passive checks request          *
+ *                                                                            *
+ ******************************************************************************/
+static int	send_passive_check_reply(zbx_socket_t *s, const char *tag, const char *value, int config_timeout)
 {
-	AGENT_RESULT	result;
-	char		**value = NULL;
+	struct zbx_json	j;
 	int		ret;
 
+	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
+	zbx_json_addstring(&j, ZBX_PROTO_TAG_VERSION, ZABBIX_VERSION, ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(&j, tag, value, ZBX_JSON_TYPE_STRING);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", j.buffer);
+
+	ret = zbx_tcp_send_to(s, j.buffer, config_timeout);
+
+	zbx_json_free(&j);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process multiple passive checks requested in one message          *
+ *                                                                            *
+ * Parameters: s              - [IN] the connection socket                    *
+ *             jp             - [IN] the request                              *
+ *             config_timeout - [IN]                                          *
+ *                                                                            *
+ * Return value: SUCCEED - the replies were sent                              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: request:                                                         *
+ *             {"request":"passive checks","data":[{"key":"..."},...]}        *
+ *           A separate message is sent as soon as each key is checked, in    *
+ *           the same order as the keys were requested, so the server can     *
+ *           apply timeout to each key instead of the whole request:          *
+ *             {"version":"...","value":"..."} or                             *
+ *             {"version":"...","error":"..."}                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_passive_checks(zbx_socket_t *s, const struct zbx_json_parse *jp, int config_timeout)
+{
+	struct zbx_json_parse	jp_data, jp_row;
+	const char		*p = NULL;
+	char			*key = NULL;
+	size_t			key_alloc = 0;
+	int			ret = SUCCEED;
+
+	if (SUCCEED != zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_DATA, &jp_data))
+		return send_passive_check_reply(s, ZBX_PROTO_TAG_ERROR, zbx_json_strerror(), config_timeout);
+
+	while (SUCCEED == ret && NULL != (p = zbx_json_next(&jp_data, p)))
+	{
+		AGENT_RESULT	result;
+		char		**value;
+
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_row) || SUCCEED != zbx_json_value_by_name_dyn(&jp_row,
+				ZBX_PROTO_TAG_KEY, &key, &key_alloc, NULL))
+		{
+			ret = send_passive_check_reply(s, ZBX_PROTO_TAG_ERROR, "Invalid passive check format.",
+					config_timeout);
+			continue;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", key);
+
+		zbx_init_agent_result(&result);
+
+		if (SUCCEED == zbx_execute_agent_check(key, ZBX_PROCESS_WITH_ALIAS, &result) &&
+				NULL != (value = ZBX_GET_TEXT_RESULT(&result)))
+		{
+			ret = send_passive_check_reply(s, ZBX_PROTO_TAG_VALUE, *value, config_timeout);
+		}
+		else
+		{
+			/* empty error is reported as not supported without the reason */
+			value = ZBX_GET_MSG_RESULT(&result);
+			ret = send_passive_check_reply(s, ZBX_PROTO_TAG_ERROR, NULL != value ? *value : "",
+					config_timeout);
+		}
+
+		zbx_free_agent_result(&result);
+	}
+
+	zbx_free(key);
+
+	return ret;
+}
+
+static void	process_listener(zbx_socket_t *s, int config_timeout)
+{
+	AGENT_RESULT		result;
+	char			**value = NULL, request[MAX_STRING_LEN];
+	int			ret;
+	struct zbx_json_parse	jp;
+
 	if (SUCCEED == (ret = zbx_tcp_recv_to(s, config_timeout)))
 	{
 		zbx_rtrim(s->buffer, "\r\n");
 
+		/* item keys cannot start with '{', so a JSON object is a request of multiple checks */
+		if ('{' == *s->buffer && SUCCEED == zbx_json_open(s->buffer, &jp) &&
+				SUCCEED == zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_REQUEST, request, sizeof(request),
+				NULL) && 0 == strcmp(request, ZBX_PROTO_VALUE_PASSIVE_CHECKS))
+		{
+			ret = process_passive_checks(s, &jp, config_timeout);
+			goto out;
+		}
+
 		zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", s->buffer);
 
 		zbx_init_agent_result(&result);
@@ -90,7 +193,7 @@ static void	process_listener(zbx_socket_t *s, int config_timeout)
 
 		zbx_free_agent_result(&result);
 	}
-
+out:
 	if (FAIL == ret)
 		zabbix_log(LOG_LEVEL_DEBUG, "Process listener error: %s", zbx_socket_strerror());
 }
@@ -206,3 +309,7 @@ ZBX_THREAD_ENTRY(listener_thread, args)
 #endif
 #undef POLL_TIMEOUT
 }
+
+#ifdef HAVE_TESTS
+#	include "../../tests/zabbix_agent/listener/listener_test.c"
+#endif
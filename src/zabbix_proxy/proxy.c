@@ -40,6 +40,7 @@
 #include "housekeeper/housekeeper.h"
 #include "../zabbix_server/pinger/pinger.h"
 #include "../zabbix_server/poller/poller.h"
+#include "../zabbix_server/poller/async_poller.h"
 #include "../zabbix_server/trapper/trapper.h"
 #include "../zabbix_server/trapper/proxydata.h"
 #include "../zabbix_server/snmptrapper/snmptrapper.h"
@@ -100,8 +101,9 @@ const char	*help_message[] = {
 	"                                   target is not specified",
 	"      " ZBX_SNMP_CACHE_RELOAD "          Reload SNMP cache",
 	"      " ZBX_DIAGINFO "=section           Log internal diagnostic information of the",
-	"                                 section (historycache, preprocessing, locks) or",
-	"                                 everything if section is not specified",
+	"                                 section (historycache, preprocessing, locks,",
+	"                                 configcache) or everything if section is not",
+	"                                 specified",
 	"      " ZBX_PROF_ENABLE "=target         Enable profiling, affects all processes if",
 	"                                   target is not specified",
 	"      " ZBX_PROF_DISABLE "=target        Disable profiling, affects all processes if",
@@ -109,22 +111,22 @@ const char	*help_message[] = {
 	"",
 	"      Log level control targets:",
 	"        process-type             All processes of specified type",
-	"                                 (availability manager, configuration syncer, data sender,",
-	"                                 discovery manager, history syncer, housekeeper, http poller,",
-	"                                 icmp pinger, ipmi manager, ipmi poller,",
+	"                                 (agent poller, availability manager, configuration syncer,",
+	"                                 data sender, discovery manager, history syncer, housekeeper,",
+	"                                 http agent poller, http poller, icmp pinger, ipmi manager, ipmi poller,",
 	"                                 java poller, odbc poller, poller, preprocessing manager,",
-	"                                 self-monitoring, snmp trapper, task manager, trapper,",
+	"                                 self-monitoring, snmp poller, snmp trapper, task manager, trapper,",
 	"                                 unreachable poller, vmware collector)",
 	"        process-type,N           Process type and number (e.g., poller,3)",
 	"        pid                      Process identifier",
 	"",
 	"      Profiling control targets:",
 	"        process-type             All processes of specified type",
-	"                                 (availability manager, configuration syncer, data sender,",
-	"                                 discovery manager, history syncer, housekeeper, http poller,",
-	"                                 icmp pinger, ipmi manager, ipmi poller,",
+	"                                 (agent poller, availability manager, configuration syncer,",
+	"                                 data sender, discovery manager, history syncer, housekeeper,",
+	"                                 http agent poller, http poller, icmp pinger, ipmi manager, ipmi poller,",
 	"                                 java poller, odbc poller, poller, preprocessing manager,",
-	"                                 self-monitoring, snmp trapper, task manager, trapper,",
+	"                                 self-monitoring, snmp poller, snmp trapper, task manager, trapper,",
 	"                                 unreachable poller, vmware collector)",
 	"        process-type,N           Process type and number (e.g., history syncer,1)",
 	"        pid                      Process identifier",
@@ -239,6 +241,10 @@ int	CONFIG_FORKS[ZBX_PROCESS_TYPE_COUNT] = {
 	0, /* ZBX_PROCESS_TYPE_CONNECTORMANAGER */
 	0, /* ZBX_PROCESS_TYPE_CONNECTORWORKER */
 	0, /* ZBX_PROCESS_TYPE_DISCOVERYMANAGER */
+	0, /* ZBX_PROCESS_TYPE_AGENT_POLLER */
+	0, /* ZBX_PROCESS_TYPE_SNMP_POLLER */
+	0, /* ZBX_PROCESS_TYPE_HTTPAGENT_POLLER */
+	0, /* ZBX_PROCESS_TYPE_TRIGGEREVAL */
 };
 
 static int	get_config_forks(unsigned char process_type)
@@ -277,11 +283,15 @@ int	CONFIG_VMWARE_TIMEOUT		= 10;
 static zbx_uint64_t	config_conf_cache_size		= 8 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_cache_size	= 16 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_index_cache_size	= 4 * ZBX_MEBIBYTE;
+static int		config_history_cache_shards	= 1;
+static zbx_uint64_t	config_preprocessing_ring_size	= 0;
 static zbx_uint64_t	config_trends_cache_size	= 0;
 zbx_uint64_t	CONFIG_VMWARE_CACHE_SIZE	= 8 * ZBX_MEBIBYTE;
 
 static int	config_unreachable_period	= 45;
 static int	config_unreachable_delay	= 15;
+static int	config_max_concurrent_checks_per_poller	= 1000;
+static int	config_max_connections_per_trapper	= 1;
 int	CONFIG_LOG_LEVEL		= LOG_LEVEL_WARNING;
 char	*CONFIG_EXTERNALSCRIPTS		= NULL;
 int	CONFIG_ALLOW_UNSUPPORTED_DB_VERSIONS = 0;
@@ -457,6 +467,22 @@ int	get_process_info_by_thread(int local_server_num, unsigned char *local_proces
 		*local_process_type = ZBX_PROCESS_TYPE_ODBCPOLLER;
 		*local_process_num = local_server_num - server_count + CONFIG_FORKS[ZBX_PROCESS_TYPE_ODBCPOLLER];
 	}
+	else if (local_server_num <= (server_count += CONFIG_FORKS[ZBX_PROCESS_TYPE_AGENT_POLLER]))
+	{
+		*local_process_type = ZBX_PROCESS_TYPE_AGENT_POLLER;
+		*local_process_num = local_server_num - server_count + CONFIG_FORKS[ZBX_PROCESS_TYPE_AGENT_POLLER];
+	}
+	else if (local_server_num <= (server_count += CONFIG_FORKS[ZBX_PROCESS_TYPE_SNMP_POLLER]))
+	{
+		*local_process_type = ZBX_PROCESS_TYPE_SNMP_POLLER;
+		*local_process_num = local_server_num - server_count + CONFIG_FORKS[ZBX_PROCESS_TYPE_SNMP_POLLER];
+	}
+	else if (local_server_num <= (server_count += CONFIG_FORKS[ZBX_PROCESS_TYPE_HTTPAGENT_POLLER]))
+	{
+		*local_process_type = ZBX_PROCESS_TYPE_HTTPAGENT_POLLER;
+		*local_process_num = local_server_num - server_count +
+				CONFIG_FORKS[ZBX_PROCESS_TYPE_HTTPAGENT_POLLER];
+	}
 	else
 		return FAIL;
 
@@ -608,6 +634,14 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		err = 1;
 	}
 
+	if (0 != config_preprocessing_ring_size && (64 * ZBX_KIBIBYTE > config_preprocessing_ring_size ||
+			0 != (config_preprocessing_ring_size & (config_preprocessing_ring_size - 1))))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"PreprocessingRingSize\" configuration parameter must be either 0"
+				" or a power of two not less than 64KB");
+		err = 1;
+	}
+
 	if (ZBX_PROXYMODE_ACTIVE == config_proxymode)
 	{
 		if (NULL != strchr(config_server, ','))
@@ -785,6 +819,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryIndexCacheSize",	&config_history_index_cache_size,	TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryCacheShards",		&config_history_cache_shards,		TYPE_INT,
+			PARM_OPT,	1,			ZBX_HC_SHARDS_MAX},
 		{"HousekeepingFrequency",	&config_housekeeping_frequency,		TYPE_INT,
 			PARM_OPT,	0,			24},
 		{"ProxyLocalBuffer",		&config_proxy_local_buffer,		TYPE_INT,
@@ -943,10 +979,22 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"StartPreprocessors",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_PREPROCESSOR],		TYPE_INT,
 			PARM_OPT,	1,			1000},
+		{"PreprocessingRingSize",	&config_preprocessing_ring_size,	TYPE_UINT64,
+			PARM_OPT,	0,			64 * ZBX_MEBIBYTE},
 		{"ListenBacklog",		&CONFIG_TCP_MAX_BACKLOG_SIZE,		TYPE_INT,
 			PARM_OPT,	0,			INT_MAX},
 		{"StartODBCPollers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_ODBCPOLLER],		TYPE_INT,
 			PARM_OPT,	0,			1000},
+		{"StartAgentPollers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_AGENT_POLLER],		TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartSNMPPollers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_SNMP_POLLER],		TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartHTTPAgentPollers",	&CONFIG_FORKS[ZBX_PROCESS_TYPE_HTTPAGENT_POLLER],	TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"MaxConcurrentChecksPerPoller",	&config_max_concurrent_checks_per_poller,	TYPE_INT,
+			PARM_OPT,	1,			1000},
+		{"MaxConnectionsPerTrapper",	&config_max_connections_per_trapper,		TYPE_INT,
+			PARM_OPT,	1,			1000},
 		{NULL}
 	};
 
@@ -1162,7 +1210,7 @@ int	main(int argc, char **argv)
 			get_zbx_config_source_ip);
 	zbx_init_library_stats(get_program_type);
 	zbx_init_library_dbhigh(zbx_config_dbhigh);
-	zbx_init_library_preproc(preproc_flush_value_proxy);
+	zbx_init_library_preproc(preproc_flush_value_proxy, config_preprocessing_ring_size);
 
 	if (ZBX_TASK_RUNTIME_CONTROL == t.task)
 	{
@@ -1279,7 +1327,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 								zbx_config_source_ip};
 	zbx_thread_args_t			thread_args;
 	zbx_thread_poller_args			poller_args = {&config_comms, get_program_type, ZBX_NO_POLLER,
-								config_startup_time, config_unavailable_delay, 0, 0};
+								config_startup_time, config_unavailable_delay, 0, 0,
+								config_max_concurrent_checks_per_poller};
 	zbx_thread_proxyconfig_args		proxyconfig_args = {zbx_config_tls, &zbx_config_vault,
 								get_program_type, zbx_config_timeout,
 								&config_server_addrs, config_hostname,
@@ -1290,13 +1339,15 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	zbx_thread_taskmanager_args		taskmanager_args = {&config_comms, get_program_type,
 								config_startup_time, zbx_config_enable_remote_commands,
 								zbx_config_log_remote_commands, config_hostname};
-	zbx_thread_httppoller_args		httppoller_args = {zbx_config_source_ip};
+	zbx_thread_httppoller_args		httppoller_args = {zbx_config_source_ip,
+								config_max_concurrent_checks_per_poller};
 	zbx_thread_discoverer_args		discoverer_args = {zbx_config_tls, get_program_type, zbx_config_timeout,
 								CONFIG_FORKS[ZBX_PROCESS_TYPE_DISCOVERER],
 								zbx_config_source_ip, &events_cbs};
 	zbx_thread_trapper_args			trapper_args = {&config_comms, &zbx_config_vault, get_program_type,
 								&events_cbs, &listen_sock, config_startup_time,
-								config_proxydata_frequency};
+								config_proxydata_frequency,
+								config_max_connections_per_trapper};
 	zbx_thread_proxy_housekeeper_args	housekeeper_args = {zbx_config_timeout, config_housekeeping_frequency,
 								config_proxy_local_buffer, config_proxy_offline_buffer};
 	zbx_thread_pinger_args			pinger_args = {zbx_config_timeout};
@@ -1422,7 +1473,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	}
 
 	if (SUCCEED != zbx_init_database_cache(get_program_type, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, config_history_cache_shards, 0, 0, &config_trends_cache_size,
+			&error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
@@ -1638,6 +1690,21 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 				thread_args.args = &poller_args;
 				zbx_thread_start(poller_thread, &thread_args, &threads[i]);
 				break;
+			case ZBX_PROCESS_TYPE_AGENT_POLLER:
+				poller_args.poller_type = ZBX_POLLER_TYPE_AGENT;
+				thread_args.args = &poller_args;
+				zbx_thread_start(async_poller_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_SNMP_POLLER:
+				poller_args.poller_type = ZBX_POLLER_TYPE_SNMP;
+				thread_args.args = &poller_args;
+				zbx_thread_start(async_poller_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_HTTPAGENT_POLLER:
+				poller_args.poller_type = ZBX_POLLER_TYPE_HTTPAGENT;
+				thread_args.args = &poller_args;
+				zbx_thread_start(async_poller_thread, &thread_args, &threads[i]);
+				break;
 		}
 	}
 
@@ -1238,6 +1238,8 @@ static void	discover_icmp(zbx_uint64_t druleid, const zbx_discoverer_task_t *tas
 		ZBX_FPING_HOST			*h = &hosts.values[i];
 		zbx_discoverer_dservice_t	service_cmp;
 
+		zbx_free(h->error);
+
 		result_cmp.ip = h->addr;
 		result_cmp.druleid = druleid;
 
@@ -37,6 +37,7 @@
 #include "zbxvariant.h"
 #include "zbxconnector.h"
 #include "zbxtagfilter.h"
+#include "zbxcachehistory.h"
 
 /* event recovery data */
 typedef struct
@@ -69,10 +70,120 @@ typedef enum
 }
 zbx_correlation_match_result_t;
 
+/* correlation rules that can match only events having the tag */
+typedef struct
+{
+	const char		*tag;
+	zbx_vector_ptr_t	correlations;
+}
+zbx_corr_index_tag_t;
+
+/* correlation rules that can match only events from hosts in the group */
+typedef struct
+{
+	zbx_uint64_t		groupid;
+	zbx_vector_ptr_t	correlations;
+}
+zbx_corr_index_group_t;
+
+/* host group used in correlation conditions with its nested groups */
+typedef struct
+{
+	zbx_uint64_t		groupid;
+	zbx_vector_uint64_t	nested_groupids;
+}
+zbx_corr_hostgroup_t;
+
+/* global correlation rule index, rebuilt whenever correlation rules are refreshed */
+typedef struct
+{
+	/* new event tag name -> rules that cannot match events without this tag */
+	zbx_hashset_t		tags;
+	/* host group -> rules that cannot match events from hosts outside this group */
+	zbx_hashset_t		groups;
+	/* nested groups of host groups used in correlation conditions */
+	zbx_hashset_t		hostgroups;
+	/* rules that must be checked for every new event */
+	zbx_vector_ptr_t	common;
+	/* tag names used by old event conditions */
+	zbx_vector_str_t	old_tags;
+
+	int			sync_ts;
+}
+zbx_corr_index_t;
+
+/* open problem, used to match old event conditions */
+typedef struct
+{
+	zbx_uint64_t		eventid;
+	zbx_uint64_t		objectid;
+
+	/* only tags used by old event conditions are loaded */
+	zbx_vector_tags_t	tags;
+
+	/* the problem is no longer open, it is removed from index when index is compacted */
+	unsigned char		closed;
+}
+zbx_corr_problem_t;
+
+/* open problems having the tag name (value is NULL) or the tag name and value */
+typedef struct
+{
+	const char		*tag;
+	const char		*value;
+	zbx_vector_ptr_t	problems;
+}
+zbx_corr_problem_tag_t;
+
+/* host groups of the trigger hosts */
+typedef struct
+{
+	zbx_uint64_t		triggerid;
+	zbx_vector_uint64_t	groupids;
+}
+zbx_corr_trigger_groups_t;
+
+/* open trigger problems indexed by tags used in old event conditions, kept between event batches */
+typedef struct
+{
+	zbx_hashset_t		problems;
+	zbx_vector_ptr_t	problems_sorted;
+	zbx_hashset_t		problem_tags;
+	int			loaded;
+	int			closed_num;
+}
+zbx_corr_problems_t;
+
+/* correlation data cached while processing a batch of new events */
+typedef struct
+{
+	/* open problems are synced once per batch when first required */
+	int			problems_synced;
+
+	/* host groups of triggers that generated new events, loaded once per batch when first required */
+	zbx_vector_uint64_t	triggerids;
+	zbx_hashset_t		trigger_groups;
+	int			groups_loaded;
+
+	/* statistics */
+	int			events_num;
+	int			rules_num;
+	int			rules_skipped;
+	int			problems_checked;
+	int			matches_num;
+	int			problems_loaded;
+}
+zbx_corr_batch_t;
+
 static zbx_vector_ptr_t		events;
 static zbx_hashset_t		event_recovery;
 static zbx_hashset_t		correlation_cache;
 static zbx_correlation_rules_t	correlation_rules;
+static zbx_corr_index_t		correlation_index;
+static zbx_corr_batch_t		correlation_batch;
+static zbx_corr_problems_t	correlation_problems;
+
+static void	correlation_problems_add(const zbx_vector_ptr_t *problem_events);
 
 /******************************************************************************
  *                                                                            *
@@ -558,6 +669,8 @@ static void	save_problems(void)
 			zbx_db_insert_execute(&db_insert);
 			zbx_db_insert_clean(&db_insert);
 		}
+
+		correlation_problems_add(&problems);
 	}
 
 	zbx_vector_ptr_destroy(&problems);
@@ -612,6 +725,7 @@ static void	save_event_recovery(void)
 				recovery->eventid);
 
 		zbx_db_execute_overflowed_sql(&sql, &sql_alloc, &sql_offset);
+
 	}
 
 	zbx_db_insert_execute(&db_insert);
@@ -652,6 +766,158 @@ static zbx_db_event	*get_event_by_source_object_id(int source, int object, zbx_u
 	return NULL;
 }
 
+static zbx_hash_t	corr_index_tag_hash_func(const void *data)
+{
+	const zbx_corr_index_tag_t	*index_tag = (const zbx_corr_index_tag_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(index_tag->tag);
+}
+
+static int	corr_index_tag_compare_func(const void *d1, const void *d2)
+{
+	const zbx_corr_index_tag_t	*index_tag1 = (const zbx_corr_index_tag_t *)d1;
+	const zbx_corr_index_tag_t	*index_tag2 = (const zbx_corr_index_tag_t *)d2;
+
+	return strcmp(index_tag1->tag, index_tag2->tag);
+}
+
+static void	corr_index_tag_clean(zbx_corr_index_tag_t *index_tag)
+{
+	zbx_vector_ptr_destroy(&index_tag->correlations);
+}
+
+static void	corr_index_group_clean(zbx_corr_index_group_t *index_group)
+{
+	zbx_vector_ptr_destroy(&index_group->correlations);
+}
+
+static void	corr_hostgroup_clean(zbx_corr_hostgroup_t *hostgroup)
+{
+	zbx_vector_uint64_destroy(&hostgroup->nested_groupids);
+}
+
+static zbx_hash_t	corr_problem_tag_hash_func(const void *data)
+{
+	const zbx_corr_problem_tag_t	*problem_tag = (const zbx_corr_problem_tag_t *)data;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_STRING_HASH_FUNC(problem_tag->tag);
+
+	if (NULL != problem_tag->value)
+		hash = ZBX_DEFAULT_STRING_HASH_ALGO(problem_tag->value, strlen(problem_tag->value), hash);
+
+	return hash;
+}
+
+static int	corr_problem_tag_compare_func(const void *d1, const void *d2)
+{
+	const zbx_corr_problem_tag_t	*problem_tag1 = (const zbx_corr_problem_tag_t *)d1;
+	const zbx_corr_problem_tag_t	*problem_tag2 = (const zbx_corr_problem_tag_t *)d2;
+	int				ret;
+
+	if (0 != (ret = strcmp(problem_tag1->tag, problem_tag2->tag)))
+		return ret;
+
+	if (NULL == problem_tag1->value || NULL == problem_tag2->value)
+	{
+		ZBX_RETURN_IF_NOT_EQUAL(problem_tag1->value, problem_tag2->value);
+		return 0;
+	}
+
+	return strcmp(problem_tag1->value, problem_tag2->value);
+}
+
+static void	corr_problem_tag_clean(zbx_corr_problem_tag_t *problem_tag)
+{
+	zbx_vector_ptr_destroy(&problem_tag->problems);
+}
+
+static void	corr_problem_clean(zbx_corr_problem_t *problem)
+{
+	zbx_vector_tags_clear_ext(&problem->tags, zbx_free_tag);
+	zbx_vector_tags_destroy(&problem->tags);
+}
+
+static void	corr_trigger_groups_clean(zbx_corr_trigger_groups_t *trigger_groups)
+{
+	zbx_vector_uint64_destroy(&trigger_groups->groupids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads host groups of triggers that generated new events in the    *
+ *          current batch                                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_batch_load_trigger_groups(void)
+{
+	zbx_db_result_t			result;
+	zbx_db_row_t			row;
+	char				*sql = NULL;
+	size_t				sql_alloc = 0, sql_offset = 0;
+	zbx_uint64_t			triggerid, groupid;
+	zbx_corr_trigger_groups_t	*trigger_groups, trigger_groups_local;
+	zbx_hashset_iter_t		iter;
+
+	correlation_batch.groups_loaded = SUCCEED;
+
+	if (0 == correlation_batch.triggerids.values_num)
+		return;
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select distinct f.triggerid,hg.groupid"
+			" from functions f,items i,hosts_groups hg"
+			" where i.itemid=f.itemid"
+				" and hg.hostid=i.hostid"
+				" and");
+
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "f.triggerid", correlation_batch.triggerids.values,
+			correlation_batch.triggerids.values_num);
+
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(triggerid, row[0]);
+		ZBX_STR2UINT64(groupid, row[1]);
+
+		if (NULL == (trigger_groups = (zbx_corr_trigger_groups_t *)zbx_hashset_search(
+				&correlation_batch.trigger_groups, &triggerid)))
+		{
+			trigger_groups_local.triggerid = triggerid;
+			trigger_groups = (zbx_corr_trigger_groups_t *)zbx_hashset_insert(&correlation_batch.trigger_groups,
+					&trigger_groups_local, sizeof(trigger_groups_local));
+			zbx_vector_uint64_create(&trigger_groups->groupids);
+		}
+
+		zbx_vector_uint64_append(&trigger_groups->groupids, groupid);
+	}
+	zbx_db_free_result(result);
+	zbx_free(sql);
+
+	zbx_hashset_iter_reset(&correlation_batch.trigger_groups, &iter);
+	while (NULL != (trigger_groups = (zbx_corr_trigger_groups_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_uint64_sort(&trigger_groups->groupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets host groups of the trigger that generated new event          *
+ *                                                                            *
+ * Parameters: triggerid - [IN]                                               *
+ *                                                                            *
+ * Return value: the trigger host groups or NULL if trigger hosts are not     *
+ *               in any group                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_corr_trigger_groups_t	*correlation_get_trigger_groups(zbx_uint64_t triggerid)
+{
+	if (SUCCEED != correlation_batch.groups_loaded)
+		correlation_batch_load_trigger_groups();
+
+	return (const zbx_corr_trigger_groups_t *)zbx_hashset_search(&correlation_batch.trigger_groups, &triggerid);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: checks if the event matches the specified host group              *
@@ -666,37 +932,30 @@ static zbx_db_event	*get_event_by_source_object_id(int source, int object, zbx_u
  ******************************************************************************/
 static int	correlation_match_event_hostgroup(const zbx_db_event *event, zbx_uint64_t groupid)
 {
-	zbx_db_result_t		result;
-	int			ret = FAIL;
-	zbx_vector_uint64_t	groupids;
-	char			*sql = NULL;
-	size_t			sql_alloc = 0, sql_offset = 0;
+	const zbx_corr_hostgroup_t		*hostgroup;
+	const zbx_corr_trigger_groups_t	*trigger_groups;
+	int					i;
 
-	zbx_vector_uint64_create(&groupids);
-	zbx_dc_get_nested_hostgroupids(&groupid, 1, &groupids);
-
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-			"select hg.groupid"
-				" from hstgrp g,hosts_groups hg,items i,functions f"
-				" where f.triggerid=" ZBX_FS_UI64
-				" and i.itemid=f.itemid"
-				" and hg.hostid=i.hostid"
-				" and",
-				event->objectid);
-
-	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "hg.groupid", groupids.values,
-			groupids.values_num);
-
-	result = zbx_db_select("%s", sql);
+	if (NULL == (hostgroup = (const zbx_corr_hostgroup_t *)zbx_hashset_search(&correlation_index.hostgroups,
+			&groupid)))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return FAIL;
+	}
 
-	if (NULL != zbx_db_fetch(result))
-		ret = SUCCEED;
+	if (NULL == (trigger_groups = correlation_get_trigger_groups(event->objectid)))
+		return FAIL;
 
-	zbx_db_free_result(result);
-	zbx_free(sql);
-	zbx_vector_uint64_destroy(&groupids);
+	for (i = 0; i < trigger_groups->groupids.values_num; i++)
+	{
+		if (FAIL != zbx_vector_uint64_bsearch(&hostgroup->nested_groupids, trigger_groups->groupids.values[i],
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		{
+			return SUCCEED;
+		}
+	}
 
-	return ret;
+	return FAIL;
 }
 
 /******************************************************************************
@@ -779,12 +1038,135 @@ static const char	*correlation_condition_match_new_event(const zbx_corr_conditio
 	return "0";
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the correlation condition matches the new event and     *
+ *          open problem                                                      *
+ *                                                                            *
+ * Parameters: condition - [IN] correlation condition to check                *
+ *             event     - [IN] new event to match                            *
+ *             problem   - [IN] open problem to match                         *
+ *                                                                            *
+ * Return value: "1" - correlation condition matches                          *
+ *               "0" - otherwise                                              *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*correlation_condition_match_problem(const zbx_corr_condition_t *condition,
+		const zbx_db_event *event, const zbx_corr_problem_t *problem)
+{
+	int				i, j, ret = FAIL;
+	const zbx_tag_t			*tag, *old_tag;
+	const zbx_corr_condition_tag_value_t	*cond;
+	unsigned char			op;
+
+	switch (condition->type)
+	{
+		case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
+			for (i = 0; i < problem->tags.values_num; i++)
+			{
+				old_tag = problem->tags.values[i];
+
+				if (0 == strcmp(old_tag->tag, condition->data.tag.tag))
+					return "1";
+			}
+			return "0";
+
+		case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
+			cond = &condition->data.tag_value;
+
+			/* negative operators match problems without matching tag, see the positive operator */
+			switch (cond->op)
+			{
+				case ZBX_CONDITION_OPERATOR_NOT_EQUAL:
+					op = ZBX_CONDITION_OPERATOR_EQUAL;
+					break;
+				case ZBX_CONDITION_OPERATOR_NOT_LIKE:
+					op = ZBX_CONDITION_OPERATOR_LIKE;
+					break;
+				default:
+					op = cond->op;
+			}
+
+			for (i = 0; i < problem->tags.values_num; i++)
+			{
+				old_tag = problem->tags.values[i];
+
+				if (0 == strcmp(old_tag->tag, cond->tag) &&
+						SUCCEED == zbx_strmatch_condition(old_tag->value, cond->value, op))
+				{
+					ret = SUCCEED;
+					break;
+				}
+			}
+
+			if (op != cond->op)
+				return (SUCCEED == ret ? "0" : "1");
+
+			return (SUCCEED == ret ? "1" : "0");
+
+		case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
+			for (i = 0; i < event->tags.values_num; i++)
+			{
+				tag = event->tags.values[i];
+
+				if (0 != strcmp(tag->tag, condition->data.tag_pair.newtag))
+					continue;
+
+				for (j = 0; j < problem->tags.values_num; j++)
+				{
+					old_tag = problem->tags.values[j];
+
+					if (0 == strcmp(old_tag->tag, condition->data.tag_pair.oldtag) &&
+							0 == strcmp(old_tag->value, tag->value))
+					{
+						return "1";
+					}
+				}
+			}
+			return "0";
+	}
+
+	return correlation_condition_match_new_event(condition, event, FAIL);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets correlation condition value used to index correlation rules  *
+ *                                                                            *
+ * Parameters: condition - [IN] correlation condition                         *
+ *                                                                            *
+ * Return value: "0"            - condition cannot match events without the   *
+ *                                condition tag or host group                 *
+ *               "ZBX_UNKNOWN " - condition might match any event             *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*correlation_condition_get_index_value(const zbx_corr_condition_t *condition)
+{
+	switch (condition->type)
+	{
+		case ZBX_CORR_CONDITION_NEW_EVENT_TAG:
+		case ZBX_CORR_CONDITION_NEW_EVENT_TAG_VALUE:
+		case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
+			return "0";
+		case ZBX_CORR_CONDITION_NEW_EVENT_HOSTGROUP:
+			if (ZBX_CONDITION_OPERATOR_EQUAL == condition->data.group.op)
+				return "0";
+			break;
+	}
+
+	return ZBX_UNKNOWN_STR "0";
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: checks if the correlation rule might match the new event          *
  *                                                                            *
  * Parameters: correlation - [IN] correlation rule to check                   *
- *             event       - [IN] new event to match                          *
+ *             event       - [IN] new event to match, NULL to check if the    *
+ *                                rule can match events without tags and      *
+ *                                host groups used in its conditions          *
+ *             problem     - [IN] open problem to match, NULL to match only   *
+ *                                the new event                               *
  *             old_value   - [IN] SUCCEED - old event conditions may          *
  *                                          match event                       *
  *                                FAIL    - old event conditions never        *
@@ -796,8 +1178,8 @@ static const char	*correlation_condition_match_new_event(const zbx_corr_conditio
  *               CORRELATION_NO_MATCH  - correlation rule doesn't match       *
  *                                                                            *
  ******************************************************************************/
-static zbx_correlation_match_result_t	correlation_match_new_event(const zbx_correlation_t *correlation,
-		const zbx_db_event *event, int old_value)
+static zbx_correlation_match_result_t	correlation_match_event(const zbx_correlation_t *correlation,
+		const zbx_db_event *event, const zbx_corr_problem_t *problem, int old_value)
 {
 	char				*expression, error[256];
 	const char			*value;
@@ -809,281 +1191,781 @@ static zbx_correlation_match_result_t	correlation_match_new_event(const zbx_corr
 	zbx_correlation_match_result_t	ret = CORRELATION_NO_MATCH;
 
 	if ('\0' == *correlation->formula)
-		return CORRELATION_MAY_MATCH;
+		return (NULL == problem ? CORRELATION_MAY_MATCH : CORRELATION_MATCH);
 
 	expression = zbx_strdup(NULL, correlation->formula);
 
-	for (; SUCCEED == zbx_token_find(expression, pos, &token, ZBX_TOKEN_SEARCH_BASIC); pos++)
+	for (; SUCCEED == zbx_token_find(expression, pos, &token, ZBX_TOKEN_SEARCH_BASIC); pos++)
+	{
+		const zbx_corr_condition_t	*condition;
+
+		if (ZBX_TOKEN_OBJECTID != token.type)
+			continue;
+
+		loc = &token.data.objectid.name;
+
+		if (SUCCEED != zbx_is_uint64_n(expression + loc->l, loc->r - loc->l + 1, &conditionid))
+			continue;
+
+		if (NULL == (condition = (zbx_corr_condition_t *)zbx_hashset_search(&correlation_rules.conditions,
+				&conditionid)))
+			goto out;
+
+		if (NULL == event)
+			value = correlation_condition_get_index_value(condition);
+		else if (NULL != problem)
+			value = correlation_condition_match_problem(condition, event, problem);
+		else
+			value = correlation_condition_match_new_event(condition, event, old_value);
+
+		zbx_replace_string(&expression, token.loc.l, &token.loc.r, value);
+		pos = token.loc.r;
+	}
+
+	if (SUCCEED == zbx_evaluate_unknown(expression, &result, error, sizeof(error)))
+	{
+		if (result == ZBX_UNKNOWN)
+			ret = CORRELATION_MAY_MATCH;
+		else if (SUCCEED == zbx_double_compare(result, 1))
+			ret = CORRELATION_MATCH;
+	}
+
+out:
+	zbx_free(expression);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds correlation rule to the index                                *
+ *                                                                            *
+ * Parameters: correlation - [IN] correlation rule to index                   *
+ *             tags        - [IN/OUT] new event tag names used by the rule    *
+ *                                    conditions                              *
+ *             groupids    - [IN/OUT] host groups (including nested groups)   *
+ *                                    used by the rule 'equal' conditions     *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_index_add_rule(zbx_correlation_t *correlation, zbx_vector_str_t *tags,
+		zbx_vector_uint64_t *groupids)
+{
+	int			i;
+	zbx_corr_index_tag_t	*index_tag, index_tag_local;
+	zbx_corr_index_group_t	*index_group, index_group_local;
+
+	/* rules with empty formula or those that might match without */
+	/* the indexed tags or host groups are checked for all events */
+	if ('\0' == *correlation->formula || CORRELATION_NO_MATCH != correlation_match_event(correlation, NULL, NULL,
+			FAIL))
+	{
+		zbx_vector_ptr_append(&correlation_index.common, correlation);
+		return;
+	}
+
+	zbx_vector_str_sort(tags, ZBX_DEFAULT_STR_COMPARE_FUNC);
+	zbx_vector_str_uniq(tags, ZBX_DEFAULT_STR_COMPARE_FUNC);
+
+	for (i = 0; i < tags->values_num; i++)
+	{
+		index_tag_local.tag = tags->values[i];
+
+		if (NULL == (index_tag = (zbx_corr_index_tag_t *)zbx_hashset_search(&correlation_index.tags,
+				&index_tag_local)))
+		{
+			index_tag = (zbx_corr_index_tag_t *)zbx_hashset_insert(&correlation_index.tags, &index_tag_local,
+					sizeof(index_tag_local));
+			zbx_vector_ptr_create(&index_tag->correlations);
+		}
+
+		zbx_vector_ptr_append(&index_tag->correlations, correlation);
+	}
+
+	zbx_vector_uint64_sort(groupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(groupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (i = 0; i < groupids->values_num; i++)
+	{
+		index_group_local.groupid = groupids->values[i];
+
+		if (NULL == (index_group = (zbx_corr_index_group_t *)zbx_hashset_search(&correlation_index.groups,
+				&index_group_local)))
+		{
+			index_group = (zbx_corr_index_group_t *)zbx_hashset_insert(&correlation_index.groups,
+					&index_group_local, sizeof(index_group_local));
+			zbx_vector_ptr_create(&index_group->correlations);
+		}
+
+		zbx_vector_ptr_append(&index_group->correlations, correlation);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: rebuilds correlation rule index after correlation rules have been *
+ *          refreshed                                                         *
+ *                                                                            *
+ * Comments: Rules that cannot match events without specific tags or from     *
+ *           hosts outside specific host groups are indexed by those tags and *
+ *           host groups, so only candidate rules are checked for new events. *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_index_update(void)
+{
+	int			i, j;
+	zbx_vector_str_t	tags;
+	zbx_vector_uint64_t	groupids;
+	zbx_corr_hostgroup_t	*hostgroup, hostgroup_local;
+
+	if (correlation_index.sync_ts == correlation_rules.sync_ts)
+		return;
+
+	/* indexed problem tags depend on old event tags used in correlation rules */
+	correlation_problems.loaded = FAIL;
+
+	zbx_hashset_clear(&correlation_index.tags);
+	zbx_hashset_clear(&correlation_index.groups);
+	zbx_hashset_clear(&correlation_index.hostgroups);
+	zbx_vector_ptr_clear(&correlation_index.common);
+	zbx_vector_str_clear(&correlation_index.old_tags);
+
+	zbx_vector_str_create(&tags);
+	zbx_vector_uint64_create(&groupids);
+
+	for (i = 0; i < correlation_rules.correlations.values_num; i++)
+	{
+		zbx_correlation_t	*correlation = (zbx_correlation_t *)correlation_rules.correlations.values[i];
+
+		for (j = 0; j < correlation->conditions.values_num; j++)
+		{
+			const zbx_corr_condition_t	*condition;
+
+			condition = (const zbx_corr_condition_t *)correlation->conditions.values[j];
+
+			switch (condition->type)
+			{
+				case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
+					zbx_vector_str_append(&correlation_index.old_tags, condition->data.tag.tag);
+					break;
+				case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
+					zbx_vector_str_append(&correlation_index.old_tags, condition->data.tag_value.tag);
+					break;
+				case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
+					zbx_vector_str_append(&correlation_index.old_tags,
+							condition->data.tag_pair.oldtag);
+					zbx_vector_str_append(&tags, condition->data.tag_pair.newtag);
+					break;
+				case ZBX_CORR_CONDITION_NEW_EVENT_TAG:
+					zbx_vector_str_append(&tags, condition->data.tag.tag);
+					break;
+				case ZBX_CORR_CONDITION_NEW_EVENT_TAG_VALUE:
+					zbx_vector_str_append(&tags, condition->data.tag_value.tag);
+					break;
+				case ZBX_CORR_CONDITION_NEW_EVENT_HOSTGROUP:
+					hostgroup_local.groupid = condition->data.group.groupid;
+
+					if (NULL == (hostgroup = (zbx_corr_hostgroup_t *)zbx_hashset_search(
+							&correlation_index.hostgroups, &hostgroup_local)))
+					{
+						hostgroup = (zbx_corr_hostgroup_t *)zbx_hashset_insert(
+								&correlation_index.hostgroups, &hostgroup_local,
+								sizeof(hostgroup_local));
+
+						zbx_vector_uint64_create(&hostgroup->nested_groupids);
+						zbx_dc_get_nested_hostgroupids(&hostgroup->groupid, 1,
+								&hostgroup->nested_groupids);
+						zbx_vector_uint64_sort(&hostgroup->nested_groupids,
+								ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+						zbx_vector_uint64_uniq(&hostgroup->nested_groupids,
+								ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+					}
+
+					if (ZBX_CONDITION_OPERATOR_EQUAL == condition->data.group.op)
+					{
+						zbx_vector_uint64_append_array(&groupids, hostgroup->nested_groupids.values,
+								hostgroup->nested_groupids.values_num);
+					}
+					break;
+			}
+		}
+
+		correlation_index_add_rule(correlation, &tags, &groupids);
+
+		zbx_vector_str_clear(&tags);
+		zbx_vector_uint64_clear(&groupids);
+	}
+
+	zbx_vector_str_sort(&correlation_index.old_tags, ZBX_DEFAULT_STR_COMPARE_FUNC);
+	zbx_vector_str_uniq(&correlation_index.old_tags, ZBX_DEFAULT_STR_COMPARE_FUNC);
+
+	zbx_vector_uint64_destroy(&groupids);
+	zbx_vector_str_destroy(&tags);
+
+	correlation_index.sync_ts = correlation_rules.sync_ts;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() rules:%d common:%d tags:%d groups:%d", __func__,
+			correlation_rules.correlations.values_num, correlation_index.common.values_num,
+			correlation_index.tags.num_data, correlation_index.groups.num_data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets correlation rules that might match the new event             *
+ *                                                                            *
+ * Parameters: event        - [IN] new event                                  *
+ *             correlations - [OUT] candidate rules sorted by correlationid   *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_index_get_rules(const zbx_db_event *event, zbx_vector_ptr_t *correlations)
+{
+	int				i;
+	const zbx_corr_index_tag_t	*index_tag;
+	zbx_corr_index_tag_t		index_tag_local;
+	const zbx_corr_index_group_t	*index_group;
+	const zbx_corr_trigger_groups_t	*trigger_groups;
+
+	zbx_vector_ptr_append_array(correlations, correlation_index.common.values,
+			correlation_index.common.values_num);
+
+	for (i = 0; i < event->tags.values_num; i++)
+	{
+		index_tag_local.tag = event->tags.values[i]->tag;
+
+		if (NULL != (index_tag = (const zbx_corr_index_tag_t *)zbx_hashset_search(&correlation_index.tags,
+				&index_tag_local)))
+		{
+			zbx_vector_ptr_append_array(correlations, index_tag->correlations.values,
+					index_tag->correlations.values_num);
+		}
+	}
+
+	if (0 != correlation_index.groups.num_data &&
+			NULL != (trigger_groups = correlation_get_trigger_groups(event->objectid)))
+	{
+		for (i = 0; i < trigger_groups->groupids.values_num; i++)
+		{
+			if (NULL != (index_group = (const zbx_corr_index_group_t *)zbx_hashset_search(
+					&correlation_index.groups, &trigger_groups->groupids.values[i])))
+			{
+				zbx_vector_ptr_append_array(correlations, index_group->correlations.values,
+						index_group->correlations.values_num);
+			}
+		}
+	}
+
+	zbx_vector_ptr_sort(correlations, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+	zbx_vector_ptr_uniq(correlations, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+}
+
+#define ZBX_CORR_OPERATION_CLOSE_OLD	0
+#define ZBX_CORR_OPERATION_CLOSE_NEW	1
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if correlation has operations to change old events         *
+ *                                                                            *
+ * Parameters: correlation - [IN] correlation to check                        *
+ *                                                                            *
+ * Return value: SUCCEED - correlation has operations to change old events    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	correlation_has_old_event_operation(const zbx_correlation_t *correlation)
+{
+	int				i;
+	const zbx_corr_operation_t	*operation;
+
+	for (i = 0; i < correlation->operations.values_num; i++)
+	{
+		operation = (zbx_corr_operation_t *)correlation->operations.values[i];
+
+		switch (operation->type)
+		{
+			case ZBX_CORR_OPERATION_CLOSE_OLD:
+				return SUCCEED;
+		}
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds open problem to the problem tag index                        *
+ *                                                                            *
+ * Parameters: problem - [IN] open problem                                    *
+ *             tag     - [IN] tag name                                        *
+ *             value   - [IN] tag value, NULL to index by tag name only       *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_problems_index_tag(zbx_corr_problem_t *problem, const char *tag, const char *value)
+{
+	zbx_corr_problem_tag_t	*problem_tag, problem_tag_local;
+
+	problem_tag_local.tag = tag;
+	problem_tag_local.value = value;
+
+	if (NULL == (problem_tag = (zbx_corr_problem_tag_t *)zbx_hashset_search(&correlation_problems.problem_tags,
+			&problem_tag_local)))
+	{
+		problem_tag = (zbx_corr_problem_tag_t *)zbx_hashset_insert(&correlation_problems.problem_tags,
+				&problem_tag_local, sizeof(problem_tag_local));
+		zbx_vector_ptr_create(&problem_tag->problems);
+	}
+
+	/* problem tags are indexed sequentially, so duplicates can only be the last added problem */
+	if (0 != problem_tag->problems.values_num &&
+			problem == problem_tag->problems.values[problem_tag->problems.values_num - 1])
+	{
+		return;
+	}
+
+	zbx_vector_ptr_append(&problem_tag->problems, problem);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds open problems to the problem index                           *
+ *                                                                            *
+ * Parameters: problems - [IN] problems inserted into problem hashset         *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_problems_index(const zbx_vector_ptr_t *problems)
+{
+	int			i, j;
+	zbx_corr_problem_t	*problem;
+	const zbx_tag_t		*tag;
+
+	if (0 == problems->values_num)
+		return;
+
+	zbx_vector_ptr_append_array(&correlation_problems.problems_sorted, problems->values, problems->values_num);
+
+	for (i = 0; i < problems->values_num; i++)
+	{
+		problem = (zbx_corr_problem_t *)problems->values[i];
+
+		for (j = 0; j < problem->tags.values_num; j++)
+		{
+			tag = problem->tags.values[j];
+
+			correlation_problems_index_tag(problem, tag->tag, NULL);
+			correlation_problems_index_tag(problem, tag->tag, tag->value);
+		}
+	}
+
+	zbx_vector_ptr_sort(&correlation_problems.problems_sorted, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes closed problems from the problem index                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_problems_compact(void)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_corr_problem_t	*problem;
+	zbx_vector_ptr_t	problems;
+
+	zbx_vector_ptr_create(&problems);
+	zbx_vector_ptr_reserve(&problems, (size_t)correlation_problems.problems.num_data);
+
+	/* tag index refers to the tags of removed problems, so it is rebuilt from the remaining problems */
+	zbx_hashset_clear(&correlation_problems.problem_tags);
+	zbx_vector_ptr_clear(&correlation_problems.problems_sorted);
+
+	zbx_hashset_iter_reset(&correlation_problems.problems, &iter);
+	while (NULL != (problem = (zbx_corr_problem_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (0 != problem->closed)
+			zbx_hashset_iter_remove(&iter);
+		else
+			zbx_vector_ptr_append(&problems, problem);
+	}
+
+	correlation_problems.closed_num = 0;
+	correlation_problems_index(&problems);
+
+	zbx_vector_ptr_destroy(&problems);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads open trigger problems into the problem index                *
+ *                                                                            *
+ * Parameters: eventids - [IN] sorted problem eventids missing from index     *
+ *                                                                            *
+ * Comments: Only the problem tags used in old event conditions are loaded.   *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_problems_load(const zbx_vector_uint64_t *eventids)
+{
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	zbx_corr_problem_t	*problem, problem_local;
+	zbx_tag_t		*tag;
+	zbx_vector_ptr_t	problems;
+	zbx_uint64_t		eventid;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+
+	zbx_vector_ptr_create(&problems);
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select eventid,objectid from problem where");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "eventid", eventids->values, eventids->values_num);
+
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(problem_local.eventid, row[0]);
+
+		if (NULL != zbx_hashset_search(&correlation_problems.problems, &problem_local.eventid))
+			continue;
+
+		ZBX_STR2UINT64(problem_local.objectid, row[1]);
+		problem_local.closed = 0;
+
+		problem = (zbx_corr_problem_t *)zbx_hashset_insert(&correlation_problems.problems, &problem_local,
+				sizeof(problem_local));
+		zbx_vector_tags_create(&problem->tags);
+		zbx_vector_ptr_append(&problems, problem);
+	}
+	zbx_db_free_result(result);
+
+	if (0 != problems.values_num && 0 != correlation_index.old_tags.values_num)
 	{
-		const zbx_corr_condition_t	*condition;
+		zbx_vector_ptr_sort(&problems, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
 
-		if (ZBX_TOKEN_OBJECTID != token.type)
-			continue;
+		sql_offset = 0;
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select eventid,tag,value from problem_tag where");
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "eventid", eventids->values,
+				eventids->values_num);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and");
+		zbx_db_add_str_condition_alloc(&sql, &sql_alloc, &sql_offset, "tag",
+				(const char **)correlation_index.old_tags.values, correlation_index.old_tags.values_num);
 
-		loc = &token.data.objectid.name;
+		result = zbx_db_select("%s", sql);
 
-		if (SUCCEED != zbx_is_uint64_n(expression + loc->l, loc->r - loc->l + 1, &conditionid))
-			continue;
+		while (NULL != (row = zbx_db_fetch(result)))
+		{
+			int	index;
 
-		if (NULL == (condition = (zbx_corr_condition_t *)zbx_hashset_search(&correlation_rules.conditions,
-				&conditionid)))
-			goto out;
+			ZBX_STR2UINT64(eventid, row[0]);
 
-		value = correlation_condition_match_new_event(condition, event, old_value);
+			if (FAIL == (index = zbx_vector_ptr_bsearch(&problems, &eventid,
+					ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
+			{
+				continue;
+			}
 
-		zbx_replace_string(&expression, token.loc.l, &token.loc.r, value);
-		pos = token.loc.r;
-	}
+			problem = (zbx_corr_problem_t *)problems.values[index];
 
-	if (SUCCEED == zbx_evaluate_unknown(expression, &result, error, sizeof(error)))
-	{
-		if (result == ZBX_UNKNOWN)
-			ret = CORRELATION_MAY_MATCH;
-		else if (SUCCEED == zbx_double_compare(result, 1))
-			ret = CORRELATION_MATCH;
+			tag = (zbx_tag_t *)zbx_malloc(NULL, sizeof(zbx_tag_t));
+			tag->tag = zbx_strdup(NULL, row[1]);
+			tag->value = zbx_strdup(NULL, row[2]);
+			zbx_vector_tags_append(&problem->tags, tag);
+		}
+		zbx_db_free_result(result);
 	}
 
-out:
-	zbx_free(expression);
+	zbx_free(sql);
 
-	return ret;
+	correlation_batch.problems_loaded += problems.values_num;
+	correlation_problems_index(&problems);
+
+	zbx_vector_ptr_destroy(&problems);
 }
 
-#define ZBX_CORR_OPERATION_CLOSE_OLD	0
-#define ZBX_CORR_OPERATION_CLOSE_NEW	1
 /******************************************************************************
  *                                                                            *
- * Purpose: checks if correlation has operations to change old events         *
+ * Purpose: removes all problems from the open problem index                  *
  *                                                                            *
- * Parameters: correlation - [IN] correlation to check                        *
+ ******************************************************************************/
+static void	correlation_problems_clear(void)
+{
+	zbx_hashset_clear(&correlation_problems.problem_tags);
+	zbx_vector_ptr_clear(&correlation_problems.problems_sorted);
+	zbx_hashset_clear(&correlation_problems.problems);
+
+	correlation_problems.closed_num = 0;
+	correlation_problems.loaded = FAIL;
+}
+
+/******************************************************************************
  *                                                                            *
- * Return value: SUCCEED - correlation has operations to change old events    *
- *               FAIL    - otherwise                                          *
+ * Purpose: updates the index of open trigger problems used to match old      *
+ *          event conditions                                                  *
+ *                                                                            *
+ * Comments: The index is kept between event batches and is synced with the   *
+ *           open problem eventids in database once per batch. Eventids are   *
+ *           reserved in ranges and might be committed out of order by other  *
+ *           processes, so problems are loaded by eventids missing from index *
+ *           rather than by the last known eventid. Problems no longer open   *
+ *           in database are marked closed and removed when index is          *
+ *           compacted. Only details of the new problems are loaded.          *
  *                                                                            *
  ******************************************************************************/
-static int	correlation_has_old_event_operation(const zbx_correlation_t *correlation)
+static void	correlation_problems_sync(void)
 {
-	int				i;
-	const zbx_corr_operation_t	*operation;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	zbx_vector_uint64_t	eventids_open, eventids_new;
+	zbx_hashset_iter_t	iter;
+	zbx_corr_problem_t	*problem;
+	zbx_uint64_t		eventid;
 
-	for (i = 0; i < correlation->operations.values_num; i++)
+	correlation_batch.problems_synced = SUCCEED;
+
+	/* problem tags are loaded by old event conditions, so index is rebuilt when they change */
+	if (SUCCEED != correlation_problems.loaded)
+		correlation_problems_clear();
+
+	zbx_vector_uint64_create(&eventids_open);
+	zbx_vector_uint64_create(&eventids_new);
+
+	result = zbx_db_select("select eventid from problem"
+			" where r_eventid is null"
+				" and source=" ZBX_STR(EVENT_SOURCE_TRIGGERS));
+
+	while (NULL != (row = zbx_db_fetch(result)))
 	{
-		operation = (zbx_corr_operation_t *)correlation->operations.values[i];
+		ZBX_STR2UINT64(eventid, row[0]);
+		zbx_vector_uint64_append(&eventids_open, eventid);
 
-		switch (operation->type)
+		if (NULL == (problem = (zbx_corr_problem_t *)zbx_hashset_search(&correlation_problems.problems,
+				&eventid)))
 		{
-			case ZBX_CORR_OPERATION_CLOSE_OLD:
-				return SUCCEED;
+			zbx_vector_uint64_append(&eventids_new, eventid);
+		}
+		else if (0 != problem->closed)
+		{
+			/* problem closing was rolled back */
+			problem->closed = 0;
+			correlation_problems.closed_num--;
 		}
 	}
+	zbx_db_free_result(result);
 
-	return FAIL;
-}
+	zbx_vector_uint64_sort(&eventids_open, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-/***********************************************************************************
- *                                                                                 *
- * Purpose: adds sql statement to match tag according to the defined               *
- *          matching operation                                                     *
- *                                                                                 *
- * Parameters: sql         - [IN/OUT]                                              *
- *             sql_alloc   - [IN/OUT]                                              *
- *             sql_offset  - [IN/OUT]                                              *
- *             tag         - [IN] tag to match                                     *
- *             value       - [IN] tag value to match                               *
- *             op          - [IN] matching operation (ZBX_CONDITION_OPERATOR_)     *
- *                                                                                 *
- ***********************************************************************************/
-static void	correlation_condition_add_tag_match(char **sql, size_t *sql_alloc, size_t *sql_offset, const char *tag,
-		const char *value, unsigned char op)
-{
-	char	*tag_esc, *value_esc;
-
-	tag_esc = zbx_db_dyn_escape_string(tag);
-	value_esc = zbx_db_dyn_escape_string(value);
-
-	switch (op)
-	{
-		case ZBX_CONDITION_OPERATOR_NOT_EQUAL:
-		case ZBX_CONDITION_OPERATOR_NOT_LIKE:
-			zbx_strcpy_alloc(sql, sql_alloc, sql_offset, "not ");
-			break;
+	zbx_hashset_iter_reset(&correlation_problems.problems, &iter);
+	while (NULL != (problem = (zbx_corr_problem_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (0 != problem->closed)
+			continue;
+
+		if (FAIL == zbx_vector_uint64_bsearch(&eventids_open, problem->eventid,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		{
+			problem->closed = 1;
+			correlation_problems.closed_num++;
+		}
 	}
 
-	zbx_strcpy_alloc(sql, sql_alloc, sql_offset,
-			"exists (select null from problem_tag pt where p.eventid=pt.eventid and ");
+	if (correlation_problems.closed_num > correlation_problems.problems.num_data / 2)
+		correlation_problems_compact();
 
-	switch (op)
+	if (0 != eventids_new.values_num)
 	{
-		case ZBX_CONDITION_OPERATOR_EQUAL:
-		case ZBX_CONDITION_OPERATOR_NOT_EQUAL:
-			zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "pt.tag='%s' and pt.value" ZBX_SQL_STRCMP,
-					tag_esc, ZBX_SQL_STRVAL_EQ(value_esc));
-			break;
-		case ZBX_CONDITION_OPERATOR_LIKE:
-		case ZBX_CONDITION_OPERATOR_NOT_LIKE:
-			zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "pt.tag='%s' and pt.value like '%%%s%%'",
-					tag_esc, value_esc);
-			break;
+		zbx_vector_uint64_sort(&eventids_new, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		correlation_problems_load(&eventids_new);
 	}
 
-	zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ')');
+	correlation_problems.loaded = SUCCEED;
 
-	zbx_free(value_esc);
-	zbx_free(tag_esc);
+	zbx_vector_uint64_destroy(&eventids_new);
+	zbx_vector_uint64_destroy(&eventids_open);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: creates sql filter to find events matching a correlation          *
- *          condition                                                         *
+ * Purpose: adds new trigger problems to the open problem index               *
  *                                                                            *
- * Parameters: condition - [IN] correlation condition to match                *
- *             event     - [IN] new event to match                            *
+ * Parameters: problem_events - [IN] new problem events                       *
  *                                                                            *
- * Return value: the created filter or NULL                                   *
+ * Comments: The problems are verified against database during the next sync, *
+ *           so problems of rolled back transactions are dropped from index.  *
  *                                                                            *
  ******************************************************************************/
-static char	*correlation_condition_get_event_filter(const zbx_corr_condition_t *condition,
-		const zbx_db_event *event)
+static void	correlation_problems_add(const zbx_vector_ptr_t *problem_events)
 {
-	int			i;
-	zbx_tag_t		*tag;
-	char			*tag_esc, *filter = NULL;
-	size_t			filter_alloc = 0, filter_offset = 0;
-	zbx_vector_str_t	values;
+	int			i, j;
+	zbx_corr_problem_t	*problem, problem_local;
+	zbx_vector_ptr_t	problems;
 
-	/* replace new event dependent condition with precalculated value */
-	switch (condition->type)
-	{
-		case ZBX_CORR_CONDITION_NEW_EVENT_TAG:
-		case ZBX_CORR_CONDITION_NEW_EVENT_TAG_VALUE:
-		case ZBX_CORR_CONDITION_NEW_EVENT_HOSTGROUP:
-			return zbx_dsprintf(NULL, "%s=1",
-					correlation_condition_match_new_event(condition, event, SUCCEED));
-	}
+	if (SUCCEED != correlation_problems.loaded)
+		return;
 
-	/* replace old event dependent condition with sql filter on problem_tag pt table */
-	switch (condition->type)
+	zbx_vector_ptr_create(&problems);
+
+	for (i = 0; i < problem_events->values_num; i++)
 	{
-		case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
-			tag_esc = zbx_db_dyn_escape_string(condition->data.tag.tag);
-			zbx_snprintf_alloc(&filter, &filter_alloc, &filter_offset,
-					"exists (select null from problem_tag pt"
-						" where p.eventid=pt.eventid"
-							" and pt.tag='%s')",
-					tag_esc);
-			zbx_free(tag_esc);
-			return filter;
+		const zbx_db_event	*event = (const zbx_db_event *)problem_events->values[i];
 
-		case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
-			zbx_vector_str_create(&values);
+		if (EVENT_SOURCE_TRIGGERS != event->source)
+			continue;
 
-			for (i = 0; i < event->tags.values_num; i++)
-			{
-				tag = event->tags.values[i];
-				if (0 == strcmp(tag->tag, condition->data.tag_pair.newtag))
-					zbx_vector_str_append(&values, zbx_strdup(NULL, tag->value));
-			}
+		if (NULL != zbx_hashset_search(&correlation_problems.problems, &event->eventid))
+			continue;
+
+		problem_local.eventid = event->eventid;
+		problem_local.objectid = event->objectid;
+		problem_local.closed = 0;
+
+		problem = (zbx_corr_problem_t *)zbx_hashset_insert(&correlation_problems.problems, &problem_local,
+				sizeof(problem_local));
+		zbx_vector_tags_create(&problem->tags);
 
-			if (0 == values.values_num)
+		for (j = 0; j < event->tags.values_num; j++)
+		{
+			const zbx_tag_t	*tag = event->tags.values[j];
+
+			if (FAIL != zbx_vector_str_bsearch(&correlation_index.old_tags, tag->tag,
+					ZBX_DEFAULT_STR_COMPARE_FUNC))
 			{
-				/* no new tag found, substitute condition with failure expression */
-				filter = zbx_strdup(NULL, "1=0");
+				zbx_vector_tags_append(&problem->tags, duplicate_tag(tag));
 			}
-			else
-			{
-				tag_esc = zbx_db_dyn_escape_string(condition->data.tag_pair.oldtag);
+		}
 
-				zbx_snprintf_alloc(&filter, &filter_alloc, &filter_offset,
-						"exists (select null from problem_tag pt"
-							" where p.eventid=pt.eventid"
-								" and pt.tag='%s'"
-								" and",
-						tag_esc);
+		zbx_vector_ptr_append(&problems, problem);
+	}
 
-				zbx_db_add_str_condition_alloc(&filter, &filter_alloc, &filter_offset, "pt.value",
-						(const char **)values.values, values.values_num);
+	correlation_problems_index(&problems);
 
-				zbx_chrcpy_alloc(&filter, &filter_alloc, &filter_offset, ')');
+	zbx_vector_ptr_destroy(&problems);
+}
 
-				zbx_free(tag_esc);
-				zbx_vector_str_clear_ext(&values, zbx_str_free);
-			}
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds open problems having the specified tag to candidates         *
+ *                                                                            *
+ * Parameters: tag      - [IN] tag name                                       *
+ *             value    - [IN] tag value, NULL to match any value             *
+ *             problems - [IN/OUT] candidate problems                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_problems_get_by_tag(const char *tag, const char *value, zbx_vector_ptr_t *problems)
+{
+	const zbx_corr_problem_tag_t	*problem_tag;
+	zbx_corr_problem_tag_t		problem_tag_local;
 
-			zbx_vector_str_destroy(&values);
-			return filter;
+	problem_tag_local.tag = tag;
+	problem_tag_local.value = value;
 
-		case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
-			correlation_condition_add_tag_match(&filter, &filter_alloc, &filter_offset,
-					condition->data.tag_value.tag, condition->data.tag_value.value,
-					condition->data.tag_value.op);
-			return filter;
+	if (NULL != (problem_tag = (const zbx_corr_problem_tag_t *)zbx_hashset_search(
+			&correlation_problems.problem_tags, &problem_tag_local)))
+	{
+		zbx_vector_ptr_append_array(problems, problem_tag->problems.values, problem_tag->problems.values_num);
 	}
-
-	return NULL;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: add sql statement to filter out correlation conditions and        *
- *          matching events                                                   *
+ * Purpose: checks if correlation has conditions using old events             *
  *                                                                            *
- * Parameters: sql         - [IN/OUT]                                         *
- *             sql_alloc   - [IN/OUT]                                         *
- *             sql_offset  - [IN/OUT]                                         *
- *             correlation - [IN] correlation rule to match                   *
- *             event       - [IN] new event to match                          *
+ * Parameters: correlation - [IN] correlation to check                        *
  *                                                                            *
- * Return value: SUCCEED - filter was added successfully                      *
+ * Return value: SUCCEED - correlation has conditions using old events        *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	correlation_add_event_filter(char **sql, size_t *sql_alloc, size_t *sql_offset,
-		const zbx_correlation_t *correlation, const zbx_db_event *event)
+static int	correlation_has_old_event_condition(const zbx_correlation_t *correlation)
 {
-	char			*expression, *filter;
-	zbx_token_t		token;
-	int			pos = 0, ret = FAIL;
-	zbx_uint64_t		conditionid;
-	zbx_strloc_t		*loc;
-	zbx_corr_condition_t	*condition;
+	int				i;
+	const zbx_corr_condition_t	*condition;
 
-	zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "c.correlationid=" ZBX_FS_UI64, correlation->correlationid);
+	for (i = 0; i < correlation->conditions.values_num; i++)
+	{
+		condition = (const zbx_corr_condition_t *)correlation->conditions.values[i];
 
-	expression = zbx_strdup(NULL, correlation->formula);
+		switch (condition->type)
+		{
+			case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
+			case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
+			case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
+				return SUCCEED;
+		}
+	}
 
-	for (; SUCCEED == zbx_token_find(expression, pos, &token, ZBX_TOKEN_SEARCH_BASIC); pos++)
-	{
-		if (ZBX_TOKEN_OBJECTID != token.type)
-			continue;
+	return FAIL;
+}
 
-		loc = &token.data.objectid.name;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets open problems that might match correlation rule old event    *
+ *          conditions                                                        *
+ *                                                                            *
+ * Parameters: correlation - [IN] correlation rule to match                   *
+ *             event       - [IN] new event to match                          *
+ *             problems    - [OUT] candidate problems sorted by eventid       *
+ *                                                                            *
+ * Return value: SUCCEED - the candidate problems were found in index         *
+ *               FAIL    - the rule might match problems without indexed      *
+ *                         tags, all open problems must be checked            *
+ *                                                                            *
+ * Comments: Candidates are the problems matching at least one of 'equal',    *
+ *           'like' or tag pair old event conditions. If the rule matches     *
+ *           when none of those conditions match or has negative old event    *
+ *           conditions, then it might match any problem.                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	correlation_batch_get_problems(const zbx_correlation_t *correlation, const zbx_db_event *event,
+		zbx_vector_ptr_t *problems)
+{
+	int				i, j;
+	const zbx_corr_condition_t	*condition;
+	const zbx_tag_t			*tag;
 
-		if (SUCCEED != zbx_is_uint64_n(expression + loc->l, loc->r - loc->l + 1, &conditionid))
-			continue;
+	if ('\0' == *correlation->formula || CORRELATION_MATCH == correlation_match_event(correlation, event, NULL,
+			FAIL))
+	{
+		return FAIL;
+	}
 
-		if (NULL == (condition = (zbx_corr_condition_t *)zbx_hashset_search(&correlation_rules.conditions, &conditionid)))
-			goto out;
+	for (i = 0; i < correlation->conditions.values_num; i++)
+	{
+		condition = (const zbx_corr_condition_t *)correlation->conditions.values[i];
 
-		if (NULL == (filter = correlation_condition_get_event_filter(condition, event)))
+		switch (condition->type)
 		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			goto out;
-		}
+			case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
+				correlation_problems_get_by_tag(condition->data.tag.tag, NULL, problems);
+				break;
+			case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
+				switch (condition->data.tag_value.op)
+				{
+					case ZBX_CONDITION_OPERATOR_EQUAL:
+						correlation_problems_get_by_tag(condition->data.tag_value.tag,
+								condition->data.tag_value.value, problems);
+						break;
+					case ZBX_CONDITION_OPERATOR_LIKE:
+						correlation_problems_get_by_tag(condition->data.tag_value.tag, NULL,
+								problems);
+						break;
+					default:
+						return FAIL;
+				}
+				break;
+			case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
+				for (j = 0; j < event->tags.values_num; j++)
+				{
+					tag = event->tags.values[j];
 
-		zbx_replace_string(&expression, token.loc.l, &token.loc.r, filter);
-		pos = token.loc.r;
-		zbx_free(filter);
+					if (0 == strcmp(tag->tag, condition->data.tag_pair.newtag))
+					{
+						correlation_problems_get_by_tag(condition->data.tag_pair.oldtag, tag->value,
+								problems);
+					}
+				}
+				break;
+		}
 	}
 
-	if ('\0' != *expression)
-		zbx_snprintf_alloc(sql, sql_alloc, sql_offset, " and (%s)", expression);
-
-	ret = SUCCEED;
-out:
-	zbx_free(expression);
+	zbx_vector_ptr_sort(problems, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+	zbx_vector_ptr_uniq(problems, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
 
-	return ret;
+	return SUCCEED;
 }
 
 /******************************************************************************
@@ -1162,56 +2044,49 @@ typedef enum
 }
 zbx_correlation_scope_t;
 
-/* flag to cache state of problem table during event correlation */
-typedef enum
-{
-	/* unknown state, not initialized */
-	ZBX_PROBLEM_STATE_UNKNOWN = -1,
-	/* all problems are resolved */
-	ZBX_PROBLEM_STATE_RESOLVED,
-	/* at least one open problem exists */
-	ZBX_PROBLEM_STATE_OPEN
-}
-zbx_problem_state_t;
-
 /******************************************************************************
  *                                                                            *
  * Purpose: find problem events that must be recovered by global correlation  *
  *          rules and check if the new event must be closed                   *
  *                                                                            *
- * Parameters: event         - [IN] new event                                 *
- *             problem_state - [IN/OUT] problem state cache variable          *
+ * Parameters: event - [IN] new event                                         *
  *                                                                            *
  * Comments: The correlation data (zbx_event_recovery_t) of events that       *
  *           must be closed are added to event_correlation hashset            *
  *                                                                            *
  *           The global event correlation matching is done in two parts:      *
  *             1) exclude correlations that can't possibly match the event    *
- *                based on new event tag/value/group conditions               *
- *             2) assemble sql statement to select problems/correlations      *
- *                based on the rest correlation conditions                    *
+ *                using correlation rule index and new event tag/value/group  *
+ *                conditions                                                  *
+ *             2) match the rest correlation conditions against open problems *
+ *                indexed by tags used in old event conditions                *
  *                                                                            *
  ******************************************************************************/
-static void	correlate_event_by_global_rules(zbx_db_event *event, zbx_problem_state_t *problem_state)
+static void	correlate_event_by_global_rules(zbx_db_event *event)
 {
-	int			i;
+	int			i, j, match_all;
 	zbx_correlation_t	*correlation;
-	zbx_vector_ptr_t	corr_old, corr_new;
-	char			*sql = NULL;
-	const char		*delim = "";
-	size_t			sql_alloc = 0, sql_offset = 0;
-	zbx_uint64_t		eventid, correlationid, objectid;
+	zbx_vector_ptr_t	correlations, corr_old, corr_new, candidates, *problems;
+	zbx_corr_problem_t	*problem;
 
+	zbx_vector_ptr_create(&correlations);
 	zbx_vector_ptr_create(&corr_old);
 	zbx_vector_ptr_create(&corr_new);
+	zbx_vector_ptr_create(&candidates);
 
-	for (i = 0; i < correlation_rules.correlations.values_num; i++)
+	correlation_index_get_rules(event, &correlations);
+
+	correlation_batch.events_num++;
+	correlation_batch.rules_num += correlations.values_num;
+	correlation_batch.rules_skipped += correlation_rules.correlations.values_num - correlations.values_num;
+
+	for (i = 0; i < correlations.values_num; i++)
 	{
 		zbx_correlation_scope_t	scope;
 
-		correlation = (zbx_correlation_t *)correlation_rules.correlations.values[i];
+		correlation = (zbx_correlation_t *)correlations.values[i];
 
-		switch (correlation_match_new_event(correlation, event, SUCCEED))
+		switch (correlation_match_event(correlation, event, NULL, SUCCEED))
 		{
 			case CORRELATION_MATCH:
 				if (SUCCEED == correlation_has_old_event_operation(correlation))
@@ -1231,27 +2106,15 @@ static void	correlate_event_by_global_rules(zbx_db_event *event, zbx_problem_sta
 
 		if (ZBX_CHECK_OLD_EVENTS == scope)
 		{
-			if (ZBX_PROBLEM_STATE_UNKNOWN == *problem_state)
-			{
-				zbx_db_result_t	result;
-
-				result = zbx_db_select_n("select eventid from problem"
-						" where r_eventid is null and source="
-						ZBX_STR(EVENT_SOURCE_TRIGGERS), 1);
-
-				if (NULL == zbx_db_fetch(result))
-					*problem_state = ZBX_PROBLEM_STATE_RESOLVED;
-				else
-					*problem_state = ZBX_PROBLEM_STATE_OPEN;
-				zbx_db_free_result(result);
-			}
+			if (SUCCEED != correlation_batch.problems_synced)
+				correlation_problems_sync();
 
-			if (ZBX_PROBLEM_STATE_RESOLVED == *problem_state)
+			if (correlation_problems.closed_num == correlation_problems.problems.num_data)
 			{
 				/* with no open problems all conditions involving old events will fail       */
 				/* so there is no need to check old events. Instead re-check if correlation  */
 				/* still matches the new event and must be processed in new event scope.     */
-				if (CORRELATION_MATCH == correlation_match_new_event(correlation, event, FAIL))
+				if (CORRELATION_MATCH == correlation_match_event(correlation, event, NULL, FAIL))
 					zbx_vector_ptr_append(&corr_new, correlation);
 			}
 			else
@@ -1266,62 +2129,106 @@ static void	correlate_event_by_global_rules(zbx_db_event *event, zbx_problem_sta
 		/* Process correlations that matches new event and does not use or affect old events. */
 		/* Those correlations can be executed directly, without checking database.            */
 		for (i = 0; i < corr_new.values_num; i++)
+		{
 			correlation_execute_operations((zbx_correlation_t *)corr_new.values[i], event, 0, 0);
+			correlation_batch.matches_num++;
+		}
 	}
 
-	if (0 != corr_old.values_num)
+	/* Process correlations that matches new event and either uses old events in conditions */
+	/* or has operations involving old events.                                              */
+	for (i = 0; i < corr_old.values_num; i++)
 	{
-		zbx_db_result_t	result;
-		zbx_db_row_t	row;
-
-		/* Process correlations that matches new event and either uses old events in conditions */
-		/* or has operations involving old events.                                              */
+		correlation = (zbx_correlation_t *)corr_old.values[i];
 
-		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select p.eventid,p.objectid,c.correlationid"
-								" from correlation c,problem p"
-								" where p.r_eventid is null"
-								" and p.source=" ZBX_STR(EVENT_SOURCE_TRIGGERS)
-								" and (");
+		if (SUCCEED == correlation_batch_get_problems(correlation, event, &candidates))
+			problems = &candidates;
+		else
+			problems = &correlation_problems.problems_sorted;
 
-		for (i = 0; i < corr_old.values_num; i++)
+		/* rules without old event conditions matching new event match all open problems */
+		if (FAIL == correlation_has_old_event_condition(correlation) &&
+				CORRELATION_MATCH == correlation_match_event(correlation, event, NULL, FAIL))
 		{
-			correlation = (zbx_correlation_t *)corr_old.values[i];
-
-			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, delim);
-			correlation_add_event_filter(&sql, &sql_alloc, &sql_offset, correlation, event);
-			delim = " or ";
+			match_all = SUCCEED;
 		}
+		else
+			match_all = FAIL;
 
-		zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ')');
-		result = zbx_db_select("%s", sql);
-
-		while (NULL != (row = zbx_db_fetch(result)))
+		for (j = 0; j < problems->values_num; j++)
 		{
-			ZBX_STR2UINT64(eventid, row[0]);
+			problem = (zbx_corr_problem_t *)problems->values[j];
+
+			if (0 != problem->closed)
+				continue;
 
 			/* check if this event is not already recovered by another correlation rule */
-			if (NULL != zbx_hashset_search(&correlation_cache, &eventid))
+			if (NULL != zbx_hashset_search(&correlation_cache, &problem->eventid))
 				continue;
 
-			ZBX_STR2UINT64(correlationid, row[2]);
+			correlation_batch.problems_checked++;
 
-			if (FAIL == (i = zbx_vector_ptr_bsearch(&corr_old, &correlationid,
-					ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
+			if (SUCCEED != match_all &&
+					CORRELATION_MATCH != correlation_match_event(correlation, event, problem, SUCCEED))
 			{
-				THIS_SHOULD_NEVER_HAPPEN;
 				continue;
 			}
 
-			ZBX_STR2UINT64(objectid, row[1]);
-			correlation_execute_operations((zbx_correlation_t *)corr_old.values[i], event, eventid, objectid);
+			correlation_execute_operations(correlation, event, problem->eventid, problem->objectid);
+			correlation_batch.matches_num++;
 		}
 
-		zbx_db_free_result(result);
-		zbx_free(sql);
+		zbx_vector_ptr_clear(&candidates);
 	}
 
+	zbx_vector_ptr_destroy(&candidates);
 	zbx_vector_ptr_destroy(&corr_new);
 	zbx_vector_ptr_destroy(&corr_old);
+	zbx_vector_ptr_destroy(&correlations);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares correlation data cache for a new batch of events         *
+ *                                                                            *
+ * Parameters: trigger_events - [IN] trigger events to correlate              *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_batch_prepare(const zbx_vector_ptr_t *trigger_events)
+{
+	int	i;
+
+	for (i = 0; i < trigger_events->values_num; i++)
+	{
+		const zbx_db_event	*event = (const zbx_db_event *)trigger_events->values[i];
+
+		if (0 != (ZBX_FLAGS_DB_EVENT_CREATE & event->flags))
+			zbx_vector_uint64_append(&correlation_batch.triggerids, event->objectid);
+	}
+
+	zbx_vector_uint64_sort(&correlation_batch.triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&correlation_batch.triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	correlation_batch.problems_synced = FAIL;
+	correlation_batch.groups_loaded = FAIL;
+
+	correlation_batch.events_num = 0;
+	correlation_batch.rules_num = 0;
+	correlation_batch.rules_skipped = 0;
+	correlation_batch.problems_checked = 0;
+	correlation_batch.matches_num = 0;
+	correlation_batch.problems_loaded = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: releases correlation data cached for the processed event batch    *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_batch_clear(void)
+{
+	zbx_hashset_clear(&correlation_batch.trigger_groups);
+	zbx_vector_uint64_clear(&correlation_batch.triggerids);
 }
 
 /******************************************************************************
@@ -1334,14 +2241,25 @@ static void	correlate_events_by_global_rules(zbx_vector_ptr_t *trigger_events, z
 {
 	int			i, index;
 	zbx_trigger_diff_t	*diff;
-	zbx_problem_state_t	problem_state = ZBX_PROBLEM_STATE_UNKNOWN;
+	double			sec;
+	zbx_dc_corr_stats_t	corr_stats;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() events:%d", __func__, correlation_cache.num_data);
 
 	zbx_dc_correlation_rules_get(&correlation_rules);
 
 	if (0 == correlation_rules.correlations.values_num)
+	{
+		if (SUCCEED == correlation_problems.loaded)
+			correlation_problems_clear();
+
 		goto out;
+	}
+
+	sec = zbx_time();
+
+	correlation_index_update();
+	correlation_batch_prepare(trigger_events);
 
 	/* process global correlation and queue the events that must be closed */
 	for (i = 0; i < trigger_events->values_num; i++)
@@ -1351,7 +2269,7 @@ static void	correlate_events_by_global_rules(zbx_vector_ptr_t *trigger_events, z
 		if (0 == (ZBX_FLAGS_DB_EVENT_CREATE & event->flags))
 			continue;
 
-		correlate_event_by_global_rules(event, &problem_state);
+		correlate_event_by_global_rules(event);
 
 		/* force value recalculation based on open problems for triggers with */
 		/* events closed by 'close new' correlation operation                */
@@ -1366,6 +2284,22 @@ static void	correlate_events_by_global_rules(zbx_vector_ptr_t *trigger_events, z
 		}
 	}
 
+	corr_stats.events = (zbx_uint64_t)correlation_batch.events_num;
+	corr_stats.rules = (zbx_uint64_t)correlation_batch.rules_num;
+	corr_stats.rules_skipped = (zbx_uint64_t)correlation_batch.rules_skipped;
+	corr_stats.problems_checked = (zbx_uint64_t)correlation_batch.problems_checked;
+	corr_stats.matches = (zbx_uint64_t)correlation_batch.matches_num;
+	corr_stats.problems = (zbx_uint64_t)(correlation_problems.problems.num_data - correlation_problems.closed_num);
+	corr_stats.problems_loaded = (zbx_uint64_t)correlation_batch.problems_loaded;
+	zbx_dc_update_corr_stats(&corr_stats);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() events:%d rules:%d skipped:%d problems:%d checked:%d matched:%d"
+			" loaded:%d %.6f sec", __func__, correlation_batch.events_num, correlation_batch.rules_num,
+			correlation_batch.rules_skipped, correlation_problems.problems.num_data -
+			correlation_problems.closed_num, correlation_batch.problems_checked,
+			correlation_batch.matches_num, correlation_batch.problems_loaded, zbx_time() - sec);
+
+	correlation_batch_clear();
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -1683,6 +2617,33 @@ void	zbx_initialize_events(void)
 	zbx_hashset_create(&correlation_cache, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	zbx_dc_correlation_rules_init(&correlation_rules);
+
+	zbx_hashset_create_ext(&correlation_index.tags, 0, corr_index_tag_hash_func, corr_index_tag_compare_func,
+			(zbx_clean_func_t)corr_index_tag_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&correlation_index.groups, 0, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)corr_index_group_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&correlation_index.hostgroups, 0, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)corr_hostgroup_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_vector_ptr_create(&correlation_index.common);
+	zbx_vector_str_create(&correlation_index.old_tags);
+	correlation_index.sync_ts = correlation_rules.sync_ts;
+
+	zbx_hashset_create_ext(&correlation_problems.problems, 0, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)corr_problem_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_vector_ptr_create(&correlation_problems.problems_sorted);
+	zbx_hashset_create_ext(&correlation_problems.problem_tags, 0, corr_problem_tag_hash_func,
+			corr_problem_tag_compare_func, (zbx_clean_func_t)corr_problem_tag_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	correlation_problems.loaded = FAIL;
+
+	zbx_vector_uint64_create(&correlation_batch.triggerids);
+	zbx_hashset_create_ext(&correlation_batch.trigger_groups, 0, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)corr_trigger_groups_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
 }
 
 /******************************************************************************
@@ -1696,6 +2657,19 @@ void	zbx_uninitialize_events(void)
 	zbx_hashset_destroy(&event_recovery);
 	zbx_hashset_destroy(&correlation_cache);
 
+	zbx_hashset_destroy(&correlation_batch.trigger_groups);
+	zbx_vector_uint64_destroy(&correlation_batch.triggerids);
+
+	zbx_hashset_destroy(&correlation_problems.problem_tags);
+	zbx_vector_ptr_destroy(&correlation_problems.problems_sorted);
+	zbx_hashset_destroy(&correlation_problems.problems);
+
+	zbx_vector_str_destroy(&correlation_index.old_tags);
+	zbx_vector_ptr_destroy(&correlation_index.common);
+	zbx_hashset_destroy(&correlation_index.hostgroups);
+	zbx_hashset_destroy(&correlation_index.groups);
+	zbx_hashset_destroy(&correlation_index.tags);
+
 	zbx_dc_correlation_rules_free(&correlation_rules);
 }
 
@@ -2981,3 +3955,7 @@ int	zbx_close_problem(zbx_uint64_t triggerid, zbx_uint64_t eventid, zbx_uint64_t
 
 	return (0 == processed_num ? FAIL : SUCCEED);
 }
+
+#ifdef HAVE_TESTS
+#	include "../../../tests/zabbix_server/events/events_test.c"
+#endif
@@ -25,6 +25,17 @@
 #include "zbxself.h"
 #include "httptest.h"
 #include "zbxtime.h"
+#include "zbxcacheconfig.h"
+#include "zbxpreproc.h"
+
+#include <event2/event.h>
+
+static void	httppoller_timer_cb(evutil_socket_t fd, short what, void *arg)
+{
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(what);
+	ZBX_UNUSED(arg);
+}
 
 /******************************************************************************
  *                                                                            *
@@ -32,16 +43,22 @@
  *                                                                            *
  * Comments: never returns                                                    *
  *                                                                            *
+ *           Web scenarios are executed concurrently, the steps of each       *
+ *           scenario are performed one after another by the event loop.      *
+ *                                                                            *
  ******************************************************************************/
 ZBX_THREAD_ENTRY(httppoller_thread, args)
 {
-	int					sleeptime = -1, httptests_count = 0, old_httptests_count = 0,
+	int					sleeptime = -1, httptests_count = 0, old_httptests_count = 0, started,
 						server_num = ((zbx_thread_args_t *)args)->info.server_num,
 						process_num = ((zbx_thread_args_t *)args)->info.process_num;
 	double					total_sec = 0.0, old_total_sec = 0.0;
 	time_t					last_stat_time, nextcheck = 0;
 	const zbx_thread_info_t			*info = &((zbx_thread_args_t *)args)->info;
 	unsigned char				process_type = ((zbx_thread_args_t *)args)->info.process_type;
+	zbx_httptest_poller_t			poller;
+	struct event_base			*base;
+	struct event				*timer;
 
 	const zbx_thread_httppoller_args	*httppoller_args_in = (const zbx_thread_httppoller_args *)
 						(((zbx_thread_args_t *)args)->args);
@@ -54,6 +71,30 @@ ZBX_THREAD_ENTRY(httppoller_thread, args)
 #define STAT_INTERVAL	5	/* if a process is busy and does not sleep then update status not faster than */
 				/* once in STAT_INTERVAL seconds */
 
+	memset(&poller, 0, sizeof(poller));
+	poller.config_source_ip = httppoller_args_in->config_source_ip;
+	poller.max_running = httppoller_args_in->config_max_concurrent_checks_per_poller;
+
+	if (NULL == (base = event_base_new()))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize event base");
+		exit(EXIT_FAILURE);
+	}
+
+	timer = evtimer_new(base, httppoller_timer_cb, NULL);
+
+#ifdef HAVE_LIBCURL
+	{
+		char	*error = NULL;
+
+		if (NULL == (poller.http = zbx_async_http_create(base, &error)))
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot initialize HTTP client: %s", error);
+			zbx_free(error);
+			exit(EXIT_FAILURE);
+		}
+	}
+#endif
 	zbx_setproctitle("%s #%d [connecting to the database]", get_process_type_string(process_type), process_num);
 	last_stat_time = time(NULL);
 
@@ -61,7 +102,8 @@ ZBX_THREAD_ENTRY(httppoller_thread, args)
 
 	while (ZBX_IS_RUNNING())
 	{
-		double	sec = zbx_time();
+		double			sec = zbx_time();
+		zbx_dc_um_handle_t	*um_handle;
 
 		zbx_update_env(get_process_type_string(process_type), sec);
 
@@ -72,17 +114,35 @@ ZBX_THREAD_ENTRY(httppoller_thread, args)
 					old_total_sec);
 		}
 
-		if ((int)sec >= nextcheck)
+		/* user macros are expanded when scenarios are started and when their steps are advanced */
+		um_handle = zbx_dc_open_user_macros();
+
+		if (poller.running < poller.max_running && (int)sec >= nextcheck)
 		{
-			httptests_count += process_httptests((int)sec, httppoller_args_in->config_source_ip,
-					&nextcheck);
-			total_sec += zbx_time() - sec;
+			started = process_httptests(&poller, (int)sec, &nextcheck);
 
 			if (0 == nextcheck)
 				nextcheck = time(NULL) + POLLER_DELAY;
 		}
+		else
+			started = 0;
+
+		event_base_loop(base, EVLOOP_NONBLOCK);
 
-		sleeptime = zbx_calculate_sleeptime(nextcheck, POLLER_DELAY);
+		zbx_dc_close_user_macros(um_handle);
+		zbx_preprocessor_flush();
+
+		httptests_count += poller.finished;
+		poller.finished = 0;
+		total_sec += zbx_time() - sec;
+
+		/* more web scenarios might be due if any were started, otherwise wait for the next check */
+		if (0 != started)
+			sleeptime = 0;
+		else if (poller.running >= poller.max_running)
+			sleeptime = POLLER_DELAY;
+		else
+			sleeptime = zbx_calculate_sleeptime(nextcheck, POLLER_DELAY);
 
 		if (0 != sleeptime || STAT_INTERVAL <= time(NULL) - last_stat_time)
 		{
@@ -105,7 +165,25 @@ ZBX_THREAD_ENTRY(httppoller_thread, args)
 			last_stat_time = time(NULL);
 		}
 
-		zbx_sleep_loop(info, sleeptime);
+		if (0 == poller.running)
+		{
+			zbx_sleep_loop(info, sleeptime);
+		}
+		else if (0 != sleeptime)
+		{
+			struct timeval	tv = {sleeptime, 0};
+
+			/* wait for network events of running scenarios, but not longer than until the next check */
+			um_handle = zbx_dc_open_user_macros();
+			evtimer_add(timer, &tv);
+
+			zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_IDLE);
+			event_base_loop(base, EVLOOP_ONCE);
+			zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+
+			evtimer_del(timer);
+			zbx_dc_close_user_macros(um_handle);
+		}
 	}
 
 	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
@@ -25,6 +25,7 @@
 typedef struct
 {
 	const char	*config_source_ip;
+	int		config_max_concurrent_checks_per_poller;
 }
 zbx_thread_httppoller_args;
 
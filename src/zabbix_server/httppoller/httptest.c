@@ -54,23 +54,20 @@ typedef struct
 }
 zbx_httppage_t;
 
-static zbx_httppage_t	page;
-
 static size_t	curl_write_cb(void *ptr, size_t size, size_t nmemb, void *userdata)
 {
-	size_t	r_size = size * nmemb;
-
-	ZBX_UNUSED(userdata);
+	size_t		r_size = size * nmemb;
+	zbx_httppage_t	*page = (zbx_httppage_t *)userdata;
 
 	/* first piece of data */
-	if (NULL == page.data)
+	if (NULL == page->data)
 	{
-		page.allocated = MAX(8096, r_size);
-		page.offset = 0;
-		page.data = (char *)zbx_malloc(page.data, page.allocated);
+		page->allocated = MAX(8096, r_size);
+		page->offset = 0;
+		page->data = (char *)zbx_malloc(page->data, page->allocated);
 	}
 
-	zbx_strncpy_alloc(&page.data, &page.allocated, &page.offset, (char *)ptr, r_size);
+	zbx_strncpy_alloc(&page->data, &page->allocated, &page->offset, (char *)ptr, r_size);
 
 	return r_size;
 }
@@ -85,6 +82,32 @@ static size_t	curl_ignore_cb(void *ptr, size_t size, size_t nmemb, void *userdat
 
 #endif	/* HAVE_LIBCURL */
 
+/* web scenario being executed, steps are performed one after another as responses arrive */
+typedef struct
+{
+	zbx_httptest_poller_t	*poller;
+	zbx_dc_host_t		host;
+	zbx_httptest_t		httptest;
+	int			now;
+	int			delay;
+
+	/* the scenario steps and the step being executed */
+	zbx_db_result_t		result;
+	zbx_db_httpstep		db_httpstep;
+#ifdef HAVE_LIBCURL
+	zbx_httpstep_t		httpstep;
+	CURL			*easyhandle;
+	char			errbuf[CURL_ERROR_SIZE];
+	struct curl_slist	*headers_slist;
+	zbx_httppage_t		page;
+#endif
+	char			*err_str;
+	int			lastfailedstep;
+	double			speed_download;
+	int			speed_download_num;
+}
+zbx_httptest_run_t;
+
 /******************************************************************************
  *                                                                            *
  * Purpose: remove all macro variables cached during http test execution      *
@@ -609,566 +632,721 @@ out:
 	return ret;
 }
 
+
 /******************************************************************************
  *                                                                            *
- * Purpose: process single scenario of http test                              *
+ * Purpose: load web scenario to be executed                                  *
+ *                                                                            *
+ * Parameters: poller     - [IN] the HTTP poller                              *
+ *             now        - [IN] the current timestamp                        *
+ *             httptestid - [IN] the web scenario identifier                  *
+ *                                                                            *
+ * Return value: the loaded web scenario or NULL if it cannot be executed     *
  *                                                                            *
  ******************************************************************************/
-static void	process_httptest(zbx_dc_host_t *host, zbx_httptest_t *httptest, int *delay,
-		const char *config_source_ip)
+static zbx_httptest_run_t	*httptest_run_create(zbx_httptest_poller_t *poller, int now, zbx_uint64_t httptestid)
 {
-	zbx_db_result_t	result;
-	zbx_db_httpstep	db_httpstep;
-	char		*err_str = NULL, *buffer = NULL;
-	int		lastfailedstep = 0;
-	zbx_timespec_t	ts;
-	double		speed_download = 0;
-	int		speed_download_num = 0;
-#ifdef HAVE_LIBCURL
-	zbx_db_row_t	row;
-	zbx_httpstat_t	stat;
-	char		errbuf[CURL_ERROR_SIZE];
-	CURL		*easyhandle = NULL;
-	CURLcode	err;
-	zbx_httpstep_t	httpstep;
-#endif
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() httptestid:" ZBX_FS_UI64 " name:'%s'",
-			__func__, httptest->httptest.httptestid, httptest->httptest.name);
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	zbx_httptest_run_t	*run = NULL;
+	zbx_httptest_t		*httptest;
+	zbx_dc_host_t		*host;
 
 	result = zbx_db_select(
-			"select httpstepid,no,name,url,timeout,posts,required,status_codes,post_type,follow_redirects,"
-				"retrieve_mode"
-			" from httpstep"
-			" where httptestid=" ZBX_FS_UI64
-			" order by no",
-			httptest->httptest.httptestid);
+			"select h.hostid,h.host,h.name,t.httptestid,t.name,t.agent,"
+				"t.authentication,t.http_user,t.http_password,t.http_proxy,t.retries,t.ssl_cert_file,"
+				"t.ssl_key_file,t.ssl_key_password,t.verify_peer,t.verify_host,t.delay"
+			" from httptest t,hosts h"
+			" where t.hostid=h.hostid"
+				" and t.httptestid=" ZBX_FS_UI64,
+			httptestid);
+
+	if (NULL == (row = zbx_db_fetch(result)))
+		goto out;
 
-	buffer = zbx_strdup(buffer, httptest->httptest.delay);
-	zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &host->hostid, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-				&buffer, MACRO_TYPE_COMMON, NULL, 0);
+	run = (zbx_httptest_run_t *)zbx_malloc(NULL, sizeof(zbx_httptest_run_t));
+	memset(run, 0, sizeof(zbx_httptest_run_t));
+	run->poller = poller;
+	run->now = now;
 
-	/* Avoid the potential usage of uninitialized values when: */
-	/* 1) compile without libCURL support */
-	/* 2) update interval is invalid */
-	db_httpstep.name = NULL;
+	host = &run->host;
+	httptest = &run->httptest;
 
-	if (SUCCEED != zbx_is_time_suffix(buffer, delay, ZBX_LENGTH_UNLIMITED))
-	{
-		err_str = zbx_dsprintf(err_str, "update interval \"%s\" is invalid", buffer);
-		lastfailedstep = -1;
-		*delay = ZBX_DEFAULT_INTERVAL;
-		goto httptest_error;
-	}
+	ZBX_STR2UINT64(host->hostid, row[0]);
+	zbx_strscpy(host->host, row[1]);
+	zbx_strlcpy_utf8(host->name, row[2], sizeof(host->name));
 
-#ifdef HAVE_LIBCURL
-	if (NULL == (easyhandle = curl_easy_init()))
-	{
-		err_str = zbx_strdup(err_str, "cannot initialize cURL library");
-		goto clean;
-	}
+	ZBX_STR2UINT64(httptest->httptest.httptestid, row[3]);
+	httptest->httptest.name = zbx_strdup(NULL, row[4]);
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_PROXY, httptest->httptest.http_proxy)) ||
-			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_COOKIEFILE, "")) ||
-			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_USERAGENT, httptest->httptest.agent)) ||
-			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_ERRORBUFFER, errbuf)) ||
-			CURLE_OK != (err = curl_easy_setopt(easyhandle, ZBX_CURLOPT_ACCEPT_ENCODING, "")))
-	{
-		err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-		goto clean;
-	}
+	/* create macro cache to use in http test */
+	zbx_vector_ptr_pair_create(&httptest->macros);
 
-#if LIBCURL_VERSION_NUM >= 0x071304
-	/* CURLOPT_PROTOCOLS is supported starting with version 7.19.4 (0x071304) */
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_PROTOCOLS, CURLPROTO_HTTP | CURLPROTO_HTTPS)))
+	if (SUCCEED != httptest_load_pairs(host, httptest))
 	{
-		err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-		goto clean;
-	}
-#endif
+		zabbix_log(LOG_LEVEL_WARNING, "cannot process web scenario \"%s\" on host \"%s\": "
+				"cannot load web scenario data", httptest->httptest.name, host->name);
+		THIS_SHOULD_NEVER_HAPPEN;
 
-	if (SUCCEED != zbx_http_prepare_ssl(easyhandle, httptest->httptest.ssl_cert_file,
-			httptest->httptest.ssl_key_file, httptest->httptest.ssl_key_password,
-			httptest->httptest.verify_peer, httptest->httptest.verify_host, config_source_ip, &err_str))
-	{
-		goto clean;
+		zbx_vector_ptr_pair_destroy(&httptest->macros);
+		zbx_free(httptest->httptest.name);
+		zbx_free(run);
+		goto out;
 	}
 
-	httpstep.httptest = httptest;
-	httpstep.httpstep = &db_httpstep;
+	httptest->httptest.agent = zbx_strdup(NULL, row[5]);
+	zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &host->hostid, NULL, NULL, NULL, NULL, NULL,
+			NULL, NULL, &httptest->httptest.agent, MACRO_TYPE_COMMON, NULL, 0);
 
-	while (NULL != (row = zbx_db_fetch(result)) && ZBX_IS_RUNNING())
+	if (HTTPTEST_AUTH_NONE != (httptest->httptest.authentication = atoi(row[6])))
 	{
-		struct curl_slist	*headers_slist = NULL;
-		char			*header_cookie = NULL;
-		size_t			(*curl_header_cb)(void *ptr, size_t size, size_t nmemb, void *userdata);
-		size_t			(*curl_body_cb)(void *ptr, size_t size, size_t nmemb, void *userdata);
-
-		/* NOTE: do not break or return from this block! */
-		/*       process_step_data() call is required! */
-
-		ZBX_STR2UINT64(db_httpstep.httpstepid, row[0]);
-		db_httpstep.httptestid = httptest->httptest.httptestid;
-		db_httpstep.no = atoi(row[1]);
-		db_httpstep.name = row[2];
+		httptest->httptest.http_user = zbx_strdup(NULL, row[7]);
+		zbx_substitute_simple_macros_unmasked(NULL, NULL, NULL, NULL, &host->hostid, NULL, NULL,
+				NULL, NULL, NULL, NULL, NULL, &httptest->httptest.http_user,
+				MACRO_TYPE_COMMON, NULL, 0);
+
+		httptest->httptest.http_password = zbx_strdup(NULL, row[8]);
+		zbx_substitute_simple_macros_unmasked(NULL, NULL, NULL, NULL, &host->hostid, NULL, NULL,
+				NULL, NULL, NULL, NULL, NULL, &httptest->httptest.http_password,
+				MACRO_TYPE_COMMON, NULL, 0);
+	}
 
-		db_httpstep.url = zbx_strdup(NULL, row[3]);
-		zbx_substitute_simple_macros_unmasked(NULL, NULL, NULL, NULL, NULL, host, NULL, NULL, NULL, NULL, NULL,
-				NULL, &db_httpstep.url, MACRO_TYPE_HTTPTEST_FIELD, NULL, 0);
-		http_substitute_variables(httptest, &db_httpstep.url);
+	if ('\0' != *row[9])
+	{
+		httptest->httptest.http_proxy = zbx_strdup(NULL, row[9]);
+		zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &host->hostid, NULL, NULL, NULL,
+				NULL, NULL, NULL, NULL, &httptest->httptest.http_proxy,
+				MACRO_TYPE_COMMON, NULL, 0);
+	}
+	else
+		httptest->httptest.http_proxy = NULL;
 
-		db_httpstep.required = zbx_strdup(NULL, row[6]);
-		zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, NULL, host, NULL, NULL, NULL, NULL, NULL, NULL,
-				&db_httpstep.required, MACRO_TYPE_HTTPTEST_FIELD, NULL, 0);
+	httptest->httptest.retries = atoi(row[10]);
 
-		db_httpstep.status_codes = zbx_strdup(NULL, row[7]);
-		zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &host->hostid, NULL, NULL, NULL, NULL, NULL, NULL,
-				NULL, &db_httpstep.status_codes, MACRO_TYPE_COMMON, NULL, 0);
+	httptest->httptest.ssl_cert_file = zbx_strdup(NULL, row[11]);
+	zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, NULL, host, NULL, NULL, NULL, NULL, NULL,
+			NULL, &httptest->httptest.ssl_cert_file, MACRO_TYPE_HTTPTEST_FIELD, NULL, 0);
 
-		db_httpstep.post_type = atoi(row[8]);
+	httptest->httptest.ssl_key_file = zbx_strdup(NULL, row[12]);
+	zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, NULL, host, NULL, NULL, NULL, NULL, NULL,
+			NULL, &httptest->httptest.ssl_key_file, MACRO_TYPE_HTTPTEST_FIELD, NULL, 0);
 
-		if (ZBX_POSTTYPE_RAW == db_httpstep.post_type)
-		{
-			db_httpstep.posts = zbx_strdup(NULL, row[5]);
-			zbx_substitute_simple_macros_unmasked(NULL, NULL, NULL, NULL, NULL, host, NULL, NULL, NULL, NULL,
-					NULL, NULL, &db_httpstep.posts, MACRO_TYPE_HTTPTEST_FIELD, NULL, 0);
-			http_substitute_variables(httptest, &db_httpstep.posts);
-		}
-		else
-			db_httpstep.posts = NULL;
+	httptest->httptest.ssl_key_password = zbx_strdup(NULL, row[13]);
+	zbx_substitute_simple_macros_unmasked(NULL, NULL, NULL, NULL, &host->hostid, NULL, NULL, NULL,
+			NULL, NULL, NULL, NULL, &httptest->httptest.ssl_key_password, MACRO_TYPE_COMMON,
+			NULL, 0);
 
-		if (SUCCEED != httpstep_load_pairs(host, &httpstep))
-		{
-			err_str = zbx_strdup(err_str, "cannot load web scenario step data");
-			goto httpstep_error;
-		}
+	httptest->httptest.verify_peer = atoi(row[14]);
+	httptest->httptest.verify_host = atoi(row[15]);
 
-		buffer = zbx_strdup(buffer, row[4]);
-		zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &host->hostid, NULL, NULL, NULL, NULL, NULL, NULL,
-				NULL, &buffer, MACRO_TYPE_COMMON, NULL, 0);
+	httptest->httptest.delay = zbx_strdup(NULL, row[16]);
 
-		if (SUCCEED != zbx_is_time_suffix(buffer, &db_httpstep.timeout, ZBX_LENGTH_UNLIMITED))
-		{
-			err_str = zbx_dsprintf(err_str, "timeout \"%s\" is invalid", buffer);
-			goto httpstep_error;
-		}
-		else if (db_httpstep.timeout < 1 || SEC_PER_HOUR < db_httpstep.timeout)
-		{
-			err_str = zbx_dsprintf(err_str, "timeout \"%s\" is out of 1-3600 seconds bounds", buffer);
-			goto httpstep_error;
-		}
+	/* add httptest variables to the current test macro cache */
+	http_process_variables(httptest, &httptest->variables, NULL, NULL);
+out:
+	zbx_db_free_result(result);
 
-		db_httpstep.follow_redirects = atoi(row[9]);
-		db_httpstep.retrieve_mode = atoi(row[10]);
+	return run;
+}
 
-		memset(&stat, 0, sizeof(stat));
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finish web scenario execution, process its data and queue it for  *
+ *          the next check                                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	httptest_run_finish(zbx_httptest_run_t *run)
+{
+	zbx_httptest_t	*httptest = &run->httptest;
+	zbx_timespec_t	ts;
 
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() use step \"%s\"", __func__, db_httpstep.name);
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() use post \"%s\"", __func__, ZBX_NULL2EMPTY_STR(httpstep.posts));
+	zbx_timespec(&ts);
 
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POSTFIELDS, httpstep.posts)))
+	if (NULL != run->err_str)
+	{
+		if (0 >= run->lastfailedstep)
 		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
-		}
+			/* we are here because web scenario update interval is invalid, */
+			/* cURL initialization failed or we have been compiled without cURL library */
 
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POST, (NULL != httpstep.posts &&
-				'\0' != *httpstep.posts) ? 1L : 0L)))
-		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
+			run->lastfailedstep = 1;
 		}
 
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_FOLLOWLOCATION,
-				0 == db_httpstep.follow_redirects ? 0L : 1L)))
+		if (NULL != run->db_httpstep.name)
 		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot process step \"%s\" of web scenario \"%s\" on host \"%s\": "
+					"%s", run->db_httpstep.name, httptest->httptest.name, run->host.name,
+					run->err_str);
 		}
+	}
 
-		if (0 != db_httpstep.follow_redirects)
-		{
-			if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_MAXREDIRS, ZBX_CURLOPT_MAXREDIRS)))
-			{
-				err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-				goto httpstep_error;
-			}
-		}
+	if (0 != run->speed_download_num)
+		run->speed_download /= run->speed_download_num;
 
-		/* headers defined in a step overwrite headers defined in scenario */
-		if (NULL != httpstep.headers && '\0' != *httpstep.headers)
-			add_http_headers(httpstep.headers, &headers_slist, &header_cookie);
-		else if (NULL != httptest->headers && '\0' != *httptest->headers)
-			add_http_headers(httptest->headers, &headers_slist, &header_cookie);
+	process_test_data(httptest->httptest.httptestid, run->lastfailedstep, run->speed_download, run->err_str,
+			&ts);
 
-		err = curl_easy_setopt(easyhandle, CURLOPT_COOKIE, header_cookie);
-		zbx_free(header_cookie);
+	zbx_dc_httptest_queue(run->now, httptest->httptest.httptestid, run->delay);
 
-		if (CURLE_OK != err)
-		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
-		}
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() httptestid:" ZBX_FS_UI64 " name:'%s' lastfailedstep:%d", __func__,
+			httptest->httptest.httptestid, httptest->httptest.name, run->lastfailedstep);
 
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_HTTPHEADER, headers_slist)))
-		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
-		}
+#ifdef HAVE_LIBCURL
+	if (NULL != run->easyhandle)
+		curl_easy_cleanup(run->easyhandle);
+#endif
+	zbx_db_free_result(run->result);
+	zbx_free(run->err_str);
 
-		switch (db_httpstep.retrieve_mode)
-		{
-			case ZBX_RETRIEVE_MODE_CONTENT:
-				curl_header_cb = curl_ignore_cb;
-				curl_body_cb = curl_write_cb;
-				break;
-			case ZBX_RETRIEVE_MODE_BOTH:
-				curl_header_cb = curl_body_cb = curl_write_cb;
-				break;
-			case ZBX_RETRIEVE_MODE_HEADERS:
-				curl_header_cb = curl_write_cb;
-				curl_body_cb = curl_ignore_cb;
-				break;
-			default:
-				THIS_SHOULD_NEVER_HAPPEN;
-				err_str = zbx_strdup(err_str, "invalid retrieve mode");
-				goto httpstep_error;
-		}
+	zbx_free(httptest->httptest.delay);
+	zbx_free(httptest->httptest.ssl_key_password);
+	zbx_free(httptest->httptest.ssl_key_file);
+	zbx_free(httptest->httptest.ssl_cert_file);
+	zbx_free(httptest->httptest.http_proxy);
 
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_WRITEFUNCTION, curl_body_cb)) ||
-				CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_HEADERFUNCTION, curl_header_cb)))
-		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
-		}
+	if (HTTPTEST_AUTH_NONE != httptest->httptest.authentication)
+	{
+		zbx_free(httptest->httptest.http_password);
+		zbx_free(httptest->httptest.http_user);
+	}
+	zbx_free(httptest->httptest.agent);
+	zbx_free(httptest->httptest.name);
+	zbx_free(httptest->headers);
+	httppairs_free(&httptest->variables);
 
-		/* enable/disable fetching the body */
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_NOBODY,
-				ZBX_RETRIEVE_MODE_HEADERS == db_httpstep.retrieve_mode ? 1L : 0L)))
-		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
-		}
+	/* destroy the macro cache used in this http test */
+	httptest_remove_macros(httptest);
+	zbx_vector_ptr_pair_destroy(&httptest->macros);
 
-		if (SUCCEED != zbx_http_prepare_auth(easyhandle, httptest->httptest.authentication,
-				httptest->httptest.http_user, httptest->httptest.http_password, NULL, &err_str))
-		{
-			goto httpstep_error;
-		}
+	run->poller->running--;
+	run->poller->finished++;
 
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() go to URL \"%s\"", __func__, httpstep.url);
+	zbx_free(run);
+}
 
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_TIMEOUT, (long)db_httpstep.timeout)) ||
-				CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_URL, httpstep.url)))
-		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
-		}
+#ifdef HAVE_LIBCURL
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free resources of the executed web scenario step                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	httpstep_clean(zbx_httptest_run_t *run)
+{
+	zbx_free(run->db_httpstep.status_codes);
+	zbx_free(run->db_httpstep.required);
+	zbx_free(run->db_httpstep.posts);
+	zbx_free(run->db_httpstep.url);
 
-		/* try to retrieve page several times depending on number of retries */
-		do
-		{
-			memset(&page, 0, sizeof(page));
-			errbuf[0] = '\0';
+	httppairs_free(&run->httpstep.variables);
 
-			if (CURLE_OK == (err = curl_easy_perform(easyhandle)))
-				break;
+	if (ZBX_POSTTYPE_FORM == run->db_httpstep.post_type)
+		zbx_free(run->httpstep.posts);
 
-			zbx_free(page.data);
-		}
-		while (0 < --httptest->httptest.retries);
+	zbx_free(run->httpstep.url);
+	zbx_free(run->httpstep.headers);
 
-		curl_slist_free_all(headers_slist);	/* must be called after curl_easy_perform() */
+	curl_slist_free_all(run->headers_slist);
+	run->headers_slist = NULL;
 
-		if (CURLE_OK == err)
-		{
-			char	*var_err_str = NULL;
+	zbx_free(run->page.data);
+}
 
-			zabbix_log(LOG_LEVEL_TRACE, "%s() page.data from %s:'%s'", __func__, httpstep.url, page.data);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepare request of web scenario step                              *
+ *                                                                            *
+ * Parameters: run - [IN/OUT] the web scenario being executed                 *
+ *             row - [IN] the step data                                       *
+ *                                                                            *
+ * Return value: SUCCEED - the request was prepared                           *
+ *               FAIL    - otherwise, run->err_str contains error message     *
+ *                                                                            *
+ ******************************************************************************/
+static int	httpstep_prepare(zbx_httptest_run_t *run, zbx_db_row_t row)
+{
+	zbx_httptest_t	*httptest = &run->httptest;
+	zbx_db_httpstep	*db_httpstep = &run->db_httpstep;
+	zbx_httpstep_t	*httpstep = &run->httpstep;
+	zbx_dc_host_t	*host = &run->host;
+	CURL		*easyhandle = run->easyhandle;
+	char		*header_cookie = NULL, *buffer = NULL;
+	CURLcode	err;
+	int		ret = FAIL;
+	size_t		(*curl_header_cb)(void *ptr, size_t size, size_t nmemb, void *userdata);
+	size_t		(*curl_body_cb)(void *ptr, size_t size, size_t nmemb, void *userdata);
 
-			/* first get the data that is needed even if step fails */
-			if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_RESPONSE_CODE, &stat.rspcode)))
-			{
-				err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			}
-			else if ('\0' != *db_httpstep.status_codes &&
-					FAIL == zbx_int_in_list(db_httpstep.status_codes, stat.rspcode))
-			{
-				err_str = zbx_dsprintf(err_str, "response code \"%ld\" did not match any of the"
-						" required status codes \"%s\"", stat.rspcode,
-						db_httpstep.status_codes);
-			}
+	ZBX_STR2UINT64(db_httpstep->httpstepid, row[0]);
+	db_httpstep->httptestid = httptest->httptest.httptestid;
+	db_httpstep->no = atoi(row[1]);
+	db_httpstep->name = row[2];
 
-			if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_TOTAL_TIME, &stat.total_time)) &&
-					NULL == err_str)
-			{
-				err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			}
+	db_httpstep->url = zbx_strdup(NULL, row[3]);
+	zbx_substitute_simple_macros_unmasked(NULL, NULL, NULL, NULL, NULL, host, NULL, NULL, NULL, NULL, NULL,
+			NULL, &db_httpstep->url, MACRO_TYPE_HTTPTEST_FIELD, NULL, 0);
+	http_substitute_variables(httptest, &db_httpstep->url);
 
-			if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, ZBX_CURLINFO_SPEED_DOWNLOAD,
-					&stat.speed_download)) && NULL == err_str)
-			{
-				err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			}
-			else
-			{
-				speed_download += stat.speed_download;
-				speed_download_num++;
-			}
+	db_httpstep->required = zbx_strdup(NULL, row[6]);
+	zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, NULL, host, NULL, NULL, NULL, NULL, NULL, NULL,
+			&db_httpstep->required, MACRO_TYPE_HTTPTEST_FIELD, NULL, 0);
 
-			/* required pattern */
-			if (NULL == err_str && '\0' != *db_httpstep.required &&
-					NULL == zbx_regexp_match(page.data, db_httpstep.required, NULL))
-			{
-				err_str = zbx_dsprintf(err_str, "required pattern \"%s\" was not found on %s",
-						db_httpstep.required, httpstep.url);
-			}
+	db_httpstep->status_codes = zbx_strdup(NULL, row[7]);
+	zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &host->hostid, NULL, NULL, NULL, NULL, NULL, NULL,
+			NULL, &db_httpstep->status_codes, MACRO_TYPE_COMMON, NULL, 0);
 
-			/* variables defined in scenario */
-			if (NULL == err_str && FAIL == http_process_variables(httptest, &httptest->variables, page.data,
-					&var_err_str))
-			{
-				char	*variables = NULL;
-				size_t	alloc_len = 0, offset;
+	db_httpstep->post_type = atoi(row[8]);
 
-				httpstep_pairs_join(&variables, &alloc_len, &offset, "=", " ", &httptest->variables);
+	if (ZBX_POSTTYPE_RAW == db_httpstep->post_type)
+	{
+		db_httpstep->posts = zbx_strdup(NULL, row[5]);
+		zbx_substitute_simple_macros_unmasked(NULL, NULL, NULL, NULL, NULL, host, NULL, NULL, NULL, NULL,
+				NULL, NULL, &db_httpstep->posts, MACRO_TYPE_HTTPTEST_FIELD, NULL, 0);
+		http_substitute_variables(httptest, &db_httpstep->posts);
+	}
+	else
+		db_httpstep->posts = NULL;
 
-				err_str = zbx_dsprintf(err_str, "error in scenario variables \"%s\": %s", variables,
-						var_err_str);
+	if (SUCCEED != httpstep_load_pairs(host, httpstep))
+	{
+		run->err_str = zbx_strdup(run->err_str, "cannot load web scenario step data");
+		goto out;
+	}
 
-				zbx_free(variables);
-			}
+	buffer = zbx_strdup(buffer, row[4]);
+	zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &host->hostid, NULL, NULL, NULL, NULL, NULL, NULL,
+			NULL, &buffer, MACRO_TYPE_COMMON, NULL, 0);
 
-			/* variables defined in a step */
-			if (NULL == err_str && FAIL == http_process_variables(httptest, &httpstep.variables, page.data,
-					&var_err_str))
-			{
-				char	*variables = NULL;
-				size_t	alloc_len = 0, offset;
+	if (SUCCEED != zbx_is_time_suffix(buffer, &db_httpstep->timeout, ZBX_LENGTH_UNLIMITED))
+	{
+		run->err_str = zbx_dsprintf(run->err_str, "timeout \"%s\" is invalid", buffer);
+		goto out;
+	}
+	else if (db_httpstep->timeout < 1 || SEC_PER_HOUR < db_httpstep->timeout)
+	{
+		run->err_str = zbx_dsprintf(run->err_str, "timeout \"%s\" is out of 1-3600 seconds bounds", buffer);
+		goto out;
+	}
 
-				httpstep_pairs_join(&variables, &alloc_len, &offset, "=", " ", &httpstep.variables);
+	db_httpstep->follow_redirects = atoi(row[9]);
+	db_httpstep->retrieve_mode = atoi(row[10]);
 
-				err_str = zbx_dsprintf(err_str, "error in step variables \"%s\": %s", variables,
-						var_err_str);
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() use step \"%s\"", __func__, db_httpstep->name);
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() use post \"%s\"", __func__, ZBX_NULL2EMPTY_STR(httpstep->posts));
 
-				zbx_free(variables);
-			}
+	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POSTFIELDS, httpstep->posts)))
+	{
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-			zbx_free(var_err_str);
+	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POST, (NULL != httpstep->posts &&
+			'\0' != *httpstep->posts) ? 1L : 0L)))
+	{
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-			zbx_timespec(&ts);
-			process_step_data(db_httpstep.httpstepid, &stat, &ts);
+	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_FOLLOWLOCATION,
+			0 == db_httpstep->follow_redirects ? 0L : 1L)))
+	{
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-			zbx_free(page.data);
+	if (0 != db_httpstep->follow_redirects)
+	{
+		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_MAXREDIRS, ZBX_CURLOPT_MAXREDIRS)))
+		{
+			run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+			goto out;
 		}
-		else
-			err_str = zbx_dsprintf(err_str, "%s", 0 < strlen(errbuf) ? errbuf : curl_easy_strerror(err));
+	}
 
-httpstep_error:
-		zbx_free(db_httpstep.status_codes);
-		zbx_free(db_httpstep.required);
-		zbx_free(db_httpstep.posts);
-		zbx_free(db_httpstep.url);
+	/* headers defined in a step overwrite headers defined in scenario */
+	if (NULL != httpstep->headers && '\0' != *httpstep->headers)
+		add_http_headers(httpstep->headers, &run->headers_slist, &header_cookie);
+	else if (NULL != httptest->headers && '\0' != *httptest->headers)
+		add_http_headers(httptest->headers, &run->headers_slist, &header_cookie);
 
-		httppairs_free(&httpstep.variables);
+	err = curl_easy_setopt(easyhandle, CURLOPT_COOKIE, header_cookie);
+	zbx_free(header_cookie);
 
-		if (ZBX_POSTTYPE_FORM == httpstep.httpstep->post_type)
-			zbx_free(httpstep.posts);
+	if (CURLE_OK != err)
+	{
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-		zbx_free(httpstep.url);
-		zbx_free(httpstep.headers);
+	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_HTTPHEADER, run->headers_slist)))
+	{
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-		if (NULL != err_str)
-		{
-			lastfailedstep = db_httpstep.no;
+	switch (db_httpstep->retrieve_mode)
+	{
+		case ZBX_RETRIEVE_MODE_CONTENT:
+			curl_header_cb = curl_ignore_cb;
+			curl_body_cb = curl_write_cb;
 			break;
-		}
+		case ZBX_RETRIEVE_MODE_BOTH:
+			curl_header_cb = curl_body_cb = curl_write_cb;
+			break;
+		case ZBX_RETRIEVE_MODE_HEADERS:
+			curl_header_cb = curl_write_cb;
+			curl_body_cb = curl_ignore_cb;
+			break;
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			run->err_str = zbx_strdup(run->err_str, "invalid retrieve mode");
+			goto out;
 	}
-clean:
-	curl_easy_cleanup(easyhandle);
-#else
-	ZBX_UNUSED(config_source_ip);
-	err_str = zbx_strdup(err_str, "cURL library is required for Web monitoring support");
-#endif	/* HAVE_LIBCURL */
-
-httptest_error:
-	zbx_timespec(&ts);
 
-	if (NULL != err_str)
+	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_WRITEFUNCTION, curl_body_cb)) ||
+			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_WRITEDATA, &run->page)) ||
+			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_HEADERFUNCTION, curl_header_cb)) ||
+			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_HEADERDATA, &run->page)))
 	{
-		if (0 >= lastfailedstep)
-		{
-			/* we are here because web scenario update interval is invalid, */
-			/* cURL initialization failed or we have been compiled without cURL library */
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-			lastfailedstep = 1;
-		}
+	/* enable/disable fetching the body */
+	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_NOBODY,
+			ZBX_RETRIEVE_MODE_HEADERS == db_httpstep->retrieve_mode ? 1L : 0L)))
+	{
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-		if (NULL != db_httpstep.name)
-		{
-			zabbix_log(LOG_LEVEL_DEBUG, "cannot process step \"%s\" of web scenario \"%s\" on host \"%s\": "
-					"%s", db_httpstep.name, httptest->httptest.name, host->name, err_str);
-		}
+	if (SUCCEED != zbx_http_prepare_auth(easyhandle, httptest->httptest.authentication,
+			httptest->httptest.http_user, httptest->httptest.http_password, NULL, &run->err_str))
+	{
+		goto out;
 	}
-	zbx_db_free_result(result);
 
-	if (0 != speed_download_num)
-		speed_download /= speed_download_num;
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() go to URL \"%s\"", __func__, httpstep->url);
 
-	process_test_data(httptest->httptest.httptestid, lastfailedstep, speed_download, err_str, &ts);
+	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_TIMEOUT, (long)db_httpstep->timeout)) ||
+			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_URL, httpstep->url)))
+	{
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
+	ret = SUCCEED;
+out:
 	zbx_free(buffer);
-	zbx_free(err_str);
-	zbx_preprocessor_flush();
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	return ret;
 }
 
+static void	httpstep_done_cb(CURLcode err, void *arg);
+
 /******************************************************************************
  *                                                                            *
- * Purpose: process httptests                                                 *
+ * Purpose: start transfer of the prepared step request                       *
  *                                                                            *
- * Parameters: now              - [IN] current timestamp                      *
- *             config_source_ip - [IN]                                        *
- *             nextcheck        - [OUT]                                       *
- *                                                                            *
- * Return value: number of processed httptests                                *
+ ******************************************************************************/
+static int	httpstep_perform(zbx_httptest_run_t *run)
+{
+	memset(&run->page, 0, sizeof(run->page));
+	run->errbuf[0] = '\0';
+
+	return zbx_async_http_add(run->poller->http, run->easyhandle, httpstep_done_cb, run, &run->err_str);
+}
+
+/******************************************************************************
  *                                                                            *
- * Comments: always SUCCEED                                                   *
+ * Purpose: check the received page and extract variables                     *
  *                                                                            *
  ******************************************************************************/
-int	process_httptests(int now, const char *config_source_ip, time_t *nextcheck)
+static void	httpstep_process_page(zbx_httptest_run_t *run)
 {
-	zbx_db_result_t		result;
-	zbx_db_row_t		row;
-	zbx_uint64_t		httptestid;
-	zbx_httptest_t		httptest;
-	zbx_dc_host_t		host;
-	int			httptests_count = 0;
-	zbx_dc_um_handle_t	*um_handle;
+	zbx_httptest_t	*httptest = &run->httptest;
+	zbx_db_httpstep	*db_httpstep = &run->db_httpstep;
+	zbx_httpstep_t	*httpstep = &run->httpstep;
+	CURL		*easyhandle = run->easyhandle;
+	zbx_httpstat_t	stat;
+	zbx_timespec_t	ts;
+	char		*var_err_str = NULL;
+	CURLcode	err;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	memset(&stat, 0, sizeof(stat));
 
-	if (SUCCEED != zbx_dc_httptest_next(now, &httptestid, nextcheck))
-		goto out;
+	zabbix_log(LOG_LEVEL_TRACE, "%s() page.data from %s:'%s'", __func__, httpstep->url, run->page.data);
 
-	um_handle = zbx_dc_open_user_macros();
+	/* first get the data that is needed even if step fails */
+	if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_RESPONSE_CODE, &stat.rspcode)))
+	{
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+	}
+	else if ('\0' != *db_httpstep->status_codes &&
+			FAIL == zbx_int_in_list(db_httpstep->status_codes, stat.rspcode))
+	{
+		run->err_str = zbx_dsprintf(run->err_str, "response code \"%ld\" did not match any of the"
+				" required status codes \"%s\"", stat.rspcode, db_httpstep->status_codes);
+	}
 
-	/* create macro cache to use in http tests */
-	zbx_vector_ptr_pair_create(&httptest.macros);
+	if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_TOTAL_TIME, &stat.total_time)) &&
+			NULL == run->err_str)
+	{
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+	}
 
-	do
+	if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, ZBX_CURLINFO_SPEED_DOWNLOAD,
+			&stat.speed_download)) && NULL == run->err_str)
 	{
-		int	delay = 0;
-
-		result = zbx_db_select(
-				"select h.hostid,h.host,h.name,t.httptestid,t.name,t.agent,"
-					"t.authentication,t.http_user,t.http_password,t.http_proxy,t.retries,t.ssl_cert_file,"
-					"t.ssl_key_file,t.ssl_key_password,t.verify_peer,t.verify_host,t.delay"
-				" from httptest t,hosts h"
-				" where t.hostid=h.hostid"
-					" and t.httptestid=" ZBX_FS_UI64,
-				httptestid);
-
-		if (NULL != (row = zbx_db_fetch(result)))
-		{
-			ZBX_STR2UINT64(host.hostid, row[0]);
-			zbx_strscpy(host.host, row[1]);
-			zbx_strlcpy_utf8(host.name, row[2], sizeof(host.name));
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+	}
+	else
+	{
+		run->speed_download += stat.speed_download;
+		run->speed_download_num++;
+	}
 
-			ZBX_STR2UINT64(httptest.httptest.httptestid, row[3]);
-			httptest.httptest.name = row[4];
+	/* required pattern */
+	if (NULL == run->err_str && '\0' != *db_httpstep->required &&
+			NULL == zbx_regexp_match(run->page.data, db_httpstep->required, NULL))
+	{
+		run->err_str = zbx_dsprintf(run->err_str, "required pattern \"%s\" was not found on %s",
+				db_httpstep->required, httpstep->url);
+	}
 
-			if (SUCCEED != httptest_load_pairs(&host, &httptest))
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "cannot process web scenario \"%s\" on host \"%s\": "
-						"cannot load web scenario data", httptest.httptest.name, host.name);
-				zbx_db_free_result(result);
-				THIS_SHOULD_NEVER_HAPPEN;
-				continue;
-			}
+	/* variables defined in scenario */
+	if (NULL == run->err_str && FAIL == http_process_variables(httptest, &httptest->variables, run->page.data,
+			&var_err_str))
+	{
+		char	*variables = NULL;
+		size_t	alloc_len = 0, offset;
 
-			httptest.httptest.agent = zbx_strdup(NULL, row[5]);
-			zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &host.hostid, NULL, NULL, NULL, NULL, NULL,
-					NULL, NULL, &httptest.httptest.agent, MACRO_TYPE_COMMON, NULL, 0);
+		httpstep_pairs_join(&variables, &alloc_len, &offset, "=", " ", &httptest->variables);
 
-			if (HTTPTEST_AUTH_NONE != (httptest.httptest.authentication = atoi(row[6])))
-			{
-				httptest.httptest.http_user = zbx_strdup(NULL, row[7]);
-				zbx_substitute_simple_macros_unmasked(NULL, NULL, NULL, NULL, &host.hostid, NULL, NULL,
-						NULL, NULL, NULL, NULL, NULL, &httptest.httptest.http_user,
-						MACRO_TYPE_COMMON, NULL, 0);
-
-				httptest.httptest.http_password = zbx_strdup(NULL, row[8]);
-				zbx_substitute_simple_macros_unmasked(NULL, NULL, NULL, NULL, &host.hostid, NULL, NULL,
-						NULL, NULL, NULL, NULL, NULL, &httptest.httptest.http_password,
-						MACRO_TYPE_COMMON, NULL, 0);
-			}
+		run->err_str = zbx_dsprintf(run->err_str, "error in scenario variables \"%s\": %s", variables,
+				var_err_str);
 
-			if ('\0' != *row[9])
-			{
-				httptest.httptest.http_proxy = zbx_strdup(NULL, row[9]);
-				zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &host.hostid, NULL, NULL, NULL,
-						NULL, NULL, NULL, NULL, &httptest.httptest.http_proxy,
-						MACRO_TYPE_COMMON, NULL, 0);
-			}
-			else
-				httptest.httptest.http_proxy = NULL;
+		zbx_free(variables);
+	}
 
-			httptest.httptest.retries = atoi(row[10]);
+	/* variables defined in a step */
+	if (NULL == run->err_str && FAIL == http_process_variables(httptest, &httpstep->variables, run->page.data,
+			&var_err_str))
+	{
+		char	*variables = NULL;
+		size_t	alloc_len = 0, offset;
 
-			httptest.httptest.ssl_cert_file = zbx_strdup(NULL, row[11]);
-			zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, NULL, &host, NULL, NULL, NULL, NULL, NULL,
-					NULL, &httptest.httptest.ssl_cert_file, MACRO_TYPE_HTTPTEST_FIELD, NULL, 0);
+		httpstep_pairs_join(&variables, &alloc_len, &offset, "=", " ", &httpstep->variables);
 
-			httptest.httptest.ssl_key_file = zbx_strdup(NULL, row[12]);
-			zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, NULL, &host, NULL, NULL, NULL, NULL, NULL,
-					NULL, &httptest.httptest.ssl_key_file, MACRO_TYPE_HTTPTEST_FIELD, NULL, 0);
+		run->err_str = zbx_dsprintf(run->err_str, "error in step variables \"%s\": %s", variables,
+				var_err_str);
 
-			httptest.httptest.ssl_key_password = zbx_strdup(NULL, row[13]);
-			zbx_substitute_simple_macros_unmasked(NULL, NULL, NULL, NULL, &host.hostid, NULL, NULL, NULL,
-					NULL, NULL, NULL, NULL, &httptest.httptest.ssl_key_password, MACRO_TYPE_COMMON,
-					NULL, 0);
+		zbx_free(variables);
+	}
 
-			httptest.httptest.verify_peer = atoi(row[14]);
-			httptest.httptest.verify_host = atoi(row[15]);
+	zbx_free(var_err_str);
 
-			httptest.httptest.delay = row[16];
+	zbx_timespec(&ts);
+	process_step_data(db_httpstep->httpstepid, &stat, &ts);
+}
 
-			/* add httptest variables to the current test macro cache */
-			http_process_variables(&httptest, &httptest.variables, NULL, NULL);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start the next web scenario step or finish the scenario if there  *
+ *          are no more steps                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	httptest_run_next_step(zbx_httptest_run_t *run)
+{
+	zbx_db_row_t	row;
 
-			process_httptest(&host, &httptest, &delay, config_source_ip);
-			zbx_dc_httptest_queue(now, httptestid, delay);
+	if (NULL == (row = zbx_db_fetch(run->result)) || !ZBX_IS_RUNNING())
+	{
+		httptest_run_finish(run);
+		return;
+	}
 
-			zbx_free(httptest.httptest.ssl_key_password);
-			zbx_free(httptest.httptest.ssl_key_file);
-			zbx_free(httptest.httptest.ssl_cert_file);
-			zbx_free(httptest.httptest.http_proxy);
+	if (SUCCEED != httpstep_prepare(run, row) || SUCCEED != httpstep_perform(run))
+	{
+		httpstep_clean(run);
+		run->lastfailedstep = run->db_httpstep.no;
+		httptest_run_finish(run);
+	}
+}
 
-			if (HTTPTEST_AUTH_NONE != httptest.httptest.authentication)
-			{
-				zbx_free(httptest.httptest.http_password);
-				zbx_free(httptest.httptest.http_user);
-			}
-			zbx_free(httptest.httptest.agent);
-			zbx_free(httptest.headers);
-			httppairs_free(&httptest.variables);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process finished transfer of web scenario step                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	httpstep_done_cb(CURLcode err, void *arg)
+{
+	zbx_httptest_run_t	*run = (zbx_httptest_run_t *)arg;
 
-			/* clear the macro cache used in this http test */
-			httptest_remove_macros(&httptest);
+	if (CURLE_OK == err)
+	{
+		httpstep_process_page(run);
+	}
+	else
+	{
+		zbx_free(run->page.data);
 
-			httptests_count++;	/* performance metric */
+		/* try to retrieve page several times depending on number of retries */
+		if (0 < --run->httptest.httptest.retries && ZBX_IS_RUNNING())
+		{
+			if (SUCCEED == httpstep_perform(run))
+				return;
+		}
+		else
+		{
+			run->err_str = zbx_dsprintf(run->err_str, "%s", 0 < strlen(run->errbuf) ? run->errbuf :
+					curl_easy_strerror(err));
 		}
-		zbx_db_free_result(result);
 	}
-	while (ZBX_IS_RUNNING() && SUCCEED == zbx_dc_httptest_next(now, &httptestid, nextcheck));
 
-	/* destroy the macro cache used in http tests */
-	zbx_vector_ptr_pair_destroy(&httptest.macros);
+	httpstep_clean(run);
+
+	if (NULL != run->err_str)
+	{
+		run->lastfailedstep = run->db_httpstep.no;
+		httptest_run_finish(run);
+		return;
+	}
+
+	httptest_run_next_step(run);
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start web scenario execution                                      *
+ *                                                                            *
+ * Comments: The scenario steps are executed by HTTP poller event loop and    *
+ *           the scenario is finished when the last step is processed or any  *
+ *           step fails.                                                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	httptest_run_start(zbx_httptest_run_t *run, const char *config_source_ip)
+{
+	zbx_httptest_t	*httptest = &run->httptest;
+	char		*buffer;
+#ifdef HAVE_LIBCURL
+	CURLcode	err;
+#endif
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() httptestid:" ZBX_FS_UI64 " name:'%s'",
+			__func__, httptest->httptest.httptestid, httptest->httptest.name);
+
+	buffer = zbx_strdup(NULL, httptest->httptest.delay);
+	zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &run->host.hostid, NULL, NULL, NULL, NULL, NULL, NULL,
+			NULL, &buffer, MACRO_TYPE_COMMON, NULL, 0);
+
+	if (SUCCEED != zbx_is_time_suffix(buffer, &run->delay, ZBX_LENGTH_UNLIMITED))
+	{
+		run->err_str = zbx_dsprintf(run->err_str, "update interval \"%s\" is invalid", buffer);
+		run->lastfailedstep = -1;
+		run->delay = ZBX_DEFAULT_INTERVAL;
+		goto fail;
+	}
+
+#ifdef HAVE_LIBCURL
+	if (NULL == (run->easyhandle = curl_easy_init()))
+	{
+		run->err_str = zbx_strdup(run->err_str, "cannot initialize cURL library");
+		goto fail;
+	}
+
+	if (CURLE_OK != (err = curl_easy_setopt(run->easyhandle, CURLOPT_PROXY, httptest->httptest.http_proxy)) ||
+			CURLE_OK != (err = curl_easy_setopt(run->easyhandle, CURLOPT_COOKIEFILE, "")) ||
+			CURLE_OK != (err = curl_easy_setopt(run->easyhandle, CURLOPT_USERAGENT,
+			httptest->httptest.agent)) ||
+			CURLE_OK != (err = curl_easy_setopt(run->easyhandle, CURLOPT_ERRORBUFFER, run->errbuf)) ||
+			CURLE_OK != (err = curl_easy_setopt(run->easyhandle, ZBX_CURLOPT_ACCEPT_ENCODING, "")))
+	{
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+		goto fail;
+	}
+
+#if LIBCURL_VERSION_NUM >= 0x071304
+	/* CURLOPT_PROTOCOLS is supported starting with version 7.19.4 (0x071304) */
+	if (CURLE_OK != (err = curl_easy_setopt(run->easyhandle, CURLOPT_PROTOCOLS,
+			CURLPROTO_HTTP | CURLPROTO_HTTPS)))
+	{
+		run->err_str = zbx_strdup(run->err_str, curl_easy_strerror(err));
+		goto fail;
+	}
+#endif
+
+	if (SUCCEED != zbx_http_prepare_ssl(run->easyhandle, httptest->httptest.ssl_cert_file,
+			httptest->httptest.ssl_key_file, httptest->httptest.ssl_key_password,
+			httptest->httptest.verify_peer, httptest->httptest.verify_host, config_source_ip,
+			&run->err_str))
+	{
+		goto fail;
+	}
+
+	run->httpstep.httptest = httptest;
+	run->httpstep.httpstep = &run->db_httpstep;
+
+	run->result = zbx_db_select(
+			"select httpstepid,no,name,url,timeout,posts,required,status_codes,post_type,follow_redirects,"
+				"retrieve_mode"
+			" from httpstep"
+			" where httptestid=" ZBX_FS_UI64
+			" order by no",
+			httptest->httptest.httptestid);
+
+	zbx_free(buffer);
+	httptest_run_next_step(run);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+
+	return;
+#else
+	ZBX_UNUSED(config_source_ip);
+	run->err_str = zbx_strdup(run->err_str, "cURL library is required for Web monitoring support");
+#endif	/* HAVE_LIBCURL */
+fail:
+	zbx_free(buffer);
+	httptest_run_finish(run);
 
-	zbx_dc_close_user_macros(um_handle);
-out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start execution of web scenarios due for checking                 *
+ *                                                                            *
+ * Parameters: poller    - [IN/OUT] the HTTP poller                           *
+ *             now       - [IN] current timestamp                             *
+ *             nextcheck - [OUT] the time of the next scheduled web scenario  *
+ *                                                                            *
+ * Return value: number of started web scenarios                              *
+ *                                                                            *
+ * Comments: The number of web scenarios executed at once is limited by       *
+ *           poller->max_running. The scenarios are finished by HTTP poller   *
+ *           event loop, scenarios that failed to start are finished at once. *
+ *                                                                            *
+ ******************************************************************************/
+int	process_httptests(zbx_httptest_poller_t *poller, int now, time_t *nextcheck)
+{
+	zbx_uint64_t	httptestid;
+	int		started = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() running:%d", __func__, poller->running);
+
+	while (poller->running < poller->max_running && ZBX_IS_RUNNING() &&
+			SUCCEED == zbx_dc_httptest_next(now, &httptestid, nextcheck))
+	{
+		zbx_httptest_run_t	*run;
+
+		if (NULL == (run = httptest_run_create(poller, now, httptestid)))
+			continue;
+
+		poller->running++;
+		started++;
+
+		httptest_run_start(run, poller->config_source_ip);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __func__, started);
 
-	return httptests_count;
+	return started;
 }
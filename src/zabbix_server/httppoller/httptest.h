@@ -22,6 +22,27 @@
 
 #include "zbxcommon.h"
 
-int	process_httptests(int now, const char *config_source_ip, time_t *nextcheck);
+#ifdef HAVE_LIBCURL
+#include "../poller/async_http.h"
+#endif
+
+/* web scenarios executed at once by HTTP poller */
+typedef struct
+{
+#ifdef HAVE_LIBCURL
+	zbx_async_http_t	*http;
+#endif
+	const char		*config_source_ip;
+	int			max_running;
+
+	/* the number of web scenarios in progress */
+	int			running;
+
+	/* the number of finished web scenarios, reset by HTTP poller */
+	int			finished;
+}
+zbx_httptest_poller_t;
+
+int	process_httptests(zbx_httptest_poller_t *poller, int now, time_t *nextcheck);
 
 #endif
@@ -136,6 +136,12 @@ static void	process_values(icmpitem_t *items, int first_index, int last_index, Z
 				continue;
 			}
 
+			if (NULL != host->error)
+			{
+				process_value(item->itemid, NULL, NULL, ts, NOTSUPPORTED, host->error);
+				continue;
+			}
+
 			if (0 == host->cnt)
 			{
 				process_value(item->itemid, NULL, NULL, ts, NOTSUPPORTED,
@@ -511,7 +517,7 @@ static void	add_pinger_host(ZBX_FPING_HOST **hosts, int *hosts_alloc, int *hosts
 
 static void	process_pinger_hosts(icmpitem_t *items, int items_count, int process_num, int process_type)
 {
-	int			i, first_index = 0, ping_result;
+	int			i, j, first_index = 0, ping_result;
 	char			error[ZBX_ITEM_ERROR_LEN_MAX];
 	static ZBX_FPING_HOST	*hosts = NULL;
 	static int		hosts_alloc = 4;
@@ -543,6 +549,9 @@ static void	process_pinger_hosts(icmpitem_t *items, int items_count, int process
 			if (FAIL != ping_result)
 				process_values(items, first_index, i + 1, hosts, hosts_count, &ts, ping_result, error);
 
+			for (j = 0; j < hosts_count; j++)
+				zbx_free(hosts[j].error);
+
 			hosts_count = 0;
 			first_index = i + 1;
 		}
@@ -0,0 +1,904 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "async_agent.h"
+
+#include "checks_agent.h"
+#include "zbxcomms.h"
+#include "zbxcompress.h"
+#include "zbxcrypto.h"
+#include "zbxsysinfo.h"
+#include "zbxtime.h"
+
+#include <event2/util.h>
+
+typedef enum
+{
+	ZBX_ASYNC_AGENT_STEP_RESOLVE,
+	ZBX_ASYNC_AGENT_STEP_CONNECT,
+	ZBX_ASYNC_AGENT_STEP_SEND,
+	ZBX_ASYNC_AGENT_STEP_RECV
+}
+zbx_async_agent_step_t;
+
+typedef enum
+{
+	ZBX_ASYNC_AGENT_HEADER_PENDING,
+	ZBX_ASYNC_AGENT_HEADER_PARSED,
+	ZBX_ASYNC_AGENT_HEADER_NONE
+}
+zbx_async_agent_header_t;
+
+typedef struct
+{
+	struct event_base			*base;
+	struct event				*event;
+	struct evdns_getaddrinfo_request	*dns_request;
+	zbx_async_agent_step_t			step;
+	evutil_socket_t				fd;
+	char					*addr;
+	unsigned short				port;
+	char					*source_ip;
+	double					deadline;
+
+	/* request data during send step, response data during receive step */
+	char					*buffer;
+	size_t					buffer_alloc;
+	size_t					buffer_offset;
+	size_t					send_len;
+
+	zbx_async_agent_header_t		header;
+	size_t					header_size;
+	unsigned char				protocol;
+	zbx_uint64_t				expected_len;
+	zbx_uint64_t				reserved;
+
+	AGENT_RESULT				*result;
+	zbx_async_agent_done_cb_t		done_cb;
+	void					*arg;
+
+	/* multiple passive checks, results are NULL for single check */
+	AGENT_RESULT				*results;
+	int					*errcodes;
+	int					keys_num;
+	int					replies_num;
+	int					timeout;
+}
+zbx_async_agent_t;
+
+static void	async_agent_event_cb(evutil_socket_t fd, short what, void *arg);
+
+static void	async_agent_free(zbx_async_agent_t *agent)
+{
+	if (NULL != agent->event)
+		event_free(agent->event);
+
+	if (-1 != agent->fd)
+		evutil_closesocket(agent->fd);
+
+	zbx_free(agent->buffer);
+	zbx_free(agent->source_ip);
+	zbx_free(agent->addr);
+	zbx_free(agent);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finish agent check and notify the caller                          *
+ *                                                                            *
+ * Parameters: agent - [IN] the agent check context                           *
+ *             ret   - [IN] the check result code                             *
+ *                                                                            *
+ * Comments: If name resolving is still in progress the context is released   *
+ *           by resolver callback after the request is cancelled.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_agent_finish(zbx_async_agent_t *agent, int ret)
+{
+	zbx_async_agent_done_cb_t		done_cb = agent->done_cb;
+	void					*arg = agent->arg;
+	struct evdns_getaddrinfo_request	*dns_request = agent->dns_request;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() addr:'%s' ret:%s", __func__, agent->addr, zbx_result_string(ret));
+
+	if (NULL != dns_request)
+	{
+		agent->done_cb = NULL;
+
+		if (NULL != agent->event)
+		{
+			event_free(agent->event);
+			agent->event = NULL;
+		}
+
+		evdns_getaddrinfo_cancel(dns_request);
+	}
+	else
+		async_agent_free(agent);
+
+	done_cb(ret, arg);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: fail the keys of multiple passive checks not replied yet          *
+ *                                                                            *
+ * Comments: The values already received are kept.                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_agent_batch_fail(zbx_async_agent_t *agent, int ret, const char *msg)
+{
+	for (int i = agent->replies_num; i < agent->keys_num; i++)
+	{
+		SET_MSG_RESULT(&agent->results[i], zbx_strdup(NULL, msg));
+		agent->errcodes[i] = ret;
+	}
+
+	async_agent_finish(agent, SUCCEED);
+}
+
+static void	async_agent_fail(zbx_async_agent_t *agent, int ret, char *error)
+{
+	char	*msg;
+
+	msg = zbx_dsprintf(NULL, "Get value from agent failed: %s", error);
+	zbx_free(error);
+
+	if (NULL != agent->results)
+	{
+		async_agent_batch_fail(agent, ret, msg);
+		zbx_free(msg);
+		return;
+	}
+
+	SET_MSG_RESULT(agent->result, msg);
+
+	async_agent_finish(agent, ret);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: wait for socket event within the remaining check time             *
+ *                                                                            *
+ * Parameters: agent - [IN] the agent check context                           *
+ *             what  - [IN] EV_READ or EV_WRITE                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_agent_wait(zbx_async_agent_t *agent, short what)
+{
+	struct timeval	tv;
+	double		remaining;
+
+	if (0 >= (remaining = agent->deadline - zbx_time()))
+	{
+		async_agent_fail(agent, TIMEOUT_ERROR, zbx_dsprintf(NULL, "timed out while communicating with"
+				" [[%s]:%hu]", agent->addr, agent->port));
+		return;
+	}
+
+	if (NULL != agent->event)
+		event_free(agent->event);
+
+	agent->event = event_new(agent->base, agent->fd, what, async_agent_event_cb, agent);
+
+	tv.tv_sec = (time_t)remaining;
+	tv.tv_usec = (suseconds_t)((remaining - (double)tv.tv_sec) * 1000000);
+
+	event_add(agent->event, &tv);
+}
+
+static void	async_agent_send(zbx_async_agent_t *agent)
+{
+	ssize_t	n;
+
+	while (agent->buffer_offset < agent->send_len)
+	{
+		if (-1 == (n = write(agent->fd, agent->buffer + agent->buffer_offset,
+				agent->send_len - agent->buffer_offset)))
+		{
+			if (EINTR == errno)
+				continue;
+
+			if (EAGAIN == errno || EWOULDBLOCK == errno)
+			{
+				async_agent_wait(agent, EV_WRITE);
+				return;
+			}
+
+			async_agent_fail(agent, NETWORK_ERROR, zbx_dsprintf(NULL, "cannot send data: %s",
+					zbx_strerror(errno)));
+			return;
+		}
+
+		agent->buffer_offset += (size_t)n;
+	}
+
+	agent->step = ZBX_ASYNC_AGENT_STEP_RECV;
+	agent->buffer_offset = 0;
+
+	async_agent_wait(agent, EV_READ);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parse Zabbix protocol header of the received data                 *
+ *                                                                            *
+ * Parameters: agent - [IN] the agent check context                           *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the header was parsed, more data is needed or the  *
+ *                         response has no header                             *
+ *               FAIL    - invalid header                                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	async_agent_parse_header(zbx_async_agent_t *agent, char **error)
+{
+	size_t	cmp_len = MIN(agent->buffer_offset, ZBX_AGENT_HEADER_LEN);
+
+	if (0 != strncmp(agent->buffer, ZBX_AGENT_HEADER_DATA, cmp_len))
+	{
+		/* older agents could respond without header, read until connection is closed */
+		agent->header = ZBX_ASYNC_AGENT_HEADER_NONE;
+		return SUCCEED;
+	}
+
+	if (ZBX_AGENT_HEADER_LEN >= agent->buffer_offset)
+		return SUCCEED;
+
+	agent->protocol = (unsigned char)agent->buffer[ZBX_AGENT_HEADER_LEN];
+
+	if (0 == (agent->protocol & ZBX_TCP_PROTOCOL))
+	{
+		*error = zbx_dsprintf(NULL, "unsupported protocol version 0x%02x from [[%s]:%hu]",
+				(unsigned int)agent->protocol, agent->addr, agent->port);
+		return FAIL;
+	}
+
+	agent->header_size = (0 != (agent->protocol & ZBX_TCP_LARGE) ? ZBX_AGENT_LARGE_HEADER_SIZE :
+			ZBX_AGENT_HEADER_SIZE);
+
+	if (agent->header_size > agent->buffer_offset)
+		return SUCCEED;
+
+	if (0 != (agent->protocol & ZBX_TCP_LARGE))
+	{
+		zbx_uint64_t	len64;
+
+		memcpy(&len64, agent->buffer + ZBX_AGENT_HEADER_LEN + 1, sizeof(len64));
+		agent->expected_len = zbx_letoh_uint64(len64);
+		memcpy(&len64, agent->buffer + ZBX_AGENT_HEADER_LEN + 1 + sizeof(len64), sizeof(len64));
+		agent->reserved = zbx_letoh_uint64(len64);
+	}
+	else
+	{
+		zbx_uint32_t	len32;
+
+		memcpy(&len32, agent->buffer + ZBX_AGENT_HEADER_LEN + 1, sizeof(len32));
+		agent->expected_len = zbx_letoh_uint32(len32);
+		memcpy(&len32, agent->buffer + ZBX_AGENT_HEADER_LEN + 1 + sizeof(len32), sizeof(len32));
+		agent->reserved = zbx_letoh_uint32(len32);
+	}
+
+	if (ZBX_MAX_RECV_DATA_SIZE < agent->expected_len || (0 != (agent->protocol & ZBX_TCP_COMPRESS) &&
+			ZBX_MAX_RECV_DATA_SIZE < agent->reserved))
+	{
+		*error = zbx_dsprintf(NULL, "message size " ZBX_FS_UI64 " from [[%s]:%hu] exceeds the maximum"
+				" size " ZBX_FS_UI64 " bytes", MAX(agent->expected_len, agent->reserved), agent->addr,
+				agent->port, (zbx_uint64_t)ZBX_MAX_RECV_DATA_SIZE);
+		return FAIL;
+	}
+
+	agent->header = ZBX_ASYNC_AGENT_HEADER_PARSED;
+
+	/* reserve space for the whole message and terminating zero */
+	if (agent->buffer_alloc < agent->header_size + agent->expected_len + 1)
+	{
+		agent->buffer_alloc = agent->header_size + agent->expected_len + 1;
+		agent->buffer = (char *)zbx_realloc(agent->buffer, agent->buffer_alloc);
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process received agent response                                   *
+ *                                                                            *
+ * Comments: The response is handled in the same way as by                    *
+ *           get_value_agent() function.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_agent_process_response(zbx_async_agent_t *agent)
+{
+	char	*value, *out = NULL;
+	size_t	value_len;
+	int	ret = SUCCEED;
+
+	if (ZBX_ASYNC_AGENT_HEADER_PARSED == agent->header)
+	{
+		if (agent->header_size + agent->expected_len > agent->buffer_offset)
+		{
+			async_agent_fail(agent, NETWORK_ERROR, zbx_dsprintf(NULL, "connection closed by [[%s]:%hu]"
+					" after receiving " ZBX_FS_SIZE_T " of " ZBX_FS_UI64 " bytes", agent->addr,
+					agent->port, (zbx_fs_size_t)(agent->buffer_offset - agent->header_size),
+					agent->expected_len));
+			return;
+		}
+
+		value = agent->buffer + agent->header_size;
+		value_len = (size_t)agent->expected_len;
+
+		if (0 != (agent->protocol & ZBX_TCP_COMPRESS))
+		{
+			size_t	out_len = (size_t)agent->reserved;
+
+			out = (char *)zbx_malloc(NULL, out_len + 1);
+
+			if (FAIL == zbx_uncompress(value, value_len, out, &out_len))
+			{
+				zbx_free(out);
+				async_agent_fail(agent, NETWORK_ERROR, zbx_dsprintf(NULL, "cannot uncompress data: %s",
+						zbx_compress_strerror()));
+				return;
+			}
+
+			if (out_len != agent->reserved)
+			{
+				zbx_free(out);
+				async_agent_fail(agent, NETWORK_ERROR, zbx_strdup(NULL,
+						"size of uncompressed data is less than expected"));
+				return;
+			}
+
+			value = out;
+			value_len = out_len;
+		}
+	}
+	else
+	{
+		value = agent->buffer;
+		value_len = agent->buffer_offset;
+	}
+
+	value[value_len] = '\0';
+
+	zabbix_log(LOG_LEVEL_DEBUG, "get value from agent result: '%s'", value);
+
+	if (0 == strcmp(value, ZBX_NOTSUPPORTED))
+	{
+		/* 'ZBX_NOTSUPPORTED\0<error message>' */
+		if (sizeof(ZBX_NOTSUPPORTED) < value_len)
+			SET_MSG_RESULT(agent->result, zbx_dsprintf(NULL, "%s", value + sizeof(ZBX_NOTSUPPORTED)));
+		else
+			SET_MSG_RESULT(agent->result, zbx_strdup(NULL, "Not supported by Zabbix Agent"));
+
+		ret = NOTSUPPORTED;
+	}
+	else if (0 == strcmp(value, ZBX_ERROR))
+	{
+		SET_MSG_RESULT(agent->result, zbx_strdup(NULL, "Zabbix Agent non-critical error"));
+		ret = AGENT_ERROR;
+	}
+	else if (0 == value_len)
+	{
+		SET_MSG_RESULT(agent->result, zbx_dsprintf(NULL, "Received empty response from Zabbix Agent at [%s]."
+				" Assuming that agent dropped connection because of access permissions.",
+				agent->addr));
+		ret = NETWORK_ERROR;
+	}
+	else
+		zbx_set_agent_result_type(agent->result, ITEM_VALUE_TYPE_TEXT, value);
+
+	zbx_free(out);
+
+	async_agent_finish(agent, ret);
+}
+
+static void	async_agent_recv(zbx_async_agent_t *agent)
+{
+	ssize_t	n;
+	char	*error = NULL;
+
+	while (1)
+	{
+		if (agent->buffer_alloc - agent->buffer_offset < ZBX_AGENT_RECV_BUF_LEN / 2 &&
+				ZBX_ASYNC_AGENT_HEADER_PARSED != agent->header)
+		{
+			if (ZBX_MAX_RECV_DATA_SIZE < agent->buffer_alloc)
+			{
+				async_agent_fail(agent, NETWORK_ERROR, zbx_dsprintf(NULL, "message from [[%s]:%hu]"
+						" exceeds the maximum size " ZBX_FS_UI64 " bytes", agent->addr,
+						agent->port, (zbx_uint64_t)ZBX_MAX_RECV_DATA_SIZE));
+				return;
+			}
+
+			agent->buffer_alloc *= 2;
+			agent->buffer = (char *)zbx_realloc(agent->buffer, agent->buffer_alloc);
+		}
+
+		if (-1 == (n = read(agent->fd, agent->buffer + agent->buffer_offset,
+				agent->buffer_alloc - agent->buffer_offset - 1)))
+		{
+			if (EINTR == errno)
+				continue;
+
+			if (EAGAIN == errno || EWOULDBLOCK == errno)
+			{
+				async_agent_wait(agent, EV_READ);
+				return;
+			}
+
+			async_agent_fail(agent, NETWORK_ERROR, zbx_dsprintf(NULL, "cannot read data: %s",
+					zbx_strerror(errno)));
+			return;
+		}
+
+		/* connection closed by peer */
+		if (0 == n)
+			break;
+
+		agent->buffer_offset += (size_t)n;
+
+		if (ZBX_ASYNC_AGENT_HEADER_PENDING == agent->header && SUCCEED != async_agent_parse_header(agent,
+				&error))
+		{
+			async_agent_fail(agent, NETWORK_ERROR, error);
+			return;
+		}
+
+		if (ZBX_ASYNC_AGENT_HEADER_PARSED == agent->header &&
+				agent->header_size + agent->expected_len <= agent->buffer_offset)
+		{
+			break;
+		}
+	}
+
+	async_agent_process_response(agent);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process agent reply to the next key of multiple passive checks    *
+ *                                                                            *
+ * Return value: SUCCEED - the reply was processed                            *
+ *               FAIL    - the agent does not support multiple passive checks *
+ *                                                                            *
+ ******************************************************************************/
+static int	async_agent_process_batch_reply(zbx_async_agent_t *agent, const char *reply)
+{
+	AGENT_RESULT	*result = &agent->results[agent->replies_num];
+	int		ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "get values from agent result: '%s'", reply);
+
+	if (FAIL == (ret = agent_parse_batch_reply(reply, result)))
+	{
+		if (0 == agent->replies_num)
+			return FAIL;
+
+		SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid Zabbix Agent response."));
+		ret = NOTSUPPORTED;
+	}
+
+	agent->errcodes[agent->replies_num++] = ret;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receive agent replies to multiple passive checks                  *
+ *                                                                            *
+ * Comments: The agent replies to each key as soon as it is checked, so the   *
+ *           check timeout is restarted after every reply.                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_agent_recv_batch(zbx_async_agent_t *agent)
+{
+	ssize_t	n;
+	size_t	frame_len;
+	char	*reply, *error = NULL;
+
+	while (1)
+	{
+		if (SUCCEED != agent_parse_frame(agent->buffer, agent->buffer_offset, &reply, &frame_len, &error))
+		{
+			if (0 == agent->replies_num)
+			{
+				zbx_free(error);
+				async_agent_finish(agent, FAIL);
+				return;
+			}
+
+			async_agent_fail(agent, NETWORK_ERROR, error);
+			return;
+		}
+
+		if (NULL != reply)
+		{
+			int	ret;
+
+			ret = async_agent_process_batch_reply(agent, reply);
+			zbx_free(reply);
+
+			if (SUCCEED != ret || agent->replies_num == agent->keys_num)
+			{
+				async_agent_finish(agent, ret);
+				return;
+			}
+
+			agent->buffer_offset -= frame_len;
+			memmove(agent->buffer, agent->buffer + frame_len, agent->buffer_offset);
+			agent->deadline = zbx_time() + agent->timeout;
+			continue;
+		}
+
+		if (agent->buffer_alloc - agent->buffer_offset < ZBX_AGENT_RECV_BUF_LEN / 2)
+		{
+			agent->buffer_alloc *= 2;
+			agent->buffer = (char *)zbx_realloc(agent->buffer, agent->buffer_alloc);
+		}
+
+		if (-1 == (n = read(agent->fd, agent->buffer + agent->buffer_offset,
+				agent->buffer_alloc - agent->buffer_offset)))
+		{
+			if (EINTR == errno)
+				continue;
+
+			if (EAGAIN == errno || EWOULDBLOCK == errno)
+			{
+				async_agent_wait(agent, EV_READ);
+				return;
+			}
+
+			async_agent_fail(agent, NETWORK_ERROR, zbx_dsprintf(NULL, "cannot read data: %s",
+					zbx_strerror(errno)));
+			return;
+		}
+
+		/* connection closed by peer */
+		if (0 == n)
+			break;
+
+		agent->buffer_offset += (size_t)n;
+	}
+
+	if (0 == agent->replies_num && 0 == agent->buffer_offset)
+	{
+		char	*msg;
+
+		msg = zbx_dsprintf(NULL, "Received empty response from Zabbix Agent at [%s]. Assuming that agent"
+				" dropped connection because of access permissions.", agent->addr);
+		async_agent_batch_fail(agent, NETWORK_ERROR, msg);
+		zbx_free(msg);
+		return;
+	}
+
+	async_agent_fail(agent, NETWORK_ERROR, zbx_dsprintf(NULL, "connection closed by [[%s]:%hu] after %d of %d"
+			" replies", agent->addr, agent->port, agent->replies_num, agent->keys_num));
+}
+
+static void	async_agent_event_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_async_agent_t	*agent = (zbx_async_agent_t *)arg;
+	int			err = 0;
+	socklen_t		len = sizeof(err);
+
+	ZBX_UNUSED(fd);
+
+	if (0 != (what & EV_TIMEOUT))
+	{
+		const char	*step;
+
+		switch (agent->step)
+		{
+			case ZBX_ASYNC_AGENT_STEP_RESOLVE:
+				step = "resolving";
+				break;
+			case ZBX_ASYNC_AGENT_STEP_CONNECT:
+				step = "connecting to";
+				break;
+			case ZBX_ASYNC_AGENT_STEP_SEND:
+				step = "sending data to";
+				break;
+			default:
+				step = "receiving data from";
+		}
+
+		async_agent_fail(agent, TIMEOUT_ERROR, zbx_dsprintf(NULL, "timed out while %s [[%s]:%hu]", step,
+				agent->addr, agent->port));
+		return;
+	}
+
+	switch (agent->step)
+	{
+		case ZBX_ASYNC_AGENT_STEP_CONNECT:
+			if (0 != getsockopt(agent->fd, SOL_SOCKET, SO_ERROR, &err, &len))
+				err = errno;
+
+			if (0 != err)
+			{
+				async_agent_fail(agent, NETWORK_ERROR, zbx_dsprintf(NULL, "cannot connect to [[%s]:%hu]:"
+						" %s", agent->addr, agent->port, zbx_strerror(err)));
+				return;
+			}
+
+			zabbix_log(LOG_LEVEL_DEBUG, "Sending [%s]", agent->buffer + ZBX_AGENT_HEADER_SIZE);
+			agent->step = ZBX_ASYNC_AGENT_STEP_SEND;
+			ZBX_FALLTHROUGH;
+		case ZBX_ASYNC_AGENT_STEP_SEND:
+			async_agent_send(agent);
+			break;
+		case ZBX_ASYNC_AGENT_STEP_RECV:
+			if (NULL != agent->results)
+				async_agent_recv_batch(agent);
+			else
+				async_agent_recv(agent);
+			break;
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+	}
+}
+
+static int	async_agent_bind(zbx_async_agent_t *agent, int family, char **error)
+{
+	struct evutil_addrinfo	hints, *ai = NULL;
+	int			rc;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = family;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = EVUTIL_AI_NUMERICHOST;
+
+	if (0 != (rc = evutil_getaddrinfo(agent->source_ip, NULL, &hints, &ai)))
+	{
+		*error = zbx_dsprintf(NULL, "invalid source IP address [%s]: %s", agent->source_ip,
+				evutil_gai_strerror(rc));
+		return FAIL;
+	}
+
+	rc = bind(agent->fd, ai->ai_addr, ai->ai_addrlen);
+	evutil_freeaddrinfo(ai);
+
+	if (0 != rc)
+	{
+		*error = zbx_dsprintf(NULL, "bind() failed: %s", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+static void	async_agent_connect(zbx_async_agent_t *agent, const struct evutil_addrinfo *ai)
+{
+	char	*error = NULL;
+
+	if (-1 == (agent->fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol)))
+	{
+		async_agent_fail(agent, NETWORK_ERROR, zbx_dsprintf(NULL, "cannot create socket: %s",
+				zbx_strerror(errno)));
+		return;
+	}
+
+	evutil_make_socket_nonblocking(agent->fd);
+	evutil_make_socket_closeonexec(agent->fd);
+
+	if (NULL != agent->source_ip && SUCCEED != async_agent_bind(agent, ai->ai_family, &error))
+	{
+		async_agent_fail(agent, NETWORK_ERROR, error);
+		return;
+	}
+
+	agent->step = ZBX_ASYNC_AGENT_STEP_CONNECT;
+
+	if (0 != connect(agent->fd, ai->ai_addr, ai->ai_addrlen) && EINPROGRESS != errno)
+	{
+		async_agent_fail(agent, NETWORK_ERROR, zbx_dsprintf(NULL, "cannot connect to [[%s]:%hu]: %s",
+				agent->addr, agent->port, zbx_strerror(errno)));
+		return;
+	}
+
+	async_agent_wait(agent, EV_WRITE);
+}
+
+static void	async_agent_resolve_cb(int result, struct evutil_addrinfo *ai, void *arg)
+{
+	zbx_async_agent_t	*agent = (zbx_async_agent_t *)arg;
+
+	agent->dns_request = NULL;
+
+	/* the check was already finished by timeout, only the context must be released */
+	if (NULL == agent->done_cb)
+	{
+		if (NULL != ai)
+			evutil_freeaddrinfo(ai);
+
+		async_agent_free(agent);
+		return;
+	}
+
+	if (0 != result)
+	{
+		async_agent_fail(agent, NETWORK_ERROR, zbx_dsprintf(NULL, "cannot resolve [%s]: %s", agent->addr,
+				evutil_gai_strerror(result)));
+		return;
+	}
+
+	async_agent_connect(agent, ai);
+	evutil_freeaddrinfo(ai);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create agent check context with the request prepared for sending  *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_async_agent_t	*async_agent_create(struct event_base *base, const char *addr, unsigned short port,
+		const char *config_source_ip, int timeout, const char *request, zbx_async_agent_done_cb_t done_cb,
+		void *arg)
+{
+	zbx_async_agent_t	*agent;
+	zbx_uint32_t		len32;
+	size_t			request_len;
+
+	agent = (zbx_async_agent_t *)zbx_malloc(NULL, sizeof(zbx_async_agent_t));
+	memset(agent, 0, sizeof(zbx_async_agent_t));
+
+	agent->base = base;
+	agent->fd = -1;
+	agent->addr = zbx_strdup(NULL, addr);
+	agent->port = port;
+	agent->source_ip = (NULL != config_source_ip && '\0' != *config_source_ip ?
+			zbx_strdup(NULL, config_source_ip) : NULL);
+	agent->timeout = timeout;
+	agent->deadline = zbx_time() + timeout;
+	agent->done_cb = done_cb;
+	agent->arg = arg;
+	agent->header = ZBX_ASYNC_AGENT_HEADER_PENDING;
+
+	/* prepare request, the response is received into the same buffer */
+	request_len = strlen(request);
+	agent->send_len = ZBX_AGENT_HEADER_SIZE + request_len;
+	agent->buffer_alloc = MAX(agent->send_len + 1, ZBX_AGENT_RECV_BUF_LEN);
+	agent->buffer = (char *)zbx_malloc(NULL, agent->buffer_alloc);
+
+	memcpy(agent->buffer, ZBX_AGENT_HEADER_DATA, ZBX_AGENT_HEADER_LEN);
+	agent->buffer[ZBX_AGENT_HEADER_LEN] = ZBX_TCP_PROTOCOL;
+	len32 = zbx_htole_uint32((zbx_uint32_t)request_len);
+	memcpy(agent->buffer + ZBX_AGENT_HEADER_LEN + 1, &len32, sizeof(len32));
+	len32 = 0;
+	memcpy(agent->buffer + ZBX_AGENT_HEADER_LEN + 1 + sizeof(len32), &len32, sizeof(len32));
+	memcpy(agent->buffer + ZBX_AGENT_HEADER_SIZE, request, request_len + 1);
+
+	return agent;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start resolving agent address, the rest of check steps are        *
+ *          driven by the event loop                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_agent_start(zbx_async_agent_t *agent, struct evdns_base *dnsbase)
+{
+	struct evutil_addrinfo			hints;
+	struct evdns_getaddrinfo_request	*dns_request;
+	struct timeval				tv = {agent->timeout, 0};
+	char					service[8];
+
+	agent->step = ZBX_ASYNC_AGENT_STEP_RESOLVE;
+	agent->event = evtimer_new(agent->base, async_agent_event_cb, agent);
+	event_add(agent->event, &tv);
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = EVUTIL_AI_NUMERICSERV;
+	zbx_snprintf(service, sizeof(service), "%hu", agent->port);
+
+	/* the callback is invoked immediately for numeric addresses, context might be already released */
+	if (NULL != (dns_request = evdns_getaddrinfo(dnsbase, agent->addr, service, &hints, async_agent_resolve_cb,
+			agent)))
+	{
+		agent->dns_request = dns_request;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start non-blocking Zabbix agent check                             *
+ *                                                                            *
+ * Parameters: base             - [IN] the event base                         *
+ *             dnsbase          - [IN] the asynchronous DNS resolver          *
+ *             addr             - [IN] the agent address                      *
+ *             port             - [IN] the agent port                         *
+ *             key              - [IN] the item key                           *
+ *             config_source_ip - [IN] the source IP address, optional        *
+ *             timeout          - [IN] the check timeout in seconds           *
+ *             result           - [OUT] the check result                      *
+ *             done_cb          - [IN] the callback invoked when the check is *
+ *                                     finished                               *
+ *             arg              - [IN] the callback argument                  *
+ *                                                                            *
+ * Comments: The callback can be invoked before this function returns, for    *
+ *           example if address does not need to be resolved and the          *
+ *           connection cannot be established.                                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_async_check_agent(struct event_base *base, struct evdns_base *dnsbase, const char *addr,
+		unsigned short port, const char *key, const char *config_source_ip, int timeout, AGENT_RESULT *result,
+		zbx_async_agent_done_cb_t done_cb, void *arg)
+{
+	zbx_async_agent_t	*agent;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() addr:'%s' port:%hu key:'%s'", __func__, addr, port, key);
+
+	agent = async_agent_create(base, addr, port, config_source_ip, timeout, key, done_cb, arg);
+	agent->result = result;
+
+	async_agent_start(agent, dnsbase);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start non-blocking multiple passive checks of Zabbix agent over   *
+ *          one connection                                                    *
+ *                                                                            *
+ * Parameters: base             - [IN] the event base                         *
+ *             dnsbase          - [IN] the asynchronous DNS resolver          *
+ *             addr             - [IN] the agent address                      *
+ *             port             - [IN] the agent port                         *
+ *             keys             - [IN] the item keys                          *
+ *             keys_num         - [IN] the number of keys                     *
+ *             config_source_ip - [IN] the source IP address, optional        *
+ *             timeout          - [IN] the timeout of each key in seconds     *
+ *             results          - [OUT] the check results                     *
+ *             errcodes         - [OUT] the check result codes                *
+ *             done_cb          - [IN] the callback invoked when the checks   *
+ *                                     are finished                           *
+ *             arg              - [IN] the callback argument                  *
+ *                                                                            *
+ * Comments: The callback is invoked with SUCCEED when results and error      *
+ *           codes of all keys are set or with FAIL if the agent does not     *
+ *           support multiple passive checks, then none of results are set.   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_async_check_agent_batch(struct event_base *base, struct evdns_base *dnsbase, const char *addr,
+		unsigned short port, char * const *keys, int keys_num, const char *config_source_ip, int timeout,
+		AGENT_RESULT *results, int *errcodes, zbx_async_agent_done_cb_t done_cb, void *arg)
+{
+	zbx_async_agent_t	*agent;
+	struct zbx_json		j;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() addr:'%s' port:%hu num:%d", __func__, addr, port, keys_num);
+
+	agent_batch_request_init(&j);
+
+	for (int i = 0; i < keys_num; i++)
+		agent_batch_request_add(&j, keys[i]);
+
+	agent = async_agent_create(base, addr, port, config_source_ip, timeout, j.buffer, done_cb, arg);
+	agent->results = results;
+	agent->errcodes = errcodes;
+	agent->keys_num = keys_num;
+
+	zbx_json_free(&j);
+
+	async_agent_start(agent, dnsbase);
+}
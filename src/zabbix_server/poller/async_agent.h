@@ -0,0 +1,39 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_ASYNC_AGENT_H
+#define ZABBIX_ASYNC_AGENT_H
+
+#include "module.h"
+
+#include <event2/event.h>
+#include <event2/dns.h>
+
+/* called once the check is finished, for single check ret is SUCCEED, NETWORK_ERROR, TIMEOUT_ERROR, */
+/* NOTSUPPORTED or AGENT_ERROR, for multiple checks SUCCEED or FAIL                                  */
+typedef void	(*zbx_async_agent_done_cb_t)(int ret, void *arg);
+
+void	zbx_async_check_agent(struct event_base *base, struct evdns_base *dnsbase, const char *addr,
+		unsigned short port, const char *key, const char *config_source_ip, int timeout, AGENT_RESULT *result,
+		zbx_async_agent_done_cb_t done_cb, void *arg);
+void	zbx_async_check_agent_batch(struct event_base *base, struct evdns_base *dnsbase, const char *addr,
+		unsigned short port, char * const *keys, int keys_num, const char *config_source_ip, int timeout,
+		AGENT_RESULT *results, int *errcodes, zbx_async_agent_done_cb_t done_cb, void *arg);
+
+#endif
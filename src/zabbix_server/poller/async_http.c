@@ -0,0 +1,312 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "async_http.h"
+
+#ifdef HAVE_LIBCURL
+
+#include "zbxcommon.h"
+
+/* cURL multi interface driven by libevent, the multi handle keeps connection cache */
+/* while DNS cache and TLS sessions are shared between transfers by share handle    */
+struct zbx_async_http
+{
+	struct event_base	*base;
+	struct event		*timer;
+	CURLM			*multi;
+	CURLSH			*share;
+};
+
+/* transfer in progress */
+typedef struct
+{
+	zbx_async_http_done_cb_t	done_cb;
+	void				*arg;
+}
+zbx_async_http_transfer_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: notify callers about finished transfers                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_http_check_finished(zbx_async_http_t *http)
+{
+	CURLMsg	*msg;
+	int	msgnum;
+
+	while (NULL != (msg = curl_multi_info_read(http->multi, &msgnum)))
+	{
+		zbx_async_http_transfer_t	*transfer;
+		CURL				*easyhandle;
+		CURLcode			err;
+
+		if (CURLMSG_DONE != msg->msg)
+			continue;
+
+		easyhandle = msg->easy_handle;
+		err = msg->data.result;
+
+		curl_easy_getinfo(easyhandle, CURLINFO_PRIVATE, (char **)&transfer);
+		curl_multi_remove_handle(http->multi, easyhandle);
+
+		/* the easy handle is not used after this, callback can clean it up */
+		transfer->done_cb(err, transfer->arg);
+		zbx_free(transfer);
+	}
+}
+
+static void	async_http_event_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_async_http_t	*http = (zbx_async_http_t *)arg;
+	int			running, action = 0;
+	CURLMcode		code;
+
+	if (0 != (what & EV_READ))
+		action |= CURL_CSELECT_IN;
+
+	if (0 != (what & EV_WRITE))
+		action |= CURL_CSELECT_OUT;
+
+	if (CURLM_OK != (code = curl_multi_socket_action(http->multi, fd, action, &running)))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot perform socket action: %s", curl_multi_strerror(code));
+
+	async_http_check_finished(http);
+}
+
+static void	async_http_timer_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_async_http_t	*http = (zbx_async_http_t *)arg;
+	int			running;
+	CURLMcode		code;
+
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(what);
+
+	if (CURLM_OK != (code = curl_multi_socket_action(http->multi, CURL_SOCKET_TIMEOUT, 0, &running)))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot perform timeout action: %s", curl_multi_strerror(code));
+
+	async_http_check_finished(http);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: update socket event according to the cURL socket state            *
+ *                                                                            *
+ * Comments: The event is stored as socket data with curl_multi_assign().     *
+ *                                                                            *
+ ******************************************************************************/
+static int	async_http_socket_cb(CURL *easyhandle, curl_socket_t s, int what, void *userp, void *socketp)
+{
+	zbx_async_http_t	*http = (zbx_async_http_t *)userp;
+	struct event		*ev = (struct event *)socketp;
+	short			events = EV_PERSIST;
+
+	ZBX_UNUSED(easyhandle);
+
+	if (CURL_POLL_REMOVE == what)
+	{
+		if (NULL != ev)
+		{
+			event_free(ev);
+			curl_multi_assign(http->multi, s, NULL);
+		}
+
+		return 0;
+	}
+
+	if (0 != (what & CURL_POLL_IN))
+		events |= EV_READ;
+
+	if (0 != (what & CURL_POLL_OUT))
+		events |= EV_WRITE;
+
+	if (NULL == ev)
+	{
+		ev = event_new(http->base, s, events, async_http_event_cb, http);
+		curl_multi_assign(http->multi, s, ev);
+	}
+	else
+	{
+		event_del(ev);
+		event_assign(ev, http->base, s, events, async_http_event_cb, http);
+	}
+
+	event_add(ev, NULL);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: schedule cURL timeout processing                                  *
+ *                                                                            *
+ * Comments: Zero timeout is also scheduled rather than processed directly,   *
+ *           because socket actions must not be performed from the callback.  *
+ *                                                                            *
+ ******************************************************************************/
+static int	async_http_timer_update_cb(CURLM *multi, long timeout_ms, void *userp)
+{
+	zbx_async_http_t	*http = (zbx_async_http_t *)userp;
+
+	ZBX_UNUSED(multi);
+
+	if (-1 == timeout_ms)
+	{
+		evtimer_del(http->timer);
+	}
+	else
+	{
+		struct timeval	tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+
+		evtimer_add(http->timer, &tv);
+	}
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create cURL multi interface driven by the event base              *
+ *                                                                            *
+ * Parameters: base  - [IN] the event base                                    *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: the created object or NULL on error                          *
+ *                                                                            *
+ ******************************************************************************/
+zbx_async_http_t	*zbx_async_http_create(struct event_base *base, char **error)
+{
+	zbx_async_http_t	*http;
+	CURLSHcode		shcode;
+
+	http = (zbx_async_http_t *)zbx_malloc(NULL, sizeof(zbx_async_http_t));
+	memset(http, 0, sizeof(zbx_async_http_t));
+	http->base = base;
+
+	if (NULL == (http->multi = curl_multi_init()))
+	{
+		*error = zbx_strdup(NULL, "cannot initialize cURL multi handle");
+		goto fail;
+	}
+
+	if (NULL == (http->share = curl_share_init()))
+	{
+		*error = zbx_strdup(NULL, "cannot initialize cURL share handle");
+		goto fail;
+	}
+
+	if (CURLSHE_OK != (shcode = curl_share_setopt(http->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS)) ||
+			CURLSHE_OK != (shcode = curl_share_setopt(http->share, CURLSHOPT_SHARE,
+			CURL_LOCK_DATA_SSL_SESSION)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot set cURL share option: %s", curl_share_strerror(shcode));
+		goto fail;
+	}
+
+	http->timer = evtimer_new(base, async_http_timer_cb, http);
+
+	curl_multi_setopt(http->multi, CURLMOPT_SOCKETFUNCTION, async_http_socket_cb);
+	curl_multi_setopt(http->multi, CURLMOPT_SOCKETDATA, http);
+	curl_multi_setopt(http->multi, CURLMOPT_TIMERFUNCTION, async_http_timer_update_cb);
+	curl_multi_setopt(http->multi, CURLMOPT_TIMERDATA, http);
+
+	return http;
+fail:
+	zbx_async_http_free(http);
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free cURL multi interface                                         *
+ *                                                                            *
+ * Comments: All transfers must be finished before this call.                 *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_async_http_free(zbx_async_http_t *http)
+{
+	if (NULL != http->timer)
+		event_free(http->timer);
+
+	if (NULL != http->multi)
+		curl_multi_cleanup(http->multi);
+
+	if (NULL != http->share)
+		curl_share_cleanup(http->share);
+
+	zbx_free(http);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start transfer of prepared request                                *
+ *                                                                            *
+ * Parameters: http       - [IN] the cURL multi interface                     *
+ *             easyhandle - [IN] the prepared request                         *
+ *             done_cb    - [IN] the callback called when transfer is         *
+ *                               finished                                     *
+ *             arg        - [IN] the callback argument                        *
+ *             error      - [OUT] the error message                           *
+ *                                                                            *
+ * Return value: SUCCEED - the transfer was started                           *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The callback is called from event loop and is responsible for    *
+ *           cleaning up the easy handle.                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_async_http_add(zbx_async_http_t *http, CURL *easyhandle, zbx_async_http_done_cb_t done_cb, void *arg,
+		char **error)
+{
+	zbx_async_http_transfer_t	*transfer;
+	CURLcode			err;
+	CURLMcode			code;
+
+	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_SHARE, http->share)))
+	{
+		*error = zbx_dsprintf(NULL, "Cannot set share handle: %s", curl_easy_strerror(err));
+		return FAIL;
+	}
+
+	transfer = (zbx_async_http_transfer_t *)zbx_malloc(NULL, sizeof(zbx_async_http_transfer_t));
+	transfer->done_cb = done_cb;
+	transfer->arg = arg;
+
+	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_PRIVATE, transfer)))
+	{
+		*error = zbx_dsprintf(NULL, "Cannot set private data: %s", curl_easy_strerror(err));
+		goto fail;
+	}
+
+	if (CURLM_OK != (code = curl_multi_add_handle(http->multi, easyhandle)))
+	{
+		*error = zbx_dsprintf(NULL, "Cannot start transfer: %s", curl_multi_strerror(code));
+		goto fail;
+	}
+
+	return SUCCEED;
+fail:
+	zbx_free(transfer);
+
+	return FAIL;
+}
+
+#endif
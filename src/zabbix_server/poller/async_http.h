@@ -0,0 +1,41 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_ASYNC_HTTP_H
+#define ZABBIX_ASYNC_HTTP_H
+
+#include "zbxhttp.h"
+
+#ifdef HAVE_LIBCURL
+
+#include <event2/event.h>
+
+/* called once the transfer is finished, err is the transfer result code */
+typedef void	(*zbx_async_http_done_cb_t)(CURLcode err, void *arg);
+
+typedef struct zbx_async_http zbx_async_http_t;
+
+zbx_async_http_t	*zbx_async_http_create(struct event_base *base, char **error);
+void	zbx_async_http_free(zbx_async_http_t *http);
+int	zbx_async_http_add(zbx_async_http_t *http, CURL *easyhandle, zbx_async_http_done_cb_t done_cb, void *arg,
+		char **error);
+
+#endif
+
+#endif
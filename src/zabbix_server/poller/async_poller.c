@@ -0,0 +1,922 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "async_poller.h"
+
+#include "poller.h"
+#include "async_agent.h"
+#include "checks_agent.h"
+#include "checks_snmp.h"
+#include "async_http.h"
+
+#include "zbxserver.h"
+#include "zbxnix.h"
+#include "zbxself.h"
+#include "zbxrtc.h"
+#include "zbxlog.h"
+#include "zbxpreproc.h"
+#include "zbxavailability.h"
+#include "zbxtime.h"
+#include "zbx_availability_constants.h"
+#include "zbx_rtc_constants.h"
+#include "zbx_item_constants.h"
+
+#include <event2/event.h>
+#include <event2/dns.h>
+
+/* asynchronous poller state */
+typedef struct
+{
+	struct event_base		*base;
+	struct evdns_base		*dnsbase;
+	const zbx_thread_poller_args	*poller_args;
+	int				processing;
+#ifdef HAVE_LIBCURL
+	zbx_async_http_t		*http;
+#endif
+
+	/* finished checks waiting to be requeued */
+	zbx_vector_uint64_t		itemids;
+	zbx_vector_int32_t		lastclocks;
+	zbx_vector_int32_t		errcodes;
+
+	/* serialized interface availability changes */
+	unsigned char			*data;
+	size_t				data_alloc;
+	size_t				data_offset;
+
+	/* statistics since the last process title update */
+	int				processed;
+	double				latency_total;
+	double				latency_max;
+	double				queue_delay_total;
+}
+zbx_async_poller_t;
+
+/* item being checked, only the data needed after check is finished is kept */
+typedef struct
+{
+	zbx_async_poller_t	*poller;
+	zbx_uint64_t		itemid;
+	zbx_uint64_t		hostid;
+	unsigned char		type;
+	unsigned char		value_type;
+	unsigned char		flags;
+	char			*host;
+	char			*key_orig;
+	zbx_dc_interface_t	interface;
+	double			start;
+	AGENT_RESULT		result;
+}
+zbx_async_item_t;
+
+/* SNMP items sharing the same interface, checked together */
+typedef struct
+{
+	zbx_async_poller_t	*poller;
+	zbx_async_item_t	**items;
+	AGENT_RESULT		*results;
+	int			*errcodes;
+	int			num;
+}
+zbx_async_snmp_batch_t;
+
+/* agent items sharing the same interface, requested over one connection */
+typedef struct
+{
+	zbx_async_poller_t	*poller;
+	zbx_uint64_t		interfaceid;
+	char			*addr;
+	unsigned short		port;
+	zbx_async_item_t	*items[ZBX_MAX_AGENT_ITEMS];
+	char			*keys[ZBX_MAX_AGENT_ITEMS];
+	AGENT_RESULT		results[ZBX_MAX_AGENT_ITEMS];
+	int			errcodes[ZBX_MAX_AGENT_ITEMS];
+	int			num;
+}
+zbx_async_agent_batch_t;
+
+#ifdef HAVE_LIBCURL
+/* HTTP agent item being checked */
+typedef struct
+{
+	zbx_async_item_t	*item;
+	zbx_http_context_t	context;
+}
+zbx_async_http_item_t;
+#endif
+
+static zbx_async_item_t	*async_item_create(zbx_async_poller_t *poller, const zbx_dc_item_t *dc_item, double now)
+{
+	zbx_async_item_t	*item;
+
+	item = (zbx_async_item_t *)zbx_malloc(NULL, sizeof(zbx_async_item_t));
+
+	item->poller = poller;
+	item->itemid = dc_item->itemid;
+	item->hostid = dc_item->host.hostid;
+	item->type = dc_item->type;
+	item->value_type = dc_item->value_type;
+	item->flags = dc_item->flags;
+	item->host = zbx_strdup(NULL, dc_item->host.host);
+	item->key_orig = zbx_strdup(NULL, dc_item->key_orig);
+	item->interface = dc_item->interface;
+	item->interface.addr = (1 == item->interface.useip ? item->interface.ip_orig : item->interface.dns_orig);
+	item->start = now;
+	zbx_init_agent_result(&item->result);
+
+	poller->queue_delay_total += MAX(0, now - dc_item->nextcheck);
+
+	return item;
+}
+
+static void	async_item_free(zbx_async_item_t *item)
+{
+	zbx_free_agent_result(&item->result);
+	zbx_free(item->key_orig);
+	zbx_free(item->host);
+	zbx_free(item);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process finished item check                                       *
+ *                                                                            *
+ * Parameters: item           - [IN] the checked item                         *
+ *             errcode        - [IN] the check result code                    *
+ *             result         - [IN] the check result                         *
+ *             last_available - [IN/OUT] the last interface availability set  *
+ *                                       by this check, used to update        *
+ *                                       interface only once per SNMP batch   *
+ *                                                                            *
+ * Comments: The item is queued for requeuing, which is done in batches by    *
+ *           async_poller_flush() function.                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_poller_process_item(zbx_async_item_t *item, int errcode, AGENT_RESULT *result,
+		int *last_available)
+{
+	zbx_async_poller_t		*poller = item->poller;
+	const zbx_thread_poller_args	*poller_args = poller->poller_args;
+	zbx_timespec_t			timespec;
+	double				latency;
+
+	zbx_timespec(&timespec);
+
+	switch (errcode)
+	{
+		case SUCCEED:
+		case NOTSUPPORTED:
+		case AGENT_ERROR:
+			if (ZBX_INTERFACE_AVAILABLE_TRUE != *last_available)
+			{
+				zbx_activate_item_interface_ext(&timespec, &item->interface, item->itemid, item->type,
+						item->host, &poller->data, &poller->data_alloc, &poller->data_offset);
+				*last_available = ZBX_INTERFACE_AVAILABLE_TRUE;
+			}
+			break;
+		case NETWORK_ERROR:
+		case GATEWAY_ERROR:
+		case TIMEOUT_ERROR:
+			if (ZBX_INTERFACE_AVAILABLE_FALSE != *last_available)
+			{
+				zbx_deactivate_item_interface_ext(&timespec, &item->interface, item->itemid,
+						item->type, item->host, item->key_orig, &poller->data,
+						&poller->data_alloc, &poller->data_offset,
+						poller_args->config_unavailable_delay,
+						poller_args->config_unreachable_period,
+						poller_args->config_unreachable_delay, result->msg);
+				*last_available = ZBX_INTERFACE_AVAILABLE_FALSE;
+			}
+			break;
+		case CONFIG_ERROR:
+			/* nothing to do */
+			break;
+		default:
+			zbx_error("unknown response code returned: %d", errcode);
+			THIS_SHOULD_NEVER_HAPPEN;
+	}
+
+	if (SUCCEED == errcode)
+	{
+		zbx_preprocess_item_value(item->itemid, item->hostid, item->value_type, item->flags, result,
+				&timespec, ITEM_STATE_NORMAL, NULL);
+	}
+	else if (NOTSUPPORTED == errcode || AGENT_ERROR == errcode || CONFIG_ERROR == errcode)
+	{
+		zbx_preprocess_item_value(item->itemid, item->hostid, item->value_type, item->flags, NULL, &timespec,
+				ITEM_STATE_NOTSUPPORTED, result->msg);
+	}
+
+	zbx_vector_uint64_append(&poller->itemids, item->itemid);
+	zbx_vector_int32_append(&poller->lastclocks, timespec.sec);
+	zbx_vector_int32_append(&poller->errcodes, errcode);
+
+	latency = zbx_time() - item->start;
+	poller->latency_total += latency;
+
+	if (latency > poller->latency_max)
+		poller->latency_max = latency;
+
+	poller->processed++;
+}
+
+static void	async_poller_process_single_item(zbx_async_item_t *item, int errcode)
+{
+	int	last_available = ZBX_INTERFACE_AVAILABLE_UNKNOWN;
+
+	async_poller_process_item(item, errcode, &item->result, &last_available);
+	async_item_free(item);
+}
+
+static void	async_poller_item_done_cb(int ret, void *arg)
+{
+	zbx_async_item_t	*item = (zbx_async_item_t *)arg;
+
+	item->poller->processing--;
+	async_poller_process_single_item(item, ret);
+}
+
+#ifdef HAVE_LIBCURL
+static void	async_poller_http_done_cb(CURLcode err, void *arg)
+{
+	zbx_async_http_item_t	*http_item = (zbx_async_http_item_t *)arg;
+	zbx_async_item_t	*item = http_item->item;
+	char			*out = NULL, *error = NULL;
+	int			ret;
+
+	if (SUCCEED == (ret = zbx_http_handle_response(&http_item->context, err, &out, &error)))
+		SET_TEXT_RESULT(&item->result, out);
+	else
+		SET_MSG_RESULT(&item->result, error);
+
+	zbx_http_context_destroy(&http_item->context);
+	zbx_free(http_item);
+
+	item->poller->processing--;
+	async_poller_process_single_item(item, ret);
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: return SNMP batch items to the queue without checking them        *
+ *                                                                            *
+ * Comments: The items are requeued for the next check without changing      *
+ *           their state. On requeue the configuration cache moves them to    *
+ *           normal pollers, because the item or its interface was changed to *
+ *           require blocking checks after the items were queued.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_poller_snmp_skip(zbx_async_snmp_batch_t *batch)
+{
+	zbx_async_poller_t	*poller = batch->poller;
+	int			now = (int)time(NULL);
+
+	poller->processing -= batch->num;
+
+	for (int i = 0; i < batch->num; i++)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "SNMP item \"%s:%s\" cannot be checked asynchronously, leaving it"
+				" to normal pollers", batch->items[i]->host, batch->items[i]->key_orig);
+
+		zbx_vector_uint64_append(&poller->itemids, batch->items[i]->itemid);
+		zbx_vector_int32_append(&poller->lastclocks, now);
+		zbx_vector_int32_append(&poller->errcodes, CONFIG_ERROR);
+
+		async_item_free(batch->items[i]);
+		zbx_free_agent_result(&batch->results[i]);
+	}
+
+	zbx_free(batch->errcodes);
+	zbx_free(batch->results);
+	zbx_free(batch->items);
+	zbx_free(batch);
+}
+
+static void	async_poller_snmp_done_cb(void *arg)
+{
+	zbx_async_snmp_batch_t	*batch = (zbx_async_snmp_batch_t *)arg;
+	int			last_available = ZBX_INTERFACE_AVAILABLE_UNKNOWN;
+
+	batch->poller->processing -= batch->num;
+
+	for (int i = 0; i < batch->num; i++)
+	{
+		async_poller_process_item(batch->items[i], batch->errcodes[i], &batch->results[i], &last_available);
+		async_item_free(batch->items[i]);
+		zbx_free_agent_result(&batch->results[i]);
+	}
+
+	zbx_free(batch->errcodes);
+	zbx_free(batch->results);
+	zbx_free(batch->items);
+	zbx_free(batch);
+}
+
+static void	async_poller_start_agent_check(zbx_async_poller_t *poller, const zbx_dc_item_t *item,
+		zbx_async_item_t *async_item)
+{
+	const zbx_config_comms_args_t	*config_comms = poller->poller_args->config_comms;
+
+	/* encrypted connections are checked synchronously, such items are normally processed by pollers */
+	if (ZBX_TCP_SEC_UNENCRYPTED != item->host.tls_connect)
+	{
+		async_poller_process_single_item(async_item, get_value_agent(item, config_comms->config_timeout,
+				config_comms->config_source_ip, &async_item->result));
+		return;
+	}
+
+	poller->processing++;
+
+	zbx_async_check_agent(poller->base, poller->dnsbase, item->interface.addr, item->interface.port, item->key,
+			config_comms->config_source_ip, config_comms->config_timeout, &async_item->result,
+			async_poller_item_done_cb, async_item);
+}
+
+static void	async_poller_agent_batch_free(zbx_async_agent_batch_t *batch)
+{
+	for (int i = 0; i < batch->num; i++)
+	{
+		zbx_free_agent_result(&batch->results[i]);
+		zbx_free(batch->keys[i]);
+	}
+
+	zbx_free(batch->addr);
+	zbx_free(batch);
+}
+
+static void	async_poller_agent_batch_done_cb(int ret, void *arg)
+{
+	zbx_async_agent_batch_t		*batch = (zbx_async_agent_batch_t *)arg;
+	zbx_async_poller_t		*poller = batch->poller;
+	const zbx_config_comms_args_t	*config_comms = poller->poller_args->config_comms;
+	int				last_available = ZBX_INTERFACE_AVAILABLE_UNKNOWN;
+
+	if (FAIL == ret)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "agent at [%s] does not support multiple passive checks, falling back to"
+				" single key requests", batch->addr);
+
+		agent_set_legacy(batch->interfaceid, time(NULL));
+
+		/* the items are still counted as processing until their single checks are finished */
+		for (int i = 0; i < batch->num; i++)
+		{
+			zbx_async_item_t	*item = batch->items[i];
+
+			zbx_async_check_agent(poller->base, poller->dnsbase, batch->addr, batch->port, batch->keys[i],
+					config_comms->config_source_ip, config_comms->config_timeout, &item->result,
+					async_poller_item_done_cb, item);
+		}
+
+		async_poller_agent_batch_free(batch);
+		return;
+	}
+
+	poller->processing -= batch->num;
+
+	for (int i = 0; i < batch->num; i++)
+	{
+		async_poller_process_item(batch->items[i], batch->errcodes[i], &batch->results[i], &last_available);
+		async_item_free(batch->items[i]);
+	}
+
+	async_poller_agent_batch_free(batch);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start checks of unencrypted agent items sharing the same          *
+ *          interface over one connection                                     *
+ *                                                                            *
+ * Parameters: poller   - [IN] the asynchronous poller                        *
+ *             items    - [IN] the items                                      *
+ *             errcodes - [IN] the item error codes                           *
+ *             num      - [IN] the number of items                            *
+ *             now      - [IN] the check start time                           *
+ *             started  - [OUT] the flags of items with started checks        *
+ *                                                                            *
+ * Comments: The items of interface are requested in batches of up to         *
+ *           ZBX_MAX_AGENT_ITEMS keys, interfaces with a single item and      *
+ *           agents not supporting multiple passive checks are left for       *
+ *           single checks.                                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_poller_start_agent_batches(zbx_async_poller_t *poller, const zbx_dc_item_t *items,
+		const int *errcodes, int num, double now, unsigned char *started)
+{
+	const zbx_config_comms_args_t	*config_comms = poller->poller_args->config_comms;
+	zbx_vector_uint64_pair_t	candidates;
+	zbx_async_agent_batch_t		*batch;
+	time_t				time_now = (time_t)now;
+	int				i, j, k, index;
+
+	zbx_vector_uint64_pair_create(&candidates);
+
+	for (i = 0; i < num; i++)
+	{
+		zbx_uint64_pair_t	pair;
+
+		if (SUCCEED != errcodes[i] || ZBX_TCP_SEC_UNENCRYPTED != items[i].host.tls_connect ||
+				SUCCEED == agent_is_legacy(items[i].interface.interfaceid, time_now))
+		{
+			continue;
+		}
+
+		pair.first = items[i].interface.interfaceid;
+		pair.second = (zbx_uint64_t)i;
+		zbx_vector_uint64_pair_append(&candidates, pair);
+	}
+
+	zbx_vector_uint64_pair_sort(&candidates, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+
+	for (i = 0; i < candidates.values_num; i = j)
+	{
+		for (j = i + 1; j < candidates.values_num && j - i < ZBX_MAX_AGENT_ITEMS &&
+				candidates.values[j].first == candidates.values[i].first; j++)
+			;
+
+		if (2 > j - i)
+			continue;
+
+		batch = (zbx_async_agent_batch_t *)zbx_malloc(NULL, sizeof(zbx_async_agent_batch_t));
+		batch->poller = poller;
+		batch->interfaceid = candidates.values[i].first;
+		batch->addr = zbx_strdup(NULL, items[candidates.values[i].second].interface.addr);
+		batch->port = items[candidates.values[i].second].interface.port;
+		batch->num = j - i;
+
+		for (k = 0; k < batch->num; k++)
+		{
+			index = (int)candidates.values[i + k].second;
+
+			batch->items[k] = async_item_create(poller, &items[index], now);
+			batch->keys[k] = zbx_strdup(NULL, items[index].key);
+			zbx_init_agent_result(&batch->results[k]);
+			batch->errcodes[k] = SUCCEED;
+			started[index] = 1;
+		}
+
+		poller->processing += batch->num;
+
+		zbx_async_check_agent_batch(poller->base, poller->dnsbase, batch->addr, batch->port, batch->keys,
+				batch->num, config_comms->config_source_ip, config_comms->config_timeout, batch->results,
+				batch->errcodes, async_poller_agent_batch_done_cb, batch);
+	}
+
+	zbx_vector_uint64_pair_destroy(&candidates);
+}
+
+static void	async_poller_start_http_check(zbx_async_poller_t *poller, const zbx_dc_item_t *item,
+		zbx_async_item_t *async_item)
+{
+#ifdef HAVE_LIBCURL
+	zbx_async_http_item_t	*http_item;
+	char			*error = NULL;
+
+	http_item = (zbx_async_http_item_t *)zbx_malloc(NULL, sizeof(zbx_async_http_item_t));
+	http_item->item = async_item;
+	zbx_http_context_create(&http_item->context);
+
+	if (SUCCEED != zbx_http_request_prepare(&http_item->context, item->request_method, item->url,
+			item->query_fields, item->headers, item->posts, item->retrieve_mode, item->http_proxy,
+			item->follow_redirects, item->timeout, item->ssl_cert_file, item->ssl_key_file,
+			item->ssl_key_password, item->verify_peer, item->verify_host, item->authtype, item->username,
+			item->password, NULL, item->post_type, item->status_codes, item->output_format,
+			poller->poller_args->config_comms->config_source_ip, &error) ||
+			SUCCEED != zbx_async_http_add(poller->http, http_item->context.easyhandle,
+			async_poller_http_done_cb, http_item, &error))
+	{
+		zbx_http_context_destroy(&http_item->context);
+		zbx_free(http_item);
+
+		SET_MSG_RESULT(&async_item->result, error);
+		async_poller_process_single_item(async_item, NOTSUPPORTED);
+		return;
+	}
+
+	poller->processing++;
+#else
+	ZBX_UNUSED(poller);
+	ZBX_UNUSED(item);
+
+	SET_MSG_RESULT(&async_item->result, zbx_strdup(NULL, "Support for HTTP agent checks was not compiled in."));
+	async_poller_process_single_item(async_item, CONFIG_ERROR);
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get agent or HTTP agent items due for checking and start the      *
+ *          checks                                                            *
+ *                                                                            *
+ * Parameters: poller    - [IN] the asynchronous poller                       *
+ *             nextcheck - [OUT] the time of the next scheduled check, only   *
+ *                               set when no items were returned              *
+ *                                                                            *
+ * Return value: the number of started checks                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	async_poller_start_checks(zbx_async_poller_t *poller, int *nextcheck)
+{
+	const zbx_thread_poller_args	*poller_args = poller->poller_args;
+	const zbx_config_comms_args_t	*config_comms = poller_args->config_comms;
+	zbx_dc_item_t			item, *items;
+	AGENT_RESULT			*results;
+	int				*errcodes, num, max_items;
+	unsigned char			*started = NULL;
+	double				now;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() processing:%d", __func__, poller->processing);
+
+	max_items = poller_args->config_max_concurrent_checks_per_poller - poller->processing;
+
+	items = &item;
+
+	if (0 == (num = zbx_dc_config_get_async_poller_items(poller_args->poller_type, config_comms->config_timeout,
+			max_items, &items)))
+	{
+		*nextcheck = zbx_dc_config_get_poller_nextcheck(poller_args->poller_type);
+		goto out;
+	}
+
+	results = (AGENT_RESULT *)zbx_malloc(NULL, sizeof(AGENT_RESULT) * (size_t)num);
+	errcodes = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)num);
+
+	zbx_prepare_items(items, errcodes, num, results, MACRO_EXPAND_YES);
+
+	now = zbx_time();
+
+	if (ZBX_POLLER_TYPE_AGENT == poller_args->poller_type)
+	{
+		started = (unsigned char *)zbx_malloc(NULL, (size_t)num);
+		memset(started, 0, (size_t)num);
+
+		async_poller_start_agent_batches(poller, items, errcodes, num, now, started);
+	}
+
+	for (int i = 0; i < num; i++)
+	{
+		zbx_async_item_t	*async_item;
+
+		if (NULL != started && 0 != started[i])
+			continue;
+
+		async_item = async_item_create(poller, &items[i], now);
+
+		if (SUCCEED != errcodes[i])
+		{
+			if (ZBX_ISSET_MSG(&results[i]))
+				SET_MSG_RESULT(&async_item->result, zbx_strdup(NULL, results[i].msg));
+
+			async_poller_process_single_item(async_item, errcodes[i]);
+			continue;
+		}
+
+		if (ZBX_POLLER_TYPE_HTTPAGENT == poller_args->poller_type)
+			async_poller_start_http_check(poller, &items[i], async_item);
+		else
+			async_poller_start_agent_check(poller, &items[i], async_item);
+	}
+
+	zbx_clean_items(items, num, results);
+	zbx_dc_config_clean_items(items, NULL, (size_t)num);
+
+	zbx_free(started);
+	zbx_free(errcodes);
+	zbx_free(results);
+
+	if (items != &item)
+		zbx_free(items);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __func__, num);
+
+	return num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get SNMP items due for checking and start the checks, one batch   *
+ *          of items sharing the same interface at a time                     *
+ *                                                                            *
+ * Parameters: poller    - [IN] the asynchronous poller                       *
+ *             nextcheck - [OUT] the time of the next scheduled check, only   *
+ *                               set when no items were returned              *
+ *                                                                            *
+ * Return value: the number of started checks                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	async_poller_start_snmp_checks(zbx_async_poller_t *poller, int *nextcheck)
+{
+	const zbx_thread_poller_args	*poller_args = poller->poller_args;
+	const zbx_config_comms_args_t	*config_comms = poller_args->config_comms;
+	zbx_dc_item_t			item, *items;
+	AGENT_RESULT			results[ZBX_MAX_SNMP_ITEMS];
+	int				num, started = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() processing:%d", __func__, poller->processing);
+
+	while (poller->processing < poller_args->config_max_concurrent_checks_per_poller)
+	{
+		zbx_async_snmp_batch_t	*batch;
+		double			now;
+
+		items = &item;
+
+		if (0 == (num = zbx_dc_config_get_async_poller_items(poller_args->poller_type,
+				config_comms->config_timeout, MIN(ZBX_MAX_SNMP_ITEMS,
+				poller_args->config_max_concurrent_checks_per_poller - poller->processing), &items)))
+		{
+			if (0 == started)
+				*nextcheck = zbx_dc_config_get_poller_nextcheck(poller_args->poller_type);
+			break;
+		}
+
+		batch = (zbx_async_snmp_batch_t *)zbx_malloc(NULL, sizeof(zbx_async_snmp_batch_t));
+		batch->poller = poller;
+		batch->num = num;
+		batch->items = (zbx_async_item_t **)zbx_malloc(NULL, sizeof(zbx_async_item_t *) * (size_t)num);
+		batch->results = (AGENT_RESULT *)zbx_malloc(NULL, sizeof(AGENT_RESULT) * (size_t)num);
+		batch->errcodes = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)num);
+
+		zbx_prepare_items(items, batch->errcodes, num, results, MACRO_EXPAND_YES);
+
+		now = zbx_time();
+
+		/* the results must outlive the items, move them to the batch */
+		for (int i = 0; i < num; i++)
+		{
+			batch->items[i] = async_item_create(poller, &items[i], now);
+			batch->results[i] = results[i];
+			zbx_init_agent_result(&results[i]);
+		}
+
+		poller->processing += num;
+		started += num;
+
+#ifdef HAVE_NETSNMP
+		if (SUCCEED != zbx_async_check_snmp(poller->base, items, batch->results, batch->errcodes, num,
+				config_comms->config_timeout, config_comms->config_source_ip,
+				async_poller_snmp_done_cb, batch))
+		{
+			async_poller_snmp_skip(batch);
+		}
+#else
+		for (int i = 0; i < num; i++)
+		{
+			if (SUCCEED != batch->errcodes[i])
+				continue;
+
+			SET_MSG_RESULT(&batch->results[i], zbx_strdup(NULL,
+					"Support for SNMP checks was not compiled in."));
+			batch->errcodes[i] = CONFIG_ERROR;
+		}
+
+		async_poller_snmp_done_cb(batch);
+#endif
+		zbx_clean_items(items, num, results);
+		zbx_dc_config_clean_items(items, NULL, (size_t)num);
+
+		if (items != &item)
+			zbx_free(items);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __func__, started);
+
+	return started;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: requeue finished items and flush collected values and interface   *
+ *          availability changes                                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_poller_flush(zbx_async_poller_t *poller)
+{
+	int	nextcheck;
+
+	if (0 != poller->itemids.values_num)
+	{
+		zbx_dc_poller_requeue_items(poller->itemids.values, poller->lastclocks.values,
+				poller->errcodes.values, (size_t)poller->itemids.values_num,
+				poller->poller_args->poller_type, &nextcheck);
+
+		zbx_vector_uint64_clear(&poller->itemids);
+		zbx_vector_int32_clear(&poller->lastclocks);
+		zbx_vector_int32_clear(&poller->errcodes);
+
+		zbx_preprocessor_flush();
+	}
+
+	if (0 != poller->data_offset)
+	{
+		zbx_availability_send(ZBX_IPC_AVAILABILITY_REQUEST, poller->data, (zbx_uint32_t)poller->data_offset,
+				NULL);
+		poller->data_offset = 0;
+	}
+}
+
+static void	async_poller_timer_cb(evutil_socket_t fd, short what, void *arg)
+{
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(what);
+	ZBX_UNUSED(arg);
+}
+
+ZBX_THREAD_ENTRY(async_poller_thread, args)
+{
+	zbx_thread_poller_args	*poller_args_in = (zbx_thread_poller_args *)(((zbx_thread_args_t *)args)->args);
+
+	int			nextcheck = FAIL, started, snmp_cache_reload = 0;
+	double			sec, total_sec = 0.0;
+	time_t			last_stat_time;
+	zbx_async_poller_t	poller;
+	struct event		*timer;
+	zbx_ipc_async_socket_t	rtc;
+	const zbx_thread_info_t	*info = &((zbx_thread_args_t *)args)->info;
+	int			server_num = ((zbx_thread_args_t *)args)->info.server_num;
+	int			process_num = ((zbx_thread_args_t *)args)->info.process_num;
+	unsigned char		process_type = ((zbx_thread_args_t *)args)->info.process_type;
+	zbx_uint32_t		rtc_msgs[] = {ZBX_RTC_SNMP_CACHE_RELOAD};
+
+#define	STAT_INTERVAL	5	/* if a process is busy and does not sleep then update status not faster than */
+				/* once in STAT_INTERVAL seconds */
+#define MAX_SLEEPTIME	1	/* network events are processed and runtime control messages are checked */
+				/* at least once per MAX_SLEEPTIME seconds                                 */
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "%s #%d started [%s #%d]", get_program_type_string(info->program_type),
+			server_num, get_process_type_string(process_type), process_num);
+
+	zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	zbx_tls_init_child(poller_args_in->config_comms->config_tls,
+			poller_args_in->zbx_get_program_type_cb_arg);
+#endif
+	memset(&poller, 0, sizeof(poller));
+	poller.poller_args = poller_args_in;
+
+	if (NULL == (poller.base = event_base_new()))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize event base");
+		exit(EXIT_FAILURE);
+	}
+
+	if (NULL == (poller.dnsbase = evdns_base_new(poller.base, EVDNS_BASE_INITIALIZE_NAMESERVERS)))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize asynchronous DNS resolver");
+		exit(EXIT_FAILURE);
+	}
+
+	timer = evtimer_new(poller.base, async_poller_timer_cb, NULL);
+
+#ifdef HAVE_LIBCURL
+	if (ZBX_POLLER_TYPE_HTTPAGENT == poller_args_in->poller_type)
+	{
+		char	*error = NULL;
+
+		if (NULL == (poller.http = zbx_async_http_create(poller.base, &error)))
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot initialize HTTP client: %s", error);
+			zbx_free(error);
+			exit(EXIT_FAILURE);
+		}
+	}
+#endif
+
+	zbx_vector_uint64_create(&poller.itemids);
+	zbx_vector_int32_create(&poller.lastclocks);
+	zbx_vector_int32_create(&poller.errcodes);
+
+	zbx_setproctitle("%s #%d started", get_process_type_string(process_type), process_num);
+	last_stat_time = time(NULL);
+
+	if (ZBX_POLLER_TYPE_SNMP == poller_args_in->poller_type)
+	{
+		zbx_rtc_subscribe(process_type, process_num, rtc_msgs, ARRSIZE(rtc_msgs),
+				poller_args_in->config_comms->config_timeout, &rtc);
+	}
+	else
+		zbx_rtc_subscribe(process_type, process_num, NULL, 0, poller_args_in->config_comms->config_timeout, &rtc);
+
+	while (ZBX_IS_RUNNING())
+	{
+		zbx_uint32_t	rtc_cmd;
+		unsigned char	*rtc_data;
+		int		sleeptime;
+
+		sec = zbx_time();
+		zbx_update_env(get_process_type_string(process_type), sec);
+
+#ifdef HAVE_NETSNMP
+		/* SNMP library can be reinitialized only when there are no open sessions */
+		if (0 != snmp_cache_reload && 0 == poller.processing)
+		{
+			zbx_clear_cache_snmp(process_type, process_num);
+			snmp_cache_reload = 0;
+		}
+#endif
+		if (poller.processing >= poller_args_in->config_max_concurrent_checks_per_poller ||
+				0 != snmp_cache_reload)
+		{
+			started = 0;
+		}
+		else if (ZBX_POLLER_TYPE_SNMP == poller_args_in->poller_type)
+			started = async_poller_start_snmp_checks(&poller, &nextcheck);
+		else
+			started = async_poller_start_checks(&poller, &nextcheck);
+
+		/* more items might be due if any were returned, otherwise wait for the next check or network events */
+		if (0 != started)
+			sleeptime = 0;
+		else if (poller.processing >= poller_args_in->config_max_concurrent_checks_per_poller ||
+				0 != snmp_cache_reload)
+		{
+			sleeptime = MAX_SLEEPTIME;
+		}
+		else
+			sleeptime = zbx_calculate_sleeptime(nextcheck, MAX_SLEEPTIME);
+
+		if (0 == sleeptime)
+		{
+			event_base_loop(poller.base, EVLOOP_NONBLOCK);
+		}
+		else
+		{
+			struct timeval	tv = {sleeptime, 0};
+
+			evtimer_add(timer, &tv);
+
+			zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_IDLE);
+			event_base_loop(poller.base, EVLOOP_ONCE);
+			zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+
+			evtimer_del(timer);
+		}
+
+		async_poller_flush(&poller);
+
+		total_sec += zbx_time() - sec;
+
+		if (STAT_INTERVAL <= time(NULL) - last_stat_time)
+		{
+			double	latency_avg = 0, queue_delay_avg = 0;
+
+			if (0 != poller.processed)
+			{
+				latency_avg = poller.latency_total / poller.processed;
+				queue_delay_avg = poller.queue_delay_total / poller.processed;
+			}
+
+			zbx_setproctitle("%s #%d [got %d values in " ZBX_FS_DBL " sec, %d checks in progress,"
+					" latency avg " ZBX_FS_DBL " max " ZBX_FS_DBL " sec, queue delay avg "
+					ZBX_FS_DBL " sec]", get_process_type_string(process_type), process_num,
+					poller.processed, total_sec, poller.processing, latency_avg, poller.latency_max,
+					queue_delay_avg);
+
+			zbx_update_selfmon_poller(info, poller.processing, latency_avg, queue_delay_avg);
+
+			poller.processed = 0;
+			poller.latency_total = 0;
+			poller.latency_max = 0;
+			poller.queue_delay_total = 0;
+			total_sec = 0.0;
+			last_stat_time = time(NULL);
+		}
+
+		if (SUCCEED == zbx_rtc_wait(&rtc, info, &rtc_cmd, &rtc_data, 0) && 0 != rtc_cmd)
+		{
+#ifdef HAVE_NETSNMP
+			if (ZBX_RTC_SNMP_CACHE_RELOAD == rtc_cmd)
+				snmp_cache_reload = 1;
+#endif
+			if (ZBX_RTC_SHUTDOWN == rtc_cmd)
+				break;
+		}
+	}
+
+	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
+
+	while (1)
+		zbx_sleep(SEC_PER_MIN);
+#undef MAX_SLEEPTIME
+#undef STAT_INTERVAL
+}
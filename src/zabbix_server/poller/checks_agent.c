@@ -20,11 +20,77 @@
 #include "checks_agent.h"
 
 #include "zbxsysinfo.h"
+#include "zbxjson.h"
+#include "zbxversion.h"
+#include "zbxalgo.h"
+#include "zbxcompress.h"
+#include "zbxcrypto.h"
 
 #if !(defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL))
 extern unsigned char	program_type;
 #endif
 
+/* how long to keep requesting keys one by one from agents without multiple checks support */
+#define AGENT_LEGACY_RECHECK_PERIOD	SEC_PER_HOUR
+
+typedef struct
+{
+	zbx_uint64_t	interfaceid;
+	time_t		recheck;
+}
+zbx_agent_legacy_t;
+
+/* interfaces of agents that do not support multiple passive checks in one request */
+static zbx_hashset_t	agents_legacy;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get TLS connection arguments of the item host                     *
+ *                                                                            *
+ * Parameters: item     - [IN] the item                                       *
+ *             tls_arg1 - [OUT] the certificate issuer or PSK identity        *
+ *             tls_arg2 - [OUT] the certificate subject or PSK                *
+ *             result   - [OUT] the error message                             *
+ *                                                                            *
+ * Return value: SUCCEED      - the arguments were retrieved                  *
+ *               CONFIG_ERROR - the connection cannot be made                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_get_tls_args(const zbx_dc_item_t *item, const char **tls_arg1, const char **tls_arg2,
+		AGENT_RESULT *result)
+{
+	switch (item->host.tls_connect)
+	{
+		case ZBX_TCP_SEC_UNENCRYPTED:
+			*tls_arg1 = NULL;
+			*tls_arg2 = NULL;
+			break;
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+		case ZBX_TCP_SEC_TLS_CERT:
+			*tls_arg1 = item->host.tls_issuer;
+			*tls_arg2 = item->host.tls_subject;
+			break;
+		case ZBX_TCP_SEC_TLS_PSK:
+			*tls_arg1 = item->host.tls_psk_identity;
+			*tls_arg2 = item->host.tls_psk;
+			break;
+#else
+		case ZBX_TCP_SEC_TLS_CERT:
+		case ZBX_TCP_SEC_TLS_PSK:
+			SET_MSG_RESULT(result, zbx_dsprintf(NULL, "A TLS connection is configured to be used with agent"
+					" but support for TLS was not compiled into %s.",
+					get_program_type_string(program_type)));
+			return CONFIG_ERROR;
+#endif
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid TLS connection parameters."));
+			return CONFIG_ERROR;
+	}
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieve data from Zabbix agent                                   *
@@ -48,42 +114,14 @@ int	get_value_agent(const zbx_dc_item_t *item, int timeout, const char *config_s
 {
 	zbx_socket_t	s;
 	const char	*tls_arg1, *tls_arg2;
-	int		ret = SUCCEED;
+	int		ret;
 	ssize_t		received_len;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' addr:'%s' key:'%s' conn:'%s'", __func__, item->host.host,
 			item->interface.addr, item->key, zbx_tcp_connection_type_name(item->host.tls_connect));
 
-	switch (item->host.tls_connect)
-	{
-		case ZBX_TCP_SEC_UNENCRYPTED:
-			tls_arg1 = NULL;
-			tls_arg2 = NULL;
-			break;
-#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
-		case ZBX_TCP_SEC_TLS_CERT:
-			tls_arg1 = item->host.tls_issuer;
-			tls_arg2 = item->host.tls_subject;
-			break;
-		case ZBX_TCP_SEC_TLS_PSK:
-			tls_arg1 = item->host.tls_psk_identity;
-			tls_arg2 = item->host.tls_psk;
-			break;
-#else
-		case ZBX_TCP_SEC_TLS_CERT:
-		case ZBX_TCP_SEC_TLS_PSK:
-			SET_MSG_RESULT(result, zbx_dsprintf(NULL, "A TLS connection is configured to be used with agent"
-					" but support for TLS was not compiled into %s.",
-					get_program_type_string(program_type)));
-			ret = CONFIG_ERROR;
-			goto out;
-#endif
-		default:
-			THIS_SHOULD_NEVER_HAPPEN;
-			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid TLS connection parameters."));
-			ret = CONFIG_ERROR;
-			goto out;
-	}
+	if (SUCCEED != (ret = agent_get_tls_args(item, &tls_arg1, &tls_arg2, result)))
+		goto out;
 
 	if (SUCCEED == zbx_tcp_connect(&s, config_source_ip, item->interface.addr, item->interface.port, timeout,
 			item->host.tls_connect, tls_arg1, tls_arg2))
@@ -143,3 +181,472 @@ out:
 
 	return ret;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if agent interface is known not to support multiple        *
+ *          passive checks in one request                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	agent_is_legacy(zbx_uint64_t interfaceid, time_t now)
+{
+	zbx_agent_legacy_t	*agent;
+
+	if (0 == agents_legacy.num_slots)
+	{
+		zbx_hashset_create(&agents_legacy, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		return FAIL;
+	}
+
+	if (NULL == (agent = (zbx_agent_legacy_t *)zbx_hashset_search(&agents_legacy, &interfaceid)))
+		return FAIL;
+
+	if (agent->recheck <= now)
+	{
+		zbx_hashset_remove_direct(&agents_legacy, agent);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+void	agent_set_legacy(zbx_uint64_t interfaceid, time_t now)
+{
+	zbx_agent_legacy_t	agent_local = {.interfaceid = interfaceid, .recheck = now + AGENT_LEGACY_RECHECK_PERIOD};
+
+	if (0 == agents_legacy.num_slots)
+		zbx_hashset_create(&agents_legacy, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_hashset_insert(&agents_legacy, &agent_local, sizeof(agent_local));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start multiple passive checks request                             *
+ *                                                                            *
+ * Comments: request:                                                         *
+ *             {"request":"passive checks","data":[{"key":"..."},...]}        *
+ *           The agent replies with a separate message per requested key in   *
+ *           the same order as the keys were requested:                       *
+ *             {"version":"...","value":"..."} or                             *
+ *             {"version":"...","error":"..."}                                *
+ *                                                                            *
+ ******************************************************************************/
+void	agent_batch_request_init(struct zbx_json *j)
+{
+	zbx_json_init(j, ZBX_JSON_STAT_BUF_LEN);
+	zbx_json_addstring(j, ZBX_PROTO_TAG_REQUEST, ZBX_PROTO_VALUE_PASSIVE_CHECKS, ZBX_JSON_TYPE_STRING);
+	zbx_json_addarray(j, ZBX_PROTO_TAG_DATA);
+}
+
+void	agent_batch_request_add(struct zbx_json *j, const char *key)
+{
+	zbx_json_addobject(j, NULL);
+	zbx_json_addstring(j, ZBX_PROTO_TAG_KEY, key, ZBX_JSON_TYPE_STRING);
+	zbx_json_close(j);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: extract the first Zabbix protocol message from received data      *
+ *                                                                            *
+ * Parameters: data      - [IN] the received data                             *
+ *             len       - [IN] the received data length                      *
+ *             payload   - [OUT] the message payload, NULL if more data must  *
+ *                               be received                                  *
+ *             frame_len - [OUT] the message length including header          *
+ *             error     - [OUT] the error message                            *
+ *                                                                            *
+ * Return value: SUCCEED - the message was extracted or more data is needed   *
+ *               FAIL    - the data is not a valid Zabbix protocol message    *
+ *                                                                            *
+ ******************************************************************************/
+int	agent_parse_frame(const char *data, size_t len, char **payload, size_t *frame_len, char **error)
+{
+	unsigned char	protocol;
+	size_t		header_size;
+	zbx_uint64_t	expected_len, reserved;
+
+	*payload = NULL;
+
+	if (0 != strncmp(data, ZBX_AGENT_HEADER_DATA, MIN(len, ZBX_AGENT_HEADER_LEN)))
+	{
+		*error = zbx_strdup(NULL, "invalid message header");
+		return FAIL;
+	}
+
+	if (ZBX_AGENT_HEADER_LEN >= len)
+		return SUCCEED;
+
+	protocol = (unsigned char)data[ZBX_AGENT_HEADER_LEN];
+
+	if (0 == (protocol & ZBX_TCP_PROTOCOL))
+	{
+		*error = zbx_dsprintf(NULL, "unsupported protocol version 0x%02x", (unsigned int)protocol);
+		return FAIL;
+	}
+
+	header_size = (0 != (protocol & ZBX_TCP_LARGE) ? ZBX_AGENT_LARGE_HEADER_SIZE : ZBX_AGENT_HEADER_SIZE);
+
+	if (header_size > len)
+		return SUCCEED;
+
+	if (0 != (protocol & ZBX_TCP_LARGE))
+	{
+		zbx_uint64_t	len64;
+
+		memcpy(&len64, data + ZBX_AGENT_HEADER_LEN + 1, sizeof(len64));
+		expected_len = zbx_letoh_uint64(len64);
+		memcpy(&len64, data + ZBX_AGENT_HEADER_LEN + 1 + sizeof(len64), sizeof(len64));
+		reserved = zbx_letoh_uint64(len64);
+	}
+	else
+	{
+		zbx_uint32_t	len32;
+
+		memcpy(&len32, data + ZBX_AGENT_HEADER_LEN + 1, sizeof(len32));
+		expected_len = zbx_letoh_uint32(len32);
+		memcpy(&len32, data + ZBX_AGENT_HEADER_LEN + 1 + sizeof(len32), sizeof(len32));
+		reserved = zbx_letoh_uint32(len32);
+	}
+
+	if (ZBX_MAX_RECV_DATA_SIZE < expected_len || (0 != (protocol & ZBX_TCP_COMPRESS) &&
+			ZBX_MAX_RECV_DATA_SIZE < reserved))
+	{
+		*error = zbx_dsprintf(NULL, "message size " ZBX_FS_UI64 " exceeds the maximum size " ZBX_FS_UI64
+				" bytes", MAX(expected_len, reserved), (zbx_uint64_t)ZBX_MAX_RECV_DATA_SIZE);
+		return FAIL;
+	}
+
+	if (header_size + expected_len > len)
+		return SUCCEED;
+
+	if (0 != (protocol & ZBX_TCP_COMPRESS))
+	{
+		size_t	out_len = (size_t)reserved;
+
+		*payload = (char *)zbx_malloc(NULL, out_len + 1);
+
+		if (FAIL == zbx_uncompress(data + header_size, (size_t)expected_len, *payload, &out_len))
+		{
+			zbx_free(*payload);
+			*error = zbx_dsprintf(NULL, "cannot uncompress data: %s", zbx_compress_strerror());
+			return FAIL;
+		}
+
+		if (out_len != reserved)
+		{
+			zbx_free(*payload);
+			*error = zbx_strdup(NULL, "size of uncompressed data is less than expected");
+			return FAIL;
+		}
+
+		(*payload)[out_len] = '\0';
+	}
+	else
+	{
+		*payload = (char *)zbx_malloc(NULL, (size_t)expected_len + 1);
+		memcpy(*payload, data + header_size, (size_t)expected_len);
+		(*payload)[expected_len] = '\0';
+	}
+
+	*frame_len = header_size + (size_t)expected_len;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parse agent reply to one key of multiple passive checks request   *
+ *                                                                            *
+ * Parameters: reply  - [IN] the reply                                        *
+ *             result - [OUT] the item value or error                         *
+ *                                                                            *
+ * Return value: SUCCEED      - the value was returned                        *
+ *               NOTSUPPORTED - the key is not supported by agent             *
+ *               FAIL         - the reply is not a reply to multiple passive  *
+ *                              checks request                                *
+ *                                                                            *
+ ******************************************************************************/
+int	agent_parse_batch_reply(const char *reply, AGENT_RESULT *result)
+{
+	struct zbx_json_parse	jp;
+	char			version[MAX_STRING_LEN], *value = NULL;
+	size_t			value_alloc = 0;
+	int			ret;
+
+	if (SUCCEED != zbx_json_open(reply, &jp) || SUCCEED != zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_VERSION,
+			version, sizeof(version), NULL) ||
+			ZBX_COMPONENT_VERSION(7, 0, 0) > zbx_get_component_version(version))
+	{
+		return FAIL;
+	}
+
+	if (SUCCEED == zbx_json_value_by_name_dyn(&jp, ZBX_PROTO_TAG_VALUE, &value, &value_alloc, NULL))
+	{
+		zbx_set_agent_result_type(result, ITEM_VALUE_TYPE_TEXT, value);
+		ret = SUCCEED;
+	}
+	else if (SUCCEED == zbx_json_value_by_name_dyn(&jp, ZBX_PROTO_TAG_ERROR, &value, &value_alloc, NULL))
+	{
+		/* empty error is reported as not supported without the reason */
+		SET_MSG_RESULT(result, zbx_strdup(NULL, '\0' != *value ? value : "Not supported by Zabbix Agent"));
+		ret = NOTSUPPORTED;
+	}
+	else
+		ret = FAIL;
+
+	zbx_free(value);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receive agent reply to the next key of multiple passive checks    *
+ *          request                                                           *
+ *                                                                            *
+ * Parameters: s             - [IN] the connection socket                     *
+ *             buffer        - [IN/OUT] the received data not parsed yet      *
+ *             buffer_alloc  - [IN/OUT]                                       *
+ *             buffer_offset - [IN/OUT]                                       *
+ *             timeout       - [IN] the time to wait for the reply            *
+ *             reply         - [OUT] the reply                                *
+ *             error         - [OUT] the error message, NULL if connection    *
+ *                                   was closed without sending anything      *
+ *                                                                            *
+ * Return value: SUCCEED       - the reply was received                       *
+ *               NETWORK_ERROR - network error or connection closed           *
+ *               TIMEOUT_ERROR - the reply was not received in time           *
+ *               FAIL          - invalid data was received                    *
+ *                                                                            *
+ * Comments: The agent sends reply as soon as the key is checked, so the      *
+ *           timeout applies to each key instead of the whole request.        *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_recv_batch_reply(zbx_socket_t *s, char **buffer, size_t *buffer_alloc, size_t *buffer_offset,
+		int timeout, char **reply, char **error)
+{
+	size_t	frame_len;
+	ssize_t	n;
+	int	ret;
+
+	zbx_socket_set_deadline(s, timeout);
+
+	while (1)
+	{
+		if (SUCCEED != agent_parse_frame(*buffer, *buffer_offset, reply, &frame_len, error))
+		{
+			ret = FAIL;
+			break;
+		}
+
+		if (NULL != *reply)
+		{
+			*buffer_offset -= frame_len;
+			memmove(*buffer, *buffer + frame_len, *buffer_offset);
+			ret = SUCCEED;
+			break;
+		}
+
+		if (*buffer_alloc - *buffer_offset < ZBX_AGENT_RECV_BUF_LEN / 2)
+		{
+			*buffer_alloc *= 2;
+			*buffer = (char *)zbx_realloc(*buffer, *buffer_alloc);
+		}
+
+		if (ZBX_PROTO_ERROR == (n = zbx_tcp_read(s, *buffer + *buffer_offset,
+				*buffer_alloc - *buffer_offset)))
+		{
+			ret = (SUCCEED != zbx_socket_check_deadline(s) ? TIMEOUT_ERROR : NETWORK_ERROR);
+			*error = zbx_strdup(NULL, zbx_socket_strerror());
+			break;
+		}
+
+		if (0 == n)
+		{
+			if (0 != *buffer_offset)
+			{
+				*error = zbx_dsprintf(NULL, "connection closed after receiving " ZBX_FS_SIZE_T
+						" bytes of incomplete message", (zbx_fs_size_t)*buffer_offset);
+			}
+
+			ret = NETWORK_ERROR;
+			break;
+		}
+
+		*buffer_offset += (size_t)n;
+	}
+
+	zbx_socket_set_deadline(s, 0);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieve values of multiple items from Zabbix agent over a single *
+ *          connection                                                        *
+ *                                                                            *
+ * Parameters: items            - [IN] items sharing the same interface       *
+ *             results          - [OUT]                                       *
+ *             errcodes         - [IN/OUT] only items with SUCCEED error code *
+ *                                         are checked                        *
+ *             num              - [IN] number of items                        *
+ *             timeout          - [IN] the timeout of each key                *
+ *             config_source_ip - [IN]                                        *
+ *                                                                            *
+ * Comments: All keys are sent in one "passive checks" request, the agent     *
+ *           replies to each key separately as soon as it is checked. If the  *
+ *           connection fails midway the values already received are kept.   *
+ *           Agents without support of such requests reply as to an invalid   *
+ *           key, then keys are requested one by one and the interface is     *
+ *           remembered to do so for a while without trying multiple checks   *
+ *           request.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+void	get_values_agent(const zbx_dc_item_t *items, AGENT_RESULT *results, int *errcodes, int num, int timeout,
+		const char *config_source_ip)
+{
+	zbx_socket_t	s;
+	struct zbx_json	j;
+	const char	*tls_arg1, *tls_arg2;
+	char		*buffer, *reply = NULL, *error = NULL, *msg = NULL;
+	size_t		buffer_alloc = ZBX_AGENT_RECV_BUF_LEN, buffer_offset = 0;
+	int		i, rc, ret = SUCCEED, keys_num = 0, replies_num = 0;
+	time_t		now;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' addr:'%s' num:%d conn:'%s'", __func__, items[0].host.host,
+			items[0].interface.addr, num, zbx_tcp_connection_type_name(items[0].host.tls_connect));
+
+	now = time(NULL);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED == errcodes[i])
+			keys_num++;
+	}
+
+	if (2 > keys_num || SUCCEED == agent_is_legacy(items[0].interface.interfaceid, now))
+		goto fallback;
+
+	if (SUCCEED != agent_get_tls_args(&items[0], &tls_arg1, &tls_arg2, &results[0]))
+	{
+		zbx_free_agent_result(&results[0]);
+		goto fallback;
+	}
+
+	if (SUCCEED != zbx_tcp_connect(&s, config_source_ip, items[0].interface.addr, items[0].interface.port,
+			timeout, items[0].host.tls_connect, tls_arg1, tls_arg2))
+	{
+		for (i = 0; i < num; i++)
+		{
+			if (SUCCEED != errcodes[i])
+				continue;
+
+			SET_MSG_RESULT(&results[i], zbx_dsprintf(NULL, "Get value from agent failed: %s",
+					zbx_socket_strerror()));
+			errcodes[i] = NETWORK_ERROR;
+		}
+
+		goto out;
+	}
+
+	agent_batch_request_init(&j);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED == errcodes[i])
+			agent_batch_request_add(&j, items[i].key);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "Sending [%s]", j.buffer);
+
+	if (SUCCEED != zbx_tcp_send(&s, j.buffer))
+	{
+		ret = NETWORK_ERROR;
+		error = zbx_strdup(NULL, zbx_socket_strerror());
+	}
+
+	zbx_json_free(&j);
+
+	buffer = (char *)zbx_malloc(NULL, buffer_alloc);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		if (SUCCEED == ret && SUCCEED == (ret = agent_recv_batch_reply(&s, &buffer, &buffer_alloc,
+				&buffer_offset, timeout, &reply, &error)))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "get values from agent result: '%s'", reply);
+
+			rc = agent_parse_batch_reply(reply, &results[i]);
+			zbx_free(reply);
+
+			if (FAIL == rc)
+			{
+				if (0 == replies_num)
+					goto legacy;
+
+				SET_MSG_RESULT(&results[i], zbx_strdup(NULL, "Invalid Zabbix Agent response."));
+				rc = NOTSUPPORTED;
+			}
+
+			errcodes[i] = rc;
+			replies_num++;
+			continue;
+		}
+
+		if (FAIL == ret)
+		{
+			if (0 == replies_num)
+				goto legacy;
+
+			ret = NETWORK_ERROR;
+		}
+
+		/* the rest of keys fail with the same error */
+		if (NULL == msg)
+		{
+			if (NULL != error)
+				msg = zbx_dsprintf(NULL, "Get value from agent failed: %s", error);
+			else if (0 == replies_num)
+			{
+				msg = zbx_dsprintf(NULL, "Received empty response from Zabbix Agent at [%s]. Assuming"
+						" that agent dropped connection because of access permissions.",
+						items[i].interface.addr);
+			}
+			else
+				msg = zbx_strdup(NULL, "Get value from agent failed: connection closed by agent");
+		}
+
+		SET_MSG_RESULT(&results[i], zbx_strdup(NULL, msg));
+		errcodes[i] = ret;
+	}
+
+	zbx_free(msg);
+	zbx_free(error);
+	zbx_free(buffer);
+	zbx_tcp_close(&s);
+
+	goto out;
+legacy:
+	zabbix_log(LOG_LEVEL_DEBUG, "agent at [%s] does not support multiple passive checks, falling back to single"
+			" key requests", items[0].interface.addr);
+
+	agent_set_legacy(items[0].interface.interfaceid, now);
+
+	zbx_free(error);
+	zbx_free(buffer);
+	zbx_tcp_close(&s);
+fallback:
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED == errcodes[i])
+			errcodes[i] = get_value_agent(&items[i], timeout, config_source_ip, &results[i]);
+	}
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
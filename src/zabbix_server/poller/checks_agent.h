@@ -21,8 +21,26 @@
 #define ZABBIX_CHECKS_AGENT_H
 
 #include "zbxcacheconfig.h"
+#include "zbxjson.h"
 #include "module.h"
 
+#define ZBX_AGENT_HEADER_DATA		"ZBXD"
+#define ZBX_AGENT_HEADER_LEN		ZBX_CONST_STRLEN(ZBX_AGENT_HEADER_DATA)
+#define ZBX_AGENT_HEADER_SIZE		(ZBX_AGENT_HEADER_LEN + 1 + 2 * sizeof(zbx_uint32_t))
+#define ZBX_AGENT_LARGE_HEADER_SIZE	(ZBX_AGENT_HEADER_LEN + 1 + 2 * sizeof(zbx_uint64_t))
+
+#define ZBX_AGENT_RECV_BUF_LEN		1024
+
 int	get_value_agent(const zbx_dc_item_t *item, int timeout, const char *config_source_ip, AGENT_RESULT *result);
+void	get_values_agent(const zbx_dc_item_t *items, AGENT_RESULT *results, int *errcodes, int num, int timeout,
+		const char *config_source_ip);
+
+int	agent_is_legacy(zbx_uint64_t interfaceid, time_t now);
+void	agent_set_legacy(zbx_uint64_t interfaceid, time_t now);
+
+void	agent_batch_request_init(struct zbx_json *j);
+void	agent_batch_request_add(struct zbx_json *j, const char *key);
+int	agent_parse_frame(const char *data, size_t len, char **payload, size_t *frame_len, char **error);
+int	agent_parse_batch_reply(const char *reply, AGENT_RESULT *result);
 
 #endif
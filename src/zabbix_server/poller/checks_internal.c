@@ -557,8 +557,9 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 		}
 		else
 		{
-			unsigned char	aggr_func, state;
+			unsigned char	aggr_func, state = ZBX_PROCESS_STATE_BUSY;
 			unsigned short	process_num = 0;
+			int		buffer = 0, poller_stat = -1;
 			char		*error = NULL;
 
 			if ('\0' == *tmp || 0 == strcmp(tmp, "avg"))
@@ -592,13 +593,48 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 				state = ZBX_PROCESS_STATE_BUSY;
 			else if (0 == strcmp(tmp, "idle"))
 				state = ZBX_PROCESS_STATE_IDLE;
+			else if (0 == strcmp(tmp, "buffer"))
+				buffer = 1;
+			else if (0 == strcmp(tmp, "checks"))
+				poller_stat = ZBX_SELFMON_POLLER_CHECKS;
+			else if (0 == strcmp(tmp, "latency"))
+				poller_stat = ZBX_SELFMON_POLLER_LATENCY;
+			else if (0 == strcmp(tmp, "queue"))
+				poller_stat = ZBX_SELFMON_POLLER_QUEUE_DELAY;
 			else
 			{
 				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid fourth parameter."));
 				goto out;
 			}
 
-			if (ZBX_PROCESS_TYPE_PREPROCESSOR == process_type ||
+			if (0 != buffer)
+			{
+				zbx_uint64_t	size;
+
+				/* the largest message received by process */
+				if (SUCCEED != zbx_get_selfmon_buffer_stats(process_type, aggr_func, process_num, &size))
+				{
+					SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Buffer size is not monitored for"
+							" \"%s\" processes.", get_process_type_string(process_type)));
+					goto out;
+				}
+
+				SET_UI64_RESULT(result, size);
+			}
+			else if (-1 != poller_stat)
+			{
+				/* checks in progress, average latency and queue delay of asynchronous pollers */
+				if (SUCCEED != zbx_get_selfmon_poller_stats(process_type, aggr_func, process_num,
+						poller_stat, &value))
+				{
+					SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Poller statistics are not available"
+							" for \"%s\" processes.", get_process_type_string(process_type)));
+					goto out;
+				}
+
+				SET_DBL_RESULT(result, value);
+			}
+			else if (ZBX_PROCESS_TYPE_PREPROCESSOR == process_type ||
 					ZBX_PROCESS_TYPE_DISCOVERER == process_type)
 			{
 				zbx_selfmon_stats_threads_cb_t	stats_func;
@@ -612,11 +648,14 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 					SET_MSG_RESULT(result, error);
 					goto out;
 				}
+
+				SET_DBL_RESULT(result, value);
 			}
 			else
+			{
 				zbx_get_selfmon_stats(process_type, aggr_func, process_num, state, &value);
-
-			SET_DBL_RESULT(result, value);
+				SET_DBL_RESULT(result, value);
+			}
 		}
 	}
 	else if (0 == strcmp(tmp, "wcache"))			/* zabbix[wcache,<cache>,<mode>] */
@@ -666,6 +705,66 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_HISTORY_FREE));
 			else if (0 == strcmp(tmp1, "pused"))
 				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_HISTORY_PUSED));
+			else if (0 == strcmp(tmp1, "lockwait"))
+				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_HISTORY_LOCK_WAIT));
+			else if (0 == strcmp(tmp1, "queue"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_HISTORY_QUEUE));
+			else if (0 == strcmp(tmp1, "delay"))
+				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_HISTORY_DELAY));
+			else if (0 == strcmp(tmp1, "copied"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_HISTORY_COPIED));
+			else if (0 == strcmp(tmp1, "copyrate"))
+				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_HISTORY_COPY_RATE));
+			else
+			{
+				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
+				goto out;
+			}
+		}
+		else if (0 == strcmp(tmp, "triggers"))
+		{
+			if (0 == (program_type & ZBX_PROGRAM_TYPE_SERVER))
+			{
+				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
+				goto out;
+			}
+
+			if (NULL == tmp1 || '\0' == *tmp1 || 0 == strcmp(tmp1, "queue"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_TRIGGER_QUEUE));
+			else if (0 == strcmp(tmp1, "delay"))
+				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_TRIGGER_DELAY));
+			else if (0 == strcmp(tmp1, "processed"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_TRIGGER_PROCESSED));
+			else if (0 == strcmp(tmp1, "wait"))
+				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_TRIGGER_WAIT));
+			else
+			{
+				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
+				goto out;
+			}
+		}
+		else if (0 == strcmp(tmp, "correlation"))
+		{
+			if (0 == (program_type & ZBX_PROGRAM_TYPE_SERVER))
+			{
+				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
+				goto out;
+			}
+
+			if (NULL == tmp1 || '\0' == *tmp1 || 0 == strcmp(tmp1, "events"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_CORR_EVENTS));
+			else if (0 == strcmp(tmp1, "rules"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_CORR_RULES));
+			else if (0 == strcmp(tmp1, "skipped"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_CORR_RULES_SKIPPED));
+			else if (0 == strcmp(tmp1, "checked"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_CORR_PROBLEMS_CHECKED));
+			else if (0 == strcmp(tmp1, "matched"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_CORR_MATCHES));
+			else if (0 == strcmp(tmp1, "problems"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_CORR_PROBLEMS));
+			else if (0 == strcmp(tmp1, "loaded"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_CORR_PROBLEMS_LOADED));
 			else
 			{
 				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
@@ -690,6 +789,8 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_TREND_FREE));
 			else if (0 == strcmp(tmp1, "pused"))
 				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_TREND_PUSED));
+			else if (0 == strcmp(tmp1, "upserted"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_TREND_UPSERTED));
 			else
 			{
 				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
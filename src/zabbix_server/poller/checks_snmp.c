@@ -31,6 +31,8 @@
 #include "zbxparam.h"
 #include "zbxsysinfo.h"
 
+#include <event2/event.h>
+
 /*
  * SNMP Dynamic Index Cache
  * ========================
@@ -1370,71 +1372,126 @@ out:
 	return ret;
 }
 
-static int	zbx_snmp_get_values(zbx_snmp_sess_t ssp, const zbx_dc_item_t *items,
-		char oids[][ZBX_ITEM_SNMP_OID_LEN_MAX], AGENT_RESULT *results, int *errcodes,
-		unsigned char *query_and_ignore_type, int num, int level, char *error, size_t max_error_len,
-		int *max_succeed, int *min_fail, unsigned char poller_type)
+/* the actions to take after processing SNMP GET response */
+#define ZBX_SNMP_GET_DONE	0	/* the request is finished */
+#define ZBX_SNMP_GET_RETRY	1	/* the fixed request PDU must be sent again */
+#define ZBX_SNMP_GET_HALVE	2	/* the request must be split into smaller ones */
+
+/* SNMP GET request, shared by synchronous and asynchronous checks */
+typedef struct
 {
-	int			i, j, status, ret = SUCCEED;
-	int			mapping[ZBX_MAX_SNMP_ITEMS], mapping_num = 0;
-	oid			parsed_oids[ZBX_MAX_SNMP_ITEMS][MAX_OID_LEN];
-	size_t			parsed_oid_lens[ZBX_MAX_SNMP_ITEMS];
-	struct snmp_pdu		*pdu, *response;
-	struct variable_list	*var;
-	unsigned char		val_type;
-	struct snmp_session	*ss;
+	const char			*host;
+	const zbx_dc_interface_t	*interface;
+	char				(*oids)[ZBX_ITEM_SNMP_OID_LEN_MAX];
+	AGENT_RESULT			*results;
+	int				*errcodes;
+	unsigned char			*query_and_ignore_type;
+	int				num;
+	oid				(*parsed_oids)[MAX_OID_LEN];
+	size_t				*parsed_oid_lens;
+	int				mapping[ZBX_MAX_SNMP_ITEMS];
+	int				mapping_num;
+}
+zbx_snmp_get_t;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() num:%d level:%d", __func__, num, level);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create SNMP GET request PDU for the items that are not failed yet *
+ *                                                                            *
+ * Parameters: get           - [IN/OUT] the request                           *
+ *             pdu           - [OUT] the request PDU, NULL if there is        *
+ *                                   nothing to query                         *
+ *             error         - [OUT] the error message                        *
+ *             max_error_len - [IN] the error message buffer size             *
+ *                                                                            *
+ * Return value: SUCCEED - the PDU was created or there was nothing to query  *
+ *               CONFIG_ERROR - failed to create the PDU                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_snmp_get_prepare(zbx_snmp_get_t *get, struct snmp_pdu **pdu, char *error, size_t max_error_len)
+{
+	int	i;
+
+	get->mapping_num = 0;
 
-	if (NULL == (pdu = snmp_pdu_create(SNMP_MSG_GET)))
+	if (NULL == (*pdu = snmp_pdu_create(SNMP_MSG_GET)))
 	{
 		zbx_strlcpy(error, "snmp_pdu_create(): cannot create PDU object.", max_error_len);
-		ret = CONFIG_ERROR;
-		goto out;
+		return CONFIG_ERROR;
 	}
 
-	for (i = 0; i < num; i++)
+	for (i = 0; i < get->num; i++)
 	{
-		if (SUCCEED != errcodes[i])
+		if (SUCCEED != get->errcodes[i])
 			continue;
 
-		if (NULL != query_and_ignore_type && 0 == query_and_ignore_type[i])
+		if (NULL != get->query_and_ignore_type && 0 == get->query_and_ignore_type[i])
 			continue;
 
-		parsed_oid_lens[i] = MAX_OID_LEN;
+		get->parsed_oid_lens[i] = MAX_OID_LEN;
 
-		if (NULL == snmp_parse_oid(oids[i], parsed_oids[i], &parsed_oid_lens[i]))
+		if (NULL == snmp_parse_oid(get->oids[i], get->parsed_oids[i], &get->parsed_oid_lens[i]))
 		{
-			SET_MSG_RESULT(&results[i], zbx_dsprintf(NULL, "snmp_parse_oid(): cannot parse OID \"%s\".",
-					oids[i]));
-			errcodes[i] = CONFIG_ERROR;
+			SET_MSG_RESULT(&get->results[i], zbx_dsprintf(NULL, "snmp_parse_oid(): cannot parse OID \"%s\".",
+					get->oids[i]));
+			get->errcodes[i] = CONFIG_ERROR;
 			continue;
 		}
 
-		if (NULL == snmp_add_null_var(pdu, parsed_oids[i], parsed_oid_lens[i]))
+		if (NULL == snmp_add_null_var(*pdu, get->parsed_oids[i], get->parsed_oid_lens[i]))
 		{
-			SET_MSG_RESULT(&results[i], zbx_strdup(NULL, "snmp_add_null_var(): cannot add null variable."));
-			errcodes[i] = CONFIG_ERROR;
+			SET_MSG_RESULT(&get->results[i], zbx_strdup(NULL,
+					"snmp_add_null_var(): cannot add null variable."));
+			get->errcodes[i] = CONFIG_ERROR;
 			continue;
 		}
 
-		mapping[mapping_num++] = i;
+		get->mapping[get->mapping_num++] = i;
 	}
 
-	if (0 == mapping_num)
+	if (0 == get->mapping_num)
 	{
-		snmp_free_pdu(pdu);
-		goto out;
+		snmp_free_pdu(*pdu);
+		*pdu = NULL;
 	}
 
-	ss = snmp_sess_session(ssp);
-	ss->retries = (1 == mapping_num && 0 == level && ZBX_POLLER_TYPE_UNREACHABLE != poller_type ? 1 : 0);
-retry:
-	status = snmp_sess_synch_response(ssp, pdu, &response);
+	return SUCCEED;
+}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "%s() snmp_sess_synch_response() status:%d s_snmp_errno:%d errstat:%ld mapping_num:%d",
-			__func__, status, ss->s_snmp_errno, NULL == response ? (long)-1 : response->errstat,
-			mapping_num);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process SNMP GET response                                         *
+ *                                                                            *
+ * Parameters: ssp           - [IN] SNMP session handle                       *
+ *             get           - [IN/OUT] the request                           *
+ *             status        - [IN] the request status                        *
+ *             response      - [IN] the response PDU, can be NULL             *
+ *             level         - [IN] the request splitting level               *
+ *             pdu           - [OUT] the fixed request PDU to send, only set  *
+ *                                   when ZBX_SNMP_GET_RETRY is returned      *
+ *             error         - [OUT] the error message                        *
+ *             max_error_len - [IN] the error message buffer size             *
+ *             max_succeed   - [OUT] number of variables that succeeded       *
+ *             min_fail      - [OUT] number of variables that failed          *
+ *             ret           - [OUT] the request result                       *
+ *                                                                            *
+ * Return value: ZBX_SNMP_GET_DONE  - the request is finished                 *
+ *               ZBX_SNMP_GET_RETRY - the fixed PDU must be sent again        *
+ *               ZBX_SNMP_GET_HALVE - the request must be split: at level 0   *
+ *                                    into two halves, at level 1 into single *
+ *                                    item requests                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_snmp_get_process_response(zbx_snmp_sess_t ssp, zbx_snmp_get_t *get, int status,
+		struct snmp_pdu *response, int level, struct snmp_pdu **pdu, char *error, size_t max_error_len,
+		int *max_succeed, int *min_fail, int *ret)
+{
+	int			i, j;
+	struct variable_list	*var;
+	unsigned char		val_type;
+	struct snmp_session	*ss = snmp_sess_session(ssp);
+
+	*ret = SUCCEED;
 
 	if (STAT_SUCCESS == status && SNMP_ERR_NOERROR == response->errstat)
 	{
@@ -1442,20 +1499,20 @@ retry:
 		{
 			/* check that response variable binding matches the request variable binding */
 
-			if (i == mapping_num)
+			if (i == get->mapping_num)
 			{
 				if (NULL != var)
 				{
 					zabbix_log(LOG_LEVEL_WARNING, "SNMP response from host \"%s\" contains"
-							" too many variable bindings", items[0].host.host);
+							" too many variable bindings", get->host);
 
-					if (1 != mapping_num)	/* give device a chance to handle a smaller request */
+					if (1 != get->mapping_num)	/* give device a chance to handle a smaller request */
 						goto halve;
 
 					zbx_strlcpy(error, "Invalid SNMP response: too many variable bindings.",
 							max_error_len);
 
-					ret = NOTSUPPORTED;
+					*ret = NOTSUPPORTED;
 				}
 
 				break;
@@ -1464,33 +1521,34 @@ retry:
 			if (NULL == var)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "SNMP response from host \"%s\" contains"
-						" too few variable bindings", items[0].host.host);
+						" too few variable bindings", get->host);
 
-				if (1 != mapping_num)	/* give device a chance to handle a smaller request */
+				if (1 != get->mapping_num)	/* give device a chance to handle a smaller request */
 					goto halve;
 
 				zbx_strlcpy(error, "Invalid SNMP response: too few variable bindings.", max_error_len);
 
-				ret = NOTSUPPORTED;
+				*ret = NOTSUPPORTED;
 				break;
 			}
 
-			j = mapping[i];
+			j = get->mapping[i];
 
-			if (parsed_oid_lens[j] != var->name_length ||
-					0 != memcmp(parsed_oids[j], var->name, parsed_oid_lens[j] * sizeof(oid)))
+			if (get->parsed_oid_lens[j] != var->name_length ||
+					0 != memcmp(get->parsed_oids[j], var->name, get->parsed_oid_lens[j] * sizeof(oid)))
 			{
 				char	sent_oid[ZBX_ITEM_SNMP_OID_LEN_MAX], received_oid[ZBX_ITEM_SNMP_OID_LEN_MAX];
 
-				zbx_snmp_dump_oid(sent_oid, sizeof(sent_oid), parsed_oids[j], parsed_oid_lens[j]);
+				zbx_snmp_dump_oid(sent_oid, sizeof(sent_oid), get->parsed_oids[j],
+						get->parsed_oid_lens[j]);
 				zbx_snmp_dump_oid(received_oid, sizeof(received_oid), var->name, var->name_length);
 
-				if (1 != mapping_num)
+				if (1 != get->mapping_num)
 				{
 					zabbix_log(LOG_LEVEL_WARNING, "SNMP response from host \"%s\" contains"
 							" variable bindings that do not match the request:"
 							" sent \"%s\", received \"%s\"",
-							items[0].host.host, sent_oid, received_oid);
+							get->host, sent_oid, received_oid);
 
 					goto halve;	/* give device a chance to handle a smaller request */
 				}
@@ -1499,25 +1557,25 @@ retry:
 					zabbix_log(LOG_LEVEL_DEBUG, "SNMP response from host \"%s\" contains"
 							" variable bindings that do not match the request:"
 							" sent \"%s\", received \"%s\"",
-							items[0].host.host, sent_oid, received_oid);
+							get->host, sent_oid, received_oid);
 				}
 			}
 
 			/* process received data */
 
-			if (NULL != query_and_ignore_type && 1 == query_and_ignore_type[j])
-				(void)zbx_snmp_set_result(var, &results[j], &val_type);
+			if (NULL != get->query_and_ignore_type && 1 == get->query_and_ignore_type[j])
+				(void)zbx_snmp_set_result(var, &get->results[j], &val_type);
 			else
-				errcodes[j] = zbx_snmp_set_result(var, &results[j], &val_type);
+				get->errcodes[j] = zbx_snmp_set_result(var, &get->results[j], &val_type);
 
-			if (ZBX_ISSET_TEXT(&results[j]) && ZBX_SNMP_STR_HEX == val_type)
-				zbx_remove_chars(results[j].text, "\r\n");
+			if (ZBX_ISSET_TEXT(&get->results[j]) && ZBX_SNMP_STR_HEX == val_type)
+				zbx_remove_chars(get->results[j].text, "\r\n");
 		}
 
-		if (SUCCEED == ret)
+		if (SUCCEED == *ret)
 		{
-			if (*max_succeed < mapping_num)
-				*max_succeed = mapping_num;
+			if (*max_succeed < get->mapping_num)
+				*max_succeed = get->mapping_num;
 		}
 		/* min_fail value is updated when bulk request is halved in the case of failure */
 	}
@@ -1532,48 +1590,45 @@ retry:
 
 		i = response->errindex - 1;
 
-		if (0 > i || i >= mapping_num)
+		if (0 > i || i >= get->mapping_num)
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "SNMP response from host \"%s\" contains"
-					" an out of bounds error index: %ld", items[0].host.host, response->errindex);
+					" an out of bounds error index: %ld", get->host, response->errindex);
 
 			zbx_strlcpy(error, "Invalid SNMP response: error index out of bounds.", max_error_len);
 
-			ret = NOTSUPPORTED;
-			goto exit;
+			*ret = NOTSUPPORTED;
+			return ZBX_SNMP_GET_DONE;
 		}
 
-		j = mapping[i];
+		j = get->mapping[i];
 
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() snmp_sess_synch_response() errindex:%ld OID:'%s'", __func__,
-				response->errindex, oids[j]);
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() errindex:%ld OID:'%s'", __func__, response->errindex, get->oids[j]);
 
-		if (NULL == query_and_ignore_type || 0 == query_and_ignore_type[j])
+		if (NULL == get->query_and_ignore_type || 0 == get->query_and_ignore_type[j])
 		{
-			errcodes[j] = zbx_get_snmp_response_error(ssp, &items[0].interface, status, response, error,
+			get->errcodes[j] = zbx_get_snmp_response_error(ssp, get->interface, status, response, error,
 					max_error_len);
-			SET_MSG_RESULT(&results[j], zbx_strdup(NULL, error));
+			SET_MSG_RESULT(&get->results[j], zbx_strdup(NULL, error));
 			*error = '\0';
 		}
 
-		if (1 < mapping_num)
+		if (1 < get->mapping_num)
 		{
-			if (NULL != (pdu = snmp_fix_pdu(response, SNMP_MSG_GET)))
+			if (NULL != (*pdu = snmp_fix_pdu(response, SNMP_MSG_GET)))
 			{
-				memmove(mapping + i, mapping + i + 1, sizeof(int) * (mapping_num - i - 1));
-				mapping_num--;
+				memmove(get->mapping + i, get->mapping + i + 1,
+						sizeof(int) * (size_t)(get->mapping_num - i - 1));
+				get->mapping_num--;
 
-				snmp_free_pdu(response);
-				goto retry;
-			}
-			else
-			{
-				zbx_strlcpy(error, "snmp_fix_pdu(): cannot fix PDU object.", max_error_len);
-				ret = NOTSUPPORTED;
+				return ZBX_SNMP_GET_RETRY;
 			}
+
+			zbx_strlcpy(error, "snmp_fix_pdu(): cannot fix PDU object.", max_error_len);
+			*ret = NOTSUPPORTED;
 		}
 	}
-	else if (1 < mapping_num &&
+	else if (1 < get->mapping_num &&
 			((STAT_SUCCESS == status && SNMP_ERR_TOOBIG == response->errstat) || STAT_TIMEOUT == status ||
 			(STAT_ERROR == status && SNMPERR_TOO_LONG == ss->s_snmp_errno)))
 	{
@@ -1592,53 +1647,107 @@ retry:
 		/* The explanation above is for the first two conditions. The third condition comes from SNMPv3, */
 		/* where the size of the request that we are trying to send exceeds device's "msgMaxSize" limit. */
 halve:
-		if (*min_fail > mapping_num)
-			*min_fail = mapping_num;
+		if (*min_fail > get->mapping_num)
+			*min_fail = get->mapping_num;
 
-		if (0 == level)
-		{
-			/* halve the number of items */
+		if (2 > level)
+			return ZBX_SNMP_GET_HALVE;
+	}
+	else
+	{
+		if (1 <= level)
+			goto halve;
 
-			int	base;
+		*ret = zbx_get_snmp_response_error(ssp, get->interface, status, response, error, max_error_len);
+	}
 
-			ret = zbx_snmp_get_values(ssp, items, oids, results, errcodes, query_and_ignore_type, num / 2,
-					level + 1, error, max_error_len, max_succeed, min_fail, poller_type);
+	return ZBX_SNMP_GET_DONE;
+}
 
-			if (SUCCEED != ret)
-				goto exit;
+static int	zbx_snmp_get_values(zbx_snmp_sess_t ssp, const zbx_dc_item_t *items,
+		char oids[][ZBX_ITEM_SNMP_OID_LEN_MAX], AGENT_RESULT *results, int *errcodes,
+		unsigned char *query_and_ignore_type, int num, int level, char *error, size_t max_error_len,
+		int *max_succeed, int *min_fail, unsigned char poller_type)
+{
+	int			i, status, ret;
+	oid			parsed_oids[ZBX_MAX_SNMP_ITEMS][MAX_OID_LEN];
+	size_t			parsed_oid_lens[ZBX_MAX_SNMP_ITEMS];
+	struct snmp_pdu		*pdu, *response;
+	struct snmp_session	*ss;
+	zbx_snmp_get_t		get;
 
-			base = num / 2;
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() num:%d level:%d", __func__, num, level);
 
-			ret = zbx_snmp_get_values(ssp, items + base, oids + base, results + base, errcodes + base,
-					NULL == query_and_ignore_type ? NULL : query_and_ignore_type + base, num - base,
-					level + 1, error, max_error_len, max_succeed, min_fail, poller_type);
-		}
-		else if (1 == level)
-		{
-			/* resort to querying items one by one */
+	get.host = items[0].host.host;
+	get.interface = &items[0].interface;
+	get.oids = oids;
+	get.results = results;
+	get.errcodes = errcodes;
+	get.query_and_ignore_type = query_and_ignore_type;
+	get.num = num;
+	get.parsed_oids = parsed_oids;
+	get.parsed_oid_lens = parsed_oid_lens;
+
+	if (SUCCEED != (ret = zbx_snmp_get_prepare(&get, &pdu, error, max_error_len)) || NULL == pdu)
+		goto out;
+
+	ss = snmp_sess_session(ssp);
+	ss->retries = (1 == get.mapping_num && 0 == level && ZBX_POLLER_TYPE_UNREACHABLE != poller_type ? 1 : 0);
+retry:
+	status = snmp_sess_synch_response(ssp, pdu, &response);
 
-			for (i = 0; i < num; i++)
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() snmp_sess_synch_response() status:%d s_snmp_errno:%d errstat:%ld mapping_num:%d",
+			__func__, status, ss->s_snmp_errno, NULL == response ? (long)-1 : response->errstat,
+			get.mapping_num);
+
+	switch (zbx_snmp_get_process_response(ssp, &get, status, response, level, &pdu, error, max_error_len,
+			max_succeed, min_fail, &ret))
+	{
+		case ZBX_SNMP_GET_RETRY:
+			snmp_free_pdu(response);
+			goto retry;
+		case ZBX_SNMP_GET_HALVE:
+			if (0 == level)
 			{
-				if (SUCCEED != errcodes[i])
-					continue;
+				/* halve the number of items */
 
-				ret = zbx_snmp_get_values(ssp, items + i, oids + i, results + i, errcodes + i,
-						NULL == query_and_ignore_type ? NULL : query_and_ignore_type + i, 1,
-						level + 1, error, max_error_len, max_succeed, min_fail, poller_type);
+				int	base;
+
+				ret = zbx_snmp_get_values(ssp, items, oids, results, errcodes, query_and_ignore_type,
+						num / 2, level + 1, error, max_error_len, max_succeed, min_fail,
+						poller_type);
 
 				if (SUCCEED != ret)
-					goto exit;
+					break;
+
+				base = num / 2;
+
+				ret = zbx_snmp_get_values(ssp, items + base, oids + base, results + base,
+						errcodes + base, NULL == query_and_ignore_type ? NULL :
+						query_and_ignore_type + base, num - base, level + 1, error,
+						max_error_len, max_succeed, min_fail, poller_type);
 			}
-		}
-	}
-	else
-	{
-		if (1 <= level)
-			goto halve;
+			else
+			{
+				/* resort to querying items one by one */
+
+				for (i = 0; i < num; i++)
+				{
+					if (SUCCEED != errcodes[i])
+						continue;
+
+					ret = zbx_snmp_get_values(ssp, items + i, oids + i, results + i, errcodes + i,
+							NULL == query_and_ignore_type ? NULL : query_and_ignore_type + i,
+							1, level + 1, error, max_error_len, max_succeed, min_fail,
+							poller_type);
 
-		ret = zbx_get_snmp_response_error(ssp, &items[0].interface, status, response, error, max_error_len);
+					if (SUCCEED != ret)
+						break;
+				}
+			}
+			break;
 	}
-exit:
+
 	if (NULL != response)
 		snmp_free_pdu(response);
 out:
@@ -2034,114 +2143,334 @@ static int	snmp_bulkwalk_parse_params(AGENT_REQUEST *request, zbx_vector_snmp_oi
 	return SUCCEED;
 }
 
-static int	snmp_bulkwalk(zbx_snmp_sess_t ssp, int pdu_type, const zbx_dc_item_t *item, zbx_snmp_oid_t *p_oid,
-		char **results, size_t *results_alloc, size_t *results_offset, char *error, size_t max_error_len)
+#define ZBX_SNMP_WALK_MAX_PENDING	8	/* maximum number of subtree requests in flight per session */
+
+#define ZBX_SNMP_WALK_SEND	0	/* the next request of subtree walk must be sent */
+#define ZBX_SNMP_WALK_PENDING	1	/* waiting for response */
+#define ZBX_SNMP_WALK_DONE	2	/* the subtree walk is finished */
+
+typedef struct zbx_snmp_bulkwalk_ctx	zbx_snmp_bulkwalk_ctx_t;
+
+/* walk of one OID subtree of walk[] item */
+typedef struct
 {
-	struct snmp_pdu		*pdu, *response = NULL;
-	int			ret, running = 1, vars_num = 0, status;
-	oid			name[MAX_OID_LEN];
-	size_t			name_length = MAX_OID_LEN;
+	const zbx_snmp_oid_t	*root;
+	oid			name[MAX_OID_LEN];	/* the last received OID to continue the walk from */
+	size_t			name_length;
+	int			pdu_type;
+	int			max_repetitions;	/* adapted to response size and timeouts */
+	int			max_repetitions_limit;	/* the largest max repetitions without too big response */
+	int			vars_num;
+	int			responses_num;
+	unsigned char		state;
+	char			*results;
+	size_t			results_alloc;
+	size_t			results_offset;
+	zbx_snmp_bulkwalk_ctx_t	*ctx;
+}
+zbx_snmp_bulkwalk_t;
+
+/* concurrent walks of walk[] item subtrees over one session */
+struct zbx_snmp_bulkwalk_ctx
+{
+	zbx_snmp_sess_t		ssp;
+	const zbx_dc_item_t	*item;
+	int			pending_num;
+	int			ret;
+	char			*error;
+	size_t			max_error_len;
+};
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add received variables to subtree walk results and decide how to  *
+ *          continue the walk                                                 *
+ *                                                                            *
+ * Parameters: walk     - [IN/OUT] the subtree walk                           *
+ *             status   - [IN] the request status                             *
+ *             response - [IN] the response, NULL if not received             *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_bulkwalk_process_response(zbx_snmp_bulkwalk_t *walk, int status, const struct snmp_pdu *response)
+{
+	zbx_snmp_bulkwalk_ctx_t	*ctx = walk->ctx;
 	struct variable_list	*var;
+	int			running = 1, vars_received = 0;
 
-	memcpy(name, p_oid->root_oid, p_oid->root_oid_len * sizeof(oid));
-	name_length = p_oid->root_oid_len;
+	ctx->pending_num--;
+	walk->state = ZBX_SNMP_WALK_SEND;
 
-	while (running)
+	/* other walk has failed, waiting for the remaining responses before the session is closed */
+	if (SUCCEED != ctx->ret)
 	{
-		/* create PDU */
-		if (NULL == (pdu = snmp_pdu_create(pdu_type)))
+		walk->state = ZBX_SNMP_WALK_DONE;
+		return;
+	}
+
+	/* fewer repetitions make smaller responses, which are less likely to be lost or refused by agent, */
+	/* timeouts are retried this way only if the agent has already responded                           */
+	if (SNMP_MSG_GETBULK == walk->pdu_type && 1 < walk->max_repetitions && ((STAT_TIMEOUT == status &&
+			0 != walk->responses_num) || (STAT_SUCCESS == status && SNMP_ERR_TOOBIG == response->errstat)))
+	{
+		walk->max_repetitions /= 2;
+
+		/* response size does not change, unlike timeouts that can be temporary */
+		if (STAT_SUCCESS == status)
+			walk->max_repetitions_limit = walk->max_repetitions;
+
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() host:'%s' oid:'%s' %s, reducing max repetitions to %d", __func__,
+				ctx->item->host.host, walk->root->str_oid, STAT_TIMEOUT == status ? "timeout" :
+				"response too big", walk->max_repetitions);
+		return;
+	}
+
+	if (STAT_SUCCESS != status || SNMP_ERR_NOERROR != response->errstat)
+	{
+		ctx->ret = zbx_get_snmp_response_error(ctx->ssp, &ctx->item->interface, status, response, ctx->error,
+				ctx->max_error_len);
+		walk->state = ZBX_SNMP_WALK_DONE;
+		return;
+	}
+
+	walk->responses_num++;
+
+	if (NULL == response->variables)
+		running = 0;
+
+	for (var = response->variables; NULL != var; var = var->next_variable)
+	{
+		if (var->name_length < walk->root->root_oid_len ||
+				0 != memcmp(walk->root->root_oid, var->name, walk->root->root_oid_len * sizeof(oid)))
 		{
-			zbx_strlcpy(error, "snmp_pdu_create(): cannot create PDU object.", max_error_len);
-			ret = CONFIG_ERROR;
-			goto out;
+			running = 0;
+			break;
 		}
 
-		if (SNMP_MSG_GETBULK == pdu_type)
+		if (SNMP_ENDOFMIBVIEW != var->type && SNMP_NOSUCHOBJECT != var->type &&
+				SNMP_NOSUCHINSTANCE != var->type)
 		{
-			pdu->non_repeaters = 0;
-			pdu->max_repetitions = item->snmp_max_repetitions;
-		}
+			char	buffer[MAX_STRING_LEN];
+
+			walk->vars_num++;
+			vars_received++;
+
+			if (SNMP_MSG_GET != walk->pdu_type)
+			{
+				if (0 <= snmp_oid_compare(walk->name, walk->name_length, var->name, var->name_length))
+				{
+					running = 0;
+					break;
+				}
+			}
+			else
+				running = 0;
+
+			snprint_variable(buffer, sizeof(buffer), var->name, var->name_length, var);
+
+			if (NULL != walk->results)
+				zbx_chrcpy_alloc(&walk->results, &walk->results_alloc, &walk->results_offset, '\n');
+
+			zbx_strcpy_alloc(&walk->results, &walk->results_alloc, &walk->results_offset, buffer);
 
-		if (NULL == snmp_add_null_var(pdu, name, name_length))
+			if (NULL == var->next_variable)
+			{
+				memcpy(walk->name, var->name, var->name_length * sizeof(oid));
+				walk->name_length = var->name_length;
+			}
+		}
+		else
 		{
-			zbx_strlcpy(error, "snmp_add_null_var(): cannot add null variable.", max_error_len);
-			ret = CONFIG_ERROR;
-			snmp_free_pdu(pdu);
-			goto out;
+			running = 0;
+			break;
 		}
+	}
 
-		status = snmp_sess_synch_response(ssp, pdu, &response);
-		if (STAT_SUCCESS != status || SNMP_ERR_NOERROR != response->errstat)
+	if (0 != running)
+	{
+		/* restore repetitions reduced after timeout once full responses are received again */
+		if (SNMP_MSG_GETBULK == walk->pdu_type && vars_received == walk->max_repetitions &&
+				walk->max_repetitions < walk->max_repetitions_limit)
 		{
-			ret = zbx_get_snmp_response_error(ssp, &item->interface, status, response,
-					error, max_error_len);
-			goto out;
+			walk->max_repetitions = MIN(walk->max_repetitions * 2, walk->max_repetitions_limit);
 		}
 
-		if (SNMP_ERR_NOSUCHNAME == response->errstat)
-			break;
+		return;
+	}
+
+	/* the root OID can be a leaf, which is not returned by walk */
+	if (0 == walk->vars_num && SNMP_MSG_GETBULK == walk->pdu_type)
+	{
+		walk->pdu_type = SNMP_MSG_GET;
+		memcpy(walk->name, walk->root->root_oid, walk->root->root_oid_len * sizeof(oid));
+		walk->name_length = walk->root->root_oid_len;
+		return;
+	}
+
+	walk->state = ZBX_SNMP_WALK_DONE;
+}
 
-		for (var = response->variables; NULL != var; var = var->next_variable)
+static int	snmp_bulkwalk_response_cb(int operation, struct snmp_session *sp, int reqid, struct snmp_pdu *pdu,
+		void *magic)
+{
+	int	status;
+
+	ZBX_UNUSED(reqid);
+
+	if (NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE == operation && SNMP_MSG_REPORT != pdu->command)
+	{
+		status = STAT_SUCCESS;
+	}
+	else
+	{
+		if (NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE == operation)
 		{
-			if (var->name_length < p_oid->root_oid_len ||
-					0 != memcmp(p_oid->root_oid, var->name, p_oid->root_oid_len * sizeof(oid)))
-			{
-				running = 0;
-				break;
-			}
+			sp->s_snmp_errno = snmpv3_get_report_type(pdu);
+			status = STAT_ERROR;
+		}
+		else if (NETSNMP_CALLBACK_OP_TIMED_OUT == operation)
+		{
+			status = STAT_TIMEOUT;
+		}
+		else
+			status = STAT_ERROR;
 
-			if (SNMP_ENDOFMIBVIEW != var->type && SNMP_NOSUCHOBJECT != var->type &&
-					SNMP_NOSUCHINSTANCE != var->type)
-			{
-				char	buffer[MAX_STRING_LEN];
-				vars_num++;
+		pdu = NULL;
+	}
 
-				if (SNMP_MSG_GET != pdu_type)
-				{
-					if (0 <= snmp_oid_compare(name, name_length, var->name, var->name_length))
-					{
-						running = 0;
-						break;
-					}
-				}
-				else
-					running = 0;
+	/* the response is freed by Net-SNMP library after callback returns */
+	snmp_bulkwalk_process_response((zbx_snmp_bulkwalk_t *)magic, status, pdu);
+
+	return 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send the next request of subtree walk                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_bulkwalk_send(zbx_snmp_bulkwalk_t *walk)
+{
+	zbx_snmp_bulkwalk_ctx_t	*ctx = walk->ctx;
+	struct snmp_pdu		*pdu;
 
-				snprint_variable(buffer, sizeof(buffer), var->name, var->name_length, var);
+	if (NULL == (pdu = snmp_pdu_create(walk->pdu_type)))
+	{
+		zbx_strlcpy(ctx->error, "snmp_pdu_create(): cannot create PDU object.", ctx->max_error_len);
+		ctx->ret = CONFIG_ERROR;
+		return FAIL;
+	}
 
-				if (NULL != *results)
-					zbx_chrcpy_alloc(results, results_alloc, results_offset, '\n');
+	if (SNMP_MSG_GETBULK == walk->pdu_type)
+	{
+		pdu->non_repeaters = 0;
+		pdu->max_repetitions = walk->max_repetitions;
+	}
 
-				zbx_strcpy_alloc(results, results_alloc, results_offset, buffer);
+	if (NULL == snmp_add_null_var(pdu, walk->name, walk->name_length))
+	{
+		zbx_strlcpy(ctx->error, "snmp_add_null_var(): cannot add null variable.", ctx->max_error_len);
+		ctx->ret = CONFIG_ERROR;
+		snmp_free_pdu(pdu);
+		return FAIL;
+	}
 
-				if (NULL == var->next_variable)
-				{
-					memcpy(name, var->name, var->name_length * sizeof(oid));
-					name_length = var->name_length;
-				}
-			}
-			else
-			{
-				running = 0;
-				break;
-			}
+	if (0 == snmp_sess_async_send(ctx->ssp, pdu, snmp_bulkwalk_response_cb, walk))
+	{
+		snmp_free_pdu(pdu);
+		ctx->ret = zbx_get_snmp_response_error(ctx->ssp, &ctx->item->interface, STAT_ERROR, NULL, ctx->error,
+				ctx->max_error_len);
+		return FAIL;
+	}
+
+	walk->state = ZBX_SNMP_WALK_PENDING;
+	ctx->pending_num++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: walk OID subtrees concurrently with several requests in flight    *
+ *                                                                            *
+ * Parameters: ssp           - [IN] the SNMP session                          *
+ *             item          - [IN] the walk[] item                           *
+ *             walks         - [IN/OUT] the subtree walks                     *
+ *             walks_num     - [IN] the number of subtree walks               *
+ *             error         - [OUT] the error message                        *
+ *             max_error_len - [IN] the error message buffer size             *
+ *                                                                            *
+ * Return value: SUCCEED - all subtrees were walked                           *
+ *               NOTSUPPORTED, NETWORK_ERROR, CONFIG_ERROR - otherwise        *
+ *                                                                            *
+ * Comments: The next request of a subtree depends on the last OID received,  *
+ *           so each subtree has at most one request in flight, while up to   *
+ *           ZBX_SNMP_WALK_MAX_PENDING subtrees are walked at the same time.  *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_bulkwalk_run(zbx_snmp_sess_t ssp, const zbx_dc_item_t *item, zbx_snmp_bulkwalk_t *walks,
+		int walks_num, char *error, size_t max_error_len)
+{
+	zbx_snmp_bulkwalk_ctx_t	ctx;
+	int			i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() walks_num:%d", __func__, walks_num);
+
+	ctx.ssp = ssp;
+	ctx.item = item;
+	ctx.pending_num = 0;
+	ctx.ret = SUCCEED;
+	ctx.error = error;
+	ctx.max_error_len = max_error_len;
+
+	for (i = 0; i < walks_num; i++)
+		walks[i].ctx = &ctx;
+
+	while (1)
+	{
+		int			numfds = 0, block = 1, rc;
+		struct timeval		tv = {0, 0};
+		netsnmp_large_fd_set	fdset;
+
+		/* requests are sent outside of response callback, while session is not being processed */
+		for (i = 0; i < walks_num && SUCCEED == ctx.ret && ZBX_SNMP_WALK_MAX_PENDING > ctx.pending_num; i++)
+		{
+			if (ZBX_SNMP_WALK_SEND == walks[i].state)
+				(void)snmp_bulkwalk_send(&walks[i]);
 		}
 
-		if (NULL != response)
+		if (0 == ctx.pending_num)
+			break;
+
+		netsnmp_large_fd_set_init(&fdset, FD_SETSIZE);
+		(void)snmp_sess_select_info2(ssp, &numfds, &fdset, &tv, &block);
+
+		if (0 < (rc = netsnmp_large_fd_set_select(numfds, &fdset, NULL, NULL, 0 == block ? &tv : NULL)))
+			(void)snmp_sess_read2(ssp, &fdset);
+		else if (0 == rc)
+			snmp_sess_timeout(ssp);
+		else if (EINTR != errno)
 		{
-			snmp_free_pdu(response);
-			response = NULL;
+			if (SUCCEED == ctx.ret)
+			{
+				zbx_snprintf(error, max_error_len, "Cannot wait for SNMP response: %s",
+						zbx_strerror(errno));
+				ctx.ret = NETWORK_ERROR;
+			}
+
+			/* pending requests must still be completed before the session is closed */
+			snmp_sess_timeout(ssp);
 		}
+
+		netsnmp_large_fd_set_cleanup(&fdset);
 	}
 
-	ret = vars_num;
-out:
-	if (NULL != response)
-		snmp_free_pdu(response);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ctx.ret));
 
-	return ret;
+	return ctx.ret;
 }
 
+#undef ZBX_SNMP_WALK_MAX_PENDING
+
 static int	zbx_snmp_process_snmp_bulkwalk(zbx_snmp_sess_t ssp, const zbx_dc_item_t *item, AGENT_RESULT *result,
 		int *errcode, char *error, size_t max_error_len)
 {
@@ -2151,6 +2480,7 @@ static int	zbx_snmp_process_snmp_bulkwalk(zbx_snmp_sess_t ssp, const zbx_dc_item
 	size_t			results_alloc = 0, results_offset = 0;
 	zbx_snmp_format_opts_t	default_opts, bulk_opts;
 	zbx_vector_snmp_oid_t	param_oids;
+	zbx_snmp_bulkwalk_t	*walks = NULL;
 
 	zbx_init_agent_request(&request);
 
@@ -2194,22 +2524,34 @@ static int	zbx_snmp_process_snmp_bulkwalk(zbx_snmp_sess_t ssp, const zbx_dc_item
 		goto out;
 	}
 
+	walks = (zbx_snmp_bulkwalk_t *)zbx_calloc(NULL, (size_t)param_oids.values_num, sizeof(zbx_snmp_bulkwalk_t));
+
 	for (i = 0; i < param_oids.values_num; i++)
 	{
-		if (SUCCEED > (ret = snmp_bulkwalk(ssp, pdu_type, item, param_oids.values[i], &results, &results_alloc,
-				&results_offset, error, max_error_len)))
-		{
-			goto out;
-		}
+		zbx_snmp_bulkwalk_t	*walk = &walks[i];
 
-		if (0 == ret && SNMP_MSG_GETBULK == pdu_type)
-		{
-			if (SUCCEED > (ret = snmp_bulkwalk(ssp, SNMP_MSG_GET, item, param_oids.values[i], &results,
-					&results_alloc, &results_offset, error, max_error_len)))
-			{
-				goto out;
-			}
-		}
+		walk->root = param_oids.values[i];
+		memcpy(walk->name, walk->root->root_oid, walk->root->root_oid_len * sizeof(oid));
+		walk->name_length = walk->root->root_oid_len;
+		walk->pdu_type = pdu_type;
+		walk->max_repetitions = item->snmp_max_repetitions;
+		walk->max_repetitions_limit = item->snmp_max_repetitions;
+		walk->state = ZBX_SNMP_WALK_SEND;
+	}
+
+	if (SUCCEED != (ret = snmp_bulkwalk_run(ssp, item, walks, param_oids.values_num, error, max_error_len)))
+		goto out;
+
+	/* results are joined in the order of OIDs */
+	for (i = 0; i < param_oids.values_num; i++)
+	{
+		if (NULL == walks[i].results)
+			continue;
+
+		if (NULL != results)
+			zbx_chrcpy_alloc(&results, &results_alloc, &results_offset, '\n');
+
+		zbx_strcpy_alloc(&results, &results_alloc, &results_offset, walks[i].results);
 	}
 
 	SET_TEXT_RESULT(result, NULL != results ? results : zbx_strdup(NULL, ""));
@@ -2217,6 +2559,14 @@ static int	zbx_snmp_process_snmp_bulkwalk(zbx_snmp_sess_t ssp, const zbx_dc_item
 out:
 	zbx_free_agent_request(&request);
 
+	if (NULL != walks)
+	{
+		for (i = 0; i < param_oids.values_num; i++)
+			zbx_free(walks[i].results);
+
+		zbx_free(walks);
+	}
+
 	if (SUCCEED != (*errcode = ret))
 	{
 		zbx_free(results);
@@ -2230,6 +2580,10 @@ out:
 	return ret;
 }
 
+#undef ZBX_SNMP_WALK_SEND
+#undef ZBX_SNMP_WALK_PENDING
+#undef ZBX_SNMP_WALK_DONE
+
 static int	zbx_snmp_process_dynamic(zbx_snmp_sess_t ssp, const zbx_dc_item_t *items, AGENT_RESULT *results,
 		int *errcodes, int num, char *error, size_t max_error_len, int *max_succeed, int *min_fail, int bulk,
 		unsigned char poller_type)
@@ -2632,6 +2986,440 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/* range of items to request asynchronously, see zbx_snmp_get_process_response() for splitting levels */
+typedef struct
+{
+	int	offset;
+	int	num;
+	int	level;
+}
+zbx_async_snmp_range_t;
+
+/* asynchronous SNMP check of items sharing the same interface */
+typedef struct
+{
+	struct event			*read_event;
+	struct event			*timer;
+	zbx_snmp_sess_t			ssp;
+	char				*host;
+	zbx_dc_interface_t		interface;
+
+	char				(*oids)[ZBX_ITEM_SNMP_OID_LEN_MAX];
+	oid				(*parsed_oids)[MAX_OID_LEN];
+	size_t				*parsed_oid_lens;
+	AGENT_RESULT			*results;
+	int				*errcodes;
+	int				num;
+
+	/* the request in progress */
+	zbx_snmp_get_t			get;
+	int				offset;
+	int				level;
+	int				pending;
+	struct snmp_pdu			*pdu;		/* fixed request PDU to send again */
+
+	/* item ranges waiting to be requested, used as a stack */
+	zbx_async_snmp_range_t		*ranges;
+	int				ranges_num;
+
+	int				max_succeed;
+	int				min_fail;
+	int				ret;
+	char				error[MAX_STRING_LEN];
+
+	zbx_async_snmp_done_cb_t	done_cb;
+	void				*arg;
+}
+zbx_async_snmp_t;
+
+static void	async_snmp_push_range(zbx_async_snmp_t *ctx, int offset, int num, int level)
+{
+	zbx_async_snmp_range_t	*range = &ctx->ranges[ctx->ranges_num++];
+
+	range->offset = offset;
+	range->num = num;
+	range->level = level;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: set error for the remaining items, update interface SNMP bulk     *
+ *          statistics, free the check and notify the caller                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_snmp_finish(zbx_async_snmp_t *ctx)
+{
+	zbx_async_snmp_done_cb_t	done_cb = ctx->done_cb;
+	void				*arg = ctx->arg;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' ret:%s", __func__, ctx->host, zbx_result_string(ctx->ret));
+
+	if (SUCCEED != ctx->ret)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "getting SNMP values failed: %s", ctx->error);
+
+		for (int i = 0; i < ctx->num; i++)
+		{
+			if (SUCCEED != ctx->errcodes[i])
+				continue;
+
+			SET_MSG_RESULT(&ctx->results[i], zbx_strdup(NULL, ctx->error));
+			ctx->errcodes[i] = ctx->ret;
+		}
+	}
+	else if (0 != ctx->max_succeed || ZBX_MAX_SNMP_ITEMS + 1 != ctx->min_fail)
+	{
+		zbx_dc_config_update_interface_snmp_stats(ctx->interface.interfaceid, ctx->max_succeed, ctx->min_fail);
+	}
+
+	if (NULL != ctx->timer)
+		event_free(ctx->timer);
+
+	if (NULL != ctx->read_event)
+		event_free(ctx->read_event);
+
+	if (NULL != ctx->pdu)
+		snmp_free_pdu(ctx->pdu);
+
+	if (NULL != ctx->ssp)
+		zbx_snmp_close_session(ctx->ssp);
+
+	zbx_free(ctx->ranges);
+	zbx_free(ctx->parsed_oid_lens);
+	zbx_free(ctx->parsed_oids);
+	zbx_free(ctx->oids);
+	zbx_free(ctx->host);
+	zbx_free(ctx);
+
+	done_cb(arg);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: schedule the session timer to the next request retransmission or  *
+ *          timeout                                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_snmp_update_timer(zbx_async_snmp_t *ctx)
+{
+	int			numfds = 0, block = 1;
+	struct timeval		tv = {0, 0};
+	netsnmp_large_fd_set	fdset;
+
+	netsnmp_large_fd_set_init(&fdset, FD_SETSIZE);
+	(void)snmp_sess_select_info2(ctx->ssp, &numfds, &fdset, &tv, &block);
+	netsnmp_large_fd_set_cleanup(&fdset);
+
+	if (0 == block)
+		evtimer_add(ctx->timer, &tv);
+	else
+		evtimer_del(ctx->timer);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process response of the request in progress                       *
+ *                                                                            *
+ * Comments: The response PDU is owned by Net-SNMP library and is freed after *
+ *           the response callback returns, so it must be processed here.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_snmp_process_response(zbx_async_snmp_t *ctx, int status, struct snmp_pdu *response)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() host:'%s' status:%d s_snmp_errno:%d errstat:%ld mapping_num:%d", __func__,
+			ctx->host, status, snmp_sess_session(ctx->ssp)->s_snmp_errno,
+			NULL == response ? (long)-1 : response->errstat, ctx->get.mapping_num);
+
+	if (ZBX_SNMP_GET_HALVE != zbx_snmp_get_process_response(ctx->ssp, &ctx->get, status, response, ctx->level,
+			&ctx->pdu, ctx->error, sizeof(ctx->error), &ctx->max_succeed, &ctx->min_fail, &ctx->ret))
+	{
+		return;
+	}
+
+	/* push the ranges in reverse order, so they are requested in the item order */
+	if (0 == ctx->level)
+	{
+		int	base = ctx->get.num / 2;
+
+		async_snmp_push_range(ctx, ctx->offset + base, ctx->get.num - base, 1);
+		async_snmp_push_range(ctx, ctx->offset, base, 1);
+	}
+	else
+	{
+		for (int i = ctx->get.num - 1; 0 <= i; i--)
+			async_snmp_push_range(ctx, ctx->offset + i, 1, 2);
+	}
+}
+
+static int	async_snmp_response_cb(int operation, struct snmp_session *sp, int reqid, struct snmp_pdu *pdu,
+		void *magic)
+{
+	zbx_async_snmp_t	*ctx = (zbx_async_snmp_t *)magic;
+	int			status;
+
+	ZBX_UNUSED(reqid);
+
+	ctx->pending = 0;
+
+	if (NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE == operation && SNMP_MSG_REPORT != pdu->command)
+	{
+		status = STAT_SUCCESS;
+	}
+	else
+	{
+		if (NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE == operation)
+		{
+			sp->s_snmp_errno = snmpv3_get_report_type(pdu);
+			status = STAT_ERROR;
+		}
+		else if (NETSNMP_CALLBACK_OP_TIMED_OUT == operation)
+		{
+			status = STAT_TIMEOUT;
+		}
+		else
+			status = STAT_ERROR;
+
+		pdu = NULL;
+	}
+
+	async_snmp_process_response(ctx, status, pdu);
+
+	return 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send the next request, finish the check when there is nothing     *
+ *          more to request or the check has failed                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_snmp_send_next(zbx_async_snmp_t *ctx)
+{
+	struct snmp_session	*ss = snmp_sess_session(ctx->ssp);
+
+	while (SUCCEED == ctx->ret)
+	{
+		struct snmp_pdu	*pdu;
+
+		if (NULL != ctx->pdu)
+		{
+			pdu = ctx->pdu;
+			ctx->pdu = NULL;
+		}
+		else
+		{
+			zbx_async_snmp_range_t	range;
+
+			if (0 == ctx->ranges_num)
+				break;
+
+			range = ctx->ranges[--ctx->ranges_num];
+
+			ctx->offset = range.offset;
+			ctx->level = range.level;
+			ctx->get.oids = ctx->oids + range.offset;
+			ctx->get.results = ctx->results + range.offset;
+			ctx->get.errcodes = ctx->errcodes + range.offset;
+			ctx->get.parsed_oids = ctx->parsed_oids + range.offset;
+			ctx->get.parsed_oid_lens = ctx->parsed_oid_lens + range.offset;
+			ctx->get.num = range.num;
+
+			if (SUCCEED != (ctx->ret = zbx_snmp_get_prepare(&ctx->get, &pdu, ctx->error,
+					sizeof(ctx->error))))
+			{
+				break;
+			}
+
+			if (NULL == pdu)
+				continue;
+
+			/* retry single item requests unless the interface is already failing */
+			ss->retries = (1 == ctx->get.mapping_num && 0 == ctx->level && 0 == ctx->interface.errors_from ?
+					1 : 0);
+		}
+
+		if (0 == snmp_sess_async_send(ctx->ssp, pdu, async_snmp_response_cb, ctx))
+		{
+			snmp_free_pdu(pdu);
+			async_snmp_process_response(ctx, STAT_ERROR, NULL);
+			continue;
+		}
+
+		ctx->pending = 1;
+		async_snmp_update_timer(ctx);
+
+		return;
+	}
+
+	async_snmp_finish(ctx);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: continue the check after Net-SNMP library has processed session   *
+ *          events                                                            *
+ *                                                                            *
+ * Comments: Requests are not sent from the response callback, because the    *
+ *           session cannot be closed while the library is processing it.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	async_snmp_continue(zbx_async_snmp_t *ctx)
+{
+	if (0 == ctx->pending)
+		async_snmp_send_next(ctx);
+	else
+		async_snmp_update_timer(ctx);
+}
+
+static void	async_snmp_read_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_async_snmp_t	*ctx = (zbx_async_snmp_t *)arg;
+	netsnmp_large_fd_set	fdset;
+
+	ZBX_UNUSED(what);
+
+	netsnmp_large_fd_set_init(&fdset, fd + 1);
+	netsnmp_large_fd_setfd(fd, &fdset);
+	(void)snmp_sess_read2(ctx->ssp, &fdset);
+	netsnmp_large_fd_set_cleanup(&fdset);
+
+	async_snmp_continue(ctx);
+}
+
+static void	async_snmp_timer_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_async_snmp_t	*ctx = (zbx_async_snmp_t *)arg;
+
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(what);
+
+	/* retransmits the request or reports timeout through the response callback */
+	snmp_sess_timeout(ctx->ssp);
+
+	async_snmp_continue(ctx);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start asynchronous SNMP check of items sharing the same interface *
+ *                                                                            *
+ * Parameters: base             - [IN] the event base                         *
+ *             items            - [IN] the items to check                     *
+ *             results          - [OUT] the check results                     *
+ *             errcodes         - [IN/OUT] the result codes, only items with  *
+ *                                         SUCCEED code are checked           *
+ *             num              - [IN] the number of items                    *
+ *             config_timeout   - [IN] the request timeout                    *
+ *             config_source_ip - [IN] the source IP address                  *
+ *             done_cb          - [IN] the callback to call once the check is *
+ *                                     finished                               *
+ *             arg              - [IN] the callback argument                  *
+ *                                                                            *
+ * Return value: SUCCEED - the check was started, results and errcodes must   *
+ *                         be kept until done_cb is called                    *
+ *               FAIL    - the items cannot be checked asynchronously and     *
+ *                         must be left to normal pollers                     *
+ *                                                                            *
+ * Comments: The items are copied, so they can be freed once the function     *
+ *           returns. Walk, discovery and dynamic index items, SNMPv3 items   *
+ *           and interfaces with DNS name are not supported, because opening  *
+ *           their sessions or walking the OIDs would block the event loop.   *
+ *           Such items are normally routed to normal pollers by the          *
+ *           configuration cache. The done_cb can be called before this       *
+ *           function returns, for example, if all items are not supported.   *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_async_check_snmp(struct event_base *base, const zbx_dc_item_t *items, AGENT_RESULT *results,
+		int *errcodes, int num, int config_timeout, const char *config_source_ip,
+		zbx_async_snmp_done_cb_t done_cb, void *arg)
+{
+	zbx_async_snmp_t	*ctx;
+	int			i, j, ret = SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' addr:'%s' num:%d",
+			__func__, items[0].host.host, items[0].interface.addr, num);
+
+	for (j = 0; j < num; j++)	/* locate first supported item to use as a reference */
+	{
+		if (SUCCEED == errcodes[j])
+			break;
+	}
+
+	if (j == num)	/* all items already NOTSUPPORTED (with invalid key, port or SNMP parameters) */
+	{
+		done_cb(arg);
+		goto out;
+	}
+
+	if (0 != (ZBX_FLAG_DISCOVERY_RULE & items[j].flags) || NULL != strchr(items[j].snmp_oid, '[') ||
+			ZBX_IF_SNMP_VERSION_3 == items[j].snmp_version || 1 != items[j].interface.useip)
+	{
+		ret = FAIL;
+		goto out;
+	}
+
+	zbx_init_snmp();	/* avoid high CPU usage by only initializing SNMP once used */
+
+	ctx = (zbx_async_snmp_t *)zbx_malloc(NULL, sizeof(zbx_async_snmp_t));
+	memset(ctx, 0, sizeof(zbx_async_snmp_t));
+
+	ctx->host = zbx_strdup(NULL, items[j].host.host);
+	ctx->interface = items[j].interface;
+	ctx->interface.addr = (1 == ctx->interface.useip ? ctx->interface.ip_orig : ctx->interface.dns_orig);
+	ctx->oids = zbx_malloc(NULL, sizeof(*ctx->oids) * (size_t)num);
+	ctx->parsed_oids = zbx_malloc(NULL, sizeof(*ctx->parsed_oids) * (size_t)num);
+	ctx->parsed_oid_lens = (size_t *)zbx_malloc(NULL, sizeof(size_t) * (size_t)num);
+	ctx->ranges = (zbx_async_snmp_range_t *)zbx_malloc(NULL, sizeof(zbx_async_snmp_range_t) * (size_t)(num + 1));
+	ctx->results = results;
+	ctx->errcodes = errcodes;
+	ctx->num = num;
+	ctx->get.host = ctx->host;
+	ctx->get.interface = &ctx->interface;
+	ctx->max_succeed = 0;
+	ctx->min_fail = ZBX_MAX_SNMP_ITEMS + 1;
+	ctx->ret = SUCCEED;
+	ctx->done_cb = done_cb;
+	ctx->arg = arg;
+
+	for (i = j; i < num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		if (0 != zbx_num_key_param(items[i].snmp_oid))
+		{
+			SET_MSG_RESULT(&results[i], zbx_dsprintf(NULL, "OID \"%s\" contains unsupported parameters.",
+					items[i].snmp_oid));
+			errcodes[i] = CONFIG_ERROR;
+			continue;
+		}
+
+		zbx_snmp_translate(ctx->oids[i], items[i].snmp_oid, sizeof(ctx->oids[i]));
+	}
+
+	if (NULL == (ctx->ssp = zbx_snmp_open_session(&items[j], ctx->error, sizeof(ctx->error), config_timeout,
+			config_source_ip)))
+	{
+		ctx->ret = NETWORK_ERROR;
+		async_snmp_finish(ctx);
+		goto out;
+	}
+
+	ctx->read_event = event_new(base, snmp_sess_transport(ctx->ssp)->sock, EV_READ | EV_PERSIST,
+			async_snmp_read_cb, ctx);
+	event_add(ctx->read_event, NULL);
+	ctx->timer = evtimer_new(base, async_snmp_timer_cb, ctx);
+
+	async_snmp_push_range(ctx, j, num - j, 0);
+	async_snmp_send_next(ctx);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: clear snmpv3 user authentication cache                            *
@@ -32,6 +32,11 @@
 #define ZBX_SNMP_STR_ASCII	5
 #define ZBX_SNMP_STR_UNDEFINED	255
 
+struct event_base;
+
+/* called once all items of asynchronous SNMP check are processed */
+typedef void	(*zbx_async_snmp_done_cb_t)(void *arg);
+
 void	zbx_init_library_mt_snmp(void);
 void	zbx_shutdown_library_mt_snmp(void);
 int	get_value_snmp(const zbx_dc_item_t *item, AGENT_RESULT *result, unsigned char poller_type, int config_timeout,
@@ -39,6 +44,9 @@ int	get_value_snmp(const zbx_dc_item_t *item, AGENT_RESULT *result, unsigned cha
 void	get_values_snmp(const zbx_dc_item_t *items, AGENT_RESULT *results, int *errcodes, int num,
 		unsigned char poller_type, int config_timeout, const char *config_source_ip);
 void	zbx_clear_cache_snmp(unsigned char process_type, int process_num);
+int	zbx_async_check_snmp(struct event_base *base, const zbx_dc_item_t *items, AGENT_RESULT *results,
+		int *errcodes, int num, int config_timeout, const char *config_source_ip,
+		zbx_async_snmp_done_cb_t done_cb, void *arg);
 #endif
 
 #endif
@@ -160,46 +160,48 @@ static const char	*item_type_agent_string(zbx_item_type_t item_type)
  * Purpose: activate item interface                                             *
  *                                                                              *
  * Parameters: ts         - [IN] the timestamp                                  *
- *             item       - [IN/OUT] the item                                   *
+ *             interface  - [IN/OUT] the item interface                         *
+ *             itemid     - [IN] the item identifier                            *
+ *             item_type  - [IN] the item type                                  *
+ *             host       - [IN] the host name                                  *
  *             data       - [IN/OUT] the serialized availability data           *
  *             data_alloc - [IN/OUT] the serialized availability data size      *
  *             data_alloc - [IN/OUT] the serialized availability data offset    *
- *             ts         - [IN] the timestamp                                  *
  *                                                                              *
  *******************************************************************************/
-void	zbx_activate_item_interface(zbx_timespec_t *ts, zbx_dc_item_t *item,  unsigned char **data, size_t *data_alloc,
-		size_t *data_offset)
+void	zbx_activate_item_interface_ext(zbx_timespec_t *ts, zbx_dc_interface_t *interface, zbx_uint64_t itemid,
+		unsigned char item_type, const char *host, unsigned char **data, size_t *data_alloc, size_t *data_offset)
 {
 	zbx_interface_availability_t	in, out;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() interfaceid:" ZBX_FS_UI64 " itemid:" ZBX_FS_UI64 " type:%d",
-			__func__, item->interface.interfaceid, item->itemid, (int)item->type);
+			__func__, interface->interfaceid, itemid, (int)item_type);
 
-	zbx_interface_availability_init(&in, item->interface.interfaceid);
-	zbx_interface_availability_init(&out, item->interface.interfaceid);
+	zbx_interface_availability_init(&in, interface->interfaceid);
+	zbx_interface_availability_init(&out, interface->interfaceid);
 
-	if (FAIL == interface_availability_by_item_type(item->type, item->interface.type))
+	if (FAIL == interface_availability_by_item_type(item_type, interface->type))
 		goto out;
 
-	interface_get_availability(&item->interface, &in);
+	interface_get_availability(interface, &in);
 
-	if (FAIL == zbx_dc_interface_activate(item->interface.interfaceid, ts, &in.agent, &out.agent))
+	if (FAIL == zbx_dc_interface_activate(interface->interfaceid, ts, &in.agent, &out.agent))
 		goto out;
 
 	if (FAIL == update_interface_availability(data, data_alloc, data_offset, &out))
 		goto out;
 
-	interface_set_availability(&item->interface, &out);
+	interface_set_availability(interface, &out);
 
 	if (ZBX_INTERFACE_AVAILABLE_TRUE == in.agent.available)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "resuming %s checks on host \"%s\": connection restored",
-				item_type_agent_string(item->type), item->host.host);
+				item_type_agent_string(item_type), host);
 	}
 	else
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "enabling %s checks on host \"%s\": interface became available",
-				item_type_agent_string(item->type), item->host.host);
+				item_type_agent_string(item_type), host);
 	}
 out:
 	zbx_interface_availability_clean(&out);
@@ -208,40 +210,63 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/********************************************************************************
+ *                                                                              *
+ * Purpose: activate item interface                                             *
+ *                                                                              *
+ * Parameters: ts         - [IN] the timestamp                                  *
+ *             item       - [IN/OUT] the item                                   *
+ *             data       - [IN/OUT] the serialized availability data           *
+ *             data_alloc - [IN/OUT] the serialized availability data size      *
+ *             data_alloc - [IN/OUT] the serialized availability data offset    *
+ *             ts         - [IN] the timestamp                                  *
+ *                                                                              *
+ *******************************************************************************/
+void	zbx_activate_item_interface(zbx_timespec_t *ts, zbx_dc_item_t *item,  unsigned char **data, size_t *data_alloc,
+		size_t *data_offset)
+{
+	zbx_activate_item_interface_ext(ts, &item->interface, item->itemid, item->type, item->host.host, data,
+			data_alloc, data_offset);
+}
+
 /***********************************************************************************
  *                                                                                 *
  * Purpose: deactivate item interface                                              *
  *                                                                                 *
  * Parameters: ts                 - [IN] timestamp                                 *
- *             item               - [IN/OUT] item                                  *
+ *             interface          - [IN/OUT] item interface                        *
+ *             itemid             - [IN] item identifier                           *
+ *             item_type          - [IN] item type                                 *
+ *             host               - [IN] host name                                 *
+ *             key_orig           - [IN] item key                                  *
  *             data               - [IN/OUT] serialized availability data          *
  *             data_alloc         - [IN/OUT] serialized availability data size     *
  *             data_alloc         - [IN/OUT] serialized availability data offset   *
- *             ts                 - [IN] timestamp                                 *
  *             unavailable_delay  - [IN]                                           *
  *             unreachable_period - [IN]                                           *
  *             unreachable_delay  - [IN]                                           *
  *             error              - [IN/OUT]                                       *
  *                                                                                 *
  ***********************************************************************************/
-void	zbx_deactivate_item_interface(zbx_timespec_t *ts, zbx_dc_item_t *item, unsigned char **data, size_t *data_alloc,
-		size_t *data_offset, int unavailable_delay, int unreachable_period, int unreachable_delay,
-		const char *error)
+void	zbx_deactivate_item_interface_ext(zbx_timespec_t *ts, zbx_dc_interface_t *interface, zbx_uint64_t itemid,
+		unsigned char item_type, const char *host, const char *key_orig, unsigned char **data,
+		size_t *data_alloc, size_t *data_offset, int unavailable_delay, int unreachable_period,
+		int unreachable_delay, const char *error)
 {
 	zbx_interface_availability_t	in, out;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() interfaceid:" ZBX_FS_UI64 " itemid:" ZBX_FS_UI64 " type:%d",
-			__func__, item->interface.interfaceid, item->itemid, (int)item->type);
+			__func__, interface->interfaceid, itemid, (int)item_type);
 
-	zbx_interface_availability_init(&in, item->interface.interfaceid);
-	zbx_interface_availability_init(&out,item->interface.interfaceid);
+	zbx_interface_availability_init(&in, interface->interfaceid);
+	zbx_interface_availability_init(&out, interface->interfaceid);
 
-	if (FAIL == interface_availability_by_item_type(item->type, item->interface.type))
+	if (FAIL == interface_availability_by_item_type(item_type, interface->type))
 		goto out;
 
-	interface_get_availability(&item->interface, &in);
+	interface_get_availability(interface, &in);
 
-	if (FAIL == zbx_dc_interface_deactivate(item->interface.interfaceid, ts, unavailable_delay, unreachable_period,
+	if (FAIL == zbx_dc_interface_deactivate(interface->interfaceid, ts, unavailable_delay, unreachable_period,
 			unreachable_delay, &in.agent, &out.agent, error))
 	{
 		goto out;
@@ -250,13 +275,13 @@ void	zbx_deactivate_item_interface(zbx_timespec_t *ts, zbx_dc_item_t *item, unsi
 	if (FAIL == update_interface_availability(data, data_alloc, data_offset, &out))
 		goto out;
 
-	interface_set_availability(&item->interface, &out);
+	interface_set_availability(interface, &out);
 
 	if (0 == in.agent.errors_from)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "%s item \"%s\" on host \"%s\" failed:"
 				" first network error, wait for %d seconds",
-				item_type_agent_string(item->type), item->key_orig, item->host.host,
+				item_type_agent_string(item_type), key_orig, host,
 				out.agent.disable_until - ts->sec);
 	}
 	else if (ZBX_INTERFACE_AVAILABLE_FALSE != in.agent.available)
@@ -265,14 +290,14 @@ void	zbx_deactivate_item_interface(zbx_timespec_t *ts, zbx_dc_item_t *item, unsi
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "%s item \"%s\" on host \"%s\" failed:"
 					" another network error, wait for %d seconds",
-					item_type_agent_string(item->type), item->key_orig, item->host.host,
+					item_type_agent_string(item_type), key_orig, host,
 					out.agent.disable_until - ts->sec);
 		}
 		else
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "temporarily disabling %s checks on host \"%s\":"
 					" interface unavailable",
-					item_type_agent_string(item->type), item->host.host);
+					item_type_agent_string(item_type), host);
 		}
 	}
 
@@ -285,6 +310,31 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/***********************************************************************************
+ *                                                                                 *
+ * Purpose: deactivate item interface                                              *
+ *                                                                                 *
+ * Parameters: ts                 - [IN] timestamp                                 *
+ *             item               - [IN/OUT] item                                  *
+ *             data               - [IN/OUT] serialized availability data          *
+ *             data_alloc         - [IN/OUT] serialized availability data size     *
+ *             data_alloc         - [IN/OUT] serialized availability data offset   *
+ *             ts                 - [IN] timestamp                                 *
+ *             unavailable_delay  - [IN]                                           *
+ *             unreachable_period - [IN]                                           *
+ *             unreachable_delay  - [IN]                                           *
+ *             error              - [IN/OUT]                                       *
+ *                                                                                 *
+ ***********************************************************************************/
+void	zbx_deactivate_item_interface(zbx_timespec_t *ts, zbx_dc_item_t *item, unsigned char **data, size_t *data_alloc,
+		size_t *data_offset, int unavailable_delay, int unreachable_period, int unreachable_delay,
+		const char *error)
+{
+	zbx_deactivate_item_interface_ext(ts, &item->interface, item->itemid, item->type, item->host.host,
+			item->key_orig, data, data_alloc, data_offset, unavailable_delay, unreachable_period,
+			unreachable_delay, error);
+}
+
 void	zbx_free_agent_result_ptr(AGENT_RESULT *result)
 {
 	zbx_free_agent_result(result);
@@ -730,6 +780,11 @@ void	zbx_check_items(zbx_dc_item_t *items, int *errcodes, int num, AGENT_RESULT
 		get_values_java(ZBX_JAVA_GATEWAY_REQUEST_JMX, items, results, errcodes, num,
 				config_comms->config_timeout, config_comms->config_source_ip);
 	}
+	else if (ITEM_TYPE_ZABBIX == items[0].type && 1 < num)
+	{
+		get_values_agent(items, results, errcodes, num, config_comms->config_timeout,
+				config_comms->config_source_ip);
+	}
 	else if (1 == num)
 	{
 		if (SUCCEED == errcodes[0])
@@ -813,8 +868,8 @@ void	zbx_clean_items(zbx_dc_item_t *items, int num, AGENT_RESULT *results)
  *                                                                                 *
  * Return value: number of items processed                                         *
  *                                                                                 *
- * Comments: processes single item at a time except for Java, SNMP items,          *
- *           see zbx_dc_config_get_poller_items()                                  *
+ * Comments: processes single item at a time except for Java, SNMP and agent      *
+ *           items, see zbx_dc_config_get_poller_items()                           *
  *                                                                                 *
  **********************************************************************************/
 static int	get_values(unsigned char poller_type, int *nextcheck, const zbx_config_comms_args_t *config_comms,
@@ -33,13 +33,20 @@ typedef struct
 	int			config_unavailable_delay;
 	int			config_unreachable_period;
 	int			config_unreachable_delay;
+	int			config_max_concurrent_checks_per_poller;
 }
 zbx_thread_poller_args;
 
 ZBX_THREAD_ENTRY(poller_thread, args);
 
+void	zbx_activate_item_interface_ext(zbx_timespec_t *ts, zbx_dc_interface_t *interface, zbx_uint64_t itemid,
+		unsigned char item_type, const char *host, unsigned char **data, size_t *data_alloc, size_t *data_offset);
 void	zbx_activate_item_interface(zbx_timespec_t *ts, zbx_dc_item_t *item, unsigned char **data, size_t *data_alloc,
 		size_t *data_offset);
+void	zbx_deactivate_item_interface_ext(zbx_timespec_t *ts, zbx_dc_interface_t *interface, zbx_uint64_t itemid,
+		unsigned char item_type, const char *host, const char *key_orig, unsigned char **data,
+		size_t *data_alloc, size_t *data_offset, int unavailable_delay, int unreachable_period,
+		int unreachable_delay, const char *error);
 void	zbx_deactivate_item_interface(zbx_timespec_t *ts, zbx_dc_item_t *item, unsigned char **data, size_t *data_alloc,
 		size_t *data_offset, int unavailable_delay, int unreachable_period, int unreachable_delay,
 		const char *error);
@@ -43,6 +43,7 @@
 #include "housekeeper/housekeeper.h"
 #include "pinger/pinger.h"
 #include "poller/poller.h"
+#include "poller/async_poller.h"
 #include "timer/timer.h"
 #include "trapper/trapper.h"
 #include "snmptrapper/snmptrapper.h"
@@ -123,8 +124,8 @@ const char	*help_message[] = {
 	"      " ZBX_SECRETS_RELOAD "                  Reload secrets from Vault",
 	"      " ZBX_DIAGINFO "=section                Log internal diagnostic information of the",
 	"                                        section (historycache, preprocessing, alerting,",
-	"                                        lld, valuecache, locks, connector) or everything if section is",
-	"                                        not specified",
+	"                                        lld, valuecache, locks, connector, configcache) or everything",
+	"                                        if section is not specified",
 	"      " ZBX_PROF_ENABLE "=target              Enable profiling, affects all processes if",
 	"                                        target is not specified",
 	"      " ZBX_PROF_DISABLE "=target             Disable profiling, affects all processes if",
@@ -139,24 +140,24 @@ const char	*help_message[] = {
 	"",
 	"      Log level control targets:",
 	"        process-type              All processes of specified type",
-	"                                  (alerter, alert manager, availability manager, configuration syncer,",
-	"                                  connector manager, connector worker, discovery manager,",
-	"                                  escalator, ha manager, history poller, history syncer,",
-	"                                  housekeeper, http poller, icmp pinger, ipmi manager,",
+	"                                  (agent poller, alerter, alert manager, availability manager,",
+	"                                  configuration syncer, connector manager, connector worker,",
+	"                                  discovery manager, escalator, ha manager, history poller, history syncer,",
+	"                                  housekeeper, http agent poller, http poller, icmp pinger, ipmi manager,",
 	"                                  ipmi poller, java poller, odbc poller, poller, preprocessing manager,",
-	"                                  proxy poller, self-monitoring, service manager, snmp trapper,",
+	"                                  proxy poller, self-monitoring, service manager, snmp poller, snmp trapper,",
 	"                                  task manager, timer, trapper, unreachable poller, vmware collector)",
 	"        process-type,N            Process type and number (e.g., poller,3)",
 	"        pid                       Process identifier",
 	"",
 	"      Profiling control targets:",
 	"        process-type              All processes of specified type",
-	"                                  (alerter, alert manager, availability manager, configuration syncer,",
-	"                                  connector manager, connector worker, discovery manager,",
-	"                                  escalator, ha manager, history poller, history syncer,",
-	"                                  housekeeper, http poller, icmp pinger, ipmi manager,",
+	"                                  (agent poller, alerter, alert manager, availability manager,",
+	"                                  configuration syncer, connector manager, connector worker,",
+	"                                  discovery manager, escalator, ha manager, history poller, history syncer,",
+	"                                  housekeeper, http agent poller, http poller, icmp pinger, ipmi manager,",
 	"                                  ipmi poller, java poller, odbc poller, poller, preprocessing manager,",
-	"                                  proxy poller, self-monitoring, service manager, snmp trapper,",
+	"                                  proxy poller, self-monitoring, service manager, snmp poller, snmp trapper,",
 	"                                  task manager, timer, trapper, unreachable poller, vmware collector)",
 	"        process-type,N            Process type and number (e.g., history syncer,1)",
 	"        pid                       Process identifier",
@@ -269,6 +270,10 @@ int	CONFIG_FORKS[ZBX_PROCESS_TYPE_COUNT] = {
 	0, /* ZBX_PROCESS_TYPE_CONNECTORMANAGER */
 	0, /* ZBX_PROCESS_TYPE_CONNECTORWORKER */
 	0, /* ZBX_PROCESS_TYPE_DISCOVERYMANAGER */
+	0, /* ZBX_PROCESS_TYPE_AGENT_POLLER */
+	0, /* ZBX_PROCESS_TYPE_SNMP_POLLER */
+	0, /* ZBX_PROCESS_TYPE_HTTPAGENT_POLLER */
+	0, /* ZBX_PROCESS_TYPE_TRIGGEREVAL */
 };
 
 static int	get_config_forks(unsigned char process_type)
@@ -326,13 +331,19 @@ int	CONFIG_VMWARE_TIMEOUT		= 10;
 static zbx_uint64_t	config_conf_cache_size		= 32 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_cache_size	= 16 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_index_cache_size	= 4 * ZBX_MEBIBYTE;
+static int		config_history_cache_shards	= 1;
+static zbx_uint64_t	config_trigger_queue_size	= 24 * ZBX_MEBIBYTE;
+static zbx_uint64_t	config_preprocessing_ring_size	= 0;
 static zbx_uint64_t	config_trends_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	CONFIG_TREND_FUNC_CACHE_SIZE	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_value_cache_size		= 8 * ZBX_MEBIBYTE;
+static int		config_value_cache_compression	= 0;
 zbx_uint64_t	CONFIG_VMWARE_CACHE_SIZE	= 8 * ZBX_MEBIBYTE;
 
 static int	config_unreachable_period	= 45;
 static int	config_unreachable_delay	= 15;
+static int	config_max_concurrent_checks_per_poller	= 1000;
+static int	config_max_connections_per_trapper	= 1;
 int	CONFIG_LOG_LEVEL		= LOG_LEVEL_WARNING;
 char	*CONFIG_EXTERNALSCRIPTS		= NULL;
 int	CONFIG_ALLOW_UNSUPPORTED_DB_VERSIONS = 0;
@@ -585,6 +596,27 @@ int	get_process_info_by_thread(int local_server_num, unsigned char *local_proces
 		*local_process_type = ZBX_PROCESS_TYPE_CONNECTORWORKER;
 		*local_process_num = local_server_num - server_count + CONFIG_FORKS[ZBX_PROCESS_TYPE_CONNECTORWORKER];
 	}
+	else if (local_server_num <= (server_count += CONFIG_FORKS[ZBX_PROCESS_TYPE_AGENT_POLLER]))
+	{
+		*local_process_type = ZBX_PROCESS_TYPE_AGENT_POLLER;
+		*local_process_num = local_server_num - server_count + CONFIG_FORKS[ZBX_PROCESS_TYPE_AGENT_POLLER];
+	}
+	else if (local_server_num <= (server_count += CONFIG_FORKS[ZBX_PROCESS_TYPE_SNMP_POLLER]))
+	{
+		*local_process_type = ZBX_PROCESS_TYPE_SNMP_POLLER;
+		*local_process_num = local_server_num - server_count + CONFIG_FORKS[ZBX_PROCESS_TYPE_SNMP_POLLER];
+	}
+	else if (local_server_num <= (server_count += CONFIG_FORKS[ZBX_PROCESS_TYPE_HTTPAGENT_POLLER]))
+	{
+		*local_process_type = ZBX_PROCESS_TYPE_HTTPAGENT_POLLER;
+		*local_process_num = local_server_num - server_count +
+				CONFIG_FORKS[ZBX_PROCESS_TYPE_HTTPAGENT_POLLER];
+	}
+	else if (local_server_num <= (server_count += CONFIG_FORKS[ZBX_PROCESS_TYPE_TRIGGEREVAL]))
+	{
+		*local_process_type = ZBX_PROCESS_TYPE_TRIGGEREVAL;
+		*local_process_num = local_server_num - server_count + CONFIG_FORKS[ZBX_PROCESS_TYPE_TRIGGEREVAL];
+	}
 
 	else
 		return FAIL;
@@ -690,6 +722,14 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		err = 1;
 	}
 
+	if (0 != config_preprocessing_ring_size && (64 * ZBX_KIBIBYTE > config_preprocessing_ring_size ||
+			0 != (config_preprocessing_ring_size & (config_preprocessing_ring_size - 1))))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"PreprocessingRingSize\" configuration parameter must be either 0"
+				" or a power of two not less than 64KB");
+		err = 1;
+	}
+
 	if (0 != config_value_cache_size && 128 * ZBX_KIBIBYTE > config_value_cache_size)
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "\"ValueCacheSize\" configuration parameter must be either 0"
@@ -819,6 +859,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			MANDATORY,	MIN,			MAX */
 		{"StartDBSyncers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_HISTSYNCER],		TYPE_INT,
 			PARM_OPT,	1,			100},
+		{"StartTriggerEvaluators",	&CONFIG_FORKS[ZBX_PROCESS_TYPE_TRIGGEREVAL],		TYPE_INT,
+			PARM_OPT,	0,			100},
 		{"StartDiscoverers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_DISCOVERER],		TYPE_INT,
 			PARM_OPT,	0,			1000},
 		{"StartHTTPPollers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_HTTPPOLLER],		TYPE_INT,
@@ -853,12 +895,18 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryIndexCacheSize",	&config_history_index_cache_size,	TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryCacheShards",		&config_history_cache_shards,		TYPE_INT,
+			PARM_OPT,	1,			ZBX_HC_SHARDS_MAX},
+		{"TriggerQueueSize",		&config_trigger_queue_size,		TYPE_UINT64,
+			PARM_OPT,	ZBX_MEBIBYTE,		__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"TrendCacheSize",		&config_trends_cache_size,		TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"TrendFunctionCacheSize",	&CONFIG_TREND_FUNC_CACHE_SIZE,		TYPE_UINT64,
 			PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"ValueCacheSize",		&config_value_cache_size,		TYPE_UINT64,
 			PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"ValueCacheCompression",	&config_value_cache_compression,	TYPE_INT,
+			PARM_OPT,	0,			1},
 		{"CacheUpdateFrequency",	&CONFIG_CONFSYNCER_FREQUENCY,		TYPE_INT,
 			PARM_OPT,	1,			SEC_PER_HOUR},
 		{"HousekeepingFrequency",	&CONFIG_HOUSEKEEPING_FREQUENCY,		TYPE_INT,
@@ -1001,6 +1049,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	1,			100},
 		{"StartPreprocessors",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_PREPROCESSOR],		TYPE_INT,
 			PARM_OPT,	1,			1000},
+		{"PreprocessingRingSize",	&config_preprocessing_ring_size,	TYPE_UINT64,
+			PARM_OPT,	0,			64 * ZBX_MEBIBYTE},
 		{"HistoryStorageURL",		&CONFIG_HISTORY_STORAGE_URL,		TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"HistoryStorageTypes",		&CONFIG_HISTORY_STORAGE_OPTS,		TYPE_STRING_LIST,
@@ -1037,6 +1087,16 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			1000},
 		{"StartConnectors",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_CONNECTORWORKER],	TYPE_INT,
 			PARM_OPT,	0,			1000},
+		{"StartAgentPollers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_AGENT_POLLER],		TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartSNMPPollers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_SNMP_POLLER],		TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartHTTPAgentPollers",	&CONFIG_FORKS[ZBX_PROCESS_TYPE_HTTPAGENT_POLLER],	TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"MaxConcurrentChecksPerPoller",	&config_max_concurrent_checks_per_poller,	TYPE_INT,
+			PARM_OPT,	1,			1000},
+		{"MaxConnectionsPerTrapper",	&config_max_connections_per_trapper,		TYPE_INT,
+			PARM_OPT,	1,			1000},
 		{NULL}
 	};
 
@@ -1261,7 +1321,7 @@ int	main(int argc, char **argv)
 			get_zbx_config_log_remote_commands, get_zbx_config_unsafe_user_parameters,
 			get_zbx_config_source_ip);
 	zbx_init_library_dbhigh(zbx_config_dbhigh);
-	zbx_init_library_preproc(preproc_flush_value_server);
+	zbx_init_library_preproc(preproc_flush_value_server, config_preprocessing_ring_size);
 
 	if (ZBX_TASK_RUNTIME_CONTROL == t.task)
 	{
@@ -1407,16 +1467,18 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 
 	zbx_thread_poller_args		poller_args = {&config_comms, get_program_type, ZBX_NO_POLLER,
 							config_startup_time, config_unavailable_delay,
-							config_unreachable_period, config_unreachable_delay};
+							config_unreachable_period, config_unreachable_delay,
+							config_max_concurrent_checks_per_poller};
 	zbx_thread_trapper_args		trapper_args = {&config_comms, &zbx_config_vault, get_program_type,
 							&events_cbs, listen_sock, config_startup_time,
-							config_proxydata_frequency};
+							config_proxydata_frequency, config_max_connections_per_trapper};
 	zbx_thread_escalator_args	escalator_args = {zbx_config_tls, get_program_type, zbx_config_timeout,
 							zbx_config_source_ip};
 	zbx_thread_proxy_poller_args	proxy_poller_args = {zbx_config_tls, &zbx_config_vault, get_program_type,
 							zbx_config_timeout, zbx_config_source_ip, &events_cbs,
 							config_proxyconfig_frequency, config_proxydata_frequency};
-	zbx_thread_httppoller_args	httppoller_args = {zbx_config_source_ip};
+	zbx_thread_httppoller_args	httppoller_args = {zbx_config_source_ip,
+							config_max_concurrent_checks_per_poller};
 	zbx_thread_discoverer_args	discoverer_args = {zbx_config_tls, get_program_type, zbx_config_timeout,
 							CONFIG_FORKS[ZBX_PROCESS_TYPE_DISCOVERER], zbx_config_source_ip,
 							&events_cbs};
@@ -1449,7 +1511,9 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 	zbx_thread_dbsyncer_args		dbsyncer_args = {&events_cbs, config_histsyncer_frequency};
 
 	if (SUCCEED != zbx_init_database_cache(get_program_type, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, config_history_cache_shards,
+			CONFIG_FORKS[ZBX_PROCESS_TYPE_TRIGGEREVAL], config_trigger_queue_size, &config_trends_cache_size,
+			&error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
@@ -1477,7 +1541,7 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 		return FAIL;
 	}
 
-	if (SUCCEED != zbx_vc_init(config_value_cache_size, &error))
+	if (SUCCEED != zbx_vc_init(config_value_cache_size, config_value_cache_compression, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize history value cache: %s", error);
 		zbx_free(error);
@@ -1634,6 +1698,10 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 				thread_args.args = &dbsyncer_args;
 				zbx_thread_start(zbx_dbsyncer_thread, &thread_args, &threads[i]);
 				break;
+			case ZBX_PROCESS_TYPE_TRIGGEREVAL:
+				thread_args.args = &dbsyncer_args;
+				zbx_thread_start(zbx_trigger_evaluator_thread, &thread_args, &threads[i]);
+				break;
 			case ZBX_PROCESS_TYPE_ESCALATOR:
 				thread_args.args = &escalator_args;
 				zbx_thread_start(escalator_thread, &thread_args, &threads[i]);
@@ -1724,6 +1792,21 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 				thread_args.args = &poller_args;
 				zbx_thread_start(poller_thread, &thread_args, &threads[i]);
 				break;
+			case ZBX_PROCESS_TYPE_AGENT_POLLER:
+				poller_args.poller_type = ZBX_POLLER_TYPE_AGENT;
+				thread_args.args = &poller_args;
+				zbx_thread_start(async_poller_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_SNMP_POLLER:
+				poller_args.poller_type = ZBX_POLLER_TYPE_SNMP;
+				thread_args.args = &poller_args;
+				zbx_thread_start(async_poller_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_HTTPAGENT_POLLER:
+				poller_args.poller_type = ZBX_POLLER_TYPE_HTTPAGENT;
+				thread_args.args = &poller_args;
+				zbx_thread_start(async_poller_thread, &thread_args, &threads[i]);
+				break;
 		}
 	}
 
@@ -2053,7 +2136,9 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	}
 
 	if (SUCCEED != zbx_init_database_cache(get_program_type, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, config_history_cache_shards,
+			CONFIG_FORKS[ZBX_PROCESS_TYPE_TRIGGEREVAL], config_trigger_queue_size, &config_trends_cache_size,
+			&error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
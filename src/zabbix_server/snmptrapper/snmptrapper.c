@@ -31,12 +31,49 @@
 #include "zbx_item_constants.h"
 #include "zbxpreproc.h"
 
-static int	trap_fd = -1;
-static off_t	trap_lastsize;
-static ino_t	trap_ino = 0;
-static char	*buffer = NULL;
-static int	offset = 0;
-static int	force = 0;
+#define ZBX_SNMPTRAP_BUFFER_LEN		(4 * ZBX_MEBIBYTE)
+
+#define ZBX_SNMPTRAP_MATCHER_SKIP	0
+#define ZBX_SNMPTRAP_MATCHER_ANY	1
+#define ZBX_SNMPTRAP_MATCHER_REGEXP	2
+#define ZBX_SNMPTRAP_MATCHER_GLOBAL	3
+#define ZBX_SNMPTRAP_MATCHER_FALLBACK	4
+#define ZBX_SNMPTRAP_MATCHER_ERROR	5
+
+typedef struct
+{
+	const char	*addr;
+	char		*trap;
+	zbx_timespec_t	ts;
+	int		matched;
+}
+zbx_snmptrap_t;
+
+ZBX_PTR_VECTOR_DECL(snmptrap_ptr, zbx_snmptrap_t *)
+ZBX_PTR_VECTOR_IMPL(snmptrap_ptr, zbx_snmptrap_t *)
+
+/* snmptrap[] item prepared for matching a batch of traps */
+typedef struct
+{
+	int		type;
+	char		*pattern;	/* global regular expression name prefixed with '@' */
+	zbx_regexp_t	*regexp;
+	char		*error;
+	int		errcode;	/* FAIL - no value was added, SUCCEED or NOTSUPPORTED - last added value */
+	int		lastclock;
+}
+zbx_snmptrap_matcher_t;
+
+static int		trap_fd = -1;
+static off_t		trap_lastsize;
+static ino_t		trap_ino = 0;
+static char		*buffer = NULL;
+static int		offset = 0;
+static int		force = 0;
+
+/* statistics */
+static zbx_uint64_t	traps_num;
+static off_t		trap_lag;
 
 static void	DBget_lastsize(void)
 {
@@ -67,55 +104,92 @@ static void	DBupdate_lastsize(void)
 	zbx_db_commit();
 }
 
+static void	snmptrap_free(zbx_snmptrap_t *trap)
+{
+	zbx_free(trap->trap);
+	zbx_free(trap);
+}
+
+static int	snmptrap_compare(const void *d1, const void *d2)
+{
+	const zbx_snmptrap_t	*t1 = *(const zbx_snmptrap_t * const *)d1;
+	const zbx_snmptrap_t	*t2 = *(const zbx_snmptrap_t * const *)d2;
+	int			ret;
+
+	if (0 != (ret = strcmp(t1->addr, t2->addr)))
+		return ret;
+
+	return zbx_timespec_compare(&t1->ts, &t2->ts);
+}
+
 /******************************************************************************
  *                                                                            *
- * Purpose: add trap to all matching items for the specified interface        *
+ * Purpose: make sure the batch regular expressions contain the specified     *
+ *          global regular expression                                         *
  *                                                                            *
- * Return value: SUCCEED - a matching item was found                          *
- *               FAIL - no matching item was found (including fallback items) *
+ * Return value: SUCCEED - the global regular expression exists               *
+ *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	process_trap_for_interface(zbx_uint64_t interfaceid, char *trap, zbx_timespec_t *ts)
+static int	snmptrap_get_expressions(zbx_vector_expression_t *regexps, const char *name)
 {
-	zbx_dc_item_t		*items = NULL;
-	const char		*regex;
-	char			error[ZBX_ITEM_ERROR_LEN_MAX];
-	size_t			num, i;
-	int			ret = FAIL, fb = -1, *lastclocks = NULL, *errcodes = NULL, value_type, regexp_ret;
-	zbx_uint64_t		*itemids = NULL;
-	AGENT_RESULT		*results = NULL;
-	AGENT_REQUEST		request;
-	zbx_vector_expression_t	regexps;
-	zbx_dc_um_handle_t	*um_handle;
+	int	i;
 
-	zbx_vector_expression_create(&regexps);
+	for (i = 0; i < regexps->values_num; i++)
+	{
+		if (0 == strcmp(regexps->values[i]->name, name))
+			return SUCCEED;
+	}
 
-	um_handle = zbx_dc_open_user_macros();
+	zbx_dc_get_expressions_by_name(regexps, name);
 
-	num = zbx_dc_config_get_snmp_items_by_interfaceid(interfaceid, &items);
+	return i == regexps->values_num ? FAIL : SUCCEED;
+}
 
-	itemids = (zbx_uint64_t *)zbx_malloc(itemids, sizeof(zbx_uint64_t) * num);
-	lastclocks = (int *)zbx_malloc(lastclocks, sizeof(int) * num);
-	errcodes = (int *)zbx_malloc(errcodes, sizeof(int) * num);
-	results = (AGENT_RESULT *)zbx_malloc(results, sizeof(AGENT_RESULT) * num);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: substitute and parse snmptrap[] item keys, compile their regular  *
+ *          expressions                                                       *
+ *                                                                            *
+ * Parameters: items    - [IN] the interface items                            *
+ *             num      - [IN] the number of items                            *
+ *             regexps  - [IN/OUT] the global regular expressions used by     *
+ *                                 the current batch                          *
+ *             matchers - [OUT] the prepared matchers, one per item           *
+ *                                                                            *
+ * Return value: index of the snmptrap.fallback item or -1 if there is none   *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmptrap_prepare_matchers(zbx_dc_item_t *items, size_t num, zbx_vector_expression_t *regexps,
+		zbx_snmptrap_matcher_t *matchers)
+{
+	const char		*regex, *err_msg = NULL;
+	char			error[ZBX_ITEM_ERROR_LEN_MAX];
+	size_t			i;
+	int			fb = -1;
+	AGENT_REQUEST		request;
+	zbx_snmptrap_matcher_t	*matcher;
 
 	for (i = 0; i < num; i++)
 	{
-		zbx_init_agent_result(&results[i]);
-		errcodes[i] = FAIL;
+		matcher = &matchers[i];
+		memset(matcher, 0, sizeof(zbx_snmptrap_matcher_t));
+		matcher->type = ZBX_SNMPTRAP_MATCHER_SKIP;
+		matcher->errcode = FAIL;
 
 		items[i].key = zbx_strdup(items[i].key, items[i].key_orig);
 		if (SUCCEED != zbx_substitute_key_macros(&items[i].key, NULL, &items[i], NULL, NULL,
 				MACRO_TYPE_ITEM_KEY, error, sizeof(error)))
 		{
-			SET_MSG_RESULT(&results[i], zbx_strdup(NULL, error));
-			errcodes[i] = NOTSUPPORTED;
+			matcher->type = ZBX_SNMPTRAP_MATCHER_ERROR;
+			matcher->error = zbx_strdup(NULL, error);
 			continue;
 		}
 
 		if (0 == strcmp(items[i].key, "snmptrap.fallback"))
 		{
-			fb = i;
+			matcher->type = ZBX_SNMPTRAP_MATCHER_FALLBACK;
+			fb = (int)i;
 			continue;
 		}
 
@@ -130,84 +204,202 @@ static int	process_trap_for_interface(zbx_uint64_t interfaceid, char *trap, zbx_
 		if (1 < get_rparams_num(&request))
 			goto next;
 
-		if (NULL != (regex = get_rparam(&request, 0)))
+		if (NULL == (regex = get_rparam(&request, 0)) || '\0' == *regex)
 		{
-			if ('@' == *regex)
-			{
-				zbx_dc_get_expressions_by_name(&regexps, regex + 1);
-
-				if (0 == regexps.values_num)
-				{
-					SET_MSG_RESULT(&results[i], zbx_dsprintf(NULL,
-							"Global regular expression \"%s\" does not exist.", regex + 1));
-					errcodes[i] = NOTSUPPORTED;
-					goto next;
-				}
-			}
+			matcher->type = ZBX_SNMPTRAP_MATCHER_ANY;
+			goto next;
+		}
 
-			if (ZBX_REGEXP_NO_MATCH == (regexp_ret = zbx_regexp_match_ex(&regexps, trap, regex,
-					ZBX_CASE_SENSITIVE)))
-			{
-				goto next;
-			}
-			else if (FAIL == regexp_ret)
+		if ('@' == *regex)
+		{
+			if (SUCCEED != snmptrap_get_expressions(regexps, regex + 1))
 			{
-				SET_MSG_RESULT(&results[i], zbx_dsprintf(NULL,
-						"Invalid regular expression \"%s\".", regex));
-				errcodes[i] = NOTSUPPORTED;
+				matcher->type = ZBX_SNMPTRAP_MATCHER_ERROR;
+				matcher->error = zbx_dsprintf(NULL, "Global regular expression \"%s\" does not exist.",
+						regex + 1);
 				goto next;
 			}
+
+			matcher->type = ZBX_SNMPTRAP_MATCHER_GLOBAL;
+			matcher->pattern = zbx_strdup(NULL, regex);
+			goto next;
+		}
+
+		if (SUCCEED != zbx_regexp_compile(regex, &matcher->regexp, &err_msg))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot compile regular expression \"%s\": %s", regex, err_msg);
+			zbx_regexp_err_msg_free(err_msg);
+
+			matcher->type = ZBX_SNMPTRAP_MATCHER_ERROR;
+			matcher->error = zbx_dsprintf(NULL, "Invalid regular expression \"%s\".", regex);
+			goto next;
 		}
 
-		value_type = (ITEM_VALUE_TYPE_LOG == items[i].value_type ? ITEM_VALUE_TYPE_LOG : ITEM_VALUE_TYPE_TEXT);
-		zbx_set_agent_result_type(&results[i], value_type, trap);
-		errcodes[i] = SUCCEED;
-		ret = SUCCEED;
+		matcher->type = ZBX_SNMPTRAP_MATCHER_REGEXP;
 next:
 		zbx_free_agent_request(&request);
 	}
 
-	if (FAIL == ret && -1 != fb)
+	return fb;
+}
+
+static void	snmptrap_clear_matchers(zbx_snmptrap_matcher_t *matchers, size_t num)
+{
+	size_t	i;
+
+	for (i = 0; i < num; i++)
 	{
-		value_type = (ITEM_VALUE_TYPE_LOG == items[fb].value_type ? ITEM_VALUE_TYPE_LOG : ITEM_VALUE_TYPE_TEXT);
-		zbx_set_agent_result_type(&results[fb], value_type, trap);
-		errcodes[fb] = SUCCEED;
-		ret = SUCCEED;
+		if (NULL != matchers[i].regexp)
+			zbx_regexp_free(matchers[i].regexp);
+
+		zbx_free(matchers[i].pattern);
+		zbx_free(matchers[i].error);
 	}
+}
 
-	for (i = 0; i < num; i++)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: match trap against prepared snmptrap[] item                       *
+ *                                                                            *
+ * Return value: ZBX_REGEXP_MATCH    - the trap matches                       *
+ *               ZBX_REGEXP_NO_MATCH - the trap does not match                *
+ *               FAIL                - invalid regular expression             *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmptrap_match(const zbx_snmptrap_matcher_t *matcher, const zbx_vector_expression_t *regexps,
+		const char *trap)
+{
+	switch (matcher->type)
+	{
+		case ZBX_SNMPTRAP_MATCHER_ANY:
+			return ZBX_REGEXP_MATCH;
+		case ZBX_SNMPTRAP_MATCHER_REGEXP:
+			return 0 == zbx_regexp_match_precompiled(trap, matcher->regexp) ? ZBX_REGEXP_MATCH :
+					ZBX_REGEXP_NO_MATCH;
+		case ZBX_SNMPTRAP_MATCHER_GLOBAL:
+			return zbx_regexp_match_ex(regexps, trap, matcher->pattern, ZBX_CASE_SENSITIVE);
+		default:
+			return ZBX_REGEXP_NO_MATCH;
+	}
+}
+
+static void	snmptrap_add_item_value(zbx_dc_item_t *item, zbx_snmptrap_matcher_t *matcher, zbx_snmptrap_t *trap)
+{
+	AGENT_RESULT	result;
+	int		value_type;
+
+	zbx_init_agent_result(&result);
+
+	value_type = (ITEM_VALUE_TYPE_LOG == item->value_type ? ITEM_VALUE_TYPE_LOG : ITEM_VALUE_TYPE_TEXT);
+	zbx_set_agent_result_type(&result, value_type, trap->trap);
+
+	if (ITEM_VALUE_TYPE_LOG == item->value_type)
+		zbx_calc_timestamp(result.log->value, &result.log->timestamp, item->logtimefmt);
+
+	item->state = ITEM_STATE_NORMAL;
+	zbx_preprocess_item_value(item->itemid, item->host.hostid, item->value_type, item->flags, &result, &trap->ts,
+			item->state, NULL);
+
+	zbx_free_agent_result(&result);
+
+	matcher->errcode = SUCCEED;
+	matcher->lastclock = trap->ts.sec;
+}
+
+static void	snmptrap_add_item_error(zbx_dc_item_t *item, zbx_snmptrap_matcher_t *matcher, zbx_snmptrap_t *trap,
+		char *error)
+{
+	item->state = ITEM_STATE_NOTSUPPORTED;
+	zbx_preprocess_item_value(item->itemid, item->host.hostid, item->value_type, item->flags, NULL, &trap->ts,
+			item->state, error);
+
+	matcher->errcode = NOTSUPPORTED;
+	matcher->lastclock = trap->ts.sec;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add traps to all matching items for the specified interface       *
+ *                                                                            *
+ * Parameters: interfaceid - [IN] the target interface                        *
+ *             traps       - [IN/OUT] the traps received from the interface   *
+ *                                    address, matched traps are marked       *
+ *             traps_num   - [IN] the number of traps                         *
+ *             regexps     - [IN/OUT] the global regular expressions used by  *
+ *                                    the current batch                       *
+ *                                                                            *
+ * Comments: The interface items are loaded and their regular expressions are *
+ *           compiled once for all traps.                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	process_traps_for_interface(zbx_uint64_t interfaceid, zbx_snmptrap_t **traps, int traps_num,
+		zbx_vector_expression_t *regexps)
+{
+	zbx_dc_item_t		*items = NULL;
+	zbx_snmptrap_matcher_t	*matchers = NULL;
+	char			*error;
+	size_t			num, i;
+	int			j, ret, fb, *lastclocks = NULL, *errcodes = NULL, regexp_ret;
+	zbx_uint64_t		*itemids = NULL;
+	zbx_dc_um_handle_t	*um_handle;
+
+	um_handle = zbx_dc_open_user_macros();
+
+	if (0 == (num = zbx_dc_config_get_snmp_items_by_interfaceid(interfaceid, &items)))
+		goto out;
+
+	matchers = (zbx_snmptrap_matcher_t *)zbx_malloc(matchers, sizeof(zbx_snmptrap_matcher_t) * num);
+	fb = snmptrap_prepare_matchers(items, num, regexps, matchers);
+
+	for (j = 0; j < traps_num; j++)
 	{
-		switch (errcodes[i])
+		ret = FAIL;
+
+		for (i = 0; i < num; i++)
 		{
-			case SUCCEED:
-				if (ITEM_VALUE_TYPE_LOG == items[i].value_type)
-				{
-					zbx_calc_timestamp(results[i].log->value, &results[i].log->timestamp,
-							items[i].logtimefmt);
-				}
+			if (ZBX_SNMPTRAP_MATCHER_ERROR == matchers[i].type)
+			{
+				snmptrap_add_item_error(&items[i], &matchers[i], traps[j], matchers[i].error);
+				continue;
+			}
+
+			if (ZBX_REGEXP_NO_MATCH == (regexp_ret = snmptrap_match(&matchers[i], regexps, traps[j]->trap)))
+				continue;
 
-				items[i].state = ITEM_STATE_NORMAL;
-				zbx_preprocess_item_value(items[i].itemid, items[i].host.hostid, items[i].value_type, items[i].flags,
-						&results[i], ts, items[i].state, NULL);
-
-				itemids[i] = items[i].itemid;
-				lastclocks[i] = ts->sec;
-				break;
-			case NOTSUPPORTED:
-				items[i].state = ITEM_STATE_NOTSUPPORTED;
-				zbx_preprocess_item_value(items[i].itemid, items[i].host.hostid, items[i].value_type, items[i].flags, NULL,
-						ts, items[i].state, results[i].msg);
-
-				itemids[i] = items[i].itemid;
-				lastclocks[i] = ts->sec;
-				break;
+			if (FAIL == regexp_ret)
+			{
+				error = zbx_dsprintf(NULL, "Invalid regular expression \"%s\".", matchers[i].pattern);
+				snmptrap_add_item_error(&items[i], &matchers[i], traps[j], error);
+				zbx_free(error);
+				continue;
+			}
+
+			snmptrap_add_item_value(&items[i], &matchers[i], traps[j]);
+			ret = SUCCEED;
 		}
 
-		zbx_free(items[i].key);
-		zbx_free_agent_result(&results[i]);
+		if (FAIL == ret && -1 != fb)
+		{
+			snmptrap_add_item_value(&items[fb], &matchers[fb], traps[j]);
+			ret = SUCCEED;
+		}
+
+		if (SUCCEED == ret)
+			traps[j]->matched = SUCCEED;
 	}
 
-	zbx_free(results);
+	itemids = (zbx_uint64_t *)zbx_malloc(itemids, sizeof(zbx_uint64_t) * num);
+	lastclocks = (int *)zbx_malloc(lastclocks, sizeof(int) * num);
+	errcodes = (int *)zbx_malloc(errcodes, sizeof(int) * num);
+
+	for (i = 0; i < num; i++)
+	{
+		itemids[i] = items[i].itemid;
+		lastclocks[i] = matchers[i].lastclock;
+		errcodes[i] = matchers[i].errcode;
+
+		zbx_free(items[i].key);
+	}
 
 	zbx_dc_requeue_items(itemids, lastclocks, errcodes, num);
 
@@ -215,70 +407,132 @@ next:
 	zbx_free(lastclocks);
 	zbx_free(itemids);
 
+	snmptrap_clear_matchers(matchers, num);
+	zbx_free(matchers);
+
 	zbx_dc_config_clean_items(items, NULL, num);
+out:
 	zbx_free(items);
 
 	zbx_dc_close_user_macros(um_handle);
-
-	zbx_regexp_clean_expressions(&regexps);
-	zbx_vector_expression_destroy(&regexps);
-
-	zbx_preprocessor_flush();
-
-	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: process a single trap                                             *
+ * Purpose: process a batch of traps                                          *
  *                                                                            *
- * Parameters: addr - [IN] address of the target interface(s)                 *
- *             begin - [IN] beginning of the trap message                     *
- *             end - [IN] end of the trap message                             *
+ * Parameters: traps - [IN/OUT] the traps parsed from the trap file buffer    *
+ *                                                                            *
+ * Comments: Traps are grouped by address so that the target interfaces are   *
+ *           looked up once per address and every trap of the group is        *
+ *           matched against the interface items prepared once. The order of  *
+ *           traps received from the same address is preserved.               *
  *                                                                            *
  ******************************************************************************/
-static void	process_trap(const char *addr, char *begin, char *end)
+static void	process_traps(zbx_vector_snmptrap_ptr_t *traps)
 {
-	zbx_timespec_t	ts;
-	zbx_uint64_t	*interfaceids = NULL;
-	int		count, i, ret = FAIL;
-	char		*trap = NULL;
+	zbx_uint64_t			*interfaceids = NULL;
+	int				i, j, k, count, unmatched_num = 0;
+	zbx_vector_expression_t		regexps;
+	zbx_vector_snmptrap_ptr_t	traps_addr;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() traps:%d", __func__, traps->values_num);
+
+	zbx_vector_expression_create(&regexps);
+	zbx_vector_snmptrap_ptr_create(&traps_addr);
+
+	zbx_vector_snmptrap_ptr_append_array(&traps_addr, traps->values, traps->values_num);
+	zbx_vector_snmptrap_ptr_sort(&traps_addr, snmptrap_compare);
+
+	for (i = 0; i < traps_addr.values_num; i = j)
+	{
+		const char	*addr = traps_addr.values[i]->addr;
 
-	zbx_timespec(&ts);
-	trap = zbx_dsprintf(trap, "%s%s", begin, end);
+		for (j = i + 1; j < traps_addr.values_num && 0 == strcmp(addr, traps_addr.values[j]->addr); j++)
+			;
 
-	count = zbx_dc_config_get_snmp_interfaceids_by_addr(addr, &interfaceids);
+		count = zbx_dc_config_get_snmp_interfaceids_by_addr(addr, &interfaceids);
+
+		for (k = 0; k < count; k++)
+			process_traps_for_interface(interfaceids[k], &traps_addr.values[i], j - i, &regexps);
+
+		zbx_free(interfaceids);
+	}
 
-	for (i = 0; i < count; i++)
+	zbx_vector_snmptrap_ptr_destroy(&traps_addr);
+
+	zbx_preprocessor_flush();
+
+	for (i = 0; i < traps->values_num; i++)
 	{
-		if (SUCCEED == process_trap_for_interface(interfaceids[i], trap, &ts))
-			ret = SUCCEED;
+		if (FAIL == traps->values[i]->matched)
+			unmatched_num++;
 	}
 
-	if (FAIL == ret)
+	if (0 != unmatched_num)
 	{
 		zbx_config_t	cfg;
 
 		zbx_config_get(&cfg, ZBX_CONFIG_FLAGS_SNMPTRAP_LOGGING);
 
 		if (ZBX_SNMPTRAP_LOGGING_ENABLED == cfg.snmptrap_logging)
-			zabbix_log(LOG_LEVEL_WARNING, "unmatched trap received from \"%s\": %s", addr, trap);
+		{
+			for (i = 0; i < traps->values_num; i++)
+			{
+				if (FAIL == traps->values[i]->matched)
+				{
+					zabbix_log(LOG_LEVEL_WARNING, "unmatched trap received from \"%s\": %s",
+							traps->values[i]->addr, traps->values[i]->trap);
+				}
+			}
+		}
 
 		zbx_config_clean(&cfg);
 	}
 
-	zbx_free(interfaceids);
-	zbx_free(trap);
+	traps_num += (zbx_uint64_t)traps->values_num;
+
+	zbx_regexp_clean_expressions(&regexps);
+	zbx_vector_expression_destroy(&regexps);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() unmatched:%d", __func__, unmatched_num);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: split traps and process them with process_trap()                  *
+ * Purpose: add a single trap to the batch                                    *
+ *                                                                            *
+ * Parameters: traps - [IN/OUT] the trap batch                                *
+ *             addr  - [IN] address of the target interface(s)                *
+ *             begin - [IN] beginning of the trap message                     *
+ *             end   - [IN] end of the trap message                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	add_trap(zbx_vector_snmptrap_ptr_t *traps, const char *addr, const char *begin, const char *end)
+{
+	zbx_snmptrap_t	*trap;
+
+	trap = (zbx_snmptrap_t *)zbx_malloc(NULL, sizeof(zbx_snmptrap_t));
+	trap->addr = addr;
+	trap->trap = zbx_dsprintf(NULL, "%s%s", begin, end);
+	trap->matched = FAIL;
+	zbx_timespec(&trap->ts);
+
+	zbx_vector_snmptrap_ptr_append(traps, trap);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: split traps and process them as a batch with process_traps()      *
  *                                                                            *
  ******************************************************************************/
 static void	parse_traps(int flag)
 {
-	char	*c, *line, *begin = NULL, *end = NULL, *addr = NULL, *pzbegin, *pzaddr = NULL, *pzdate = NULL;
+	char				*c, *line, *begin = NULL, *end = NULL, *addr = NULL, *pzbegin, *pzaddr = NULL,
+					*pzdate = NULL;
+	zbx_vector_snmptrap_ptr_t	traps;
+
+	zbx_vector_snmptrap_ptr_create(&traps);
 
 	c = line = buffer;
 
@@ -305,14 +559,14 @@ static void	parse_traps(int flag)
 
 		/* c now points to the address */
 
-		/* process the previous trap */
+		/* add the previous trap to the batch */
 		if (NULL != begin)
 		{
 			*(line - 1) = '\0';
 			*pzdate = '\0';
 			*pzaddr = '\0';
 
-			process_trap(addr, begin, end);
+			add_trap(&traps, addr, begin, end);
 			end = NULL;
 		}
 
@@ -329,6 +583,22 @@ static void	parse_traps(int flag)
 		end = c + 1;	/* the rest of the trap */
 	}
 
+	if (0 != flag && NULL != end)
+	{
+		*(line - 1) = '\0';
+		*pzdate = '\0';
+		*pzaddr = '\0';
+
+		add_trap(&traps, addr, begin, end);
+	}
+
+	/* trap addresses point to the buffer, process the batch before the buffer is changed */
+	if (0 != traps.values_num)
+		process_traps(&traps);
+
+	zbx_vector_snmptrap_ptr_clear_ext(&traps, snmptrap_free);
+	zbx_vector_snmptrap_ptr_destroy(&traps);
+
 	if (0 == flag)
 	{
 		if (NULL == begin)
@@ -336,7 +606,7 @@ static void	parse_traps(int flag)
 		else
 			offset = c - begin;
 
-		if (offset == MAX_BUFFER_LEN - 1)
+		if (offset == ZBX_SNMPTRAP_BUFFER_LEN - 1)
 		{
 			if (NULL != end)
 			{
@@ -358,22 +628,11 @@ static void	parse_traps(int flag)
 	}
 	else
 	{
-		if (NULL != end)
-		{
-			*(line - 1) = '\0';
-			*pzdate = '\0';
-			*pzaddr = '\0';
-
-			process_trap(addr, begin, end);
-			offset = 0;
-			*buffer = '\0';
-		}
-		else
-		{
+		if (NULL == end)
 			zabbix_log(LOG_LEVEL_WARNING, "invalid trap data found \"%s\"", buffer);
-			offset = 0;
-			*buffer = '\0';
-		}
+
+		offset = 0;
+		*buffer = '\0';
 	}
 }
 
@@ -411,8 +670,9 @@ static void	delay_trap_logs(char *error, int log_level)
  ******************************************************************************/
 static int	read_traps(void)
 {
-	int	nbytes = 0;
-	char	*error = NULL;
+	int		nbytes = 0;
+	char		*error = NULL;
+	zbx_stat_t	file_buf;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() lastsize: %lld", __func__, (long long int)trap_lastsize);
 
@@ -424,7 +684,7 @@ static int	read_traps(void)
 		goto out;
 	}
 
-	if (-1 == (nbytes = read(trap_fd, buffer + offset, MAX_BUFFER_LEN - offset - 1)))
+	if (-1 == (nbytes = read(trap_fd, buffer + offset, ZBX_SNMPTRAP_BUFFER_LEN - offset - 1)))
 	{
 		error = zbx_dsprintf(error, "cannot read from SNMP trapper file \"%s\": %s",
 				CONFIG_SNMPTRAP_FILE, zbx_strerror(errno));
@@ -437,6 +697,12 @@ static int	read_traps(void)
 		buffer[nbytes + offset] = '\0';
 		trap_lastsize += nbytes;
 		DBupdate_lastsize();
+
+		if (0 == zbx_fstat(trap_fd, &file_buf) && file_buf.st_size > trap_lastsize)
+			trap_lag = file_buf.st_size - trap_lastsize;
+		else
+			trap_lag = 0;
+
 		parse_traps(0);
 	}
 out:
@@ -605,7 +871,7 @@ ZBX_THREAD_ENTRY(snmptrapper_thread, args)
 
 	DBget_lastsize();
 
-	buffer = (char *)zbx_malloc(buffer, MAX_BUFFER_LEN);
+	buffer = (char *)zbx_malloc(buffer, ZBX_SNMPTRAP_BUFFER_LEN);
 	*buffer = '\0';
 
 	while (ZBX_IS_RUNNING())
@@ -615,12 +881,24 @@ ZBX_THREAD_ENTRY(snmptrapper_thread, args)
 
 		zbx_setproctitle("%s [processing data]", get_process_type_string(process_type));
 
+		traps_num = 0;
+
 		while (ZBX_IS_RUNNING() && SUCCEED == get_latest_data())
+		{
 			read_traps();
+
+			if (0 != trap_lag)
+			{
+				zbx_setproctitle("%s [processing data, " ZBX_FS_UI64 " traps processed, %lld bytes behind]",
+						get_process_type_string(process_type), traps_num, (long long int)trap_lag);
+			}
+		}
+
 		sec = zbx_time() - sec;
 
-		zbx_setproctitle("%s [processed data in " ZBX_FS_DBL " sec, idle 1 sec]",
-				get_process_type_string(process_type), sec);
+		zbx_setproctitle("%s [processed " ZBX_FS_UI64 " traps in " ZBX_FS_DBL " sec (" ZBX_FS_DBL
+				" traps/sec), idle 1 sec]", get_process_type_string(process_type), traps_num, sec,
+				0 < sec ? (double)traps_num / sec : 0.0);
 
 		zbx_sleep_loop(info, 1);
 	}
@@ -128,7 +128,7 @@ static int	zbx_autoreg_host_check_permissions(const char *host, const char *ip,
 #if defined(HAVE_GNUTLS) || (defined(HAVE_OPENSSL) && defined(HAVE_OPENSSL_WITH_PSK))
 	if (ZBX_TCP_SEC_TLS_PSK == sock->connection_type)
 	{
-		if (0 == (ZBX_PSK_FOR_AUTOREG & zbx_tls_get_psk_usage()))
+		if (0 == (ZBX_PSK_FOR_AUTOREG & zbx_tls_get_psk_usage(sock)))
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "autoregistration from \"%s\" denied (host:\"%s\" ip:\"%s\""
 					" port:%hu): connection used PSK which is not configured for autoregistration",
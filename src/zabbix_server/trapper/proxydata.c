@@ -124,13 +124,16 @@ static int	proxy_data_no_history(const struct zbx_json_parse *jp)
  * Parameters: sock                - [IN] connection socket                   *
  *             jp                  - [IN] received JSON data                  *
  *             ts                  - [IN] connection timestamp                *
+ *             stream              - [IN] history processed while the request *
+ *                                        was received, optional              *
  *             events_cbs          - [IN]                                     *
  *             config_timeout      - [IN]                                     *
  *             proxydata_frequency - [IN]                                     *
  *                                                                            *
  ******************************************************************************/
 void	zbx_recv_proxy_data(zbx_socket_t *sock, struct zbx_json_parse *jp, const zbx_timespec_t *ts,
-		const zbx_events_funcs_t *events_cbs, int config_timeout, int proxydata_frequency)
+		const zbx_proxy_data_stream_t *stream, const zbx_events_funcs_t *events_cbs, int config_timeout,
+		int proxydata_frequency)
 {
 	int			ret = FAIL, upload_status = 0, status, version_int, responded = 0;
 	char			*error = NULL, *version_str = NULL;
@@ -172,8 +175,8 @@ void	zbx_recv_proxy_data(zbx_socket_t *sock, struct zbx_json_parse *jp, const zb
 
 	if (SUCCEED == ret)
 	{
-		if (SUCCEED != (ret = zbx_process_proxy_data(&proxy, jp, ts, HOST_STATUS_PROXY_ACTIVE, events_cbs,
-				proxydata_frequency, NULL, &error)))
+		if (SUCCEED != (ret = zbx_process_proxy_data(&proxy, jp, ts, stream, HOST_STATUS_PROXY_ACTIVE,
+				events_cbs, proxydata_frequency, NULL, &error)))
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "received invalid proxy data from proxy \"%s\" at \"%s\": %s",
 					proxy.host, sock->peer, error);
@@ -23,12 +23,14 @@
 #include "zbxcacheconfig.h"
 #include "zbxcomms.h"
 #include "zbxdbhigh.h"
+#include "zbxdbwrap.h"
 #include "zbxtime.h"
 
 extern int	CONFIG_TRAPPER_TIMEOUT;
 
 void	zbx_recv_proxy_data(zbx_socket_t *sock, struct zbx_json_parse *jp, const zbx_timespec_t *ts,
-		const zbx_events_funcs_t *events_cbs, int config_timeout, int proxydata_frequency);
+		const zbx_proxy_data_stream_t *stream, const zbx_events_funcs_t *events_cbs, int config_timeout,
+		int proxydata_frequency);
 void	zbx_send_proxy_data(zbx_socket_t *sock, zbx_timespec_t *ts, const zbx_config_comms_args_t *config_comms);
 void	zbx_send_task_data(zbx_socket_t *sock, zbx_timespec_t *ts, const zbx_config_comms_args_t *config_comms);
 
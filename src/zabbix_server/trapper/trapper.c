@@ -51,6 +51,8 @@
 #	include "zbxrtc.h"
 #endif
 
+#include <event2/event.h>
+
 #define ZBX_MAX_SECTION_ENTRIES		4
 #define ZBX_MAX_ENTRY_ATTRIBUTES	3
 
@@ -1097,8 +1099,9 @@ static int	comms_parse_response(char *xml, char *host, size_t host_len, char *ke
 }
 
 static int	process_trap(zbx_socket_t *sock, char *s, ssize_t bytes_received, zbx_timespec_t *ts,
-		const zbx_config_comms_args_t *config_comms, const zbx_config_vault_t *config_vault,
-		int config_startup_time, const zbx_events_funcs_t *events_cbs, int proxydata_frequency)
+		const zbx_proxy_data_stream_t *stream, const zbx_config_comms_args_t *config_comms,
+		const zbx_config_vault_t *config_vault, int config_startup_time, const zbx_events_funcs_t *events_cbs,
+		int proxydata_frequency)
 {
 	int	ret = SUCCEED;
 
@@ -1147,7 +1150,7 @@ static int	process_trap(zbx_socket_t *sock, char *s, ssize_t bytes_received, zbx
 		{
 			if (0 != (zbx_get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 			{
-				zbx_recv_proxy_data(sock, &jp, ts, events_cbs, config_comms->config_timeout,
+				zbx_recv_proxy_data(sock, &jp, ts, stream, events_cbs, config_comms->config_timeout,
 						proxydata_frequency);
 			}
 			else if (0 != (zbx_get_program_type_cb() & ZBX_PROGRAM_TYPE_PROXY_PASSIVE))
@@ -1288,19 +1291,358 @@ static int	process_trap(zbx_socket_t *sock, char *s, ssize_t bytes_received, zbx
 	return ret;
 }
 
-static void	process_trapper_child(zbx_socket_t *sock, zbx_timespec_t *ts,
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create stream to process history of 'proxy data' request while    *
+ *          it is being received                                              *
+ *                                                                            *
+ * Return value: the proxy data stream or NULL if proxy data is not accepted  *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_proxy_data_stream_t	*trapper_proxy_data_stream_create(const zbx_socket_t *sock, const zbx_timespec_t *ts,
+		int proxydata_frequency)
+{
+	if (0 == (zbx_get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
+		return NULL;
+
+	return zbx_proxy_data_stream_create(sock, ts, proxydata_frequency);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the maximum size of request data kept in receive buffer       *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	trapper_buffer_peak(const zbx_socket_t *sock, const zbx_proxy_data_stream_t *stream)
+{
+	if (NULL != stream && zbx_proxy_data_stream_get_peak(stream) > sock->read_bytes)
+		return zbx_proxy_data_stream_get_peak(stream);
+
+	return sock->read_bytes;
+}
+
+static void	process_trapper_child(const zbx_thread_info_t *info, zbx_socket_t *sock, zbx_timespec_t *ts,
 		const zbx_config_comms_args_t *config_comms, const zbx_config_vault_t *config_vault,
 		int config_startup_time, const zbx_events_funcs_t *events_cbs, int proxydata_frequency)
 {
-	ssize_t	bytes_received;
+	ssize_t			bytes_received;
+	zbx_proxy_data_stream_t	*stream;
+
+	stream = trapper_proxy_data_stream_create(sock, ts, proxydata_frequency);
+
+	if (FAIL != (bytes_received = zbx_tcp_recv_consume(sock, CONFIG_TRAPPER_TIMEOUT, ZBX_TCP_LARGE,
+			NULL != stream ? zbx_proxy_data_stream_consume : NULL, stream)))
+	{
+		zbx_update_selfmon_buffer(info, trapper_buffer_peak(sock, stream));
+
+		process_trap(sock, sock->buffer, bytes_received, ts, stream, config_comms, config_vault,
+				config_startup_time, events_cbs, proxydata_frequency);
+	}
+
+	if (NULL != stream)
+		zbx_proxy_data_stream_free(stream);
+}
+
+#define ZBX_TRAPPER_CONN_ACCEPT	0
+#define ZBX_TRAPPER_CONN_RECV	1
+
+/* multiplexed connections of trapper working in event-driven mode */
+typedef struct
+{
+	struct event_base	*base;
+	struct event		**listen_events;
+	int			listen_events_num;
+	int			listen_enabled;
+	int			timeout;
+	int			connections_num;
+	int			connections_max;
+	int			proxydata_frequency;
+	zbx_vector_ptr_t	received;	/* connections with completely received requests */
+}
+zbx_trapper_loop_t;
+
+typedef struct
+{
+	zbx_socket_t		s;
+	zbx_tcp_recv_context_t	context;
+	zbx_proxy_data_stream_t	*stream;	/* history of 'proxy data' request processed while receiving */
+	zbx_timespec_t		ts;
+	struct event		*event;
+	zbx_trapper_loop_t	*loop;
+	ssize_t			bytes_received;
+	double			deadline;	/* 0 - no deadline */
+	unsigned char		step;
+}
+zbx_trapper_conn_t;
+
+static void	trapper_listen_enable(zbx_trapper_loop_t *loop, int enable)
+{
+	int	i;
+
+	for (i = 0; i < loop->listen_events_num; i++)
+	{
+		if (0 != enable)
+			event_add(loop->listen_events[i], NULL);
+		else
+			event_del(loop->listen_events[i]);
+	}
+
+	loop->listen_enabled = enable;
+}
+
+static void	trapper_conn_free(zbx_trapper_conn_t *conn)
+{
+	zbx_trapper_loop_t	*loop = conn->loop;
+
+	if (ZBX_TRAPPER_CONN_RECV == conn->step)
+		zbx_tcp_recv_context_clear(&conn->context);
+
+	if (NULL != conn->stream)
+		zbx_proxy_data_stream_free(conn->stream);
+
+	zbx_tcp_unaccept(&conn->s);
+	event_free(conn->event);
+	zbx_free(conn);
+
+	loop->connections_num--;
+
+	if (0 == loop->listen_enabled)
+		trapper_listen_enable(loop, 1);
+}
+
+static void	trapper_conn_cb(evutil_socket_t fd, short what, void *arg);
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: wait for connection socket to become ready for the next step      *
+ *                                                                            *
+ * Parameters: conn   - [IN] the connection                                   *
+ *             events - [IN] POLLIN or POLLOUT                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_conn_wait(zbx_trapper_conn_t *conn, short events)
+{
+	struct timeval	tv, *ptv = NULL;
+
+	event_assign(conn->event, conn->loop->base, conn->s.socket, 0 != (events & POLLOUT) ? EV_WRITE : EV_READ,
+			trapper_conn_cb, conn);
+
+	if (0 != conn->deadline)
+	{
+		double	left;
+
+		if (0 > (left = conn->deadline - zbx_time()))
+			left = 0;
+
+		tv.tv_sec = (time_t)left;
+		tv.tv_usec = (suseconds_t)((left - (double)tv.tv_sec) * 1000000);
+		ptv = &tv;
+	}
+
+	event_add(conn->event, ptv);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: continue accepting or receiving request from connection as far as *
+ *          possible without blocking                                         *
+ *                                                                            *
+ * Comments: connection with completely received request is queued for        *
+ *           processing, failed connection is closed                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_conn_process(zbx_trapper_conn_t *conn)
+{
+	short	events;
+
+	if (ZBX_TRAPPER_CONN_ACCEPT == conn->step)
+	{
+		/* Trapper has to accept all types of connections it can accept with the specified configuration. */
+		if (SUCCEED != zbx_tcp_accept_step(&conn->s, ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK |
+				ZBX_TCP_SEC_UNENCRYPTED, &events))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: %s",
+					zbx_socket_strerror());
+			trapper_conn_free(conn);
+			return;
+		}
+
+		if (0 != events)
+		{
+			trapper_conn_wait(conn, events);
+			return;
+		}
+
+		/* get connection timestamp */
+		zbx_timespec(&conn->ts);
+
+		conn->step = ZBX_TRAPPER_CONN_RECV;
+		conn->deadline = zbx_time() + CONFIG_TRAPPER_TIMEOUT;
+		zbx_tcp_recv_context_init(&conn->s, &conn->context, ZBX_TCP_LARGE);
+
+		if (NULL != (conn->stream = trapper_proxy_data_stream_create(&conn->s, &conn->ts,
+				conn->loop->proxydata_frequency)))
+		{
+			zbx_tcp_recv_context_set_consumer(&conn->context, zbx_proxy_data_stream_consume, conn->stream);
+		}
+	}
+
+	if (FAIL == (conn->bytes_received = zbx_tcp_recv_context(&conn->s, &conn->context, &events)))
+	{
+		if (0 != events)
+		{
+			trapper_conn_wait(conn, events);
+			return;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot receive request from %s: %s", conn->s.peer,
+				zbx_socket_strerror());
+		trapper_conn_free(conn);
+		return;
+	}
+
+	zbx_vector_ptr_append(&conn->loop->received, conn);
+}
+
+static void	trapper_conn_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_trapper_conn_t	*conn = (zbx_trapper_conn_t *)arg;
 
-	if (FAIL == (bytes_received = zbx_tcp_recv_ext(sock, CONFIG_TRAPPER_TIMEOUT, ZBX_TCP_LARGE)))
+	ZBX_UNUSED(fd);
+
+	if (0 != (what & EV_TIMEOUT))
+	{
+		if (ZBX_TRAPPER_CONN_ACCEPT == conn->step)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: from %s: timed out",
+					conn->s.peer);
+		}
+		else
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot receive request from %s: timed out", conn->s.peer);
+
+		trapper_conn_free(conn);
 		return;
+	}
+
+	trapper_conn_process(conn);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add accepted connection to the loop and start processing it      *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_conn_start(zbx_trapper_loop_t *loop, zbx_trapper_conn_t *conn)
+{
+	conn->loop = loop;
+	conn->stream = NULL;
+	conn->step = ZBX_TRAPPER_CONN_ACCEPT;
+	conn->deadline = (0 != loop->timeout ? zbx_time() + loop->timeout : 0);
+	conn->event = event_new(loop->base, conn->s.socket, EV_READ, trapper_conn_cb, conn);
+	loop->connections_num++;
+
+	trapper_conn_process(conn);
+}
+
+static void	trapper_listen_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_trapper_loop_t	*loop = (zbx_trapper_loop_t *)arg;
+
+	ZBX_UNUSED(what);
+
+	while (loop->connections_num < loop->connections_max)
+	{
+		zbx_trapper_conn_t	*conn;
+		int			ret;
+
+		conn = (zbx_trapper_conn_t *)zbx_malloc(NULL, sizeof(zbx_trapper_conn_t));
+
+		if (SUCCEED != (ret = zbx_tcp_accept_nowait(fd, &conn->s, loop->timeout)))
+		{
+			if (FAIL == ret)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: %s",
+						zbx_socket_strerror());
+			}
 
-	process_trap(sock, sock->buffer, bytes_received, ts, config_comms, config_vault, config_startup_time,
-			events_cbs, proxydata_frequency);
+			zbx_free(conn);
+			break;
+		}
+
+		trapper_conn_start(loop, conn);
+	}
+
+	if (loop->connections_num == loop->connections_max && 0 != loop->listen_enabled)
+		trapper_listen_enable(loop, 0);
+}
+
+static void	trapper_timer_cb(evutil_socket_t fd, short what, void *arg)
+{
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(what);
+	ZBX_UNUSED(arg);
+}
+
+static void	trapper_loop_init(zbx_trapper_loop_t *loop, const zbx_socket_t *listen_sock, int connections_max,
+		int proxydata_frequency)
+{
+	int	i;
+
+	if (NULL == (loop->base = event_base_new()))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize event base");
+		exit(EXIT_FAILURE);
+	}
+
+	loop->listen_events_num = listen_sock->num_socks;
+	loop->listen_events = (struct event **)zbx_malloc(NULL, sizeof(struct event *) *
+			(size_t)listen_sock->num_socks);
+
+	for (i = 0; i < listen_sock->num_socks; i++)
+	{
+		loop->listen_events[i] = event_new(loop->base, listen_sock->sockets[i], EV_READ | EV_PERSIST,
+				trapper_listen_cb, loop);
+	}
+
+	loop->timeout = listen_sock->timeout;
+	loop->connections_num = 0;
+	loop->connections_max = connections_max;
+	loop->proxydata_frequency = proxydata_frequency;
+	zbx_vector_ptr_create(&loop->received);
+
+	trapper_listen_enable(loop, 1);
 }
 
+#ifdef HAVE_NETSNMP
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process pending runtime control messages                          *
+ *                                                                            *
+ * Return value: SUCCEED - trapper can continue                               *
+ *               FAIL    - trapper must shut down                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	trapper_process_rtc(zbx_ipc_async_socket_t *rtc, const zbx_thread_info_t *info)
+{
+	zbx_uint32_t	rtc_cmd;
+	unsigned char	*rtc_data;
+	int		snmp_reload = 0;
+
+	while (SUCCEED == zbx_rtc_wait(rtc, info, &rtc_cmd, &rtc_data, 0) && 0 != rtc_cmd)
+	{
+		if (ZBX_RTC_SNMP_CACHE_RELOAD == rtc_cmd && 0 == snmp_reload)
+		{
+			zbx_clear_cache_snmp(info->process_type, info->process_num);
+			snmp_reload = 1;
+		}
+		else if (ZBX_RTC_SHUTDOWN == rtc_cmd)
+			return FAIL;
+	}
+
+	return SUCCEED;
+}
+#endif
+
 ZBX_THREAD_ENTRY(trapper_thread, args)
 {
 #define POLL_TIMEOUT	1
@@ -1313,6 +1655,8 @@ ZBX_THREAD_ENTRY(trapper_thread, args)
 	int			server_num = ((zbx_thread_args_t *)args)->info.server_num;
 	int			process_num = ((zbx_thread_args_t *)args)->info.process_num;
 	unsigned char		process_type = ((zbx_thread_args_t *)args)->info.process_type;
+	zbx_trapper_loop_t	loop;
+	struct event		*timer = NULL;
 #ifdef HAVE_NETSNMP
 	zbx_uint32_t		rtc_msgs[] = {ZBX_RTC_SNMP_CACHE_RELOAD};
 	zbx_ipc_async_socket_t	rtc;
@@ -1340,19 +1684,66 @@ ZBX_THREAD_ENTRY(trapper_thread, args)
 			trapper_args_in->config_comms->config_timeout, &rtc);
 #endif
 
-	while (ZBX_IS_RUNNING())
+	/* with more than one connection per trapper requests are received from all connections without blocking */
+	if (1 < trapper_args_in->max_connections)
 	{
-#ifdef HAVE_NETSNMP
-		zbx_uint32_t	rtc_cmd;
-		unsigned char	*rtc_data;
-		int		snmp_reload = 0;
-#endif
+		trapper_loop_init(&loop, &s, trapper_args_in->max_connections, trapper_args_in->proxydata_frequency);
+		timer = evtimer_new(loop.base, trapper_timer_cb, NULL);
+	}
 
+	while (ZBX_IS_RUNNING())
+	{
 		zbx_setproctitle("%s #%d [processed data in " ZBX_FS_DBL " sec, waiting for connection]",
 				get_process_type_string(process_type), process_num, sec);
 
 		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_IDLE);
 
+		if (NULL != timer)
+		{
+			struct timeval	tv = {POLL_TIMEOUT, 0};
+			int		i;
+
+			evtimer_add(timer, &tv);
+			event_base_loop(loop.base, EVLOOP_ONCE);
+			evtimer_del(timer);
+
+			zbx_update_env(get_process_type_string(process_type), zbx_time());
+
+			if (0 == loop.received.values_num)
+				continue;
+
+			zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+
+			zbx_setproctitle("%s #%d [processing data]", get_process_type_string(process_type),
+					process_num);
+#ifdef HAVE_NETSNMP
+			if (SUCCEED != trapper_process_rtc(&rtc, info))
+				goto out;
+#endif
+			sec = zbx_time();
+
+			/* Received requests are still processed synchronously in this process and replies are */
+			/* sent blocking, so other connections are not serviced while a request is processed.  */
+			for (i = 0; i < loop.received.values_num; i++)
+			{
+				zbx_trapper_conn_t	*conn = (zbx_trapper_conn_t *)loop.received.values[i];
+
+				zbx_update_selfmon_buffer(info, trapper_buffer_peak(&conn->s, conn->stream));
+
+				process_trap(&conn->s, conn->s.buffer, conn->bytes_received, &conn->ts, conn->stream,
+						trapper_args_in->config_comms, trapper_args_in->config_vault,
+						trapper_args_in->config_startup_time, trapper_args_in->events_cbs,
+						trapper_args_in->proxydata_frequency);
+
+				trapper_conn_free(conn);
+			}
+
+			zbx_vector_ptr_clear(&loop.received);
+			sec = zbx_time() - sec;
+
+			continue;
+		}
+
 		/* Trapper has to accept all types of connections it can accept with the specified configuration. */
 		/* Only after receiving data it is known who has sent them and one can decide to accept or discard */
 		/* the data. */
@@ -1376,25 +1767,16 @@ ZBX_THREAD_ENTRY(trapper_thread, args)
 					process_num);
 
 #ifdef HAVE_NETSNMP
-			while (SUCCEED == zbx_rtc_wait(&rtc, info, &rtc_cmd, &rtc_data, 0) && 0 != rtc_cmd)
+			if (SUCCEED != trapper_process_rtc(&rtc, info))
 			{
-				if (ZBX_RTC_SNMP_CACHE_RELOAD == rtc_cmd && 0 == snmp_reload)
-				{
-					zbx_clear_cache_snmp(process_type, process_num);
-					snmp_reload = 1;
-				}
-				else if (ZBX_RTC_SHUTDOWN == rtc_cmd)
-				{
-					zbx_tcp_unaccept(&s);
-					goto out;
-				}
-
+				zbx_tcp_unaccept(&s);
+				goto out;
 			}
 #endif
 			sec = zbx_time();
-			process_trapper_child(&s, &ts, trapper_args_in->config_comms, trapper_args_in->config_vault,
-					trapper_args_in->config_startup_time, trapper_args_in->events_cbs,
-					trapper_args_in->proxydata_frequency);
+			process_trapper_child(info, &s, &ts, trapper_args_in->config_comms,
+					trapper_args_in->config_vault, trapper_args_in->config_startup_time,
+					trapper_args_in->events_cbs, trapper_args_in->proxydata_frequency);
 			sec = zbx_time() - sec;
 
 			zbx_tcp_unaccept(&s);
@@ -1415,3 +1797,7 @@ out:
 
 #undef POLL_TIMEOUT
 }
+
+#ifdef HAVE_TESTS
+#	include "../../../tests/zabbix_server/trapper/trapper_loop_test.c"
+#endif
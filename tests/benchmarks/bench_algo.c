@@ -0,0 +1,298 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxbench.h"
+
+#include "zbxalgo.h"
+
+#define BENCH_ALGO_KEYS_NUM	1000000
+
+typedef struct
+{
+	zbx_uint64_t	id;
+	zbx_uint64_t	value;
+}
+bench_algo_obj_t;
+
+static zbx_uint64_t	*bench_algo_create_keys(zbx_bench_t *bench, zbx_uint64_t num)
+{
+	zbx_uint64_t	*keys;
+
+	keys = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * num);
+
+	/* item/trigger identifiers are mostly sequential with gaps */
+	for (zbx_uint64_t i = 0; i < num; i++)
+		keys[i] = i * 4 + zbx_bench_rand(bench) % 4 + 1;
+
+	/* shuffle keys to avoid sequential access */
+	for (zbx_uint64_t i = num - 1; 0 < i; i--)
+	{
+		zbx_uint64_t	j = zbx_bench_rand(bench) % (i + 1), tmp = keys[i];
+
+		keys[i] = keys[j];
+		keys[j] = tmp;
+	}
+
+	return keys;
+}
+
+static zbx_uint64_t	bench_hashset_insert(zbx_bench_t *bench)
+{
+	zbx_hashset_t	hs;
+	zbx_uint64_t	*keys, num = zbx_bench_scale(bench, BENCH_ALGO_KEYS_NUM);
+
+	keys = bench_algo_create_keys(bench, num);
+
+	zbx_bench_start(bench);
+
+	zbx_hashset_create(&hs, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+	{
+		bench_algo_obj_t	obj = {keys[i], i};
+
+		zbx_hashset_insert(&hs, &obj, sizeof(obj));
+	}
+
+	zbx_bench_stop(bench);
+
+	zbx_hashset_destroy(&hs);
+	zbx_free(keys);
+
+	return num;
+}
+
+static zbx_uint64_t	bench_hashset_search(zbx_bench_t *bench)
+{
+	zbx_hashset_t	hs;
+	zbx_uint64_t	*keys, num = zbx_bench_scale(bench, BENCH_ALGO_KEYS_NUM), found = 0;
+
+	keys = bench_algo_create_keys(bench, num);
+	zbx_hashset_create(&hs, num, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	/* insert every second key to have both hits and misses */
+	for (zbx_uint64_t i = 0; i < num; i += 2)
+	{
+		bench_algo_obj_t	obj = {keys[i], i};
+
+		zbx_hashset_insert(&hs, &obj, sizeof(obj));
+	}
+
+	zbx_bench_start(bench);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+	{
+		if (NULL != zbx_hashset_search(&hs, &keys[i]))
+			found++;
+	}
+
+	zbx_bench_stop(bench);
+
+	if (found != (num + 1) / 2)
+		THIS_SHOULD_NEVER_HAPPEN;
+
+	zbx_hashset_destroy(&hs);
+	zbx_free(keys);
+
+	return num;
+}
+
+static zbx_uint64_t	bench_hashset_remove(zbx_bench_t *bench)
+{
+	zbx_hashset_t	hs;
+	zbx_uint64_t	*keys, num = zbx_bench_scale(bench, BENCH_ALGO_KEYS_NUM);
+
+	keys = bench_algo_create_keys(bench, num);
+	zbx_hashset_create(&hs, num, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+	{
+		bench_algo_obj_t	obj = {keys[i], i};
+
+		zbx_hashset_insert(&hs, &obj, sizeof(obj));
+	}
+
+	zbx_bench_start(bench);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+		zbx_hashset_remove(&hs, &keys[i]);
+
+	zbx_bench_stop(bench);
+
+	zbx_hashset_destroy(&hs);
+	zbx_free(keys);
+
+	return num;
+}
+
+static zbx_uint64_t	bench_vector_append(zbx_bench_t *bench)
+{
+	zbx_vector_uint64_t	ids;
+	zbx_uint64_t		num = zbx_bench_scale(bench, BENCH_ALGO_KEYS_NUM * 10);
+
+	zbx_bench_start(bench);
+
+	zbx_vector_uint64_create(&ids);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+		zbx_vector_uint64_append(&ids, i);
+
+	zbx_bench_stop(bench);
+
+	zbx_vector_uint64_destroy(&ids);
+
+	return num;
+}
+
+static zbx_uint64_t	bench_vector_sort_uniq(zbx_bench_t *bench)
+{
+	zbx_vector_uint64_t	ids;
+	zbx_uint64_t		num = zbx_bench_scale(bench, BENCH_ALGO_KEYS_NUM);
+
+	zbx_vector_uint64_create(&ids);
+	zbx_vector_uint64_reserve(&ids, (size_t)num);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+		zbx_vector_uint64_append(&ids, zbx_bench_rand(bench) % num);
+
+	zbx_bench_start(bench);
+
+	zbx_vector_uint64_sort(&ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_bench_stop(bench);
+
+	zbx_vector_uint64_destroy(&ids);
+
+	return num;
+}
+
+static zbx_uint64_t	bench_vector_bsearch(zbx_bench_t *bench)
+{
+	zbx_vector_uint64_t	ids;
+	zbx_uint64_t		*keys, num = zbx_bench_scale(bench, BENCH_ALGO_KEYS_NUM), found = 0;
+
+	keys = bench_algo_create_keys(bench, num);
+
+	zbx_vector_uint64_create(&ids);
+	zbx_vector_uint64_append_array(&ids, keys, (int)num);
+	zbx_vector_uint64_sort(&ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_bench_start(bench);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+	{
+		if (FAIL != zbx_vector_uint64_bsearch(&ids, keys[i], ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+			found++;
+	}
+
+	zbx_bench_stop(bench);
+
+	if (found != num)
+		THIS_SHOULD_NEVER_HAPPEN;
+
+	zbx_vector_uint64_destroy(&ids);
+	zbx_free(keys);
+
+	return num;
+}
+
+static int	bench_heap_compare(const void *d1, const void *d2)
+{
+	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
+	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL((uintptr_t)e1->data, (uintptr_t)e2->data);
+
+	return 0;
+}
+
+/* simulates scheduler queue - items are popped and reinserted with the next check time */
+static zbx_uint64_t	bench_binary_heap_schedule(zbx_bench_t *bench)
+{
+	zbx_binary_heap_t	heap;
+	zbx_uint64_t		num = zbx_bench_scale(bench, BENCH_ALGO_KEYS_NUM / 4), ops = num * 4;
+
+	zbx_binary_heap_create(&heap, bench_heap_compare, ZBX_BINARY_HEAP_OPTION_DIRECT);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+	{
+		zbx_binary_heap_elem_t	elem = {i + 1, (void *)(uintptr_t)(zbx_bench_rand(bench) % 3600)};
+
+		zbx_binary_heap_insert(&heap, &elem);
+	}
+
+	zbx_bench_start(bench);
+
+	for (zbx_uint64_t i = 0; i < ops; i++)
+	{
+		zbx_binary_heap_elem_t	*min, elem;
+
+		min = zbx_binary_heap_find_min(&heap);
+		elem.key = min->key;
+		elem.data = (void *)((uintptr_t)min->data + 1 + zbx_bench_rand(bench) % 300);
+		zbx_binary_heap_update_direct(&heap, &elem);
+	}
+
+	zbx_bench_stop(bench);
+
+	zbx_binary_heap_destroy(&heap);
+
+	return ops;
+}
+
+static zbx_uint64_t	bench_queue_ptr(zbx_bench_t *bench)
+{
+	zbx_queue_ptr_t	queue;
+	zbx_uint64_t	num = zbx_bench_scale(bench, BENCH_ALGO_KEYS_NUM * 4);
+
+	zbx_bench_start(bench);
+
+	zbx_queue_ptr_create(&queue);
+
+	/* keep queue partially filled so that it wraps around */
+	for (zbx_uint64_t i = 0; i < num; i++)
+	{
+		zbx_queue_ptr_push(&queue, (void *)(uintptr_t)(i + 1));
+
+		if (1 == i % 2)
+		{
+			zbx_queue_ptr_pop(&queue);
+			zbx_queue_ptr_pop(&queue);
+		}
+	}
+
+	zbx_bench_stop(bench);
+
+	zbx_queue_ptr_destroy(&queue);
+
+	return num;
+}
+
+zbx_bench_case_t	bench_algo_cases[] = {
+	{"algo.hashset.insert", bench_hashset_insert},
+	{"algo.hashset.search", bench_hashset_search},
+	{"algo.hashset.remove", bench_hashset_remove},
+	{"algo.vector_uint64.append", bench_vector_append},
+	{"algo.vector_uint64.sort_uniq", bench_vector_sort_uniq},
+	{"algo.vector_uint64.bsearch", bench_vector_bsearch},
+	{"algo.binary_heap.schedule", bench_binary_heap_schedule},
+	{"algo.queue_ptr.push_pop", bench_queue_ptr},
+	{NULL}
+};
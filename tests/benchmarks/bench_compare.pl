@@ -0,0 +1,83 @@
+#!/usr/bin/env perl
+
+use strict;
+use warnings;
+
+use JSON::PP qw(decode_json);
+use Getopt::Long qw(GetOptions);
+use Pod::Usage;
+
+use constant BENCH_FORMAT_VERSION	=> 1;
+use constant RESULT_HEADER_FORMAT	=> " %-40s │ %12s │ %12s │ %8s │ %10s │ %10s\n";
+use constant RESULT_FORMAT		=> " %-40s │ %12.1f │ %12.1f │ %+7.1f%% │ %10.3f │ %10.3f %s\n";
+
+sub load_results($)
+{
+	my $file = shift;
+
+	open(my $fh, '<', $file) or die("cannot open \"$file\": $!\n");
+	local $/;
+	my $data = decode_json(<$fh>);
+	close($fh);
+
+	die("unsupported benchmark format version in \"$file\"\n") if ($data->{'version'} != BENCH_FORMAT_VERSION);
+
+	return {map { $_->{'name'} => $_ } @{$data->{'results'}}};
+}
+
+my $threshold = 10;
+
+GetOptions('threshold=f' => \$threshold, 'help' => sub { pod2usage(-verbose => 1, -exitval => 0) })
+		or pod2usage(2);
+
+pod2usage(2) unless (@ARGV == 2);
+
+my $base = load_results($ARGV[0]);
+my $current = load_results($ARGV[1]);
+my $regressions = 0;
+
+printf(RESULT_HEADER_FORMAT, 'case', 'base ns/op', 'ns/op', 'change', 'base alloc', 'allocs/op');
+
+foreach my $name (sort(keys(%{$current})))
+{
+	next unless (exists($base->{$name}));
+
+	my $old = $base->{$name};
+	my $new = $current->{$name};
+	my $change = 0 == $old->{'ns_per_op'} ? 0 : ($new->{'ns_per_op'} / $old->{'ns_per_op'} - 1) * 100;
+	my $mark = '';
+
+	if ($change > $threshold || $new->{'allocs_per_op'} > $old->{'allocs_per_op'})
+	{
+		$mark = 'REGRESSION';
+		$regressions++;
+	}
+
+	printf(RESULT_FORMAT, $name, $old->{'ns_per_op'}, $new->{'ns_per_op'}, $change, $old->{'allocs_per_op'},
+			$new->{'allocs_per_op'}, $mark);
+}
+
+exit($regressions == 0 ? 0 : 1);
+
+__END__
+
+=head1 NAME
+
+bench_compare.pl - compare zbx_benchmark results of two builds
+
+=head1 SYNOPSIS
+
+bench_compare.pl [--threshold <percent>] <base.json> <current.json>
+
+=head1 OPTIONS
+
+=over 8
+
+=item B<--threshold> I<percent>
+
+Report cases where ns/op increased by more than the given percentage (default 10). Any increase of allocations per
+operation is always reported. Exits with non-zero status if regressions were found.
+
+=back
+
+=cut
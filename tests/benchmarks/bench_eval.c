@@ -0,0 +1,199 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxbench.h"
+
+#include "zbxeval.h"
+#include "zbxvariant.h"
+
+#define BENCH_EVAL_EXPRESSIONS_NUM	100000
+
+/* trigger expressions with history functions replaced by functionids, as they are stored in configuration cache */
+static const char	*bench_trigger_expressions[] = {
+	"{100001}>90",
+	"{100002}<10 and {100003}>0",
+	"({100004}+{100005})/2>75.5 or {100006}=1",
+	"abs({100007}-{100008})>5 and not {100009}=0",
+	"{100010}>1K and ({100011}/{100012}*100)<20 or {100013}<>1",
+	"min({100014},{100015},{100016})>=5.5e3 and max({100017},{100018})<1G",
+	NULL
+};
+
+/* calculated item expressions without history functions */
+static const char	*bench_calc_expressions[] = {
+	"(1+2)*3/4-5>0",
+	"length(\"abcdef\")=6 and left(\"abcdef\",3)=\"abc\"",
+	"round(10.12345,2)*100+mod(17,5)-power(2,10)",
+	"bitand(255,15)=15 or between(5,1,10)=1",
+	NULL
+};
+
+static zbx_uint64_t	bench_eval_parse(zbx_bench_t *bench, const char **expressions, zbx_uint64_t rules)
+{
+	zbx_eval_context_t	ctx;
+	zbx_uint64_t		num = zbx_bench_scale(bench, BENCH_EVAL_EXPRESSIONS_NUM), i, expressions_num;
+	char			*error = NULL;
+
+	for (expressions_num = 0; NULL != expressions[expressions_num]; expressions_num++)
+		;
+
+	zbx_bench_start(bench);
+
+	for (i = 0; i < num; i++)
+	{
+		const char	*expression = expressions[i % expressions_num];
+
+		if (SUCCEED != zbx_eval_parse_expression(&ctx, expression, rules, &error))
+		{
+			printf("cannot parse expression \"%s\": %s\n", expression, error);
+			zbx_free(error);
+			break;
+		}
+
+		zbx_eval_clear(&ctx);
+	}
+
+	zbx_bench_stop(bench);
+
+	return i;
+}
+
+static zbx_uint64_t	bench_eval_parse_trigger(zbx_bench_t *bench)
+{
+	return bench_eval_parse(bench, bench_trigger_expressions, ZBX_EVAL_TRIGGER_EXPRESSION);
+}
+
+static zbx_uint64_t	bench_eval_parse_calc(zbx_bench_t *bench)
+{
+	return bench_eval_parse(bench, bench_calc_expressions, ZBX_EVAL_PARSE_CALC_EXPRESSION);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes pre-parsed expressions, as done during trigger           *
+ *          recalculation after new values are received                       *
+ *                                                                            *
+ * Parameters: bench       - [IN] the benchmark                               *
+ *             expressions - [IN] the expressions to execute                  *
+ *             rules       - [IN] the expression parsing rules                *
+ *             compile     - [IN] 1 - execute compiled instructions, as done  *
+ *                                for expressions deserialized from           *
+ *                                configuration cache                         *
+ *                                0 - interpret the token stack               *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	bench_eval_execute(zbx_bench_t *bench, const char **expressions, zbx_uint64_t rules,
+		int compile)
+{
+	zbx_eval_context_t	*ctxs;
+	zbx_uint64_t		num = zbx_bench_scale(bench, BENCH_EVAL_EXPRESSIONS_NUM * 10), ops = 0;
+	int			ctxs_num;
+	zbx_timespec_t		ts = {0, 0};
+	zbx_variant_t		value;
+	char			*error = NULL;
+
+	for (ctxs_num = 0; NULL != expressions[ctxs_num]; ctxs_num++)
+		;
+
+	ctxs = (zbx_eval_context_t *)zbx_malloc(NULL, sizeof(zbx_eval_context_t) * (size_t)ctxs_num);
+
+	for (int i = 0; i < ctxs_num; i++)
+	{
+		if (SUCCEED != zbx_eval_parse_expression(&ctxs[i], expressions[i], rules, &error))
+		{
+			printf("cannot parse expression \"%s\": %s\n", expressions[i], error);
+			zbx_free(error);
+
+			for (int k = 0; k < i; k++)
+				zbx_eval_clear(&ctxs[k]);
+
+			zbx_free(ctxs);
+
+			return 0;
+		}
+
+		for (int k = 0; k < ctxs[i].stack.values_num; k++)
+		{
+			zbx_eval_token_t	*token = &ctxs[i].stack.values[k];
+
+			if (ZBX_EVAL_TOKEN_FUNCTIONID != token->type)
+				continue;
+
+			zbx_variant_clear(&token->value);
+			zbx_variant_set_dbl(&token->value, (double)(zbx_bench_rand(bench) % 200));
+		}
+
+		if (0 != compile)
+			zbx_eval_compile(&ctxs[i]);
+	}
+
+	zbx_bench_start(bench);
+
+	for (; ops < num; ops++)
+	{
+		if (SUCCEED != zbx_eval_execute(&ctxs[ops % (zbx_uint64_t)ctxs_num], &ts, &value, &error))
+		{
+			printf("cannot execute expression \"%s\": %s\n", ctxs[ops % (zbx_uint64_t)ctxs_num].expression,
+					error);
+			zbx_free(error);
+			break;
+		}
+
+		zbx_variant_clear(&value);
+	}
+
+	zbx_bench_stop(bench);
+
+	for (int i = 0; i < ctxs_num; i++)
+		zbx_eval_clear(&ctxs[i]);
+
+	zbx_free(ctxs);
+
+	return ops;
+}
+
+static zbx_uint64_t	bench_eval_execute_trigger(zbx_bench_t *bench)
+{
+	return bench_eval_execute(bench, bench_trigger_expressions, ZBX_EVAL_TRIGGER_EXPRESSION, 0);
+}
+
+static zbx_uint64_t	bench_eval_execute_calc(zbx_bench_t *bench)
+{
+	return bench_eval_execute(bench, bench_calc_expressions, ZBX_EVAL_PARSE_CALC_EXPRESSION, 0);
+}
+
+static zbx_uint64_t	bench_eval_execute_trigger_compiled(zbx_bench_t *bench)
+{
+	return bench_eval_execute(bench, bench_trigger_expressions, ZBX_EVAL_TRIGGER_EXPRESSION, 1);
+}
+
+static zbx_uint64_t	bench_eval_execute_calc_compiled(zbx_bench_t *bench)
+{
+	return bench_eval_execute(bench, bench_calc_expressions, ZBX_EVAL_PARSE_CALC_EXPRESSION, 1);
+}
+
+zbx_bench_case_t	bench_eval_cases[] = {
+	{"eval.parse.trigger", bench_eval_parse_trigger},
+	{"eval.parse.calc", bench_eval_parse_calc},
+	{"eval.execute.trigger", bench_eval_execute_trigger},
+	{"eval.execute.calc", bench_eval_execute_calc},
+	{"eval.execute.trigger.compiled", bench_eval_execute_trigger_compiled},
+	{"eval.execute.calc.compiled", bench_eval_execute_calc_compiled},
+	{NULL}
+};
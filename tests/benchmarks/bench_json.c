@@ -0,0 +1,209 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxbench.h"
+
+#include "zbxjson.h"
+#include "zbxstr.h"
+
+#define BENCH_JSON_OBJECTS_NUM	1000
+#define BENCH_JSON_QUERIES_NUM	200
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates JSON document, similar to the ones returned by HTTP agent *
+ *          master items for dependent item preprocessing                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_json_create_document(zbx_bench_t *bench, struct zbx_json *j)
+{
+	char	buf[64];
+
+	zbx_json_init(j, ZBX_JSON_STAT_BUF_LEN);
+	zbx_json_addstring(j, "version", "1.2.3", ZBX_JSON_TYPE_STRING);
+	zbx_json_addarray(j, "items");
+
+	for (int i = 0; i < BENCH_JSON_OBJECTS_NUM; i++)
+	{
+		zbx_json_addobject(j, NULL);
+		zbx_json_adduint64(j, "id", (zbx_uint64_t)i);
+		zbx_snprintf(buf, sizeof(buf), "host-%d.example.com", i);
+		zbx_json_addstring(j, "name", buf, ZBX_JSON_TYPE_STRING);
+		zbx_json_adduint64(j, "status", zbx_bench_rand(bench) % 3);
+
+		zbx_json_addobject(j, "metrics");
+		zbx_json_addfloat(j, "cpu", (double)(zbx_bench_rand(bench) % 10000) / 100);
+		zbx_json_adduint64(j, "memory", zbx_bench_rand(bench) % __UINT64_C(68719476736));
+		zbx_json_adduint64(j, "uptime", zbx_bench_rand(bench) % 10000000);
+		zbx_json_close(j);
+
+		zbx_json_addarray(j, "tags");
+
+		for (int k = 0; k < 3; k++)
+		{
+			zbx_json_addobject(j, NULL);
+			zbx_snprintf(buf, sizeof(buf), "tag%d", k);
+			zbx_json_addstring(j, "tag", buf, ZBX_JSON_TYPE_STRING);
+			zbx_snprintf(buf, sizeof(buf), "value%d", (int)(zbx_bench_rand(bench) % 10));
+			zbx_json_addstring(j, "value", buf, ZBX_JSON_TYPE_STRING);
+			zbx_json_close(j);
+		}
+
+		zbx_json_close(j);
+		zbx_json_close(j);
+	}
+
+	zbx_json_close(j);
+}
+
+static zbx_uint64_t	bench_json_parse(zbx_bench_t *bench)
+{
+	struct zbx_json	j;
+	zbx_jsonobj_t	obj;
+	zbx_uint64_t	num = zbx_bench_scale(bench, BENCH_JSON_QUERIES_NUM);
+
+	bench_json_create_document(bench, &j);
+
+	zbx_bench_start(bench);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+	{
+		if (SUCCEED != zbx_jsonobj_open(j.buffer, &obj))
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			break;
+		}
+
+		zbx_jsonobj_clear(&obj);
+	}
+
+	zbx_bench_stop(bench);
+
+	zbx_json_free(&j);
+
+	return num;
+}
+
+static zbx_uint64_t	bench_jsonpath_query(zbx_bench_t *bench, const char *path)
+{
+	struct zbx_json		j;
+	struct zbx_json_parse	jp;
+	zbx_uint64_t		num = zbx_bench_scale(bench, BENCH_JSON_QUERIES_NUM);
+	char			*output = NULL;
+
+	bench_json_create_document(bench, &j);
+
+	if (SUCCEED != zbx_json_open(j.buffer, &jp))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		zbx_json_free(&j);
+		return 0;
+	}
+
+	zbx_bench_start(bench);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+	{
+		if (SUCCEED != zbx_jsonpath_query(&jp, path, &output))
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			break;
+		}
+
+		zbx_free(output);
+	}
+
+	zbx_bench_stop(bench);
+
+	zbx_json_free(&j);
+
+	return num;
+}
+
+static zbx_uint64_t	bench_jsonpath_query_simple(zbx_bench_t *bench)
+{
+	return bench_jsonpath_query(bench, "$.items[500].metrics.cpu");
+}
+
+static zbx_uint64_t	bench_jsonpath_query_filter(zbx_bench_t *bench)
+{
+	return bench_jsonpath_query(bench, "$.items[?(@.name == \"host-750.example.com\")].metrics.memory.first()");
+}
+
+static zbx_uint64_t	bench_jsonpath_query_aggregate(zbx_bench_t *bench)
+{
+	return bench_jsonpath_query(bench, "$.items[?(@.status == 1)].metrics.cpu.avg()");
+}
+
+/* dependent items querying the same master item value with jsonpath index */
+static zbx_uint64_t	bench_jsonpath_query_indexed(zbx_bench_t *bench)
+{
+	struct zbx_json		j;
+	zbx_jsonobj_t		obj;
+	zbx_jsonpath_index_t	*index;
+	zbx_uint64_t		num = zbx_bench_scale(bench, BENCH_JSON_QUERIES_NUM * 100);
+	char			*output = NULL, *error = NULL, path[128];
+
+	bench_json_create_document(bench, &j);
+
+	if (SUCCEED != zbx_jsonobj_open(j.buffer, &obj))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		zbx_json_free(&j);
+		return 0;
+	}
+
+	zbx_bench_start(bench);
+
+	index = zbx_jsonpath_index_create(&error);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+	{
+		zbx_snprintf(path, sizeof(path), "$.items[?(@.name == \"host-%d.example.com\")].metrics.cpu.first()",
+				(int)(i % BENCH_JSON_OBJECTS_NUM));
+
+		if (SUCCEED != zbx_jsonobj_query_ext(&obj, index, path, &output))
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			break;
+		}
+
+		zbx_free(output);
+	}
+
+	if (NULL != index)
+		zbx_jsonpath_index_free(index);
+
+	zbx_bench_stop(bench);
+
+	zbx_free(error);
+	zbx_jsonobj_clear(&obj);
+	zbx_json_free(&j);
+
+	return num;
+}
+
+zbx_bench_case_t	bench_json_cases[] = {
+	{"json.jsonobj.open", bench_json_parse},
+	{"json.jsonpath.query_simple", bench_jsonpath_query_simple},
+	{"json.jsonpath.query_filter", bench_jsonpath_query_filter},
+	{"json.jsonpath.query_aggregate", bench_jsonpath_query_aggregate},
+	{"json.jsonpath.query_indexed", bench_jsonpath_query_indexed},
+	{NULL}
+};
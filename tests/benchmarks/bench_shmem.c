@@ -0,0 +1,112 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxbench.h"
+
+#include "zbxshmem.h"
+
+#define BENCH_SHMEM_SIZE	(64 * ZBX_MEBIBYTE)
+#define BENCH_SHMEM_OPS_NUM	1000000
+
+/* the number of live allocations, replaced in random order - the same workload is */
+/* checked for correctness by REPLACE cases of tests/libs/zbxshmem/shmem_slabs      */
+#define BENCH_SHMEM_SLOTS_NUM	50000
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: replaces random live allocations, simulating configuration and    *
+ *          value cache updates                                               *
+ *                                                                            *
+ * Parameters: bench    - [IN] the benchmark                                  *
+ *             size_max - [IN] the maximum allocation size                    *
+ *             slabs    - [IN] 1 - enable slab allocator                      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	bench_shmem_malloc_free(zbx_bench_t *bench, size_t size_max, int slabs)
+{
+	zbx_shmem_info_t	*info;
+	void			**slots;
+	zbx_uint64_t		num = zbx_bench_scale(bench, BENCH_SHMEM_OPS_NUM);
+	char			*error = NULL;
+
+	if (SUCCEED != zbx_shmem_create(&info, BENCH_SHMEM_SIZE, "benchmark", "benchmark", 0, &error))
+	{
+		printf("cannot create shared memory: %s\n", error);
+		zbx_free(error);
+		return 0;
+	}
+
+	if (0 != slabs && SUCCEED != zbx_shmem_enable_slabs(info, &error))
+	{
+		printf("cannot enable slabs: %s\n", error);
+		zbx_free(error);
+		zbx_shmem_destroy(info);
+		return 0;
+	}
+
+	slots = (void **)zbx_malloc(NULL, sizeof(void *) * BENCH_SHMEM_SLOTS_NUM);
+
+	for (int i = 0; i < BENCH_SHMEM_SLOTS_NUM; i++)
+		slots[i] = zbx_shmem_malloc(info, NULL, 8 + zbx_bench_rand(bench) % size_max);
+
+	zbx_bench_start(bench);
+
+	for (zbx_uint64_t i = 0; i < num; i++)
+	{
+		int	slot = (int)(zbx_bench_rand(bench) % BENCH_SHMEM_SLOTS_NUM);
+
+		zbx_shmem_free(info, slots[slot]);
+		slots[slot] = zbx_shmem_malloc(info, NULL, 8 + zbx_bench_rand(bench) % size_max);
+	}
+
+	zbx_bench_stop(bench);
+
+	zbx_free(slots);
+	zbx_shmem_destroy(info);
+
+	return num;
+}
+
+static zbx_uint64_t	bench_shmem_small(zbx_bench_t *bench)
+{
+	return bench_shmem_malloc_free(bench, 120, 0);
+}
+
+static zbx_uint64_t	bench_shmem_small_slabs(zbx_bench_t *bench)
+{
+	return bench_shmem_malloc_free(bench, 120, 1);
+}
+
+static zbx_uint64_t	bench_shmem_mixed(zbx_bench_t *bench)
+{
+	return bench_shmem_malloc_free(bench, 1000, 0);
+}
+
+static zbx_uint64_t	bench_shmem_mixed_slabs(zbx_bench_t *bench)
+{
+	return bench_shmem_malloc_free(bench, 1000, 1);
+}
+
+zbx_bench_case_t	bench_shmem_cases[] = {
+	{"shmem.malloc_free.small", bench_shmem_small},
+	{"shmem.malloc_free.small_slabs", bench_shmem_small_slabs},
+	{"shmem.malloc_free.mixed", bench_shmem_mixed},
+	{"shmem.malloc_free.mixed_slabs", bench_shmem_mixed_slabs},
+	{NULL}
+};
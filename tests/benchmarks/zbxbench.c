@@ -0,0 +1,371 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxbench.h"
+
+#include "zbxjson.h"
+#include "zbxnum.h"
+#include "zbxstr.h"
+
+/* the benchmark output format version, increased when fields are changed */
+#define ZBX_BENCH_FORMAT_VERSION	1
+
+#define ZBX_BENCH_DEFAULT_REPEAT	3
+
+/* seed for synthetic data generator, fixed to make workloads reproducible */
+#define ZBX_BENCH_SEED	__UINT64_C(0x9e3779b97f4a7c15)
+
+const char	*progname = "zbx_benchmark";
+const char	title_message[] = "zbx_benchmark";
+const char	*usage_message[] = {"[-f filter] [-r repeat] [-s scale] [-o output.json]", NULL};
+const char	*help_message[] = {NULL};
+const char	syslog_app_name[] = "zbx_benchmark";
+
+/* server configuration referenced by the linked libraries, not used by benchmarks */
+char	*CONFIG_SSL_CA_LOCATION			= NULL;
+char	*CONFIG_SSL_CERT_LOCATION		= NULL;
+char	*CONFIG_SSL_KEY_LOCATION		= NULL;
+char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
+char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
+int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+int	CONFIG_ALLOW_UNSUPPORTED_DB_VERSIONS	= 0;
+int	CONFIG_TCP_MAX_BACKLOG_SIZE		= SOMAXCONN;
+
+/* allocation counters, updated by zbx_malloc2(), zbx_realloc2() and zbx_strdup2() wrappers */
+static zbx_uint64_t	alloc_num, alloc_bytes;
+
+struct zbx_bench
+{
+	zbx_uint64_t	scale;
+	zbx_uint64_t	seed;
+
+	struct timespec	start;
+	zbx_uint64_t	alloc_num_start;
+	zbx_uint64_t	alloc_bytes_start;
+
+	zbx_uint64_t	ns;
+	zbx_uint64_t	alloc_num;
+	zbx_uint64_t	alloc_bytes;
+};
+
+typedef struct
+{
+	const char	*name;
+	zbx_uint64_t	ops;
+	zbx_uint64_t	ns_min;
+	zbx_uint64_t	ns_total;
+	zbx_uint64_t	alloc_num;
+	zbx_uint64_t	alloc_bytes;
+	int		repeat;
+}
+zbx_bench_result_t;
+
+void	*__real_zbx_malloc2(const char *filename, int line, void *old, size_t size);
+void	*__real_zbx_realloc2(const char *filename, int line, void *old, size_t size);
+char	*__real_zbx_strdup2(const char *filename, int line, char *old, const char *str);
+
+void	*__wrap_zbx_malloc2(const char *filename, int line, void *old, size_t size)
+{
+	alloc_num++;
+	alloc_bytes += size;
+
+	return __real_zbx_malloc2(filename, line, old, size);
+}
+
+void	*__wrap_zbx_realloc2(const char *filename, int line, void *old, size_t size)
+{
+	alloc_num++;
+	alloc_bytes += size;
+
+	return __real_zbx_realloc2(filename, line, old, size);
+}
+
+char	*__wrap_zbx_strdup2(const char *filename, int line, char *old, const char *str)
+{
+	alloc_num++;
+	alloc_bytes += strlen(str) + 1;
+
+	return __real_zbx_strdup2(filename, line, old, str);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts benchmark case measurement                                 *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_bench_start(zbx_bench_t *bench)
+{
+	bench->alloc_num_start = alloc_num;
+	bench->alloc_bytes_start = alloc_bytes;
+	clock_gettime(CLOCK_MONOTONIC, &bench->start);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: stops benchmark case measurement                                  *
+ *                                                                            *
+ * Comments: The measurement can be started and stopped several times to      *
+ *           exclude data preparation from results.                           *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_bench_stop(zbx_bench_t *bench)
+{
+	struct timespec	end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	bench->ns += (zbx_uint64_t)(end.tv_sec - bench->start.tv_sec) * 1000000000 + end.tv_nsec -
+			bench->start.tv_nsec;
+	bench->alloc_num += alloc_num - bench->alloc_num_start;
+	bench->alloc_bytes += alloc_bytes - bench->alloc_bytes_start;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: scales the base number of case operations                         *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_bench_scale(const zbx_bench_t *bench, zbx_uint64_t num)
+{
+	return num * bench->scale;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets pseudo random number generator to the initial state        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_bench_seed(zbx_bench_t *bench)
+{
+	bench->seed = ZBX_BENCH_SEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the next pseudo random number (splitmix64)                *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_bench_rand(zbx_bench_t *bench)
+{
+	zbx_uint64_t	z;
+
+	z = (bench->seed += __UINT64_C(0x9e3779b97f4a7c15));
+	z = (z ^ (z >> 30)) * __UINT64_C(0xbf58476d1ce4e5b9);
+	z = (z ^ (z >> 27)) * __UINT64_C(0x94d049bb133111eb);
+
+	return z ^ (z >> 31);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: runs benchmark case the specified number of times                 *
+ *                                                                            *
+ * Parameters: bench_case - [IN] the benchmark case                           *
+ *             scale      - [IN] the workload scale                           *
+ *             repeat     - [IN] the number of runs                           *
+ *             result     - [OUT] the benchmark result                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_run_case(const zbx_bench_case_t *bench_case, zbx_uint64_t scale, int repeat,
+		zbx_bench_result_t *result)
+{
+	memset(result, 0, sizeof(zbx_bench_result_t));
+	result->name = bench_case->name;
+	result->repeat = repeat;
+	result->ns_min = ZBX_MAX_UINT64;
+
+	for (int i = 0; i < repeat; i++)
+	{
+		zbx_bench_t	bench;
+
+		memset(&bench, 0, sizeof(bench));
+		bench.scale = scale;
+		zbx_bench_seed(&bench);
+
+		result->ops = bench_case->func(&bench);
+
+		if (bench.ns < result->ns_min)
+			result->ns_min = bench.ns;
+
+		result->ns_total += bench.ns;
+
+		/* workloads are deterministic, so allocations match between runs */
+		result->alloc_num = bench.alloc_num;
+		result->alloc_bytes = bench.alloc_bytes;
+	}
+}
+
+static double	bench_ns_per_op(const zbx_bench_result_t *result)
+{
+	return 0 == result->ops ? 0 : (double)result->ns_min / result->ops;
+}
+
+static double	bench_ops_per_sec(const zbx_bench_result_t *result)
+{
+	return 0 == result->ns_min ? 0 : (double)result->ops * 1000000000 / result->ns_min;
+}
+
+static double	bench_per_op(const zbx_bench_result_t *result, zbx_uint64_t value)
+{
+	return 0 == result->ops ? 0 : (double)value / result->ops;
+}
+
+static void	bench_print_result(const zbx_bench_result_t *result)
+{
+	char	ops[MAX_ID_LEN + 1];
+
+	zbx_snprintf(ops, sizeof(ops), ZBX_FS_UI64, result->ops);
+	printf("%-40s %12s %12.1f %14.0f %10.3f %12.1f\n", result->name, ops,
+			bench_ns_per_op(result), bench_ops_per_sec(result), bench_per_op(result, result->alloc_num),
+			bench_per_op(result, result->alloc_bytes));
+	fflush(stdout);
+}
+
+static void	bench_json_add_result(struct zbx_json *j, const zbx_bench_result_t *result)
+{
+	zbx_json_addobject(j, NULL);
+	zbx_json_addstring(j, "name", result->name, ZBX_JSON_TYPE_STRING);
+	zbx_json_adduint64(j, "ops", result->ops);
+	zbx_json_adduint64(j, "repeat", (zbx_uint64_t)result->repeat);
+	zbx_json_adduint64(j, "ns_min", result->ns_min);
+	zbx_json_adduint64(j, "ns_avg", result->ns_total / (zbx_uint64_t)result->repeat);
+	zbx_json_addfloat(j, "ns_per_op", bench_ns_per_op(result));
+	zbx_json_addfloat(j, "ops_per_sec", bench_ops_per_sec(result));
+	zbx_json_adduint64(j, "allocs", result->alloc_num);
+	zbx_json_addfloat(j, "allocs_per_op", bench_per_op(result, result->alloc_num));
+	zbx_json_addfloat(j, "bytes_per_op", bench_per_op(result, result->alloc_bytes));
+	zbx_json_close(j);
+}
+
+static int	bench_write_output(const char *filename, const struct zbx_json *j)
+{
+	FILE	*f;
+	int	ret = FAIL;
+
+	if (NULL == (f = fopen(filename, "w")))
+	{
+		fprintf(stderr, "cannot open output file \"%s\": %s\n", filename, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (j->buffer_size == fwrite(j->buffer, 1, j->buffer_size, f) && EOF != fputc('\n', f))
+		ret = SUCCEED;
+	else
+		fprintf(stderr, "cannot write output file \"%s\": %s\n", filename, zbx_strerror(errno));
+
+	if (0 != fclose(f))
+		ret = FAIL;
+
+	return ret;
+}
+
+static void	bench_usage(void)
+{
+	printf("usage: %s %s\n", progname, usage_message[0]);
+	printf("  -f filter       run only cases with names containing filter\n");
+	printf("  -r repeat       number of runs per case, the best run is reported (default %d)\n",
+			ZBX_BENCH_DEFAULT_REPEAT);
+	printf("  -s scale        workload size multiplier (default 1)\n");
+	printf("  -o output.json  write results in JSON format\n");
+	printf("  -l              list benchmark cases\n");
+}
+
+int	main(int argc, char **argv)
+{
+	zbx_bench_case_t	*case_lists[] = {bench_algo_cases, bench_json_cases, bench_eval_cases,
+					bench_shmem_cases, NULL};
+	const char		*filter = NULL, *output = NULL;
+	zbx_uint64_t		scale = 1;
+	int			opt, repeat = ZBX_BENCH_DEFAULT_REPEAT, list = 0, ret = EXIT_SUCCESS;
+	struct zbx_json		j;
+
+	while (-1 != (opt = getopt(argc, argv, "f:r:s:o:lh")))
+	{
+		switch (opt)
+		{
+			case 'f':
+				filter = optarg;
+				break;
+			case 'r':
+				if (0 >= (repeat = atoi(optarg)))
+				{
+					bench_usage();
+					return EXIT_FAILURE;
+				}
+				break;
+			case 's':
+				if (FAIL == zbx_is_uint64(optarg, &scale) || 0 == scale)
+				{
+					bench_usage();
+					return EXIT_FAILURE;
+				}
+				break;
+			case 'o':
+				output = optarg;
+				break;
+			case 'l':
+				list = 1;
+				break;
+			default:
+				bench_usage();
+				return 'h' == opt ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
+	zbx_json_adduint64(&j, "version", ZBX_BENCH_FORMAT_VERSION);
+	zbx_json_adduint64(&j, "scale", scale);
+	zbx_json_addarray(&j, "results");
+
+	if (0 == list)
+	{
+		printf("%-40s %12s %12s %14s %10s %12s\n", "case", "ops", "ns/op", "ops/sec", "allocs/op",
+				"bytes/op");
+	}
+
+	for (int i = 0; NULL != case_lists[i]; i++)
+	{
+		for (zbx_bench_case_t *bench_case = case_lists[i]; NULL != bench_case->name; bench_case++)
+		{
+			zbx_bench_result_t	result;
+
+			if (NULL != filter && NULL == strstr(bench_case->name, filter))
+				continue;
+
+			if (0 != list)
+			{
+				printf("%s\n", bench_case->name);
+				continue;
+			}
+
+			bench_run_case(bench_case, scale, repeat, &result);
+			bench_print_result(&result);
+			bench_json_add_result(&j, &result);
+		}
+	}
+
+	zbx_json_close(&j);
+
+	if (0 == list && NULL != output && SUCCEED != bench_write_output(output, &j))
+		ret = EXIT_FAILURE;
+
+	zbx_json_free(&j);
+
+	return ret;
+}
@@ -0,0 +1,51 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_ZBXBENCH_H
+#define ZABBIX_ZBXBENCH_H
+
+#include "zbxcommon.h"
+
+typedef struct zbx_bench zbx_bench_t;
+
+/* benchmark case function, must call zbx_bench_start() and zbx_bench_stop() */
+/* around the measured code and return the number of performed operations   */
+typedef zbx_uint64_t (*zbx_bench_func_t)(zbx_bench_t *bench);
+
+typedef struct
+{
+	const char		*name;
+	zbx_bench_func_t	func;
+}
+zbx_bench_case_t;
+
+void		zbx_bench_start(zbx_bench_t *bench);
+void		zbx_bench_stop(zbx_bench_t *bench);
+zbx_uint64_t	zbx_bench_scale(const zbx_bench_t *bench, zbx_uint64_t num);
+
+void		zbx_bench_seed(zbx_bench_t *bench);
+zbx_uint64_t	zbx_bench_rand(zbx_bench_t *bench);
+
+/* benchmark case lists, terminated by case with NULL name */
+extern zbx_bench_case_t	bench_algo_cases[];
+extern zbx_bench_case_t	bench_json_cases[];
+extern zbx_bench_case_t	bench_eval_cases[];
+extern zbx_bench_case_t	bench_shmem_cases[];
+
+#endif
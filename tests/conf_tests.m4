@@ -54,31 +54,40 @@ AC_DEFUN([CONF_TESTS],
 
 		AC_CONFIG_FILES([
 			tests/Makefile
+			tests/benchmarks/Makefile
 			tests/libs/Makefile
 			tests/libs/zbxalgo/Makefile
 			tests/libs/zbxcommon/Makefile
 			tests/libs/zbxcomms/Makefile
 			tests/libs/zbxcommshigh/Makefile
 			tests/libs/zbxconf/Makefile
+			tests/libs/zbxcachevalue/Makefile
 			tests/libs/zbxdbcache/Makefile
 			tests/libs/zbxdbhigh/Makefile
+			tests/libs/zbxdbwrap/Makefile
 			tests/libs/zbxeval/Makefile
 			tests/libs/zbxhistory/Makefile
+			tests/libs/zbxicmpping/Makefile
 			tests/libs/zbxjson/Makefile
 			tests/libs/zbxmodules/Makefile
 			tests/libs/zbxpreproc/Makefile
 			tests/libs/zbxprometheus/Makefile
 			tests/libs/zbxregexp/Makefile
 			tests/libs/zbxserver/Makefile
+			tests/libs/zbxshmem/Makefile
 			tests/libs/zbxsysinfo/Makefile
 			tests/libs/zbxsysinfo/common/Makefile
 			tests/libs/zbxtagfilter/Makefile
 			tests/libs/zbxtrends/Makefile
 			tests/libs/zbxtime/Makefile
+			tests/zabbix_agent/Makefile
+			tests/zabbix_agent/listener/Makefile
 			tests/zabbix_server/Makefile
+			tests/zabbix_server/events/Makefile
 			tests/zabbix_server/pinger/Makefile
 			tests/zabbix_server/poller/Makefile
 			tests/zabbix_server/service/Makefile
+			tests/zabbix_server/snmptrapper/Makefile
 			tests/zabbix_server/trapper/Makefile
 			tests/mocks/Makefile
 			tests/mocks/configcache/Makefile
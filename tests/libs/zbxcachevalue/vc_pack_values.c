@@ -0,0 +1,187 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "vc_pack.h"
+
+/* the history library is not linked, only numeric values without allocated data are used */
+ZBX_VECTOR_IMPL(history_record, zbx_history_record_t)
+
+static void	mock_read_values(zbx_mock_handle_t hvalues, unsigned char value_type,
+		zbx_vector_history_record_t *values)
+{
+	zbx_mock_error_t	err;
+	zbx_mock_handle_t	hvalue;
+	zbx_history_record_t	record;
+	const char		*value;
+	char			*end;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hvalues, &hvalue))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read value: %s", zbx_mock_error_string(err));
+
+		record.timestamp.sec = zbx_mock_get_object_member_int(hvalue, "sec");
+		record.timestamp.ns = zbx_mock_get_object_member_int(hvalue, "ns");
+
+		if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		{
+			record.value.ui64 = zbx_mock_get_object_member_uint64(hvalue, "value");
+		}
+		else
+		{
+			/* strtod() is used to accept nan, inf and -0 values */
+			value = zbx_mock_get_object_member_string(hvalue, "value");
+			record.value.dbl = strtod(value, &end);
+
+			if ('\0' != *end)
+				fail_msg("Invalid float value \"%s\"", value);
+		}
+
+		zbx_vector_history_record_append_ptr(values, &record);
+	}
+}
+
+static zbx_uint64_t	mock_rand(zbx_uint64_t *seed)
+{
+	*seed = *seed * __UINT64_C(6364136223846793005) + __UINT64_C(1442695040888963407);
+
+	return *seed;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: generates reproducible pseudo random values                       *
+ *                                                                            *
+ * Comments: Values mix small deltas, repeated values and arbitrary bit       *
+ *           patterns, timestamps mix regular intervals and random jitter.    *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_generate_values(zbx_mock_handle_t hrandom, unsigned char value_type,
+		zbx_vector_history_record_t *values)
+{
+	zbx_history_record_t	record;
+	zbx_uint64_t		seed, rnd, value = 0;
+	int			i, count;
+
+	seed = zbx_mock_get_object_member_uint64(hrandom, "seed");
+	count = zbx_mock_get_object_member_int(hrandom, "count");
+
+	record.timestamp.sec = 1700000000;
+	record.timestamp.ns = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		rnd = mock_rand(&seed);
+
+		switch (rnd >> 62)
+		{
+			case 0:
+				break;
+			case 1:
+				value += (rnd >> 32) & 0xff;
+				break;
+			case 2:
+				value -= (rnd >> 40) & 0xffff;
+				break;
+			default:
+				value = mock_rand(&seed);
+		}
+
+		if (0 == (rnd & 1))
+		{
+			record.timestamp.sec += 60;
+		}
+		else
+		{
+			record.timestamp.sec += (int)((rnd >> 8) & 0xffff);
+			record.timestamp.ns = (int)((rnd >> 24) % 1000000000);
+		}
+
+		if (ITEM_VALUE_TYPE_UINT64 == value_type)
+			record.value.ui64 = value;
+		else
+			memcpy(&record.value.dbl, &value, sizeof(record.value.dbl));
+
+		zbx_vector_history_record_append_ptr(values, &record);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_history_record_t	values;
+	zbx_history_record_t		*unpacked;
+	unsigned char			value_type, *data;
+	int				i, size;
+	zbx_mock_handle_t		hin, hsize, hrandom;
+	char				msg[64];
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_history_record_create(&values);
+
+	hin = zbx_mock_get_parameter_handle("in");
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(hin, "value type"));
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hin, "random", &hrandom))
+		mock_generate_values(hrandom, value_type, &values);
+	else
+		mock_read_values(zbx_mock_get_object_member_handle(hin, "values"), value_type, &values);
+
+	data = (unsigned char *)zbx_malloc(NULL, (size_t)values.values_num * ZBX_VC_PACKED_RECORD_SIZE_MAX);
+	size = vc_pack_values(values.values, values.values_num, value_type, data);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.size", &hsize))
+		zbx_mock_assert_int_eq("packed size", (int)zbx_mock_get_parameter_uint64("out.size"), size);
+
+	unpacked = (zbx_history_record_t *)zbx_malloc(NULL, sizeof(zbx_history_record_t) * (size_t)values.values_num);
+	vc_unpack_values(data, values.values_num, value_type, unpacked);
+
+	for (i = 0; i < values.values_num; i++)
+	{
+		zbx_snprintf(msg, sizeof(msg), "value #%d seconds", i);
+		zbx_mock_assert_int_eq(msg, values.values[i].timestamp.sec, unpacked[i].timestamp.sec);
+		zbx_snprintf(msg, sizeof(msg), "value #%d nanoseconds", i);
+		zbx_mock_assert_int_eq(msg, values.values[i].timestamp.ns, unpacked[i].timestamp.ns);
+
+		zbx_snprintf(msg, sizeof(msg), "value #%d", i);
+
+		if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		{
+			zbx_mock_assert_uint64_eq(msg, values.values[i].value.ui64, unpacked[i].value.ui64);
+		}
+		else
+		{
+			zbx_uint64_t	expected, returned;
+
+			/* compare value bits so that NaN and signed zero are checked exactly */
+			memcpy(&expected, &values.values[i].value.dbl, sizeof(expected));
+			memcpy(&returned, &unpacked[i].value.dbl, sizeof(returned));
+			zbx_mock_assert_uint64_eq(msg, expected, returned);
+		}
+	}
+
+	zbx_free(unpacked);
+	zbx_free(data);
+	zbx_vector_history_record_destroy(&values);
+}
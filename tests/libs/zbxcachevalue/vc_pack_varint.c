@@ -0,0 +1,57 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "vc_pack.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_error_t	err;
+	zbx_mock_handle_t	hvalues, hvalue;
+	zbx_uint64_t		value, unpacked;
+	unsigned char		buf[ZBX_VC_VARINT_SIZE_MAX + 1];
+	int			size;
+
+	ZBX_UNUSED(state);
+
+	hvalues = zbx_mock_get_parameter_handle("in.values");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hvalues, &hvalue))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read value: %s", zbx_mock_error_string(err));
+
+		value = zbx_mock_get_object_member_uint64(hvalue, "value");
+
+		/* guard byte to detect writes past the encoded value */
+		memset(buf, 0xff, sizeof(buf));
+		buf[zbx_mock_get_object_member_int(hvalue, "size")] = 0;
+
+		size = vc_pack_varint(buf, value);
+		zbx_mock_assert_int_eq("packed size", zbx_mock_get_object_member_int(hvalue, "size"), size);
+		zbx_mock_assert_int_eq("guard byte", 0, buf[size]);
+
+		zbx_mock_assert_int_eq("unpacked size", size, vc_unpack_varint(buf, &unpacked));
+		zbx_mock_assert_uint64_eq("unpacked value", value, unpacked);
+	}
+}
@@ -0,0 +1,76 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxcomms.h"
+
+static unsigned int	str_to_tls_accept(const char *str)
+{
+	if (0 == strcmp(str, "unencrypted"))
+		return ZBX_TCP_SEC_UNENCRYPTED;
+
+	if (0 == strcmp(str, "psk"))
+		return ZBX_TCP_SEC_TLS_PSK;
+
+	fail_msg("unknown connection type \"%s\"", str);
+
+	return 0;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_socket_t	s;
+	unsigned int	tls_accept;
+	short		events;
+	int		ret, waits = 0;
+
+	ZBX_UNUSED(state);
+
+	tls_accept = str_to_tls_accept(zbx_mock_get_parameter_string("in.tls_accept"));
+
+	zbx_mock_assert_result_eq("zbx_tcp_connect() return code", SUCCEED,
+			zbx_tcp_connect(&s, NULL, "127.0.0.1", 10051, 0, ZBX_TCP_SEC_UNENCRYPTED, NULL, NULL));
+
+	/* connection type is detected when the first byte arrives, like in trapper event loop */
+	while (SUCCEED == (ret = zbx_tcp_accept_step(&s, tls_accept, &events)) && 0 != events)
+	{
+		zbx_mock_assert_int_eq("awaited events", POLLIN, events);
+		waits++;
+	}
+
+	zbx_mock_assert_result_eq("zbx_tcp_accept_step() return code",
+			zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")), ret);
+	zbx_mock_assert_int_eq("number of waits", (int)zbx_mock_get_parameter_uint64("out.waits"), waits);
+
+	if (SUCCEED == ret)
+	{
+		zbx_mock_assert_int_eq("connection type", ZBX_TCP_SEC_UNENCRYPTED, s.connection_type);
+
+		/* the first byte was peeked and must still be received */
+		zbx_mock_assert_int_ne("zbx_tcp_recv() return code", FAIL, zbx_tcp_recv(&s));
+		zbx_mock_assert_str_eq("received message", zbx_mock_get_parameter_string("out.data"), s.buffer);
+	}
+
+	zbx_tcp_close(&s);
+}
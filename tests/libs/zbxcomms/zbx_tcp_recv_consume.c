@@ -0,0 +1,167 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxcomms.h"
+#include "zbxstr.h"
+
+/* message is '{' followed by rows terminated with ';' and '}' */
+typedef struct
+{
+	char	*removed;
+	size_t	removed_alloc;
+	size_t	removed_offset;
+	size_t	peak;
+	int	calls;
+	int	stop;
+}
+zbx_test_consumer_t;
+
+/* removes complete rows after the opening bracket, stops when the closing bracket is received */
+static int	test_consume(char *data, size_t *size, void *arg)
+{
+	zbx_test_consumer_t	*consumer = (zbx_test_consumer_t *)arg;
+	size_t			i, end = 1;
+
+	consumer->calls++;
+
+	if (consumer->peak < *size)
+		consumer->peak = *size;
+
+	if (0 != consumer->stop)
+		return FAIL;
+
+	for (i = 1; i < *size; i++)
+	{
+		if ('}' == data[i])
+			break;
+
+		if (';' == data[i])
+			end = i + 1;
+	}
+
+	if (1 < end)
+	{
+		zbx_strncpy_alloc(&consumer->removed, &consumer->removed_alloc, &consumer->removed_offset, data + 1,
+				end - 1);
+		memmove(data + 1, data + end, *size - end);
+		*size -= end - 1;
+	}
+
+	return i < *size ? FAIL : SUCCEED;
+}
+
+static char	*test_message(int rows, int row_size)
+{
+	char		*message;
+	int		i, j;
+	size_t		offset = 0;
+	unsigned int	seed = 1;
+
+	message = (char *)zbx_malloc(NULL, (size_t)(rows * (row_size + 1) + 3));
+	message[offset++] = '{';
+
+	/* pseudo random rows, must match the data in test case fragments */
+	for (i = 0; i < rows; i++)
+	{
+		for (j = 0; j < row_size; j++)
+		{
+			seed = seed * 1103515245 + 12345;
+			message[offset++] = 'a' + (seed >> 16) % 8;
+		}
+
+		message[offset++] = ';';
+	}
+
+	message[offset++] = '}';
+	message[offset] = '\0';
+
+	return message;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	char			*message;
+	size_t			len;
+	zbx_socket_t		s;
+	zbx_test_consumer_t	consumer;
+
+	ZBX_UNUSED(state);
+
+	memset(&consumer, 0, sizeof(consumer));
+	consumer.stop = (0 == strcmp(zbx_mock_get_parameter_string("in.consume"), "no"));
+
+	message = test_message((int)zbx_mock_get_parameter_uint64("in.rows"),
+			(int)zbx_mock_get_parameter_uint64("in.row_size"));
+	len = strlen(message);
+
+	zbx_mock_assert_result_eq("zbx_tcp_connect() return code", SUCCEED,
+			zbx_tcp_connect(&s, NULL, "127.0.0.1", 10051, 0, ZBX_TCP_SEC_UNENCRYPTED, NULL, NULL));
+
+	if (FAIL == zbx_tcp_recv_consume(&s, 0, 0, test_consume, &consumer))
+	{
+		if (FAIL != zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")))
+			fail_msg("cannot receive message: %s", zbx_socket_strerror());
+
+		goto out;
+	}
+
+	zbx_mock_assert_result_eq("zbx_tcp_recv_consume() return code",
+			zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")), SUCCEED);
+
+	/* data removed by consumer and the received message together must make up the sent message */
+	zbx_mock_assert_uint64_eq("message size", len, consumer.removed_offset + s.read_bytes);
+	zbx_mock_assert_int_eq("message start", '{', s.buffer[0]);
+
+	if (0 != consumer.removed_offset)
+		zbx_mock_assert_int_eq("removed data", 0, memcmp(message + 1, consumer.removed, consumer.removed_offset));
+
+	zbx_mock_assert_str_eq("message end", message + 1 + consumer.removed_offset, s.buffer + 1);
+
+	if (0 == strcmp(zbx_mock_get_parameter_string("out.consumed"), "yes"))
+	{
+		zbx_mock_assert_str_eq("received message", "{}", s.buffer);
+
+		/* removed data is not kept in memory */
+		if (consumer.peak >= len / 2)
+		{
+			fail_msg("data kept in memory " ZBX_FS_SIZE_T " is not less than half of message size "
+					ZBX_FS_SIZE_T, (zbx_fs_size_t)consumer.peak, (zbx_fs_size_t)len);
+		}
+	}
+	else
+		zbx_mock_assert_uint64_eq("removed data size", 0, consumer.removed_offset);
+
+	if (0 == strcmp(zbx_mock_get_parameter_string("out.called"), "yes"))
+	{
+		if (0 == consumer.calls)
+			fail_msg("consumer was not called");
+	}
+	else
+		zbx_mock_assert_int_eq("consumer calls", 0, consumer.calls);
+out:
+	zbx_free(consumer.removed);
+	zbx_free(message);
+	zbx_tcp_close(&s);
+}
@@ -0,0 +1,61 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxcomms.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_socket_t		s;
+	zbx_tcp_recv_context_t	context;
+	ssize_t			received;
+	short			events;
+	int			waits = 0;
+
+	ZBX_UNUSED(state);
+
+	zbx_mock_assert_result_eq("zbx_tcp_connect() return code", SUCCEED,
+			zbx_tcp_connect(&s, NULL, "127.0.0.1", 10051, 0, ZBX_TCP_SEC_UNENCRYPTED, NULL, NULL));
+
+	zbx_tcp_recv_context_init(&s, &context, ZBX_TCP_LARGE);
+
+	/* message is received in parts as they arrive, like in trapper event loop */
+	while (FAIL == (received = zbx_tcp_recv_context(&s, &context, &events)) && 0 != events)
+	{
+		zbx_mock_assert_int_eq("awaited events", POLLIN, events);
+		waits++;
+	}
+
+	zbx_tcp_recv_context_clear(&context);
+
+	zbx_mock_assert_result_eq("zbx_tcp_recv_context() return code",
+			zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")),
+			FAIL == received ? FAIL : SUCCEED);
+	zbx_mock_assert_int_eq("number of waits", (int)zbx_mock_get_parameter_uint64("out.waits"), waits);
+
+	if (FAIL != received)
+		zbx_mock_assert_str_eq("received message", zbx_mock_get_parameter_string("out.data"), s.buffer);
+
+	zbx_tcp_close(&s);
+}
@@ -0,0 +1,265 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxcomms.h"
+#include "zbxcrypto.h"
+
+#if defined(HAVE_OPENSSL) && defined(HAVE_OPENSSL_WITH_PSK)
+
+#include <openssl/ssl.h>
+
+#define TEST_CONNECTIONS_MAX	4
+#define TEST_STEPS_MAX		100
+
+extern size_t	(*find_psk_in_cache)(const unsigned char *, unsigned char *, unsigned int *);
+
+typedef struct
+{
+	zbx_socket_t	s;
+	SSL		*ssl;
+	const char	*identity;
+	const char	*psk;
+	int		client_done;
+	int		server_done;
+	int		ret;
+	int		waits;
+}
+zbx_test_conn_t;
+
+static unsigned char	get_server_program_type(void)
+{
+	return ZBX_PROGRAM_TYPE_SERVER;
+}
+
+static unsigned int	str_to_psk_usage(const char *str)
+{
+	if (0 == strcmp(str, "host"))
+		return ZBX_PSK_FOR_HOST;
+
+	if (0 == strcmp(str, "autoreg"))
+		return ZBX_PSK_FOR_AUTOREG;
+
+	if (0 == strcmp(str, "host,autoreg"))
+		return ZBX_PSK_FOR_HOST | ZBX_PSK_FOR_AUTOREG;
+
+	fail_msg("unknown PSK usage \"%s\"", str);
+
+	return 0;
+}
+
+/* replaces configuration cache lookup, PSKs are taken from in.cache */
+static size_t	test_find_psk(const unsigned char *identity, unsigned char *psk_hex, unsigned int *psk_usage)
+{
+	zbx_mock_handle_t	hpsks, hpsk;
+
+	hpsks = zbx_mock_get_parameter_handle("in.cache");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hpsks, &hpsk))
+	{
+		if (0 != strcmp((const char *)identity, zbx_mock_get_object_member_string(hpsk, "identity")))
+			continue;
+
+		*psk_usage = str_to_psk_usage(zbx_mock_get_object_member_string(hpsk, "usage"));
+
+		return zbx_strlcpy((char *)psk_hex, zbx_mock_get_object_member_string(hpsk, "psk"),
+				HOST_TLS_PSK_LEN_MAX);
+	}
+
+	return 0;
+}
+
+static unsigned int	test_client_psk_cb(SSL *ssl, const char *hint, char *identity, unsigned int max_identity_len,
+		unsigned char *psk, unsigned int max_psk_len)
+{
+	zbx_test_conn_t	*conn = (zbx_test_conn_t *)SSL_get_app_data(ssl);
+	int		psk_len;
+
+	ZBX_UNUSED(hint);
+
+	zbx_strlcpy(identity, conn->identity, max_identity_len);
+
+	if (0 >= (psk_len = zbx_hex2bin((const unsigned char *)conn->psk, psk, (int)max_psk_len)))
+		fail_msg("invalid PSK \"%s\"", conn->psk);
+
+	return (unsigned int)psk_len;
+}
+
+static void	test_conn_init(zbx_test_conn_t *conn, zbx_mock_handle_t hconn, SSL_CTX *ctx)
+{
+	int	sv[2];
+
+	memset(conn, 0, sizeof(zbx_test_conn_t));
+
+	conn->identity = zbx_mock_get_object_member_string(hconn, "identity");
+	conn->psk = zbx_mock_get_object_member_string(hconn, "psk");
+
+	/* the mocked connection provides the first byte of TLS handshake for connection type detection, */
+	/* the handshake itself goes through a socket pair */
+	zbx_mock_assert_result_eq("zbx_tcp_connect() return code", SUCCEED,
+			zbx_tcp_connect(&conn->s, NULL, "127.0.0.1", 10051, 0, ZBX_TCP_SEC_UNENCRYPTED, NULL, NULL));
+
+	if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv))
+		fail_msg("cannot create socket pair: %s", zbx_strerror(errno));
+
+	if (-1 == fcntl(sv[0], F_SETFL, O_NONBLOCK) || -1 == fcntl(sv[1], F_SETFL, O_NONBLOCK))
+		fail_msg("cannot set non-blocking mode: %s", zbx_strerror(errno));
+
+	close(conn->s.socket);
+	conn->s.socket = sv[0];
+
+	if (NULL == (conn->ssl = SSL_new(ctx)))
+		fail_msg("cannot create client TLS context");
+
+	SSL_set_app_data(conn->ssl, conn);
+	SSL_set_fd(conn->ssl, sv[1]);
+}
+
+static void	test_conn_step(zbx_test_conn_t *conn, unsigned int tls_accept)
+{
+	short	events;
+
+	if (0 == conn->client_done)
+	{
+		int	res;
+
+		if (1 == (res = SSL_connect(conn->ssl)))
+			conn->client_done = 1;
+		else if (SSL_ERROR_WANT_READ != SSL_get_error(conn->ssl, res))
+			conn->client_done = 1;
+	}
+
+	if (0 != conn->server_done)
+		return;
+
+	if (SUCCEED != (conn->ret = zbx_tcp_accept_step(&conn->s, tls_accept, &events)) || 0 == events)
+		conn->server_done = 1;
+	else
+		conn->waits++;
+}
+
+static void	test_conn_clear(zbx_test_conn_t *conn)
+{
+	zbx_tcp_close(&conn->s);
+	close(SSL_get_fd(conn->ssl));
+	SSL_free(conn->ssl);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_config_tls_t	*config_tls;
+	zbx_mock_handle_t	hconns, hconn;
+	zbx_test_conn_t		conns[TEST_CONNECTIONS_MAX];
+	SSL_CTX			*ctx;
+	int			i, conns_num = 0, steps;
+
+	ZBX_UNUSED(state);
+
+	config_tls = zbx_config_tls_new();
+	zbx_tls_init_parent(get_server_program_type);
+	zbx_tls_init_child(config_tls, get_server_program_type);
+	find_psk_in_cache = test_find_psk;
+
+	if (NULL == (ctx = SSL_CTX_new(TLS_client_method())))
+		fail_msg("cannot create client TLS context");
+
+	SSL_CTX_set_max_proto_version(ctx, TLS1_2_VERSION);
+	SSL_CTX_set_cipher_list(ctx, "kECDHEPSK+AES128:kPSK+AES128");
+	SSL_CTX_set_psk_client_callback(ctx, test_client_psk_cb);
+
+	hconns = zbx_mock_get_parameter_handle("in.connections");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hconns, &hconn))
+	{
+		if (TEST_CONNECTIONS_MAX == conns_num)
+			fail_msg("too many connections");
+
+		test_conn_init(&conns[conns_num++], hconn, ctx);
+	}
+
+	/* handshakes of all connections are stepped in turns, like in trapper event loop */
+	for (steps = 0; steps < TEST_STEPS_MAX; steps++)
+	{
+		int	done = 1;
+
+		for (i = 0; i < conns_num; i++)
+		{
+			test_conn_step(&conns[i], ZBX_TCP_SEC_TLS_PSK);
+
+			if (0 == conns[i].server_done)
+				done = 0;
+		}
+
+		if (0 != done)
+			break;
+	}
+
+	hconns = zbx_mock_get_parameter_handle("out.connections");
+
+	for (i = 0; i < conns_num; i++)
+	{
+		zbx_tls_conn_attr_t	attr;
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_vector_element(hconns, &hconn))
+			fail_msg("missing expected result of connection #%d", i + 1);
+
+		zbx_mock_assert_int_eq("handshake finished", 1, conns[i].server_done);
+		zbx_mock_assert_result_eq("zbx_tcp_accept_step() return code",
+				zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hconn, "return")),
+				conns[i].ret);
+
+		if (SUCCEED != conns[i].ret)
+			continue;
+
+		/* handshake must not be completed in one step */
+		zbx_mock_assert_int_ne("number of waits", 0, conns[i].waits);
+
+		zbx_mock_assert_int_eq("connection type", ZBX_TCP_SEC_TLS_PSK, conns[i].s.connection_type);
+		zbx_mock_assert_result_eq("zbx_tls_get_attr_psk() return code", SUCCEED,
+				zbx_tls_get_attr_psk(&conns[i].s, &attr));
+		zbx_mock_assert_str_eq("PSK identity", conns[i].identity, attr.psk_identity);
+		zbx_mock_assert_uint64_eq("PSK usage",
+				str_to_psk_usage(zbx_mock_get_object_member_string(hconn, "usage")),
+				zbx_tls_get_psk_usage(&conns[i].s));
+	}
+
+	for (i = 0; i < conns_num; i++)
+		test_conn_clear(&conns[i]);
+
+	SSL_CTX_free(ctx);
+	zbx_tls_free();
+	zbx_config_tls_free(config_tls);
+}
+
+#undef TEST_CONNECTIONS_MAX
+#undef TEST_STEPS_MAX
+
+#else
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	skip();
+}
+#endif
@@ -0,0 +1,77 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "dbcache_test.h"
+
+void	zbx_hc_add_text_value(zbx_uint64_t itemid, const char *value, int sec)
+{
+	zbx_timespec_t	ts = {sec, 0};
+
+	dc_local_add_history_text(itemid, ITEM_VALUE_TYPE_TEXT, &ts, value, 0, 0, 0);
+}
+
+/* returns index of the shard containing the item or -1 if the item is not cached */
+int	zbx_hc_get_item_shard(zbx_uint64_t itemid)
+{
+	int	i;
+
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		if (NULL != hc_get_item(&cache->shards[i], itemid))
+			return i;
+	}
+
+	return -1;
+}
+
+void	zbx_hc_get_shard_state(int shard_index, int *history_num, int *queue_num, zbx_uint64_t *history_free,
+		zbx_uint64_t *index_free)
+{
+	zbx_hc_shard_t	*shard = &cache->shards[shard_index];
+
+	hc_shard_lock(shard);
+
+	*history_num = shard->history_num;
+	*queue_num = shard->history_queue.elems_num;
+	*history_free = shard->mem->free_size;
+	*index_free = shard->index_mem->free_size;
+
+	hc_shard_unlock(shard);
+}
+
+/* pops the next batch of items and returns them to cache as processed, returns the number of popped items */
+int	zbx_hc_sync_items(int *queue_num)
+{
+	zbx_vector_ptr_t	history_items;
+	int			items_num;
+
+	zbx_vector_ptr_create(&history_items);
+
+	hc_pop_items(&history_items);
+
+	if (0 != (items_num = history_items.values_num))
+		*queue_num = hc_push_items(&history_items);
+	else
+		*queue_num = 0;
+
+	zbx_vector_ptr_destroy(&history_items);
+
+	return items_num;
+}
@@ -0,0 +1,32 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#ifndef ZABBIX_DBCACHE_TEST_H
+#define ZABBIX_DBCACHE_TEST_H
+
+#include "zbxtypes.h"
+
+void	zbx_hc_add_text_value(zbx_uint64_t itemid, const char *value, int sec);
+int	zbx_hc_get_item_shard(zbx_uint64_t itemid);
+void	zbx_hc_get_shard_state(int shard_index, int *history_num, int *queue_num, zbx_uint64_t *history_free,
+		zbx_uint64_t *index_free);
+int	zbx_hc_sync_items(int *queue_num);
+
+#endif
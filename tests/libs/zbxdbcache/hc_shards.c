@@ -0,0 +1,178 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxmutexs.h"
+#include "zbxcachehistory.h"
+#include "dbcache_test.h"
+
+#define HC_TEST_SHARD_SIZE	(256 * ZBX_KIBIBYTE)
+#define HC_TEST_SYNC_MAX	1000
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	int		values_num;
+	int		shard;
+}
+hc_test_item_t;
+
+ZBX_VECTOR_DECL(hc_test_item, hc_test_item_t)
+ZBX_VECTOR_IMPL(hc_test_item, hc_test_item_t)
+
+static void	hc_test_read_items(zbx_vector_hc_test_item_t *items)
+{
+	zbx_mock_handle_t	hitems, hitem;
+	zbx_mock_error_t	err;
+	hc_test_item_t		item;
+
+	hitems = zbx_mock_get_parameter_handle("in.items");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hitems, &hitem))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read item: %s", zbx_mock_error_string(err));
+
+		item.itemid = zbx_mock_get_object_member_uint64(hitem, "itemid");
+		item.values_num = zbx_mock_get_object_member_int(hitem, "values");
+		item.shard = zbx_mock_get_object_member_int(hitem, "shard");
+
+		zbx_vector_hc_test_item_append(items, item);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	int				err, shards_num, i, j, sec = 1, history_num, queue_num, synced_num, values_num,
+					syncs_num = 0, shard_values[ZBX_HC_SHARDS_MAX] = {0};
+	char				*error = NULL;
+	zbx_uint64_t			trends_size = 0, history_free[ZBX_HC_SHARDS_MAX], index_free[ZBX_HC_SHARDS_MAX],
+					free_size, index_free_size, total_values = 0, diag_items, diag_values;
+	zbx_vector_hc_test_item_t	items;
+	zbx_wcache_info_t		wcache_info;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_hc_test_item_create(&items);
+	hc_test_read_items(&items);
+
+	shards_num = (int)zbx_mock_get_parameter_uint64("in.shards");
+
+	err = zbx_locks_create(&error);
+	zbx_mock_assert_result_eq("Lock initialization failed", SUCCEED, err);
+
+	err = zbx_init_database_cache(get_program_type, (zbx_uint64_t)shards_num * HC_TEST_SHARD_SIZE,
+			(zbx_uint64_t)shards_num * HC_TEST_SHARD_SIZE, shards_num, 0, 0, &trends_size, &error);
+	zbx_mock_assert_result_eq("History cache initialization failed", SUCCEED, err);
+
+	for (i = 0; i < shards_num; i++)
+		zbx_hc_get_shard_state(i, &history_num, &queue_num, &history_free[i], &index_free[i]);
+
+	for (i = 0; i < items.values_num; i++)
+	{
+		for (j = 0; j < items.values[i].values_num; j++)
+			zbx_hc_add_text_value(items.values[i].itemid, "history cache shard test value", sec++);
+
+		shard_values[items.values[i].shard] += items.values[i].values_num;
+		total_values += (zbx_uint64_t)items.values[i].values_num;
+	}
+
+	zbx_dc_flush_history();
+
+	/* every item must be stored in its own shard */
+	for (i = 0; i < items.values_num; i++)
+	{
+		zbx_mock_assert_int_eq("item shard", items.values[i].shard,
+				zbx_hc_get_item_shard(items.values[i].itemid));
+	}
+
+	/* values must be allocated only from the memory of the shard the item belongs to */
+	for (i = 0; i < shards_num; i++)
+	{
+		zbx_hc_get_shard_state(i, &history_num, &queue_num, &free_size, &index_free_size);
+
+		zbx_mock_assert_int_eq("shard values", shard_values[i], history_num);
+
+		if (0 == shard_values[i])
+		{
+			zbx_mock_assert_int_eq("empty shard queue", 0, queue_num);
+			zbx_mock_assert_uint64_eq("empty shard history memory", history_free[i], free_size);
+			zbx_mock_assert_uint64_eq("empty shard index memory", index_free[i], index_free_size);
+		}
+		else
+		{
+			if (free_size >= history_free[i])
+				fail_msg("history memory of shard %d was not used", i);
+		}
+	}
+
+	/* statistics must be summed over all shards */
+	zbx_hc_get_diag_stats(&diag_items, &diag_values);
+	zbx_mock_assert_uint64_eq("cached items", (zbx_uint64_t)items.values_num, diag_items);
+	zbx_mock_assert_uint64_eq("cached values", total_values, diag_values);
+
+	zbx_dc_get_stats_all(&wcache_info);
+	zbx_mock_assert_uint64_eq("history queue", total_values, wcache_info.history_queue);
+
+	/* each sync takes one value per item, so the cache is drained after the largest item values */
+	for (i = 0, values_num = 0; i < items.values_num; i++)
+	{
+		if (values_num < items.values[i].values_num)
+			values_num = items.values[i].values_num;
+	}
+
+	while (0 != (synced_num = zbx_hc_sync_items(&queue_num)))
+	{
+		if (HC_TEST_SYNC_MAX < synced_num)
+			fail_msg("synced %d items, while no more than %d are allowed", synced_num, HC_TEST_SYNC_MAX);
+
+		if (++syncs_num > values_num)
+			fail_msg("history cache was not drained after %d syncs", values_num);
+
+		/* the returned queue size must match the values left in cache */
+		zbx_mock_assert_int_eq("history queue after sync", (values_num > syncs_num ? 1 : 0),
+				(0 != queue_num ? 1 : 0));
+	}
+
+	zbx_mock_assert_int_eq("history syncs", values_num, syncs_num);
+
+	for (i = 0; i < shards_num; i++)
+	{
+		zbx_hc_get_shard_state(i, &history_num, &queue_num, &free_size, &index_free_size);
+
+		zbx_mock_assert_int_eq("shard values after sync", 0, history_num);
+		zbx_mock_assert_int_eq("shard queue after sync", 0, queue_num);
+	}
+
+	for (i = 0; i < items.values_num; i++)
+	{
+		zbx_mock_assert_int_eq("item shard after sync", -1,
+				zbx_hc_get_item_shard(items.values[i].itemid));
+	}
+
+	zbx_free_database_cache(ZBX_SYNC_NONE, NULL);
+
+	zbx_vector_hc_test_item_destroy(&items);
+}
@@ -39,8 +39,10 @@ int	zbx_vc_get_cached_values(zbx_uint64_t itemid, unsigned char value_type, zbx_
 
 	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
 	{
+		zbx_history_record_t	*slots = vch_chunk_values(chunk, value_type);
+
 		for (i = chunk->first_value; i <= chunk->last_value; i++)
-			vc_history_record_vector_append(values, value_type, &chunk->slots[i]);
+			vc_history_record_vector_append(values, value_type, &slots[i]);
 	}
 
 	return SUCCEED;
@@ -51,6 +53,7 @@ int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int
 	zbx_vc_item_t			*item;
 	int				ret;
 	zbx_vector_history_record_t	values;
+	zbx_vc_vector_append_t		append = {.values = &values, .value_type = (unsigned char)value_type};
 
 	/* add item to cache if necessary */
 	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
@@ -62,7 +65,7 @@ int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int
 	/* perform request to cache values */
 	zbx_history_record_vector_create(&values);
 	RDLOCK_CACHE;
-	ret = vch_item_get_values(item, &values, seconds, count, ts);
+	ret = vch_item_get_values(item, seconds, count, ts, vc_history_record_vector_append_func, &append);
 	UNLOCK_CACHE;
 	zbx_vc_flush_stats();
 	zbx_history_record_vector_destroy(&values, value_type);
@@ -93,6 +96,25 @@ int	zbx_vc_get_item_state(zbx_uint64_t itemid, int *status, int *active_range, i
 	return ret;
 }
 
+int	zbx_vc_get_window_state(zbx_uint64_t itemid, int seconds, int *valid, int *values_num, int *min, int *max)
+{
+	zbx_vc_item_t	*item;
+	zbx_vc_window_t	*window;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)) ||
+			NULL == (window = vc_item_find_window(item, seconds)))
+	{
+		return FAIL;
+	}
+
+	*valid = (0 != (window->flags & ZBX_VC_WINDOW_VALID));
+	*values_num = window->values_num;
+	*min = (0 != (window->flags & ZBX_VC_WINDOW_MIN));
+	*max = (0 != (window->flags & ZBX_VC_WINDOW_MAX));
+
+	return SUCCEED;
+}
+
 int	zbx_vc_get_cache_state(int *mode, zbx_uint64_t *hits, zbx_uint64_t *misses)
 {
 	if (NULL == vc_cache)
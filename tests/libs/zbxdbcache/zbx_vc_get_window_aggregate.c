@@ -0,0 +1,206 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxnum.h"
+#include "zbxmutexs.h"
+#include "zbxcachevalue.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+static int	str_to_aggr_func(const char *str)
+{
+	if (0 == strcmp(str, "sum"))
+		return ZBX_VC_AGGR_SUM;
+
+	if (0 == strcmp(str, "avg"))
+		return ZBX_VC_AGGR_AVG;
+
+	if (0 == strcmp(str, "min"))
+		return ZBX_VC_AGGR_MIN;
+
+	if (0 == strcmp(str, "max"))
+		return ZBX_VC_AGGR_MAX;
+
+	if (0 == strcmp(str, "count"))
+		return ZBX_VC_AGGR_COUNT;
+
+	fail_msg("unknown aggregate function: %s", str);
+
+	return FAIL;
+}
+
+static int	str_to_flag(const char *str)
+{
+	if (0 == strcmp(str, "yes"))
+		return 1;
+
+	if (0 == strcmp(str, "no"))
+		return 0;
+
+	fail_msg("invalid flag value: %s", str);
+
+	return FAIL;
+}
+
+static void	check_window(zbx_mock_handle_t hstep)
+{
+	zbx_mock_handle_t	hwindow;
+	zbx_uint64_t		itemid;
+	int			seconds, valid, values_num, min, max;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hstep, "window", &hwindow))
+		return;
+
+	if (FAIL == zbx_is_uint64(zbx_mock_get_object_member_string(hwindow, "itemid"), &itemid))
+		fail_msg("Invalid window itemid value");
+
+	seconds = atoi(zbx_mock_get_object_member_string(hwindow, "seconds"));
+
+	zbx_mock_assert_result_eq("zbx_vc_get_window_state() return value", SUCCEED,
+			zbx_vc_get_window_state(itemid, seconds, &valid, &values_num, &min, &max));
+
+	zbx_mock_assert_int_eq("window valid", str_to_flag(zbx_mock_get_object_member_string(hwindow, "valid")),
+			valid);
+
+	if (0 == valid)
+		return;
+
+	zbx_mock_assert_int_eq("window values", atoi(zbx_mock_get_object_member_string(hwindow, "values")),
+			values_num);
+	zbx_mock_assert_int_eq("window min", str_to_flag(zbx_mock_get_object_member_string(hwindow, "min")), min);
+	zbx_mock_assert_int_eq("window max", str_to_flag(zbx_mock_get_object_member_string(hwindow, "max")), max);
+}
+
+static void	test_add_values(zbx_mock_handle_t hstep)
+{
+	zbx_vector_ptr_t	history;
+	int			ret_flush;
+
+	zbx_vector_ptr_create(&history);
+	zbx_vcmock_get_dc_history(zbx_mock_get_object_member_handle(hstep, "values"), &history);
+
+	zbx_mock_assert_result_eq("zbx_vc_add_values() return value", SUCCEED, zbx_vc_add_values(&history,
+			&ret_flush));
+
+	zbx_vector_ptr_clear_ext(&history, zbx_vcmock_free_dc_history);
+	zbx_vector_ptr_destroy(&history);
+}
+
+static void	test_get_aggregate(zbx_mock_handle_t hstep)
+{
+	zbx_uint64_t		itemid, expected_ui64;
+	unsigned char		value_type;
+	int			seconds, count, aggr_func, values_num, ret, expected_ret;
+	zbx_timespec_t		ts;
+	zbx_history_value_t	value;
+	zbx_mock_handle_t	hvalue;
+	const char		*data;
+
+	zbx_vcmock_get_request_params(hstep, &itemid, &value_type, &seconds, &count, &ts);
+	aggr_func = str_to_aggr_func(zbx_mock_get_object_member_string(hstep, "func"));
+
+	ret = zbx_vc_get_window_aggregate(itemid, value_type, seconds, &ts, aggr_func, &value, &values_num);
+	zbx_vc_flush_stats();
+
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hstep, "return"));
+	zbx_mock_assert_result_eq("zbx_vc_get_window_aggregate() return value", expected_ret, ret);
+
+	if (SUCCEED != ret)
+		return;
+
+	zbx_mock_assert_int_eq("values num", atoi(zbx_mock_get_object_member_string(hstep, "num")), values_num);
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hstep, "value", &hvalue))
+		return;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_string(hvalue, &data))
+		fail_msg("Cannot read aggregate value");
+
+	if (ITEM_VALUE_TYPE_UINT64 == value_type && ZBX_VC_AGGR_AVG != aggr_func)
+	{
+		if (FAIL == zbx_is_uint64(data, &expected_ui64))
+			fail_msg("Invalid uint64 value \"%s\"", data);
+
+		zbx_mock_assert_uint64_eq("aggregate value", expected_ui64, value.ui64);
+	}
+	else
+		zbx_mock_assert_double_eq("aggregate value", atof(data), value.dbl);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	int			err, seconds, count;
+	char			*error = NULL;
+	const char		*type;
+	zbx_mock_handle_t	handle, hstep;
+	zbx_uint64_t		itemid;
+	unsigned char		value_type;
+	zbx_timespec_t		ts;
+
+	ZBX_UNUSED(state);
+
+	/* set small cache size to force smaller cache free request size (5% of cache size) */
+	set_zbx_config_value_cache_size(ZBX_KIBIBYTE);
+
+	err = zbx_locks_create(&error);
+	zbx_mock_assert_result_eq("Lock initialization failed", SUCCEED, err);
+
+	err = zbx_vc_init(get_zbx_config_value_cache_size(), 0, &error);
+	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
+
+	zbx_vc_enable();
+	zbx_vcmock_ds_init();
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.precache", &handle))
+	{
+		while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(handle, &hstep))
+		{
+			zbx_vcmock_set_time(hstep, "time");
+			zbx_vcmock_get_request_params(hstep, &itemid, &value_type, &seconds, &count, &ts);
+			zbx_vc_precache_values(itemid, value_type, seconds, count, &ts);
+		}
+	}
+
+	handle = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(handle, &hstep))
+	{
+		zbx_vcmock_set_time(hstep, "time");
+		type = zbx_mock_get_object_member_string(hstep, "type");
+
+		if (0 == strcmp(type, "add"))
+			test_add_values(hstep);
+		else if (0 == strcmp(type, "get"))
+			test_get_aggregate(hstep);
+		else
+			fail_msg("unknown step type: %s", type);
+
+		check_window(hstep);
+	}
+
+	zbx_vcmock_ds_destroy();
+
+	zbx_vc_reset();
+	zbx_vc_destroy();
+}
@@ -0,0 +1,170 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxdb.h"
+#include "zbxdbhigh.h"
+#include "zbxnum.h"
+
+static char	*copy_sql, *copy_data;
+
+int	__wrap_zbx_db_copy_from(const char *sql, const char *data, size_t data_len);
+
+int	__wrap_zbx_db_copy_from(const char *sql, const char *data, size_t data_len)
+{
+	int		rows = 0;
+	const char	*ptr;
+
+	copy_sql = zbx_strdup(copy_sql, sql);
+
+	copy_data = (char *)zbx_realloc(copy_data, data_len + 1);
+	memcpy(copy_data, data, data_len);
+	copy_data[data_len] = '\0';
+
+	for (ptr = data; ptr < data + data_len; ptr++)
+	{
+		if ('\n' == *ptr)
+			rows++;
+	}
+
+	return rows;
+}
+
+static void	read_row(zbx_mock_handle_t hrow, zbx_vector_ptr_t *fields, zbx_db_value_t *values)
+{
+	zbx_mock_handle_t	hvalue;
+	zbx_mock_error_t	err;
+	const char		*str;
+	int			i = 0;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hrow, &hvalue))))
+	{
+		const zbx_db_field_t	*field;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hvalue, &str)))
+			fail_msg("Cannot read row value: %s", zbx_mock_error_string(err));
+
+		if (i >= fields->values_num)
+			fail_msg("too many row values");
+
+		field = (const zbx_db_field_t *)fields->values[i];
+
+		switch (field->type)
+		{
+			case ZBX_TYPE_ID:
+			case ZBX_TYPE_UINT:
+				ZBX_STR2UINT64(values[i].ui64, str);
+				break;
+			case ZBX_TYPE_INT:
+				values[i].i32 = atoi(str);
+				break;
+			case ZBX_TYPE_FLOAT:
+				values[i].dbl = atof(str);
+				break;
+			default:
+				values[i].str = (char *)str;
+		}
+
+		i++;
+	}
+
+	zbx_mock_assert_int_eq("row values", fields->values_num, i);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_db_insert_t		db_insert;
+	const zbx_db_table_t	*table;
+	zbx_vector_ptr_t	fields;
+	zbx_mock_handle_t	hfields, hfield, hrows, hrow;
+	zbx_mock_error_t	err;
+	zbx_db_value_t		*values, **pvalues;
+	const char		*name;
+	zbx_uint64_t		rows;
+	double			time_spent;
+	int			i, rows_num = 0;
+
+	ZBX_UNUSED(state);
+
+#ifndef HAVE_POSTGRESQL
+	skip();
+#endif
+	if (NULL == (table = zbx_db_get_table(zbx_mock_get_parameter_string("in.table"))))
+		fail_msg("unknown table");
+
+	zbx_vector_ptr_create(&fields);
+
+	hfields = zbx_mock_get_parameter_handle("in.fields");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hfields, &hfield))))
+	{
+		const zbx_db_field_t	*field;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hfield, &name)))
+			fail_msg("Cannot read field name: %s", zbx_mock_error_string(err));
+
+		if (NULL == (field = zbx_db_get_field(table, name)))
+			fail_msg("unknown field \"%s\"", name);
+
+		zbx_vector_ptr_append(&fields, (void *)field);
+	}
+
+	zbx_db_insert_prepare_dyn(&db_insert, table, (const zbx_db_field_t **)fields.values, fields.values_num);
+	zbx_db_insert_use_copy(&db_insert);
+
+	values = (zbx_db_value_t *)zbx_malloc(NULL, sizeof(zbx_db_value_t) * (size_t)fields.values_num);
+	pvalues = (zbx_db_value_t **)zbx_malloc(NULL, sizeof(zbx_db_value_t *) * (size_t)fields.values_num);
+
+	for (i = 0; i < fields.values_num; i++)
+		pvalues[i] = &values[i];
+
+	hrows = zbx_mock_get_parameter_handle("in.rows");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hrows, &hrow))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read row: %s", zbx_mock_error_string(err));
+
+		read_row(hrow, &fields, values);
+		zbx_db_insert_add_values_dyn(&db_insert, pvalues, fields.values_num);
+		rows_num++;
+	}
+
+	zbx_mock_assert_int_eq("insert result", SUCCEED, zbx_db_insert_execute(&db_insert));
+	zbx_mock_assert_str_eq("copy statement", zbx_mock_get_parameter_string("out.sql"), copy_sql);
+	zbx_mock_assert_str_eq("copy data", zbx_mock_get_parameter_string("out.data"), copy_data);
+
+	zbx_db_get_copy_stats(&rows, &time_spent);
+	zbx_mock_assert_uint64_eq("copied rows", (zbx_uint64_t)rows_num, rows);
+
+	/* statistics are reset after being retrieved */
+	zbx_db_get_copy_stats(&rows, &time_spent);
+	zbx_mock_assert_uint64_eq("copied rows after reset", 0, rows);
+
+	zbx_db_insert_clean(&db_insert);
+	zbx_free(pvalues);
+	zbx_free(values);
+	zbx_vector_ptr_destroy(&fields);
+	zbx_free(copy_sql);
+	zbx_free(copy_data);
+}
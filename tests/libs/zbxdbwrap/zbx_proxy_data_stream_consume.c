@@ -0,0 +1,82 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxdbwrap.h"
+#include "zbxstr.h"
+
+#include "proxy_data_stream_test.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	fragments, fragment;
+	zbx_socket_t		s;
+	zbx_timespec_t		ts = {0, 0};
+	zbx_proxy_data_stream_t	*stream;
+	char			*data = NULL;
+	const char		*value;
+	size_t			data_alloc = 0, data_offset = 0;
+	int			ret = SUCCEED;
+
+	ZBX_UNUSED(state);
+
+	memset(&s, 0, sizeof(s));
+	stream = zbx_proxy_data_stream_create(&s, &ts, 0);
+
+	fragments = zbx_mock_get_parameter_handle("in.fragments");
+
+	/* request is received in fragments, consumer is called after each fragment like zbx_tcp_recv_consume() */
+	while (SUCCEED == ret && ZBX_MOCK_SUCCESS == zbx_mock_vector_element(fragments, &fragment))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(fragment, &value))
+			fail_msg("cannot read fragment");
+
+		zbx_strcpy_alloc(&data, &data_alloc, &data_offset, value);
+
+		if (0 == strcmp(proxy_data_stream_state_test(stream), "head") &&
+				SUCCEED != proxy_data_stream_start_test(stream, data, data_offset))
+		{
+			if (0 == strcmp(proxy_data_stream_state_test(stream), "off"))
+				ret = FAIL;
+
+			continue;
+		}
+
+		ret = zbx_proxy_data_stream_consume(data, &data_offset, stream);
+	}
+
+	zbx_mock_assert_result_eq("zbx_proxy_data_stream_consume() return code",
+			zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")), ret);
+	zbx_mock_assert_str_eq("stream state", zbx_mock_get_parameter_string("out.state"),
+			proxy_data_stream_state_test(stream));
+	zbx_mock_assert_int_eq("complete rows", (int)zbx_mock_get_parameter_uint64("out.rows"),
+			proxy_data_stream_rows_test(stream));
+
+	/* history rows are not removed from request before a complete batch is received */
+	data[data_offset] = '\0';
+	zbx_mock_assert_str_eq("request data", zbx_mock_get_parameter_string("out.data"), data);
+
+	zbx_free(data);
+	zbx_proxy_data_stream_free(stream);
+}
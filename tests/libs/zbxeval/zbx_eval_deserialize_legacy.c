@@ -0,0 +1,149 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxeval.h"
+#include "zbxserialize.h"
+#include "mock_eval.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: serializes evaluation context tokens in the format used before    *
+ *          compiled instructions were added to serialized data              *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned char	*mock_serialize_legacy(const zbx_eval_context_t *ctx)
+{
+	unsigned char	*buffer, *ptr, *data;
+	size_t		buffer_size = 6;
+	zbx_uint32_t	len, len_offset;
+	int		i;
+
+	for (i = 0; i < ctx->stack.values_num; i++)
+	{
+		buffer_size += 23 + sizeof(zbx_uint64_t);
+
+		if (ZBX_VARIANT_STR == ctx->stack.values[i].value.type)
+			buffer_size += strlen(ctx->stack.values[i].value.data.str) + 1;
+	}
+
+	ptr = buffer = (unsigned char *)zbx_malloc(NULL, buffer_size);
+
+	ptr += zbx_serialize_uint31_compact(ptr, ctx->stack.values_num);
+
+	for (i = 0; i < ctx->stack.values_num; i++)
+	{
+		const zbx_eval_token_t	*token = &ctx->stack.values[i];
+
+		ptr += zbx_serialize_value(ptr, token->type);
+		ptr += zbx_serialize_uint31_compact(ptr, token->opt);
+		ptr += zbx_serialize_uint31_compact(ptr, token->loc.l);
+		ptr += zbx_serialize_uint31_compact(ptr, token->loc.r);
+
+		*ptr++ = token->value.type;
+
+		switch (token->value.type)
+		{
+			case ZBX_VARIANT_UI64:
+				ptr += zbx_serialize_uint64(ptr, token->value.data.ui64);
+				break;
+			case ZBX_VARIANT_DBL:
+				ptr += zbx_serialize_double(ptr, token->value.data.dbl);
+				break;
+			case ZBX_VARIANT_STR:
+				len = strlen(token->value.data.str) + 1;
+				memcpy(ptr, token->value.data.str, len);
+				ptr += len;
+				break;
+			case ZBX_VARIANT_NONE:
+				break;
+			default:
+				fail_msg("unsupported token #%d value type %d", i, token->value.type);
+		}
+	}
+
+	len = ptr - buffer;
+
+	data = (unsigned char *)zbx_malloc(NULL, len + 6);
+	len_offset = zbx_serialize_uint31_compact(data, len);
+	memcpy(data + len_offset, buffer, len);
+
+	zbx_free(buffer);
+
+	return data;
+}
+
+static void	mock_eval_execute(zbx_eval_context_t *ctx)
+{
+	char		*error = NULL;
+	zbx_variant_t	value;
+
+	if (SUCCEED != zbx_eval_execute(ctx, NULL, &value, &error))
+		fail_msg("cannot execute expression: %s", error);
+
+	zbx_mock_assert_str_eq("output value", zbx_mock_get_parameter_string("out.value"),
+			zbx_variant_value_desc(&value));
+
+	zbx_variant_clear(&value);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_eval_context_t	ctx, ctx_legacy, ctx_compiled;
+	char			*error = NULL;
+	const char		*expression;
+	zbx_uint64_t		rules;
+	unsigned char		*data;
+
+	ZBX_UNUSED(state);
+
+	rules = mock_eval_read_rules("in.rules");
+	expression = zbx_mock_get_parameter_string("in.expression");
+
+	if (SUCCEED != zbx_eval_parse_expression(&ctx, expression, rules, &error))
+		fail_msg("failed to parse expression: %s", error);
+
+	mock_eval_read_values(&ctx, "in.replace");
+
+	/* data serialized without instructions must be executed by interpreting the token stack */
+	data = mock_serialize_legacy(&ctx);
+	zbx_eval_deserialize(&ctx_legacy, expression, rules, data);
+	zbx_free(data);
+
+	zbx_mock_assert_int_eq("legacy instructions", 0, ctx_legacy.code_num);
+	mock_eval_execute(&ctx_legacy);
+
+	/* re-serialized context must be executed by compiled instructions with the same result */
+	zbx_eval_serialize(&ctx_legacy, NULL, &data);
+	zbx_eval_deserialize(&ctx_compiled, expression, rules, data);
+	zbx_free(data);
+
+	if (0 == ctx_compiled.code_num)
+		fail_msg("expression was not compiled");
+
+	mock_eval_execute(&ctx_compiled);
+
+	zbx_eval_clear(&ctx_compiled);
+	zbx_eval_clear(&ctx_legacy);
+	zbx_eval_clear(&ctx);
+}
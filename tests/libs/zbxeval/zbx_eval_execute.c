@@ -27,13 +27,50 @@
 #include "zbxlog.h"
 #include "mock_eval.h"
 
+static void	mock_eval_execute(zbx_eval_context_t *ctx, const zbx_timespec_t *pts, int expected_ret)
+{
+	char		*error = NULL;
+	int		returned_ret;
+	zbx_variant_t	value;
+
+	returned_ret = zbx_eval_execute(ctx, pts, &value, &error);
+
+	if (SUCCEED != returned_ret)
+		printf("ERROR: %s\n", error);
+
+	zbx_mock_assert_result_eq("return value", expected_ret, returned_ret);
+
+	if (SUCCEED == expected_ret)
+	{
+		/* use custom epsilon for floating point values to account for */
+		/* rounding differences with various systems/libs              */
+		if (ZBX_VARIANT_DBL == value.type)
+		{
+			double	expected_value;
+
+			expected_value = atof(zbx_mock_get_parameter_string("out.value"));
+
+			if (1e-12 < fabs(value.data.dbl - expected_value))
+				fail_msg("Expected value \"%f\" while got \"%f\"", expected_value, value.data.dbl);
+		}
+		else
+		{
+			zbx_mock_assert_str_eq("output value", zbx_mock_get_parameter_string("out.value"),
+				zbx_variant_value_desc(&value));
+		}
+
+		zbx_variant_clear(&value);
+	}
+
+	zbx_free(error);
+}
+
 void	zbx_mock_test_entry(void **state)
 {
 	zbx_eval_context_t	ctx;
 	char			*error = NULL;
 	zbx_uint64_t		rules;
-	int			expected_ret, returned_ret;
-	zbx_variant_t		value;
+	int			expected_ret;
 	zbx_mock_handle_t	htime;
 	zbx_timespec_t		ts, *pts = NULL;
 
@@ -68,34 +105,11 @@ void	zbx_mock_test_entry(void **state)
 		pts = &ts;
 	}
 
-	returned_ret = zbx_eval_execute(&ctx, pts, &value, &error);
-
-	if (SUCCEED != returned_ret)
-		printf("ERROR: %s\n", error);
-
-	zbx_mock_assert_result_eq("return value", expected_ret, returned_ret);
+	mock_eval_execute(&ctx, pts, expected_ret);
 
-	if (SUCCEED == expected_ret)
-	{
-		/* use custom epsilon for floating point values to account for */
-		/* rounding differences with various systems/libs              */
-		if (ZBX_VARIANT_DBL == value.type)
-		{
-			double	expected_value;
-
-			expected_value = atof(zbx_mock_get_parameter_string("out.value"));
-
-			if (1e-12 < fabs(value.data.dbl - expected_value))
-				fail_msg("Expected value \"%f\" while got \"%f\"", expected_value, value.data.dbl);
-		}
-		else
-		{
-			zbx_mock_assert_str_eq("output value", zbx_mock_get_parameter_string("out.value"),
-				zbx_variant_value_desc(&value));
-		}
-
-		zbx_variant_clear(&value);
-	}
+	/* compiled expression must return the same result */
+	zbx_eval_compile(&ctx);
+	mock_eval_execute(&ctx, pts, expected_ret);
 out:
 	zbx_free(error);
 	zbx_eval_clear(&ctx);
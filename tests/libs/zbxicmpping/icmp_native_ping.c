@@ -0,0 +1,142 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxicmpping/icmpnative.h"
+
+#include "zbxcomms.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the process is allowed to open ICMP datagram or raw     *
+ *          socket of the specified address family                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmp_socket_allowed(int family)
+{
+	int	fd, protocol = IPPROTO_ICMP;
+
+#ifdef HAVE_IPV6
+	if (AF_INET6 == family)
+		protocol = IPPROTO_ICMPV6;
+#endif
+	if (-1 == (fd = socket(family, SOCK_DGRAM, protocol)) && -1 == (fd = socket(family, SOCK_RAW, protocol)))
+		return FAIL;
+
+	close(fd);
+
+	return SUCCEED;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	haddrs, haddr, hhosts, hhost, herror;
+	ZBX_FPING_HOST		*hosts;
+	const char		*addr, *host_error;
+	char			error[MAX_STRING_LEN];
+	int			i, hosts_num, count, family = AF_INET;
+
+	ZBX_UNUSED(state);
+
+	if (0 == strcmp(zbx_mock_get_parameter_string("in.family"), "ipv6"))
+	{
+#ifdef HAVE_IPV6
+		family = AF_INET6;
+#else
+		skip();
+#endif
+	}
+
+	/* ICMP sockets need net.ipv4.ping_group_range to include the process group or CAP_NET_RAW capability */
+	if (SUCCEED != icmp_socket_allowed(family))
+		skip();
+
+	haddrs = zbx_mock_get_parameter_handle("in.addresses");
+
+	for (hosts_num = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(haddrs, &haddr); hosts_num++)
+		;
+
+	hosts = (ZBX_FPING_HOST *)zbx_calloc(NULL, (size_t)hosts_num, sizeof(ZBX_FPING_HOST));
+	haddrs = zbx_mock_get_parameter_handle("in.addresses");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(haddrs, &haddr); i++)
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(haddr, &addr))
+			fail_msg("invalid address");
+
+		hosts[i].addr = zbx_strdup(NULL, addr);
+	}
+
+	count = (int)zbx_mock_get_parameter_uint64("in.count");
+
+	zbx_mock_assert_int_eq("icmp_native_ping() return value", SUCCEED, icmp_native_ping(hosts, hosts_num, count,
+			(int)zbx_mock_get_parameter_uint64("in.period"), (int)zbx_mock_get_parameter_uint64("in.size"),
+			(int)zbx_mock_get_parameter_uint64("in.timeout"), 0, 0, NULL, error, sizeof(error)));
+
+	hhosts = zbx_mock_get_parameter_handle("out.hosts");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hhosts, &hhost); i++)
+	{
+		if (i == hosts_num)
+			fail_msg("expected more hosts");
+
+		zbx_mock_assert_int_eq("sent requests", (int)zbx_mock_get_object_member_uint64(hhost, "cnt"),
+				hosts[i].cnt);
+		zbx_mock_assert_int_eq("received replies", (int)zbx_mock_get_object_member_uint64(hhost, "rcv"),
+				hosts[i].rcv);
+
+		if (0 != hosts[i].rcv)
+		{
+			if (0 > hosts[i].min || hosts[i].min > hosts[i].max)
+				fail_msg("invalid response time range %f - %f", hosts[i].min, hosts[i].max);
+
+			if (hosts[i].sum < hosts[i].max || hosts[i].sum > hosts[i].max * hosts[i].rcv)
+				fail_msg("invalid response time sum %f", hosts[i].sum);
+		}
+
+		/* the per request statuses are used only while pinging */
+		zbx_mock_assert_ptr_eq("status", NULL, hosts[i].status);
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hhost, "error", &herror))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_string(herror, &host_error))
+				fail_msg("invalid host error");
+
+			zbx_mock_assert_str_eq("host error", host_error, hosts[i].error);
+		}
+		else
+			zbx_mock_assert_ptr_eq("host error", NULL, hosts[i].error);
+	}
+
+	zbx_mock_assert_int_eq("hosts", hosts_num, i);
+
+	for (i = 0; i < hosts_num; i++)
+	{
+		zbx_free(hosts[i].addr);
+		zbx_free(hosts[i].dnsname);
+		zbx_free(hosts[i].error);
+	}
+
+	zbx_free(hosts);
+}
@@ -0,0 +1,431 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxshmem.h"
+#include "zbxalgo.h"
+
+#define SHMEM_TEST_SLAB_SIZE	4096
+#define SHMEM_TEST_FILL_SIZE	1024
+
+#define CLASSES		1
+#define FALLBACK	2
+#define RELEASE		3
+#define REPLACE		4
+
+typedef struct
+{
+	zbx_uint64_t	size;
+	int		count;
+	int		slabs;
+	void		**ptrs;
+}
+zbx_shmem_test_objects_t;
+
+static int	get_type(const char *str)
+{
+	if (0 == strcmp(str, "CLASSES"))
+		return CLASSES;
+
+	if (0 == strcmp(str, "FALLBACK"))
+		return FALLBACK;
+
+	if (0 == strcmp(str, "RELEASE"))
+		return RELEASE;
+
+	if (0 == strcmp(str, "REPLACE"))
+		return REPLACE;
+
+	fail_msg("unknown test type: %s", str);
+
+	return FAIL;
+}
+
+static int	get_class_index(zbx_uint64_t size)
+{
+	return (int)((size + 7) >> 3) - 1;
+}
+
+static zbx_shmem_info_t	*shmem_create(void)
+{
+	zbx_shmem_info_t	*info;
+	char			*error = NULL;
+
+	if (SUCCEED != zbx_shmem_create(&info, zbx_mock_get_parameter_uint64("in.size"), "test", "test", 1, &error))
+		fail_msg("cannot create shared memory: %s", error);
+
+	if (SUCCEED != zbx_shmem_enable_slabs(info, &error))
+		fail_msg("cannot enable slabs: %s", error);
+
+	return info;
+}
+
+static int	shmem_slabs_num(const zbx_shmem_info_t *info)
+{
+	zbx_shmem_stats_t	stats;
+	int			i, slabs_num = 0;
+
+	zbx_shmem_get_stats(info, &stats);
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+		slabs_num += (int)stats.slab_classes[i].slabs_num;
+
+	return slabs_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks that free slab objects are not accounted as used memory    *
+ *                                                                            *
+ * Parameters: info           - [IN] the shared memory                        *
+ *             used_size_base - [IN] the used size before any allocations     *
+ *                                                                            *
+ ******************************************************************************/
+static void	shmem_check_used_size(const zbx_shmem_info_t *info, zbx_uint64_t used_size_base)
+{
+	zbx_shmem_stats_t	stats;
+	int			i;
+	zbx_uint64_t		used_size = used_size_base;
+
+	zbx_shmem_get_stats(info, &stats);
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		/* object size includes 8 byte header */
+		zbx_uint64_t	object_size = (zbx_uint64_t)(i + 2) * 8;
+
+		used_size += stats.slab_classes[i].slabs_num * SHMEM_TEST_SLAB_SIZE;
+		used_size -= stats.slab_classes[i].free_objects * object_size;
+	}
+
+	zbx_mock_assert_uint64_eq("used size", used_size, stats.used_size);
+}
+
+static int	shmem_read_objects(zbx_shmem_test_objects_t *objects)
+{
+	zbx_mock_handle_t	hobjects, hobject;
+	zbx_mock_error_t	err;
+	int			objects_num = 0;
+
+	hobjects = zbx_mock_get_parameter_handle("in.objects");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hobjects, &hobject))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read objects: %s", zbx_mock_error_string(err));
+
+		if (ZBX_SHMEM_SLAB_CLASS_COUNT == objects_num)
+			fail_msg("too many object sizes");
+
+		objects[objects_num].size = zbx_mock_get_object_member_uint64(hobject, "size");
+		objects[objects_num].count = zbx_mock_get_object_member_int(hobject, "count");
+		objects[objects_num].slabs = zbx_mock_get_object_member_int(hobject, "slabs");
+		objects[objects_num].ptrs = (void **)zbx_malloc(NULL, sizeof(void *) *
+				(size_t)objects[objects_num].count);
+		objects_num++;
+	}
+
+	return objects_num;
+}
+
+static void	test_shmem_slab_classes(void)
+{
+	zbx_shmem_info_t		*info;
+	zbx_shmem_stats_t		stats;
+	zbx_shmem_test_objects_t	objects[ZBX_SHMEM_SLAB_CLASS_COUNT];
+	zbx_uint64_t			used_size;
+	int				i, j, objects_num, allocated, class_index;
+	char				msg[64];
+
+	info = shmem_create();
+	zbx_shmem_get_stats(info, &stats);
+	used_size = stats.used_size;
+
+	objects_num = shmem_read_objects(objects);
+
+	/* interleave allocations of different size classes */
+	for (j = 0, allocated = 1; 0 != allocated; j++)
+	{
+		for (i = 0, allocated = 0; i < objects_num; i++)
+		{
+			if (j >= objects[i].count)
+				continue;
+
+			if (NULL == (objects[i].ptrs[j] = zbx_shmem_malloc(info, NULL, objects[i].size)))
+				fail_msg("cannot allocate %d byte object", (int)objects[i].size);
+
+			memset(objects[i].ptrs[j], 0xff, objects[i].size);
+			allocated++;
+		}
+	}
+
+	zbx_shmem_get_stats(info, &stats);
+
+	for (i = 0; i < objects_num; i++)
+	{
+		class_index = get_class_index(objects[i].size);
+
+		zbx_snprintf(msg, sizeof(msg), "%d byte objects", (int)objects[i].size);
+		zbx_mock_assert_int_eq(msg, objects[i].count, (int)stats.slab_classes[class_index].used_objects);
+
+		zbx_snprintf(msg, sizeof(msg), "%d byte object slabs", (int)objects[i].size);
+		zbx_mock_assert_int_eq(msg, objects[i].slabs, (int)stats.slab_classes[class_index].slabs_num);
+	}
+
+	shmem_check_used_size(info, used_size);
+
+	for (i = 0; i < objects_num; i++)
+	{
+		for (j = 0; j < objects[i].count; j++)
+			zbx_shmem_free(info, objects[i].ptrs[j]);
+
+		zbx_free(objects[i].ptrs);
+	}
+
+	zbx_shmem_get_stats(info, &stats);
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+		zbx_mock_assert_int_eq("used objects after free", 0, (int)stats.slab_classes[i].used_objects);
+
+	zbx_mock_assert_int_eq("slabs kept after free", (int)zbx_mock_get_parameter_uint64("out.slabs"),
+			shmem_slabs_num(info));
+
+	shmem_check_used_size(info, used_size);
+
+	zbx_shmem_destroy(info);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: fills shared memory with general allocator chunks                 *
+ *                                                                            *
+ * Parameters: info - [IN] the shared memory                                  *
+ *             ptrs - [OUT] the allocated chunks                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	shmem_fill(zbx_shmem_info_t *info, zbx_vector_ptr_t *ptrs)
+{
+	void	*ptr;
+
+	while (NULL != (ptr = zbx_shmem_malloc(info, NULL, SHMEM_TEST_FILL_SIZE)))
+		zbx_vector_ptr_append(ptrs, ptr);
+
+	if (0 == ptrs->values_num)
+		fail_msg("cannot fill shared memory");
+}
+
+static void	test_shmem_slab_fallback(void)
+{
+	zbx_shmem_info_t	*info;
+	zbx_vector_ptr_t	ptrs;
+	void			*ptr;
+	int			i;
+
+	zbx_vector_ptr_create(&ptrs);
+	info = shmem_create();
+
+	/* allocations above slab size classes are served by the general allocator */
+	ptr = zbx_shmem_malloc(info, NULL, ZBX_SHMEM_SLAB_MAX_ALLOC + 1);
+	zbx_mock_assert_ptr_ne("large allocation", NULL, ptr);
+	zbx_mock_assert_int_eq("slabs after large allocation", 0, shmem_slabs_num(info));
+	zbx_shmem_free(info, ptr);
+
+	/* without space for a new slab small allocations are served by the general allocator */
+	shmem_fill(info, &ptrs);
+	zbx_shmem_free(info, ptrs.values[ptrs.values_num - 1]);
+	ptrs.values_num--;
+
+	ptr = zbx_shmem_malloc(info, NULL, (size_t)zbx_mock_get_parameter_uint64("in.object"));
+	zbx_mock_assert_ptr_ne("small allocation", NULL, ptr);
+	zbx_mock_assert_int_eq("slabs after small allocation", 0, shmem_slabs_num(info));
+
+	/* reallocating general chunk within slab size class must keep it working */
+	ptr = zbx_shmem_realloc(info, ptr, SHMEM_TEST_FILL_SIZE / 2);
+	zbx_mock_assert_ptr_ne("reallocation", NULL, ptr);
+	zbx_shmem_free(info, ptr);
+
+	for (i = 0; i < ptrs.values_num; i++)
+		zbx_shmem_free(info, ptrs.values[i]);
+
+	zbx_vector_ptr_destroy(&ptrs);
+	zbx_shmem_destroy(info);
+}
+
+static void	test_shmem_slab_release(void)
+{
+	zbx_shmem_info_t		*info;
+	zbx_shmem_test_objects_t	objects[ZBX_SHMEM_SLAB_CLASS_COUNT];
+	zbx_vector_ptr_t		ptrs;
+	void				*ptr;
+	int				i, j, objects_num;
+
+	zbx_vector_ptr_create(&ptrs);
+	info = shmem_create();
+
+	objects_num = shmem_read_objects(objects);
+
+	for (i = 0; i < objects_num; i++)
+	{
+		for (j = 0; j < objects[i].count; j++)
+		{
+			if (NULL == (objects[i].ptrs[j] = zbx_shmem_malloc(info, NULL, objects[i].size)))
+				fail_msg("cannot allocate %d byte object", (int)objects[i].size);
+		}
+	}
+
+	shmem_fill(info, &ptrs);
+
+	for (i = 0; i < objects_num; i++)
+	{
+		for (j = 0; j < objects[i].count; j++)
+			zbx_shmem_free(info, objects[i].ptrs[j]);
+
+		zbx_free(objects[i].ptrs);
+	}
+
+	zbx_mock_assert_int_eq("empty slabs kept", (int)zbx_mock_get_parameter_uint64("out.slabs"),
+			shmem_slabs_num(info));
+
+	/* the general allocator must get memory of empty slabs when it runs out of memory */
+	ptr = zbx_shmem_malloc(info, NULL, (size_t)zbx_mock_get_parameter_uint64("in.allocation"));
+	zbx_mock_assert_ptr_ne("allocation from released slabs", NULL, ptr);
+	zbx_mock_assert_int_eq("slabs after release", 0, shmem_slabs_num(info));
+
+	zbx_shmem_free(info, ptr);
+
+	for (i = 0; i < ptrs.values_num; i++)
+		zbx_shmem_free(info, ptrs.values[i]);
+
+	zbx_vector_ptr_destroy(&ptrs);
+	zbx_shmem_destroy(info);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns next pseudo random number of reproducible sequence        *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	shmem_rand(zbx_uint64_t *seed)
+{
+	*seed = *seed * __UINT64_C(6364136223846793005) + __UINT64_C(1442695040888963407);
+
+	return *seed >> 33;
+}
+
+static void	shmem_check_pattern(const unsigned char *ptr, size_t size, unsigned char pattern)
+{
+	size_t	i;
+
+	for (i = 0; i < size; i++)
+	{
+		if (pattern != ptr[i])
+			fail_msg("allocation data overwritten at offset " ZBX_FS_SIZE_T, (zbx_fs_size_t)i);
+	}
+}
+
+/* replaces random live allocations like the shared memory benchmark and checks that */
+/* allocations do not overlap and memory accounting stays consistent                  */
+static void	test_shmem_slab_replace(void)
+{
+	zbx_shmem_info_t	*info;
+	zbx_shmem_stats_t	stats;
+	zbx_uint64_t		used_size, seed, ops_num;
+	unsigned char		**ptrs;
+	size_t			*sizes, size_max;
+	int			i, slot, slots_num;
+
+	info = shmem_create();
+	zbx_shmem_get_stats(info, &stats);
+	used_size = stats.used_size;
+
+	seed = zbx_mock_get_parameter_uint64("in.seed");
+	ops_num = zbx_mock_get_parameter_uint64("in.ops");
+	size_max = (size_t)zbx_mock_get_parameter_uint64("in.size_max");
+	slots_num = (int)zbx_mock_get_parameter_uint64("in.slots");
+
+	ptrs = (unsigned char **)zbx_malloc(NULL, sizeof(unsigned char *) * (size_t)slots_num);
+	sizes = (size_t *)zbx_malloc(NULL, sizeof(size_t) * (size_t)slots_num);
+
+	for (i = 0; i < slots_num; i++)
+	{
+		sizes[i] = 1 + shmem_rand(&seed) % size_max;
+
+		if (NULL == (ptrs[i] = (unsigned char *)zbx_shmem_malloc(info, NULL, sizes[i])))
+			fail_msg("cannot allocate " ZBX_FS_SIZE_T " bytes", (zbx_fs_size_t)sizes[i]);
+
+		memset(ptrs[i], (unsigned char)i, sizes[i]);
+	}
+
+	for (; 0 != ops_num; ops_num--)
+	{
+		slot = (int)(shmem_rand(&seed) % (zbx_uint64_t)slots_num);
+
+		shmem_check_pattern(ptrs[slot], sizes[slot], (unsigned char)slot);
+		zbx_shmem_free(info, ptrs[slot]);
+
+		sizes[slot] = 1 + shmem_rand(&seed) % size_max;
+
+		if (NULL == (ptrs[slot] = (unsigned char *)zbx_shmem_malloc(info, NULL, sizes[slot])))
+			fail_msg("cannot allocate " ZBX_FS_SIZE_T " bytes", (zbx_fs_size_t)sizes[slot]);
+
+		memset(ptrs[slot], (unsigned char)slot, sizes[slot]);
+	}
+
+	for (i = 0; i < slots_num; i++)
+	{
+		shmem_check_pattern(ptrs[i], sizes[i], (unsigned char)i);
+		zbx_shmem_free(info, ptrs[i]);
+	}
+
+	zbx_shmem_get_stats(info, &stats);
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+		zbx_mock_assert_int_eq("used objects after free", 0, (int)stats.slab_classes[i].used_objects);
+
+	shmem_check_used_size(info, used_size);
+
+	zbx_free(sizes);
+	zbx_free(ptrs);
+	zbx_shmem_destroy(info);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	switch (get_type(zbx_mock_get_parameter_string("in.type")))
+	{
+		case CLASSES:
+			test_shmem_slab_classes();
+			break;
+		case FALLBACK:
+			test_shmem_slab_fallback();
+			break;
+		case RELEASE:
+			test_shmem_slab_release();
+			break;
+		case REPLACE:
+			test_shmem_slab_replace();
+			break;
+	}
+}
@@ -0,0 +1,131 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxcomms.h"
+#include "zbxsysinfo.h"
+#include "zbxjson.h"
+#include "listener_test.h"
+
+pid_t	*threads;
+int	threads_num;
+
+int	get_process_info_by_thread(int local_server_num, unsigned char *local_process_type, int *local_process_num);
+int	MAIN_ZABBIX_ENTRY(int flags);
+
+int	get_process_info_by_thread(int local_server_num, unsigned char *local_process_type, int *local_process_num)
+{
+	ZBX_UNUSED(local_server_num);
+	ZBX_UNUSED(local_process_type);
+	ZBX_UNUSED(local_process_num);
+
+	return 0;
+}
+
+int	MAIN_ZABBIX_ENTRY(int flags)
+{
+	ZBX_UNUSED(flags);
+
+	return 0;
+}
+
+int	__wrap_zbx_tcp_send_ext(zbx_socket_t *s, const char *data, size_t len, size_t reserved, unsigned char flags,
+		int timeout);
+
+static zbx_vector_str_t	replies;
+
+int	__wrap_zbx_tcp_send_ext(zbx_socket_t *s, const char *data, size_t len, size_t reserved, unsigned char flags,
+		int timeout)
+{
+	ZBX_UNUSED(s);
+	ZBX_UNUSED(reserved);
+	ZBX_UNUSED(flags);
+	ZBX_UNUSED(timeout);
+
+	zbx_vector_str_append(&replies, zbx_dsprintf(NULL, "%.*s", (int)len, data));
+
+	return SUCCEED;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hreplies, hreply, hvalue;
+	zbx_mock_error_t	err;
+	zbx_socket_t		s;
+	int			i;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_str_create(&replies);
+
+	zbx_init_library_sysinfo(get_zbx_config_timeout, get_zbx_config_enable_remote_commands,
+			get_zbx_config_log_remote_commands, get_zbx_config_unsafe_user_parameters,
+			get_zbx_config_source_ip);
+	zbx_init_metrics();
+
+	zbx_mock_assert_result_eq("zbx_tcp_connect() return code", SUCCEED,
+			zbx_tcp_connect(&s, NULL, "127.0.0.1", 10050, 0, ZBX_TCP_SEC_UNENCRYPTED, NULL, NULL));
+
+	process_listener_test(&s, 3);
+
+	zbx_tcp_close(&s);
+
+	hreplies = zbx_mock_get_parameter_handle("out.replies");
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hreplies, &hreply))); i++)
+	{
+		struct zbx_json_parse	jp;
+		const char		*tag;
+		char			version[MAX_STRING_LEN], *value = NULL;
+		size_t			value_alloc = 0;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read reply: %s", zbx_mock_error_string(err));
+
+		if (i >= replies.values_num)
+			fail_msg("expected reply #%d was not sent", i + 1);
+
+		if (SUCCEED != zbx_json_open(replies.values[i], &jp))
+			fail_msg("invalid reply \"%s\": %s", replies.values[i], zbx_json_strerror());
+
+		if (SUCCEED != zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_VERSION, version, sizeof(version), NULL))
+			fail_msg("missing version in reply \"%s\"", replies.values[i]);
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hreply, ZBX_PROTO_TAG_VALUE, &hvalue))
+			tag = ZBX_PROTO_TAG_VALUE;
+		else
+			tag = ZBX_PROTO_TAG_ERROR;
+
+		if (SUCCEED != zbx_json_value_by_name_dyn(&jp, tag, &value, &value_alloc, NULL))
+			fail_msg("missing \"%s\" in reply \"%s\"", tag, replies.values[i]);
+
+		zbx_mock_assert_str_eq("reply", zbx_mock_get_object_member_string(hreply, tag), value);
+		zbx_free(value);
+	}
+
+	zbx_mock_assert_int_eq("number of sent replies", i, replies.values_num);
+
+	zbx_vector_str_clear_ext(&replies, zbx_str_free);
+	zbx_vector_str_destroy(&replies);
+}
@@ -0,0 +1,115 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdb.h"
+
+#include "events.h"
+#include "events_test.h"
+
+static void	read_eventids(zbx_mock_handle_t handle, zbx_vector_uint64_t *eventids)
+{
+	zbx_mock_handle_t	heventid;
+	zbx_uint64_t		eventid;
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(handle, &heventid))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(heventid, &eventid))
+			fail_msg("Cannot read eventid");
+
+		zbx_vector_uint64_append(eventids, eventid);
+	}
+}
+
+static void	check_eventids(const char *prefix, int sync, const zbx_vector_uint64_t *expected,
+		const zbx_vector_uint64_t *returned)
+{
+	int	i;
+	char	msg[64];
+
+	zbx_snprintf(msg, sizeof(msg), "sync #%d %s count", sync, prefix);
+	zbx_mock_assert_int_eq(msg, expected->values_num, returned->values_num);
+
+	for (i = 0; i < expected->values_num; i++)
+	{
+		zbx_snprintf(msg, sizeof(msg), "sync #%d %s #%d", sync, prefix, i);
+		zbx_mock_assert_uint64_eq(msg, expected->values[i], returned->values[i]);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	htags, htag, hsyncs, hsync;
+	zbx_vector_str_t	old_tags;
+	zbx_vector_uint64_t	expected, expected_tagged, eventids, tagged;
+	const char		*tag;
+	int			i;
+
+	ZBX_UNUSED(state);
+
+	zbx_mockdb_init();
+	zbx_initialize_events();
+
+	zbx_vector_str_create(&old_tags);
+	zbx_vector_uint64_create(&expected);
+	zbx_vector_uint64_create(&expected_tagged);
+	zbx_vector_uint64_create(&eventids);
+	zbx_vector_uint64_create(&tagged);
+
+	htags = zbx_mock_get_parameter_handle("in.old_tags");
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htags, &htag))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(htag, &tag))
+			fail_msg("Cannot read old event tag");
+
+		zbx_vector_str_append(&old_tags, (char *)tag);
+	}
+	zbx_vector_str_sort(&old_tags, ZBX_DEFAULT_STR_COMPARE_FUNC);
+
+	tag = zbx_mock_get_parameter_string("in.tag");
+
+	hsyncs = zbx_mock_get_parameter_handle("out.syncs");
+	for (i = 1; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hsyncs, &hsync); i++)
+	{
+		read_eventids(zbx_mock_get_object_member_handle(hsync, "problems"), &expected);
+		read_eventids(zbx_mock_get_object_member_handle(hsync, "tagged"), &expected_tagged);
+
+		correlation_problems_sync_test(&old_tags, &eventids, tag, &tagged);
+
+		check_eventids("problems", i, &expected, &eventids);
+		check_eventids("tagged", i, &expected_tagged, &tagged);
+
+		zbx_vector_uint64_clear(&expected);
+		zbx_vector_uint64_clear(&expected_tagged);
+		zbx_vector_uint64_clear(&eventids);
+		zbx_vector_uint64_clear(&tagged);
+	}
+
+	zbx_vector_uint64_destroy(&tagged);
+	zbx_vector_uint64_destroy(&eventids);
+	zbx_vector_uint64_destroy(&expected_tagged);
+	zbx_vector_uint64_destroy(&expected);
+	zbx_vector_str_destroy(&old_tags);
+
+	zbx_uninitialize_events();
+	zbx_mockdb_destroy();
+}
@@ -0,0 +1,55 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "events_test.h"
+
+void	correlation_problems_sync_test(zbx_vector_str_t *old_tags, zbx_vector_uint64_t *eventids, const char *tag,
+		zbx_vector_uint64_t *tag_eventids)
+{
+	int			i;
+	zbx_vector_ptr_t	problems;
+	zbx_corr_problem_t	*problem;
+
+	zbx_vector_str_clear(&correlation_index.old_tags);
+	zbx_vector_str_append_array(&correlation_index.old_tags, old_tags->values, old_tags->values_num);
+
+	correlation_problems_sync();
+
+	for (i = 0; i < correlation_problems.problems_sorted.values_num; i++)
+	{
+		problem = (zbx_corr_problem_t *)correlation_problems.problems_sorted.values[i];
+
+		if (0 == problem->closed)
+			zbx_vector_uint64_append(eventids, problem->eventid);
+	}
+
+	zbx_vector_ptr_create(&problems);
+	correlation_problems_get_by_tag(tag, NULL, &problems);
+
+	for (i = 0; i < problems.values_num; i++)
+	{
+		problem = (zbx_corr_problem_t *)problems.values[i];
+
+		if (0 == problem->closed)
+			zbx_vector_uint64_append(tag_eventids, problem->eventid);
+	}
+
+	zbx_vector_uint64_sort(tag_eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_ptr_destroy(&problems);
+}
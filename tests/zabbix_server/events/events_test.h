@@ -0,0 +1,28 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef EVENTS_TEST_H
+#define EVENTS_TEST_H
+
+#include "zbxalgo.h"
+
+void	correlation_problems_sync_test(zbx_vector_str_t *old_tags, zbx_vector_uint64_t *eventids, const char *tag,
+		zbx_vector_uint64_t *tag_eventids);
+
+#endif /* EVENTS_TEST_H */
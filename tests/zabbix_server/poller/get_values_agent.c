@@ -0,0 +1,137 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxcomms.h"
+#include "zbxsysinfo.h"
+#include "../../../src/zabbix_server/poller/checks_agent.h"
+
+int	__wrap_zbx_tcp_send_ext(zbx_socket_t *s, const char *data, size_t len, size_t reserved, unsigned char flags,
+		int timeout);
+
+static zbx_vector_str_t	requests;
+
+int	__wrap_zbx_tcp_send_ext(zbx_socket_t *s, const char *data, size_t len, size_t reserved, unsigned char flags,
+		int timeout)
+{
+	ZBX_UNUSED(s);
+	ZBX_UNUSED(reserved);
+	ZBX_UNUSED(flags);
+	ZBX_UNUSED(timeout);
+
+	zbx_vector_str_append(&requests, zbx_dsprintf(NULL, "%.*s", (int)len, data));
+
+	return SUCCEED;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hkeys, hkey, hresults, hresult, hrequests, hrequest;
+	zbx_mock_error_t	err;
+	zbx_dc_item_t		items[ZBX_MAX_AGENT_ITEMS];
+	AGENT_RESULT		results[ZBX_MAX_AGENT_ITEMS];
+	int			errcodes[ZBX_MAX_AGENT_ITEMS], num = 0, i;
+	const char		*key;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_str_create(&requests);
+
+	hkeys = zbx_mock_get_parameter_handle("in.keys");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hkeys, &hkey))))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hkey, &key)))
+			fail_msg("Cannot read key: %s", zbx_mock_error_string(err));
+
+		memset(&items[num], 0, sizeof(zbx_dc_item_t));
+		items[num].key = (char *)key;
+		zbx_strlcpy(items[num].host.host, "Zabbix server", sizeof(items[num].host.host));
+		items[num].host.tls_connect = ZBX_TCP_SEC_UNENCRYPTED;
+		items[num].interface.interfaceid = 1;
+		items[num].interface.addr = "127.0.0.1";
+		items[num].interface.port = 10050;
+
+		zbx_init_agent_result(&results[num]);
+		errcodes[num++] = SUCCEED;
+	}
+
+	get_values_agent(items, results, errcodes, num, 3, NULL);
+
+	hrequests = zbx_mock_get_parameter_handle("out.requests");
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hrequests, &hrequest))); i++)
+	{
+		const char	*request;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hrequest, &request)))
+			fail_msg("Cannot read request: %s", zbx_mock_error_string(err));
+
+		if (i >= requests.values_num)
+			fail_msg("expected request \"%s\" was not sent", request);
+
+		zbx_mock_assert_str_eq("sent request", request, requests.values[i]);
+	}
+
+	zbx_mock_assert_int_eq("number of sent requests", i, requests.values_num);
+
+	hresults = zbx_mock_get_parameter_handle("out.results");
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hresults, &hresult))); i++)
+	{
+		int	expected_ret;
+		char	**value;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read result: %s", zbx_mock_error_string(err));
+
+		if (i >= num)
+			fail_msg("too many expected results");
+
+		expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hresult, "return"));
+		zbx_mock_assert_result_eq("return code", expected_ret, errcodes[i]);
+
+		if (SUCCEED == expected_ret)
+		{
+			if (NULL == (value = ZBX_GET_TEXT_RESULT(&results[i])))
+				fail_msg("missing value of key \"%s\"", items[i].key);
+
+			zbx_mock_assert_str_eq("value", zbx_mock_get_object_member_string(hresult, "value"), *value);
+		}
+		else
+		{
+			if (NULL == (value = ZBX_GET_MSG_RESULT(&results[i])))
+				fail_msg("missing error of key \"%s\"", items[i].key);
+
+			zbx_mock_assert_str_eq("error", zbx_mock_get_object_member_string(hresult, "error"), *value);
+		}
+
+		zbx_free_agent_result(&results[i]);
+	}
+
+	zbx_mock_assert_int_eq("number of results", num, i);
+
+	zbx_vector_str_clear_ext(&requests, zbx_str_free);
+	zbx_vector_str_destroy(&requests);
+}
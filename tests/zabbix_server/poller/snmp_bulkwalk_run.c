@@ -0,0 +1,448 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/zabbix_server/poller/checks_snmp.c"
+
+#ifdef HAVE_NETSNMP
+
+#define SNMP_MOCK_REQUESTS_MAX	64
+
+/* OID of simulated agent MIB */
+typedef struct
+{
+	oid		name[MAX_OID_LEN];
+	size_t		name_length;
+	const char	*value;
+}
+zbx_snmp_mock_oid_t;
+
+/* request sent to simulated agent */
+typedef struct
+{
+	struct snmp_pdu		*pdu;
+	netsnmp_callback	callback;
+	void			*magic;
+	int			timeout;
+}
+zbx_snmp_mock_request_t;
+
+static zbx_snmp_mock_oid_t	*mib;
+static int			mib_num;
+
+static zbx_snmp_mock_request_t	requests[SNMP_MOCK_REQUESTS_MAX];
+static int			requests_num, requests_sent, requests_max_pending, lifo;
+static zbx_uint64_t		max_vars;
+static netsnmp_session		session;
+static zbx_vector_uint64_t	timeouts;
+
+int	__wrap_snmp_sess_async_send(void *sessp, netsnmp_pdu *pdu, netsnmp_callback callback, void *cb_data);
+int	__wrap_snmp_sess_select_info2(void *sessp, int *numfds, netsnmp_large_fd_set *fdset, struct timeval *timeout,
+		int *block);
+int	__wrap_netsnmp_large_fd_set_select(int numfds, netsnmp_large_fd_set *readfds, netsnmp_large_fd_set *writefds,
+		netsnmp_large_fd_set *exceptfds, struct timeval *timeout);
+int	__wrap_snmp_sess_read2(void *sessp, netsnmp_large_fd_set *fdset);
+void	__wrap_snmp_sess_timeout(void *sessp);
+int	__wrap_snprint_variable(char *buf, size_t buf_len, const oid *objid, size_t objidlen,
+		const netsnmp_variable_list *variable);
+
+static void	snmp_mock_parse_oid(const char *str, oid *name, size_t *name_length)
+{
+	char	*end;
+
+	for (*name_length = 0; '\0' != *str; str = end + ('.' == *end ? 1 : 0))
+	{
+		if (MAX_OID_LEN == *name_length)
+			fail_msg("OID \"%s\" is too long", str);
+
+		name[(*name_length)++] = (oid)strtoul(str, &end, 10);
+
+		if (end == str || ('\0' != *end && '.' != *end))
+			fail_msg("invalid OID \"%s\"", str);
+	}
+}
+
+static void	snmp_mock_load_mib(void)
+{
+	zbx_mock_handle_t	hmib, hoid;
+	int			i;
+
+	hmib = zbx_mock_get_parameter_handle("in.mib");
+
+	for (mib_num = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hmib, &hoid); mib_num++)
+		;
+
+	mib = (zbx_snmp_mock_oid_t *)zbx_malloc(NULL, sizeof(zbx_snmp_mock_oid_t) * (size_t)MAX(mib_num, 1));
+	hmib = zbx_mock_get_parameter_handle("in.mib");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hmib, &hoid); i++)
+	{
+		snmp_mock_parse_oid(zbx_mock_get_object_member_string(hoid, "oid"), mib[i].name, &mib[i].name_length);
+		mib[i].value = zbx_mock_get_object_member_string(hoid, "value");
+
+		if (0 < i && 0 <= snmp_oid_compare(mib[i - 1].name, mib[i - 1].name_length, mib[i].name,
+				mib[i].name_length))
+		{
+			fail_msg("MIB OIDs must be in ascending order");
+		}
+	}
+}
+
+/* returns index of the first MIB OID following the specified OID */
+static int	snmp_mock_mib_next(const oid *name, size_t name_length)
+{
+	int	i;
+
+	for (i = 0; i < mib_num; i++)
+	{
+		if (0 < snmp_oid_compare(mib[i].name, mib[i].name_length, name, name_length))
+			break;
+	}
+
+	return i;
+}
+
+static void	snmp_mock_add_oid(struct snmp_pdu *response, int index)
+{
+	snmp_pdu_add_variable(response, mib[index].name, mib[index].name_length, ASN_OCTET_STR, mib[index].value,
+			strlen(mib[index].value));
+}
+
+/* builds response of simulated agent to GET, GETNEXT and GETBULK requests */
+static struct snmp_pdu	*snmp_mock_response(const struct snmp_pdu *request)
+{
+	struct snmp_pdu		*response;
+	struct variable_list	*var = request->variables;
+	int			i, index, vars_num = 0;
+
+	response = snmp_pdu_create(SNMP_MSG_RESPONSE);
+	response->errstat = SNMP_ERR_NOERROR;
+
+	switch (request->command)
+	{
+		case SNMP_MSG_GET:
+			for (i = 0; i < mib_num; i++)
+			{
+				if (0 == snmp_oid_compare(mib[i].name, mib[i].name_length, var->name,
+						var->name_length))
+				{
+					break;
+				}
+			}
+
+			if (i == mib_num)
+			{
+				snmp_pdu_add_variable(response, var->name, var->name_length, SNMP_NOSUCHOBJECT,
+						NULL, 0);
+			}
+			else
+				snmp_mock_add_oid(response, i);
+
+			return response;
+		case SNMP_MSG_GETNEXT:
+			vars_num = 1;
+			break;
+		case SNMP_MSG_GETBULK:
+			vars_num = (int)request->max_repetitions;
+			break;
+		default:
+			fail_msg("unexpected request type 0x%02X", (unsigned int)request->command);
+	}
+
+	if (0 != max_vars && (zbx_uint64_t)vars_num > max_vars)
+	{
+		response->errstat = SNMP_ERR_TOOBIG;
+		return response;
+	}
+
+	index = snmp_mock_mib_next(var->name, var->name_length);
+
+	for (i = 0; i < vars_num; i++)
+	{
+		if (index + i == mib_num)
+		{
+			snmp_pdu_add_variable(response, var->name, var->name_length, SNMP_ENDOFMIBVIEW, NULL, 0);
+			break;
+		}
+
+		snmp_mock_add_oid(response, index + i);
+	}
+
+	return response;
+}
+
+int	__wrap_snmp_sess_async_send(void *sessp, netsnmp_pdu *pdu, netsnmp_callback callback, void *cb_data)
+{
+	zbx_snmp_mock_request_t	*request;
+
+	ZBX_UNUSED(sessp);
+
+	if (SNMP_MOCK_REQUESTS_MAX == requests_num)
+		fail_msg("too many pending requests");
+
+	request = &requests[requests_num++];
+	request->pdu = pdu;
+	request->callback = callback;
+	request->magic = cb_data;
+
+	requests_sent++;
+	request->timeout = (FAIL != zbx_vector_uint64_bsearch(&timeouts, (zbx_uint64_t)requests_sent,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC) ? SUCCEED : FAIL);
+
+	if (requests_num > requests_max_pending)
+		requests_max_pending = requests_num;
+
+	return 1;
+}
+
+/* removes the next request to be answered by simulated agent */
+static zbx_snmp_mock_request_t	snmp_mock_pop_request(void)
+{
+	zbx_snmp_mock_request_t	request;
+
+	if (0 == requests_num)
+		fail_msg("no pending requests");
+
+	if (0 != lifo)
+		return requests[--requests_num];
+
+	request = requests[0];
+	memmove(&requests[0], &requests[1], sizeof(zbx_snmp_mock_request_t) * (size_t)--requests_num);
+
+	return request;
+}
+
+static const zbx_snmp_mock_request_t	*snmp_mock_next_request(void)
+{
+	if (0 == requests_num)
+		fail_msg("waiting for response without pending requests");
+
+	return &requests[0 != lifo ? requests_num - 1 : 0];
+}
+
+int	__wrap_snmp_sess_select_info2(void *sessp, int *numfds, netsnmp_large_fd_set *fdset, struct timeval *timeout,
+		int *block)
+{
+	ZBX_UNUSED(sessp);
+	ZBX_UNUSED(fdset);
+	ZBX_UNUSED(timeout);
+
+	*numfds = 1;
+	*block = 1;
+
+	return 1;
+}
+
+int	__wrap_netsnmp_large_fd_set_select(int numfds, netsnmp_large_fd_set *readfds, netsnmp_large_fd_set *writefds,
+		netsnmp_large_fd_set *exceptfds, struct timeval *timeout)
+{
+	ZBX_UNUSED(numfds);
+	ZBX_UNUSED(readfds);
+	ZBX_UNUSED(writefds);
+	ZBX_UNUSED(exceptfds);
+	ZBX_UNUSED(timeout);
+
+	/* timed out requests are reported as select() timeout */
+	return SUCCEED == snmp_mock_next_request()->timeout ? 0 : 1;
+}
+
+int	__wrap_snmp_sess_read2(void *sessp, netsnmp_large_fd_set *fdset)
+{
+	zbx_snmp_mock_request_t	request;
+	struct snmp_pdu		*response;
+
+	ZBX_UNUSED(sessp);
+	ZBX_UNUSED(fdset);
+
+	request = snmp_mock_pop_request();
+	response = snmp_mock_response(request.pdu);
+
+	request.callback(NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE, &session, 0, response, request.magic);
+
+	snmp_free_pdu(response);
+	snmp_free_pdu(request.pdu);
+
+	return 0;
+}
+
+void	__wrap_snmp_sess_timeout(void *sessp)
+{
+	zbx_snmp_mock_request_t	request;
+
+	ZBX_UNUSED(sessp);
+
+	request = snmp_mock_pop_request();
+	request.callback(NETSNMP_CALLBACK_OP_TIMED_OUT, &session, 0, request.pdu, request.magic);
+	snmp_free_pdu(request.pdu);
+}
+
+int	__wrap_snprint_variable(char *buf, size_t buf_len, const oid *objid, size_t objidlen,
+		const netsnmp_variable_list *variable)
+{
+	size_t	i, offset = 0;
+
+	for (i = 0; i < objidlen; i++)
+	{
+		offset += zbx_snprintf(buf + offset, buf_len - offset, "%s%lu", 0 == i ? "" : ".",
+				(unsigned long)objid[i]);
+	}
+
+	offset += zbx_snprintf(buf + offset, buf_len - offset, " = %.*s", (int)variable->val_len,
+			(const char *)variable->val.string);
+
+	return (int)offset;
+}
+
+static int	snmp_mock_get_pdu_type(const char *str)
+{
+	if (0 == strcmp(str, "GETBULK"))
+		return SNMP_MSG_GETBULK;
+
+	if (0 == strcmp(str, "GETNEXT"))
+		return SNMP_MSG_GETNEXT;
+
+	fail_msg("unknown PDU type: %s", str);
+
+	return FAIL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hwalks, hwalk, hparam;
+	zbx_snmp_bulkwalk_t	*walks;
+	zbx_snmp_oid_t		*roots;
+	zbx_dc_item_t		item;
+	int			i, walks_num, ret;
+	char			error[MAX_STRING_LEN];
+	const char		*str;
+
+	ZBX_UNUSED(state);
+
+	snmp_mock_load_mib();
+
+	max_vars = (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.max_vars", &hparam) ?
+			zbx_mock_get_parameter_uint64("in.max_vars") : 0);
+
+	lifo = (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.delivery", &hparam) &&
+			0 == strcmp(zbx_mock_get_parameter_string("in.delivery"), "lifo"));
+
+	zbx_vector_uint64_create(&timeouts);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.timeouts", &hparam))
+	{
+		zbx_mock_handle_t	htimeout;
+		zbx_uint64_t		timeout;
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hparam, &htimeout))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(htimeout, &timeout))
+				fail_msg("invalid request number");
+
+			zbx_vector_uint64_append(&timeouts, timeout);
+		}
+
+		zbx_vector_uint64_sort(&timeouts, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	}
+
+	memset(&item, 0, sizeof(item));
+	zbx_strlcpy(item.host.host, "test", sizeof(item.host.host));
+	item.interface.addr = "127.0.0.1";
+	item.interface.port = 161;
+
+	hwalks = zbx_mock_get_parameter_handle("in.walks");
+
+	for (walks_num = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hwalks, &hwalk); walks_num++)
+		;
+
+	walks = (zbx_snmp_bulkwalk_t *)zbx_calloc(NULL, (size_t)walks_num, sizeof(zbx_snmp_bulkwalk_t));
+	roots = (zbx_snmp_oid_t *)zbx_calloc(NULL, (size_t)walks_num, sizeof(zbx_snmp_oid_t));
+	hwalks = zbx_mock_get_parameter_handle("in.walks");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hwalks, &hwalk); i++)
+	{
+		zbx_snmp_bulkwalk_t	*walk = &walks[i];
+
+		roots[i].str_oid = (char *)zbx_mock_get_object_member_string(hwalk, "oid");
+		snmp_mock_parse_oid(roots[i].str_oid, roots[i].root_oid, &roots[i].root_oid_len);
+
+		walk->root = &roots[i];
+		memcpy(walk->name, walk->root->root_oid, walk->root->root_oid_len * sizeof(oid));
+		walk->name_length = walk->root->root_oid_len;
+		walk->pdu_type = snmp_mock_get_pdu_type(zbx_mock_get_object_member_string(hwalk, "pdu_type"));
+		walk->max_repetitions = (int)zbx_mock_get_object_member_uint64(hwalk, "max_repetitions");
+		walk->max_repetitions_limit = walk->max_repetitions;
+
+		/* walks allocated with zeroed state are ready to send the first request */
+	}
+
+	ret = snmp_bulkwalk_run(NULL, &item, walks, walks_num, error, sizeof(error));
+
+	zbx_mock_assert_int_eq("return value", zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")),
+			ret);
+	zbx_mock_assert_int_eq("pending requests", 0, requests_num);
+	zbx_mock_assert_int_eq("max pending requests", (int)zbx_mock_get_parameter_uint64("out.max_pending"),
+			requests_max_pending);
+
+	if (SUCCEED != ret)
+		zbx_mock_assert_str_eq("error", zbx_mock_get_parameter_string("out.error"), error);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.requests", &hparam))
+	{
+		zbx_mock_assert_int_eq("sent requests", (int)zbx_mock_get_parameter_uint64("out.requests"),
+				requests_sent);
+	}
+
+	hwalks = zbx_mock_get_parameter_handle("out.walks");
+
+	for (i = 0; SUCCEED == ret && ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hwalks, &hwalk); i++)
+	{
+		if (i == walks_num)
+			fail_msg("expected more walks");
+
+		str = zbx_mock_get_object_member_string(hwalk, "results");
+		zbx_mock_assert_str_eq("walk results", str, ZBX_NULL2EMPTY_STR(walks[i].results));
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hwalk, "max_repetitions", &hparam))
+		{
+			zbx_mock_assert_int_eq("max repetitions", (int)zbx_mock_get_object_member_uint64(hwalk,
+					"max_repetitions"), walks[i].max_repetitions);
+		}
+	}
+
+	for (i = 0; i < walks_num; i++)
+		zbx_free(walks[i].results);
+
+	zbx_free(roots);
+	zbx_free(walks);
+	zbx_free(mib);
+	zbx_vector_uint64_destroy(&timeouts);
+}
+#else
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	skip();
+}
+#endif
@@ -0,0 +1,268 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/zabbix_server/snmptrapper/snmptrapper.c"
+
+static zbx_mock_handle_t	hvalues;
+static int			values_num;
+static zbx_vector_str_t		lookups;
+
+int	__wrap_zbx_dc_config_get_snmp_interfaceids_by_addr(const char *addr, zbx_uint64_t **interfaceids);
+size_t	__wrap_zbx_dc_config_get_snmp_items_by_interfaceid(zbx_uint64_t interfaceid, zbx_dc_item_t **items);
+void	__wrap_zbx_dc_config_clean_items(zbx_dc_item_t *items, int *errcodes, size_t num);
+void	__wrap_zbx_dc_requeue_items(const zbx_uint64_t *itemids, const int *lastclocks, const int *errcodes,
+		size_t num);
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros(void);
+void	__wrap_zbx_dc_close_user_macros(zbx_dc_um_handle_t *um_handle);
+int	__wrap_zbx_substitute_key_macros(char **data, zbx_uint64_t *hostid, zbx_dc_item_t *dc_item,
+		const struct zbx_json_parse *jp_row, const zbx_vector_ptr_t *lld_macro_paths, int macro_type,
+		char *error, size_t maxerrlen);
+void	__wrap_zbx_dc_get_expressions_by_name(zbx_vector_expression_t *expressions, const char *name);
+void	__wrap_zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigned char item_value_type,
+		unsigned char item_flags, AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state, char *error);
+void	__wrap_zbx_preprocessor_flush(void);
+void	__wrap_zbx_config_get(zbx_config_t *cfg, zbx_uint64_t flags);
+void	__wrap_zbx_config_clean(zbx_config_t *cfg);
+
+int	__wrap_zbx_dc_config_get_snmp_interfaceids_by_addr(const char *addr, zbx_uint64_t **interfaceids)
+{
+	zbx_mock_handle_t	hinterfaces, hinterface;
+	int			count = 0;
+
+	zbx_vector_str_append(&lookups, zbx_strdup(NULL, addr));
+
+	hinterfaces = zbx_mock_get_parameter_handle("in.interfaces");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hinterfaces, &hinterface))
+	{
+		if (0 != strcmp(addr, zbx_mock_get_object_member_string(hinterface, "addr")))
+			continue;
+
+		*interfaceids = (zbx_uint64_t *)zbx_realloc(*interfaceids, sizeof(zbx_uint64_t) * (size_t)(count + 1));
+		(*interfaceids)[count++] = zbx_mock_get_object_member_uint64(hinterface, "interfaceid");
+	}
+
+	return count;
+}
+
+size_t	__wrap_zbx_dc_config_get_snmp_items_by_interfaceid(zbx_uint64_t interfaceid, zbx_dc_item_t **items)
+{
+	zbx_mock_handle_t	hitems, hitem, hvalue_type;
+	size_t			num = 0;
+	zbx_dc_item_t		*item;
+	const char		*value_type;
+
+	hitems = zbx_mock_get_parameter_handle("in.items");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hitems, &hitem))
+	{
+		if (interfaceid != zbx_mock_get_object_member_uint64(hitem, "interfaceid"))
+			continue;
+
+		*items = (zbx_dc_item_t *)zbx_realloc(*items, sizeof(zbx_dc_item_t) * (num + 1));
+		item = &(*items)[num++];
+		memset(item, 0, sizeof(zbx_dc_item_t));
+
+		item->itemid = zbx_mock_get_object_member_uint64(hitem, "itemid");
+		zbx_strlcpy(item->key_orig, zbx_mock_get_object_member_string(hitem, "key"), sizeof(item->key_orig));
+		item->value_type = ITEM_VALUE_TYPE_TEXT;
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hitem, "value_type", &hvalue_type) &&
+				ZBX_MOCK_SUCCESS == zbx_mock_string(hvalue_type, &value_type) &&
+				0 == strcmp(value_type, "ITEM_VALUE_TYPE_LOG"))
+		{
+			item->value_type = ITEM_VALUE_TYPE_LOG;
+		}
+	}
+
+	return num;
+}
+
+void	__wrap_zbx_dc_config_clean_items(zbx_dc_item_t *items, int *errcodes, size_t num)
+{
+	ZBX_UNUSED(items);
+	ZBX_UNUSED(errcodes);
+	ZBX_UNUSED(num);
+}
+
+void	__wrap_zbx_dc_requeue_items(const zbx_uint64_t *itemids, const int *lastclocks, const int *errcodes,
+		size_t num)
+{
+	ZBX_UNUSED(itemids);
+	ZBX_UNUSED(lastclocks);
+	ZBX_UNUSED(errcodes);
+	ZBX_UNUSED(num);
+}
+
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros(void)
+{
+	return NULL;
+}
+
+void	__wrap_zbx_dc_close_user_macros(zbx_dc_um_handle_t *um_handle)
+{
+	ZBX_UNUSED(um_handle);
+}
+
+int	__wrap_zbx_substitute_key_macros(char **data, zbx_uint64_t *hostid, zbx_dc_item_t *dc_item,
+		const struct zbx_json_parse *jp_row, const zbx_vector_ptr_t *lld_macro_paths, int macro_type,
+		char *error, size_t maxerrlen)
+{
+	ZBX_UNUSED(data);
+	ZBX_UNUSED(hostid);
+	ZBX_UNUSED(dc_item);
+	ZBX_UNUSED(jp_row);
+	ZBX_UNUSED(lld_macro_paths);
+	ZBX_UNUSED(macro_type);
+	ZBX_UNUSED(error);
+	ZBX_UNUSED(maxerrlen);
+
+	return SUCCEED;
+}
+
+void	__wrap_zbx_dc_get_expressions_by_name(zbx_vector_expression_t *expressions, const char *name)
+{
+	ZBX_UNUSED(expressions);
+	ZBX_UNUSED(name);
+}
+
+void	__wrap_zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigned char item_value_type,
+		unsigned char item_flags, AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state, char *error)
+{
+	zbx_mock_handle_t	hvalue;
+	const char		*value;
+
+	ZBX_UNUSED(hostid);
+	ZBX_UNUSED(item_flags);
+	ZBX_UNUSED(ts);
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_vector_element(hvalues, &hvalue))
+		fail_msg("unexpected value for item " ZBX_FS_UI64, itemid);
+
+	values_num++;
+
+	zbx_mock_assert_uint64_eq("itemid", zbx_mock_get_object_member_uint64(hvalue, "itemid"), itemid);
+
+	if (ITEM_STATE_NOTSUPPORTED == state)
+	{
+		zbx_mock_assert_str_eq("error", zbx_mock_get_object_member_string(hvalue, "error"), error);
+		return;
+	}
+
+	value = zbx_mock_get_object_member_string(hvalue, "value");
+
+	if (ITEM_VALUE_TYPE_LOG == item_value_type)
+	{
+		if (!ZBX_ISSET_LOG(result))
+			fail_msg("log value was not set for item " ZBX_FS_UI64, itemid);
+
+		zbx_mock_assert_str_eq("log value", value, result->log->value);
+	}
+	else
+	{
+		if (!ZBX_ISSET_TEXT(result))
+			fail_msg("text value was not set for item " ZBX_FS_UI64, itemid);
+
+		zbx_mock_assert_str_eq("text value", value, result->text);
+	}
+}
+
+void	__wrap_zbx_preprocessor_flush(void)
+{
+}
+
+void	__wrap_zbx_config_get(zbx_config_t *cfg, zbx_uint64_t flags)
+{
+	ZBX_UNUSED(flags);
+
+	memset(cfg, 0, sizeof(zbx_config_t));
+	cfg->snmptrap_logging = ZBX_SNMPTRAP_LOGGING_ENABLED;
+}
+
+void	__wrap_zbx_config_clean(zbx_config_t *cfg)
+{
+	ZBX_UNUSED(cfg);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hchunks, hchunk, hlookups, hlookup;
+	const char		*chunk, *addr;
+	size_t			len;
+	int			i;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_str_create(&lookups);
+	hvalues = zbx_mock_get_parameter_handle("out.values");
+	values_num = 0;
+
+	buffer = (char *)zbx_malloc(NULL, ZBX_SNMPTRAP_BUFFER_LEN);
+	*buffer = '\0';
+	offset = 0;
+
+	/* the chunks are parsed as they would be read from the trap file */
+	hchunks = zbx_mock_get_parameter_handle("in.chunks");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hchunks, &hchunk))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hchunk, &chunk))
+			fail_msg("invalid trap file chunk");
+
+		len = strlen(chunk);
+		memcpy(buffer + offset, chunk, len + 1);
+		parse_traps(0);
+	}
+
+	zbx_mock_assert_int_eq("pending trap data", (int)zbx_mock_get_parameter_uint64("out.pending"), offset);
+
+	if (0 != offset)
+		parse_traps(1);
+
+	zbx_mock_assert_int_eq("offset after flush", 0, offset);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvalues, &hchunk))
+		fail_msg("expected more than %d values", values_num);
+
+	/* interfaces are looked up once per trap source address in each batch */
+	hlookups = zbx_mock_get_parameter_handle("out.lookups");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hlookups, &hlookup); i++)
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hlookup, &addr))
+			fail_msg("invalid address");
+
+		if (i >= lookups.values_num)
+			fail_msg("address \"%s\" was not looked up", addr);
+
+		zbx_mock_assert_str_eq("looked up address", addr, lookups.values[i]);
+	}
+
+	zbx_mock_assert_int_eq("lookups", i, lookups.values_num);
+
+	zbx_vector_str_clear_ext(&lookups, zbx_str_free);
+	zbx_vector_str_destroy(&lookups);
+	zbx_free(buffer);
+}
@@ -0,0 +1,74 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxcomms.h"
+#include "trapper_loop_test.h"
+
+#define TEST_WAITS_MAX	100
+
+/* unresolved symbols needed for linking */
+unsigned char	program_type = ZBX_PROGRAM_TYPE_SERVER;
+int		CONFIG_FORKS[ZBX_PROCESS_TYPE_COUNT];
+char		*CONFIG_STATS_ALLOWED_IP = NULL;
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_socket_t	s;
+	int		waits = 0;
+
+	ZBX_UNUSED(state);
+
+	trapper_loop_test_init(2);
+
+	zbx_mock_assert_result_eq("zbx_tcp_connect() return code", SUCCEED,
+			zbx_tcp_connect(&s, NULL, "127.0.0.1", 10051, 0, ZBX_TCP_SEC_UNENCRYPTED, NULL, NULL));
+
+	/* connection is accepted and request received as far as possible without blocking, */
+	/* each event loop iteration continues where the previous one stopped */
+	trapper_loop_test_add(&s);
+
+	while (0 != trapper_loop_test_connections() && 0 == trapper_loop_test_received())
+	{
+		if (TEST_WAITS_MAX == waits++)
+			fail_msg("connection is not processed after %d event loop iterations", TEST_WAITS_MAX);
+
+		trapper_loop_test_run();
+	}
+
+	zbx_mock_assert_int_eq("number of waits", (int)zbx_mock_get_parameter_uint64("out.waits"), waits);
+
+	if (SUCCEED == zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")))
+	{
+		zbx_mock_assert_int_eq("received requests", 1, trapper_loop_test_received());
+		zbx_mock_assert_str_eq("received request", zbx_mock_get_parameter_string("out.data"),
+				trapper_loop_test_received_data(0));
+	}
+	else
+		zbx_mock_assert_int_eq("open connections", 0, trapper_loop_test_connections());
+
+	trapper_loop_test_destroy();
+}
+
+#undef TEST_WAITS_MAX
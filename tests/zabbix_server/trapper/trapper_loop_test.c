@@ -0,0 +1,80 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "trapper_loop_test.h"
+
+static zbx_trapper_loop_t	test_loop;
+
+static unsigned char	test_program_type(void)
+{
+	return ZBX_PROGRAM_TYPE_SERVER;
+}
+
+void	trapper_loop_test_init(int connections_max)
+{
+	zbx_socket_t	listen_sock;
+
+	zbx_get_program_type_cb = test_program_type;
+
+	memset(&listen_sock, 0, sizeof(listen_sock));
+	trapper_loop_init(&test_loop, &listen_sock, connections_max, 0);
+}
+
+/* adds connection as if it was just accepted from listening socket */
+void	trapper_loop_test_add(const zbx_socket_t *s)
+{
+	zbx_trapper_conn_t	*conn;
+
+	conn = (zbx_trapper_conn_t *)zbx_malloc(NULL, sizeof(zbx_trapper_conn_t));
+	conn->s = *s;
+
+	trapper_conn_start(&test_loop, conn);
+}
+
+void	trapper_loop_test_run(void)
+{
+	event_base_loop(test_loop.base, EVLOOP_ONCE);
+}
+
+int	trapper_loop_test_connections(void)
+{
+	return test_loop.connections_num;
+}
+
+int	trapper_loop_test_received(void)
+{
+	return test_loop.received.values_num;
+}
+
+const char	*trapper_loop_test_received_data(int index)
+{
+	return ((zbx_trapper_conn_t *)test_loop.received.values[index])->s.buffer;
+}
+
+void	trapper_loop_test_destroy(void)
+{
+	int	i;
+
+	for (i = 0; i < test_loop.received.values_num; i++)
+		trapper_conn_free((zbx_trapper_conn_t *)test_loop.received.values[i]);
+
+	zbx_vector_ptr_destroy(&test_loop.received);
+	zbx_free(test_loop.listen_events);
+	event_base_free(test_loop.base);
+}
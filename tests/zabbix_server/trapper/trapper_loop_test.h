@@ -0,0 +1,33 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2023 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef TRAPPER_LOOP_TEST_H
+#define TRAPPER_LOOP_TEST_H
+
+#include "zbxcomms.h"
+
+void		trapper_loop_test_init(int connections_max);
+void		trapper_loop_test_add(const zbx_socket_t *s);
+void		trapper_loop_test_run(void);
+int		trapper_loop_test_connections(void);
+int		trapper_loop_test_received(void);
+const char	*trapper_loop_test_received_data(int index);
+void		trapper_loop_test_destroy(void);
+
+#endif /* TRAPPER_LOOP_TEST_H */
@@ -49,6 +49,7 @@ int	__wrap_fclose(FILE *fp);
 char	*__wrap_fgets(char *s, int size, FILE *stream);
 int	__wrap_connect(int socket, void *addr, socklen_t address_len);
 ssize_t	__wrap_read(int fildes, void *buf, size_t nbyte);
+ssize_t	__wrap_recv(int sockfd, void *buf, size_t len, int flags);
 int	__wrap_open(const char *path, int oflag, ...);
 int	__wrap_stat(const char *path, struct stat *buf);
 int	__wrap___xstat(int ver, const char *pathname, struct stat *buf);
@@ -222,50 +223,95 @@ int	__wrap_open(const char *path, int oflag, ...)
 	return INT_MAX;
 }
 
+static int	mock_str_to_errno(const char *str)
+{
+	if (0 == strcmp(str, "EAGAIN"))
+		return EAGAIN;
+
+	if (0 == strcmp(str, "ECONNRESET"))
+		return ECONNRESET;
+
+	fail_msg("Unknown errno \"%s\"", str);
+
+	return 0;
+}
+
 /******************************************************************************
  *                                                                            *
- * Comments: Note that simply wrapping read function will break any compiled  *
- *           in tool, that would attempt to use read() function. In this case *
- *           some safeguards must be added to implement pass-through          *
- *           functionality like it's done with open/fxstat etc functions for  *
- *           coverage builds.                                                 *
+ * Purpose: read the next part of fragments data                              *
+ *                                                                            *
+ * Comments: A fragment with errno member instead of data simulates failed    *
+ *           read, for example EAGAIN when no data has arrived yet.           *
  *                                                                            *
  ******************************************************************************/
-ssize_t	__wrap_read(int fildes, void *buf, size_t nbyte)
+static ssize_t	fragments_read(void *buf, size_t nbyte, int peek)
 {
-	static int		remaining_length;
+	static size_t		remaining_length;
 	static const char	*data;
 	zbx_mock_error_t	error;
-	zbx_mock_handle_t	fragment;
+	zbx_mock_handle_t	fragment, handle;
 	size_t			length;
 
-	ZBX_UNUSED(fildes);
-
 	if (0 == remaining_length)
 	{
+		const char	*value;
+
 		if (ZBX_MOCK_SUCCESS != zbx_mock_vector_element(fragments, &fragment))
 			return 0;	/* no more data */
 
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(fragment, "errno", &handle))
+		{
+			if (ZBX_MOCK_SUCCESS != (error = zbx_mock_string(handle, &value)))
+				fail_msg("Cannot read errno '%s'", zbx_mock_error_string(error));
+
+			errno = mock_str_to_errno(value);
+
+			return -1;
+		}
+
 		if (ZBX_MOCK_SUCCESS != (error = zbx_mock_binary(fragment, &data, &length)))
 			fail_msg("Cannot read data '%s'", zbx_mock_error_string(error));
 	}
 	else
 		length = remaining_length;
 
+	remaining_length = length;
+
 	if (nbyte < length)
-	{
-		remaining_length = length - nbyte;
 		length = nbyte;
-	}
-	else
-		remaining_length = 0;
 
 	memcpy(buf, data, length);
 
-	if (0 != remaining_length)
+	if (0 == peek)
+	{
+		remaining_length -= length;
 		data += length;
+	}
+
+	return (ssize_t)length;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Comments: Note that simply wrapping read function will break any compiled  *
+ *           in tool, that would attempt to use read() function. In this case *
+ *           some safeguards must be added to implement pass-through          *
+ *           functionality like it's done with open/fxstat etc functions for  *
+ *           coverage builds.                                                 *
+ *                                                                            *
+ ******************************************************************************/
+ssize_t	__wrap_read(int fildes, void *buf, size_t nbyte)
+{
+	ZBX_UNUSED(fildes);
+
+	return fragments_read(buf, nbyte, 0);
+}
+
+ssize_t	__wrap_recv(int sockfd, void *buf, size_t len, int flags)
+{
+	ZBX_UNUSED(sockfd);
 
-	return length;
+	return fragments_read(buf, len, 0 != (flags & MSG_PEEK));
 }
 
 int	__wrap_stat(const char *path, struct stat *buf)